@@ -0,0 +1,859 @@
+/* ccd_combine.c
+** Master calibration frame combine module.
+** $Header$
+*/
+/**
+ * ccd_combine holds the routines for combining a series of bias or dark frames into a master calibration frame,
+ * as each frame is read out and de-interlaced, rather than re-reading the saved frames from disk afterwards.
+ * <ul>
+ * <li>CCD_Combine_Start starts a combine. While it is active, CCD_Combine_Post_Readout (called from
+ *     ccd_pixel_stream after each full frame is de-interlaced) adds each frame to the combine.
+ * <li>A running per-pixel mean and variance (Welford's method) is always kept, using two floats per pixel.
+ * <li>For the median and sigma clipped mean combine methods, a copy of each frame is also kept, up to
+ *     the configured memory limit (and CCD_COMBINE_MAX_STACK_FRAME_COUNT frames). If more frames are read out
+ *     than can be kept, the master frame is the running mean.
+ * <li>CCD_Combine_Save computes the master frame, and saves it (and the per-pixel variance) to a FITS file.
+ * </ul>
+ * Adding frames and computing the master frame are split into row bands, each processed by a separate thread.
+ * @author Chris Mottram
+ * @version $Revision$
+ */
+/**
+ * This hash define is needed before including source files give us POSIX.4/IEEE1003.1b-1993 prototypes.
+ */
+#define _POSIX_SOURCE 1
+/**
+ * This hash define is needed before including source files give us POSIX.4/IEEE1003.1b-1993 prototypes.
+ */
+#define _POSIX_C_SOURCE 199309L
+#include <errno.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "log_udp.h"
+#include "ccd_global.h"
+#include "ccd_combine.h"
+#ifdef CFITSIO
+#include "fitsio.h"
+#endif
+
+/**
+ * Revision Control System identifier.
+ */
+static char rcsid[] = "$Id$";
+
+/* hash defines */
+/**
+ * The maximum number of clipping iterations for the sigma clipped mean.
+ */
+#define COMBINE_CLIP_MAX_ITERATIONS	(5)
+/**
+ * The number of bytes in a megabyte, used to convert the memory limit.
+ */
+#define COMBINE_BYTES_PER_MEGABYTE	(1024*1024)
+
+/* data types */
+/**
+ * Data type holding local data to ccd_combine. This consists of the following:
+ * <dl>
+ * <dt>Method</dt> <dd>Which combine method to use, see CCD_COMBINE_METHOD_MEAN etc.</dd>
+ * <dt>Clip_Sigma</dt> <dd>How many standard deviations from the mean a pixel must be to be rejected
+ *     by the sigma clipped mean.</dd>
+ * <dt>Thread_Count</dt> <dd>The number of row bands (threads) to split each frame into.</dd>
+ * <dt>Memory_Limit</dt> <dd>The memory, in megabytes, that can be used to keep copies of the frames.</dd>
+ * <dt>Active</dt> <dd>A boolean, whether a combine has been started and frames are being added.</dd>
+ * <dt>NCols</dt> <dd>The number of columns in each frame, set from the first frame.</dd>
+ * <dt>NRows</dt> <dd>The number of rows in each frame, set from the first frame.</dd>
+ * <dt>Frame_Count</dt> <dd>The number of frames added.</dd>
+ * <dt>Mean</dt> <dd>The running per-pixel mean (NCols*NRows).</dd>
+ * <dt>M2</dt> <dd>The running per-pixel sum of squared differences from the mean (NCols*NRows).</dd>
+ * <dt>Stack_List</dt> <dd>Copies of the frames added, for the median/clipped mean methods.</dd>
+ * <dt>Stack_Count</dt> <dd>The number of frames in Stack_List.</dd>
+ * <dt>Stack_Limit</dt> <dd>The maximum number of frames that can be kept in Stack_List.</dd>
+ * </dl>
+ */
+struct Combine_Struct
+{
+	int Method;
+	double Clip_Sigma;
+	int Thread_Count;
+	int Memory_Limit;
+	int Active;
+	int NCols;
+	int NRows;
+	int Frame_Count;
+	float *Mean;
+	float *M2;
+	unsigned short *Stack_List[CCD_COMBINE_MAX_STACK_FRAME_COUNT];
+	int Stack_Count;
+	int Stack_Limit;
+};
+
+/**
+ * Data type holding the data for processing one row band of a frame.
+ * <dl>
+ * <dt>Image_Data</dt> <dd>The frame being added, or NULL when computing the master frame.</dd>
+ * <dt>Combined_Data</dt> <dd>Where to put the master frame, when computing the master frame.</dd>
+ * <dt>Start_Row</dt> <dd>The first row in the band.</dd>
+ * <dt>End_Row</dt> <dd>One more than the last row in the band.</dd>
+ * <dt>Thread</dt> <dd>The thread processing this band.</dd>
+ * <dt>Thread_Started</dt> <dd>A boolean, whether Thread was successfully started.</dd>
+ * </dl>
+ */
+struct Combine_Band_Struct
+{
+	unsigned short *Image_Data;
+	float *Combined_Data;
+	int Start_Row;
+	int End_Row;
+	pthread_t Thread;
+	int Thread_Started;
+};
+
+/* internal variables */
+/**
+ * Variable holding error code of last operation performed by ccd_combine.
+ */
+static int Combine_Error_Number = 0;
+/**
+ * Local variable holding description of the last error that occured.
+ */
+static char Combine_Error_String[CCD_GLOBAL_ERROR_STRING_LENGTH] = "";
+/**
+ * Local combine data.
+ * @see #Combine_Struct
+ */
+static struct Combine_Struct Combine_Data;
+
+/* internal function definitions */
+static void Combine_Bands_Run(void *(*band_routine)(void *),unsigned short *image_data,float *combined_data);
+static void *Combine_Add_Band_Thread(void *user_arg);
+static void *Combine_Stack_Band_Thread(void *user_arg);
+static void Combine_Free(void);
+static char *Combine_Method_To_String(int method);
+#ifdef CFITSIO
+static int Combine_Save(char *filename,float *combined_data,int method);
+#endif
+
+/* -----------------------------------------------------------------------------
+**     external functions
+** ----------------------------------------------------------------------------- */
+/**
+ * This routine sets up ccd_combine internal variables.
+ * It should be called at startup.
+ * @return This routine returns TRUE for success.
+ * @see #Combine_Data
+ */
+int CCD_Combine_Initialise(void)
+{
+	Combine_Error_Number = 0;
+/* print some compile time information to stdout */
+	fprintf(stdout,"CCD_Combine_Initialise:%s.\n",rcsid);
+	memset(&Combine_Data,0,sizeof(Combine_Data));
+	Combine_Data.Method = CCD_COMBINE_METHOD_MEAN;
+	Combine_Data.Clip_Sigma = CCD_COMBINE_DEFAULT_CLIP_SIGMA;
+	Combine_Data.Thread_Count = CCD_COMBINE_DEFAULT_THREAD_COUNT;
+	Combine_Data.Memory_Limit = CCD_COMBINE_DEFAULT_MEMORY_LIMIT;
+	Combine_Data.Active = FALSE;
+	return TRUE;
+}
+
+/**
+ * Routine to configure the combine. The configuration is used by the next call to CCD_Combine_Start.
+ * @param method The combine method, one of CCD_COMBINE_METHOD_MEAN, CCD_COMBINE_METHOD_CLIPPED_MEAN or
+ *        CCD_COMBINE_METHOD_MEDIAN.
+ * @param clip_sigma How many standard deviations from the mean a pixel must be to be rejected by
+ *        the sigma clipped mean. Must be greater than zero.
+ * @param thread_count The number of row bands (threads) to split each frame into,
+ *        from 1 to CCD_COMBINE_MAX_THREAD_COUNT.
+ * @param memory_limit The memory, in megabytes, that can be used to keep copies of the frames for the
+ *        median/clipped mean methods. Must be at least zero.
+ * @return The routine returns TRUE on success, and FALSE if an argument is out of range, or a combine is active.
+ * @see #Combine_Data
+ * @see #CCD_COMBINE_IS_METHOD
+ * @see #CCD_COMBINE_MAX_THREAD_COUNT
+ */
+int CCD_Combine_Set_Config(int method,double clip_sigma,int thread_count,int memory_limit)
+{
+	Combine_Error_Number = 0;
+	if(!CCD_COMBINE_IS_METHOD(method))
+	{
+		Combine_Error_Number = 1;
+		sprintf(Combine_Error_String,"CCD_Combine_Set_Config:Illegal method %d.",method);
+		return FALSE;
+	}
+	if(clip_sigma <= 0.0)
+	{
+		Combine_Error_Number = 2;
+		sprintf(Combine_Error_String,"CCD_Combine_Set_Config:Illegal clip sigma %.2f.",clip_sigma);
+		return FALSE;
+	}
+	if((thread_count < 1)||(thread_count > CCD_COMBINE_MAX_THREAD_COUNT))
+	{
+		Combine_Error_Number = 3;
+		sprintf(Combine_Error_String,"CCD_Combine_Set_Config:Illegal thread count %d (1..%d).",
+			thread_count,CCD_COMBINE_MAX_THREAD_COUNT);
+		return FALSE;
+	}
+	if(memory_limit < 0)
+	{
+		Combine_Error_Number = 4;
+		sprintf(Combine_Error_String,"CCD_Combine_Set_Config:Illegal memory limit %d.",memory_limit);
+		return FALSE;
+	}
+	if(Combine_Data.Active)
+	{
+		Combine_Error_Number = 5;
+		sprintf(Combine_Error_String,"CCD_Combine_Set_Config:A combine is active.");
+		return FALSE;
+	}
+	Combine_Data.Method = method;
+	Combine_Data.Clip_Sigma = clip_sigma;
+	Combine_Data.Thread_Count = thread_count;
+	Combine_Data.Memory_Limit = memory_limit;
+#if LOGGING > 4
+	CCD_Global_Log_Format(LOG_VERBOSITY_VERBOSE,"CCD_Combine_Set_Config:method %s:clip sigma %.2f:"
+			      "thread count %d:memory limit %d Mb.",Combine_Method_To_String(method),clip_sigma,
+			      thread_count,memory_limit);
+#endif
+	return TRUE;
+}
+
+/**
+ * Routine to start a combine. Any previous combine is discarded. Each full frame read out after this
+ * is added to the combine, until CCD_Combine_Save or CCD_Combine_Abort is called.
+ * The memory for the combine is allocated when the first frame is added, as the frame dimensions are not
+ * known until then.
+ * @return The routine returns TRUE on success.
+ * @see #Combine_Data
+ * @see #Combine_Free
+ * @see #CCD_Combine_Post_Readout
+ */
+int CCD_Combine_Start(void)
+{
+	Combine_Error_Number = 0;
+	Combine_Free();
+	Combine_Data.Active = TRUE;
+#if LOGGING > 4
+	CCD_Global_Log_Format(LOG_VERBOSITY_VERBOSE,"CCD_Combine_Start:Started %s combine.",
+			      Combine_Method_To_String(Combine_Data.Method));
+#endif
+	return TRUE;
+}
+
+/**
+ * Routine to return whether a combine is active.
+ * @return A boolean, TRUE if a combine has been started, and not yet saved or aborted.
+ * @see #Combine_Data
+ */
+int CCD_Combine_Is_Active(void)
+{
+	return Combine_Data.Active;
+}
+
+/**
+ * Routine to add a frame to the active combine.
+ * <ul>
+ * <li>If this is the first frame, the running mean and variance arrays are allocated, and
+ *     the number of frames that can be kept in memory (Stack_Limit) is worked out.
+ * <li>If the median/clipped mean method is being used, and there is room, a frame buffer is allocated
+ *     for a copy of the frame.
+ * <li>Combine_Bands_Run is called with Combine_Add_Band_Thread, to update the running mean and variance,
+ *     and copy the frame, in row bands.
+ * </ul>
+ * @param image_data The frame, ncols by nrows unsigned shorts, row 0 first.
+ * @param ncols The number of columns in the frame.
+ * @param nrows The number of rows in the frame.
+ * @return The routine returns TRUE on success, and FALSE if an error occurs.
+ * @see #Combine_Data
+ * @see #Combine_Bands_Run
+ * @see #Combine_Add_Band_Thread
+ * @see #COMBINE_BYTES_PER_MEGABYTE
+ * @see #CCD_COMBINE_MAX_STACK_FRAME_COUNT
+ */
+int CCD_Combine_Add(unsigned short *image_data,int ncols,int nrows)
+{
+	unsigned short *stack_frame = NULL;
+	size_t pixel_count;
+	double stack_limit;
+
+	Combine_Error_Number = 0;
+	if(Combine_Data.Active == FALSE)
+	{
+		Combine_Error_Number = 6;
+		sprintf(Combine_Error_String,"CCD_Combine_Add:No combine is active.");
+		return FALSE;
+	}
+	if(image_data == NULL)
+	{
+		Combine_Error_Number = 7;
+		sprintf(Combine_Error_String,"CCD_Combine_Add:image_data was NULL.");
+		return FALSE;
+	}
+	if((ncols <= 0)||(nrows <= 0))
+	{
+		Combine_Error_Number = 8;
+		sprintf(Combine_Error_String,"CCD_Combine_Add:Illegal dimensions (%d,%d).",ncols,nrows);
+		return FALSE;
+	}
+	pixel_count = ((size_t)ncols)*((size_t)nrows);
+	if(Combine_Data.Frame_Count == 0)
+	{
+		Combine_Data.NCols = ncols;
+		Combine_Data.NRows = nrows;
+		Combine_Data.Mean = (float *)calloc(pixel_count,sizeof(float));
+		Combine_Data.M2 = (float *)calloc(pixel_count,sizeof(float));
+		if((Combine_Data.Mean == NULL)||(Combine_Data.M2 == NULL))
+		{
+			Combine_Free();
+			Combine_Data.Active = TRUE;
+			Combine_Error_Number = 9;
+			sprintf(Combine_Error_String,"CCD_Combine_Add:Failed to allocate running mean/variance "
+				"(%d,%d).",ncols,nrows);
+			return FALSE;
+		}
+		if(Combine_Data.Method == CCD_COMBINE_METHOD_MEAN)
+			Combine_Data.Stack_Limit = 0;
+		else
+		{
+			stack_limit = (((double)Combine_Data.Memory_Limit)*COMBINE_BYTES_PER_MEGABYTE)/
+				(((double)pixel_count)*sizeof(unsigned short));
+			if(stack_limit > CCD_COMBINE_MAX_STACK_FRAME_COUNT)
+				stack_limit = CCD_COMBINE_MAX_STACK_FRAME_COUNT;
+			Combine_Data.Stack_Limit = (int)stack_limit;
+		}
+#if LOGGING > 4
+		CCD_Global_Log_Format(LOG_VERBOSITY_VERBOSE,"CCD_Combine_Add:First frame (%d,%d):"
+				      "up to %d frames can be kept in memory.",ncols,nrows,Combine_Data.Stack_Limit);
+#endif
+	}
+	else if((ncols != Combine_Data.NCols)||(nrows != Combine_Data.NRows))
+	{
+		Combine_Error_Number = 10;
+		sprintf(Combine_Error_String,"CCD_Combine_Add:Frame dimensions (%d,%d) do not match "
+			"the first frame (%d,%d).",ncols,nrows,Combine_Data.NCols,Combine_Data.NRows);
+		return FALSE;
+	}
+	/* allocate a copy of the frame, if we are keeping them, and there is room */
+	if(Combine_Data.Stack_Count < Combine_Data.Stack_Limit)
+	{
+		stack_frame = (unsigned short *)malloc(pixel_count*sizeof(unsigned short));
+		if(stack_frame != NULL)
+		{
+			Combine_Data.Stack_List[Combine_Data.Stack_Count] = stack_frame;
+		}
+		else
+		{
+			/* stop keeping copies, the running mean will be used */
+			Combine_Data.Stack_Limit = Combine_Data.Stack_Count;
+#if LOGGING > 1
+			CCD_Global_Log_Format(LOG_VERBOSITY_TERSE,"CCD_Combine_Add:Failed to allocate frame copy %d:"
+					      "master frame will be the mean.",Combine_Data.Stack_Count);
+#endif
+		}
+	}
+	Combine_Bands_Run(Combine_Add_Band_Thread,image_data,NULL);
+	if(stack_frame != NULL)
+		Combine_Data.Stack_Count++;
+	Combine_Data.Frame_Count++;
+#if LOGGING > 4
+	CCD_Global_Log_Format(LOG_VERBOSITY_VERBOSE,"CCD_Combine_Add:Added frame %d (%d kept in memory).",
+			      Combine_Data.Frame_Count,Combine_Data.Stack_Count);
+#endif
+	return TRUE;
+}
+
+/**
+ * Routine called by ccd_pixel_stream after a full frame has been read out and de-interlaced.
+ * If a combine is active, the frame is added to it.
+ * @param image_data The frame, ncols by nrows unsigned shorts, row 0 first.
+ * @param ncols The number of columns in the frame.
+ * @param nrows The number of rows in the frame.
+ * @return The routine returns TRUE on success (or if no combine is active), and FALSE if an error occurs.
+ * @see #CCD_Combine_Add
+ */
+int CCD_Combine_Post_Readout(unsigned short *image_data,int ncols,int nrows)
+{
+	if(Combine_Data.Active == FALSE)
+		return TRUE;
+	return CCD_Combine_Add(image_data,ncols,nrows);
+}
+
+/**
+ * Routine to return the number of frames added to the combine.
+ * @return The number of frames.
+ * @see #Combine_Data
+ */
+int CCD_Combine_Get_Frame_Count(void)
+{
+	return Combine_Data.Frame_Count;
+}
+
+/**
+ * Routine to finish the active combine, and save the master frame.
+ * <ul>
+ * <li>The running M2 is converted to a variance.
+ * <li>If the method is mean, or not all the frames could be kept in memory, the master frame is
+ *     the running mean. Otherwise a master frame buffer is allocated, and Combine_Bands_Run is called with
+ *     Combine_Stack_Band_Thread to compute the median or sigma clipped mean of the kept frames.
+ * <li>The master frame and variance are saved to filename.
+ * <li>The combine is freed, and is no longer active.
+ * </ul>
+ * @param filename The FITS filename to save the master frame to. Any existing file is overwritten.
+ * @return The routine returns TRUE on success, and FALSE if an error occurs. The combine is no longer active
+ *         whether it succeeds or fails.
+ * @see #Combine_Data
+ * @see #Combine_Bands_Run
+ * @see #Combine_Stack_Band_Thread
+ * @see #Combine_Save
+ * @see #Combine_Free
+ */
+int CCD_Combine_Save(char *filename)
+{
+	struct timespec start_time,end_time;
+	float *combined_data = NULL;
+	size_t pixel_count,i;
+	int method,retval;
+
+	Combine_Error_Number = 0;
+	if(filename == NULL)
+	{
+		Combine_Error_Number = 11;
+		sprintf(Combine_Error_String,"CCD_Combine_Save:filename was NULL.");
+		Combine_Free();
+		return FALSE;
+	}
+	if(Combine_Data.Active == FALSE)
+	{
+		Combine_Error_Number = 12;
+		sprintf(Combine_Error_String,"CCD_Combine_Save:No combine is active.");
+		return FALSE;
+	}
+	if(Combine_Data.Frame_Count == 0)
+	{
+		Combine_Error_Number = 13;
+		sprintf(Combine_Error_String,"CCD_Combine_Save:No frames have been added.");
+		Combine_Free();
+		return FALSE;
+	}
+	clock_gettime(CLOCK_REALTIME,&start_time);
+	pixel_count = ((size_t)Combine_Data.NCols)*((size_t)Combine_Data.NRows);
+	/* convert running M2 to variance */
+	for(i = 0; i < pixel_count; i++)
+	{
+		if(Combine_Data.Frame_Count > 1)
+			Combine_Data.M2[i] /= (float)(Combine_Data.Frame_Count-1);
+		else
+			Combine_Data.M2[i] = 0.0f;
+	}
+	/* compute master frame */
+	method = Combine_Data.Method;
+	if((method != CCD_COMBINE_METHOD_MEAN)&&(Combine_Data.Stack_Count < Combine_Data.Frame_Count))
+	{
+#if LOGGING > 1
+		CCD_Global_Log_Format(LOG_VERBOSITY_TERSE,"CCD_Combine_Save:Only %d of %d frames kept in memory:"
+				      "using mean instead of %s.",Combine_Data.Stack_Count,Combine_Data.Frame_Count,
+				      Combine_Method_To_String(method));
+#endif
+		method = CCD_COMBINE_METHOD_MEAN;
+	}
+	if(method == CCD_COMBINE_METHOD_MEAN)
+		combined_data = Combine_Data.Mean;
+	else
+	{
+		combined_data = (float *)malloc(pixel_count*sizeof(float));
+		if(combined_data == NULL)
+		{
+#if LOGGING > 1
+			CCD_Global_Log_Format(LOG_VERBOSITY_TERSE,"CCD_Combine_Save:Failed to allocate master frame:"
+					      "using mean instead of %s.",Combine_Method_To_String(method));
+#endif
+			method = CCD_COMBINE_METHOD_MEAN;
+			combined_data = Combine_Data.Mean;
+		}
+		else
+			Combine_Bands_Run(Combine_Stack_Band_Thread,NULL,combined_data);
+	}
+	clock_gettime(CLOCK_REALTIME,&end_time);
+#if LOGGING > 4
+	CCD_Global_Log_Format(LOG_VERBOSITY_VERBOSE,"CCD_Combine_Save:Combined %d frames using %s in %.3f seconds.",
+			      Combine_Data.Frame_Count,Combine_Method_To_String(method),
+			      fdifftime(end_time,start_time));
+#endif
+#ifdef CFITSIO
+	retval = Combine_Save(filename,combined_data,method);
+#else
+	Combine_Error_Number = 14;
+	sprintf(Combine_Error_String,"CCD_Combine_Save:Library not compiled with CFITSIO:Cannot save %s.",
+		filename);
+	retval = FALSE;
+#endif
+	if(combined_data != Combine_Data.Mean)
+		free(combined_data);
+	Combine_Free();
+	return retval;
+}
+
+/**
+ * Routine to abort the active combine. The combine is freed, and is no longer active.
+ * It is not an error to call this if no combine is active.
+ * @return The routine returns TRUE.
+ * @see #Combine_Free
+ */
+int CCD_Combine_Abort(void)
+{
+	Combine_Error_Number = 0;
+	Combine_Free();
+	return TRUE;
+}
+
+/**
+ * Get the current value of the error number.
+ * @return The current value of the error number.
+ */
+int CCD_Combine_Get_Error_Number(void)
+{
+	return Combine_Error_Number;
+}
+
+/**
+ * The error routine that reports any errors occuring in ccd_combine in a standard way.
+ * @see ccd_global.html#CCD_Global_Get_Current_Time_String
+ * @see #Combine_Error_Number
+ * @see #Combine_Error_String
+ */
+void CCD_Combine_Error(void)
+{
+	char time_string[32];
+
+	CCD_Global_Get_Current_Time_String(time_string,32);
+	/* if the error number is zero an error message has not been set up
+	** This is in itself an error as we should not be calling this routine
+	** without there being an error to display */
+	if(Combine_Error_Number == 0)
+		sprintf(Combine_Error_String,"Logic Error:No Error defined");
+	fprintf(stderr,"%s CCD_Combine:Error(%d) : %s\n",time_string,Combine_Error_Number,Combine_Error_String);
+}
+
+/**
+ * The error routine that reports any errors occuring in ccd_combine in a standard way. This routine places the
+ * generated error string at the end of a passed in string argument.
+ * @param error_string A string to put the generated error in. This string should be initialised before
+ * 	being passed to this routine. The routine will try to concatenate it's error string onto the end
+ * 	of any string already in existance.
+ * @see ccd_global.html#CCD_Global_Get_Current_Time_String
+ */
+void CCD_Combine_Error_String(char *error_string)
+{
+	char time_string[32];
+
+	CCD_Global_Get_Current_Time_String(time_string,32);
+	/* if the error number is zero an error message has not been set up
+	** This is in itself an error as we should not be calling this routine
+	** without there being an error to display */
+	if(Combine_Error_Number == 0)
+		sprintf(Combine_Error_String,"Logic Error:No Error defined");
+	sprintf(error_string+strlen(error_string),"%s CCD_Combine:Error(%d) : %s\n",time_string,
+		Combine_Error_Number,Combine_Error_String);
+}
+
+/* -----------------------------------------------------------------------------
+** 	internal functions
+** ----------------------------------------------------------------------------- */
+/**
+ * Split the frame into Thread_Count row bands, and call band_routine on each band. Bands 1.. are processed
+ * by new threads, band 0 by this thread. If a thread cannot be started, the band is processed in this
+ * thread instead.
+ * @param band_routine The routine to call for each band, passed a pointer to a Combine_Band_Struct.
+ * @param image_data The frame being added, or NULL.
+ * @param combined_data The master frame being computed, or NULL.
+ * @see #Combine_Data
+ * @see #Combine_Band_Struct
+ */
+static void Combine_Bands_Run(void *(*band_routine)(void *),unsigned short *image_data,float *combined_data)
+{
+	struct Combine_Band_Struct band_list[CCD_COMBINE_MAX_THREAD_COUNT];
+	int band_count,band_index,retval;
+
+	band_count = Combine_Data.Thread_Count;
+	if(band_count > Combine_Data.NRows)
+		band_count = Combine_Data.NRows;
+	memset(band_list,0,sizeof(band_list));
+	for(band_index = 0; band_index < band_count; band_index++)
+	{
+		band_list[band_index].Image_Data = image_data;
+		band_list[band_index].Combined_Data = combined_data;
+		band_list[band_index].Start_Row = (band_index*Combine_Data.NRows)/band_count;
+		band_list[band_index].End_Row = ((band_index+1)*Combine_Data.NRows)/band_count;
+		if(band_index > 0)
+		{
+			retval = pthread_create(&(band_list[band_index].Thread),NULL,band_routine,
+						(void *)&(band_list[band_index]));
+			band_list[band_index].Thread_Started = (retval == 0);
+		}
+	}
+	band_routine((void *)&(band_list[0]));
+	for(band_index = 1; band_index < band_count; band_index++)
+	{
+		if(band_list[band_index].Thread_Started)
+			pthread_join(band_list[band_index].Thread,NULL);
+		else
+			band_routine((void *)&(band_list[band_index]));
+	}
+}
+
+/**
+ * Thread routine to add one row band of a frame to the combine. The running mean and M2 of each pixel are
+ * updated using Welford's method, and if a frame copy has been allocated (Stack_List[Stack_Count]),
+ * the band is copied into it.
+ * @param user_arg A pointer to the Combine_Band_Struct for this band.
+ * @return The routine returns NULL.
+ * @see #Combine_Data
+ */
+static void *Combine_Add_Band_Thread(void *user_arg)
+{
+	struct Combine_Band_Struct *band = (struct Combine_Band_Struct *)user_arg;
+	unsigned short *stack_frame = NULL;
+	size_t start_index,end_index,i;
+	float n,value,delta;
+
+	start_index = ((size_t)band->Start_Row)*((size_t)Combine_Data.NCols);
+	end_index = ((size_t)band->End_Row)*((size_t)Combine_Data.NCols);
+	n = (float)(Combine_Data.Frame_Count+1);
+	for(i = start_index; i < end_index; i++)
+	{
+		value = (float)(band->Image_Data[i]);
+		delta = value-Combine_Data.Mean[i];
+		Combine_Data.Mean[i] += delta/n;
+		Combine_Data.M2[i] += delta*(value-Combine_Data.Mean[i]);
+	}
+	if(Combine_Data.Stack_Count < Combine_Data.Stack_Limit)
+	{
+		stack_frame = Combine_Data.Stack_List[Combine_Data.Stack_Count];
+		memcpy(stack_frame+start_index,band->Image_Data+start_index,
+		       (end_index-start_index)*sizeof(unsigned short));
+	}
+	return NULL;
+}
+
+/**
+ * Thread routine to compute one row band of the master frame from the frames kept in memory.
+ * For each pixel, the values from each frame are sorted (insertion sort, there are at most
+ * CCD_COMBINE_MAX_STACK_FRAME_COUNT). The median is the middle value (or the mean of the middle two values).
+ * The sigma clipped mean repeatedly computes the mean and standard deviation of the values not yet rejected,
+ * and rejects values more than Clip_Sigma standard deviations from the mean (from either end of the sorted
+ * list), until no more values are rejected, fewer than three remain, or COMBINE_CLIP_MAX_ITERATIONS is reached.
+ * @param user_arg A pointer to the Combine_Band_Struct for this band.
+ * @return The routine returns NULL.
+ * @see #Combine_Data
+ * @see #COMBINE_CLIP_MAX_ITERATIONS
+ */
+static void *Combine_Stack_Band_Thread(void *user_arg)
+{
+	struct Combine_Band_Struct *band = (struct Combine_Band_Struct *)user_arg;
+	unsigned short value_list[CCD_COMBINE_MAX_STACK_FRAME_COUNT];
+	unsigned short value;
+	size_t start_index,end_index,i;
+	double sum,sum_squares,mean,sigma;
+	int count,j,k,lo,hi,new_lo,new_hi,iteration;
+
+	start_index = ((size_t)band->Start_Row)*((size_t)Combine_Data.NCols);
+	end_index = ((size_t)band->End_Row)*((size_t)Combine_Data.NCols);
+	count = Combine_Data.Stack_Count;
+	for(i = start_index; i < end_index; i++)
+	{
+		/* gather and sort the pixel values */
+		for(j = 0; j < count; j++)
+		{
+			value = Combine_Data.Stack_List[j][i];
+			k = j;
+			while((k > 0)&&(value_list[k-1] > value))
+			{
+				value_list[k] = value_list[k-1];
+				k--;
+			}
+			value_list[k] = value;
+		}
+		if(Combine_Data.Method == CCD_COMBINE_METHOD_MEDIAN)
+		{
+			if(count % 2)
+				band->Combined_Data[i] = (float)(value_list[count/2]);
+			else
+				band->Combined_Data[i] = ((float)(value_list[(count/2)-1])+
+							  (float)(value_list[count/2]))/2.0f;
+			continue;
+		}
+		/* sigma clipped mean */
+		lo = 0;
+		hi = count;
+		mean = 0.0;
+		for(iteration = 0; iteration <= COMBINE_CLIP_MAX_ITERATIONS; iteration++)
+		{
+			sum = 0.0;
+			sum_squares = 0.0;
+			for(j = lo; j < hi; j++)
+			{
+				sum += (double)(value_list[j]);
+				sum_squares += ((double)(value_list[j]))*((double)(value_list[j]));
+			}
+			mean = sum/((double)(hi-lo));
+			if((iteration == COMBINE_CLIP_MAX_ITERATIONS)||((hi-lo) < 3))
+				break;
+			sigma = (sum_squares/((double)(hi-lo)))-(mean*mean);
+			if(sigma > 0.0)
+				sigma = sqrt(sigma);
+			else
+				sigma = 0.0;
+			new_lo = lo;
+			new_hi = hi;
+			while((new_lo < new_hi)&&
+			      (((double)(value_list[new_lo])) < (mean-(Combine_Data.Clip_Sigma*sigma))))
+				new_lo++;
+			while((new_hi > new_lo)&&
+			      (((double)(value_list[new_hi-1])) > (mean+(Combine_Data.Clip_Sigma*sigma))))
+				new_hi--;
+			if(((new_lo == lo)&&(new_hi == hi))||(new_hi == new_lo))
+				break;
+			lo = new_lo;
+			hi = new_hi;
+		}
+		band->Combined_Data[i] = (float)mean;
+	}
+	return NULL;
+}
+
+/**
+ * Free the memory used by the combine, and make it inactive.
+ * @see #Combine_Data
+ */
+static void Combine_Free(void)
+{
+	int i;
+
+	if(Combine_Data.Mean != NULL)
+		free(Combine_Data.Mean);
+	Combine_Data.Mean = NULL;
+	if(Combine_Data.M2 != NULL)
+		free(Combine_Data.M2);
+	Combine_Data.M2 = NULL;
+	for(i = 0; i < Combine_Data.Stack_Count; i++)
+	{
+		if(Combine_Data.Stack_List[i] != NULL)
+			free(Combine_Data.Stack_List[i]);
+		Combine_Data.Stack_List[i] = NULL;
+	}
+	Combine_Data.Stack_Count = 0;
+	Combine_Data.Stack_Limit = 0;
+	Combine_Data.Frame_Count = 0;
+	Combine_Data.NCols = 0;
+	Combine_Data.NRows = 0;
+	Combine_Data.Active = FALSE;
+}
+
+/**
+ * Return a string describing a combine method, used for logging and the COMBMETH FITS keyword.
+ * @param method The combine method.
+ * @return A string describing the method.
+ */
+static char *Combine_Method_To_String(int method)
+{
+	switch(method)
+	{
+		case CCD_COMBINE_METHOD_MEAN:
+			return "MEAN";
+		case CCD_COMBINE_METHOD_CLIPPED_MEAN:
+			return "CLIPPED_MEAN";
+		case CCD_COMBINE_METHOD_MEDIAN:
+			return "MEDIAN";
+		default:
+			return "UNKNOWN";
+	}
+}
+
+#ifdef CFITSIO
+/**
+ * Save the master frame to a new FITS file. The primary HDU contains the master frame (as floats),
+ * with the NCOMBINE, COMBMETH and CLIPSIG keywords. An image extension called VARIANCE contains the
+ * per-pixel variance of the combined frames.
+ * @param filename The filename to save to. Any existing file is overwritten.
+ * @param combined_data The master frame.
+ * @param method The combine method actually used.
+ * @return The routine returns TRUE on success, and FALSE if an error occurs.
+ * @see #Combine_Data
+ * @see #Combine_Method_To_String
+ */
+static int Combine_Save(char *filename,float *combined_data,int method)
+{
+	fitsfile *fp = NULL;
+	char overwrite_filename[CCD_GLOBAL_ERROR_STRING_LENGTH];
+	char buff[32]; /* fits_get_errstatus returns 30 chars max */
+	long axes_list[2];
+	long pixel_count;
+	int retval=0,status=0;
+
+	if(strlen(filename) > (CCD_GLOBAL_ERROR_STRING_LENGTH-2))
+	{
+		Combine_Error_Number = 15;
+		sprintf(Combine_Error_String,"Combine_Save:filename too long (%lu).",
+			(unsigned long)strlen(filename));
+		return FALSE;
+	}
+	/* a leading '!' tells CFITSIO to overwrite any existing file */
+	sprintf(overwrite_filename,"!%s",filename);
+	axes_list[0] = Combine_Data.NCols;
+	axes_list[1] = Combine_Data.NRows;
+	pixel_count = axes_list[0]*axes_list[1];
+	retval = fits_create_file(&fp,overwrite_filename,&status);
+	if(retval == 0)
+		retval = fits_create_img(fp,FLOAT_IMG,2,axes_list,&status);
+	if(retval == 0)
+		retval = fits_write_img(fp,TFLOAT,1,pixel_count,combined_data,&status);
+	if(retval == 0)
+		retval = fits_update_key(fp,TINT,"NCOMBINE",&(Combine_Data.Frame_Count),
+					 "Number of frames combined",&status);
+	if(retval == 0)
+		retval = fits_update_key(fp,TSTRING,"COMBMETH",Combine_Method_To_String(method),
+					 "Combine method",&status);
+	if((retval == 0)&&(method == CCD_COMBINE_METHOD_CLIPPED_MEAN))
+		retval = fits_update_key_fixdbl(fp,"CLIPSIG",Combine_Data.Clip_Sigma,2,
+						"Clipped mean rejection sigma",&status);
+	if(retval == 0)
+		retval = fits_create_img(fp,FLOAT_IMG,2,axes_list,&status);
+	if(retval == 0)
+		retval = fits_update_key(fp,TSTRING,"EXTNAME","VARIANCE","Per-pixel variance of combined frames",
+					 &status);
+	if(retval == 0)
+		retval = fits_write_img(fp,TFLOAT,1,pixel_count,Combine_Data.M2,&status);
+	if(retval)
+	{
+		fits_get_errstatus(status,buff);
+		fits_report_error(stderr,status);
+		if(fp != NULL)
+			fits_close_file(fp,&status);
+		Combine_Error_Number = 16;
+		sprintf(Combine_Error_String,"Combine_Save:Failed to save master frame(%s,%d,%s).",filename,status,
+			buff);
+		return FALSE;
+	}
+	retval = fits_close_file(fp,&status);
+	if(retval)
+	{
+		fits_get_errstatus(status,buff);
+		fits_report_error(stderr,status);
+		Combine_Error_Number = 17;
+		sprintf(Combine_Error_String,"Combine_Save:File close failed(%s,%d,%s).",filename,status,buff);
+		return FALSE;
+	}
+#if LOGGING > 4
+	CCD_Global_Log_Format(LOG_VERBOSITY_VERBOSE,"Combine_Save:Saved master frame %s.",filename);
+#endif
+	return TRUE;
+}
+#endif
+
+/*
+** $Log: not supported by cvs2svn $
+*/
@@ -0,0 +1,726 @@
+/* ccd_compress.c
+** Tile-compressed FITS image saving module.
+** $Header$
+*/
+/**
+ * ccd_compress holds the routines for saving read out images as lossless tile-compressed FITS images,
+ * using the FITS tiled image compression convention (as written by fpack, and read transparently by CFITSIO).
+ * <ul>
+ * <li>Each image row is a tile, Rice compressed (ZCMPTYPE = 'RICE_1', BLOCKSIZE = 32, BYTEPIX = 2).
+ * <li>The tiles are compressed in parallel, the image is split into row bands, each compressed by a separate
+ *     thread. Each thread writes it's band to it's own in-memory FITS file using CFITSIO's public tiled image
+ *     compression API (fits_set_compression_type/fits_set_tile_dim/fits_write_img), and reads the
+ *     compressed tiles back from the resulting COMPRESSED_DATA column.
+ * <li>The compressed tiles are then written, in order, to the COMPRESSED_DATA variable length array column
+ *     of a binary table extension. CFITSIO's own tile compression runs in the writing thread, one tile at a time.
+ * <li>Bands are only compressed in parallel if CFITSIO was built reentrant (fits_is_reentrant), otherwise they are
+ *     compressed one after the other in the calling thread. This needs CFITSIO 3.0 or later.
+ * <li>The FITS headers already written to the file (by the Java layer) are copied into the compressed image
+ *     HDU, and the file replaced atomically (the compressed file is written to a temporary file, and renamed).
+ * </ul>
+ * @author Chris Mottram
+ * @version $Revision$
+ */
+/**
+ * This hash define is needed before including source files give us POSIX.4/IEEE1003.1b-1993 prototypes.
+ */
+#define _POSIX_SOURCE 1
+/**
+ * This hash define is needed before including source files give us POSIX.4/IEEE1003.1b-1993 prototypes.
+ */
+#define _POSIX_C_SOURCE 199309L
+#include <errno.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "log_udp.h"
+#include "ccd_global.h"
+#include "ccd_compress.h"
+#ifdef CFITSIO
+#include "fitsio.h"
+#endif
+
+/**
+ * Revision Control System identifier.
+ */
+static char rcsid[] = "$Id$";
+
+/* hash defines */
+/**
+ * The number of pixels in each Rice compression block.
+ */
+#define COMPRESS_RICE_BLOCK_SIZE	(32)
+/**
+ * The length of a FITS header card, plus a terminator.
+ */
+#define COMPRESS_CARD_LENGTH		(81)
+/**
+ * The maximum length of a filename, including the temporary file extension.
+ */
+#define COMPRESS_MAX_FILENAME_LENGTH	(256)
+/**
+ * The maximum number of characters of a filename put into an error string, so two filenames and the
+ * rest of the message fit into CCD_GLOBAL_ERROR_STRING_LENGTH.
+ */
+#define COMPRESS_ERROR_FILENAME_LENGTH	(100)
+
+/* data types */
+/**
+ * Data type holding local data to ccd_compress. This consists of the following:
+ * <dl>
+ * <dt>Type</dt> <dd>The compression type, CCD_COMPRESS_TYPE_NONE or CCD_COMPRESS_TYPE_RICE.</dd>
+ * <dt>Thread_Count</dt> <dd>The number of row bands (threads) to split each image into.</dd>
+ * </dl>
+ */
+struct Compress_Struct
+{
+	int Type;
+	int Thread_Count;
+};
+
+/**
+ * Data type holding the data for compressing one row band of an image.
+ * <dl>
+ * <dt>Image_Data</dt> <dd>The image being compressed.</dd>
+ * <dt>NCols</dt> <dd>The number of columns in the image (pixels in each tile).</dd>
+ * <dt>Start_Row</dt> <dd>The first row in the band.</dd>
+ * <dt>End_Row</dt> <dd>One more than the last row in the band.</dd>
+ * <dt>Tile_Capacity</dt> <dd>The number of bytes allocated for each compressed tile.</dd>
+ * <dt>Tile_Data</dt> <dd>The compressed tiles, Tile_Capacity bytes per row in the band.</dd>
+ * <dt>Tile_Length_List</dt> <dd>The compressed length of each tile in the band, in bytes.</dd>
+ * <dt>Thread</dt> <dd>The thread compressing this band.</dd>
+ * <dt>Thread_Started</dt> <dd>A boolean, whether Thread was successfully started.</dd>
+ * <dt>Failed_Row</dt> <dd>The row that failed to compress, or -1 if all rows compressed successfully.</dd>
+ * <dt>Status</dt> <dd>The CFITSIO status of the failure, or 0 if all rows compressed successfully.</dd>
+ * </dl>
+ */
+struct Compress_Band_Struct
+{
+	unsigned short *Image_Data;
+	int NCols;
+	int Start_Row;
+	int End_Row;
+	int Tile_Capacity;
+	unsigned char *Tile_Data;
+	int *Tile_Length_List;
+	pthread_t Thread;
+	int Thread_Started;
+	int Failed_Row;
+	int Status;
+};
+
+/* internal variables */
+/**
+ * Variable holding error code of last operation performed by ccd_compress.
+ */
+static int Compress_Error_Number = 0;
+/**
+ * Local variable holding description of the last error that occured.
+ */
+static char Compress_Error_String[CCD_GLOBAL_ERROR_STRING_LENGTH] = "";
+/**
+ * Local compress data.
+ * @see #Compress_Struct
+ */
+static struct Compress_Struct Compress_Data;
+
+#ifdef CFITSIO
+/* internal function definitions */
+static int Compress_Image(char *filename,fitsfile *in_fp,fitsfile *out_fp,unsigned short *image_data,
+			  int ncols,int nrows,int is_primary);
+static void *Compress_Band_Thread(void *user_arg);
+static int Compress_Copy_Header(char *filename,fitsfile *in_fp,fitsfile *out_fp);
+static int Compress_Is_Structural_Keyword(char *card);
+#endif
+
+/* -----------------------------------------------------------------------------
+**     external functions
+** ----------------------------------------------------------------------------- */
+/**
+ * This routine sets up ccd_compress internal variables. Compression is off by default.
+ * It should be called at startup.
+ * @return This routine returns TRUE for success.
+ * @see #Compress_Data
+ */
+int CCD_Compress_Initialise(void)
+{
+	Compress_Error_Number = 0;
+/* print some compile time information to stdout */
+	fprintf(stdout,"CCD_Compress_Initialise:%s.\n",rcsid);
+	Compress_Data.Type = CCD_COMPRESS_TYPE_NONE;
+	Compress_Data.Thread_Count = CCD_COMPRESS_DEFAULT_THREAD_COUNT;
+	return TRUE;
+}
+
+/**
+ * Routine to configure how subsequent images are saved.
+ * @param type The compression type, CCD_COMPRESS_TYPE_NONE or CCD_COMPRESS_TYPE_RICE.
+ * @param thread_count The number of row bands (threads) to split each image into while compressing,
+ *        from 1 to CCD_COMPRESS_MAX_THREAD_COUNT.
+ * @return The routine returns TRUE on success, and FALSE if an argument is out of range.
+ * @see #Compress_Data
+ * @see #CCD_COMPRESS_IS_TYPE
+ * @see #CCD_COMPRESS_MAX_THREAD_COUNT
+ */
+int CCD_Compress_Set_Config(int type,int thread_count)
+{
+	Compress_Error_Number = 0;
+	if(!CCD_COMPRESS_IS_TYPE(type))
+	{
+		Compress_Error_Number = 1;
+		sprintf(Compress_Error_String,"CCD_Compress_Set_Config:Illegal type %d.",type);
+		return FALSE;
+	}
+	if((thread_count < 1)||(thread_count > CCD_COMPRESS_MAX_THREAD_COUNT))
+	{
+		Compress_Error_Number = 2;
+		sprintf(Compress_Error_String,"CCD_Compress_Set_Config:Illegal thread count %d (1..%d).",
+			thread_count,CCD_COMPRESS_MAX_THREAD_COUNT);
+		return FALSE;
+	}
+#ifndef CFITSIO
+	if(type != CCD_COMPRESS_TYPE_NONE)
+	{
+		Compress_Error_Number = 3;
+		sprintf(Compress_Error_String,"CCD_Compress_Set_Config:Library not compiled with CFITSIO.");
+		return FALSE;
+	}
+#endif
+	Compress_Data.Type = type;
+	Compress_Data.Thread_Count = thread_count;
+#if LOGGING > 4
+	CCD_Global_Log_Format(LOG_VERBOSITY_VERBOSE,"CCD_Compress_Set_Config:type %d:thread count %d.",type,
+			      thread_count);
+#endif
+	return TRUE;
+}
+
+/**
+ * Routine to get the configured compression type.
+ * @return The compression type, CCD_COMPRESS_TYPE_NONE or CCD_COMPRESS_TYPE_RICE.
+ * @see #Compress_Data
+ */
+int CCD_Compress_Get_Type(void)
+{
+	return Compress_Data.Type;
+}
+
+/**
+ * Routine to save image data into an existing FITS file as tile-compressed images.
+ * The existing file should contain the FITS headers for the image in it's primary HDU (any data in it is
+ * ignored).
+ * <ul>
+ * <li>A temporary file (filename with ".tmp" appended) is created, containing an empty primary HDU.
+ * <li>Compress_Image is called for each image in exposure_data_list, to add a compressed image HDU. The first
+ *     one gets a copy of the existing FITS headers.
+ * <li>The temporary file is renamed over filename.
+ * </ul>
+ * @param filename The FITS filename, which should already contain the relevant headers.
+ * @param exposure_data_list A list of images to save. The first is the primary image, the others are
+ *        saved as further image extensions (i.e. dummy amplifier data).
+ * @param exposure_data_count The number of images in exposure_data_list.
+ * @param ncols The number of columns in each image.
+ * @param nrows The number of rows in each image.
+ * @return The routine returns TRUE on success, and FALSE if an error occurs. The original file is
+ *         left unchanged if an error occurs.
+ * @see #Compress_Image
+ * @see #COMPRESS_MAX_FILENAME_LENGTH
+ */
+int CCD_Compress_Save(char *filename,unsigned short *exposure_data_list[],int exposure_data_count,
+		      int ncols,int nrows)
+{
+#ifdef CFITSIO
+	fitsfile *in_fp = NULL;
+	fitsfile *out_fp = NULL;
+	struct timespec start_time,end_time;
+	char temp_filename[COMPRESS_MAX_FILENAME_LENGTH];
+	char create_filename[COMPRESS_MAX_FILENAME_LENGTH+1];
+	char buff[32]; /* fits_get_errstatus returns 30 chars max */
+	int retval,status=0,i;
+
+	Compress_Error_Number = 0;
+	if(filename == NULL)
+	{
+		Compress_Error_Number = 4;
+		sprintf(Compress_Error_String,"CCD_Compress_Save:filename was NULL.");
+		return FALSE;
+	}
+	if(strlen(filename) > (COMPRESS_MAX_FILENAME_LENGTH-5))
+	{
+		Compress_Error_Number = 5;
+		sprintf(Compress_Error_String,"CCD_Compress_Save:filename too long (%lu).",
+			(unsigned long)strlen(filename));
+		return FALSE;
+	}
+	if((exposure_data_list == NULL)||(exposure_data_count < 1))
+	{
+		Compress_Error_Number = 6;
+		sprintf(Compress_Error_String,"CCD_Compress_Save:Illegal exposure data list (%d).",
+			exposure_data_count);
+		return FALSE;
+	}
+	clock_gettime(CLOCK_REALTIME,&start_time);
+	sprintf(temp_filename,"%s.tmp",filename);
+	/* a leading '!' tells CFITSIO to overwrite any existing file */
+	sprintf(create_filename,"!%s",temp_filename);
+	retval = fits_open_file(&in_fp,filename,READONLY,&status);
+	if(retval)
+	{
+		fits_get_errstatus(status,buff);
+		fits_report_error(stderr,status);
+		Compress_Error_Number = 7;
+		sprintf(Compress_Error_String,"CCD_Compress_Save:File open failed(%.*s,%d,%s).",
+			COMPRESS_ERROR_FILENAME_LENGTH,filename,status,buff);
+		return FALSE;
+	}
+	retval = fits_create_file(&out_fp,create_filename,&status);
+	/* empty primary HDU, the images are in the compressed image extensions */
+	if(retval == 0)
+		retval = fits_create_img(out_fp,SHORT_IMG,0,NULL,&status);
+	if(retval)
+	{
+		fits_get_errstatus(status,buff);
+		fits_report_error(stderr,status);
+		Compress_Error_Number = 8;
+		sprintf(Compress_Error_String,"CCD_Compress_Save:File create failed(%.*s,%d,%s).",
+			COMPRESS_ERROR_FILENAME_LENGTH,temp_filename,status,buff);
+		status = 0;
+		if(out_fp != NULL)
+			fits_close_file(out_fp,&status);
+		status = 0;
+		fits_close_file(in_fp,&status);
+		remove(temp_filename);
+		return FALSE;
+	}
+	for(i = 0; i < exposure_data_count; i++)
+	{
+		if(!Compress_Image(filename,in_fp,out_fp,exposure_data_list[i],ncols,nrows,(i == 0)))
+		{
+			status = 0;
+			fits_close_file(out_fp,&status);
+			status = 0;
+			fits_close_file(in_fp,&status);
+			remove(temp_filename);
+			return FALSE;
+		}
+	}
+	/* the original file was only read, so an error closing it is not important */
+	fits_close_file(in_fp,&status);
+	status = 0;
+	retval = fits_close_file(out_fp,&status);
+	if(retval)
+	{
+		fits_get_errstatus(status,buff);
+		fits_report_error(stderr,status);
+		remove(temp_filename);
+		Compress_Error_Number = 9;
+		sprintf(Compress_Error_String,"CCD_Compress_Save:File close failed(%.*s,%d,%s).",
+			COMPRESS_ERROR_FILENAME_LENGTH,temp_filename,status,buff);
+		return FALSE;
+	}
+	if(rename(temp_filename,filename) != 0)
+	{
+		Compress_Error_Number = 10;
+		sprintf(Compress_Error_String,"CCD_Compress_Save:Renaming %.*s to %.*s failed(%d).",
+			COMPRESS_ERROR_FILENAME_LENGTH,temp_filename,COMPRESS_ERROR_FILENAME_LENGTH,filename,errno);
+		remove(temp_filename);
+		return FALSE;
+	}
+	clock_gettime(CLOCK_REALTIME,&end_time);
+#if LOGGING > 4
+	CCD_Global_Log_Format(LOG_VERBOSITY_VERBOSE,"CCD_Compress_Save:Saved %d compressed images (%d,%d) to %s "
+			      "in %.3f seconds using %d threads.",exposure_data_count,ncols,nrows,filename,
+			      fdifftime(end_time,start_time),Compress_Data.Thread_Count);
+#endif
+	return TRUE;
+#else
+	Compress_Error_Number = 11;
+	sprintf(Compress_Error_String,"CCD_Compress_Save:Library not compiled with CFITSIO.");
+	return FALSE;
+#endif
+}
+
+/**
+ * Get the current value of the error number.
+ * @return The current value of the error number.
+ */
+int CCD_Compress_Get_Error_Number(void)
+{
+	return Compress_Error_Number;
+}
+
+/**
+ * The error routine that reports any errors occuring in ccd_compress in a standard way.
+ * @see ccd_global.html#CCD_Global_Get_Current_Time_String
+ * @see #Compress_Error_Number
+ * @see #Compress_Error_String
+ */
+void CCD_Compress_Error(void)
+{
+	char time_string[32];
+
+	CCD_Global_Get_Current_Time_String(time_string,32);
+	/* if the error number is zero an error message has not been set up
+	** This is in itself an error as we should not be calling this routine
+	** without there being an error to display */
+	if(Compress_Error_Number == 0)
+		sprintf(Compress_Error_String,"Logic Error:No Error defined");
+	fprintf(stderr,"%s CCD_Compress:Error(%d) : %s\n",time_string,Compress_Error_Number,Compress_Error_String);
+}
+
+/**
+ * The error routine that reports any errors occuring in ccd_compress in a standard way. This routine places the
+ * generated error string at the end of a passed in string argument.
+ * @param error_string A string to put the generated error in. This string should be initialised before
+ * 	being passed to this routine. The routine will try to concatenate it's error string onto the end
+ * 	of any string already in existance.
+ * @see ccd_global.html#CCD_Global_Get_Current_Time_String
+ */
+void CCD_Compress_Error_String(char *error_string)
+{
+	char time_string[32];
+
+	CCD_Global_Get_Current_Time_String(time_string,32);
+	/* if the error number is zero an error message has not been set up
+	** This is in itself an error as we should not be calling this routine
+	** without there being an error to display */
+	if(Compress_Error_Number == 0)
+		sprintf(Compress_Error_String,"Logic Error:No Error defined");
+	sprintf(error_string+strlen(error_string),"%s CCD_Compress:Error(%d) : %s\n",time_string,
+		Compress_Error_Number,Compress_Error_String);
+}
+
+/* -----------------------------------------------------------------------------
+** 	internal functions
+** ----------------------------------------------------------------------------- */
+#ifdef CFITSIO
+/**
+ * Compress one image, and write it as a compressed image binary table extension.
+ * <ul>
+ * <li>The image is split into Thread_Count row bands. Each band gets a buffer large enough for the worst case
+ *     (incompressible) Rice encoding of each row.
+ * <li>Bands 1.. are compressed by new threads running Compress_Band_Thread, band 0 by this thread. If a thread
+ *     cannot be started, or CFITSIO is not reentrant, the band is compressed in this thread instead.
+ * <li>The binary table is created, and the tiled image compression keywords written. For the primary image,
+ *     Compress_Copy_Header copies the existing FITS headers into it.
+ * <li>The compressed tiles are written to the table, one row per tile.
+ * </ul>
+ * @param filename The original filename, used for error messages.
+ * @param in_fp The open original file, containing the FITS headers.
+ * @param out_fp The open compressed file, positioned at the last HDU.
+ * @param image_data The image to compress.
+ * @param ncols The number of columns in the image.
+ * @param nrows The number of rows in the image.
+ * @param is_primary A boolean, TRUE if this is the primary image (the headers are copied, and ZSIMPLE written),
+ *        FALSE if it is an image extension.
+ * @return The routine returns TRUE on success, and FALSE if an error occurs.
+ * @see #Compress_Data
+ * @see #Compress_Band_Struct
+ * @see #Compress_Band_Thread
+ * @see #Compress_Copy_Header
+ * @see #COMPRESS_RICE_BLOCK_SIZE
+ * @see #COMPRESS_ERROR_FILENAME_LENGTH
+ */
+static int Compress_Image(char *filename,fitsfile *in_fp,fitsfile *out_fp,unsigned short *image_data,
+			  int ncols,int nrows,int is_primary)
+{
+	struct Compress_Band_Struct band_list[CCD_COMPRESS_MAX_THREAD_COUNT];
+	char *ttype_list[] = {"COMPRESSED_DATA"};
+	char *tform_list[] = {"1PB"};
+	char *tunit_list[] = {"\0"};
+	char buff[32]; /* fits_get_errstatus returns 30 chars max */
+	long compressed_length;
+	int band_count,band_index,band_row,row,retval,status = 0;
+	int true_value = TRUE,value,failed_row = -1,failed_status = 0,is_reentrant;
+
+	band_count = Compress_Data.Thread_Count;
+	if(band_count > nrows)
+		band_count = nrows;
+	memset(band_list,0,sizeof(band_list));
+	for(band_index = 0; band_index < band_count; band_index++)
+	{
+		band_list[band_index].Image_Data = image_data;
+		band_list[band_index].NCols = ncols;
+		band_list[band_index].Start_Row = (band_index*nrows)/band_count;
+		band_list[band_index].End_Row = ((band_index+1)*nrows)/band_count;
+		/* worst case: first value, then a 4 bit code and the raw pixels for each block */
+		band_list[band_index].Tile_Capacity = (ncols*sizeof(short))+
+			(((ncols/COMPRESS_RICE_BLOCK_SIZE)+1)*sizeof(short))+16;
+		band_list[band_index].Tile_Data = (unsigned char *)malloc(band_list[band_index].Tile_Capacity*
+			(band_list[band_index].End_Row-band_list[band_index].Start_Row));
+		band_list[band_index].Tile_Length_List = (int *)malloc(sizeof(int)*
+			(band_list[band_index].End_Row-band_list[band_index].Start_Row));
+		band_list[band_index].Failed_Row = -1;
+		if((band_list[band_index].Tile_Data == NULL)||(band_list[band_index].Tile_Length_List == NULL))
+		{
+			for(; band_index >= 0; band_index--)
+			{
+				if(band_list[band_index].Tile_Data != NULL)
+					free(band_list[band_index].Tile_Data);
+				if(band_list[band_index].Tile_Length_List != NULL)
+					free(band_list[band_index].Tile_Length_List);
+			}
+			Compress_Error_Number = 12;
+			sprintf(Compress_Error_String,"Compress_Image:Failed to allocate compressed tile buffers "
+				"(%d,%d).",ncols,nrows);
+			return FALSE;
+		}
+	}
+	/* CFITSIO can only be called from several threads at once if it was built reentrant */
+	is_reentrant = fits_is_reentrant();
+	for(band_index = 1; is_reentrant&&(band_index < band_count); band_index++)
+	{
+		retval = pthread_create(&(band_list[band_index].Thread),NULL,Compress_Band_Thread,
+					(void *)&(band_list[band_index]));
+		band_list[band_index].Thread_Started = (retval == 0);
+	}
+	Compress_Band_Thread((void *)&(band_list[0]));
+	for(band_index = 1; band_index < band_count; band_index++)
+	{
+		if(band_list[band_index].Thread_Started)
+			pthread_join(band_list[band_index].Thread,NULL);
+		else
+			Compress_Band_Thread((void *)&(band_list[band_index]));
+	}
+	for(band_index = 0; band_index < band_count; band_index++)
+	{
+		if(band_list[band_index].Failed_Row != -1)
+		{
+			failed_row = band_list[band_index].Failed_Row;
+			failed_status = band_list[band_index].Status;
+		}
+	}
+	/* create the compressed image table, and write the tiled image compression keywords */
+	retval = 0;
+	if(failed_row == -1)
+	{
+		retval = fits_create_tbl(out_fp,BINARY_TBL,nrows,1,ttype_list,tform_list,tunit_list,
+					 "COMPRESSED_IMAGE",&status);
+		if((retval == 0)&&is_primary)
+			retval = fits_update_key(out_fp,TLOGICAL,"ZSIMPLE",&true_value,"file does conform to FITS standard",
+						 &status);
+		if(retval == 0)
+			retval = fits_update_key(out_fp,TLOGICAL,"ZIMAGE",&true_value,
+						 "extension contains compressed image",&status);
+		value = 16;
+		if(retval == 0)
+			retval = fits_update_key(out_fp,TINT,"ZBITPIX",&value,"data type of original image",&status);
+		value = 2;
+		if(retval == 0)
+			retval = fits_update_key(out_fp,TINT,"ZNAXIS",&value,"dimension of original image",&status);
+		if(retval == 0)
+			retval = fits_update_key(out_fp,TINT,"ZNAXIS1",&ncols,"length of original image axis",&status);
+		if(retval == 0)
+			retval = fits_update_key(out_fp,TINT,"ZNAXIS2",&nrows,"length of original image axis",&status);
+		if(retval == 0)
+			retval = fits_update_key(out_fp,TINT,"ZTILE1",&ncols,"size of tiles to be compressed",&status);
+		value = 1;
+		if(retval == 0)
+			retval = fits_update_key(out_fp,TINT,"ZTILE2",&value,"size of tiles to be compressed",&status);
+		if(retval == 0)
+			retval = fits_update_key(out_fp,TSTRING,"ZCMPTYPE","RICE_1","compression algorithm",&status);
+		if(retval == 0)
+			retval = fits_update_key(out_fp,TSTRING,"ZNAME1","BLOCKSIZE","compression block size",&status);
+		value = COMPRESS_RICE_BLOCK_SIZE;
+		if(retval == 0)
+			retval = fits_update_key(out_fp,TINT,"ZVAL1",&value,"pixels per block",&status);
+		if(retval == 0)
+			retval = fits_update_key(out_fp,TSTRING,"ZNAME2","BYTEPIX","bytes per pixel (1, 2, 4, or 8)",
+						 &status);
+		value = sizeof(short);
+		if(retval == 0)
+			retval = fits_update_key(out_fp,TINT,"ZVAL2",&value,"bytes per pixel (1, 2, 4, or 8)",&status);
+		/* tiles are stored as signed shorts, offset by BZERO */
+		value = 32768;
+		if(retval == 0)
+			retval = fits_update_key(out_fp,TINT,"BZERO",&value,"offset data range to that of unsigned short",
+						 &status);
+		value = 1;
+		if(retval == 0)
+			retval = fits_update_key(out_fp,TINT,"BSCALE",&value,"default scaling factor",&status);
+		if(retval)
+		{
+			fits_get_errstatus(status,buff);
+			fits_report_error(stderr,status);
+		}
+	}
+	if((failed_row == -1)&&(retval == 0)&&is_primary)
+	{
+		if(!Compress_Copy_Header(filename,in_fp,out_fp))
+			retval = -1;
+	}
+	/* write the compressed tiles in row order */
+	for(band_index = 0; (failed_row == -1)&&(retval == 0)&&(band_index < band_count); band_index++)
+	{
+		for(row = band_list[band_index].Start_Row; (retval == 0)&&(row < band_list[band_index].End_Row); row++)
+		{
+			band_row = row-band_list[band_index].Start_Row;
+			compressed_length = band_list[band_index].Tile_Length_List[band_row];
+			retval = fits_write_col(out_fp,TBYTE,1,row+1,1,compressed_length,
+						band_list[band_index].Tile_Data+(band_row*band_list[band_index].Tile_Capacity),
+						&status);
+			if(retval)
+			{
+				fits_get_errstatus(status,buff);
+				fits_report_error(stderr,status);
+			}
+		}
+	}
+	for(band_index = 0; band_index < band_count; band_index++)
+	{
+		free(band_list[band_index].Tile_Data);
+		free(band_list[band_index].Tile_Length_List);
+	}
+	if(failed_row != -1)
+	{
+		Compress_Error_Number = 13;
+		sprintf(Compress_Error_String,"Compress_Image:Failed to compress row %d of %.*s(%d).",failed_row,
+			COMPRESS_ERROR_FILENAME_LENGTH,filename,failed_status);
+		return FALSE;
+	}
+	if(retval == -1) /* Compress_Copy_Header failed, and set the error */
+		return FALSE;
+	if(retval)
+	{
+		Compress_Error_Number = 14;
+		sprintf(Compress_Error_String,"Compress_Image:Writing compressed image failed(%.*s,%d,%s).",
+			COMPRESS_ERROR_FILENAME_LENGTH,filename,status,buff);
+		return FALSE;
+	}
+	return TRUE;
+}
+
+/**
+ * Thread routine to Rice compress each row of one row band of an image. The band is written to a new in-memory
+ * FITS file as a tile-compressed image (one tile per row, RICE_1), so CFITSIO does the compression (including
+ * the BZERO offset of the unsigned pixel values to signed shorts, and CFITSIO's default Rice block size is
+ * COMPRESS_RICE_BLOCK_SIZE). Each compressed tile is then read back from the
+ * COMPRESSED_DATA column of the in-memory file's compressed image table, into it's slot in Tile_Data.
+ * Each thread uses it's own fitsfile, so this is safe to run in parallel with a reentrant CFITSIO.
+ * @param user_arg A pointer to the Compress_Band_Struct for this band. Tile_Length_List is filled in,
+ *        and Failed_Row and Status set if a row fails to compress.
+ * @return The routine returns NULL.
+ * @see #COMPRESS_RICE_BLOCK_SIZE
+ */
+static void *Compress_Band_Thread(void *user_arg)
+{
+	struct Compress_Band_Struct *band = (struct Compress_Band_Struct *)user_arg;
+	fitsfile *band_fp = NULL;
+	long naxes[2],tile_dim[2];
+	long compressed_length,heap_offset;
+	int band_row_count,band_row = 0,column,retval,status = 0;
+
+	band_row_count = band->End_Row-band->Start_Row;
+	naxes[0] = band->NCols;
+	naxes[1] = band_row_count;
+	tile_dim[0] = band->NCols;
+	tile_dim[1] = 1;
+	retval = fits_create_file(&band_fp,"mem://",&status);
+	if(retval == 0)
+		retval = fits_set_compression_type(band_fp,RICE_1,&status);
+	if(retval == 0)
+		retval = fits_set_tile_dim(band_fp,2,tile_dim,&status);
+	if(retval == 0)
+		retval = fits_create_img(band_fp,USHORT_IMG,2,naxes,&status);
+	/* tiles are compressed as they are written */
+	if(retval == 0)
+	{
+		retval = fits_write_img(band_fp,TUSHORT,1,((long)band->NCols)*((long)band_row_count),
+					band->Image_Data+(((size_t)band->Start_Row)*((size_t)band->NCols)),&status);
+	}
+	if(retval == 0)
+		retval = fits_get_colnum(band_fp,CASEINSEN,"COMPRESSED_DATA",&column,&status);
+	for(band_row = 0; (retval == 0)&&(band_row < band_row_count); band_row++)
+	{
+		retval = fits_read_descript(band_fp,column,band_row+1,&compressed_length,&heap_offset,&status);
+		if((retval == 0)&&(compressed_length > band->Tile_Capacity))
+		{
+			retval = -1;
+			break;
+		}
+		if(retval == 0)
+		{
+			retval = fits_read_col(band_fp,TBYTE,column,band_row+1,1,compressed_length,NULL,
+					       band->Tile_Data+(band_row*band->Tile_Capacity),NULL,&status);
+		}
+		if(retval == 0)
+			band->Tile_Length_List[band_row] = (int)compressed_length;
+	}
+	if(retval != 0)
+	{
+		band->Failed_Row = band->Start_Row+band_row;
+		band->Status = status;
+	}
+	if(band_fp != NULL)
+	{
+		status = 0;
+		fits_close_file(band_fp,&status);
+	}
+	return NULL;
+}
+
+/**
+ * Copy the FITS headers from the primary HDU of the original file into the compressed image HDU.
+ * Structural keywords (describing the original primary HDU's data layout) are not copied,
+ * see Compress_Is_Structural_Keyword.
+ * @param filename The original filename, used for error messages.
+ * @param in_fp The open original file.
+ * @param out_fp The open compressed file, positioned at the compressed image HDU.
+ * @return The routine returns TRUE on success, and FALSE if an error occurs.
+ * @see #Compress_Is_Structural_Keyword
+ * @see #COMPRESS_CARD_LENGTH
+ */
+static int Compress_Copy_Header(char *filename,fitsfile *in_fp,fitsfile *out_fp)
+{
+	char card[COMPRESS_CARD_LENGTH];
+	char buff[32]; /* fits_get_errstatus returns 30 chars max */
+	int keyword_count,i,retval,status = 0;
+
+	retval = fits_get_hdrspace(in_fp,&keyword_count,NULL,&status);
+	for(i = 1; (retval == 0)&&(i <= keyword_count); i++)
+	{
+		retval = fits_read_record(in_fp,i,card,&status);
+		if((retval == 0)&&(Compress_Is_Structural_Keyword(card) == FALSE))
+			retval = fits_write_record(out_fp,card,&status);
+	}
+	if(retval)
+	{
+		fits_get_errstatus(status,buff);
+		fits_report_error(stderr,status);
+		Compress_Error_Number = 15;
+		sprintf(Compress_Error_String,"Compress_Copy_Header:Copying headers failed(%.*s,%d,%s).",
+			COMPRESS_ERROR_FILENAME_LENGTH,filename,status,buff);
+		return FALSE;
+	}
+	return TRUE;
+}
+
+/**
+ * Return whether a FITS header card is a structural keyword of the original primary HDU, which
+ * should not be copied into the compressed image HDU.
+ * @param card The FITS header card.
+ * @return TRUE if the card is SIMPLE, BITPIX, NAXIS, NAXISn, EXTEND, BZERO, BSCALE, PCOUNT, GCOUNT or END.
+ */
+static int Compress_Is_Structural_Keyword(char *card)
+{
+	char *keyword_list[] = {"SIMPLE  ","BITPIX  ","NAXIS   ","EXTEND  ","BZERO   ","BSCALE  ","PCOUNT  ",
+				"GCOUNT  ","END     "};
+	size_t i;
+
+	for(i = 0; i < (sizeof(keyword_list)/sizeof(keyword_list[0])); i++)
+	{
+		if(strncmp(card,keyword_list[i],8) == 0)
+			return TRUE;
+	}
+	/* NAXIS1, NAXIS2 ... */
+	if((strncmp(card,"NAXIS",5) == 0)&&(card[5] >= '0')&&(card[5] <= '9'))
+		return TRUE;
+	return FALSE;
+}
+#endif
+
+/*
+** $Log: not supported by cvs2svn $
+*/
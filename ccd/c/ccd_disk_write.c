@@ -0,0 +1,515 @@
+/* ccd_disk_write.c
+** Direct to disc FITS image data writing module.
+** $Header$
+*/
+/**
+ * ccd_disk_write holds the routines for writing read out image data into a FITS file without going through
+ * CFITSIO's buffered I/O and the page cache. A full frame is 34-68Mb, and writing it through the page cache
+ * leaves that much dirty data for the kernel to write back, often during the next readout.
+ * <ul>
+ * <li>The FITS headers are written by CFITSIO as before. The image data is then written directly after them,
+ *     converted to FITS format (big endian, BZERO = 32768) a chunk at a time into an aligned buffer.
+ * <li>The file is opened with O_DIRECT, and the data area preallocated (fallocate) before writing.
+ *     If the filesystem does not support O_DIRECT, normal writes are used and the written pages dropped
+ *     from the page cache afterwards (posix_fadvise).
+ * <li>The file is synchronised to disc according to the configured fsync policy.
+ * <li>The time taken to write each frame is kept, so latency percentiles can be reported.
+ * </ul>
+ * io_uring is not used, the instrument computer's kernel predates it, and each frame is a single sequential
+ * write where O_DIRECT already avoids the copy through the page cache.
+ * @author Chris Mottram
+ * @version $Revision$
+ */
+/**
+ * This hash define is needed before including source files to give us O_DIRECT, fallocate and posix_memalign.
+ */
+#define _GNU_SOURCE 1
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include "log_udp.h"
+#include "ccd_global.h"
+#include "ccd_disk_write.h"
+
+/**
+ * Revision Control System identifier.
+ */
+static char rcsid[] = "$Id$";
+
+/* hash defines */
+/**
+ * The alignment, in bytes, of the file offsets, lengths and buffer addresses used with O_DIRECT.
+ * This is a multiple of the logical block size of any disc the instrument is likely to use.
+ */
+#define DISK_WRITE_ALIGNMENT		(4096)
+/**
+ * The length of the aligned buffer the image data is converted into and written from, in bytes.
+ * This must be a multiple of DISK_WRITE_ALIGNMENT.
+ * @see #DISK_WRITE_ALIGNMENT
+ */
+#define DISK_WRITE_CHUNK_LENGTH		(4*1024*1024)
+/**
+ * The length of a FITS logical record, in bytes. The data unit is padded to a multiple of this.
+ */
+#define DISK_WRITE_FITS_BLOCK_LENGTH	(2880)
+
+/* data types */
+/**
+ * Data type holding local data to ccd_disk_write. This consists of the following:
+ * <dl>
+ * <dt>Enable</dt> <dd>A boolean, whether image data should be written using CCD_Disk_Write_Save.</dd>
+ * <dt>Fsync_Policy</dt> <dd>How the file is synchronised to disc after writing, one of CCD_DISK_WRITE_FSYNC_*.</dd>
+ * <dt>Buffer</dt> <dd>The DISK_WRITE_ALIGNMENT aligned buffer data is written from, allocated on first use.</dd>
+ * <dt>Latency_List</dt> <dd>A ring of the last CCD_DISK_WRITE_LATENCY_SAMPLE_COUNT frame write times,
+ *     in seconds.</dd>
+ * <dt>Latency_Count</dt> <dd>The total number of frames written. Latency_Count modulo
+ *     CCD_DISK_WRITE_LATENCY_SAMPLE_COUNT is the next ring index to write.</dd>
+ * <dt>Latency_Mutex</dt> <dd>Protects Latency_List and Latency_Count, which are read by the status thread.</dd>
+ * </dl>
+ * @see #CCD_DISK_WRITE_LATENCY_SAMPLE_COUNT
+ */
+struct Disk_Write_Struct
+{
+	int Enable;
+	int Fsync_Policy;
+	unsigned char *Buffer;
+	double Latency_List[CCD_DISK_WRITE_LATENCY_SAMPLE_COUNT];
+	int Latency_Count;
+	pthread_mutex_t Latency_Mutex;
+};
+
+/* internal variables */
+/**
+ * Variable holding error code of last operation performed by ccd_disk_write.
+ */
+static int Disk_Write_Error_Number = 0;
+/**
+ * Local variable holding description of the last error that occured.
+ */
+static char Disk_Write_Error_String[CCD_GLOBAL_ERROR_STRING_LENGTH] = "";
+/**
+ * Local disk write data.
+ * @see #Disk_Write_Struct
+ */
+static struct Disk_Write_Struct Disk_Write_Data =
+{
+	FALSE,CCD_DISK_WRITE_FSYNC_NONE,NULL,{0.0},0,PTHREAD_MUTEX_INITIALIZER
+};
+
+/* internal function definitions */
+static void Disk_Write_Fill(unsigned char *buffer,size_t length,unsigned short *image_data,size_t pixel_count,
+			    size_t data_byte_index);
+static int Disk_Write_Buffer(int fd,unsigned char *buffer,size_t length,off_t offset);
+
+/* -----------------------------------------------------------------------------
+**     external functions
+** ----------------------------------------------------------------------------- */
+/**
+ * This routine sets up ccd_disk_write internal variables. Direct writing is off by default, and the
+ * latency statistics are reset. It should be called at startup.
+ * @return This routine returns TRUE for success.
+ * @see #Disk_Write_Data
+ */
+int CCD_Disk_Write_Initialise(void)
+{
+	Disk_Write_Error_Number = 0;
+/* print some compile time information to stdout */
+	fprintf(stdout,"CCD_Disk_Write_Initialise:%s.\n",rcsid);
+	Disk_Write_Data.Enable = FALSE;
+	Disk_Write_Data.Fsync_Policy = CCD_DISK_WRITE_FSYNC_NONE;
+	pthread_mutex_lock(&(Disk_Write_Data.Latency_Mutex));
+	Disk_Write_Data.Latency_Count = 0;
+	pthread_mutex_unlock(&(Disk_Write_Data.Latency_Mutex));
+	return TRUE;
+}
+
+/**
+ * Routine to configure whether subsequent images are written with CCD_Disk_Write_Save.
+ * @param enable A boolean, TRUE to write image data directly to disc, FALSE to write it through CFITSIO.
+ * @param fsync_policy How each file is synchronised to disc, one of CCD_DISK_WRITE_FSYNC_NONE,
+ *        CCD_DISK_WRITE_FSYNC_DATA or CCD_DISK_WRITE_FSYNC_FULL.
+ * @return The routine returns TRUE on success, and FALSE if an argument is out of range.
+ * @see #Disk_Write_Data
+ * @see #CCD_DISK_WRITE_IS_FSYNC
+ */
+int CCD_Disk_Write_Set_Config(int enable,int fsync_policy)
+{
+	Disk_Write_Error_Number = 0;
+	if(!CCD_GLOBAL_IS_BOOLEAN(enable))
+	{
+		Disk_Write_Error_Number = 1;
+		sprintf(Disk_Write_Error_String,"CCD_Disk_Write_Set_Config:Illegal enable %d.",enable);
+		return FALSE;
+	}
+	if(!CCD_DISK_WRITE_IS_FSYNC(fsync_policy))
+	{
+		Disk_Write_Error_Number = 2;
+		sprintf(Disk_Write_Error_String,"CCD_Disk_Write_Set_Config:Illegal fsync policy %d.",fsync_policy);
+		return FALSE;
+	}
+	Disk_Write_Data.Enable = enable;
+	Disk_Write_Data.Fsync_Policy = fsync_policy;
+#if LOGGING > 4
+	CCD_Global_Log_Format(LOG_VERBOSITY_VERBOSE,"CCD_Disk_Write_Set_Config:enable %d:fsync policy %d.",enable,
+			      fsync_policy);
+#endif
+	return TRUE;
+}
+
+/**
+ * Routine to get whether image data is written with CCD_Disk_Write_Save.
+ * @return A boolean, TRUE if image data should be written with CCD_Disk_Write_Save.
+ * @see #Disk_Write_Data
+ */
+int CCD_Disk_Write_Get_Enable(void)
+{
+	return Disk_Write_Data.Enable;
+}
+
+/**
+ * Routine to write image data into the data unit of an existing FITS file. The file's primary header must
+ * already be complete (BITPIX = 16, BZERO = 32768, NAXIS1 = ncols, NAXIS2 = nrows), and the data unit must
+ * start at data_offset. Anything already in the file after data_offset is overwritten.
+ * <ul>
+ * <li>The file is opened with O_DIRECT (or without, if the filesystem does not support it).
+ * <li>The data unit (padded to a FITS block) is preallocated with fallocate, where supported.
+ * <li>If data_offset is not aligned, the header bytes in the first aligned block are read, so they can be
+ *     rewritten along with the start of the data.
+ * <li>Each chunk is filled by Disk_Write_Fill, and written with Disk_Write_Buffer.
+ * <li>The file is truncated to the end of the padded data unit, as the last aligned write may extend past it.
+ * <li>The file is synchronised according to the fsync policy, and closed.
+ * <li>The time taken is added to the latency ring.
+ * </ul>
+ * @param filename The FITS filename.
+ * @param data_offset The offset of the start of the primary data unit in the file, in bytes.
+ * @param image_data The image data to write.
+ * @param ncols The number of columns in the image.
+ * @param nrows The number of rows in the image.
+ * @return The routine returns TRUE on success, and FALSE if an error occurs.
+ * @see #Disk_Write_Data
+ * @see #Disk_Write_Fill
+ * @see #Disk_Write_Buffer
+ * @see #DISK_WRITE_ALIGNMENT
+ * @see #DISK_WRITE_CHUNK_LENGTH
+ * @see #DISK_WRITE_FITS_BLOCK_LENGTH
+ */
+int CCD_Disk_Write_Save(char *filename,long long data_offset,unsigned short *image_data,int ncols,int nrows)
+{
+	struct timespec start_time,end_time;
+	size_t pixel_count,data_length,chunk_length,buffer_start;
+	off_t aligned_start,file_end,write_end,chunk_offset;
+	ssize_t read_length;
+	double latency;
+	int fd,direct,retval;
+
+	Disk_Write_Error_Number = 0;
+	if(filename == NULL)
+	{
+		Disk_Write_Error_Number = 3;
+		sprintf(Disk_Write_Error_String,"CCD_Disk_Write_Save:filename was NULL.");
+		return FALSE;
+	}
+	if(image_data == NULL)
+	{
+		Disk_Write_Error_Number = 4;
+		sprintf(Disk_Write_Error_String,"CCD_Disk_Write_Save:image data was NULL.");
+		return FALSE;
+	}
+	/* the data unit starts on a FITS block boundary, so is always pixel aligned */
+	if((data_offset < 0)||((data_offset % DISK_WRITE_FITS_BLOCK_LENGTH) != 0))
+	{
+		Disk_Write_Error_Number = 5;
+		sprintf(Disk_Write_Error_String,"CCD_Disk_Write_Save:Illegal data offset %lld.",data_offset);
+		return FALSE;
+	}
+	if(Disk_Write_Data.Buffer == NULL)
+	{
+		retval = posix_memalign((void**)&(Disk_Write_Data.Buffer),DISK_WRITE_ALIGNMENT,DISK_WRITE_CHUNK_LENGTH);
+		if(retval != 0)
+		{
+			Disk_Write_Data.Buffer = NULL;
+			Disk_Write_Error_Number = 6;
+			sprintf(Disk_Write_Error_String,"CCD_Disk_Write_Save:Failed to allocate buffer(%d).",retval);
+			return FALSE;
+		}
+	}
+	clock_gettime(CLOCK_REALTIME,&start_time);
+	pixel_count = ((size_t)ncols)*((size_t)nrows);
+	data_length = pixel_count*sizeof(unsigned short);
+	data_length = ((data_length+DISK_WRITE_FITS_BLOCK_LENGTH-1)/DISK_WRITE_FITS_BLOCK_LENGTH)*
+		DISK_WRITE_FITS_BLOCK_LENGTH;
+	aligned_start = (((off_t)data_offset)/DISK_WRITE_ALIGNMENT)*DISK_WRITE_ALIGNMENT;
+	file_end = ((off_t)data_offset)+((off_t)data_length);
+	write_end = ((file_end+DISK_WRITE_ALIGNMENT-1)/DISK_WRITE_ALIGNMENT)*DISK_WRITE_ALIGNMENT;
+	/* open the file */
+	direct = TRUE;
+	fd = open(filename,O_RDWR|O_DIRECT);
+	if((fd < 0)&&(errno == EINVAL))
+	{
+#if LOGGING > 4
+		CCD_Global_Log_Format(LOG_VERBOSITY_VERBOSE,"CCD_Disk_Write_Save:%s does not support O_DIRECT.",
+				      filename);
+#endif
+		direct = FALSE;
+		fd = open(filename,O_RDWR);
+	}
+	if(fd < 0)
+	{
+		Disk_Write_Error_Number = 7;
+		sprintf(Disk_Write_Error_String,"CCD_Disk_Write_Save:Failed to open %s(%d).",filename,errno);
+		return FALSE;
+	}
+	/* preallocate the data unit, so the filesystem can lay it out contiguously */
+#ifdef FALLOC_FL_KEEP_SIZE
+	if(fallocate(fd,0,(off_t)data_offset,(off_t)data_length) != 0)
+	{
+		if((errno != EOPNOTSUPP)&&(errno != ENOSYS))
+		{
+			Disk_Write_Error_Number = 8;
+			sprintf(Disk_Write_Error_String,"CCD_Disk_Write_Save:Failed to preallocate %s(%lu,%d).",
+				filename,(unsigned long)data_length,errno);
+			close(fd);
+			return FALSE;
+		}
+	}
+#endif
+	/* keep the end of the header that shares the first aligned block with the data */
+	buffer_start = (size_t)(((off_t)data_offset)-aligned_start);
+	if(buffer_start > 0)
+	{
+		read_length = pread(fd,Disk_Write_Data.Buffer,DISK_WRITE_ALIGNMENT,aligned_start);
+		if(read_length < (ssize_t)buffer_start)
+		{
+			Disk_Write_Error_Number = 9;
+			sprintf(Disk_Write_Error_String,"CCD_Disk_Write_Save:Failed to read header of %s(%ld,%d).",
+				filename,(long)read_length,errno);
+			close(fd);
+			return FALSE;
+		}
+	}
+	/* convert and write the data a chunk at a time */
+	for(chunk_offset = aligned_start; chunk_offset < write_end; chunk_offset += chunk_length)
+	{
+		chunk_length = DISK_WRITE_CHUNK_LENGTH;
+		if(((off_t)chunk_length) > (write_end-chunk_offset))
+			chunk_length = (size_t)(write_end-chunk_offset);
+		Disk_Write_Fill(Disk_Write_Data.Buffer+buffer_start,chunk_length-buffer_start,image_data,pixel_count,
+				(size_t)(chunk_offset+buffer_start-data_offset));
+		if(!Disk_Write_Buffer(fd,Disk_Write_Data.Buffer,chunk_length,chunk_offset))
+		{
+			Disk_Write_Error_Number = 10;
+			sprintf(Disk_Write_Error_String,"CCD_Disk_Write_Save:Failed to write %s(%ld,%lu,%d).",
+				filename,(long)chunk_offset,(unsigned long)chunk_length,errno);
+			close(fd);
+			return FALSE;
+		}
+		buffer_start = 0;
+	}
+	/* the last aligned write may go past the end of the FITS data unit */
+	if(ftruncate(fd,file_end) != 0)
+	{
+		Disk_Write_Error_Number = 11;
+		sprintf(Disk_Write_Error_String,"CCD_Disk_Write_Save:Failed to truncate %s(%ld,%d).",filename,
+			(long)file_end,errno);
+		close(fd);
+		return FALSE;
+	}
+	if(Disk_Write_Data.Fsync_Policy == CCD_DISK_WRITE_FSYNC_DATA)
+		retval = fdatasync(fd);
+	else if(Disk_Write_Data.Fsync_Policy == CCD_DISK_WRITE_FSYNC_FULL)
+		retval = fsync(fd);
+	else
+		retval = 0;
+	if(retval != 0)
+	{
+		Disk_Write_Error_Number = 12;
+		sprintf(Disk_Write_Error_String,"CCD_Disk_Write_Save:Failed to synchronise %s(%d,%d).",filename,
+			Disk_Write_Data.Fsync_Policy,errno);
+		close(fd);
+		return FALSE;
+	}
+	/* without O_DIRECT, drop the (now clean) written pages from the page cache */
+	if(direct == FALSE)
+		posix_fadvise(fd,0,0,POSIX_FADV_DONTNEED);
+	if(close(fd) != 0)
+	{
+		Disk_Write_Error_Number = 13;
+		sprintf(Disk_Write_Error_String,"CCD_Disk_Write_Save:Failed to close %s(%d).",filename,errno);
+		return FALSE;
+	}
+	clock_gettime(CLOCK_REALTIME,&end_time);
+	latency = fdifftime(end_time,start_time);
+	pthread_mutex_lock(&(Disk_Write_Data.Latency_Mutex));
+	Disk_Write_Data.Latency_List[Disk_Write_Data.Latency_Count%CCD_DISK_WRITE_LATENCY_SAMPLE_COUNT] = latency;
+	Disk_Write_Data.Latency_Count++;
+	pthread_mutex_unlock(&(Disk_Write_Data.Latency_Mutex));
+#if LOGGING > 4
+	CCD_Global_Log_Format(LOG_VERBOSITY_VERBOSE,"CCD_Disk_Write_Save:Wrote %lu bytes to %s in %.3f seconds"
+			      "(direct = %d,fsync policy = %d).",(unsigned long)data_length,filename,latency,direct,
+			      Disk_Write_Data.Fsync_Policy);
+#endif
+	return TRUE;
+}
+
+/**
+ * Routine to get a percentile of the recent per-frame write latencies (the time CCD_Disk_Write_Save took),
+ * from the last CCD_DISK_WRITE_LATENCY_SAMPLE_COUNT frames written. The nearest rank method is used.
+ * @param percentile The percentile to get, from 0 to 100 (i.e. 50 for the median, 100 for the maximum).
+ * @param latency The address of a double, on return set to the latency percentile in seconds, or 0.0 if no frames
+ *        have been written.
+ * @param sample_count The address of an integer, on return set to the number of latencies the percentile
+ *        was computed from.
+ * @return The routine returns TRUE on success, and FALSE if an argument is out of range.
+ * @see #Disk_Write_Data
+ * @see ccd_global.html#CCD_Global_Percentile
+ */
+int CCD_Disk_Write_Latency_Get(double percentile,double *latency,int *sample_count)
+{
+	double latency_list[CCD_DISK_WRITE_LATENCY_SAMPLE_COUNT];
+	int count;
+
+	Disk_Write_Error_Number = 0;
+	if((percentile < 0.0)||(percentile > 100.0))
+	{
+		Disk_Write_Error_Number = 14;
+		sprintf(Disk_Write_Error_String,"CCD_Disk_Write_Latency_Get:Illegal percentile %.2f.",percentile);
+		return FALSE;
+	}
+	if((latency == NULL)||(sample_count == NULL))
+	{
+		Disk_Write_Error_Number = 15;
+		sprintf(Disk_Write_Error_String,"CCD_Disk_Write_Latency_Get:Illegal pointer argument.");
+		return FALSE;
+	}
+	pthread_mutex_lock(&(Disk_Write_Data.Latency_Mutex));
+	count = Disk_Write_Data.Latency_Count;
+	if(count > CCD_DISK_WRITE_LATENCY_SAMPLE_COUNT)
+		count = CCD_DISK_WRITE_LATENCY_SAMPLE_COUNT;
+	memcpy(latency_list,Disk_Write_Data.Latency_List,count*sizeof(double));
+	pthread_mutex_unlock(&(Disk_Write_Data.Latency_Mutex));
+	(*sample_count) = count;
+	(*latency) = CCD_Global_Percentile(latency_list,count,percentile);
+	return TRUE;
+}
+
+/**
+ * Get the current value of the error number.
+ * @return The current value of the error number.
+ */
+int CCD_Disk_Write_Get_Error_Number(void)
+{
+	return Disk_Write_Error_Number;
+}
+
+/**
+ * The error routine that reports any errors occuring in ccd_disk_write in a standard way.
+ * @see ccd_global.html#CCD_Global_Get_Current_Time_String
+ * @see #Disk_Write_Error_Number
+ * @see #Disk_Write_Error_String
+ */
+void CCD_Disk_Write_Error(void)
+{
+	char time_string[32];
+
+	CCD_Global_Get_Current_Time_String(time_string,32);
+	/* if the error number is zero an error message has not been set up
+	** This is in itself an error as we should not be calling this routine
+	** without there being an error to display */
+	if(Disk_Write_Error_Number == 0)
+		sprintf(Disk_Write_Error_String,"Logic Error:No Error defined");
+	fprintf(stderr,"%s CCD_Disk_Write:Error(%d) : %s\n",time_string,Disk_Write_Error_Number,
+		Disk_Write_Error_String);
+}
+
+/**
+ * The error routine that reports any errors occuring in ccd_disk_write in a standard way. This routine places the
+ * generated error string at the end of a passed in string argument.
+ * @param error_string A string to put the generated error in. This string should be initialised before
+ * 	being passed to this routine. The routine will try to concatenate it's error string onto the end
+ * 	of any string already in existance.
+ * @see ccd_global.html#CCD_Global_Get_Current_Time_String
+ */
+void CCD_Disk_Write_Error_String(char *error_string)
+{
+	char time_string[32];
+
+	CCD_Global_Get_Current_Time_String(time_string,32);
+	/* if the error number is zero an error message has not been set up
+	** This is in itself an error as we should not be calling this routine
+	** without there being an error to display */
+	if(Disk_Write_Error_Number == 0)
+		sprintf(Disk_Write_Error_String,"Logic Error:No Error defined");
+	sprintf(error_string+strlen(error_string),"%s CCD_Disk_Write:Error(%d) : %s\n",time_string,
+		Disk_Write_Error_Number,Disk_Write_Error_String);
+}
+
+/* -----------------------------------------------------------------------------
+** 	internal functions
+** ----------------------------------------------------------------------------- */
+/**
+ * Fill a buffer with part of the FITS data unit for some image data. Each pixel is stored as a big endian
+ * signed short with BZERO = 32768 (i.e. the top bit is inverted). Bytes past the end of the image data
+ * (the FITS block padding, and any alignment padding) are set to zero.
+ * @param buffer The buffer to fill.
+ * @param length The number of bytes to fill.
+ * @param image_data The image data.
+ * @param pixel_count The number of pixels in image_data.
+ * @param data_byte_index The byte index in the data unit of the first byte in the buffer. This must be even.
+ */
+static void Disk_Write_Fill(unsigned char *buffer,size_t length,unsigned short *image_data,size_t pixel_count,
+			    size_t data_byte_index)
+{
+	size_t pixel_index,i;
+
+	pixel_index = data_byte_index/2;
+	for(i = 0; (i+1 < length)&&(pixel_index < pixel_count); i += 2, pixel_index++)
+	{
+		buffer[i] = (unsigned char)(((image_data[pixel_index] >> 8)&0xff)^0x80);
+		buffer[i+1] = (unsigned char)(image_data[pixel_index]&0xff);
+	}
+	if(i < length)
+		memset(buffer+i,0,length-i);
+}
+
+/**
+ * Write a buffer to a file descriptor at an offset, retrying partial writes.
+ * @param fd The file descriptor.
+ * @param buffer The buffer to write.
+ * @param length The number of bytes to write.
+ * @param offset The file offset to write them at.
+ * @return The routine returns TRUE on success, and FALSE if a write fails (errno is set).
+ */
+static int Disk_Write_Buffer(int fd,unsigned char *buffer,size_t length,off_t offset)
+{
+	ssize_t write_length;
+	size_t done_length = 0;
+
+	while(done_length < length)
+	{
+		write_length = pwrite(fd,buffer+done_length,length-done_length,offset+done_length);
+		if(write_length < 0)
+		{
+			if(errno == EINTR)
+				continue;
+			return FALSE;
+		}
+		if(write_length == 0)
+		{
+			errno = EIO;
+			return FALSE;
+		}
+		done_length += write_length;
+	}
+	return TRUE;
+}
+
+/*
+** $Log: not supported by cvs2svn $
+*/
@@ -15,9 +15,9 @@
 #define _POSIX_SOURCE 1
 /**
  * This hash define is needed before including source files give us POSIX.4/IEEE1003.1b-1993 prototypes
- * for clock_gettime.
+ * for clock_gettime, and IEEE1003.1-2001 prototypes for pthread_condattr_setclock.
  */
-#define _POSIX_C_SOURCE 199309L
+#define _POSIX_C_SOURCE 200112L
 
 #include <errno.h>
 #include <fcntl.h>
@@ -30,9 +30,7 @@
 #ifndef _POSIX_TIMERS
 #include <sys/time.h>
 #endif
-#ifdef CCD_DSP_MUTEXED
 #include <pthread.h>
-#endif
 #include "log_udp.h"
 #include "ccd_global.h"
 #include "ccd_interface.h"
@@ -40,6 +38,7 @@
 #include "ccd_dsp.h"
 #include "ccd_exposure.h"
 #include "ccd_filter_wheel.h"
+#include "ccd_trace.h"
 
 /**
  * Revision Control System identifier.
@@ -54,12 +53,27 @@ static char rcsid[] = "$Id: ccd_dsp.c,v 1.5 2013-03-25 15:15:03 cjm Exp $";
  * @see #CCD_DSP_DON
  */
 #define	DSP_ACTUAL_VALUE 		-1 /* flag indicating return value of DSP command is to be returned as data */
+/**
+ * The longest time, in nanoseconds, the final approach to a timed exposure start sleeps for, before checking
+ * whether the exposure has been aborted.
+ * @see #DSP_Send_Sex
+ */
+#define DSP_START_APPROACH_SLICE_NS	(10000000)
 
 /* structure */
 /**
  * Structure used to hold local data to ccd_dsp.
  * <dl>
  * <dt>Abort</dt> <dd>Whether it has been requested to abort the current operation.</dd>
+ * <dt>Abort_Mutex</dt> <dd>Protects setting Abort, and the abort latency data, and is used with Abort_Condition.</dd>
+ * <dt>Abort_Condition</dt> <dd>Broadcast when Abort is set, to wake threads sleeping in CCD_DSP_Abort_Sleep.
+ *     It uses CLOCK_MONOTONIC, and is initialised once by DSP_Abort_Condition_Initialise.</dd>
+ * <dt>Abort_Pending</dt> <dd>A boolean, TRUE if an abort has been requested, and the aborted operation
+ *     has not yet returned (CCD_DSP_Abort_Complete).</dd>
+ * <dt>Abort_Request_Time</dt> <dd>When the pending abort was requested (CLOCK_MONOTONIC).</dd>
+ * <dt>Abort_Latency_List</dt> <dd>A ring of the last CCD_DSP_ABORT_LATENCY_SAMPLE_COUNT abort latencies,
+ *     the time from the abort request to the aborted operation returning, in seconds.</dd>
+ * <dt>Abort_Latency_Count</dt> <dd>The number of abort latencies added to Abort_Latency_List.</dd>
  * <dt>Mutex</dt> <dd>Optionally compiled mutex locking for sending commands and getting replies from the 
  * 	controller.</dd>
  * </dl>
@@ -67,6 +81,12 @@ static char rcsid[] = "$Id: ccd_dsp.c,v 1.5 2013-03-25 15:15:03 cjm Exp $";
 struct DSP_Attr_Struct
 {
 	volatile int Abort; /* This is volatile as a different thread may change this variable. */
+	pthread_mutex_t Abort_Mutex;
+	pthread_cond_t Abort_Condition;
+	int Abort_Pending;
+	struct timespec Abort_Request_Time;
+	double Abort_Latency_List[CCD_DSP_ABORT_LATENCY_SAMPLE_COUNT];
+	int Abort_Latency_Count;
 #ifdef CCD_DSP_MUTEXED
 	pthread_mutex_t Mutex;
 #endif
@@ -87,17 +107,29 @@ static char DSP_Error_String[CCD_GLOBAL_ERROR_STRING_LENGTH] = "";
  * Data holding the current status of ccd_dsp. This is statically initialised to the following:
  * <dl>
  * <dt>Abort</dt> <dd>FALSE</dd>
+ * <dt>Abort_Mutex</dt> <dd>PTHREAD_MUTEX_INITIALIZER</dd>
+ * <dt>Abort_Condition</dt> <dd>PTHREAD_COND_INITIALIZER (re-initialised to use CLOCK_MONOTONIC on first use)</dd>
+ * <dt>Abort_Pending</dt> <dd>FALSE</dd>
+ * <dt>Abort_Request_Time</dt> <dd>{0,0}</dd>
+ * <dt>Abort_Latency_List</dt> <dd>{0.0}</dd>
+ * <dt>Abort_Latency_Count</dt> <dd>0</dd>
  * <dt>Mutex</dt> <dd>If compiled in, PTHREAD_MUTEX_INITIALIZER</dd>
  * </dl>
  * @see #DSP_Attr_Struct
  */
 static struct DSP_Attr_Struct DSP_Data = 
 {
-	FALSE,
+	FALSE,PTHREAD_MUTEX_INITIALIZER,PTHREAD_COND_INITIALIZER,FALSE,{0,0},{0.0},0,
 #ifdef CCD_DSP_MUTEXED
 	PTHREAD_MUTEX_INITIALIZER
 #endif
 };
+/**
+ * Used with pthread_once to initialise DSP_Data's Abort_Condition to use CLOCK_MONOTONIC once, before it is used.
+ * @see #DSP_Data
+ * @see #DSP_Abort_Condition_Initialise
+ */
+static pthread_once_t DSP_Abort_Condition_Once = PTHREAD_ONCE_INIT;
 
 /* internal functions */
 static int DSP_Send_Lda(CCD_Interface_Handle_T* handle,enum CCD_DSP_BOARD_ID board_id,int data,int *reply_value);
@@ -148,6 +180,7 @@ static int DSP_Mutex_Unlock(void);
 #endif
 static char *DSP_Manual_Command_To_String(int manual_command);
 static int DSP_String_To_Manual_Command(char *command_string);
+static void DSP_Abort_Condition_Initialise(void);
 
 /* external functions */
 
@@ -2098,11 +2131,17 @@ int CCD_DSP_Get_Abort(void)
 /**
  * This routine allows the setting and reseting of the Abort flag.
  * The Abort flag is defined in DSP_Data and is set to true when
- * the user wants to stop execution mid-commend.
+ * the user wants to stop execution mid-commend. Setting the flag to TRUE wakes any thread sleeping in
+ * CCD_DSP_Abort_Sleep, and starts timing the abort latency (if an abort is not already pending).
+ * Setting the flag to FALSE (at the start of the next operation) cancels any pending abort timing.
  * @return Returns TRUE or FALSE to indicate success/failure.
  * @param value What to set the Abort flag to: either TRUE or FALSE.
  * @see #CCD_DSP_Get_Abort
+ * @see #CCD_DSP_Abort_Sleep
+ * @see #CCD_DSP_Abort_Complete
  * @see #DSP_Data
+ * @see #DSP_Abort_Condition_Once
+ * @see #DSP_Abort_Condition_Initialise
  */
 int CCD_DSP_Set_Abort(int value)
 {
@@ -2115,13 +2154,141 @@ int CCD_DSP_Set_Abort(int value)
 		sprintf(DSP_Error_String,"CCD_DSP_Set_Abort:Illegal value '%d'.",value);
 		return FALSE;
 	}
+	pthread_once(&DSP_Abort_Condition_Once,DSP_Abort_Condition_Initialise);
+	pthread_mutex_lock(&(DSP_Data.Abort_Mutex));
 	DSP_Data.Abort = value;
+	if(value)
+	{
+		/* only the first abort request of an operation is timed, repeated ABORTs don't reset the latency */
+		if(!DSP_Data.Abort_Pending)
+		{
+			clock_gettime(CLOCK_MONOTONIC,&(DSP_Data.Abort_Request_Time));
+			DSP_Data.Abort_Pending = TRUE;
+		}
+		/* wake any thread sleeping in CCD_DSP_Abort_Sleep */
+		pthread_cond_broadcast(&(DSP_Data.Abort_Condition));
+	}
+	else
+		DSP_Data.Abort_Pending = FALSE;
+	pthread_mutex_unlock(&(DSP_Data.Abort_Mutex));
 #if LOGGING > 4
 	CCD_Global_Log_Format(LOG_VERBOSITY_VERBOSE,"CCD_DSP_Set_Abort(%d) returned.",value);
 #endif
 	return TRUE;
 }
 
+/**
+ * Routine to sleep for a length of time, returning early if the Abort flag is set. This should be used
+ * instead of nanosleep in wait loops that check the Abort flag, so aborts are acted on as soon as
+ * CCD_DSP_Set_Abort is called, rather than after the rest of the sleep.
+ * The sleep is timed against CLOCK_MONOTONIC, so is not affected by the system clock being stepped.
+ * @param sleep_time How long to sleep for.
+ * @return The routine returns TRUE if the Abort flag was set (before or during the sleep), and FALSE if
+ *         the whole time was slept.
+ * @see #CCD_DSP_Set_Abort
+ * @see #DSP_Data
+ * @see #DSP_Abort_Condition_Once
+ * @see #DSP_Abort_Condition_Initialise
+ */
+int CCD_DSP_Abort_Sleep(struct timespec sleep_time)
+{
+	struct timespec deadline;
+	int retval;
+
+	pthread_once(&DSP_Abort_Condition_Once,DSP_Abort_Condition_Initialise);
+	clock_gettime(CLOCK_MONOTONIC,&deadline);
+	deadline.tv_sec += sleep_time.tv_sec;
+	deadline.tv_nsec += sleep_time.tv_nsec;
+	while(deadline.tv_nsec >= CCD_GLOBAL_ONE_SECOND_NS)
+	{
+		deadline.tv_sec++;
+		deadline.tv_nsec -= CCD_GLOBAL_ONE_SECOND_NS;
+	}
+	pthread_mutex_lock(&(DSP_Data.Abort_Mutex));
+	retval = 0;
+	/* loop to ignore spurious wakeups */
+	while((DSP_Data.Abort == FALSE)&&(retval != ETIMEDOUT))
+	{
+		retval = pthread_cond_timedwait(&(DSP_Data.Abort_Condition),&(DSP_Data.Abort_Mutex),&deadline);
+	}
+	retval = DSP_Data.Abort;
+	pthread_mutex_unlock(&(DSP_Data.Abort_Mutex));
+	return retval;
+}
+
+/**
+ * Routine to call when an operation has returned (to the point where another operation can be started) after
+ * failing. If an abort is pending, the time since the abort was requested is added to the abort latency list,
+ * and the abort is no longer pending. Otherwise nothing is done.
+ * @see #CCD_DSP_Set_Abort
+ * @see #CCD_DSP_Abort_Latency_Get
+ * @see #DSP_Data
+ */
+void CCD_DSP_Abort_Complete(void)
+{
+	struct timespec current_time;
+	double latency = 0.0;
+	int pending;
+
+	pthread_mutex_lock(&(DSP_Data.Abort_Mutex));
+	pending = DSP_Data.Abort_Pending;
+	if(pending)
+	{
+		clock_gettime(CLOCK_MONOTONIC,&current_time);
+		latency = fdifftime(current_time,DSP_Data.Abort_Request_Time);
+		DSP_Data.Abort_Latency_List[DSP_Data.Abort_Latency_Count%CCD_DSP_ABORT_LATENCY_SAMPLE_COUNT] = latency;
+		DSP_Data.Abort_Latency_Count++;
+		DSP_Data.Abort_Pending = FALSE;
+	}
+	pthread_mutex_unlock(&(DSP_Data.Abort_Mutex));
+#if LOGGING > 1
+	if(pending)
+		CCD_Global_Log_Format(LOG_VERBOSITY_TERSE,"CCD_DSP_Abort_Complete:Abort took %.3f seconds.",latency);
+#endif
+}
+
+/**
+ * Routine to get a percentile of the recent abort latencies (the time from CCD_DSP_Set_Abort(TRUE) to
+ * CCD_DSP_Abort_Complete), from the last CCD_DSP_ABORT_LATENCY_SAMPLE_COUNT aborts. The nearest rank method is used.
+ * @param percentile The percentile to get, from 0 to 100 (i.e. 50 for the median, 100 for the maximum).
+ * @param latency The address of a double, on return set to the latency percentile in seconds, or 0.0 if no
+ *        aborts have completed.
+ * @param sample_count The address of an integer, on return set to the number of latencies the percentile
+ *        was computed from.
+ * @return The routine returns TRUE on success, and FALSE if an argument is out of range.
+ * @see #CCD_DSP_Abort_Complete
+ * @see #DSP_Data
+ * @see ccd_global.html#CCD_Global_Percentile
+ */
+int CCD_DSP_Abort_Latency_Get(double percentile,double *latency,int *sample_count)
+{
+	double latency_list[CCD_DSP_ABORT_LATENCY_SAMPLE_COUNT];
+	int count;
+
+	DSP_Error_Number = 0;
+	if((percentile < 0.0)||(percentile > 100.0))
+	{
+		DSP_Error_Number = 113;
+		sprintf(DSP_Error_String,"CCD_DSP_Abort_Latency_Get:Illegal percentile %.2f.",percentile);
+		return FALSE;
+	}
+	if((latency == NULL)||(sample_count == NULL))
+	{
+		DSP_Error_Number = 114;
+		sprintf(DSP_Error_String,"CCD_DSP_Abort_Latency_Get:Illegal pointer argument.");
+		return FALSE;
+	}
+	pthread_mutex_lock(&(DSP_Data.Abort_Mutex));
+	count = DSP_Data.Abort_Latency_Count;
+	if(count > CCD_DSP_ABORT_LATENCY_SAMPLE_COUNT)
+		count = CCD_DSP_ABORT_LATENCY_SAMPLE_COUNT;
+	memcpy(latency_list,DSP_Data.Abort_Latency_List,count*sizeof(double));
+	pthread_mutex_unlock(&(DSP_Data.Abort_Mutex));
+	(*sample_count) = count;
+	(*latency) = CCD_Global_Percentile(latency_list,count,percentile);
+	return TRUE;
+}
+
 /**
  * Get the current value of ccd_dsp's error number.
  * @return The current value of ccd_dsp's error number.
@@ -2586,6 +2753,13 @@ static int DSP_Send_Rex(CCD_Interface_Handle_T* handle,int *reply_value)
  * Internal DSP command to make the SDSU CCD Controller start an exposure.
  * If the tv_sec field of start_time is non-zero, we want to open the shutter as near as possible to the 
  * passed in time, allowing for some transmission delay (DSP_Data.Start_Exposure_Offset_Time).
+ * Until the final approach (CCD_Exposure_Start_Approach_Time_Get milliseconds before the send time) we sleep for
+ * at most a second at a time using CCD_DSP_Abort_Sleep, re-reading the real time clock each time so any change
+ * to it is followed. The final approach sleeps to an absolute CLOCK_MONOTONIC time, in clock_nanosleep slices
+ * of at most DSP_START_APPROACH_SLICE_NS (each to an absolute time, the last to the send time itself) checking
+ * for an abort between them, optionally with increased priority (CCD_Exposure_Start_Approach_Priority_Get)
+ * until the command has been sent. The abort flag is checked once more just before the command is sent.
+ * How late the command was sent is recorded using CCD_Exposure_Set_Start_Error.
  * Sets the DSP_Data.Exposure_Start_Time to start of the exposure.
  * Sets the exposure status to either EXPOSING or READOUT (if the exposure length is small).
  * @param handle The address of a CCD_Interface_Handle_T that holds the device connection specific information.
@@ -2596,7 +2770,16 @@ static int DSP_Send_Rex(CCD_Interface_Handle_T* handle,int *reply_value)
  * @param reply_value The address of an integer to store the value returned from the SDSU board.
  * @return Returns true if sending the command succeeded, false if it failed.
  * @see #DSP_Data
+ * @see #DSP_START_APPROACH_SLICE_NS
+ * @see #CCD_DSP_Abort_Sleep
+ * @see #CCD_DSP_Get_Abort
  * @see #DSP_Send_Manual_Command
+ * @see ccd_global.html#CCD_Global_Increase_Priority
+ * @see ccd_global.html#CCD_Global_Decrease_Priority
+ * @see ccd_global.html#CCD_Global_Subtract_Time_Ms
+ * @see ccd_exposure.html#CCD_Exposure_Start_Approach_Time_Get
+ * @see ccd_exposure.html#CCD_Exposure_Start_Approach_Priority_Get
+ * @see ccd_exposure.html#CCD_Exposure_Set_Start_Error
  * @see ccd_pci.html#CCD_PCI_HCVR_START_EXPOSURE
  * @see ccd_exposure.html#CCD_Exposure_Set_Exposure_Start_Time
  * @see ccd_exposure.html#CCD_Exposure_Set_Exposure_Status
@@ -2608,11 +2791,9 @@ static int DSP_Send_Rex(CCD_Interface_Handle_T* handle,int *reply_value)
 static int DSP_Send_Sex(CCD_Interface_Handle_T* handle,struct timespec start_time,int exposure_length, int *reply_value)
 {
 	enum CCD_EXPOSURE_STATUS exposure_status;
-	struct timespec current_time,sleep_time;
-#ifndef _POSIX_TIMERS
-	struct timeval gtod_current_time;
-#endif
-	int remaining_sec,remaining_ns,done = FALSE;
+	struct timespec send_time,current_time,monotonic_time,slice_time,sleep_time;
+	double remaining_time,approach_time;
+	int retval,done = FALSE,priority_increased = FALSE;
 
 /* if a start time has been specified wait for it */
 	if(start_time.tv_sec > 0)
@@ -2624,56 +2805,98 @@ static int DSP_Send_Sex(CCD_Interface_Handle_T* handle,struct timespec start_tim
 			sprintf(DSP_Error_String,"DSP_Send_Sex:Setting exposure status %d failed.",exposure_status);
 			return FALSE;
 		}
+	/* we need to allow time for the propogation of the SEX command
+	** and the shutter trigger delay. */
+		send_time = start_time;
+		CCD_Global_Subtract_Time_Ms(&send_time,CCD_Exposure_Shutter_Trigger_Delay_Get()+
+					    CCD_Exposure_Get_Start_Exposure_Offset_Time());
+		approach_time = ((double)CCD_Exposure_Start_Approach_Time_Get())/((double)CCD_GLOBAL_ONE_SECOND_MS);
 		done = FALSE;
 		while(done == FALSE)
 		{
-#ifdef _POSIX_TIMERS
+		/* send_time is on the real time clock, which can be stepped or slewed. Work out how long is left
+		** each time round the loop, and sleep against the monotonic clock. */
 			clock_gettime(CLOCK_REALTIME,&current_time);
-#else
-			gettimeofday(&gtod_current_time,NULL);
-			current_time.tv_sec = gtod_current_time.tv_sec;
-			current_time.tv_nsec = gtod_current_time.tv_usec*CCD_GLOBAL_ONE_MICROSECOND_NS;
-#endif
-			remaining_sec = start_time.tv_sec - current_time.tv_sec;
-		/* if we have over a second before start_time, sleep for a second. */
-			if(remaining_sec > 1)
+			clock_gettime(CLOCK_MONOTONIC,&monotonic_time);
+			remaining_time = fdifftime(send_time,current_time);
+		/* Until the final approach, sleep for at most a second, waking up if we are aborted. */
+			if(remaining_time > approach_time)
 			{
-				sleep_time.tv_sec = 1;
-				sleep_time.tv_nsec = 0;
-				nanosleep(&sleep_time,NULL);
+				remaining_time -= approach_time;
+				if(remaining_time > 1.0)
+					remaining_time = 1.0;
+				sleep_time.tv_sec = (time_t)remaining_time;
+				sleep_time.tv_nsec = (long)((remaining_time-((double)sleep_time.tv_sec))*
+							    ((double)CCD_GLOBAL_ONE_SECOND_NS));
+				CCD_DSP_Abort_Sleep(sleep_time);
 			}
-			else if(remaining_sec > -1)
+			else
 			{
-				remaining_ns = (start_time.tv_nsec - current_time.tv_nsec);
-			/* we need to allow time for the propogation of the SEX command
-			** and the shutter trigger delay. */
-				remaining_ns -= (CCD_Exposure_Shutter_Trigger_Delay_Get()+
-						 CCD_Exposure_Get_Start_Exposure_Offset_Time())*
-					        CCD_GLOBAL_ONE_MILLISECOND_NS;
-				if(remaining_ns < 0)
+			/* The final approach: optionally increase priority, and sleep until an absolute
+			** time on the monotonic clock, so a late wakeup is not added to the sleep length.
+			** The sleep is done in short slices, so an abort is still noticed. */
+				if(CCD_Exposure_Start_Approach_Priority_Get())
 				{
-					remaining_sec--;
-					remaining_ns += CCD_GLOBAL_ONE_SECOND_NS;
+					if(CCD_Global_Increase_Priority())
+						priority_increased = TRUE;
+#if LOGGING > 1
+					else
+					{
+						CCD_Global_Log(LOG_VERBOSITY_TERSE,
+						      "DSP_Send_Sex:Failed to increase priority for the final approach.");
+					}
+#endif
 				}
-				done = TRUE;
-				if(remaining_sec > -1)
+				if(remaining_time > 0.0)
 				{
-					sleep_time.tv_sec = remaining_sec;
-					sleep_time.tv_nsec = remaining_ns;
-					nanosleep(&sleep_time,NULL);
+					slice_time = monotonic_time;
+					sleep_time.tv_sec = (time_t)remaining_time;
+					sleep_time.tv_nsec = (long)((remaining_time-((double)sleep_time.tv_sec))*
+								    ((double)CCD_GLOBAL_ONE_SECOND_NS));
+					monotonic_time.tv_sec += sleep_time.tv_sec;
+					monotonic_time.tv_nsec += sleep_time.tv_nsec;
+					if(monotonic_time.tv_nsec >= CCD_GLOBAL_ONE_SECOND_NS)
+					{
+						monotonic_time.tv_sec++;
+						monotonic_time.tv_nsec -= CCD_GLOBAL_ONE_SECOND_NS;
+					}
+					/* each slice ends a fixed time after the last one, the last slice at monotonic_time */
+					while((CCD_DSP_Get_Abort() == FALSE)&&(fdifftime(monotonic_time,slice_time) > 0.0))
+					{
+						slice_time.tv_nsec += DSP_START_APPROACH_SLICE_NS;
+						if(slice_time.tv_nsec >= CCD_GLOBAL_ONE_SECOND_NS)
+						{
+							slice_time.tv_sec++;
+							slice_time.tv_nsec -= CCD_GLOBAL_ONE_SECOND_NS;
+						}
+						if(fdifftime(monotonic_time,slice_time) < 0.0)
+							slice_time = monotonic_time;
+						while(clock_nanosleep(CLOCK_MONOTONIC,TIMER_ABSTIME,&slice_time,NULL) == EINTR)
+							;
+					}
 				}
-			}
-			else
 				done = TRUE;
+			}
 		/* if an abort has occured, stop sleeping. */
 			if(DSP_Data.Abort)
 			{
+				if(priority_increased)
+					CCD_Global_Decrease_Priority();
 				DSP_Error_Number = 31;
 				sprintf(DSP_Error_String,"DSP_Send_Sex:Abort detected whilst waiting for start time.");
 				return FALSE;
 			}
 		}/* end while */
 	}/* end if */
+/* don't start the exposure if it has been aborted since the start time wait (or whilst the exposure was set up) */
+	if(CCD_DSP_Get_Abort())
+	{
+		if(priority_increased)
+			CCD_Global_Decrease_Priority();
+		DSP_Error_Number = 115;
+		sprintf(DSP_Error_String,"DSP_Send_Sex:Abort detected before the exposure was started.");
+		return FALSE;
+	}
 /* switch status to exposing and store the actual time the exposure is going to start */
 /* If the exposure length is small, we go directly into READOUT status. */
 	if(exposure_length < CCD_Exposure_Get_Readout_Remaining_Time())
@@ -2682,13 +2905,24 @@ static int DSP_Send_Sex(CCD_Interface_Handle_T* handle,struct timespec start_tim
 		exposure_status = CCD_EXPOSURE_STATUS_EXPOSE;
 	if(!CCD_Exposure_Set_Exposure_Status(handle,exposure_status))
 	{
+		if(priority_increased)
+			CCD_Global_Decrease_Priority();
 		DSP_Error_Number = 16;
 		sprintf(DSP_Error_String,"DSP_Send_Sex:Setting exposure status %d failed.",exposure_status);
 		return FALSE;
 	}
 	CCD_Exposure_Set_Exposure_Start_Time(handle);
+/* record how late the exposure was started */
+	if(start_time.tv_sec > 0)
+	{
+		clock_gettime(CLOCK_REALTIME,&current_time);
+		CCD_Exposure_Set_Start_Error(handle,fdifftime(current_time,send_time));
+	}
 /* start exposure and return result */
-	return DSP_Send_Manual_Command(handle,CCD_DSP_TIM_BOARD_ID,CCD_DSP_SEX,NULL,0,reply_value);
+	retval = DSP_Send_Manual_Command(handle,CCD_DSP_TIM_BOARD_ID,CCD_DSP_SEX,NULL,0,reply_value);
+	if(priority_increased)
+		CCD_Global_Decrease_Priority();
+	return retval;
 }
 
 /**
@@ -3052,14 +3286,19 @@ static int DSP_Check_Reply(int reply,int expected_reply)
 /**
  * Routine to lock the controller access mutex. This will block until the mutex has been acquired,
  * unless an error occurs.
+ * The time spent waiting for the mutex is passed to ccd_trace, to be recorded against the thread's next
+ * controller request.
  * @return Returns TRUE if the mutex has been  locked for access by this thread,
  * 	FALSE if an error occured.
  * @see #DSP_Data
+ * @see ccd_trace.html#CCD_Trace_Mutex_Wait
  */
 static int DSP_Mutex_Lock(void)
 {
+	struct timespec start_time;
 	int error_number;
 
+	clock_gettime(CLOCK_MONOTONIC,&start_time);
 	error_number = pthread_mutex_lock(&(DSP_Data.Mutex));
 	if(error_number != 0)
 	{
@@ -3067,6 +3306,7 @@ static int DSP_Mutex_Lock(void)
 		sprintf(DSP_Error_String,"DSP_Mutex_Lock:Mutex lock failed '%d'.",error_number);
 		return FALSE;
 	}
+	CCD_Trace_Mutex_Wait(start_time);
 	return TRUE;
 }
 
@@ -3136,6 +3376,24 @@ static int DSP_String_To_Manual_Command(char *command_string)
 	return manual_command;
 }
 
+/**
+ * Routine to re-initialise DSP_Data's Abort_Condition to use CLOCK_MONOTONIC for timed waits,
+ * so CCD_DSP_Abort_Sleep is not affected by the system clock being stepped. This is called once,
+ * via pthread_once, before the condition is used.
+ * @see #DSP_Data
+ * @see #DSP_Abort_Condition_Once
+ * @see #CCD_DSP_Abort_Sleep
+ */
+static void DSP_Abort_Condition_Initialise(void)
+{
+	pthread_condattr_t condition_attr;
+
+	pthread_condattr_init(&condition_attr);
+	pthread_condattr_setclock(&condition_attr,CLOCK_MONOTONIC);
+	pthread_cond_init(&(DSP_Data.Abort_Condition),&condition_attr);
+	pthread_condattr_destroy(&condition_attr);
+}
+
 /*
 ** $Log: not supported by cvs2svn $
 ** Revision 1.4  2012/07/17 16:54:04  cjm
@@ -25,12 +25,14 @@
 #include <fcntl.h>
 #include <signal.h>
 #include <errno.h>
+#include <math.h>
 #include <unistd.h>
 #include <sys/types.h>
 #ifndef _POSIX_TIMERS
 #include <sys/time.h>
 #endif
 #include <time.h>
+#include <pthread.h>
 #include "log_udp.h"
 #include "ccd_dsp.h"
 #include "ccd_exposure.h"
@@ -39,6 +41,10 @@
 #include "ccd_interface_private.h"
 #include "ccd_pixel_stream.h"
 #include "ccd_setup.h"
+#include "ccd_timing.h"
+#include "ccd_frame_view.h"
+#include "ccd_exposure_event.h"
+#include "ccd_readout_watchdog.h"
 
 /* hash definitions */
 /**
@@ -60,13 +66,6 @@
  * Bits used when getting the HSTR status.
  */
 #define EXPOSURE_HSTR_HTF_BITS				(0x38)
-/**
- * Number used to determine how long we keep getting the same number of readout pixels
- * returned before we timeout. This number depeends on the sleep in the loop.
- * This is by default 1 second, which makes this number the number of seconds
- * we don't read out more pixels before we time out.
- */
-#define EXPOSURE_READ_TIMEOUT                           (0x5)
 /**
  * The number of milliseconds before the controller stops exposing and starts reading out,
  * that we switch the exposure status from EXPOSING to READOUT. This is done early as we 
@@ -87,6 +86,11 @@
  * START_EXPOSURE command, to allow for transmission delay.
  */
 #define EXPOSURE_DEFAULT_START_EXPOSURE_OFFSET_TIME	(2)
+/**
+ * The default amount of time, in milliseconds, before the START_EXPOSURE command is due to be sent for a timed
+ * exposure, that we stop the coarse (abortable) sleeps and do a single absolute time sleep until the send time.
+ */
+#define EXPOSURE_DEFAULT_START_APPROACH_TIME		(250)
 /**
  * The default amount of time, in milliseconds, between the Uniblitz CS90 shutter controller receiving the
  * open shutter signal, and the shutter starting to open.
@@ -141,7 +145,18 @@
  *     we start the readout.</dd>
  * <dt>Readout_Remaining_Time</dt> <dd>Amount of time, in milleseconds,
  * 	remaining for an exposure when we change status to READOUT, to stop RDM/TDL/WRMs affecting the readout.</dd>
+ * <dt>Start_Approach_Time</dt> <dd>The amount of time, in milliseconds, before the START_EXPOSURE command
+ *     is due to be sent for a timed exposure, that the final approach (an absolute time sleep) starts.</dd>
+ * <dt>Start_Approach_Priority</dt> <dd>A boolean, whether to increase the process priority
+ *     (CCD_Global_Increase_Priority) for the final approach to a timed exposure start.</dd>
+ * <dt>Start_Error_List</dt> <dd>A ring of the last CCD_EXPOSURE_START_ERROR_SAMPLE_COUNT timed exposure
+ *     start errors, in seconds.</dd>
+ * <dt>Start_Error_Count</dt> <dd>The total number of timed exposure start errors recorded. Start_Error_Count
+ *     modulo CCD_EXPOSURE_START_ERROR_SAMPLE_COUNT is the next ring index to write.</dd>
+ * <dt>Start_Error_Mutex</dt> <dd>Protects Start_Error_List and Start_Error_Count,
+ *     which are read by the status thread.</dd>
  * </dl>
+ * @see #CCD_EXPOSURE_START_ERROR_SAMPLE_COUNT
  */
 struct Exposure_Struct
 {
@@ -153,6 +168,11 @@ struct Exposure_Struct
 	int Shutter_Close_Delay;
 	int Readout_Delay;
 	int Readout_Remaining_Time;
+	int Start_Approach_Time;
+	int Start_Approach_Priority;
+	double Start_Error_List[CCD_EXPOSURE_START_ERROR_SAMPLE_COUNT];
+	int Start_Error_Count;
+	pthread_mutex_t Start_Error_Mutex;
 };
 
 /* external variables */
@@ -166,7 +186,10 @@ static char rcsid[] = "$Id: ccd_exposure.c,v 1.7 2013-03-25 15:15:03 cjm Exp $";
  * Internal exposure data (library wide).
  * @see #Exposure_Struct
  */
-static struct Exposure_Struct Exposure_Data;
+static struct Exposure_Struct Exposure_Data =
+{
+	0,0,0,0,0,0,0,0,0,FALSE,{0.0},0,PTHREAD_MUTEX_INITIALIZER
+};
 /**
  * Variable holding error code of last operation performed by ccd_exposure.
  */
@@ -178,6 +201,7 @@ static char Exposure_Error_String[CCD_GLOBAL_ERROR_STRING_LENGTH] = "";
 
 /* internal functions */
 static int Exposure_Shutter_Control(CCD_Interface_Handle_T* handle,int value);
+static void Exposure_Status_Set(CCD_Interface_Handle_T* handle,enum CCD_EXPOSURE_STATUS status);
 
 /* external functions */
 /**
@@ -192,6 +216,9 @@ static int Exposure_Shutter_Control(CCD_Interface_Handle_T* handle,int value);
  * <dt>Shutter_Close_Delay</dt>        <dd>EXPOSURE_DEFAULT_SHUTTER_CLOSE_DELAY</dd>
  * <dt>Readout_Delay</dt>              <dd>EXPOSURE_DEFAULT_READOUT_DELAY</dd>
  * <dt>Readout_Remaining_Time</dt>     <dd>EXPOSURE_DEFAULT_READOUT_REMAINING_TIME</dd>
+ * <dt>Start_Approach_Time</dt>        <dd>EXPOSURE_DEFAULT_START_APPROACH_TIME</dd>
+ * <dt>Start_Approach_Priority</dt>    <dd>FALSE</dd>
+ * <dt>Start_Error_Count</dt>          <dd>0</dd>
  * </dl>
  * @see #Exposure_Data
  * @see #Exposure_Struct
@@ -203,6 +230,7 @@ static int Exposure_Shutter_Control(CCD_Interface_Handle_T* handle,int value);
  * @see #EXPOSURE_DEFAULT_SHUTTER_CLOSE_DELAY
  * @see #EXPOSURE_DEFAULT_READOUT_DELAY
  * @see #EXPOSURE_DEFAULT_READOUT_REMAINING_TIME
+ * @see #EXPOSURE_DEFAULT_START_APPROACH_TIME
  */
 void CCD_Exposure_Initialise(void)
 {
@@ -227,6 +255,11 @@ void CCD_Exposure_Initialise(void)
 	Exposure_Data.Shutter_Close_Delay = EXPOSURE_DEFAULT_SHUTTER_CLOSE_DELAY;
 	Exposure_Data.Readout_Delay = EXPOSURE_DEFAULT_READOUT_DELAY;
 	Exposure_Data.Readout_Remaining_Time = EXPOSURE_DEFAULT_READOUT_REMAINING_TIME;
+	Exposure_Data.Start_Approach_Time = EXPOSURE_DEFAULT_START_APPROACH_TIME;
+	Exposure_Data.Start_Approach_Priority = FALSE;
+	pthread_mutex_lock(&(Exposure_Data.Start_Error_Mutex));
+	Exposure_Data.Start_Error_Count = 0;
+	pthread_mutex_unlock(&(Exposure_Data.Start_Error_Mutex));
 }
 
 /**
@@ -236,6 +269,8 @@ void CCD_Exposure_Initialise(void)
  * <dt>Exposure_Length</dt> <dd>0</dd>
  * <dt>Modified_Exposure_Length</dt> <dd>0</dd>
  * <dt>Exposure_Start_Time</dt> <dd>{0L,0L}</dd>
+ * <dt>Start_Error_Valid</dt> <dd>FALSE</dd>
+ * <dt>Start_Error</dt> <dd>0.0</dd>
  * </dl>
  * @param handle The address of a CCD_Interface_Handle_T that holds the device connection specific information.
  * @see ccd_exposure_private.html#CCD_Exposure_Struct
@@ -248,6 +283,8 @@ void CCD_Exposure_Data_Initialise(CCD_Interface_Handle_T* handle)
 	handle->Exposure_Data.Modified_Exposure_Length = 0;
 	handle->Exposure_Data.Exposure_Start_Time.tv_sec = 0;
 	handle->Exposure_Data.Exposure_Start_Time.tv_nsec = 0;
+	handle->Exposure_Data.Start_Error_Valid = FALSE;
+	handle->Exposure_Data.Start_Error = 0.0;
 }
 
 /**
@@ -263,7 +300,8 @@ void CCD_Exposure_Data_Initialise(CCD_Interface_Handle_T* handle)
  *     using CCD_DSP_Command_WRM to be the sum of the shutter close delay and readout delay.
  * <li>A sleep is executed until it is nearly (Exposure_Data.Start_Exposure_Clear_Time) time to start the exposure.
  * <li>The array is cleared calling  CCD_DSP_Command_CLR TWICE.
- * <li>The exposure is started by calling CCD_DSP_Command_SEX.
+ * <li>The exposure is started by calling CCD_DSP_Command_SEX. For a timed exposure this waits for the
+ *     start time, and records the start error (see CCD_Exposure_Get_Start_Error).
  * <li>Enter a loop, until the readout is completed:
  * 	<ul>
  * 	<li>Get the Host Status Transfer Register value, using CCD_DSP_Command_Get_HSTR.
@@ -273,14 +311,22 @@ void CCD_Exposure_Data_Initialise(CCD_Interface_Handle_T* handle)
  * 		Exposure_Data.Readout_Remaining_Time milliseconds, switch exposure status to READOUT.
  * 	<li>If we are in readout mode, use CCD_DSP_Command_Get_Readout_Progress to get how many pixels
  * 		we have read out.
+ * 	<li>Once we are in readout mode, pass the readout progress to CCD_Readout_Watchdog_Progress. If the
+ * 		readout has stalled, send an abort readout (ABR) command and fail.
  * 	<li>Check to see if we have finished reading out.
  * 	<li>Check to see whether we have been aborted.
+ * 	<li>Sleep, for the watchdog's poll period once the readout is about to start, otherwise for a second.
  *	</ul>
  * <li>Get a pointer to the read out reply data, using CCD_Interface_Get_Reply_Data.
  * <li>If we are reading out a full frame, call CCD_Pixel_Stream_Post_Readout_Full_Frame. Otherwise call
  *     CCD_Pixel_Stream_Post_Readout_Window.
  * </ul>
- * The Exposure_Data.Exposure_Status is changed to reflect the operation being performed on the CCD.
+ * The Exposure_Data.Exposure_Status is changed to reflect the operation being performed on the CCD, using
+ * Exposure_Status_Set, which posts a phase event to ccd_exposure_event. Once the readout has started, the readout
+ * progress is also posted to ccd_exposure_event each time round the loop.
+ * The duration of each phase of the exposure is timed using ccd_timing (CCD_Timing_Exposure_Start,
+ * CCD_Timing_Phase_Start/End), and added to the phase histograms (CCD_Timing_Exposure_End) if the exposure
+ * succeeds.
  * If the exposure is aborted at any stage the routine returns. CCD_Pixel_Stream_Delete_Fits_Images is
  * called to attempt to delete the blank FITS files, if the routine fails or is aborted.
  * @param handle The address of a CCD_Interface_Handle_T that holds the device connection specific information.
@@ -301,7 +347,6 @@ void CCD_Exposure_Data_Initialise(CCD_Interface_Handle_T* handle)
  * @see #EXPOSURE_HSTR_HTF_BITS
  * @see #CCD_EXPOSURE_HSTR_READOUT
  * @see #CCD_EXPOSURE_HSTR_BIT_SHIFT
- * @see #EXPOSURE_READ_TIMEOUT
  * @see #EXPOSURE_ADDRESS_SHDEL
  * @see ccd_exposure_private.html#CCD_Exposure_Struct
  * @see #Exposure_Shutter_Control
@@ -321,6 +366,20 @@ void CCD_Exposure_Data_Initialise(CCD_Interface_Handle_T* handle)
  * @see ccd_dsp.html#CCD_DSP_EXPOSURE_MAX_LENGTH
  * @see ccd_interface.html#CCD_Interface_Get_Reply_Data
  * @see ccd_interface.html#CCD_Interface_Handle_T
+ * @see ccd_timing.html#CCD_Timing_Exposure_Start
+ * @see ccd_frame_view.html#CCD_Frame_View_Raw_Invalidate
+ * @see ccd_timing.html#CCD_Timing_Phase_Start
+ * @see ccd_timing.html#CCD_Timing_Phase_End
+ * @see ccd_timing.html#CCD_Timing_Readout_Progress
+ * @see ccd_timing.html#CCD_Timing_Exposure_End
+ * @see #Exposure_Status_Set
+ * @see ccd_exposure_event.html#CCD_Exposure_Event_Post_Readout_Progress
+ * @see ccd_readout_watchdog.html#CCD_Readout_Watchdog_Start
+ * @see ccd_readout_watchdog.html#CCD_Readout_Watchdog_Progress
+ * @see ccd_readout_watchdog.html#CCD_Readout_Watchdog_End
+ * @see ccd_readout_watchdog.html#CCD_Readout_Watchdog_Poll_Period_Get
+ * @see ccd_dsp.html#CCD_DSP_Command_ABR
+ * @see ccd_dsp.html#CCD_DSP_Abort_Sleep
  */
 int CCD_Exposure_Expose(CCD_Interface_Handle_T* handle,int clear_array,int open_shutter,
 			struct timespec start_time,int exposure_time,
@@ -331,9 +390,10 @@ int CCD_Exposure_Expose(CCD_Interface_Handle_T* handle,int clear_array,int open_
 	struct timeval gtod_current_time;
 #endif
 	unsigned short *exposure_data = NULL;
+	double remaining_time;
 	int elapsed_exposure_time,done;
 	int status,window_flags,i;
-	int expected_pixel_count,current_pixel_count,last_pixel_count,readout_timeout_count,shdel;
+	int expected_pixel_count,current_pixel_count,shdel,poll_period;
 
 	Exposure_Error_Number = 0;
 #if LOGGING > 0
@@ -405,6 +465,16 @@ int CCD_Exposure_Expose(CCD_Interface_Handle_T* handle,int clear_array,int open_
 			expected_pixel_count);
 		return FALSE;
 	}
+	/* start timing the exposure phases */
+	CCD_Timing_Exposure_Start(CCD_Setup_Get_NSBin(handle),CCD_Setup_Get_NPBin(handle),
+				  (int)CCD_Setup_Get_Amplifier(handle),(window_flags != 0));
+	/* start watching the readout progress rate of this readout setup */
+	CCD_Readout_Watchdog_Start(CCD_Setup_Get_Binned_NCols(handle),CCD_Setup_Get_Binned_NRows(handle),
+				   CCD_Setup_Get_NSBin(handle),CCD_Setup_Get_NPBin(handle),
+				   (int)CCD_Setup_Get_Amplifier(handle),(int)CCD_Setup_Get_Gain(handle),
+				   CCD_Setup_Get_Gain_Speed(handle),window_flags,expected_pixel_count);
+	/* the raw readout buffer is about to be overwritten, so any views of it are no longer valid */
+	CCD_Frame_View_Raw_Invalidate();
 /* if we have aborted - stop here */
 	if(CCD_DSP_Get_Abort())
 	{
@@ -434,6 +504,8 @@ int CCD_Exposure_Expose(CCD_Interface_Handle_T* handle,int clear_array,int open_
 	}
 /* Save the exposure length for FITS headers etc */
 	handle->Exposure_Data.Exposure_Length = exposure_time;
+/* CCD_DSP_Command_SEX sets the start error if this is a timed exposure */
+	handle->Exposure_Data.Start_Error_Valid = FALSE;
 #if LOGGING > 4
 	CCD_Global_Log_Format(LOG_VERBOSITY_INTERMEDIATE,
 			      "CCD_Exposure_Expose(handle=%p):Original exposure length(%d).",
@@ -498,13 +570,15 @@ int CCD_Exposure_Expose(CCD_Interface_Handle_T* handle,int clear_array,int open_
 		sprintf(Exposure_Error_String,"CCD_Exposure_Expose:Aborted");
 		return FALSE;
 	}
+	CCD_Timing_Phase_End(CCD_TIMING_PHASE_SETUP);
 /* initialise variables */
 /* We will use the start_time parameter to determine when to start the exposure IF 
 ** it's seconds are greater then zero */ 
 /* do the clear array a few seconds before the exposure is due to start */
 	if(start_time.tv_sec > 0)
 	{
-		handle->Exposure_Data.Exposure_Status = CCD_EXPOSURE_STATUS_WAIT_START;
+		Exposure_Status_Set(handle,CCD_EXPOSURE_STATUS_WAIT_START);
+		CCD_Timing_Phase_Start(CCD_TIMING_PHASE_WAIT_START);
 		done = FALSE;
 		while(done == FALSE)
 		{
@@ -520,12 +594,18 @@ int CCD_Exposure_Expose(CCD_Interface_Handle_T* handle,int clear_array,int open_
 				       "CCD_Exposure_Expose(handle=%p):Waiting for exposure start time (%ld,%ld).",
 				       handle,current_time.tv_sec,start_time.tv_sec);
 #endif
-		/* if we've time, sleep for a second */
-			if((start_time.tv_sec - current_time.tv_sec) > Exposure_Data.Start_Exposure_Clear_Time)
+		/* if we've time, sleep until it is time to clear the array (for at most a second, to
+		** follow any change to the real time clock), or until we are aborted */
+			remaining_time = fdifftime(start_time,current_time)-
+				((double)Exposure_Data.Start_Exposure_Clear_Time);
+			if(remaining_time > 0.0)
 			{
-				sleep_time.tv_sec = 1;
-				sleep_time.tv_nsec = 0;
-				nanosleep(&sleep_time,NULL);
+				if(remaining_time > 1.0)
+					remaining_time = 1.0;
+				sleep_time.tv_sec = (time_t)remaining_time;
+				sleep_time.tv_nsec = (long)((remaining_time-((double)sleep_time.tv_sec))*
+							    ((double)CCD_GLOBAL_ONE_SECOND_NS));
+				CCD_DSP_Abort_Sleep(sleep_time);
 			}
 			else
 				done = TRUE;
@@ -533,12 +613,13 @@ int CCD_Exposure_Expose(CCD_Interface_Handle_T* handle,int clear_array,int open_
 			if(CCD_DSP_Get_Abort())
 			{
 				CCD_Pixel_Stream_Delete_Fits_Images(filename_list,filename_count);
-				handle->Exposure_Data.Exposure_Status = CCD_EXPOSURE_STATUS_NONE;
+				Exposure_Status_Set(handle,CCD_EXPOSURE_STATUS_NONE);
 				Exposure_Error_Number = 37;
 				sprintf(Exposure_Error_String,"CCD_Exposure_Expose:Aborted.");
 				return FALSE;
 			}
 		}/* end while */
+		CCD_Timing_Phase_End(CCD_TIMING_PHASE_WAIT_START);
 	}
 /* clear the array */
 	if(clear_array)
@@ -546,7 +627,8 @@ int CCD_Exposure_Expose(CCD_Interface_Handle_T* handle,int clear_array,int open_
 #if LOGGING > 4
        		CCD_Global_Log(LOG_VERBOSITY_INTERMEDIATE,"CCD_Exposure_Expose():Clearing CCD array.");
 #endif
-		handle->Exposure_Data.Exposure_Status = CCD_EXPOSURE_STATUS_CLEAR;
+		Exposure_Status_Set(handle,CCD_EXPOSURE_STATUS_CLEAR);
+		CCD_Timing_Phase_Start(CCD_TIMING_PHASE_CLEAR);
 		/* we call CLR twice here. This is because CLR only parallel clocks 1024 times,
 		** and we need 2049 times to clear the array. Setting NPCLR to 2049 causes CLR to timeout TOUT though.
 		*/
@@ -555,18 +637,19 @@ int CCD_Exposure_Expose(CCD_Interface_Handle_T* handle,int clear_array,int open_
 			if(!CCD_DSP_Command_CLR(handle))
 			{
 				CCD_Pixel_Stream_Delete_Fits_Images(filename_list,filename_count);
-				handle->Exposure_Data.Exposure_Status = CCD_EXPOSURE_STATUS_NONE;
+				Exposure_Status_Set(handle,CCD_EXPOSURE_STATUS_NONE);
 				Exposure_Error_Number = 38;
 				sprintf(Exposure_Error_String,"CCD_Exposure_Expose:Clear Array failed(%d).",i);
 				return FALSE;
 			}
 		}/* end for */
+		CCD_Timing_Phase_End(CCD_TIMING_PHASE_CLEAR);
 	}/* end if clear array */
 /* check - have we been aborted? */
 	if(CCD_DSP_Get_Abort())
 	{
 		CCD_Pixel_Stream_Delete_Fits_Images(filename_list,filename_count);
-		handle->Exposure_Data.Exposure_Status = CCD_EXPOSURE_STATUS_NONE;
+		Exposure_Status_Set(handle,CCD_EXPOSURE_STATUS_NONE);
 		Exposure_Error_Number = 20;
 		sprintf(Exposure_Error_String,"CCD_Exposure_Expose:Aborted.");
 		return FALSE;
@@ -577,10 +660,11 @@ int CCD_Exposure_Expose(CCD_Interface_Handle_T* handle,int clear_array,int open_
 #endif
 	/* Exposure status is set in CCD_DSP_Command_SEX, as this routine sleeps before starting
 	** the exposure. */
+	CCD_Timing_Phase_Start(CCD_TIMING_PHASE_EXPOSE);
 	if(!CCD_DSP_Command_SEX(handle,start_time,handle->Exposure_Data.Modified_Exposure_Length))
 	{
 		CCD_Pixel_Stream_Delete_Fits_Images(filename_list,filename_count);
-		handle->Exposure_Data.Exposure_Status = CCD_EXPOSURE_STATUS_NONE;
+		Exposure_Status_Set(handle,CCD_EXPOSURE_STATUS_NONE);
 		Exposure_Error_Number = 39;
 		sprintf(Exposure_Error_String,"CCD_Exposure_Expose:SEX command failed(%ld,%ld,%d).",
 			start_time.tv_sec,start_time.tv_nsec,handle->Exposure_Data.Modified_Exposure_Length);
@@ -590,7 +674,6 @@ int CCD_Exposure_Expose(CCD_Interface_Handle_T* handle,int clear_array,int open_
 	done = FALSE;
         elapsed_exposure_time = 0;
 	current_pixel_count = 0;
-	last_pixel_count = 0;
 	while(done == FALSE)
 	{
 #if LOGGING > 4
@@ -600,7 +683,7 @@ int CCD_Exposure_Expose(CCD_Interface_Handle_T* handle,int clear_array,int open_
 		if(!CCD_DSP_Command_Get_HSTR(handle,&status))
 		{
 			CCD_Pixel_Stream_Delete_Fits_Images(filename_list,filename_count);
-			handle->Exposure_Data.Exposure_Status = CCD_EXPOSURE_STATUS_NONE;
+			Exposure_Status_Set(handle,CCD_EXPOSURE_STATUS_NONE);
 			Exposure_Error_Number = 40;
 			sprintf(Exposure_Error_String,"CCD_Exposure_Expose:Getting HSTR failed.");
 			return FALSE;
@@ -651,7 +734,9 @@ int CCD_Exposure_Expose(CCD_Interface_Handle_T* handle,int clear_array,int open_
 				** We switch to exposure readout Exposure_Data.Readout_Remaining_Time milliseconds 
 				** early as we sleep for a second at the bottom of the loop, and the HSTR status
 				** may change before we check it again. */
-				handle->Exposure_Data.Exposure_Status = CCD_EXPOSURE_STATUS_PRE_READOUT;
+				Exposure_Status_Set(handle,CCD_EXPOSURE_STATUS_PRE_READOUT);
+				CCD_Timing_Phase_End(CCD_TIMING_PHASE_EXPOSE);
+				CCD_Timing_Phase_Start(CCD_TIMING_PHASE_PRE_READOUT);
 #if LOGGING > 4
 				CCD_Global_Log_Format(LOG_VERBOSITY_INTERMEDIATE,
 						      "CCD_Exposure_Expose(handle=%p):Exposure Status "
@@ -680,7 +765,10 @@ int CCD_Exposure_Expose(CCD_Interface_Handle_T* handle,int clear_array,int open_
 			/* is this the first time through the loop we have detected readout mode? */
 			if(handle->Exposure_Data.Exposure_Status != CCD_EXPOSURE_STATUS_READOUT)
 			{
-				handle->Exposure_Data.Exposure_Status = CCD_EXPOSURE_STATUS_READOUT;
+				Exposure_Status_Set(handle,CCD_EXPOSURE_STATUS_READOUT);
+				CCD_Timing_Phase_End(CCD_TIMING_PHASE_EXPOSE);
+				CCD_Timing_Phase_End(CCD_TIMING_PHASE_PRE_READOUT);
+				CCD_Timing_Phase_Start(CCD_TIMING_PHASE_READOUT);
 #if LOGGING > 4
 				CCD_Global_Log_Format(LOG_VERBOSITY_INTERMEDIATE,
 				 "CCD_Exposure_Expose(handle=%p):Exposure Status changed to READOUT(HSTR).",handle);
@@ -699,15 +787,16 @@ int CCD_Exposure_Expose(CCD_Interface_Handle_T* handle,int clear_array,int open_
 		CCD_Global_Log_Format(LOG_VERBOSITY_INTERMEDIATE,
 			       "CCD_Exposure_Expose(handle=%p):Getting Readout Progress.",handle);
 #endif
-		last_pixel_count = current_pixel_count;
 		if(!CCD_DSP_Command_Get_Readout_Progress(handle,&current_pixel_count))
 		{
 			CCD_Pixel_Stream_Delete_Fits_Images(filename_list,filename_count);
-			handle->Exposure_Data.Exposure_Status = CCD_EXPOSURE_STATUS_NONE;
+			Exposure_Status_Set(handle,CCD_EXPOSURE_STATUS_NONE);
 			Exposure_Error_Number = 41;
 			sprintf(Exposure_Error_String,"CCD_Exposure_Expose:Get Readout Progress failed.");
 			return FALSE;
 		}
+		CCD_Timing_Readout_Progress(current_pixel_count,expected_pixel_count);
+		CCD_Exposure_Event_Post_Readout_Progress(current_pixel_count,expected_pixel_count);
 #if LOGGING > 9
 		CCD_Global_Log_Format(LOG_VERBOSITY_INTERMEDIATE,
 				      "CCD_Exposure_Expose(handle=%p):Readout progress is %#x of %#x pixels.",
@@ -722,7 +811,10 @@ int CCD_Exposure_Expose(CCD_Interface_Handle_T* handle,int clear_array,int open_
 			/* is this the first time through the loop we have detected readout mode? */
 			if(handle->Exposure_Data.Exposure_Status != CCD_EXPOSURE_STATUS_READOUT)
 			{
-				handle->Exposure_Data.Exposure_Status = CCD_EXPOSURE_STATUS_READOUT;
+				Exposure_Status_Set(handle,CCD_EXPOSURE_STATUS_READOUT);
+				CCD_Timing_Phase_End(CCD_TIMING_PHASE_EXPOSE);
+				CCD_Timing_Phase_End(CCD_TIMING_PHASE_PRE_READOUT);
+				CCD_Timing_Phase_Start(CCD_TIMING_PHASE_READOUT);
 #if LOGGING > 4
 				CCD_Global_Log_Format(LOG_VERBOSITY_INTERMEDIATE,
 						      "CCD_Exposure_Expose(handle=%p):"
@@ -730,28 +822,29 @@ int CCD_Exposure_Expose(CCD_Interface_Handle_T* handle,int clear_array,int open_
 #endif
 			}
 		}
-		/* We can only have a readout timeout, if we are in readout mode. */
+		/* We can only have a readout stall, if we are in readout mode. */
 		if(handle->Exposure_Data.Exposure_Status == CCD_EXPOSURE_STATUS_READOUT)
 		{
-			/* has the pixel count changed. If not, increment timeout */
-			if(current_pixel_count == last_pixel_count)
-				readout_timeout_count++;
-			else
-				readout_timeout_count = 0;
-			/* have we timed out? If so, exit loop. */
-			if(readout_timeout_count == EXPOSURE_READ_TIMEOUT)
+			/* has the pixel count stopped changing for longer than this readout setup allows? */
+			if(!CCD_Readout_Watchdog_Progress(current_pixel_count))
 			{
-				CCD_Pixel_Stream_Delete_Fits_Images(filename_list,filename_count);
-#if LOGGING > 9
-				CCD_Global_Log_Format(LOG_VERBOSITY_INTERMEDIATE,
-				       "CCD_Exposure_Expose(handle=%p):Readout timeout has occured.",handle);
+#if LOGGING > 0
+				CCD_Global_Log_Format(LOG_VERBOSITY_TERSE,"CCD_Exposure_Expose(handle=%p):"
+						      "Readout stalled at %d of %d pixels:Trying ABR.",handle,
+						      current_pixel_count,expected_pixel_count);
 #endif
-				handle->Exposure_Data.Exposure_Status = CCD_EXPOSURE_STATUS_NONE;
+				/* The readout has stalled, so ABR is the only way to get the controller back,
+				** despite it's history of lockups during a readout that is progressing. */
+				if(CCD_DSP_Command_ABR(handle) != CCD_DSP_DON)
+					CCD_DSP_Error();
+				CCD_Pixel_Stream_Delete_Fits_Images(filename_list,filename_count);
+				Exposure_Status_Set(handle,CCD_EXPOSURE_STATUS_NONE);
 				Exposure_Error_Number = 43;
-				sprintf(Exposure_Error_String,"CCD_Exposure_Expose:Readout timed out.");
+				sprintf(Exposure_Error_String,"CCD_Exposure_Expose:Readout timed out at %d of %d pixels.",
+					current_pixel_count,expected_pixel_count);
 				return FALSE;
 			}
-		} 
+		}
 		/* check - have we been aborted? */
 		if(CCD_DSP_Get_Abort())
 		{
@@ -768,14 +861,14 @@ int CCD_Exposure_Expose(CCD_Interface_Handle_T* handle,int clear_array,int open_
 				if(CCD_DSP_Command_AEX(handle) != CCD_DSP_DON)
 				{
 					CCD_Pixel_Stream_Delete_Fits_Images(filename_list,filename_count);
-					handle->Exposure_Data.Exposure_Status = CCD_EXPOSURE_STATUS_NONE;
+					Exposure_Status_Set(handle,CCD_EXPOSURE_STATUS_NONE);
 					Exposure_Error_Number = 15;
 					sprintf(Exposure_Error_String,"CCD_Exposure_Expose:AEX Abort command failed.");
 					return FALSE;
 				}
 				CCD_Pixel_Stream_Delete_Fits_Images(filename_list,filename_count);
 				/* we now only abort when exposure status is STATUS_EXPOSE. */
-				handle->Exposure_Data.Exposure_Status = CCD_EXPOSURE_STATUS_NONE;
+				Exposure_Status_Set(handle,CCD_EXPOSURE_STATUS_NONE);
 				Exposure_Error_Number = 42;
 				sprintf(Exposure_Error_String,"CCD_Exposure_Expose:Aborted.");
 				return FALSE;
@@ -794,27 +887,36 @@ int CCD_Exposure_Expose(CCD_Interface_Handle_T* handle,int clear_array,int open_
 			CCD_Global_Log_Format(LOG_VERBOSITY_INTERMEDIATE,
 					      "CCD_Exposure_Expose(handle=%p):Readout completed.",handle);
 #endif
+			CCD_Timing_Phase_End(CCD_TIMING_PHASE_READOUT);
+			CCD_Readout_Watchdog_End();
 			done = TRUE;
 		}
-		/* sleep for a bit */
-		sleep_time.tv_sec = 1;
-		sleep_time.tv_nsec = 0;
-		nanosleep(&sleep_time,NULL);
+		/* sleep for a bit. Once the readout is about to start, poll at the watchdog's rate
+		** so a stall is detected within a few expected progress intervals. */
+		if((handle->Exposure_Data.Exposure_Status == CCD_EXPOSURE_STATUS_PRE_READOUT)||
+		   (handle->Exposure_Data.Exposure_Status == CCD_EXPOSURE_STATUS_READOUT))
+		{
+			poll_period = CCD_Readout_Watchdog_Poll_Period_Get();
+			sleep_time.tv_sec = poll_period/CCD_GLOBAL_ONE_SECOND_MS;
+			sleep_time.tv_nsec = (poll_period%CCD_GLOBAL_ONE_SECOND_MS)*CCD_GLOBAL_ONE_MILLISECOND_NS;
+		}
+		else
+		{
+			sleep_time.tv_sec = 1;
+			sleep_time.tv_nsec = 0;
+		}
+		/* Wake early if we are aborted, so an exposure is stopped with AEX straight away. Once aborted
+		** (the readout is let finish, see above) sleep the whole poll period rather than spinning. */
+		if(CCD_DSP_Get_Abort())
+			nanosleep(&sleep_time,NULL);
+		else
+			CCD_DSP_Abort_Sleep(sleep_time);
 	}/* end while not done */
-	/* did the readout time out?*/
-	if(readout_timeout_count == EXPOSURE_READ_TIMEOUT)
-	{
-		CCD_Pixel_Stream_Delete_Fits_Images(filename_list,filename_count);
-		handle->Exposure_Data.Exposure_Status = CCD_EXPOSURE_STATUS_NONE;
-		Exposure_Error_Number = 30;
-		sprintf(Exposure_Error_String,"CCD_Exposure_Expose:Readout timed out.");
-		return FALSE;
-	}
 /* check - have we been aborted? */
 	if(CCD_DSP_Get_Abort())
 	{
 		CCD_Pixel_Stream_Delete_Fits_Images(filename_list,filename_count);
-		handle->Exposure_Data.Exposure_Status = CCD_EXPOSURE_STATUS_NONE;
+		Exposure_Status_Set(handle,CCD_EXPOSURE_STATUS_NONE);
 		Exposure_Error_Number = 24;
 		sprintf(Exposure_Error_String,"CCD_Exposure_Expose:Aborted.");
 		return FALSE;
@@ -826,17 +928,18 @@ int CCD_Exposure_Expose(CCD_Interface_Handle_T* handle,int clear_array,int open_
 	if(!CCD_Interface_Get_Reply_Data(handle,&exposure_data))
 	{
 		CCD_Pixel_Stream_Delete_Fits_Images(filename_list,filename_count);
-		handle->Exposure_Data.Exposure_Status = CCD_EXPOSURE_STATUS_NONE;
+		Exposure_Status_Set(handle,CCD_EXPOSURE_STATUS_NONE);
 		Exposure_Error_Number = 44;
 		sprintf(Exposure_Error_String,"CCD_Exposure_Expose:Failed to get reply data.");
 		return FALSE;
 	}
-	handle->Exposure_Data.Exposure_Status = CCD_EXPOSURE_STATUS_POST_READOUT;
+	Exposure_Status_Set(handle,CCD_EXPOSURE_STATUS_POST_READOUT);
+	CCD_Timing_Phase_Start(CCD_TIMING_PHASE_POST_READOUT);
 /* did we abort? */
 	if(CCD_DSP_Get_Abort())
 	{
 		CCD_Pixel_Stream_Delete_Fits_Images(filename_list,filename_count);
-		handle->Exposure_Data.Exposure_Status = CCD_EXPOSURE_STATUS_NONE;
+		Exposure_Status_Set(handle,CCD_EXPOSURE_STATUS_NONE);
 		Exposure_Error_Number = 26;
 		sprintf(Exposure_Error_String,"CCD_Exposure_Expose:Aborted.");
 		return FALSE;
@@ -847,7 +950,7 @@ int CCD_Exposure_Expose(CCD_Interface_Handle_T* handle,int clear_array,int open_
 		if(CCD_Pixel_Stream_Post_Readout_Full_Frame(handle,exposure_data,filename_list[0]) == FALSE)
 		{
 			/* Do not call CCD_Pixel_Stream_Delete_Fits_Images here - we may have saved to disk */
-			handle->Exposure_Data.Exposure_Status = CCD_EXPOSURE_STATUS_NONE;
+			Exposure_Status_Set(handle,CCD_EXPOSURE_STATUS_NONE);
 			return FALSE;
 		}
 	}
@@ -856,12 +959,14 @@ int CCD_Exposure_Expose(CCD_Interface_Handle_T* handle,int clear_array,int open_
 		if(CCD_Pixel_Stream_Post_Readout_Window(handle,exposure_data,filename_list,filename_count) == FALSE)
 		{
 			/* Do not call CCD_Pixel_Stream_Delete_Fits_Images here - we may have saved to disk */
-			handle->Exposure_Data.Exposure_Status = CCD_EXPOSURE_STATUS_NONE;
+			Exposure_Status_Set(handle,CCD_EXPOSURE_STATUS_NONE);
 			return FALSE;
 		}
 	}
 /* reset exposure status */
-	handle->Exposure_Data.Exposure_Status = CCD_EXPOSURE_STATUS_NONE;
+	Exposure_Status_Set(handle,CCD_EXPOSURE_STATUS_NONE);
+	CCD_Timing_Phase_End(CCD_TIMING_PHASE_POST_READOUT);
+	CCD_Timing_Exposure_End();
 #if LOGGING > 0
 	CCD_Global_Log_Format(LOG_VERBOSITY_INTERMEDIATE,"CCD_Exposure_Expose(handle=%p) returned TRUE.",handle);
 #endif
@@ -1050,6 +1155,7 @@ int CCD_Exposure_Read_Out_CCD(CCD_Interface_Handle_T* handle,char *filename)
  * @see ccd_exposure_private.html#CCD_Exposure_Struct
  * @see #CCD_EXPOSURE_STATUS
  * @see #CCD_EXPOSURE_IS_STATUS
+ * @see #Exposure_Status_Set
  * @see ccd_interface.html#CCD_Interface_Handle_T
  */
 int CCD_Exposure_Set_Exposure_Status(CCD_Interface_Handle_T* handle,enum CCD_EXPOSURE_STATUS status)
@@ -1060,7 +1166,7 @@ int CCD_Exposure_Set_Exposure_Status(CCD_Interface_Handle_T* handle,enum CCD_EXP
 		sprintf(Exposure_Error_String,"CCD_Exposure_Set_Exposure_Status:Status illegal value (%d).",status);
 		return FALSE;
 	}
-	handle->Exposure_Data.Exposure_Status = status;
+	Exposure_Status_Set(handle,status);
 	return TRUE;
 }
 
@@ -1301,6 +1407,154 @@ extern int CCD_Exposure_Readout_Delay_Get(void)
 	return Exposure_Data.Readout_Delay;
 }
 
+/**
+ * Routine to configure the final approach to a timed exposure start. Until approach_ms before the START_EXPOSURE
+ * command is due to be sent, CCD_DSP_Command_SEX sleeps in abortable steps of at most a second. It then sleeps
+ * until the send time in short absolute time sleeps on the monotonic clock, checking for an abort between them.
+ * @param approach_ms The length of the final approach, in milliseconds. This should be longer than the
+ *        worst case scheduling delay.
+ * @param increase_priority A boolean, if TRUE CCD_Global_Increase_Priority is called for the final approach,
+ *        and CCD_Global_Decrease_Priority once the START_EXPOSURE command has been sent. This only has an effect
+ *        if the library was compiled with CCD_GLOBAL_READOUT_PRIORITY non-zero.
+ * @return The routine returns TRUE on success, and FALSE if an argument is out of range.
+ * @see #Exposure_Struct
+ * @see #Exposure_Data
+ * @see ccd_dsp.html#CCD_DSP_Command_SEX
+ */
+int CCD_Exposure_Start_Approach_Set(int approach_ms,int increase_priority)
+{
+	Exposure_Error_Number = 0;
+	if(approach_ms < 0)
+	{
+		Exposure_Error_Number = 73;
+		sprintf(Exposure_Error_String,"CCD_Exposure_Start_Approach_Set:Illegal approach time %d.",
+			approach_ms);
+		return FALSE;
+	}
+	if(!CCD_GLOBAL_IS_BOOLEAN(increase_priority))
+	{
+		Exposure_Error_Number = 74;
+		sprintf(Exposure_Error_String,"CCD_Exposure_Start_Approach_Set:Illegal increase priority %d.",
+			increase_priority);
+		return FALSE;
+	}
+	Exposure_Data.Start_Approach_Time = approach_ms;
+	Exposure_Data.Start_Approach_Priority = increase_priority;
+	return TRUE;
+}
+
+/**
+ * Routine to get the length of the final approach to a timed exposure start.
+ * @return The length of the final approach, in milliseconds.
+ * @see #Exposure_Struct
+ * @see #Exposure_Data
+ * @see #CCD_Exposure_Start_Approach_Set
+ */
+int CCD_Exposure_Start_Approach_Time_Get(void)
+{
+	return Exposure_Data.Start_Approach_Time;
+}
+
+/**
+ * Routine to get whether the process priority is increased for the final approach to a timed exposure start.
+ * @return A boolean, TRUE if the priority is increased.
+ * @see #Exposure_Struct
+ * @see #Exposure_Data
+ * @see #CCD_Exposure_Start_Approach_Set
+ */
+int CCD_Exposure_Start_Approach_Priority_Get(void)
+{
+	return Exposure_Data.Start_Approach_Priority;
+}
+
+/**
+ * Routine to record the start error of a timed exposure. This is called from CCD_DSP_Command_SEX as
+ * the START_EXPOSURE command is sent. The error is saved in the handle, and added to the library wide
+ * start error ring used by CCD_Exposure_Start_Error_Percentile_Get.
+ * @param handle The address of a CCD_Interface_Handle_T that holds the device connection specific information.
+ * @param start_error The time the START_EXPOSURE command was sent, less the time it was due to be sent,
+ *        in seconds. This is positive if the exposure started late.
+ * @see #Exposure_Data
+ * @see ccd_exposure_private.html#CCD_Exposure_Struct
+ * @see ccd_dsp.html#CCD_DSP_Command_SEX
+ * @see ccd_interface.html#CCD_Interface_Handle_T
+ */
+void CCD_Exposure_Set_Start_Error(CCD_Interface_Handle_T* handle,double start_error)
+{
+	handle->Exposure_Data.Start_Error = start_error;
+	handle->Exposure_Data.Start_Error_Valid = TRUE;
+	pthread_mutex_lock(&(Exposure_Data.Start_Error_Mutex));
+	Exposure_Data.Start_Error_List[Exposure_Data.Start_Error_Count%CCD_EXPOSURE_START_ERROR_SAMPLE_COUNT] =
+		start_error;
+	Exposure_Data.Start_Error_Count++;
+	pthread_mutex_unlock(&(Exposure_Data.Start_Error_Mutex));
+#if LOGGING > 4
+	CCD_Global_Log_Format(LOG_VERBOSITY_INTERMEDIATE,
+			      "CCD_Exposure_Set_Start_Error(handle=%p):Exposure started %.3f ms %s.",handle,
+			      fabs(start_error)*((double)CCD_GLOBAL_ONE_SECOND_MS),(start_error < 0.0) ? "early" : "late");
+#endif
+}
+
+/**
+ * Routine to get the start error of the last exposure started on this handle.
+ * @param handle The address of a CCD_Interface_Handle_T that holds the device connection specific information.
+ * @param start_error The address of a double, on return set to the time the START_EXPOSURE command was sent
+ *        less the time it was due to be sent, in seconds, or 0.0 if the last exposure was not timed.
+ * @return The routine returns TRUE if the last exposure was a timed exposure (with a start time),
+ *         and FALSE if it was not (so there is no start error).
+ * @see ccd_exposure_private.html#CCD_Exposure_Struct
+ * @see ccd_interface.html#CCD_Interface_Handle_T
+ */
+int CCD_Exposure_Get_Start_Error(CCD_Interface_Handle_T* handle,double *start_error)
+{
+	if(start_error != NULL)
+		(*start_error) = handle->Exposure_Data.Start_Error;
+	return handle->Exposure_Data.Start_Error_Valid;
+}
+
+/**
+ * Routine to get a percentile of the absolute start errors of the last CCD_EXPOSURE_START_ERROR_SAMPLE_COUNT
+ * timed exposures. The nearest rank method is used.
+ * @param percentile The percentile to get, from 0 to 100 (i.e. 50 for the median, 100 for the maximum).
+ * @param start_error The address of a double, on return set to the absolute start error percentile in seconds,
+ *        or 0.0 if no timed exposures have been started.
+ * @param sample_count The address of an integer, on return set to the number of start errors the percentile
+ *        was computed from.
+ * @return The routine returns TRUE on success, and FALSE if an argument is out of range.
+ * @see #Exposure_Data
+ * @see ccd_global.html#CCD_Global_Percentile
+ */
+int CCD_Exposure_Start_Error_Percentile_Get(double percentile,double *start_error,int *sample_count)
+{
+	double error_list[CCD_EXPOSURE_START_ERROR_SAMPLE_COUNT];
+	int count,index;
+
+	Exposure_Error_Number = 0;
+	if((percentile < 0.0)||(percentile > 100.0))
+	{
+		Exposure_Error_Number = 75;
+		sprintf(Exposure_Error_String,"CCD_Exposure_Start_Error_Percentile_Get:Illegal percentile %.2f.",
+			percentile);
+		return FALSE;
+	}
+	if((start_error == NULL)||(sample_count == NULL))
+	{
+		Exposure_Error_Number = 76;
+		sprintf(Exposure_Error_String,"CCD_Exposure_Start_Error_Percentile_Get:Illegal pointer argument.");
+		return FALSE;
+	}
+	pthread_mutex_lock(&(Exposure_Data.Start_Error_Mutex));
+	count = Exposure_Data.Start_Error_Count;
+	if(count > CCD_EXPOSURE_START_ERROR_SAMPLE_COUNT)
+		count = CCD_EXPOSURE_START_ERROR_SAMPLE_COUNT;
+	for(index = 0; index < count; index++)
+		error_list[index] = fabs(Exposure_Data.Start_Error_List[index]);
+	pthread_mutex_unlock(&(Exposure_Data.Start_Error_Mutex));
+	(*sample_count) = count;
+	(*start_error) = CCD_Global_Percentile(error_list,count,percentile);
+	return TRUE;
+}
+
 /**
  * Routine to set the Exposure_Start_Time of Exposure_Data, to the current time of the real time clock.
  * clock_gettime or gettimeofday is used, depending on whether _POSIX_TIMERS is defined.
@@ -1458,6 +1712,24 @@ static int Exposure_Shutter_Control(CCD_Interface_Handle_T* handle,int open_shut
 	return TRUE;
 }
 
+/**
+ * Set the exposure status in the interface handle. If the status has changed, a phase event is posted
+ * to ccd_exposure_event, so that clients waiting on exposure events are told about the change.
+ * @param handle The address of a CCD_Interface_Handle_T that holds the device connection specific information.
+ * @param status The new exposure status.
+ * @see ccd_exposure_private.html#CCD_Exposure_Struct
+ * @see ccd_exposure_event.html#CCD_Exposure_Event_Post_Phase
+ * @see ccd_interface.html#CCD_Interface_Handle_T
+ */
+static void Exposure_Status_Set(CCD_Interface_Handle_T* handle,enum CCD_EXPOSURE_STATUS status)
+{
+	if(handle->Exposure_Data.Exposure_Status != status)
+	{
+		handle->Exposure_Data.Exposure_Status = status;
+		CCD_Exposure_Event_Post_Phase(status);
+	}
+}
+
 /*
 ** $Log: not supported by cvs2svn $
 ** Revision 1.6  2012/07/19 14:07:46  cjm
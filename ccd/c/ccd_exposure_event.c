@@ -0,0 +1,366 @@
+/* ccd_exposure_event.c
+** Exposure event queue module.
+** $Header$
+*/
+/**
+ * ccd_exposure_event holds a queue of events describing the progress of an exposure, so that a client
+ * (i.e. the Java layer's asynchronous exposure API) can be told about phase changes and readout progress
+ * without polling the exposure status.
+ * <ul>
+ * <li>ccd_exposure posts a phase event (CCD_Exposure_Event_Post_Phase) each time the exposure status changes,
+ *     and a readout progress event (CCD_Exposure_Event_Post_Readout_Progress) each time round the exposure loop
+ *     once the readout has started.
+ * <li>The client posts a complete event (CCD_Exposure_Event_Post_Complete) once CCD_Exposure_Expose has returned,
+ *     so that it knows every event belonging to that exposure has been delivered.
+ * <li>A single consumer calls CCD_Exposure_Event_Wait, which blocks until there is at least one event, and
+ *     returns all the queued events in one go.
+ * </ul>
+ * Posting never blocks the exposure thread for longer than it takes to copy an event into the queue.
+ * A readout progress event replaces the last queued event if that was also readout progress, so a slow consumer
+ * sees the latest progress rather than a backlog. If the queue fills, the oldest event is dropped.
+ * @author Chris Mottram
+ * @version $Revision$
+ */
+/**
+ * This hash define is needed before including source files give us POSIX.4/IEEE1003.1b-1993 prototypes.
+ */
+#define _POSIX_SOURCE 1
+/**
+ * This hash define is needed before including source files give us POSIX.4/IEEE1003.1b-1993 prototypes.
+ */
+#define _POSIX_C_SOURCE 199309L
+#include <errno.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "log_udp.h"
+#include "ccd_global.h"
+#include "ccd_exposure.h"
+#include "ccd_exposure_event.h"
+
+/* hash defines */
+/**
+ * The maximum timeout that can be passed to CCD_Exposure_Event_Wait, in milliseconds (one hour).
+ * @see #CCD_Exposure_Event_Wait
+ */
+#define EXPOSURE_EVENT_MAX_TIMEOUT_MS	(3600000)
+
+/**
+ * Revision Control System identifier.
+ */
+static char rcsid[] = "$Id$";
+
+/* data types */
+/**
+ * Data type holding local data to ccd_exposure_event.
+ * <dl>
+ * <dt>Event_List</dt> <dd>The event queue, a ring buffer.</dd>
+ * <dt>Head</dt> <dd>The index in Event_List of the oldest queued event.</dd>
+ * <dt>Count</dt> <dd>The number of queued events.</dd>
+ * <dt>Exposure_Status</dt> <dd>The exposure status in the last phase event, used for readout progress
+ *     events.</dd>
+ * <dt>Dropped_Count</dt> <dd>The number of events dropped because the queue was full.</dd>
+ * <dt>Mutex</dt> <dd>Protects the queue, which is posted to by the exposure thread and read by the
+ *     consumer.</dd>
+ * <dt>Condition</dt> <dd>Signalled when an event is posted.</dd>
+ * </dl>
+ * @see #CCD_EXPOSURE_EVENT_QUEUE_LENGTH
+ */
+struct Exposure_Event_Struct
+{
+	struct CCD_Exposure_Event_Struct Event_List[CCD_EXPOSURE_EVENT_QUEUE_LENGTH];
+	int Head;
+	int Count;
+	enum CCD_EXPOSURE_STATUS Exposure_Status;
+	int Dropped_Count;
+	pthread_mutex_t Mutex;
+	pthread_cond_t Condition;
+};
+
+/* internal variables */
+/**
+ * Variable holding error code of last operation performed by ccd_exposure_event.
+ */
+static int Exposure_Event_Error_Number = 0;
+/**
+ * Local variable holding description of the last error that occured.
+ */
+static char Exposure_Event_Error_String[CCD_GLOBAL_ERROR_STRING_LENGTH] = "";
+/**
+ * Local exposure event data.
+ * @see #Exposure_Event_Struct
+ */
+static struct Exposure_Event_Struct Exposure_Event_Data =
+{
+	{{CCD_EXPOSURE_EVENT_TYPE_PHASE,{0L,0L},CCD_EXPOSURE_STATUS_NONE,0,0,0}},0,0,CCD_EXPOSURE_STATUS_NONE,0,
+	PTHREAD_MUTEX_INITIALIZER,PTHREAD_COND_INITIALIZER
+};
+
+/* internal function definitions */
+static void Exposure_Event_Post(struct CCD_Exposure_Event_Struct *event);
+
+/* -----------------------------------------------------------------------------
+**     external functions
+** ----------------------------------------------------------------------------- */
+/**
+ * This routine sets up ccd_exposure_event internal variables.
+ * It should be called at startup.
+ * @return This routine returns TRUE for success.
+ */
+int CCD_Exposure_Event_Initialise(void)
+{
+	Exposure_Event_Error_Number = 0;
+/* print some compile time information to stdout */
+	fprintf(stdout,"CCD_Exposure_Event_Initialise:%s.\n",rcsid);
+	return TRUE;
+}
+
+/**
+ * Routine called by ccd_exposure when the exposure status changes. A phase event is queued.
+ * @param exposure_status The new exposure status.
+ * @see #Exposure_Event_Post
+ */
+void CCD_Exposure_Event_Post_Phase(enum CCD_EXPOSURE_STATUS exposure_status)
+{
+	struct CCD_Exposure_Event_Struct event;
+
+	event.Type = CCD_EXPOSURE_EVENT_TYPE_PHASE;
+	event.Exposure_Status = exposure_status;
+	event.Pixel_Count = 0;
+	event.Expected_Pixel_Count = 0;
+	event.Id = 0;
+	Exposure_Event_Post(&event);
+}
+
+/**
+ * Routine called by ccd_exposure each time it gets the readout progress from the controller. A readout
+ * progress event is queued, unless no pixels have been read out yet.
+ * @param pixel_count The number of pixels read out so far.
+ * @param expected_pixel_count The number of pixels in the readout.
+ * @see #Exposure_Event_Post
+ */
+void CCD_Exposure_Event_Post_Readout_Progress(int pixel_count,int expected_pixel_count)
+{
+	struct CCD_Exposure_Event_Struct event;
+
+	if(pixel_count <= 0)
+		return;
+	event.Type = CCD_EXPOSURE_EVENT_TYPE_READOUT_PROGRESS;
+	event.Pixel_Count = pixel_count;
+	event.Expected_Pixel_Count = expected_pixel_count;
+	event.Id = 0;
+	Exposure_Event_Post(&event);
+}
+
+/**
+ * Routine called by the client once an asynchronous exposure has finished (CCD_Exposure_Expose has returned).
+ * A complete event is queued. As the queue is in order, every event posted by the exposure is delivered
+ * before the complete event.
+ * @param id The identifier of the asynchronous exposure.
+ * @see #Exposure_Event_Post
+ */
+void CCD_Exposure_Event_Post_Complete(int id)
+{
+	struct CCD_Exposure_Event_Struct event;
+
+	event.Type = CCD_EXPOSURE_EVENT_TYPE_COMPLETE;
+	event.Pixel_Count = 0;
+	event.Expected_Pixel_Count = 0;
+	event.Id = id;
+	Exposure_Event_Post(&event);
+}
+
+/**
+ * Wait for exposure events. The routine blocks until at least one event has been queued, or the timeout
+ * expires, and then copies all the queued events (up to max_event_count) into event_list, oldest first,
+ * and removes them from the queue.
+ * @param timeout_ms The maximum time to wait, in milliseconds. If this is zero, the routine returns
+ *        immediately with whatever events are queued.
+ * @param event_list An array to copy the events into.
+ * @param max_event_count The length of event_list.
+ * @param event_count The address of an integer, on return set to the number of events copied into
+ *        event_list. This is zero if the timeout expired.
+ * @return The routine returns TRUE on success, and FALSE if an error occurs.
+ * @see #EXPOSURE_EVENT_MAX_TIMEOUT_MS
+ * @see #CCD_EXPOSURE_EVENT_QUEUE_LENGTH
+ */
+int CCD_Exposure_Event_Wait(int timeout_ms,struct CCD_Exposure_Event_Struct *event_list,int max_event_count,
+			    int *event_count)
+{
+	struct timespec timeout_time;
+	int retval;
+
+	Exposure_Event_Error_Number = 0;
+	if((timeout_ms < 0)||(timeout_ms > EXPOSURE_EVENT_MAX_TIMEOUT_MS))
+	{
+		Exposure_Event_Error_Number = 1;
+		sprintf(Exposure_Event_Error_String,"CCD_Exposure_Event_Wait:Illegal timeout %d ms.",timeout_ms);
+		return FALSE;
+	}
+	if(event_list == NULL)
+	{
+		Exposure_Event_Error_Number = 2;
+		sprintf(Exposure_Event_Error_String,"CCD_Exposure_Event_Wait:event_list was NULL.");
+		return FALSE;
+	}
+	if(event_count == NULL)
+	{
+		Exposure_Event_Error_Number = 3;
+		sprintf(Exposure_Event_Error_String,"CCD_Exposure_Event_Wait:event_count was NULL.");
+		return FALSE;
+	}
+	(*event_count) = 0;
+	clock_gettime(CLOCK_REALTIME,&timeout_time);
+	timeout_time.tv_sec += timeout_ms/CCD_GLOBAL_ONE_SECOND_MS;
+	timeout_time.tv_nsec += (timeout_ms%CCD_GLOBAL_ONE_SECOND_MS)*CCD_GLOBAL_ONE_MILLISECOND_NS;
+	if(timeout_time.tv_nsec >= CCD_GLOBAL_ONE_SECOND_NS)
+	{
+		timeout_time.tv_sec++;
+		timeout_time.tv_nsec -= CCD_GLOBAL_ONE_SECOND_NS;
+	}
+	pthread_mutex_lock(&(Exposure_Event_Data.Mutex));
+	retval = 0;
+	while((Exposure_Event_Data.Count == 0)&&(timeout_ms > 0)&&(retval != ETIMEDOUT))
+	{
+		retval = pthread_cond_timedwait(&(Exposure_Event_Data.Condition),&(Exposure_Event_Data.Mutex),
+						&timeout_time);
+	}
+	while((Exposure_Event_Data.Count > 0)&&((*event_count) < max_event_count))
+	{
+		event_list[(*event_count)] = Exposure_Event_Data.Event_List[Exposure_Event_Data.Head];
+		(*event_count)++;
+		Exposure_Event_Data.Head = (Exposure_Event_Data.Head+1)%CCD_EXPOSURE_EVENT_QUEUE_LENGTH;
+		Exposure_Event_Data.Count--;
+	}
+	pthread_mutex_unlock(&(Exposure_Event_Data.Mutex));
+	return TRUE;
+}
+
+/**
+ * Remove all queued events. This is called before an asynchronous exposure is started, so that events left over
+ * from previous (synchronous) exposures are not delivered.
+ */
+void CCD_Exposure_Event_Flush(void)
+{
+	pthread_mutex_lock(&(Exposure_Event_Data.Mutex));
+	Exposure_Event_Data.Head = 0;
+	Exposure_Event_Data.Count = 0;
+	pthread_mutex_unlock(&(Exposure_Event_Data.Mutex));
+}
+
+/**
+ * Get the number of events that have been dropped because the queue was full.
+ * @return The number of dropped events.
+ * @see #Exposure_Event_Data
+ */
+int CCD_Exposure_Event_Get_Dropped_Count(void)
+{
+	int dropped_count;
+
+	pthread_mutex_lock(&(Exposure_Event_Data.Mutex));
+	dropped_count = Exposure_Event_Data.Dropped_Count;
+	pthread_mutex_unlock(&(Exposure_Event_Data.Mutex));
+	return dropped_count;
+}
+
+/**
+ * Get the current value of ccd_exposure_event's error number.
+ * @return The current value of ccd_exposure_event's error number.
+ */
+int CCD_Exposure_Event_Get_Error_Number(void)
+{
+	return Exposure_Event_Error_Number;
+}
+
+/**
+ * The error routine that reports any errors occuring in ccd_exposure_event in a standard way.
+ * @see ccd_global.html#CCD_Global_Get_Current_Time_String
+ */
+void CCD_Exposure_Event_Error(void)
+{
+	char time_string[32];
+
+	CCD_Global_Get_Current_Time_String(time_string,32);
+	/* if the error number is zero an error message has not been set up
+	** This is in itself an error as we should not be calling this routine
+	** without there being an error to display */
+	if(Exposure_Event_Error_Number == 0)
+		sprintf(Exposure_Event_Error_String,"Logic Error:No Error defined");
+	fprintf(stderr,"%s CCD_Exposure_Event:Error(%d) : %s\n",time_string,Exposure_Event_Error_Number,
+		Exposure_Event_Error_String);
+}
+
+/**
+ * The error routine that reports any errors occuring in ccd_exposure_event in a standard way. This routine
+ * places the generated error string at the end of a passed in string argument.
+ * @param error_string A string to put the generated error in. This string should be initialised before
+ * being passed to this routine. The routine will try to concatenate it's error string onto the end
+ * of any string already in existance.
+ * @see ccd_global.html#CCD_Global_Get_Current_Time_String
+ */
+void CCD_Exposure_Event_Error_String(char *error_string)
+{
+	char time_string[32];
+
+	CCD_Global_Get_Current_Time_String(time_string,32);
+	/* if the error number is zero an error message has not been set up
+	** This is in itself an error as we should not be calling this routine
+	** without there being an error to display */
+	if(Exposure_Event_Error_Number == 0)
+		sprintf(Exposure_Event_Error_String,"Logic Error:No Error defined");
+	sprintf(error_string+strlen(error_string),"%s CCD_Exposure_Event:Error(%d) : %s\n",time_string,
+		Exposure_Event_Error_Number,Exposure_Event_Error_String);
+}
+
+/* -----------------------------------------------------------------------------
+**     internal functions
+** ----------------------------------------------------------------------------- */
+/**
+ * Add an event to the queue, and wake up the consumer. The event is time stamped. Phase events update
+ * the remembered exposure status, which is copied into readout progress and complete events.
+ * A readout progress event replaces the newest queued event, if that is also a readout progress event.
+ * If the queue is full the oldest event is dropped.
+ * @param event The event to queue. The Time_Stamp (and for non-phase events, the Exposure_Status) are filled in.
+ * @see #Exposure_Event_Data
+ * @see #CCD_EXPOSURE_EVENT_QUEUE_LENGTH
+ */
+static void Exposure_Event_Post(struct CCD_Exposure_Event_Struct *event)
+{
+	int index;
+
+	clock_gettime(CLOCK_REALTIME,&(event->Time_Stamp));
+	pthread_mutex_lock(&(Exposure_Event_Data.Mutex));
+	if(event->Type == CCD_EXPOSURE_EVENT_TYPE_PHASE)
+		Exposure_Event_Data.Exposure_Status = event->Exposure_Status;
+	else
+		event->Exposure_Status = Exposure_Event_Data.Exposure_Status;
+	/* merge consecutive readout progress events */
+	if((event->Type == CCD_EXPOSURE_EVENT_TYPE_READOUT_PROGRESS)&&(Exposure_Event_Data.Count > 0))
+	{
+		index = (Exposure_Event_Data.Head+Exposure_Event_Data.Count-1)%CCD_EXPOSURE_EVENT_QUEUE_LENGTH;
+		if(Exposure_Event_Data.Event_List[index].Type == CCD_EXPOSURE_EVENT_TYPE_READOUT_PROGRESS)
+		{
+			Exposure_Event_Data.Event_List[index] = (*event);
+			pthread_cond_signal(&(Exposure_Event_Data.Condition));
+			pthread_mutex_unlock(&(Exposure_Event_Data.Mutex));
+			return;
+		}
+	}
+	/* drop the oldest event if the queue is full */
+	if(Exposure_Event_Data.Count == CCD_EXPOSURE_EVENT_QUEUE_LENGTH)
+	{
+		Exposure_Event_Data.Head = (Exposure_Event_Data.Head+1)%CCD_EXPOSURE_EVENT_QUEUE_LENGTH;
+		Exposure_Event_Data.Count--;
+		Exposure_Event_Data.Dropped_Count++;
+	}
+	index = (Exposure_Event_Data.Head+Exposure_Event_Data.Count)%CCD_EXPOSURE_EVENT_QUEUE_LENGTH;
+	Exposure_Event_Data.Event_List[index] = (*event);
+	Exposure_Event_Data.Count++;
+	pthread_cond_signal(&(Exposure_Event_Data.Condition));
+	pthread_mutex_unlock(&(Exposure_Event_Data.Mutex));
+}
+
+/*
+** $Log: not supported by cvs2svn $
+*/
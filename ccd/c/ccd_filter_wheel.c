@@ -16,6 +16,7 @@
  * This hash define is needed before including source files give us POSIX.4/IEEE1003.1b-1993 prototypes.
  */
 #define _POSIX_C_SOURCE 199309L
+#include <pthread.h>
 #include <stdio.h>
 #include <string.h>
 #include <math.h>
@@ -37,6 +38,51 @@ static char rcsid[] = "$Id: ccd_filter_wheel.c,v 1.4 2014-01-27 16:45:47 cjm Exp
  * @see #Filter_Wheel_Struct
  */
 #define FW_DEFAULT_POSITION_COUNT		(12)
+/**
+ * The maximum number of positions in a filter wheel we can keep move time statistics for.
+ * @see #Filter_Wheel_Struct
+ */
+#define FW_MAX_POSITION_COUNT			(16)
+/**
+ * The default (and maximum) client side timeout for a move or reset, in seconds.
+ * This is used until we have enough timed moves to predict the time a move should take.
+ */
+#define FW_MOVE_TIMEOUT_DEFAULT			(120.0)
+/**
+ * The number of timed moves between a pair of positions we need, before we use the move time statistics
+ * to calculate a tighter client side timeout.
+ */
+#define FW_MOVE_STATS_MIN_COUNT			(3)
+/**
+ * The number of standard deviations above the mean move time to allow, when calculating a move timeout.
+ */
+#define FW_MOVE_TIMEOUT_SIGMA			(5.0)
+/**
+ * A fixed margin in seconds added to the predicted move time when calculating a move timeout.
+ */
+#define FW_MOVE_TIMEOUT_MARGIN			(10.0)
+/**
+ * A rough estimate of the time taken to drive the locators out and back in, in seconds.
+ * Only used to estimate move times before any moves have been timed.
+ */
+#define FW_DEFAULT_LOCATOR_TIME			(4.0)
+/**
+ * A rough estimate of the time taken to move the wheel through one position, in seconds.
+ * Only used to estimate move times before any moves have been timed.
+ */
+#define FW_DEFAULT_POSITION_MOVE_TIME		(2.0)
+/**
+ * How long to sleep between status polls, in milliseconds, whilst the move is not predicted to finish soon.
+ */
+#define FW_POLL_COARSE_SLEEP_MS			(50)
+/**
+ * How long to sleep between status polls, in milliseconds, when the move is predicted to finish soon.
+ */
+#define FW_POLL_FINE_SLEEP_MS			(2)
+/**
+ * How long before the predicted end of a move, in seconds, we switch from coarse to fine status polling.
+ */
+#define FW_POLL_FINE_WINDOW			(1.0)
 /**
  * How often, in milliseconds the SERVICE routine is executed.
  * This is 0.8.
@@ -256,20 +302,63 @@ static char rcsid[] = "$Id: ccd_filter_wheel.c,v 1.4 2014-01-27 16:45:47 cjm Exp
 #define FW_OUTPUT_CLUTCH_DISENGAGE             (1<<2)
 
 /* data types */
+/**
+ * Data type holding running statistics on how long a filter wheel operation takes.
+ * The mean and variance are accumulated using Welford's method.
+ * <dl>
+ * <dt>Count</dt> <dd>The number of operations timed.</dd>
+ * <dt>Mean</dt> <dd>The mean time taken, in seconds.</dd>
+ * <dt>Sum_Squares</dt> <dd>The sum of squared differences from the mean, used to calculate the variance.</dd>
+ * <dt>Min</dt> <dd>The shortest time taken, in seconds.</dd>
+ * <dt>Max</dt> <dd>The longest time taken, in seconds.</dd>
+ * </dl>
+ */
+struct Filter_Wheel_Move_Stats_Struct
+{
+	int Count;
+	double Mean;
+	double Sum_Squares;
+	double Min;
+	double Max;
+};
+
 /**
  * Data type holding local data to ccd_filter_wheel. This is the current position of each wheel.
  * <dl>
  * <dt>Position</dt> <dd>The position the filter wheel has attained.
  * <dt>Position_Count</dt> <dd>The number of filter positions in each wheel. Normally twelve.</dd>
  * <dt>Status</dt> <dd>What operation the filter wheel sub-system is performing.</dd>
+ * <dt>Move_Stats</dt> <dd>Move time statistics for each (start position,target position) pair.</dd>
+ * <dt>Offset_Stats</dt> <dd>Move time statistics for each forward offset (number of positions moved through),
+ *     used to estimate moves between position pairs we have not timed yet.</dd>
+ * <dt>Reset_Stats</dt> <dd>Reset time statistics.</dd>
+ * <dt>Stats_Mutex</dt> <dd>Mutex protecting the statistics, which are updated by the move thread
+ *     and read by other threads, and the Move_Thread fields.</dd>
+ * <dt>Move_Thread</dt> <dd>The thread started by CCD_Filter_Wheel_Move_Start to do an asynchronous move.</dd>
+ * <dt>Move_Thread_Active</dt> <dd>A boolean, TRUE between CCD_Filter_Wheel_Move_Start and 
+ *     CCD_Filter_Wheel_Move_Wait.</dd>
+ * <dt>Move_Thread_Handle</dt> <dd>The interface handle the asynchronous move is using.</dd>
+ * <dt>Move_Thread_Position</dt> <dd>The position the asynchronous move is moving to.</dd>
+ * <dt>Move_Thread_Retval</dt> <dd>The return value of CCD_Filter_Wheel_Move in the asynchronous move thread.</dd>
  * </dl>
  * @see #CCD_FILTER_WHEEL_STATUS
+ * @see #Filter_Wheel_Move_Stats_Struct
+ * @see #FW_MAX_POSITION_COUNT
  */
 struct Filter_Wheel_Struct
 {
 	int Position;
 	int Position_Count;
 	enum CCD_FILTER_WHEEL_STATUS Status;
+	struct Filter_Wheel_Move_Stats_Struct Move_Stats[FW_MAX_POSITION_COUNT][FW_MAX_POSITION_COUNT];
+	struct Filter_Wheel_Move_Stats_Struct Offset_Stats[FW_MAX_POSITION_COUNT];
+	struct Filter_Wheel_Move_Stats_Struct Reset_Stats;
+	pthread_mutex_t Stats_Mutex;
+	pthread_t Move_Thread;
+	volatile int Move_Thread_Active;
+	CCD_Interface_Handle_T* Move_Thread_Handle;
+	int Move_Thread_Position;
+	int Move_Thread_Retval;
 };
 
 /* external variables */
@@ -290,10 +379,17 @@ static char Filter_Wheel_Error_String[CCD_GLOBAL_ERROR_STRING_LENGTH] = "";
  */
 static struct Filter_Wheel_Struct Filter_Wheel_Data = 
 {
-	-1,FW_DEFAULT_POSITION_COUNT,CCD_FILTER_WHEEL_STATUS_NONE
+	-1,FW_DEFAULT_POSITION_COUNT,CCD_FILTER_WHEEL_STATUS_NONE,{{{0,0.0,0.0,0.0,0.0}}},{{0,0.0,0.0,0.0,0.0}},
+	{0,0.0,0.0,0.0,0.0},PTHREAD_MUTEX_INITIALIZER,0,FALSE,NULL,-1,FALSE
 };
 
 /* internal function definitions */
+static void *Filter_Wheel_Move_Thread(void *user_arg);
+static void Filter_Wheel_Move_Time_Get(int from_position,int to_position,double *estimate_secs,
+				       double *stddev_secs,int *count);
+static double Filter_Wheel_Move_Timeout_Get(int from_position,int to_position);
+static void Filter_Wheel_Stats_Add(struct Filter_Wheel_Move_Stats_Struct *stats,double length_secs);
+static double Filter_Wheel_Stats_Stddev(struct Filter_Wheel_Move_Stats_Struct *stats);
 static void Filter_Wheel_Print_Status(int fw_status,int fw_move_timeout_index);
 static void Filter_Wheel_Print_Digital_Inputs(int fw_dig_in);
 static void Filter_Wheel_Print_Proximity(int fw_dig_in,char *description_string);
@@ -320,17 +416,31 @@ int CCD_Filter_Wheel_Initialise(void)
 	Filter_Wheel_Data.Position = -1;
 	Filter_Wheel_Data.Position_Count = FW_DEFAULT_POSITION_COUNT;
 	Filter_Wheel_Data.Status = CCD_FILTER_WHEEL_STATUS_NONE;
+	pthread_mutex_lock(&(Filter_Wheel_Data.Stats_Mutex));
+	memset(Filter_Wheel_Data.Move_Stats,0,sizeof(Filter_Wheel_Data.Move_Stats));
+	memset(Filter_Wheel_Data.Offset_Stats,0,sizeof(Filter_Wheel_Data.Offset_Stats));
+	memset(&(Filter_Wheel_Data.Reset_Stats),0,sizeof(Filter_Wheel_Data.Reset_Stats));
+	pthread_mutex_unlock(&(Filter_Wheel_Data.Stats_Mutex));
 	return TRUE;
 }
 
 /**
  * Routine to set how many positions in the filter wheel.
- * @param position_count How many positions. This is nominally twelve.
+ * @param position_count How many positions. This is nominally twelve, and must be between 1 and
+ *        FW_MAX_POSITION_COUNT.
  * @return The routine returns TRUE if it succeeded, and FALSE if it failed.
+ * @see #FW_MAX_POSITION_COUNT
  */
 int CCD_Filter_Wheel_Position_Count_Set(int position_count)
 {
 	Filter_Wheel_Error_Number = 0;
+	if((position_count < 1)||(position_count > FW_MAX_POSITION_COUNT))
+	{
+		Filter_Wheel_Error_Number = 33;
+		sprintf(Filter_Wheel_Error_String,"Position_Count_Set:Illegal position count %d (1,%d).",
+			position_count,FW_MAX_POSITION_COUNT);
+		return FALSE;
+	}
 	Filter_Wheel_Data.Position_Count = position_count;
 	return TRUE;
 }
@@ -344,6 +454,68 @@ int CCD_Filter_Wheel_Position_Count_Get(void)
 	return Filter_Wheel_Data.Position_Count;
 }
 
+/**
+ * Routine to work out how many positions the wheel has to move through to get from one position to another.
+ * The filter wheel motor is not reversible, the FWM DSP command always drives the wheel forward
+ * (increasing position number, wrapping around at the position count) from Y:FW_LAST_POS to the target.
+ * The number of positions moved through is therefore the forward offset modulo the wheel position count,
+ * which is what the DSP code calculates into Y:FW_OFFSET_POS.
+ * @param from_position The position the wheel starts in (0..N-1).
+ * @param to_position The position the wheel is moving to (0..N-1).
+ * @return The number of positions the wheel moves through (0..N-1), or -1 if either position is out of range.
+ * @see #Filter_Wheel_Data
+ * @see #FW_MEM_LOC_UTIL_BOARD_OFFSET_POS
+ */
+int CCD_Filter_Wheel_Move_Offset_Get(int from_position,int to_position)
+{
+	int position_count;
+
+	position_count = Filter_Wheel_Data.Position_Count;
+	if((from_position < 0)||(from_position >= position_count)||(to_position < 0)||(to_position >= position_count))
+		return -1;
+	return (to_position-from_position+position_count)%position_count;
+}
+
+/**
+ * Routine to estimate how long a filter wheel move will take, based on the statistics gathered from
+ * previous moves.
+ * <ul>
+ * <li>If we have timed moves between this pair of positions, the mean move time is returned.
+ * <li>Otherwise, if we have timed moves with the same forward offset, the mean move time for that offset is returned.
+ * <li>Otherwise a rough estimate is made from FW_DEFAULT_LOCATOR_TIME and FW_DEFAULT_POSITION_MOVE_TIME.
+ * </ul>
+ * If from_position is -1 (the wheel position is unknown), the move will start with a reset. The estimate is 
+ * then the reset time plus the worst case (N-1 positions) move time.
+ * @param from_position The position the wheel starts in (0..N-1), or -1 if the current position is unknown.
+ * @param to_position The position the wheel is moving to (0..N-1).
+ * @param estimate_secs The address of a double, on return filled in with the estimated move time in seconds.
+ * @return The routine returns TRUE if it succeeded, and FALSE if it failed.
+ * @see #Filter_Wheel_Move_Time_Get
+ */
+int CCD_Filter_Wheel_Move_Time_Estimate(int from_position,int to_position,double *estimate_secs)
+{
+	double stddev_secs;
+	int count;
+
+	Filter_Wheel_Error_Number = 0;
+	if((from_position < -1)||(from_position >= Filter_Wheel_Data.Position_Count)||
+	   (to_position < 0)||(to_position >= Filter_Wheel_Data.Position_Count))
+	{
+		Filter_Wheel_Error_Number = 38;
+		sprintf(Filter_Wheel_Error_String,"Move_Time_Estimate:Illegal position (%d,%d) (0,%d).",
+			from_position,to_position,Filter_Wheel_Data.Position_Count);
+		return FALSE;
+	}
+	if(estimate_secs == NULL)
+	{
+		Filter_Wheel_Error_Number = 39;
+		sprintf(Filter_Wheel_Error_String,"Move_Time_Estimate:estimate_secs was NULL.");
+		return FALSE;
+	}
+	Filter_Wheel_Move_Time_Get(from_position,to_position,estimate_secs,&stddev_secs,&count);
+	return TRUE;
+}
+
 
 /**
  * Routine to reset the filter wheel. This drives the wheel into the next position, and works out where
@@ -352,6 +524,7 @@ int CCD_Filter_Wheel_Position_Count_Get(void)
  * <li>We change the Filter_Wheel_Data.Position to -1 whilst we are moving the wheel.
  * <li>We set the filter wheel status to MOVING.
  * <li>We call CCD_DSP_Command_FWR to call the FWR command.
+ * <li>We call Filter_Wheel_Move_Timeout_Get to get a client side timeout based on previous reset times.
  * <li>We enter a loop:
  *     <ul>
  *     <li>We use CCD_DSP_Command_RDM to get the X:STATUS word.
@@ -374,7 +547,8 @@ int CCD_Filter_Wheel_Position_Count_Get(void)
  * <li>We use CCD_DSP_Command_RDM to get Y:DIG_IN, the current digitial inputs.
  * <li>We use CCD_DSP_Command_RDM to get Y:FW_LAST_POS, which contains the wheel absolute position 
  *     if FWR was successful.
- * <li>If the reset succeeded, we update Filter_Wheel_Data.Position to the contents of Y:FW_LAST_POS.
+ * <li>If the reset succeeded, we add the time it took to the reset statistics using Filter_Wheel_Stats_Add, and
+ *     update Filter_Wheel_Data.Position to the contents of Y:FW_LAST_POS.
  * </ul>
  * @param handle The address of a CCD_Interface_Handle_T that holds the device connection specific information.
  * @param position The position to move the specified wheel to. An integer greater or equal to zero and less
@@ -399,6 +573,8 @@ int CCD_Filter_Wheel_Position_Count_Get(void)
  * @see #Filter_Wheel_Print_Digital_Inputs
  * @see #Filter_Wheel_Print_Proximity
  * @see #Filter_Wheel_Print_Digital_Outputs
+ * @see #Filter_Wheel_Move_Timeout_Get
+ * @see #Filter_Wheel_Stats_Add
  * @see ccd_dsp.html#CCD_DSP_Command_FWR
  * @see ccd_dsp.html#CCD_DSP_Command_RDM
  * @see ccd_dsp.html#CCD_DSP_BOARD_ID
@@ -431,13 +607,13 @@ int CCD_Filter_Wheel_Reset(CCD_Interface_Handle_T* handle)
 	}
 /* enter loop - monitoring for completion */
 	done = FALSE;
-        timeout_length = 120;/* diddly */
+	timeout_length = Filter_Wheel_Move_Timeout_Get(-1,-1);
 	clock_gettime(CLOCK_REALTIME,&start_time);
 	while(done == FALSE)
 	{
 	/* sleep for 2 milliseconds */
 		sleep_time.tv_sec = 0;
-		sleep_time.tv_nsec = 2*1000000;
+		sleep_time.tv_nsec = FW_POLL_FINE_SLEEP_MS*CCD_GLOBAL_ONE_MILLISECOND_NS;
 		nanosleep(&sleep_time,NULL);
 	/* get utility board X:STATUS word */
 #if LOGGING > 0
@@ -527,6 +703,7 @@ int CCD_Filter_Wheel_Reset(CCD_Interface_Handle_T* handle)
 	/* keep looping until utility board is no longer reseting wheel */
 		done = ((fw_status&FW_STATUS_BIT_RESET)==0);
 	}/* end while */
+	length_secs = fdifftime(current_time,start_time);
 	Filter_Wheel_Data.Status = CCD_FILTER_WHEEL_STATUS_NONE;
 /* the move bit is no longer set. Why? */
 	/* check filter wheel error code */
@@ -571,6 +748,14 @@ int CCD_Filter_Wheel_Reset(CCD_Interface_Handle_T* handle)
 		return FALSE;
 	}
 	Filter_Wheel_Print_Proximity(fw_dig_in,"Final Actual");
+	/* add the successful reset to the reset time statistics */
+	pthread_mutex_lock(&(Filter_Wheel_Data.Stats_Mutex));
+	Filter_Wheel_Stats_Add(&(Filter_Wheel_Data.Reset_Stats),length_secs);
+	pthread_mutex_unlock(&(Filter_Wheel_Data.Stats_Mutex));
+#if LOGGING > 0
+	CCD_Global_Log_Format(LOG_VERBOSITY_VERY_VERBOSE,"CCD_Filter_Wheel_Reset:Reset took %.3f seconds.",
+			      length_secs);
+#endif
 #else
 #if LOGGING > 0
 	CCD_Global_Log(LOG_VERBOSITY_VERY_VERBOSE,"CCD_Filter_Wheel_Reset: "
@@ -589,12 +774,21 @@ int CCD_Filter_Wheel_Reset(CCD_Interface_Handle_T* handle)
  * Routine to move the filter wheel to an absolute location.
  * <ul>
  * <li>The parameters are checked.
+ * <li>If an asynchronous move started by CCD_Filter_Wheel_Move_Start is in progress 
+ *     (and we are not that move's thread), we return an error.
  * <li>If the wheel is already in the correct position, we return TRUE.
+ * <li>If the wheel position is unknown, we call CCD_Filter_Wheel_Reset to drive the wheel into a known position.
+ * <li>We plan the move: CCD_Filter_Wheel_Move_Offset_Get is used to calculate how many positions the wheel
+ *     will move through (the wheel only moves forward), and Filter_Wheel_Move_Time_Get / 
+ *     Filter_Wheel_Move_Timeout_Get are used to predict the move time and a client side timeout 
+ *     from previous moves.
  * <li>We change the Filter_Wheel_Data.Position to -1 whilst we are moving the wheel.
  * <li>We set the filter wheel status to MOVING.
  * <li>We call CCD_DSP_Command_FWM to call the FWM command with the passed in position parameter.
  * <li>We enter a loop:
  *     <ul>
+ *     <li>We sleep for FW_POLL_COARSE_SLEEP_MS if the move is not predicted to finish within 
+ *         FW_POLL_FINE_WINDOW seconds, otherwise for FW_POLL_FINE_SLEEP_MS.
  *     <li>We use CCD_DSP_Command_RDM to get the X:STATUS word.
  *     <li>We get the current time, compare it with a timestamp stored before entering the loop, and exit
  *         with an error if we have timed out.
@@ -622,7 +816,8 @@ int CCD_Filter_Wheel_Reset(CCD_Interface_Handle_T* handle)
  * <li>We call Filter_Wheel_Print_Proximity to print the FINAL TARGET proximity pattern.
  * <li>If the digital inputs ANDed with the proximity mask does not equal the target proximity pattern,
  *     we are in the wrong position and return an error.
- * <li>If the move succeeded, we update Filter_Wheel_Data.Position to the new position.
+ * <li>If the move succeeded, we add the time it took to the move statistics for this position pair and
+ *     forward offset, and update Filter_Wheel_Data.Position to the new position.
  * </ul>
  * @param handle The address of a CCD_Interface_Handle_T that holds the device connection specific information.
  * @param position The position to move the specified wheel to. An integer greater or equal to zero and less
@@ -648,6 +843,13 @@ int CCD_Filter_Wheel_Reset(CCD_Interface_Handle_T* handle)
  * @see #Filter_Wheel_Print_Digital_Inputs
  * @see #Filter_Wheel_Print_Proximity
  * @see #Filter_Wheel_Print_Digital_Outputs
+ * @see #CCD_Filter_Wheel_Move_Offset_Get
+ * @see #Filter_Wheel_Move_Time_Get
+ * @see #Filter_Wheel_Move_Timeout_Get
+ * @see #Filter_Wheel_Stats_Add
+ * @see #FW_POLL_COARSE_SLEEP_MS
+ * @see #FW_POLL_FINE_SLEEP_MS
+ * @see #FW_POLL_FINE_WINDOW
  * @see ccd_dsp.html#CCD_DSP_Command_FWM
  * @see ccd_dsp.html#CCD_DSP_Command_RDM
  * @see ccd_dsp.html#CCD_DSP_BOARD_ID
@@ -657,8 +859,8 @@ int CCD_Filter_Wheel_Move(CCD_Interface_Handle_T* handle,int position)
 {
 	struct timespec start_time,current_time,sleep_time;
 	int done,fw_status,fw_dig_in,fw_dig_out,fw_last_pos,fw_target_pos,fw_offset_pos,fw_target_proximity_pattern;
-	int fw_error_code,fw_move_timeout_index;
-	double timeout_length,length_secs;
+	int fw_error_code,fw_move_timeout_index,start_position,offset_count,estimate_count;
+	double timeout_length,length_secs,estimate_secs,estimate_stddev_secs;
 
 	Filter_Wheel_Error_Number = 0;
 #if LOGGING > 0
@@ -672,6 +874,17 @@ int CCD_Filter_Wheel_Move(CCD_Interface_Handle_T* handle,int position)
 			Filter_Wheel_Data.Position_Count);
 		return FALSE;
 	}
+/* only the asynchronous move thread can move the wheel whilst an asynchronous move is in progress */
+	pthread_mutex_lock(&(Filter_Wheel_Data.Stats_Mutex));
+	if(Filter_Wheel_Data.Move_Thread_Active && (!pthread_equal(pthread_self(),Filter_Wheel_Data.Move_Thread)))
+	{
+		Filter_Wheel_Error_Number = 34;
+		sprintf(Filter_Wheel_Error_String,"Move:Asynchronous move to position %d already in progress.",
+			Filter_Wheel_Data.Move_Thread_Position);
+		pthread_mutex_unlock(&(Filter_Wheel_Data.Stats_Mutex));
+		return FALSE;
+	}
+	pthread_mutex_unlock(&(Filter_Wheel_Data.Stats_Mutex));
 /* if we are already at the correct position, don't move and return success now */
 	if(position == Filter_Wheel_Data.Position)
 	{
@@ -692,6 +905,17 @@ int CCD_Filter_Wheel_Move(CCD_Interface_Handle_T* handle,int position)
 		if(!CCD_Filter_Wheel_Reset(handle))
 			return FALSE;
 	}
+/* plan the move: the wheel only moves forward, so the offset is modulo the position count */
+	start_position = Filter_Wheel_Data.Position;
+	offset_count = CCD_Filter_Wheel_Move_Offset_Get(start_position,position);
+	Filter_Wheel_Move_Time_Get(start_position,position,&estimate_secs,&estimate_stddev_secs,&estimate_count);
+	timeout_length = Filter_Wheel_Move_Timeout_Get(start_position,position);
+#if LOGGING > 0
+	CCD_Global_Log_Format(LOG_VERBOSITY_VERBOSE,"CCD_Filter_Wheel_Move:Moving from %d to %d:"
+			      "offset %d positions:estimated time %.2f +/- %.2f seconds (%d moves):timeout %.2f.",
+			      start_position,position,offset_count,estimate_secs,estimate_stddev_secs,estimate_count,
+			      timeout_length);
+#endif
 /* wheels position is indeterminate during move */
 	Filter_Wheel_Data.Position = -1;
 /* do move */
@@ -708,13 +932,16 @@ int CCD_Filter_Wheel_Move(CCD_Interface_Handle_T* handle,int position)
 	}
 /* enter loop - monitoring for completion */
 	done = FALSE;
-        timeout_length = 120;/* diddly */
 	clock_gettime(CLOCK_REALTIME,&start_time);
+	current_time = start_time;
 	while(done == FALSE)
 	{
-	/* sleep for 2 milliseconds */
+	/* sleep - polling the utility board less often whilst the wheel is not predicted to be near the target */
 		sleep_time.tv_sec = 0;
-		sleep_time.tv_nsec = 2*1000000;
+		if(fdifftime(current_time,start_time) < (estimate_secs-FW_POLL_FINE_WINDOW))
+			sleep_time.tv_nsec = FW_POLL_COARSE_SLEEP_MS*CCD_GLOBAL_ONE_MILLISECOND_NS;
+		else
+			sleep_time.tv_nsec = FW_POLL_FINE_SLEEP_MS*CCD_GLOBAL_ONE_MILLISECOND_NS;
 		nanosleep(&sleep_time,NULL);
 	/* get utility board X:STATUS word */
 #if LOGGING > 0
@@ -813,6 +1040,7 @@ int CCD_Filter_Wheel_Move(CCD_Interface_Handle_T* handle,int position)
 	/* keep looping until utility board is no longer moving wheel */
 		done = ((fw_status&FW_STATUS_BIT_MOVE)==0);
 	}/* end while */
+	length_secs = fdifftime(current_time,start_time);
 	Filter_Wheel_Data.Status = CCD_FILTER_WHEEL_STATUS_NONE;
 /* the move bit is no longer set. Why? */
 	/* check filter wheel error code */
@@ -869,6 +1097,15 @@ int CCD_Filter_Wheel_Move(CCD_Interface_Handle_T* handle,int position)
 			fw_target_proximity_pattern,(fw_dig_in& FW_INPUT_PROXIMITY_MASK));
 		return FALSE;
 	}
+	/* add the successful move to the move time statistics */
+	pthread_mutex_lock(&(Filter_Wheel_Data.Stats_Mutex));
+	Filter_Wheel_Stats_Add(&(Filter_Wheel_Data.Move_Stats[start_position][position]),length_secs);
+	Filter_Wheel_Stats_Add(&(Filter_Wheel_Data.Offset_Stats[offset_count]),length_secs);
+	pthread_mutex_unlock(&(Filter_Wheel_Data.Stats_Mutex));
+#if LOGGING > 0
+	CCD_Global_Log_Format(LOG_VERBOSITY_VERBOSE,"CCD_Filter_Wheel_Move:Move from %d to %d took %.3f seconds "
+			      "(estimated %.2f).",start_position,position,length_secs,estimate_secs);
+#endif
 #else
 #if LOGGING > 0
 	CCD_Global_Log(LOG_VERBOSITY_VERY_VERBOSE,"CCD_Filter_Wheel_Move: "
@@ -883,6 +1120,119 @@ int CCD_Filter_Wheel_Move(CCD_Interface_Handle_T* handle,int position)
 	return TRUE;
 }
 
+/**
+ * Routine to start an asynchronous move of the filter wheel to an absolute location. A thread is started
+ * which calls CCD_Filter_Wheel_Move, so the caller can carry on configuring other parts of the instrument 
+ * whilst the wheel is moving. CCD_Filter_Wheel_Move_Wait <b>must</b> be called to wait for the move to complete
+ * and get it's result, before another move can be started.
+ * The move can be aborted using CCD_Filter_Wheel_Abort as normal.
+ * @param handle The address of a CCD_Interface_Handle_T that holds the device connection specific information.
+ *        This must remain valid until CCD_Filter_Wheel_Move_Wait has been called.
+ * @param position The position to move the wheel to (0..N-1).
+ * @return The routine returns TRUE if the move thread was started, and FALSE if it failed.
+ * @see #Filter_Wheel_Data
+ * @see #Filter_Wheel_Move_Thread
+ * @see #CCD_Filter_Wheel_Move
+ * @see #CCD_Filter_Wheel_Move_Wait
+ * @see #CCD_Filter_Wheel_Abort
+ */
+int CCD_Filter_Wheel_Move_Start(CCD_Interface_Handle_T* handle,int position)
+{
+	pthread_t move_thread;
+	int retval;
+
+	Filter_Wheel_Error_Number = 0;
+#if LOGGING > 0
+	CCD_Global_Log_Format(LOG_VERBOSITY_VERY_VERBOSE,"CCD_Filter_Wheel_Move_Start(position=%d) started.",
+			      position);
+#endif
+	if((position < 0)||(position >= Filter_Wheel_Data.Position_Count))
+	{
+		Filter_Wheel_Error_Number = 40;
+		sprintf(Filter_Wheel_Error_String,"Move_Start:Illegal Position '%d' (0,%d).",position,
+			Filter_Wheel_Data.Position_Count);
+		return FALSE;
+	}
+	/* check and set Move_Thread_Active under the mutex, so two concurrent calls can't both start a move */
+	pthread_mutex_lock(&(Filter_Wheel_Data.Stats_Mutex));
+	if(Filter_Wheel_Data.Move_Thread_Active)
+	{
+		Filter_Wheel_Error_Number = 34;
+		sprintf(Filter_Wheel_Error_String,"Move_Start:Asynchronous move to position %d already in progress.",
+			Filter_Wheel_Data.Move_Thread_Position);
+		pthread_mutex_unlock(&(Filter_Wheel_Data.Stats_Mutex));
+		return FALSE;
+	}
+	Filter_Wheel_Data.Move_Thread_Handle = handle;
+	Filter_Wheel_Data.Move_Thread_Position = position;
+	Filter_Wheel_Data.Move_Thread_Retval = FALSE;
+	Filter_Wheel_Data.Move_Thread_Active = TRUE;
+	pthread_mutex_unlock(&(Filter_Wheel_Data.Stats_Mutex));
+	retval = pthread_create(&move_thread,NULL,Filter_Wheel_Move_Thread,NULL);
+	pthread_mutex_lock(&(Filter_Wheel_Data.Stats_Mutex));
+	if(retval != 0)
+	{
+		Filter_Wheel_Data.Move_Thread_Active = FALSE;
+		pthread_mutex_unlock(&(Filter_Wheel_Data.Stats_Mutex));
+		Filter_Wheel_Error_Number = 35;
+		sprintf(Filter_Wheel_Error_String,"Move_Start:Failed to create move thread (%d,%s).",retval,
+			strerror(retval));
+		return FALSE;
+	}
+	/* the move thread also stores it's own id, in case it needs it before we get here */
+	Filter_Wheel_Data.Move_Thread = move_thread;
+	pthread_mutex_unlock(&(Filter_Wheel_Data.Stats_Mutex));
+#if LOGGING > 0
+	CCD_Global_Log(LOG_VERBOSITY_VERY_VERBOSE,"CCD_Filter_Wheel_Move_Start() returned TRUE.");
+#endif
+	return TRUE;
+}
+
+/**
+ * Routine to wait for an asynchronous move started by CCD_Filter_Wheel_Move_Start to finish.
+ * If the move failed, the filter wheel error number and string are those set by CCD_Filter_Wheel_Move
+ * in the move thread.
+ * @return The routine returns TRUE if the move succeeded, and FALSE if the move failed, was aborted,
+ *         or no move was started.
+ * @see #Filter_Wheel_Data
+ * @see #CCD_Filter_Wheel_Move_Start
+ */
+int CCD_Filter_Wheel_Move_Wait(void)
+{
+	pthread_t move_thread;
+	int retval;
+
+#if LOGGING > 0
+	CCD_Global_Log(LOG_VERBOSITY_VERY_VERBOSE,"CCD_Filter_Wheel_Move_Wait() started.");
+#endif
+	pthread_mutex_lock(&(Filter_Wheel_Data.Stats_Mutex));
+	if(Filter_Wheel_Data.Move_Thread_Active == FALSE)
+	{
+		pthread_mutex_unlock(&(Filter_Wheel_Data.Stats_Mutex));
+		Filter_Wheel_Error_Number = 36;
+		sprintf(Filter_Wheel_Error_String,"Move_Wait:No asynchronous move has been started.");
+		return FALSE;
+	}
+	move_thread = Filter_Wheel_Data.Move_Thread;
+	pthread_mutex_unlock(&(Filter_Wheel_Data.Stats_Mutex));
+	retval = pthread_join(move_thread,NULL);
+	pthread_mutex_lock(&(Filter_Wheel_Data.Stats_Mutex));
+	Filter_Wheel_Data.Move_Thread_Active = FALSE;
+	pthread_mutex_unlock(&(Filter_Wheel_Data.Stats_Mutex));
+	if(retval != 0)
+	{
+		Filter_Wheel_Error_Number = 37;
+		sprintf(Filter_Wheel_Error_String,"Move_Wait:Failed to join move thread (%d,%s).",retval,
+			strerror(retval));
+		return FALSE;
+	}
+#if LOGGING > 0
+	CCD_Global_Log_Format(LOG_VERBOSITY_VERY_VERBOSE,"CCD_Filter_Wheel_Move_Wait() returned %d.",
+			      Filter_Wheel_Data.Move_Thread_Retval);
+#endif
+	return Filter_Wheel_Data.Move_Thread_Retval;
+}
+
 
 
 /**
@@ -1012,6 +1362,180 @@ void CCD_Filter_Wheel_Error_String(char *error_string)
 /* -----------------------------------------------------------------------------
 ** 	internal functions 
 ** ----------------------------------------------------------------------------- */
+/**
+ * Thread routine started by CCD_Filter_Wheel_Move_Start, to move the wheel asynchronously.
+ * Stores it's own thread id in Filter_Wheel_Data.Move_Thread (using pthread_self, as pthread_create may not
+ * have stored it yet), so CCD_Filter_Wheel_Move knows it is the move thread.
+ * Then calls CCD_Filter_Wheel_Move with the handle and position stored in Filter_Wheel_Data, and saves the result
+ * in Filter_Wheel_Data.Move_Thread_Retval for CCD_Filter_Wheel_Move_Wait to return.
+ * @param user_arg Not used.
+ * @return Always NULL.
+ * @see #Filter_Wheel_Data
+ * @see #CCD_Filter_Wheel_Move
+ * @see #CCD_Filter_Wheel_Move_Start
+ * @see #CCD_Filter_Wheel_Move_Wait
+ */
+static void *Filter_Wheel_Move_Thread(void *user_arg)
+{
+	CCD_Interface_Handle_T* handle = NULL;
+	int position,retval;
+
+	pthread_mutex_lock(&(Filter_Wheel_Data.Stats_Mutex));
+	Filter_Wheel_Data.Move_Thread = pthread_self();
+	handle = Filter_Wheel_Data.Move_Thread_Handle;
+	position = Filter_Wheel_Data.Move_Thread_Position;
+	pthread_mutex_unlock(&(Filter_Wheel_Data.Stats_Mutex));
+	retval = CCD_Filter_Wheel_Move(handle,position);
+	pthread_mutex_lock(&(Filter_Wheel_Data.Stats_Mutex));
+	Filter_Wheel_Data.Move_Thread_Retval = retval;
+	pthread_mutex_unlock(&(Filter_Wheel_Data.Stats_Mutex));
+	return NULL;
+}
+
+/**
+ * Get the predicted time for a filter wheel move, from the move time statistics.
+ * <ul>
+ * <li>If from_position and to_position are both -1, the reset statistics are used.
+ * <li>If from_position is -1, the reset statistics are added to the worst case (N-1 positions) move.
+ * <li>If we have timed moves between this pair of positions, their statistics are used.
+ * <li>Otherwise, if we have timed moves through the same number of positions, their statistics are used.
+ * <li>Otherwise FW_DEFAULT_LOCATOR_TIME and FW_DEFAULT_POSITION_MOVE_TIME are used, with a count of zero.
+ * </ul>
+ * The positions are assumed to have been range checked by the caller.
+ * @param from_position The position the wheel starts in (0..N-1), or -1 if unknown.
+ * @param to_position The position the wheel is moving to (0..N-1), or -1 to estimate a reset.
+ * @param estimate_secs The address of a double, on return filled in with the predicted time in seconds.
+ * @param stddev_secs The address of a double, on return filled in with the standard deviation of the
+ *        timed moves used for the prediction, in seconds.
+ * @param count The address of an integer, on return filled in with the number of timed moves the prediction
+ *        was based on.
+ * @see #Filter_Wheel_Data
+ * @see #CCD_Filter_Wheel_Move_Offset_Get
+ * @see #Filter_Wheel_Stats_Stddev
+ * @see #FW_DEFAULT_LOCATOR_TIME
+ * @see #FW_DEFAULT_POSITION_MOVE_TIME
+ */
+static void Filter_Wheel_Move_Time_Get(int from_position,int to_position,double *estimate_secs,
+				       double *stddev_secs,int *count)
+{
+	struct Filter_Wheel_Move_Stats_Struct stats;
+	double reset_secs,reset_stddev_secs;
+	int offset_count,reset_count;
+
+	if(from_position == -1)
+	{
+		pthread_mutex_lock(&(Filter_Wheel_Data.Stats_Mutex));
+		stats = Filter_Wheel_Data.Reset_Stats;
+		pthread_mutex_unlock(&(Filter_Wheel_Data.Stats_Mutex));
+		if(stats.Count > 0)
+		{
+			reset_secs = stats.Mean;
+			reset_stddev_secs = Filter_Wheel_Stats_Stddev(&stats);
+		}
+		else
+		{
+			/* a reset drives the wheel into the next position */
+			reset_secs = FW_DEFAULT_LOCATOR_TIME+FW_DEFAULT_POSITION_MOVE_TIME;
+			reset_stddev_secs = 0.0;
+		}
+		reset_count = stats.Count;
+		if(to_position == -1)
+		{
+			(*estimate_secs) = reset_secs;
+			(*stddev_secs) = reset_stddev_secs;
+			(*count) = reset_count;
+			return;
+		}
+		/* after the reset, we don't know where the wheel is, so assume the worst case move */
+		Filter_Wheel_Move_Time_Get((to_position+1)%Filter_Wheel_Data.Position_Count,to_position,
+					   estimate_secs,stddev_secs,count);
+		(*estimate_secs) += reset_secs;
+		(*stddev_secs) = sqrt(((*stddev_secs)*(*stddev_secs))+(reset_stddev_secs*reset_stddev_secs));
+		if(reset_count < (*count))
+			(*count) = reset_count;
+		return;
+	}
+	offset_count = CCD_Filter_Wheel_Move_Offset_Get(from_position,to_position);
+	pthread_mutex_lock(&(Filter_Wheel_Data.Stats_Mutex));
+	stats = Filter_Wheel_Data.Move_Stats[from_position][to_position];
+	if(stats.Count == 0)
+		stats = Filter_Wheel_Data.Offset_Stats[offset_count];
+	pthread_mutex_unlock(&(Filter_Wheel_Data.Stats_Mutex));
+	if(stats.Count > 0)
+	{
+		(*estimate_secs) = stats.Mean;
+		(*stddev_secs) = Filter_Wheel_Stats_Stddev(&stats);
+	}
+	else
+	{
+		(*estimate_secs) = FW_DEFAULT_LOCATOR_TIME+(offset_count*FW_DEFAULT_POSITION_MOVE_TIME);
+		(*stddev_secs) = 0.0;
+	}
+	(*count) = stats.Count;
+}
+
+/**
+ * Get the client side timeout to use for a filter wheel move or reset. If the predicted move time is based
+ * on at least FW_MOVE_STATS_MIN_COUNT timed moves, the timeout is the predicted time plus FW_MOVE_TIMEOUT_SIGMA
+ * standard deviations plus FW_MOVE_TIMEOUT_MARGIN seconds. The timeout is never more than FW_MOVE_TIMEOUT_DEFAULT,
+ * which is also used when we don't have enough timed moves.
+ * @param from_position The position the wheel starts in (0..N-1), or -1 if unknown.
+ * @param to_position The position the wheel is moving to (0..N-1), or -1 to get a reset timeout.
+ * @return The timeout in seconds.
+ * @see #Filter_Wheel_Move_Time_Get
+ * @see #FW_MOVE_STATS_MIN_COUNT
+ * @see #FW_MOVE_TIMEOUT_SIGMA
+ * @see #FW_MOVE_TIMEOUT_MARGIN
+ * @see #FW_MOVE_TIMEOUT_DEFAULT
+ */
+static double Filter_Wheel_Move_Timeout_Get(int from_position,int to_position)
+{
+	double estimate_secs,stddev_secs,timeout_length;
+	int count;
+
+	Filter_Wheel_Move_Time_Get(from_position,to_position,&estimate_secs,&stddev_secs,&count);
+	if(count < FW_MOVE_STATS_MIN_COUNT)
+		return FW_MOVE_TIMEOUT_DEFAULT;
+	timeout_length = estimate_secs+(FW_MOVE_TIMEOUT_SIGMA*stddev_secs)+FW_MOVE_TIMEOUT_MARGIN;
+	if(timeout_length > FW_MOVE_TIMEOUT_DEFAULT)
+		timeout_length = FW_MOVE_TIMEOUT_DEFAULT;
+	return timeout_length;
+}
+
+/**
+ * Add a timed operation to some move statistics, using Welford's method to update the running mean and variance.
+ * The caller should hold Filter_Wheel_Data.Stats_Mutex.
+ * @param stats The address of the statistics to update.
+ * @param length_secs How long the operation took, in seconds.
+ * @see #Filter_Wheel_Move_Stats_Struct
+ */
+static void Filter_Wheel_Stats_Add(struct Filter_Wheel_Move_Stats_Struct *stats,double length_secs)
+{
+	double delta;
+
+	if((stats->Count == 0)||(length_secs < stats->Min))
+		stats->Min = length_secs;
+	if((stats->Count == 0)||(length_secs > stats->Max))
+		stats->Max = length_secs;
+	stats->Count++;
+	delta = length_secs-stats->Mean;
+	stats->Mean += delta/((double)stats->Count);
+	stats->Sum_Squares += delta*(length_secs-stats->Mean);
+}
+
+/**
+ * Return the sample standard deviation of some move statistics.
+ * @param stats The address of the statistics.
+ * @return The standard deviation in seconds, or 0.0 if less than two operations have been timed.
+ * @see #Filter_Wheel_Move_Stats_Struct
+ */
+static double Filter_Wheel_Stats_Stddev(struct Filter_Wheel_Move_Stats_Struct *stats)
+{
+	if(stats->Count < 2)
+		return 0.0;
+	return sqrt(stats->Sum_Squares/((double)(stats->Count-1)));
+}
+
 /**
  * Debug and print status contained in the utility board X:STATUS register.
  * @param fw_status The value in the utility board X:STATUS register read by an RDM command.
@@ -0,0 +1,674 @@
+/* ccd_frame_ring.c
+** Shared memory frame publication module.
+** $Header$
+*/
+/**
+ * ccd_frame_ring publishes each read out, de-interlaced frame into a POSIX shared memory ring, so local
+ * programs (quick-look, twilight analysis) can use it as soon as it is read out, without waiting for the FITS
+ * file to be written and unlocked, and without re-reading it from disc.
+ * <ul>
+ * <li>The shared memory object starts with a CCD_Frame_Ring_Header_Struct, followed by Slot_Count slots, each a
+ *     CCD_Frame_Ring_Slot_Struct followed by the pixel data.
+ * <li>The O (the writer) calls CCD_Frame_Ring_Open at startup. CCD_Pixel_Stream then calls CCD_Frame_Ring_Publish
+ *     for each frame, which does nothing if the ring is not open.
+ * <li>Each slot is protected by a sequence count (a seqlock), so the writer never waits for a reader.
+ *     A reader that is too slow sees the sequence change, and drops the frame.
+ * <li>Readers call CCD_Frame_Ring_Attach, then wait for new frames with CCD_Frame_Ring_Wait (a futex on the header's
+ *     Publish_Count, woken by the writer). CCD_Frame_Ring_Slot_Get returns pointers straight into the shared
+ *     memory (no copy), and CCD_Frame_Ring_Slot_Check says whether the slot was overwritten whilst it was used.
+ * </ul>
+ * @author Chris Mottram
+ * @version $Revision$
+ */
+/**
+ * This hash define is needed before including source files to give us shm_open, syscall and the futex definitions.
+ */
+#define _GNU_SOURCE 1
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/types.h>
+#include "log_udp.h"
+#include "ccd_global.h"
+#include "ccd_frame_ring.h"
+
+/**
+ * Revision Control System identifier.
+ */
+static char rcsid[] = "$Id$";
+
+/* hash defines */
+/**
+ * The maximum number of slots in a frame ring.
+ */
+#define FRAME_RING_MAX_SLOT_COUNT	(64)
+/**
+ * The alignment of the slots and their pixel data in the shared memory, in bytes (a page).
+ */
+#define FRAME_RING_ALIGNMENT		(4096)
+/**
+ * The maximum length of the shared memory object name.
+ */
+#define FRAME_RING_NAME_LENGTH		(128)
+/**
+ * How long a reader sleeps between checks for a new frame, in milliseconds, if the futex cannot be used.
+ */
+#define FRAME_RING_POLL_MS		(10)
+/**
+ * Macro to round a length up to a multiple of FRAME_RING_ALIGNMENT.
+ * @see #FRAME_RING_ALIGNMENT
+ */
+#define FRAME_RING_ALIGN(length)	((((length)+FRAME_RING_ALIGNMENT-1)/FRAME_RING_ALIGNMENT)*FRAME_RING_ALIGNMENT)
+
+/* data types */
+/**
+ * Data type holding local data to ccd_frame_ring. This consists of the following:
+ * <dl>
+ * <dt>Name</dt> <dd>The shared memory object name.</dd>
+ * <dt>Fd</dt> <dd>The shared memory object file descriptor, or -1 if the ring is not open/attached.</dd>
+ * <dt>Header</dt> <dd>The address the shared memory is mapped at, or NULL.</dd>
+ * <dt>Length</dt> <dd>The length of the mapped shared memory, in bytes.</dd>
+ * <dt>Writable</dt> <dd>A boolean, TRUE if this process opened the ring to publish frames (CCD_Frame_Ring_Open),
+ *     FALSE if it attached to read them (CCD_Frame_Ring_Attach).</dd>
+ * <dt>Mutex</dt> <dd>Stops the ring being closed whilst a frame is being published.</dd>
+ * </dl>
+ */
+struct Frame_Ring_Struct
+{
+	char Name[FRAME_RING_NAME_LENGTH];
+	int Fd;
+	struct CCD_Frame_Ring_Header_Struct *Header;
+	size_t Length;
+	int Writable;
+	pthread_mutex_t Mutex;
+};
+
+/* internal variables */
+/**
+ * Variable holding error code of last operation performed by ccd_frame_ring.
+ */
+static int Frame_Ring_Error_Number = 0;
+/**
+ * Local variable holding description of the last error that occured.
+ */
+static char Frame_Ring_Error_String[CCD_GLOBAL_ERROR_STRING_LENGTH] = "";
+/**
+ * Local frame ring data.
+ * @see #Frame_Ring_Struct
+ */
+static struct Frame_Ring_Struct Frame_Ring_Data =
+{
+	"",-1,NULL,0,FALSE,PTHREAD_MUTEX_INITIALIZER
+};
+
+/* internal function definitions */
+static struct CCD_Frame_Ring_Slot_Struct *Frame_Ring_Slot(unsigned int frame_number);
+static void Frame_Ring_Unmap(void);
+
+/* -----------------------------------------------------------------------------
+**     external functions
+** ----------------------------------------------------------------------------- */
+/**
+ * This routine sets up ccd_frame_ring internal variables. It should be called at startup.
+ * @return This routine returns TRUE for success.
+ */
+int CCD_Frame_Ring_Initialise(void)
+{
+	Frame_Ring_Error_Number = 0;
+/* print some compile time information to stdout */
+	fprintf(stdout,"CCD_Frame_Ring_Initialise:%s.\n",rcsid);
+	return TRUE;
+}
+
+/**
+ * Routine to create (or recreate) the frame ring shared memory object, and map it, so frames can be
+ * published into it. Any existing object of the same name is replaced (readers attached to it keep their
+ * old mapping, and should re-attach when it's Publish_Count stops increasing).
+ * @param name The shared memory object name, which should start with a '/' (i.e. CCD_FRAME_RING_DEFAULT_NAME).
+ * @param slot_count The number of slots (frames) in the ring, from 1 to FRAME_RING_MAX_SLOT_COUNT.
+ * @param slot_pixel_count The maximum number of pixels in a frame. Larger frames are not published.
+ * @return The routine returns TRUE on success, and FALSE if an error occurs.
+ * @see #Frame_Ring_Data
+ * @see #Frame_Ring_Unmap
+ * @see #FRAME_RING_ALIGN
+ * @see #FRAME_RING_MAX_SLOT_COUNT
+ */
+int CCD_Frame_Ring_Open(char *name,int slot_count,int slot_pixel_count)
+{
+	struct CCD_Frame_Ring_Header_Struct *header = NULL;
+	size_t slot_offset,slot_length,data_offset,length;
+	int fd;
+
+	Frame_Ring_Error_Number = 0;
+	if((name == NULL)||(strlen(name) >= FRAME_RING_NAME_LENGTH))
+	{
+		Frame_Ring_Error_Number = 1;
+		sprintf(Frame_Ring_Error_String,"CCD_Frame_Ring_Open:Illegal name.");
+		return FALSE;
+	}
+	if((slot_count < 1)||(slot_count > FRAME_RING_MAX_SLOT_COUNT))
+	{
+		Frame_Ring_Error_Number = 2;
+		sprintf(Frame_Ring_Error_String,"CCD_Frame_Ring_Open:Illegal slot count %d (1..%d).",slot_count,
+			FRAME_RING_MAX_SLOT_COUNT);
+		return FALSE;
+	}
+	if(slot_pixel_count < 1)
+	{
+		Frame_Ring_Error_Number = 3;
+		sprintf(Frame_Ring_Error_String,"CCD_Frame_Ring_Open:Illegal slot pixel count %d.",slot_pixel_count);
+		return FALSE;
+	}
+	if(Frame_Ring_Data.Header != NULL)
+	{
+		Frame_Ring_Error_Number = 4;
+		sprintf(Frame_Ring_Error_String,"CCD_Frame_Ring_Open:Frame ring %s already open.",
+			Frame_Ring_Data.Name);
+		return FALSE;
+	}
+	slot_offset = FRAME_RING_ALIGN(sizeof(struct CCD_Frame_Ring_Header_Struct));
+	data_offset = FRAME_RING_ALIGN(sizeof(struct CCD_Frame_Ring_Slot_Struct));
+	slot_length = data_offset+FRAME_RING_ALIGN(((size_t)slot_pixel_count)*sizeof(unsigned short));
+	length = slot_offset+(((size_t)slot_count)*slot_length);
+	if(slot_length > UINT_MAX)
+	{
+		Frame_Ring_Error_Number = 5;
+		sprintf(Frame_Ring_Error_String,"CCD_Frame_Ring_Open:Slot pixel count %d too large.",
+			slot_pixel_count);
+		return FALSE;
+	}
+	/* replace any old object, so readers attached to it are not confused by a change in layout */
+	shm_unlink(name);
+	fd = shm_open(name,O_RDWR|O_CREAT|O_EXCL,S_IRUSR|S_IWUSR|S_IRGRP|S_IWGRP|S_IROTH);
+	if(fd < 0)
+	{
+		Frame_Ring_Error_Number = 6;
+		sprintf(Frame_Ring_Error_String,"CCD_Frame_Ring_Open:shm_open %s failed(%d).",name,errno);
+		return FALSE;
+	}
+	if(ftruncate(fd,(off_t)length) != 0)
+	{
+		Frame_Ring_Error_Number = 7;
+		sprintf(Frame_Ring_Error_String,"CCD_Frame_Ring_Open:Sizing %s to %lu bytes failed(%d).",name,
+			(unsigned long)length,errno);
+		close(fd);
+		shm_unlink(name);
+		return FALSE;
+	}
+	header = (struct CCD_Frame_Ring_Header_Struct *)mmap(NULL,length,PROT_READ|PROT_WRITE,MAP_SHARED,fd,0);
+	if(header == MAP_FAILED)
+	{
+		Frame_Ring_Error_Number = 8;
+		sprintf(Frame_Ring_Error_String,"CCD_Frame_Ring_Open:Mapping %s (%lu bytes) failed(%d).",name,
+			(unsigned long)length,errno);
+		close(fd);
+		shm_unlink(name);
+		return FALSE;
+	}
+	/* the object is zero filled by ftruncate, so all slot sequences start even and frame numbers 0 */
+	header->Version = CCD_FRAME_RING_VERSION;
+	header->Slot_Count = slot_count;
+	header->Slot_Pixel_Count = slot_pixel_count;
+	header->Slot_Offset = slot_offset;
+	header->Slot_Length = slot_length;
+	header->Publish_Count = 0;
+	header->Pad = 0;
+	/* write magic last, readers check it to see the header is valid */
+	__sync_synchronize();
+	header->Magic = CCD_FRAME_RING_MAGIC;
+	pthread_mutex_lock(&(Frame_Ring_Data.Mutex));
+	strcpy(Frame_Ring_Data.Name,name);
+	Frame_Ring_Data.Fd = fd;
+	Frame_Ring_Data.Header = header;
+	Frame_Ring_Data.Length = length;
+	Frame_Ring_Data.Writable = TRUE;
+	pthread_mutex_unlock(&(Frame_Ring_Data.Mutex));
+#if LOGGING > 4
+	CCD_Global_Log_Format(LOG_VERBOSITY_VERBOSE,"CCD_Frame_Ring_Open:Opened %s:%d slots of %d pixels "
+			      "(%lu bytes).",name,slot_count,slot_pixel_count,(unsigned long)length);
+#endif
+	return TRUE;
+}
+
+/**
+ * Routine to close the frame ring opened by CCD_Frame_Ring_Open. The shared memory object is unlinked,
+ * readers still attached keep their mapping until they detach.
+ * @return The routine returns TRUE on success, and FALSE if an error occurs.
+ * @see #Frame_Ring_Data
+ * @see #Frame_Ring_Unmap
+ */
+int CCD_Frame_Ring_Close(void)
+{
+	Frame_Ring_Error_Number = 0;
+	pthread_mutex_lock(&(Frame_Ring_Data.Mutex));
+	if((Frame_Ring_Data.Header == NULL)||(Frame_Ring_Data.Writable == FALSE))
+	{
+		pthread_mutex_unlock(&(Frame_Ring_Data.Mutex));
+		return TRUE;
+	}
+	shm_unlink(Frame_Ring_Data.Name);
+	Frame_Ring_Unmap();
+	pthread_mutex_unlock(&(Frame_Ring_Data.Mutex));
+#if LOGGING > 4
+	CCD_Global_Log(LOG_VERBOSITY_VERBOSE,"CCD_Frame_Ring_Close:Closed.");
+#endif
+	return TRUE;
+}
+
+/**
+ * Routine to return whether the frame ring is open for publishing frames.
+ * @return TRUE if the frame ring was opened with CCD_Frame_Ring_Open, FALSE otherwise.
+ * @see #Frame_Ring_Data
+ */
+int CCD_Frame_Ring_Is_Open(void)
+{
+	return ((Frame_Ring_Data.Header != NULL)&&Frame_Ring_Data.Writable);
+}
+
+/**
+ * Routine to publish a frame into the next slot of the frame ring. If the ring is not open this does nothing.
+ * <ul>
+ * <li>The slot's Sequence is incremented (making it odd), so readers know it is being written.
+ * <li>The metadata and pixel data are copied into the slot.
+ * <li>The slot's Sequence is incremented again (making it even), and the header's Publish_Count incremented.
+ * <li>Any readers waiting in CCD_Frame_Ring_Wait are woken (FUTEX_WAKE on Publish_Count).
+ * </ul>
+ * @param image_data The de-interlaced image data.
+ * @param ncols The number of columns in the image.
+ * @param nrows The number of rows in the image.
+ * @param x_bin The serial binning.
+ * @param y_bin The parallel binning.
+ * @param window_number 0 for a full frame, or the window number (1..4).
+ * @param exposure_length The exposure length in milliseconds.
+ * @param start_time The exposure start time.
+ * @param filename The FITS filename the frame is being saved to.
+ * @return The routine returns TRUE on success (or if the ring is not open), and FALSE if the frame could
+ *         not be published.
+ * @see #Frame_Ring_Data
+ * @see #Frame_Ring_Slot
+ */
+int CCD_Frame_Ring_Publish(unsigned short *image_data,int ncols,int nrows,int x_bin,int y_bin,
+			   int window_number,int exposure_length,struct timespec start_time,char *filename)
+{
+	struct CCD_Frame_Ring_Header_Struct *header = NULL;
+	struct CCD_Frame_Ring_Slot_Struct *slot = NULL;
+	struct timespec publish_time;
+	size_t pixel_count;
+	unsigned int frame_number;
+
+	Frame_Ring_Error_Number = 0;
+	/* cheap check first, so this costs nothing when the ring is not in use */
+	if(Frame_Ring_Data.Header == NULL)
+		return TRUE;
+	if(image_data == NULL)
+	{
+		Frame_Ring_Error_Number = 9;
+		sprintf(Frame_Ring_Error_String,"CCD_Frame_Ring_Publish:image data was NULL.");
+		return FALSE;
+	}
+	pthread_mutex_lock(&(Frame_Ring_Data.Mutex));
+	header = Frame_Ring_Data.Header;
+	if((header == NULL)||(Frame_Ring_Data.Writable == FALSE))
+	{
+		pthread_mutex_unlock(&(Frame_Ring_Data.Mutex));
+		return TRUE;
+	}
+	pixel_count = ((size_t)ncols)*((size_t)nrows);
+	if((ncols < 1)||(nrows < 1)||(pixel_count > header->Slot_Pixel_Count))
+	{
+		pthread_mutex_unlock(&(Frame_Ring_Data.Mutex));
+		Frame_Ring_Error_Number = 10;
+		sprintf(Frame_Ring_Error_String,"CCD_Frame_Ring_Publish:Frame (%d,%d) too large for slot (%u pixels).",
+			ncols,nrows,header->Slot_Pixel_Count);
+		return FALSE;
+	}
+	frame_number = header->Publish_Count+1;
+	slot = Frame_Ring_Slot(frame_number);
+	/* odd sequence: slot being written */
+	slot->Sequence++;
+	__sync_synchronize();
+	slot->Frame_Number = frame_number;
+	slot->Data_Offset = FRAME_RING_ALIGN(sizeof(struct CCD_Frame_Ring_Slot_Struct));
+	slot->NCols = ncols;
+	slot->NRows = nrows;
+	slot->X_Bin = x_bin;
+	slot->Y_Bin = y_bin;
+	slot->Window_Number = window_number;
+	slot->Exposure_Length = exposure_length;
+	slot->Start_Time_Sec = start_time.tv_sec;
+	slot->Start_Time_Nsec = start_time.tv_nsec;
+	if(filename != NULL)
+	{
+		strncpy(slot->Filename,filename,CCD_FRAME_RING_FILENAME_LENGTH-1);
+		slot->Filename[CCD_FRAME_RING_FILENAME_LENGTH-1] = '\0';
+	}
+	else
+		slot->Filename[0] = '\0';
+	memcpy(((char *)slot)+slot->Data_Offset,image_data,pixel_count*sizeof(unsigned short));
+	clock_gettime(CLOCK_REALTIME,&publish_time);
+	slot->Publish_Time_Sec = publish_time.tv_sec;
+	slot->Publish_Time_Nsec = publish_time.tv_nsec;
+	__sync_synchronize();
+	/* even sequence: slot complete */
+	slot->Sequence++;
+	__sync_synchronize();
+	header->Publish_Count = frame_number;
+	__sync_synchronize();
+	syscall(SYS_futex,&(header->Publish_Count),FUTEX_WAKE,INT_MAX,NULL,NULL,0);
+	pthread_mutex_unlock(&(Frame_Ring_Data.Mutex));
+#if LOGGING > 9
+	CCD_Global_Log_Format(LOG_VERBOSITY_VERY_VERBOSE,"CCD_Frame_Ring_Publish:Published frame %u (%d,%d).",
+			      frame_number,ncols,nrows);
+#endif
+	return TRUE;
+}
+
+/**
+ * Routine for a reader to attach (read only) to an existing frame ring.
+ * @param name The shared memory object name the writer opened (i.e. CCD_FRAME_RING_DEFAULT_NAME).
+ * @return The routine returns TRUE on success, and FALSE if an error occurs.
+ * @see #Frame_Ring_Data
+ * @see #Frame_Ring_Unmap
+ */
+int CCD_Frame_Ring_Attach(char *name)
+{
+	struct CCD_Frame_Ring_Header_Struct *header = NULL;
+	struct stat stat_buffer;
+	int fd;
+
+	Frame_Ring_Error_Number = 0;
+	if((name == NULL)||(strlen(name) >= FRAME_RING_NAME_LENGTH))
+	{
+		Frame_Ring_Error_Number = 11;
+		sprintf(Frame_Ring_Error_String,"CCD_Frame_Ring_Attach:Illegal name.");
+		return FALSE;
+	}
+	if(Frame_Ring_Data.Header != NULL)
+	{
+		Frame_Ring_Error_Number = 12;
+		sprintf(Frame_Ring_Error_String,"CCD_Frame_Ring_Attach:Frame ring %s already open.",
+			Frame_Ring_Data.Name);
+		return FALSE;
+	}
+	fd = shm_open(name,O_RDONLY,0);
+	if(fd < 0)
+	{
+		Frame_Ring_Error_Number = 13;
+		sprintf(Frame_Ring_Error_String,"CCD_Frame_Ring_Attach:shm_open %s failed(%d).",name,errno);
+		return FALSE;
+	}
+	if((fstat(fd,&stat_buffer) != 0)||(stat_buffer.st_size < (off_t)sizeof(struct CCD_Frame_Ring_Header_Struct)))
+	{
+		Frame_Ring_Error_Number = 14;
+		sprintf(Frame_Ring_Error_String,"CCD_Frame_Ring_Attach:%s is too small(%d).",name,errno);
+		close(fd);
+		return FALSE;
+	}
+	header = (struct CCD_Frame_Ring_Header_Struct *)mmap(NULL,stat_buffer.st_size,PROT_READ,MAP_SHARED,fd,0);
+	if(header == MAP_FAILED)
+	{
+		Frame_Ring_Error_Number = 15;
+		sprintf(Frame_Ring_Error_String,"CCD_Frame_Ring_Attach:Mapping %s failed(%d).",name,errno);
+		close(fd);
+		return FALSE;
+	}
+	if((header->Magic != CCD_FRAME_RING_MAGIC)||(header->Version != CCD_FRAME_RING_VERSION)||
+	   ((size_t)stat_buffer.st_size < header->Slot_Offset+(((size_t)header->Slot_Count)*header->Slot_Length)))
+	{
+		Frame_Ring_Error_Number = 16;
+		sprintf(Frame_Ring_Error_String,"CCD_Frame_Ring_Attach:%s is not a version %d frame ring "
+			"(magic %#x,version %u).",name,CCD_FRAME_RING_VERSION,header->Magic,header->Version);
+		munmap(header,stat_buffer.st_size);
+		close(fd);
+		return FALSE;
+	}
+	pthread_mutex_lock(&(Frame_Ring_Data.Mutex));
+	strcpy(Frame_Ring_Data.Name,name);
+	Frame_Ring_Data.Fd = fd;
+	Frame_Ring_Data.Header = header;
+	Frame_Ring_Data.Length = stat_buffer.st_size;
+	Frame_Ring_Data.Writable = FALSE;
+	pthread_mutex_unlock(&(Frame_Ring_Data.Mutex));
+	return TRUE;
+}
+
+/**
+ * Routine for a reader to detach from the frame ring attached to with CCD_Frame_Ring_Attach.
+ * Pointers returned by CCD_Frame_Ring_Slot_Get are no longer valid.
+ * @return The routine returns TRUE on success.
+ * @see #Frame_Ring_Data
+ * @see #Frame_Ring_Unmap
+ */
+int CCD_Frame_Ring_Detach(void)
+{
+	Frame_Ring_Error_Number = 0;
+	pthread_mutex_lock(&(Frame_Ring_Data.Mutex));
+	if((Frame_Ring_Data.Header != NULL)&&(Frame_Ring_Data.Writable == FALSE))
+		Frame_Ring_Unmap();
+	pthread_mutex_unlock(&(Frame_Ring_Data.Mutex));
+	return TRUE;
+}
+
+/**
+ * Routine for a reader to wait for a frame newer than last_frame_number to be published.
+ * The reader sleeps on a futex on the header's Publish_Count, which CCD_Frame_Ring_Publish wakes. If the futex
+ * cannot be used (older kernels do not allow it on read only mappings), Publish_Count is polled every
+ * FRAME_RING_POLL_MS milliseconds instead.
+ * @param last_frame_number The last frame number the reader has seen, 0 if none.
+ * @param timeout_ms How long to wait, in milliseconds.
+ * @param frame_number The address of an unsigned integer, on return set to the latest frame number published.
+ *        If this is equal to last_frame_number the wait timed out.
+ * @return The routine returns TRUE on success, and FALSE if an error occurs.
+ * @see #Frame_Ring_Data
+ * @see #FRAME_RING_POLL_MS
+ */
+int CCD_Frame_Ring_Wait(unsigned int last_frame_number,int timeout_ms,unsigned int *frame_number)
+{
+	struct CCD_Frame_Ring_Header_Struct *header = NULL;
+	struct timespec start_time,current_time,timeout,sleep_time;
+	int remaining_ms;
+
+	Frame_Ring_Error_Number = 0;
+	header = Frame_Ring_Data.Header;
+	if(header == NULL)
+	{
+		Frame_Ring_Error_Number = 17;
+		sprintf(Frame_Ring_Error_String,"CCD_Frame_Ring_Wait:Frame ring not attached.");
+		return FALSE;
+	}
+	if(frame_number == NULL)
+	{
+		Frame_Ring_Error_Number = 18;
+		sprintf(Frame_Ring_Error_String,"CCD_Frame_Ring_Wait:frame_number was NULL.");
+		return FALSE;
+	}
+	clock_gettime(CLOCK_REALTIME,&start_time);
+	while(header->Publish_Count == last_frame_number)
+	{
+		clock_gettime(CLOCK_REALTIME,&current_time);
+		remaining_ms = timeout_ms-((int)(fdifftime(current_time,start_time)*((double)CCD_GLOBAL_ONE_SECOND_MS)));
+		if(remaining_ms <= 0)
+			break;
+		timeout.tv_sec = remaining_ms/CCD_GLOBAL_ONE_SECOND_MS;
+		timeout.tv_nsec = (remaining_ms%CCD_GLOBAL_ONE_SECOND_MS)*CCD_GLOBAL_ONE_MILLISECOND_NS;
+		if(syscall(SYS_futex,&(header->Publish_Count),FUTEX_WAIT,last_frame_number,&timeout,NULL,0) != 0)
+		{
+			if((errno != EAGAIN)&&(errno != EINTR)&&(errno != ETIMEDOUT))
+			{
+				sleep_time.tv_sec = 0;
+				sleep_time.tv_nsec = FRAME_RING_POLL_MS*CCD_GLOBAL_ONE_MILLISECOND_NS;
+				nanosleep(&sleep_time,NULL);
+			}
+		}
+	}
+	(*frame_number) = header->Publish_Count;
+	return TRUE;
+}
+
+/**
+ * Routine for a reader to get pointers to a published frame, in the shared memory (no copy is made).
+ * The returned sequence should be passed to CCD_Frame_Ring_Slot_Check after the frame has been used, if that
+ * returns FALSE the writer overwrote the slot whilst it was in use, and the results should be discarded.
+ * @param frame_number The frame number to get, from CCD_Frame_Ring_Wait.
+ * @param slot The address of a slot pointer, on return pointing to the slot's metadata.
+ * @param image_data The address of a pointer, on return pointing to the slot's pixel data.
+ * @param sequence The address of an unsigned integer, on return set to the slot's sequence.
+ * @return The routine returns TRUE on success, and FALSE if the frame is no longer (or not yet) in the ring.
+ * @see #Frame_Ring_Data
+ * @see #Frame_Ring_Slot
+ * @see #CCD_Frame_Ring_Slot_Check
+ */
+int CCD_Frame_Ring_Slot_Get(unsigned int frame_number,struct CCD_Frame_Ring_Slot_Struct **slot,
+			    unsigned short **image_data,unsigned int *sequence)
+{
+	struct CCD_Frame_Ring_Header_Struct *header = NULL;
+	struct CCD_Frame_Ring_Slot_Struct *frame_slot = NULL;
+	unsigned int publish_count,slot_sequence;
+
+	Frame_Ring_Error_Number = 0;
+	header = Frame_Ring_Data.Header;
+	if(header == NULL)
+	{
+		Frame_Ring_Error_Number = 19;
+		sprintf(Frame_Ring_Error_String,"CCD_Frame_Ring_Slot_Get:Frame ring not attached.");
+		return FALSE;
+	}
+	if((slot == NULL)||(image_data == NULL)||(sequence == NULL))
+	{
+		Frame_Ring_Error_Number = 20;
+		sprintf(Frame_Ring_Error_String,"CCD_Frame_Ring_Slot_Get:Illegal pointer argument.");
+		return FALSE;
+	}
+	publish_count = header->Publish_Count;
+	if((frame_number == 0)||(frame_number > publish_count)||((publish_count-frame_number) >= header->Slot_Count))
+	{
+		Frame_Ring_Error_Number = 21;
+		sprintf(Frame_Ring_Error_String,"CCD_Frame_Ring_Slot_Get:Frame %u not in ring (published %u,%u slots).",
+			frame_number,publish_count,header->Slot_Count);
+		return FALSE;
+	}
+	frame_slot = Frame_Ring_Slot(frame_number);
+	slot_sequence = frame_slot->Sequence;
+	__sync_synchronize();
+	if(((slot_sequence%2) != 0)||(frame_slot->Frame_Number != frame_number))
+	{
+		Frame_Ring_Error_Number = 22;
+		sprintf(Frame_Ring_Error_String,"CCD_Frame_Ring_Slot_Get:Frame %u has been overwritten.",frame_number);
+		return FALSE;
+	}
+	(*slot) = frame_slot;
+	(*image_data) = (unsigned short *)(((char *)frame_slot)+frame_slot->Data_Offset);
+	(*sequence) = slot_sequence;
+	return TRUE;
+}
+
+/**
+ * Routine for a reader to check a slot returned by CCD_Frame_Ring_Slot_Get was not overwritten whilst it was
+ * being used.
+ * @param slot The slot pointer returned by CCD_Frame_Ring_Slot_Get.
+ * @param sequence The sequence returned by CCD_Frame_Ring_Slot_Get.
+ * @return TRUE if the slot is unchanged, FALSE if the writer has started to overwrite it.
+ */
+int CCD_Frame_Ring_Slot_Check(struct CCD_Frame_Ring_Slot_Struct *slot,unsigned int sequence)
+{
+	__sync_synchronize();
+	return (slot->Sequence == sequence);
+}
+
+/**
+ * Get the current value of the error number.
+ * @return The current value of the error number.
+ */
+int CCD_Frame_Ring_Get_Error_Number(void)
+{
+	return Frame_Ring_Error_Number;
+}
+
+/**
+ * The error routine that reports any errors occuring in ccd_frame_ring in a standard way.
+ * @see ccd_global.html#CCD_Global_Get_Current_Time_String
+ * @see #Frame_Ring_Error_Number
+ * @see #Frame_Ring_Error_String
+ */
+void CCD_Frame_Ring_Error(void)
+{
+	char time_string[32];
+
+	CCD_Global_Get_Current_Time_String(time_string,32);
+	/* if the error number is zero an error message has not been set up
+	** This is in itself an error as we should not be calling this routine
+	** without there being an error to display */
+	if(Frame_Ring_Error_Number == 0)
+		sprintf(Frame_Ring_Error_String,"Logic Error:No Error defined");
+	fprintf(stderr,"%s CCD_Frame_Ring:Error(%d) : %s\n",time_string,Frame_Ring_Error_Number,
+		Frame_Ring_Error_String);
+}
+
+/**
+ * The error routine that reports any errors occuring in ccd_frame_ring in a standard way. This routine places the
+ * generated error string at the end of a passed in string argument.
+ * @param error_string A string to put the generated error in. This string should be initialised before
+ * 	being passed to this routine. The routine will try to concatenate it's error string onto the end
+ * 	of any string already in existance.
+ * @see ccd_global.html#CCD_Global_Get_Current_Time_String
+ */
+void CCD_Frame_Ring_Error_String(char *error_string)
+{
+	char time_string[32];
+
+	CCD_Global_Get_Current_Time_String(time_string,32);
+	/* if the error number is zero an error message has not been set up
+	** This is in itself an error as we should not be calling this routine
+	** without there being an error to display */
+	if(Frame_Ring_Error_Number == 0)
+		sprintf(Frame_Ring_Error_String,"Logic Error:No Error defined");
+	sprintf(error_string+strlen(error_string),"%s CCD_Frame_Ring:Error(%d) : %s\n",time_string,
+		Frame_Ring_Error_Number,Frame_Ring_Error_String);
+}
+
+/* -----------------------------------------------------------------------------
+** 	internal functions
+** ----------------------------------------------------------------------------- */
+/**
+ * Get the address of the slot a frame number is (or will be) published in.
+ * @param frame_number The frame number, starting from 1.
+ * @return The slot address.
+ * @see #Frame_Ring_Data
+ */
+static struct CCD_Frame_Ring_Slot_Struct *Frame_Ring_Slot(unsigned int frame_number)
+{
+	struct CCD_Frame_Ring_Header_Struct *header = Frame_Ring_Data.Header;
+
+	return (struct CCD_Frame_Ring_Slot_Struct *)(((char *)header)+header->Slot_Offset+
+						     (((size_t)((frame_number-1)%header->Slot_Count))*
+						      header->Slot_Length));
+}
+
+/**
+ * Unmap and close the shared memory object, and reset Frame_Ring_Data. Frame_Ring_Data.Mutex should be held.
+ * @see #Frame_Ring_Data
+ */
+static void Frame_Ring_Unmap(void)
+{
+	munmap(Frame_Ring_Data.Header,Frame_Ring_Data.Length);
+	close(Frame_Ring_Data.Fd);
+	Frame_Ring_Data.Header = NULL;
+	Frame_Ring_Data.Fd = -1;
+	Frame_Ring_Data.Length = 0;
+	Frame_Ring_Data.Writable = FALSE;
+	Frame_Ring_Data.Name[0] = '\0';
+}
+
+/*
+** $Log: not supported by cvs2svn $
+*/
@@ -0,0 +1,544 @@
+/* ccd_frame_view.c
+** Zero-copy frame access module.
+** $Header$
+*/
+/**
+ * ccd_frame_view keeps the most recent de-interlaced frame in memory after it has been saved, so that
+ * analysis code (i.e. in Java, via direct ByteBuffers created by the JNI layer) can read the pixels in place,
+ * without copying them or re-reading the FITS file.
+ * <ul>
+ * <li>Nothing is retained, and neither kind of view is available, until frame viewing is turned on with
+ *     CCD_Frame_View_Set_Enable. It is off by default.
+ * <li>The pixel stream code hands the de-interlaced image data over to this module with
+ *     CCD_Frame_View_Post_Readout, instead of freeing it. No copy is made.
+ * <li>A frame is acquired with CCD_Frame_View_Acquire, which returns the latest frame and it's sequence number,
+ *     and increments it's reference count. The frame is not freed until it is released with
+ *     CCD_Frame_View_Release, even if newer frames have been read out since.
+ * <li>Up to CCD_FRAME_VIEW_MAX_FRAME_COUNT frames are retained. If they are all still acquired when a new frame
+ *     is read out, the new frame is not retained (the pixel stream code frees it as usual).
+ * <li>The raw (not de-interlaced) readout buffer can also be viewed. This is the device driver's memory mapped
+ *     DMA buffer, and is overwritten by the next readout, so it cannot be retained. Instead, each readout
+ *     increments a raw sequence number: a reader should get the sequence number (CCD_Frame_View_Raw_Get),
+ *     read the pixels, and then check the sequence number has not changed (CCD_Frame_View_Raw_Sequence_Get)
+ *     before trusting what it read. The buffer is unmapped or remapped by CCD_Setup_Startup,
+ *     CCD_Setup_Shutdown and the JNI memory map routine, so a reader that can't stop that happening whilst it
+ *     reads (i.e. the JNI layer) should use CCD_Frame_View_Raw_Copy, which copies the pixels with the
+ *     mutex locked, and fails if the sequence number has changed.
+ * </ul>
+ * @author Chris Mottram
+ * @version $Revision$
+ */
+/**
+ * This hash define is needed before including source files give us POSIX.4/IEEE1003.1b-1993 prototypes.
+ */
+#define _POSIX_SOURCE 1
+/**
+ * This hash define is needed before including source files give us POSIX.4/IEEE1003.1b-1993 prototypes.
+ */
+#define _POSIX_C_SOURCE 199309L
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "log_udp.h"
+#include "ccd_global.h"
+#include "ccd_frame_view.h"
+
+/**
+ * Revision Control System identifier.
+ */
+static char rcsid[] = "$Id$";
+
+/* data types */
+/**
+ * Data type holding a retained de-interlaced frame.
+ * <dl>
+ * <dt>Image_Data</dt> <dd>The image data, or NULL if this entry is not in use.</dd>
+ * <dt>NCols</dt> <dd>The number of binned columns in the frame.</dd>
+ * <dt>NRows</dt> <dd>The number of binned rows in the frame.</dd>
+ * <dt>X_Bin</dt> <dd>The serial binning.</dd>
+ * <dt>Y_Bin</dt> <dd>The parallel binning.</dd>
+ * <dt>Window_Number</dt> <dd>0 for a full frame, or the window number (1..4) of a windowed frame.</dd>
+ * <dt>Sequence</dt> <dd>The frame's sequence number.</dd>
+ * <dt>Reference_Count</dt> <dd>The number of times the frame has been acquired and not released.</dd>
+ * </dl>
+ */
+struct Frame_View_Frame_Struct
+{
+	unsigned short *Image_Data;
+	int NCols;
+	int NRows;
+	int X_Bin;
+	int Y_Bin;
+	int Window_Number;
+	unsigned int Sequence;
+	int Reference_Count;
+};
+
+/**
+ * Data type holding local data to ccd_frame_view.
+ * <dl>
+ * <dt>Enable</dt> <dd>A boolean, whether frames are retained and the raw readout buffer can be viewed.</dd>
+ * <dt>Frame_List</dt> <dd>The retained frames.</dd>
+ * <dt>Latest_Index</dt> <dd>The index in Frame_List of the latest frame, or -1 if no frame is retained.</dd>
+ * <dt>Sequence</dt> <dd>The sequence number of the last frame read out.</dd>
+ * <dt>Raw_Data</dt> <dd>The raw readout buffer of the last readout.</dd>
+ * <dt>Raw_Pixel_Count</dt> <dd>The number of pixels in Raw_Data.</dd>
+ * <dt>Raw_Valid</dt> <dd>A boolean, whether Raw_Data holds a complete readout.</dd>
+ * <dt>Raw_Sequence</dt> <dd>Incremented each time the raw readout buffer is set or invalidated.</dd>
+ * <dt>Mutex</dt> <dd>Protects the frame list, which is used by the exposure thread and the Java threads.</dd>
+ * </dl>
+ * @see #Frame_View_Frame_Struct
+ * @see #CCD_FRAME_VIEW_MAX_FRAME_COUNT
+ */
+struct Frame_View_Struct
+{
+	int Enable;
+	struct Frame_View_Frame_Struct Frame_List[CCD_FRAME_VIEW_MAX_FRAME_COUNT];
+	int Latest_Index;
+	unsigned int Sequence;
+	unsigned short *Raw_Data;
+	size_t Raw_Pixel_Count;
+	int Raw_Valid;
+	volatile unsigned int Raw_Sequence;
+	pthread_mutex_t Mutex;
+};
+
+/* internal variables */
+/**
+ * Variable holding error code of last operation performed by ccd_frame_view.
+ */
+static int Frame_View_Error_Number = 0;
+/**
+ * Local variable holding description of the last error that occured.
+ */
+static char Frame_View_Error_String[CCD_GLOBAL_ERROR_STRING_LENGTH] = "";
+/**
+ * Local frame view data.
+ * @see #Frame_View_Struct
+ */
+static struct Frame_View_Struct Frame_View_Data =
+{
+	FALSE,{{NULL,0,0,0,0,0,0,0}},-1,0,NULL,0,FALSE,0,PTHREAD_MUTEX_INITIALIZER
+};
+
+/* internal function definitions */
+static void Frame_View_Frame_Free(struct Frame_View_Frame_Struct *frame);
+
+/* -----------------------------------------------------------------------------
+**     external functions
+** ----------------------------------------------------------------------------- */
+/**
+ * This routine sets up ccd_frame_view internal variables.
+ * It should be called at startup.
+ * @return This routine returns TRUE for success.
+ */
+int CCD_Frame_View_Initialise(void)
+{
+	Frame_View_Error_Number = 0;
+/* print some compile time information to stdout */
+	fprintf(stdout,"CCD_Frame_View_Initialise:%s.\n",rcsid);
+	return TRUE;
+}
+
+/**
+ * Routine to turn frame viewing on or off. When it is turned off, the latest frame is freed (unless it is
+ * still acquired, in which case it is freed when it is released), and the raw readout buffer can no longer
+ * be viewed.
+ * @param enable A boolean, whether to retain frames and allow the raw readout buffer to be viewed.
+ * @see #Frame_View_Data
+ * @see #Frame_View_Frame_Free
+ */
+void CCD_Frame_View_Set_Enable(int enable)
+{
+	pthread_mutex_lock(&(Frame_View_Data.Mutex));
+	Frame_View_Data.Enable = enable;
+	if(enable == FALSE)
+	{
+		if((Frame_View_Data.Latest_Index >= 0)&&
+		   (Frame_View_Data.Frame_List[Frame_View_Data.Latest_Index].Reference_Count == 0))
+		{
+			Frame_View_Frame_Free(&(Frame_View_Data.Frame_List[Frame_View_Data.Latest_Index]));
+		}
+		Frame_View_Data.Latest_Index = -1;
+		Frame_View_Data.Raw_Valid = FALSE;
+		Frame_View_Data.Raw_Sequence++;
+	}
+	pthread_mutex_unlock(&(Frame_View_Data.Mutex));
+}
+
+/**
+ * Routine to get whether frame viewing is on.
+ * @return A boolean, TRUE if frames are being retained.
+ * @see #Frame_View_Data
+ */
+int CCD_Frame_View_Get_Enable(void)
+{
+	return Frame_View_Data.Enable;
+}
+
+/**
+ * Routine called by the pixel stream code once a de-interlaced frame has been saved. The frame becomes the
+ * latest frame, and the image data is retained (without copying) until it is no longer the latest frame and
+ * has been released by everything that acquired it. The previous latest frame is freed, unless it is
+ * still acquired. Nothing is done if frame viewing is off.
+ * @param image_data The address of a pointer to the image data, allocated with malloc. If the frame is retained,
+ *        the pointer is set to NULL, and this module takes over freeing it. Otherwise (frame viewing is off,
+ *        or all CCD_FRAME_VIEW_MAX_FRAME_COUNT frames are still acquired), the pointer is left alone, and the
+ *        caller should free the image data as usual.
+ * @param ncols The number of binned columns in the frame.
+ * @param nrows The number of binned rows in the frame.
+ * @param x_bin The serial binning.
+ * @param y_bin The parallel binning.
+ * @param window_number 0 for a full frame, or the window number (1..4) of a windowed frame.
+ * @see #Frame_View_Data
+ * @see #Frame_View_Frame_Free
+ */
+void CCD_Frame_View_Post_Readout(unsigned short **image_data,int ncols,int nrows,int x_bin,int y_bin,
+				 int window_number)
+{
+	struct Frame_View_Frame_Struct *frame = NULL;
+	unsigned int sequence;
+	int i,frame_index;
+
+	if((image_data == NULL)||((*image_data) == NULL))
+		return;
+	pthread_mutex_lock(&(Frame_View_Data.Mutex));
+	if(Frame_View_Data.Enable == FALSE)
+	{
+		pthread_mutex_unlock(&(Frame_View_Data.Mutex));
+		return;
+	}
+	Frame_View_Data.Sequence++;
+	sequence = Frame_View_Data.Sequence;
+	/* the previous latest frame is freed now, unless someone has still acquired it */
+	if(Frame_View_Data.Latest_Index >= 0)
+	{
+		frame = &(Frame_View_Data.Frame_List[Frame_View_Data.Latest_Index]);
+		if(frame->Reference_Count == 0)
+			Frame_View_Frame_Free(frame);
+		Frame_View_Data.Latest_Index = -1;
+	}
+	frame_index = -1;
+	for(i = 0; i < CCD_FRAME_VIEW_MAX_FRAME_COUNT; i++)
+	{
+		if(Frame_View_Data.Frame_List[i].Image_Data == NULL)
+		{
+			frame_index = i;
+			break;
+		}
+	}
+	if(frame_index == -1)
+	{
+		pthread_mutex_unlock(&(Frame_View_Data.Mutex));
+#if LOGGING > 1
+		CCD_Global_Log_Format(LOG_VERBOSITY_TERSE,"CCD_Frame_View_Post_Readout:"
+				      "All %d frames are still acquired, frame %u not retained.",
+				      CCD_FRAME_VIEW_MAX_FRAME_COUNT,sequence);
+#endif
+		return;
+	}
+	frame = &(Frame_View_Data.Frame_List[frame_index]);
+	frame->Image_Data = (*image_data);
+	frame->NCols = ncols;
+	frame->NRows = nrows;
+	frame->X_Bin = x_bin;
+	frame->Y_Bin = y_bin;
+	frame->Window_Number = window_number;
+	frame->Sequence = sequence;
+	frame->Reference_Count = 0;
+	Frame_View_Data.Latest_Index = frame_index;
+	pthread_mutex_unlock(&(Frame_View_Data.Mutex));
+	(*image_data) = NULL;
+#if LOGGING > 9
+	CCD_Global_Log_Format(LOG_VERBOSITY_VERY_VERBOSE,"CCD_Frame_View_Post_Readout:"
+			      "Retained frame %u (%d x %d) in slot %d.",sequence,ncols,nrows,frame_index);
+#endif
+}
+
+/**
+ * Routine to acquire the latest de-interlaced frame. The frame's image data remains valid until it is released
+ * with CCD_Frame_View_Release (using the returned sequence number).
+ * @param image_data The address of a pointer, set to the frame's image data.
+ * @param ncols The address of an integer to store the number of binned columns in.
+ * @param nrows The address of an integer to store the number of binned rows in.
+ * @param x_bin The address of an integer to store the serial binning in.
+ * @param y_bin The address of an integer to store the parallel binning in.
+ * @param window_number The address of an integer to store the window number in (0 for a full frame).
+ * @param sequence The address of an unsigned integer to store the frame's sequence number in.
+ * @return The routine returns TRUE on success, and FALSE if an error occurs (frame viewing is off, or no frame
+ *         is retained).
+ * @see #Frame_View_Data
+ * @see #CCD_Frame_View_Release
+ */
+int CCD_Frame_View_Acquire(unsigned short **image_data,int *ncols,int *nrows,int *x_bin,int *y_bin,
+			   int *window_number,unsigned int *sequence)
+{
+	struct Frame_View_Frame_Struct *frame = NULL;
+
+	Frame_View_Error_Number = 0;
+	if((image_data == NULL)||(ncols == NULL)||(nrows == NULL)||(x_bin == NULL)||(y_bin == NULL)||
+	   (window_number == NULL)||(sequence == NULL))
+	{
+		Frame_View_Error_Number = 1;
+		sprintf(Frame_View_Error_String,"CCD_Frame_View_Acquire:NULL argument.");
+		return FALSE;
+	}
+	pthread_mutex_lock(&(Frame_View_Data.Mutex));
+	if(Frame_View_Data.Enable == FALSE)
+	{
+		pthread_mutex_unlock(&(Frame_View_Data.Mutex));
+		Frame_View_Error_Number = 6;
+		sprintf(Frame_View_Error_String,"CCD_Frame_View_Acquire:Frame viewing is not enabled.");
+		return FALSE;
+	}
+	if(Frame_View_Data.Latest_Index < 0)
+	{
+		pthread_mutex_unlock(&(Frame_View_Data.Mutex));
+		Frame_View_Error_Number = 2;
+		sprintf(Frame_View_Error_String,"CCD_Frame_View_Acquire:No frame is available (last sequence %u).",
+			Frame_View_Data.Sequence);
+		return FALSE;
+	}
+	frame = &(Frame_View_Data.Frame_List[Frame_View_Data.Latest_Index]);
+	frame->Reference_Count++;
+	(*image_data) = frame->Image_Data;
+	(*ncols) = frame->NCols;
+	(*nrows) = frame->NRows;
+	(*x_bin) = frame->X_Bin;
+	(*y_bin) = frame->Y_Bin;
+	(*window_number) = frame->Window_Number;
+	(*sequence) = frame->Sequence;
+	pthread_mutex_unlock(&(Frame_View_Data.Mutex));
+	return TRUE;
+}
+
+/**
+ * Routine to release a frame acquired with CCD_Frame_View_Acquire. If the frame is no longer the latest
+ * frame, and nothing else has acquired it, it's image data is freed. The image data must not be used after
+ * the frame has been released.
+ * @param sequence The sequence number of the frame, as returned by CCD_Frame_View_Acquire.
+ * @return The routine returns TRUE on success, and FALSE if an error occurs (the frame was not acquired).
+ * @see #Frame_View_Data
+ * @see #Frame_View_Frame_Free
+ * @see #CCD_Frame_View_Acquire
+ */
+int CCD_Frame_View_Release(unsigned int sequence)
+{
+	struct Frame_View_Frame_Struct *frame = NULL;
+	int i;
+
+	Frame_View_Error_Number = 0;
+	pthread_mutex_lock(&(Frame_View_Data.Mutex));
+	for(i = 0; i < CCD_FRAME_VIEW_MAX_FRAME_COUNT; i++)
+	{
+		if((Frame_View_Data.Frame_List[i].Image_Data != NULL)&&
+		   (Frame_View_Data.Frame_List[i].Sequence == sequence))
+		{
+			frame = &(Frame_View_Data.Frame_List[i]);
+			break;
+		}
+	}
+	if((frame == NULL)||(frame->Reference_Count < 1))
+	{
+		pthread_mutex_unlock(&(Frame_View_Data.Mutex));
+		Frame_View_Error_Number = 3;
+		sprintf(Frame_View_Error_String,"CCD_Frame_View_Release:Frame %u was not acquired.",sequence);
+		return FALSE;
+	}
+	frame->Reference_Count--;
+	if((frame->Reference_Count == 0)&&(i != Frame_View_Data.Latest_Index))
+		Frame_View_Frame_Free(frame);
+	pthread_mutex_unlock(&(Frame_View_Data.Mutex));
+	return TRUE;
+}
+
+/**
+ * Routine called by the pixel stream code when a readout has completed, before the raw readout buffer is
+ * processed, to make it available for viewing. If frame viewing is off, the raw readout buffer is not made
+ * available.
+ * @param raw_data The raw readout buffer.
+ * @param pixel_count The number of pixels read out into raw_data.
+ * @see #Frame_View_Data
+ */
+void CCD_Frame_View_Raw_Set(unsigned short *raw_data,size_t pixel_count)
+{
+	pthread_mutex_lock(&(Frame_View_Data.Mutex));
+	Frame_View_Data.Raw_Data = raw_data;
+	Frame_View_Data.Raw_Pixel_Count = pixel_count;
+	Frame_View_Data.Raw_Valid = (Frame_View_Data.Enable && (raw_data != NULL));
+	Frame_View_Data.Raw_Sequence++;
+	pthread_mutex_unlock(&(Frame_View_Data.Mutex));
+}
+
+/**
+ * Routine called at the start of an exposure, before the raw readout buffer is overwritten by the next
+ * readout, and by CCD_Setup_Startup/CCD_Setup_Shutdown (and the JNI memory map routine) before the raw
+ * readout buffer is remapped or unmapped. Any view of the raw readout buffer becomes invalid.
+ * @see #Frame_View_Data
+ */
+void CCD_Frame_View_Raw_Invalidate(void)
+{
+	pthread_mutex_lock(&(Frame_View_Data.Mutex));
+	Frame_View_Data.Raw_Valid = FALSE;
+	Frame_View_Data.Raw_Sequence++;
+	pthread_mutex_unlock(&(Frame_View_Data.Mutex));
+}
+
+/**
+ * Routine to get the raw readout buffer of the last readout. The data is only valid whilst
+ * CCD_Frame_View_Raw_Sequence_Get returns the same sequence number as this routine.
+ * @param raw_data The address of a pointer, set to the raw readout buffer.
+ * @param pixel_count The address of a size_t to store the number of pixels read out in.
+ * @param sequence The address of an unsigned integer to store the raw sequence number in.
+ * @return The routine returns TRUE on success, and FALSE if an error occurs (frame viewing is off, or there is
+ *         no complete readout in the buffer).
+ * @see #Frame_View_Data
+ * @see #CCD_Frame_View_Raw_Sequence_Get
+ */
+int CCD_Frame_View_Raw_Get(unsigned short **raw_data,size_t *pixel_count,unsigned int *sequence)
+{
+	Frame_View_Error_Number = 0;
+	if((raw_data == NULL)||(pixel_count == NULL)||(sequence == NULL))
+	{
+		Frame_View_Error_Number = 4;
+		sprintf(Frame_View_Error_String,"CCD_Frame_View_Raw_Get:NULL argument.");
+		return FALSE;
+	}
+	pthread_mutex_lock(&(Frame_View_Data.Mutex));
+	if(Frame_View_Data.Raw_Valid == FALSE)
+	{
+		pthread_mutex_unlock(&(Frame_View_Data.Mutex));
+		Frame_View_Error_Number = 5;
+		sprintf(Frame_View_Error_String,"CCD_Frame_View_Raw_Get:No complete readout is available.");
+		return FALSE;
+	}
+	(*raw_data) = Frame_View_Data.Raw_Data;
+	(*pixel_count) = Frame_View_Data.Raw_Pixel_Count;
+	(*sequence) = Frame_View_Data.Raw_Sequence;
+	pthread_mutex_unlock(&(Frame_View_Data.Mutex));
+	return TRUE;
+}
+
+/**
+ * Routine to copy the raw readout buffer of a readout, previously returned by CCD_Frame_View_Raw_Get.
+ * The copy is made with the mutex locked, so the raw readout buffer can't be invalidated (and then unmapped)
+ * whilst it is being copied.
+ * @param sequence The raw sequence number returned by CCD_Frame_View_Raw_Get.
+ * @param buffer The buffer to copy the pixels into.
+ * @param pixel_count The number of pixels to copy, which must be no more than the number of pixels read out.
+ * @return The routine returns TRUE on success, and FALSE if an error occurs (the raw sequence number has
+ *         changed, or too many pixels were requested).
+ * @see #Frame_View_Data
+ * @see #CCD_Frame_View_Raw_Get
+ */
+int CCD_Frame_View_Raw_Copy(unsigned int sequence,unsigned short *buffer,size_t pixel_count)
+{
+	Frame_View_Error_Number = 0;
+	if(buffer == NULL)
+	{
+		Frame_View_Error_Number = 7;
+		sprintf(Frame_View_Error_String,"CCD_Frame_View_Raw_Copy:buffer was NULL.");
+		return FALSE;
+	}
+	pthread_mutex_lock(&(Frame_View_Data.Mutex));
+	if((Frame_View_Data.Raw_Valid == FALSE)||(Frame_View_Data.Raw_Sequence != sequence))
+	{
+		pthread_mutex_unlock(&(Frame_View_Data.Mutex));
+		Frame_View_Error_Number = 8;
+		sprintf(Frame_View_Error_String,"CCD_Frame_View_Raw_Copy:Raw readout %u is no longer available "
+			"(current raw sequence %u).",sequence,Frame_View_Data.Raw_Sequence);
+		return FALSE;
+	}
+	if(pixel_count > Frame_View_Data.Raw_Pixel_Count)
+	{
+		pthread_mutex_unlock(&(Frame_View_Data.Mutex));
+		Frame_View_Error_Number = 9;
+		sprintf(Frame_View_Error_String,"CCD_Frame_View_Raw_Copy:Pixel count %lu too large (%lu read out).",
+			(unsigned long)pixel_count,(unsigned long)Frame_View_Data.Raw_Pixel_Count);
+		return FALSE;
+	}
+	memcpy(buffer,Frame_View_Data.Raw_Data,pixel_count*CCD_GLOBAL_BYTES_PER_PIXEL);
+	pthread_mutex_unlock(&(Frame_View_Data.Mutex));
+	return TRUE;
+}
+
+/**
+ * Routine to get the current raw sequence number. This changes whenever the raw readout buffer is about to be
+ * overwritten, or has been filled by a new readout.
+ * @return The raw sequence number.
+ * @see #Frame_View_Data
+ * @see #CCD_Frame_View_Raw_Get
+ */
+unsigned int CCD_Frame_View_Raw_Sequence_Get(void)
+{
+	return Frame_View_Data.Raw_Sequence;
+}
+
+/**
+ * Get the current value of the error number.
+ * @return The current value of the error number.
+ */
+int CCD_Frame_View_Get_Error_Number(void)
+{
+	return Frame_View_Error_Number;
+}
+
+/**
+ * The error routine that reports any errors occuring in ccd_frame_view in a standard way.
+ * @see ccd_global.html#CCD_Global_Get_Current_Time_String
+ */
+void CCD_Frame_View_Error(void)
+{
+	char time_string[32];
+
+	CCD_Global_Get_Current_Time_String(time_string,32);
+	/* if the error number is zero an error message has not been set up
+	** This is in itself an error as we should not be calling this routine
+	** without there being an error to display */
+	if(Frame_View_Error_Number == 0)
+		sprintf(Frame_View_Error_String,"Logic Error:No Error defined");
+	fprintf(stderr,"%s CCD_Frame_View:Error(%d) : %s\n",time_string,Frame_View_Error_Number,
+		Frame_View_Error_String);
+}
+
+/**
+ * The error routine that reports any errors occuring in ccd_frame_view in a standard way. This routine places the
+ * generated error string at the end of a passed in string argument.
+ * @param error_string A string to put the generated error in. This string should be initialised before
+ * being passed to this routine. The routine will try to concatenate it's error string onto the end
+ * of any string already in existance.
+ * @see ccd_global.html#CCD_Global_Get_Current_Time_String
+ */
+void CCD_Frame_View_Error_String(char *error_string)
+{
+	char time_string[32];
+
+	CCD_Global_Get_Current_Time_String(time_string,32);
+	/* if the error number is zero an error message has not been set up
+	** This is in itself an error as we should not be calling this routine
+	** without there being an error to display */
+	if(Frame_View_Error_Number == 0)
+		sprintf(Frame_View_Error_String,"Logic Error:No Error defined");
+	sprintf(error_string+strlen(error_string),"%s CCD_Frame_View:Error(%d) : %s\n",time_string,
+		Frame_View_Error_Number,Frame_View_Error_String);
+}
+
+/* -----------------------------------------------------------------------------
+**     internal functions
+** ----------------------------------------------------------------------------- */
+/**
+ * Free a retained frame's image data, and mark the entry as not in use. Called with the mutex locked.
+ * @param frame The frame to free.
+ */
+static void Frame_View_Frame_Free(struct Frame_View_Frame_Struct *frame)
+{
+	if(frame->Image_Data != NULL)
+		free(frame->Image_Data);
+	frame->Image_Data = NULL;
+	frame->Reference_Count = 0;
+}
+
+/*
+** $Log: not supported by cvs2svn $
+*/
@@ -37,6 +37,8 @@
 #include <stdio.h>
 #include <errno.h>
 #include <limits.h>
+#include <math.h>
+#include <stdlib.h>
 #include <sys/types.h>
 #include <string.h>
 #include <time.h>
@@ -57,6 +59,18 @@
 #endif /* CCD_GLOBAL_READOUT_MLOCK */
 #include "log_udp.h"
 #include "ccd_dsp.h"
+#include "ccd_combine.h"
+#include "ccd_compress.h"
+#include "ccd_disk_write.h"
+#include "ccd_frame_ring.h"
+#include "ccd_preview.h"
+#include "ccd_timing.h"
+#include "ccd_trace.h"
+#include "ccd_frame_view.h"
+#include "ccd_exposure_event.h"
+#include "ccd_status.h"
+#include "ccd_seeing.h"
+#include "ccd_readout_watchdog.h"
 #include "ccd_dsp_download.h"
 #include "ccd_exposure.h"
 #include "ccd_filter_wheel.h"
@@ -65,7 +79,10 @@
 #include "ccd_pci.h"
 #include "ccd_pixel_stream.h"
 #include "ccd_setup.h"
+#include "ccd_source_find.h"
 #include "ccd_text.h"
+#include "ccd_telemetry.h"
+#include "ccd_telemetry_store.h"
 #include "ccd_temperature.h"
 
 /* hash definitions */
@@ -200,6 +217,21 @@ static char Global_Buff[CCD_GLOBAL_ERROR_STRING_LENGTH];
  * @see ccd_exposure.html#CCD_Exposure_Initialise
  * @see ccd_pixel_stream.html#CCD_Pixel_Stream_Initialise
  * @see ccd_setup.html#CCD_Setup_Initialise
+ * @see ccd_source_find.html#CCD_Source_Find_Initialise
+ * @see ccd_combine.html#CCD_Combine_Initialise
+ * @see ccd_compress.html#CCD_Compress_Initialise
+ * @see ccd_disk_write.html#CCD_Disk_Write_Initialise
+ * @see ccd_frame_ring.html#CCD_Frame_Ring_Initialise
+ * @see ccd_preview.html#CCD_Preview_Initialise
+ * @see ccd_timing.html#CCD_Timing_Initialise
+ * @see ccd_trace.html#CCD_Trace_Initialise
+ * @see ccd_frame_view.html#CCD_Frame_View_Initialise
+ * @see ccd_exposure_event.html#CCD_Exposure_Event_Initialise
+ * @see ccd_status.html#CCD_Status_Initialise
+ * @see ccd_seeing.html#CCD_Seeing_Initialise
+ * @see ccd_readout_watchdog.html#CCD_Readout_Watchdog_Initialise
+ * @see ccd_telemetry.html#CCD_Telemetry_Initialise
+ * @see ccd_telemetry_store.html#CCD_Telemetry_Store_Initialise
  */
 void CCD_Global_Initialise(void)
 {
@@ -212,6 +244,21 @@ void CCD_Global_Initialise(void)
 	CCD_Pixel_Stream_Initialise();
 	CCD_Setup_Initialise();
 	CCD_Filter_Wheel_Initialise();
+	CCD_Source_Find_Initialise();
+	CCD_Combine_Initialise();
+	CCD_Compress_Initialise();
+	CCD_Disk_Write_Initialise();
+	CCD_Frame_Ring_Initialise();
+	CCD_Preview_Initialise();
+	CCD_Timing_Initialise();
+	CCD_Trace_Initialise();
+	CCD_Frame_View_Initialise();
+	CCD_Exposure_Event_Initialise();
+	CCD_Status_Initialise();
+	CCD_Seeing_Initialise();
+	CCD_Readout_Watchdog_Initialise();
+	CCD_Telemetry_Initialise();
+	CCD_Telemetry_Store_Initialise();
 /* print some compile time information to stdout */
 	fprintf(stdout,"CCD_Global_Initialise:%s.\n",rcsid);
 #if CCD_GLOBAL_READOUT_PRIORITY == 0
@@ -246,6 +293,36 @@ void CCD_Global_Initialise(void)
  * @see ccd_exposure.html#CCD_Exposure_Error
  * @see ccd_filter_wheel.html#CCD_Filter_Wheel_Get_Error_Number
  * @see ccd_filter_wheel.html#CCD_Filter_Wheel_Error
+ * @see ccd_source_find.html#CCD_Source_Find_Get_Error_Number
+ * @see ccd_source_find.html#CCD_Source_Find_Error
+ * @see ccd_combine.html#CCD_Combine_Get_Error_Number
+ * @see ccd_combine.html#CCD_Combine_Error
+ * @see ccd_compress.html#CCD_Compress_Get_Error_Number
+ * @see ccd_compress.html#CCD_Compress_Error
+ * @see ccd_disk_write.html#CCD_Disk_Write_Get_Error_Number
+ * @see ccd_disk_write.html#CCD_Disk_Write_Error
+ * @see ccd_frame_ring.html#CCD_Frame_Ring_Get_Error_Number
+ * @see ccd_frame_ring.html#CCD_Frame_Ring_Error
+ * @see ccd_preview.html#CCD_Preview_Get_Error_Number
+ * @see ccd_preview.html#CCD_Preview_Error
+ * @see ccd_timing.html#CCD_Timing_Get_Error_Number
+ * @see ccd_timing.html#CCD_Timing_Error
+ * @see ccd_trace.html#CCD_Trace_Get_Error_Number
+ * @see ccd_trace.html#CCD_Trace_Error
+ * @see ccd_frame_view.html#CCD_Frame_View_Get_Error_Number
+ * @see ccd_frame_view.html#CCD_Frame_View_Error
+ * @see ccd_exposure_event.html#CCD_Exposure_Event_Get_Error_Number
+ * @see ccd_exposure_event.html#CCD_Exposure_Event_Error
+ * @see ccd_status.html#CCD_Status_Get_Error_Number
+ * @see ccd_status.html#CCD_Status_Error
+ * @see ccd_seeing.html#CCD_Seeing_Get_Error_Number
+ * @see ccd_seeing.html#CCD_Seeing_Error
+ * @see ccd_readout_watchdog.html#CCD_Readout_Watchdog_Get_Error_Number
+ * @see ccd_readout_watchdog.html#CCD_Readout_Watchdog_Error
+ * @see ccd_telemetry.html#CCD_Telemetry_Get_Error_Number
+ * @see ccd_telemetry.html#CCD_Telemetry_Error
+ * @see ccd_telemetry_store.html#CCD_Telemetry_Store_Get_Error_Number
+ * @see ccd_telemetry_store.html#CCD_Telemetry_Store_Error
  * @see ccd_temperature.html#CCD_Temperature_Get_Error_Number
  * @see ccd_temperature.html#CCD_Temperature_Error
  * @see ccd_dsp.html#CCD_DSP_Get_Error_Number
@@ -285,6 +362,81 @@ void CCD_Global_Error(void)
 		found = TRUE;
 		CCD_Filter_Wheel_Error();
 	}
+	if(CCD_Source_Find_Get_Error_Number() != 0)
+	{
+		found = TRUE;
+		CCD_Source_Find_Error();
+	}
+	if(CCD_Combine_Get_Error_Number() != 0)
+	{
+		found = TRUE;
+		CCD_Combine_Error();
+	}
+	if(CCD_Compress_Get_Error_Number() != 0)
+	{
+		found = TRUE;
+		CCD_Compress_Error();
+	}
+	if(CCD_Disk_Write_Get_Error_Number() != 0)
+	{
+		found = TRUE;
+		CCD_Disk_Write_Error();
+	}
+	if(CCD_Frame_Ring_Get_Error_Number() != 0)
+	{
+		found = TRUE;
+		CCD_Frame_Ring_Error();
+	}
+	if(CCD_Preview_Get_Error_Number() != 0)
+	{
+		found = TRUE;
+		CCD_Preview_Error();
+	}
+	if(CCD_Timing_Get_Error_Number() != 0)
+	{
+		found = TRUE;
+		CCD_Timing_Error();
+	}
+	if(CCD_Trace_Get_Error_Number() != 0)
+	{
+		found = TRUE;
+		CCD_Trace_Error();
+	}
+	if(CCD_Frame_View_Get_Error_Number() != 0)
+	{
+		found = TRUE;
+		CCD_Frame_View_Error();
+	}
+	if(CCD_Exposure_Event_Get_Error_Number() != 0)
+	{
+		found = TRUE;
+		CCD_Exposure_Event_Error();
+	}
+	if(CCD_Status_Get_Error_Number() != 0)
+	{
+		found = TRUE;
+		CCD_Status_Error();
+	}
+	if(CCD_Seeing_Get_Error_Number() != 0)
+	{
+		found = TRUE;
+		CCD_Seeing_Error();
+	}
+	if(CCD_Readout_Watchdog_Get_Error_Number() != 0)
+	{
+		found = TRUE;
+		CCD_Readout_Watchdog_Error();
+	}
+	if(CCD_Telemetry_Get_Error_Number() != 0)
+	{
+		found = TRUE;
+		CCD_Telemetry_Error();
+	}
+	if(CCD_Telemetry_Store_Get_Error_Number() != 0)
+	{
+		found = TRUE;
+		CCD_Telemetry_Store_Error();
+	}
 	if(CCD_Temperature_Get_Error_Number() != 0)
 	{
 		found = TRUE;
@@ -351,6 +503,36 @@ void CCD_Global_Error(void)
  * @see ccd_exposure.html#CCD_Exposure_Error_String
  * @see ccd_filter_wheel.html#CCD_Filter_Wheel_Get_Error_Number
  * @see ccd_filter_wheel.html#CCD_Filter_Wheel_Error_String
+ * @see ccd_source_find.html#CCD_Source_Find_Get_Error_Number
+ * @see ccd_source_find.html#CCD_Source_Find_Error_String
+ * @see ccd_combine.html#CCD_Combine_Get_Error_Number
+ * @see ccd_combine.html#CCD_Combine_Error_String
+ * @see ccd_compress.html#CCD_Compress_Get_Error_Number
+ * @see ccd_compress.html#CCD_Compress_Error_String
+ * @see ccd_disk_write.html#CCD_Disk_Write_Get_Error_Number
+ * @see ccd_disk_write.html#CCD_Disk_Write_Error_String
+ * @see ccd_frame_ring.html#CCD_Frame_Ring_Get_Error_Number
+ * @see ccd_frame_ring.html#CCD_Frame_Ring_Error_String
+ * @see ccd_preview.html#CCD_Preview_Get_Error_Number
+ * @see ccd_preview.html#CCD_Preview_Error_String
+ * @see ccd_timing.html#CCD_Timing_Get_Error_Number
+ * @see ccd_timing.html#CCD_Timing_Error_String
+ * @see ccd_trace.html#CCD_Trace_Get_Error_Number
+ * @see ccd_trace.html#CCD_Trace_Error_String
+ * @see ccd_frame_view.html#CCD_Frame_View_Get_Error_Number
+ * @see ccd_frame_view.html#CCD_Frame_View_Error_String
+ * @see ccd_exposure_event.html#CCD_Exposure_Event_Get_Error_Number
+ * @see ccd_exposure_event.html#CCD_Exposure_Event_Error_String
+ * @see ccd_status.html#CCD_Status_Get_Error_Number
+ * @see ccd_status.html#CCD_Status_Error_String
+ * @see ccd_seeing.html#CCD_Seeing_Get_Error_Number
+ * @see ccd_seeing.html#CCD_Seeing_Error_String
+ * @see ccd_readout_watchdog.html#CCD_Readout_Watchdog_Get_Error_Number
+ * @see ccd_readout_watchdog.html#CCD_Readout_Watchdog_Error_String
+ * @see ccd_telemetry.html#CCD_Telemetry_Get_Error_Number
+ * @see ccd_telemetry.html#CCD_Telemetry_Error_String
+ * @see ccd_telemetry_store.html#CCD_Telemetry_Store_Get_Error_Number
+ * @see ccd_telemetry_store.html#CCD_Telemetry_Store_Error_String
  * @see ccd_temperature.html#CCD_Temperature_Get_Error_Number
  * @see ccd_temperature.html#CCD_Temperature_Error_String
  * @see ccd_dsp.html#CCD_DSP_Get_Error_Number
@@ -386,6 +568,66 @@ void CCD_Global_Error_String(char *error_string)
 	{
 		CCD_Filter_Wheel_Error_String(error_string);
 	}
+	if(CCD_Source_Find_Get_Error_Number() != 0)
+	{
+		CCD_Source_Find_Error_String(error_string);
+	}
+	if(CCD_Combine_Get_Error_Number() != 0)
+	{
+		CCD_Combine_Error_String(error_string);
+	}
+	if(CCD_Compress_Get_Error_Number() != 0)
+	{
+		CCD_Compress_Error_String(error_string);
+	}
+	if(CCD_Disk_Write_Get_Error_Number() != 0)
+	{
+		CCD_Disk_Write_Error_String(error_string);
+	}
+	if(CCD_Frame_Ring_Get_Error_Number() != 0)
+	{
+		CCD_Frame_Ring_Error_String(error_string);
+	}
+	if(CCD_Preview_Get_Error_Number() != 0)
+	{
+		CCD_Preview_Error_String(error_string);
+	}
+	if(CCD_Timing_Get_Error_Number() != 0)
+	{
+		CCD_Timing_Error_String(error_string);
+	}
+	if(CCD_Trace_Get_Error_Number() != 0)
+	{
+		CCD_Trace_Error_String(error_string);
+	}
+	if(CCD_Frame_View_Get_Error_Number() != 0)
+	{
+		CCD_Frame_View_Error_String(error_string);
+	}
+	if(CCD_Exposure_Event_Get_Error_Number() != 0)
+	{
+		CCD_Exposure_Event_Error_String(error_string);
+	}
+	if(CCD_Status_Get_Error_Number() != 0)
+	{
+		CCD_Status_Error_String(error_string);
+	}
+	if(CCD_Seeing_Get_Error_Number() != 0)
+	{
+		CCD_Seeing_Error_String(error_string);
+	}
+	if(CCD_Readout_Watchdog_Get_Error_Number() != 0)
+	{
+		CCD_Readout_Watchdog_Error_String(error_string);
+	}
+	if(CCD_Telemetry_Get_Error_Number() != 0)
+	{
+		CCD_Telemetry_Error_String(error_string);
+	}
+	if(CCD_Telemetry_Store_Get_Error_Number() != 0)
+	{
+		CCD_Telemetry_Store_Error_String(error_string);
+	}
 	if(CCD_Temperature_Get_Error_Number() != 0)
 	{
 		strcat(error_string,"\t");
@@ -948,6 +1190,62 @@ void CCD_Global_Subtract_Time_Ms(struct timespec *time,int ms)
 	}
 }
 
+/**
+ * Routine to get the zero based index of a percentile in a sorted list, using the nearest rank method:
+ * the index of the smallest value with at least percentile% of the values less than or equal to it.
+ * @param percentile The percentile to get, from 0 to 100 (i.e. 50 for the median, 100 for the maximum).
+ * @param count The number of values in the list.
+ * @return The index, between 0 and count-1 (0 if count is 0).
+ */
+int CCD_Global_Percentile_Index(double percentile,int count)
+{
+	int index;
+
+	index = ((int)ceil((percentile/100.0)*((double)count)))-1;
+	if(index >= count)
+		index = count-1;
+	if(index < 0)
+		index = 0;
+	return index;
+}
+
+/**
+ * Routine to get a percentile of a list of values, using the nearest rank method. Modules keeping a ring of
+ * recent samples copy it (under their own mutex) and call this routine on the copy.
+ * @param list The list of values. This is sorted into ascending order in place.
+ * @param count The number of values in the list.
+ * @param percentile The percentile to get, from 0 to 100 (i.e. 50 for the median, 100 for the maximum).
+ * @return The percentile value, or 0.0 if count is 0.
+ * @see #CCD_Global_Percentile_Index
+ * @see #CCD_Global_Double_Compare
+ */
+double CCD_Global_Percentile(double *list,int count,double percentile)
+{
+	if(count < 1)
+		return 0.0;
+	qsort(list,count,sizeof(double),CCD_Global_Double_Compare);
+	return list[CCD_Global_Percentile_Index(percentile,count)];
+}
+
+/**
+ * qsort comparison routine for doubles, in ascending order.
+ * @param p1 A pointer to the first double.
+ * @param p2 A pointer to the second double.
+ * @return Less than, equal to, or greater than zero, if the first double is less than, equal to, or greater
+ *         than the second.
+ */
+int CCD_Global_Double_Compare(const void *p1,const void *p2)
+{
+	double d1 = *((const double *)p1);
+	double d2 = *((const double *)p2);
+
+	if(d1 < d2)
+		return -1;
+	if(d1 > d2)
+		return 1;
+	return 0;
+}
+
 /*
 ** $Log: not supported by cvs2svn $
 ** Revision 1.1  2011/11/23 10:59:52  cjm
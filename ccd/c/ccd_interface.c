@@ -24,8 +24,17 @@
 #include "ccd_text.h"
 #include "ccd_pci.h"
 #include "ccd_setup.h"
+#include "ccd_trace.h"
 #include "ccd_interface_private.h"
 
+/* hash defines */
+/**
+ * The number of arguments of a request list copied for tracing (the header word, the DSP command and it's
+ * first argument).
+ * @see #CCD_Interface_Command_List
+ */
+#define INTERFACE_TRACE_ARGUMENT_COUNT	(3)
+
 /* internal structures */
 /* internal variables */
 /**
@@ -212,13 +221,19 @@ int CCD_Interface_Memory_UnMap(CCD_Interface_Handle_T *handle)
  * 	the routine, the return value from the DSP code may be in the argument.
  * @return The routine returns the return value from the command routine it called. This will normally be TRUE
  * 	if the request was sent correctly, or FALSE if it failed in some way.
+ * 	The request is traced (timed and recorded) using ccd_trace.
  * @see #CCD_Interface_Handle_T
  * @see ccd_text.html#CCD_Text_Command
  * @see ccd_pci.html#CCD_PCI_Command
  * @see ccd_dsp.html#DSP_Send_Command
+ * @see ccd_trace.html#CCD_Trace_Request_Start
+ * @see ccd_trace.html#CCD_Trace_Request_End
  */
 int CCD_Interface_Command(CCD_Interface_Handle_T *handle,int request,int *argument)
 {
+	struct timespec start_time;
+	int argument_value,retval;
+
 	Interface_Error_Number = 0;
 	/* check parameters */
 	if(handle == NULL)
@@ -228,12 +243,25 @@ int CCD_Interface_Command(CCD_Interface_Handle_T *handle,int request,int *argume
 		return FALSE;
 	}
 	/* call the device specific command routine */
+	/* the argument is overwritten by the reply, so keep a copy for tracing */
+	if(argument != NULL)
+		argument_value = (*argument);
+	else
+		argument_value = 0;
 	switch(handle->Interface_Device)
 	{
 		case CCD_INTERFACE_DEVICE_TEXT:
-			return CCD_Text_Command(handle,request,argument);
+			CCD_Trace_Request_Start(&start_time);
+			retval = CCD_Text_Command(handle,request,argument);
+			CCD_Trace_Request_End(start_time,request,&argument_value,1,
+					      (argument != NULL) ? (*argument) : 0,retval);
+			return retval;
 		case CCD_INTERFACE_DEVICE_PCI:
-			return CCD_PCI_Command(handle,request,argument);
+			CCD_Trace_Request_Start(&start_time);
+			retval = CCD_PCI_Command(handle,request,argument);
+			CCD_Trace_Request_End(start_time,request,&argument_value,1,
+					      (argument != NULL) ? (*argument) : 0,retval);
+			return retval;
 		default:
 			Interface_Error_Number = 4;
 			sprintf(Interface_Error_String,"CCD_Interface_Command failed:No device selected(%p,%d).",
@@ -252,13 +280,21 @@ int CCD_Interface_Command(CCD_Interface_Handle_T *handle,int request,int *argume
  * @param argument_count The number of arguments in argument_list.
  * @return The routine returns the return value from the command routine it called. This will normally be TRUE
  * 	if the request was sent correctly, or FALSE if it failed in some way.
+ * 	The request is traced (timed and recorded) using ccd_trace.
  * @see #CCD_Interface_Handle_T
+ * @see #INTERFACE_TRACE_ARGUMENT_COUNT
  * @see ccd_text.html#CCD_Text_Command_List
  * @see ccd_pci.html#CCD_PCI_Command_List
  * @see ccd_dsp.html#DSP_Send_Command
+ * @see ccd_trace.html#CCD_Trace_Request_Start
+ * @see ccd_trace.html#CCD_Trace_Request_End
  */
 int CCD_Interface_Command_List(CCD_Interface_Handle_T *handle,int request,int *argument_list,int argument_count)
 {
+	int trace_argument_list[INTERFACE_TRACE_ARGUMENT_COUNT];
+	struct timespec start_time;
+	int trace_argument_count,retval,i;
+
 	Interface_Error_Number = 0;
 	/* check parameters */
 	if(handle == NULL)
@@ -268,12 +304,28 @@ int CCD_Interface_Command_List(CCD_Interface_Handle_T *handle,int request,int *a
 		return FALSE;
 	}
 	/* call the device specific command routine */
+	/* the argument list is overwritten by the reply, so keep a copy of the start of it for tracing */
+	trace_argument_count = 0;
+	if(argument_list != NULL)
+	{
+		for(i = 0; (i < argument_count)&&(i < INTERFACE_TRACE_ARGUMENT_COUNT); i++)
+			trace_argument_list[i] = argument_list[i];
+		trace_argument_count = i;
+	}
 	switch(handle->Interface_Device)
 	{
 		case CCD_INTERFACE_DEVICE_TEXT:
-			return CCD_Text_Command_List(handle,request,argument_list,argument_count);
+			CCD_Trace_Request_Start(&start_time);
+			retval = CCD_Text_Command_List(handle,request,argument_list,argument_count);
+			CCD_Trace_Request_End(start_time,request,trace_argument_list,trace_argument_count,
+					      (argument_list != NULL) ? argument_list[0] : 0,retval);
+			return retval;
 		case CCD_INTERFACE_DEVICE_PCI:
-			return CCD_PCI_Command_List(handle,request,argument_list,argument_count);
+			CCD_Trace_Request_Start(&start_time);
+			retval = CCD_PCI_Command_List(handle,request,argument_list,argument_count);
+			CCD_Trace_Request_End(start_time,request,trace_argument_list,trace_argument_count,
+					      (argument_list != NULL) ? argument_list[0] : 0,retval);
+			return retval;
 		default:
 			Interface_Error_Number = 5;
 			sprintf(Interface_Error_String,"CCD_Interface_Command_List failed:No device selected(%p,%d).",
@@ -28,11 +28,20 @@
 #include "log_udp.h"
 #include "ccd_dsp.h"
 #include "ccd_exposure.h"
+#include "ccd_combine.h"
+#include "ccd_compress.h"
+#include "ccd_disk_write.h"
+#include "ccd_frame_ring.h"
+#include "ccd_frame_view.h"
+#include "ccd_preview.h"
+#include "ccd_seeing.h"
 #include "ccd_global.h"
 #include "ccd_interface.h"
 #include "ccd_pixel_stream.h"
 #include "ccd_setup.h"
 #include "ccd_setup_private.h"
+#include "ccd_source_find.h"
+#include "ccd_timing.h"
 #ifdef CFITSIO
 #include "fitsio.h"
 #endif
@@ -53,6 +62,13 @@
  * The maximum numbers of corners (amplifiers) in one image (detector). Currently set to 4.
  */
 #define PIXEL_STREAM_MAX_CORNER_COUNT     (4)
+/**
+ * Mask applied to the input pixel index when de-interlacing a full frame. The abort flag is checked whenever
+ * the masked index is zero, i.e. every 262144 pixels (a few milliseconds of de-interlacing), so an abort
+ * stops de-interlacing quickly without checking the flag on every pixel.
+ * @see #CCD_Pixel_Stream_Post_Readout_Full_Frame
+ */
+#define PIXEL_STREAM_ABORT_CHECK_MASK     (0x3ffff)
 
 /* internal enumerations */
 /**
@@ -232,7 +248,20 @@ void CCD_Pixel_Stream_Initialise(void)
  * <ul>
  * <li>The number of columns and rows are retrieved from setup.
  * <li>The data is de-interlaced using Pixel_Stream_DeInterlace.
+ * <li>CCD_Source_Find_Post_Readout is called, which runs the source finder on the image data if it is enabled.
+ *     Source finder failures are logged, but do not stop the frame being saved.
+ * <li>CCD_Seeing_Post_Readout is called, which runs the seeing estimator on the image data if it is enabled.
+ *     Seeing estimator failures are logged, but do not stop the frame being saved.
+ * <li>CCD_Combine_Post_Readout is called, which adds the image data to the master calibration frame combine,
+ *     if one is active. Combine failures are logged, but do not stop the frame being saved.
+ * <li>CCD_Frame_Ring_Publish is called, which publishes the image data to the shared memory frame ring,
+ *     if it is open. Publish failures are logged, but do not stop the frame being saved.
  * <li>The data is saved to disc using Pixel_Stream_Save.
+ * <li>CCD_Preview_Post_Readout is called, which saves quick-look previews of the image data, if enabled.
+ *     Preview failures are logged, but do not fail the exposure.
+ * <li>CCD_Frame_View_Post_Readout is called, which keeps the image data in memory (instead of it being freed)
+ *     so it can be viewed without copying, if frame viewing is enabled. The raw readout buffer is made available for viewing before
+ *     de-interlacing, with CCD_Frame_View_Raw_Set.
  * </ul>
  * If an error occurs BEFORE saving the read out frame to disk, CCD_Pixel_Stream_Delete_Fits_Images is called
  * to delete any 'blank' FITS files.
@@ -247,12 +276,24 @@ void CCD_Pixel_Stream_Initialise(void)
  * @see #Pixel_Stream_Save
  * @see #CCD_Pixel_Stream_Delete_Fits_Images
  * @see #PIXEL_STREAM_MAX_CORNER_COUNT
+ * @see #PIXEL_STREAM_ABORT_CHECK_MASK
  * @see ccd_dsp.html#CCD_DSP_IS_DUMMY_AMPLIFIER
+ * @see ccd_dsp.html#CCD_DSP_Get_Abort
  * @see ccd_exposure.html#CCD_Exposure_Get_Exposure_Start_Time
  * @see ccd_setup.html#CCD_Setup_Get_Binned_NCols
  * @see ccd_setup.html#CCD_Setup_Get_Binned_NRows
  * @see ccd_setup.html#CCD_Setup_Get_Readout_Pixel_Count
  * @see ccd_setup.html#CCD_Setup_Get_Amplifier
+ * @see ccd_source_find.html#CCD_Source_Find_Post_Readout
+ * @see ccd_seeing.html#CCD_Seeing_Post_Readout
+ * @see ccd_combine.html#CCD_Combine_Post_Readout
+ * @see ccd_frame_ring.html#CCD_Frame_Ring_Publish
+ * @see ccd_preview.html#CCD_Preview_Post_Readout
+ * @see ccd_frame_view.html#CCD_Frame_View_Post_Readout
+ * @see ccd_frame_view.html#CCD_Frame_View_Raw_Set
+ * @see ccd_exposure.html#CCD_Exposure_Get_Exposure_Length
+ * @see ccd_setup.html#CCD_Setup_Get_NSBin
+ * @see ccd_setup.html#CCD_Setup_Get_NPBin
  * @see ccd_interface.html#CCD_Interface_Handle_T
  */
 int CCD_Pixel_Stream_Post_Readout_Full_Frame(CCD_Interface_Handle_T* handle,unsigned short *exposure_data,
@@ -356,6 +397,7 @@ int CCD_Pixel_Stream_Post_Readout_Full_Frame(CCD_Interface_Handle_T* handle,unsi
 			return FALSE;
 		}
 	}
+	CCD_Timing_Phase_Start(CCD_TIMING_PHASE_DEINTERLACE);
 /* byte swap to get into right order */
 #ifdef CCD_EXPOSURE_BYTE_SWAP
 #if LOGGING > 4
@@ -364,6 +406,8 @@ int CCD_Pixel_Stream_Post_Readout_Full_Frame(CCD_Interface_Handle_T* handle,unsi
 #endif
 	Pixel_Stream_Byte_Swap(exposure_data,expected_pixel_count);
 #endif
+	/* make the raw readout buffer available for viewing */
+	CCD_Frame_View_Raw_Set(exposure_data,(size_t)exposure_data_pixel_count);
 	/* calculate ncols to use based on whether the amplifier setting is a split serial one */
 	if(pixel_stream_entry.Is_Split_Serial)
 		binned_split_ncols = binned_ncols / 2;
@@ -386,6 +430,9 @@ int CCD_Pixel_Stream_Post_Readout_Full_Frame(CCD_Interface_Handle_T* handle,unsi
 	exposure_data_pixel_index = 0;
 	while(exposure_data_pixel_index < exposure_data_pixel_count)
 	{
+		/* check for an abort every so often, the abort is handled after the loop */
+		if(((exposure_data_pixel_index & PIXEL_STREAM_ABORT_CHECK_MASK) == 0)&&CCD_DSP_Get_Abort())
+			break;
 		/* which image and corner does this pixel belong to */
 		image_index = pixel_stream_entry.Pixel_List[pixel_stream_entry_pixel_index].Image_Number;
 		corner_index = pixel_stream_entry.Pixel_List[pixel_stream_entry_pixel_index].Corner_Number;
@@ -453,6 +500,7 @@ int CCD_Pixel_Stream_Post_Readout_Full_Frame(CCD_Interface_Handle_T* handle,unsi
 		/* look at the next input pixel in exposure_data */
 		exposure_data_pixel_index++;
 	}/* end while on pixels in exposure_data (exposure_data_pixel_index) */
+	CCD_Timing_Phase_End(CCD_TIMING_PHASE_DEINTERLACE);
 	/* if we have aborted stop and return */
 	if(CCD_DSP_Get_Abort())
 	{
@@ -464,19 +512,73 @@ int CCD_Pixel_Stream_Post_Readout_Full_Frame(CCD_Interface_Handle_T* handle,unsi
 		sprintf(Pixel_Stream_Error_String,"CCD_Pixel_Stream_Post_Readout_Full_Frame:Aborted.");
 		return FALSE;
 	}
+	/* find the brightest object (if enabled) whilst the de-interlaced image is still in memory */
+	if(!CCD_Source_Find_Post_Readout(Image_Data_List[0],binned_ncols,binned_nrows))
+	{
+#if LOGGING > 1
+		CCD_Global_Log_Format(LOG_VERBOSITY_TERSE,"CCD_Pixel_Stream_Post_Readout_Full_Frame:"
+				      "Source finder failed (source find error %d), continuing.",
+				      CCD_Source_Find_Get_Error_Number());
+#endif
+	}
+	/* estimate the seeing (if enabled) whilst the de-interlaced image is still in memory */
+	if(!CCD_Seeing_Post_Readout(Image_Data_List[0],binned_ncols,binned_nrows))
+	{
+#if LOGGING > 1
+		CCD_Global_Log_Format(LOG_VERBOSITY_TERSE,"CCD_Pixel_Stream_Post_Readout_Full_Frame:"
+				      "Seeing estimator failed (seeing error %d), continuing.",
+				      CCD_Seeing_Get_Error_Number());
+#endif
+	}
+	/* add the de-interlaced image to the master bias/dark combine (if active) */
+	if(!CCD_Combine_Post_Readout(Image_Data_List[0],binned_ncols,binned_nrows))
+	{
+#if LOGGING > 1
+		CCD_Global_Log_Format(LOG_VERBOSITY_TERSE,"CCD_Pixel_Stream_Post_Readout_Full_Frame:"
+				      "Combine failed (combine error %d), continuing.",
+				      CCD_Combine_Get_Error_Number());
+#endif
+	}
+	exposure_start_time = CCD_Exposure_Get_Exposure_Start_Time(handle);
+	/* publish the de-interlaced image to local consumers (if the frame ring is open) before it is saved */
+	if(!CCD_Frame_Ring_Publish(Image_Data_List[0],binned_ncols,binned_nrows,CCD_Setup_Get_NSBin(handle),
+				   CCD_Setup_Get_NPBin(handle),0,CCD_Exposure_Get_Exposure_Length(handle),
+				   exposure_start_time,filename))
+	{
+#if LOGGING > 1
+		CCD_Global_Log_Format(LOG_VERBOSITY_TERSE,"CCD_Pixel_Stream_Post_Readout_Full_Frame:"
+				      "Frame ring publish failed (frame ring error %d), continuing.",
+				      CCD_Frame_Ring_Get_Error_Number());
+#endif
+	}
 /* save the resultant image to disk */
 #if LOGGING > 4
 	CCD_Global_Log_Format(LOG_VERBOSITY_INTERMEDIATE,"CCD_Pixel_Stream_Post_Readout_Full_Frame:"
 			      "Saving to filename %s.",filename);
 #endif
-	exposure_start_time = CCD_Exposure_Get_Exposure_Start_Time(handle);
+	CCD_Timing_Phase_Start(CCD_TIMING_PHASE_SAVE);
 	if(!Pixel_Stream_Save(filename,Image_Data_List,Image_Data_Count,binned_ncols,binned_nrows,exposure_start_time))
 	{
+		CCD_Timing_Phase_End(CCD_TIMING_PHASE_SAVE);
 		for(i=0; i< Image_Data_Count; i++)
 			free(Image_Data_List[i]);
 		/* Pixel_Stream_Save can fail but still have saved the exposure_data to disk OK */
 		return FALSE;
 	}
+	CCD_Timing_Phase_End(CCD_TIMING_PHASE_SAVE);
+	/* produce the quick-look previews (if enabled) whilst the de-interlaced image is still in memory */
+	if(!CCD_Preview_Post_Readout(filename,Image_Data_List[0],binned_ncols,binned_nrows))
+	{
+#if LOGGING > 1
+		CCD_Global_Log_Format(LOG_VERBOSITY_TERSE,"CCD_Pixel_Stream_Post_Readout_Full_Frame:"
+				      "Preview failed (preview error %d), continuing.",
+				      CCD_Preview_Get_Error_Number());
+#endif
+	}
+	/* keep the de-interlaced image in memory for zero-copy viewing, this sets Image_Data_List[0] to NULL
+	** if it is retained (and will be freed by ccd_frame_view) */
+	CCD_Frame_View_Post_Readout(&(Image_Data_List[0]),binned_ncols,binned_nrows,CCD_Setup_Get_NSBin(handle),
+				    CCD_Setup_Get_NPBin(handle),0);
 	/* free allocated image data */
 	for(i=0; i< Image_Data_Count; i++)
 	{
@@ -496,7 +598,15 @@ int CCD_Pixel_Stream_Post_Readout_Full_Frame(CCD_Interface_Handle_T* handle,unsi
  *     (applying the necessary exposure data index offset) into it.
  * <li>We call Pixel_Stream_DeInterlace to de-interlace the sub-image.
  * <li>We check whether we should be aborting.
+ * <li>For the first active window, CCD_Source_Find_Post_Readout is called, which runs the source finder on
+ *     the sub-image if it is enabled. Object positions are relative to the window 
+ *     (and the window's bias strip is included in the search area).
+ * <li>For the first active window, CCD_Seeing_Post_Readout is called, which runs the seeing estimator on
+ *     the sub-image if it is enabled.
+ * <li>We publish the sub-image to the shared memory frame ring (if it is open), with CCD_Frame_Ring_Publish.
  * <li>We save the sub-image to the relevant filename.
+ * <li>For the first active window, CCD_Frame_View_Post_Readout is called, which keeps the sub-image in memory
+ *     (instead of it being freed) so it can be viewed without copying, if frame viewing is enabled.
  * <li>We increment the exposure data index offset by the number of pixels in the sub-image.
  * <li>We increment the filename index.
  * <li>We free the sub-image data.
@@ -519,6 +629,11 @@ int CCD_Pixel_Stream_Post_Readout_Full_Frame(CCD_Interface_Handle_T* handle,unsi
  * @see ccd_dsp.html#CCD_DSP_IS_DEINTERLACE_TYPE
  * @see ccd_dsp.html#CCD_DSP_Get_Abort
  * @see ccd_interface.html#CCD_Interface_Handle_T
+ * @see ccd_source_find.html#CCD_Source_Find_Post_Readout
+ * @see ccd_seeing.html#CCD_Seeing_Post_Readout
+ * @see ccd_frame_ring.html#CCD_Frame_Ring_Publish
+ * @see ccd_frame_view.html#CCD_Frame_View_Post_Readout
+ * @see ccd_frame_view.html#CCD_Frame_View_Raw_Set
  */
 int CCD_Pixel_Stream_Post_Readout_Window(CCD_Interface_Handle_T* handle,unsigned short *exposure_data,
 						char *filename_list[],int filename_count)
@@ -540,6 +655,8 @@ int CCD_Pixel_Stream_Post_Readout_Window(CCD_Interface_Handle_T* handle,unsigned
 #endif
 	Pixel_Stream_Byte_Swap(exposure_data,expected_pixel_count);
 #endif
+	/* make the raw readout buffer available for viewing */
+	CCD_Frame_View_Raw_Set(exposure_data,(size_t)CCD_Setup_Get_Readout_Pixel_Count(handle));
 	/* go through list of windows */
 	exposure_data_index = 0;
 	filename_index = 0;
@@ -577,7 +694,9 @@ int CCD_Pixel_Stream_Post_Readout_Window(CCD_Interface_Handle_T* handle,unsigned
 					"SubImage Data was NULL (%d,%d).",window_number,pixel_count);
 				return FALSE;
 			}
+			CCD_Timing_Phase_Start(CCD_TIMING_PHASE_DEINTERLACE);
 			memcpy(subimage_data,exposure_data+exposure_data_index,pixel_count*CCD_GLOBAL_BYTES_PER_PIXEL);
+			CCD_Timing_Phase_End(CCD_TIMING_PHASE_DEINTERLACE);
 #if LOGGING > 4
 			CCD_Global_Log(LOG_VERBOSITY_INTERMEDIATE,
 				       "CCD_Pixel_Stream_Post_Readout_Window:De-Interlacing.");
@@ -601,20 +720,59 @@ int CCD_Pixel_Stream_Post_Readout_Window(CCD_Interface_Handle_T* handle,unsigned
 				sprintf(Pixel_Stream_Error_String,"CCD_Pixel_Stream_Post_Readout_Window:Aborted.");
 				return FALSE;
 			}
+/* find the brightest object in the first window (if enabled) whilst the sub-image is still in memory */
+			if((filename_index == 0)&&(!CCD_Source_Find_Post_Readout(subimage_data,ncols,nrows)))
+			{
+#if LOGGING > 1
+				CCD_Global_Log_Format(LOG_VERBOSITY_TERSE,"CCD_Pixel_Stream_Post_Readout_Window:"
+						      "Source finder failed (source find error %d), continuing.",
+						      CCD_Source_Find_Get_Error_Number());
+#endif
+			}
+/* estimate the seeing in the first window (if enabled) whilst the sub-image is still in memory */
+			if((filename_index == 0)&&(!CCD_Seeing_Post_Readout(subimage_data,ncols,nrows)))
+			{
+#if LOGGING > 1
+				CCD_Global_Log_Format(LOG_VERBOSITY_TERSE,"CCD_Pixel_Stream_Post_Readout_Window:"
+						      "Seeing estimator failed (seeing error %d), continuing.",
+						      CCD_Seeing_Get_Error_Number());
+#endif
+			}
 /* save the resultant image to disk */
 #if LOGGING > 4
 			CCD_Global_Log_Format(LOG_VERBOSITY_INTERMEDIATE,"CCD_Pixel_Stream_Post_Readout_Window:"
 			      "Saving to filename %s.",filename_list[filename_index]);
 #endif
 			exposure_start_time = CCD_Exposure_Get_Exposure_Start_Time(handle);
+			if(!CCD_Frame_Ring_Publish(subimage_data,ncols,nrows,CCD_Setup_Get_NSBin(handle),
+						   CCD_Setup_Get_NPBin(handle),window_number+1,
+						   CCD_Exposure_Get_Exposure_Length(handle),exposure_start_time,
+						   filename_list[filename_index]))
+			{
+#if LOGGING > 1
+				CCD_Global_Log_Format(LOG_VERBOSITY_TERSE,"CCD_Pixel_Stream_Post_Readout_Window:"
+						      "Frame ring publish failed (frame ring error %d), continuing.",
+						      CCD_Frame_Ring_Get_Error_Number());
+#endif
+			}
 			subimage_data_list[0] = subimage_data;
+			CCD_Timing_Phase_Start(CCD_TIMING_PHASE_SAVE);
 			if(!Pixel_Stream_Save(filename_list[filename_index],subimage_data_list,1,ncols,nrows,
 					      exposure_start_time))
 			{
+				CCD_Timing_Phase_End(CCD_TIMING_PHASE_SAVE);
 				free(subimage_data);
 				/* Pixel_Stream_Save can fail but still have saved the exposure_data to disk OK */
 				return FALSE;
 			}
+			CCD_Timing_Phase_End(CCD_TIMING_PHASE_SAVE);
+			/* keep the first window in memory for zero-copy viewing, this sets subimage_data to NULL
+			** if it is retained (and will be freed by ccd_frame_view) */
+			if(filename_index == 0)
+			{
+				CCD_Frame_View_Post_Readout(&subimage_data,ncols,nrows,CCD_Setup_Get_NSBin(handle),
+							    CCD_Setup_Get_NPBin(handle),window_number+1);
+			}
 			/* increment index into exposure data to start of next window. */
 			exposure_data_index += pixel_count;
 			/* increment index iff this window is active - only active window filenames in filename_list */
@@ -1050,6 +1208,12 @@ static int Pixel_Stream_Entry_Get(enum CCD_DSP_AMPLIFIER amplifier,struct Pixel_
 /**
  * This routine takes some image data and saves it in a file on disc. It also updates the 
  * DATE-OBS FITS keyword to the value saved just before the SEX command was sent to the controller.
+ * If compression is configured (CCD_Compress_Get_Type), CCD_Compress_Save is first called to replace the
+ * file with tile-compressed images, and the keywords are then updated in the compressed primary image
+ * (HDU 2, the primary HDU of a compressed file is empty).
+ * If direct disc writing is enabled (CCD_Disk_Write_Get_Enable), the image is uncompressed, there is only one
+ * image and the file's primary image is unsigned short, the image data is not written through CFITSIO. Instead,
+ * after the keywords are updated and the file closed, CCD_Disk_Write_Save writes the data unit directly to disc.
  * @param filename The filename to save the data into.
  * @param exposure_data_list A list of allocated data memory to save.
  * @param exposure_data_count The number of image data areas in exposure_data_list.
@@ -1061,6 +1225,10 @@ static int Pixel_Stream_Entry_Get(enum CCD_DSP_AMPLIFIER amplifier,struct Pixel_
  * @see #Pixel_Stream_TimeSpec_To_Date_Obs_String
  * @see #Pixel_Stream_TimeSpec_To_UtStart_String
  * @see #Pixel_Stream_TimeSpec_To_Mjd
+ * @see ccd_compress.html#CCD_Compress_Get_Type
+ * @see ccd_compress.html#CCD_Compress_Save
+ * @see ccd_disk_write.html#CCD_Disk_Write_Get_Enable
+ * @see ccd_disk_write.html#CCD_Disk_Write_Save
  */
 static int Pixel_Stream_Save(char *filename,unsigned short *exposure_data_list[],int exposure_data_count,
 			     int ncols,int nrows,struct timespec start_time)
@@ -1071,10 +1239,26 @@ static int Pixel_Stream_Save(char *filename,unsigned short *exposure_data_list[]
 	long axes_list[2];
 	char exposure_start_time_string[64];
 	double mjd;
+	long long header_start,data_start,data_end;
+	int compressed = FALSE;
+	int direct = FALSE;
+	int image_type = 0;
 
 #if LOGGING > 4
 	CCD_Global_Log(LOG_VERBOSITY_INTERMEDIATE,"Pixel_Stream_Save:Started.");
 #endif
+	/* write tile-compressed image data, if configured */
+	if(CCD_Compress_Get_Type() != CCD_COMPRESS_TYPE_NONE)
+	{
+		if(!CCD_Compress_Save(filename,exposure_data_list,exposure_data_count,ncols,nrows))
+		{
+			Pixel_Stream_Error_Number = 34;
+			sprintf(Pixel_Stream_Error_String,"Pixel_Stream_Save: Compressed save failed(%s,%d).",filename,
+				CCD_Compress_Get_Error_Number());
+			return FALSE;
+		}
+		compressed = TRUE;
+	}
 	/* try to open file */
 	retval = fits_open_file(&fp,filename,READWRITE,&status);
 	if(retval)
@@ -1088,8 +1272,27 @@ static int Pixel_Stream_Save(char *filename,unsigned short *exposure_data_list[]
 	}
 	/* flip the data QUAD requires a flip in X, BOTHRIGHT requires a flip in Y (now corrected in DeInterlace) */
 	/*CCD_Pixel_Stream_Flip_X(ncols,nrows,exposure_data);*/
-	/* write the data */
-	retval = fits_write_img(fp,TUSHORT,1,ncols*nrows,exposure_data_list[0],&status);
+	/* the data can only be written directly to disc if it is the only image, and in the same format */
+	if((compressed == FALSE)&&(exposure_data_count == 1)&&CCD_Disk_Write_Get_Enable())
+	{
+		retval = fits_get_img_equivtype(fp,&image_type,&status);
+		if((retval == 0)&&(image_type == USHORT_IMG))
+			direct = TRUE;
+#if LOGGING > 4
+		else
+		{
+			CCD_Global_Log_Format(LOG_VERBOSITY_INTERMEDIATE,"Pixel_Stream_Save:%s has image type %d:"
+					      "Not writing direct to disc.",filename,image_type);
+		}
+#endif
+	}
+	/* write the data, move to the compressed primary image, or leave the data to CCD_Disk_Write_Save */
+	if(compressed)
+		retval = fits_movabs_hdu(fp,2,NULL,&status);
+	else if(direct)
+		retval = 0;
+	else
+		retval = fits_write_img(fp,TUSHORT,1,ncols*nrows,exposure_data_list[0],&status);
 	if(retval)
 	{
 		fits_get_errstatus(status,buff);
@@ -1154,8 +1357,23 @@ static int Pixel_Stream_Save(char *filename,unsigned short *exposure_data_list[]
 			filename,status,buff);
 		return FALSE;
 	}
-	/* write any extra image extensions needed */
-	for(i=1; i < exposure_data_count; i++)
+	/* get where the data unit starts, after any header space added by the keyword updates */
+	if(direct)
+	{
+		retval = fits_get_hduaddrll(fp,&header_start,&data_start,&data_end,&status);
+		if(retval)
+		{
+			fits_get_errstatus(status,buff);
+			fits_report_error(stderr,status);
+			fits_close_file(fp,&status);
+			Pixel_Stream_Error_Number = 35;
+			sprintf(Pixel_Stream_Error_String,"Pixel_Stream_Save:Getting data offset failed(%s,%d,%s).",
+				filename,status,buff);
+			return FALSE;
+		}
+	}
+	/* write any extra image extensions needed (already written if compressed) */
+	for(i=1; (compressed == FALSE) && (i < exposure_data_count); i++)
 	{
 		/* create a new HDU, with an image the same size as the primary one */
 		axes_list[0] = ncols;
@@ -1209,6 +1427,17 @@ static int Pixel_Stream_Save(char *filename,unsigned short *exposure_data_list[]
 			buff);
 		return FALSE;
 	}
+	/* write the image data directly to disc */
+	if(direct)
+	{
+		if(!CCD_Disk_Write_Save(filename,data_start,exposure_data_list[0],ncols,nrows))
+		{
+			Pixel_Stream_Error_Number = 36;
+			sprintf(Pixel_Stream_Error_String,"Pixel_Stream_Save:Direct disc write failed(%s,%d).",filename,
+				CCD_Disk_Write_Get_Error_Number());
+			return FALSE;
+		}
+	}
 #if LOGGING > 4
 	CCD_Global_Log(LOG_VERBOSITY_INTERMEDIATE,"Pixel_Stream_Save:Completed.");
 #endif
@@ -0,0 +1,664 @@
+/* ccd_preview.c
+** Quick-look preview image module.
+** $Header$
+*/
+/**
+ * ccd_preview holds the routines for producing small quick-look preview images of each full frame as it is
+ * read out, so the operators and the RCS can look at a frame without opening the 34Mb FITS file.
+ * <ul>
+ * <li>For each configured binning factor, the de-interlaced image is block-averaged. The rows of each block
+ *     are summed into a row buffer, and the row buffer is then summed across each block. Both loops are simple
+ *     enough for the compiler to vectorise. Partial blocks at the right and top edges are dropped.
+ * <li>The black and white levels are robust percentiles (by default 0.5% and 99.5%) of the pixel values
+ *     of the first (least binned) preview, found from a histogram. The same levels are used for every preview
+ *     of a frame.
+ * <li>Each preview is scaled to 8 bits, and saved as a BITPIX = 8 FITS image, either alongside the frame or
+ *     in a configured directory. The filename is the frame's with _p&lt;binning factor&gt; appended before the
+ *     extension.
+ * </ul>
+ * When previews are disabled CCD_Preview_Post_Readout returns immediately.
+ * @author Chris Mottram
+ * @version $Revision$
+ */
+/**
+ * This hash define is needed before including source files give us POSIX.4/IEEE1003.1b-1993 prototypes.
+ */
+#define _POSIX_SOURCE 1
+/**
+ * This hash define is needed before including source files give us POSIX.4/IEEE1003.1b-1993 prototypes.
+ */
+#define _POSIX_C_SOURCE 199309L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "log_udp.h"
+#include "ccd_global.h"
+#include "ccd_preview.h"
+#ifdef CFITSIO
+#include "fitsio.h"
+#endif
+
+/**
+ * Revision Control System identifier.
+ */
+static char rcsid[] = "$Id$";
+
+/* hash defines */
+/**
+ * The maximum length of the preview directory and preview filenames.
+ */
+#define PREVIEW_MAX_FILENAME_LENGTH	(256)
+/**
+ * The number of bins in the histogram used to find the black and white levels, one per unsigned short value.
+ */
+#define PREVIEW_HISTOGRAM_LENGTH	(65536)
+
+/* data types */
+/**
+ * Data type holding local data to ccd_preview. This consists of the following:
+ * <dl>
+ * <dt>Enable</dt> <dd>A boolean, whether previews are produced for each full frame.</dd>
+ * <dt>Directory</dt> <dd>The directory previews are saved into. If this is blank, they are saved in the
+ *     same directory as the frame.</dd>
+ * <dt>Bin_Factor_List</dt> <dd>The binning factor of each preview, in ascending order.</dd>
+ * <dt>Bin_Factor_Count</dt> <dd>The number of binning factors in Bin_Factor_List.</dd>
+ * <dt>Low_Percentile</dt> <dd>The percentile of preview pixels scaled to 0.</dd>
+ * <dt>High_Percentile</dt> <dd>The percentile of preview pixels scaled to 255.</dd>
+ * <dt>Histogram</dt> <dd>The histogram used to find the black and white levels, allocated on first use.</dd>
+ * </dl>
+ * @see #PREVIEW_MAX_FILENAME_LENGTH
+ * @see #PREVIEW_HISTOGRAM_LENGTH
+ * @see #CCD_PREVIEW_MAX_BIN_FACTOR_COUNT
+ */
+struct Preview_Struct
+{
+	int Enable;
+	char Directory[PREVIEW_MAX_FILENAME_LENGTH];
+	int Bin_Factor_List[CCD_PREVIEW_MAX_BIN_FACTOR_COUNT];
+	int Bin_Factor_Count;
+	double Low_Percentile;
+	double High_Percentile;
+	unsigned int *Histogram;
+};
+
+/* internal variables */
+/**
+ * Variable holding error code of last operation performed by ccd_preview.
+ */
+static int Preview_Error_Number = 0;
+/**
+ * Local variable holding description of the last error that occured.
+ */
+static char Preview_Error_String[CCD_GLOBAL_ERROR_STRING_LENGTH] = "";
+/**
+ * Local preview data.
+ * @see #Preview_Struct
+ */
+static struct Preview_Struct Preview_Data =
+{
+	FALSE,"",{8,32},2,CCD_PREVIEW_DEFAULT_LOW_PERCENTILE,CCD_PREVIEW_DEFAULT_HIGH_PERCENTILE,NULL
+};
+
+/* internal function definitions */
+static void Preview_Block_Average(unsigned short *image_data,int ncols,int bin_factor,
+				  unsigned int *row_sum,unsigned short *preview_data,int preview_ncols,
+				  int preview_nrows);
+static void Preview_Levels_Get(unsigned short *preview_data,size_t pixel_count,unsigned short *low_level,
+			       unsigned short *high_level);
+static void Preview_Scale(unsigned short *preview_data,size_t pixel_count,unsigned short low_level,
+			  unsigned short high_level,unsigned char *scaled_data);
+static int Preview_Filename_Get(char *filename,int bin_factor,char *preview_filename);
+static int Preview_Save(char *preview_filename,char *filename,unsigned char *scaled_data,int ncols,int nrows,
+			int bin_factor,unsigned short low_level,unsigned short high_level);
+
+/* -----------------------------------------------------------------------------
+**     external functions
+** ----------------------------------------------------------------------------- */
+/**
+ * This routine sets up ccd_preview internal variables. Previews are off by default.
+ * It should be called at startup.
+ * @return This routine returns TRUE for success.
+ * @see #Preview_Data
+ */
+int CCD_Preview_Initialise(void)
+{
+	Preview_Error_Number = 0;
+/* print some compile time information to stdout */
+	fprintf(stdout,"CCD_Preview_Initialise:%s.\n",rcsid);
+	Preview_Data.Enable = FALSE;
+	return TRUE;
+}
+
+/**
+ * Routine to configure the previews produced for subsequent full frames.
+ * @param enable A boolean, TRUE to produce previews, FALSE to not produce them.
+ * @param directory The directory to save previews into, or NULL (or a blank string) to save them alongside
+ *        the frame.
+ * @param bin_factor_list A list of binning factors, one preview is produced for each. Each factor must be
+ *        between 2 and CCD_PREVIEW_MAX_BIN_FACTOR, and the list must be in ascending order.
+ * @param bin_factor_count The number of binning factors in bin_factor_list, 1 to CCD_PREVIEW_MAX_BIN_FACTOR_COUNT.
+ * @param low_percentile The percentile of pixels scaled to black, greater than or equal to 0 and less than
+ *        high_percentile.
+ * @param high_percentile The percentile of pixels scaled to white, less than or equal to 100.
+ * @return The routine returns TRUE on success, and FALSE if an argument is out of range.
+ * @see #Preview_Data
+ * @see #PREVIEW_MAX_FILENAME_LENGTH
+ * @see #CCD_PREVIEW_MAX_BIN_FACTOR
+ * @see #CCD_PREVIEW_MAX_BIN_FACTOR_COUNT
+ */
+int CCD_Preview_Set_Config(int enable,char *directory,int *bin_factor_list,int bin_factor_count,
+			   double low_percentile,double high_percentile)
+{
+	int i;
+
+	Preview_Error_Number = 0;
+	if(!CCD_GLOBAL_IS_BOOLEAN(enable))
+	{
+		Preview_Error_Number = 1;
+		sprintf(Preview_Error_String,"CCD_Preview_Set_Config:Illegal enable %d.",enable);
+		return FALSE;
+	}
+	if((directory != NULL)&&(strlen(directory) >= (PREVIEW_MAX_FILENAME_LENGTH/2)))
+	{
+		Preview_Error_Number = 2;
+		sprintf(Preview_Error_String,"CCD_Preview_Set_Config:Directory too long (%lu).",
+			(unsigned long)strlen(directory));
+		return FALSE;
+	}
+	if((bin_factor_list == NULL)||(bin_factor_count < 1)||(bin_factor_count > CCD_PREVIEW_MAX_BIN_FACTOR_COUNT))
+	{
+		Preview_Error_Number = 3;
+		sprintf(Preview_Error_String,"CCD_Preview_Set_Config:Illegal bin factor count %d.",bin_factor_count);
+		return FALSE;
+	}
+	for(i = 0; i < bin_factor_count; i++)
+	{
+		if((bin_factor_list[i] < 2)||(bin_factor_list[i] > CCD_PREVIEW_MAX_BIN_FACTOR)||
+		   ((i > 0)&&(bin_factor_list[i] <= bin_factor_list[i-1])))
+		{
+			Preview_Error_Number = 4;
+			sprintf(Preview_Error_String,"CCD_Preview_Set_Config:Illegal bin factor %d at index %d.",
+				bin_factor_list[i],i);
+			return FALSE;
+		}
+	}
+	if((low_percentile < 0.0)||(high_percentile > 100.0)||(low_percentile >= high_percentile))
+	{
+		Preview_Error_Number = 5;
+		sprintf(Preview_Error_String,"CCD_Preview_Set_Config:Illegal percentiles %.2f,%.2f.",
+			low_percentile,high_percentile);
+		return FALSE;
+	}
+	Preview_Data.Enable = enable;
+	if(directory != NULL)
+		strcpy(Preview_Data.Directory,directory);
+	else
+		strcpy(Preview_Data.Directory,"");
+	for(i = 0; i < bin_factor_count; i++)
+		Preview_Data.Bin_Factor_List[i] = bin_factor_list[i];
+	Preview_Data.Bin_Factor_Count = bin_factor_count;
+	Preview_Data.Low_Percentile = low_percentile;
+	Preview_Data.High_Percentile = high_percentile;
+#if LOGGING > 4
+	CCD_Global_Log_Format(LOG_VERBOSITY_VERBOSE,"CCD_Preview_Set_Config:enable %d:directory '%s':"
+			      "%d bin factors starting at %d:percentiles %.2f,%.2f.",enable,Preview_Data.Directory,
+			      bin_factor_count,bin_factor_list[0],low_percentile,high_percentile);
+#endif
+	return TRUE;
+}
+
+/**
+ * Routine to get whether previews are produced.
+ * @return A boolean, TRUE if previews are produced for each full frame.
+ * @see #Preview_Data
+ */
+int CCD_Preview_Get_Enable(void)
+{
+	return Preview_Data.Enable;
+}
+
+/**
+ * Routine to produce the previews of a full frame, called from the pixel stream code once the frame has been
+ * de-interlaced and saved. If previews are not enabled, this routine returns immediately.
+ * <ul>
+ * <li>The histogram is allocated on first use, and a row sum buffer and preview buffers allocated.
+ * <li>Each preview is block averaged with Preview_Block_Average.
+ * <li>The black and white levels are found from the first preview with Preview_Levels_Get.
+ * <li>Each preview is scaled with Preview_Scale and saved with Preview_Save.
+ * </ul>
+ * @param filename The FITS filename of the frame.
+ * @param image_data The de-interlaced image data.
+ * @param ncols The number of columns in the image.
+ * @param nrows The number of rows in the image.
+ * @return The routine returns TRUE on success (or if previews are disabled), and FALSE if an error occurs.
+ * @see #Preview_Data
+ * @see #Preview_Block_Average
+ * @see #Preview_Levels_Get
+ * @see #Preview_Scale
+ * @see #Preview_Filename_Get
+ * @see #Preview_Save
+ */
+int CCD_Preview_Post_Readout(char *filename,unsigned short *image_data,int ncols,int nrows)
+{
+	struct timespec start_time,end_time;
+	unsigned short *preview_data_list[CCD_PREVIEW_MAX_BIN_FACTOR_COUNT];
+	unsigned int *row_sum = NULL;
+	unsigned char *scaled_data = NULL;
+	char preview_filename[PREVIEW_MAX_FILENAME_LENGTH];
+	unsigned short low_level,high_level;
+	int preview_ncols_list[CCD_PREVIEW_MAX_BIN_FACTOR_COUNT],preview_nrows_list[CCD_PREVIEW_MAX_BIN_FACTOR_COUNT];
+	int i,j,bin_factor,retval;
+
+	Preview_Error_Number = 0;
+	if(Preview_Data.Enable == FALSE)
+		return TRUE;
+	if(filename == NULL)
+	{
+		Preview_Error_Number = 6;
+		sprintf(Preview_Error_String,"CCD_Preview_Post_Readout:filename was NULL.");
+		return FALSE;
+	}
+	if(image_data == NULL)
+	{
+		Preview_Error_Number = 7;
+		sprintf(Preview_Error_String,"CCD_Preview_Post_Readout:image data was NULL.");
+		return FALSE;
+	}
+	if((ncols < Preview_Data.Bin_Factor_List[0])||(nrows < Preview_Data.Bin_Factor_List[0]))
+	{
+		Preview_Error_Number = 8;
+		sprintf(Preview_Error_String,"CCD_Preview_Post_Readout:Image (%d,%d) smaller than bin factor %d.",
+			ncols,nrows,Preview_Data.Bin_Factor_List[0]);
+		return FALSE;
+	}
+	clock_gettime(CLOCK_REALTIME,&start_time);
+	if(Preview_Data.Histogram == NULL)
+	{
+		Preview_Data.Histogram = (unsigned int *)malloc(PREVIEW_HISTOGRAM_LENGTH*sizeof(unsigned int));
+		if(Preview_Data.Histogram == NULL)
+		{
+			Preview_Error_Number = 9;
+			sprintf(Preview_Error_String,"CCD_Preview_Post_Readout:Failed to allocate histogram.");
+			return FALSE;
+		}
+	}
+	row_sum = (unsigned int *)malloc(ncols*sizeof(unsigned int));
+	/* the first preview is the largest, so scaled_data is big enough for all of them */
+	scaled_data = (unsigned char *)malloc((ncols/Preview_Data.Bin_Factor_List[0])*
+					      (nrows/Preview_Data.Bin_Factor_List[0])*sizeof(unsigned char));
+	if((row_sum == NULL)||(scaled_data == NULL))
+	{
+		if(row_sum != NULL)
+			free(row_sum);
+		if(scaled_data != NULL)
+			free(scaled_data);
+		Preview_Error_Number = 10;
+		sprintf(Preview_Error_String,"CCD_Preview_Post_Readout:Failed to allocate buffers (%d,%d).",ncols,nrows);
+		return FALSE;
+	}
+	for(i = 0; i < Preview_Data.Bin_Factor_Count; i++)
+		preview_data_list[i] = NULL;
+	/* block average each preview */
+	for(i = 0; i < Preview_Data.Bin_Factor_Count; i++)
+	{
+		bin_factor = Preview_Data.Bin_Factor_List[i];
+		preview_ncols_list[i] = ncols/bin_factor;
+		preview_nrows_list[i] = nrows/bin_factor;
+		if((preview_ncols_list[i] < 1)||(preview_nrows_list[i] < 1))
+			break;
+		preview_data_list[i] = (unsigned short *)malloc(preview_ncols_list[i]*preview_nrows_list[i]*
+								sizeof(unsigned short));
+		if(preview_data_list[i] == NULL)
+		{
+			for(j = 0; j < i; j++)
+				free(preview_data_list[j]);
+			free(row_sum);
+			free(scaled_data);
+			Preview_Error_Number = 11;
+			sprintf(Preview_Error_String,"CCD_Preview_Post_Readout:Failed to allocate preview %d (%d,%d).",
+				bin_factor,preview_ncols_list[i],preview_nrows_list[i]);
+			return FALSE;
+		}
+		Preview_Block_Average(image_data,ncols,bin_factor,row_sum,preview_data_list[i],
+				      preview_ncols_list[i],preview_nrows_list[i]);
+	}
+	free(row_sum);
+	/* find the black and white levels from the least binned preview */
+	Preview_Levels_Get(preview_data_list[0],((size_t)preview_ncols_list[0])*((size_t)preview_nrows_list[0]),
+			   &low_level,&high_level);
+	/* scale and save each preview */
+	retval = TRUE;
+	for(i = 0; (i < Preview_Data.Bin_Factor_Count)&&(preview_data_list[i] != NULL); i++)
+	{
+		bin_factor = Preview_Data.Bin_Factor_List[i];
+		Preview_Scale(preview_data_list[i],((size_t)preview_ncols_list[i])*((size_t)preview_nrows_list[i]),
+			      low_level,high_level,scaled_data);
+		if(retval)
+			retval = Preview_Filename_Get(filename,bin_factor,preview_filename);
+		if(retval)
+		{
+			retval = Preview_Save(preview_filename,filename,scaled_data,preview_ncols_list[i],
+					      preview_nrows_list[i],bin_factor,low_level,high_level);
+		}
+		free(preview_data_list[i]);
+		preview_data_list[i] = NULL;
+	}
+	free(scaled_data);
+	if(retval == FALSE)
+		return FALSE;
+	clock_gettime(CLOCK_REALTIME,&end_time);
+#if LOGGING > 4
+	CCD_Global_Log_Format(LOG_VERBOSITY_VERBOSE,"CCD_Preview_Post_Readout:Produced %d previews of %s "
+			      "(levels %hu,%hu) in %.3f seconds.",i,filename,low_level,high_level,
+			      fdifftime(end_time,start_time));
+#endif
+	return TRUE;
+}
+
+/**
+ * Get the current value of the error number.
+ * @return The current value of the error number.
+ */
+int CCD_Preview_Get_Error_Number(void)
+{
+	return Preview_Error_Number;
+}
+
+/**
+ * The error routine that reports any errors occuring in ccd_preview in a standard way.
+ * @see ccd_global.html#CCD_Global_Get_Current_Time_String
+ */
+void CCD_Preview_Error(void)
+{
+	char time_string[32];
+
+	CCD_Global_Get_Current_Time_String(time_string,32);
+	/* if the error number is zero an error message has not been set up
+	** This is in itself an error as we should not be calling this routine
+	** without there being an error to display */
+	if(Preview_Error_Number == 0)
+		sprintf(Preview_Error_String,"Logic Error:No Error defined");
+	fprintf(stderr,"%s CCD_Preview:Error(%d) : %s\n",time_string,Preview_Error_Number,Preview_Error_String);
+}
+
+/**
+ * The error routine that reports any errors occuring in ccd_preview in a standard way. This routine places the
+ * generated error string at the end of a passed in string argument.
+ * @param error_string A string to put the generated error in. This string should be initialised before
+ * being passed to this routine. The routine will try to concatenate it's error string onto the end
+ * of any string already in existance.
+ * @see ccd_global.html#CCD_Global_Get_Current_Time_String
+ */
+void CCD_Preview_Error_String(char *error_string)
+{
+	char time_string[32];
+
+	CCD_Global_Get_Current_Time_String(time_string,32);
+	/* if the error number is zero an error message has not been set up
+	** This is in itself an error as we should not be calling this routine
+	** without there being an error to display */
+	if(Preview_Error_Number == 0)
+		sprintf(Preview_Error_String,"Logic Error:No Error defined");
+	sprintf(error_string+strlen(error_string),"%s CCD_Preview:Error(%d) : %s\n",time_string,
+		Preview_Error_Number,Preview_Error_String);
+}
+
+/* -----------------------------------------------------------------------------
+**     internal functions
+** ----------------------------------------------------------------------------- */
+/**
+ * Block average an image. For each row of blocks, the image rows in the block are summed into row_sum,
+ * then each block's columns in row_sum are summed and divided by the number of pixels in the block.
+ * A 256x256 block of 65535 pixels fits in an unsigned int sum.
+ * @param image_data The image data.
+ * @param ncols The number of columns in the image.
+ * @param bin_factor The binning factor (block size).
+ * @param row_sum A buffer of at least preview_ncols*bin_factor unsigned ints.
+ * @param preview_data The buffer to put the block averaged image in.
+ * @param preview_ncols The number of columns in the preview, ncols/bin_factor.
+ * @param preview_nrows The number of rows in the preview, nrows/bin_factor.
+ */
+static void Preview_Block_Average(unsigned short *image_data,int ncols,int bin_factor,
+				  unsigned int *row_sum,unsigned short *preview_data,int preview_ncols,
+				  int preview_nrows)
+{
+	unsigned short *image_row = NULL;
+	unsigned int block_sum,block_pixel_count;
+	int sum_ncols,preview_x,preview_y,x,y;
+
+	sum_ncols = preview_ncols*bin_factor;
+	block_pixel_count = (unsigned int)(bin_factor*bin_factor);
+	for(preview_y = 0; preview_y < preview_nrows; preview_y++)
+	{
+		memset(row_sum,0,sum_ncols*sizeof(unsigned int));
+		for(y = preview_y*bin_factor; y < (preview_y+1)*bin_factor; y++)
+		{
+			image_row = image_data+(((size_t)y)*((size_t)ncols));
+			for(x = 0; x < sum_ncols; x++)
+				row_sum[x] += image_row[x];
+		}
+		for(preview_x = 0; preview_x < preview_ncols; preview_x++)
+		{
+			block_sum = 0;
+			for(x = preview_x*bin_factor; x < (preview_x+1)*bin_factor; x++)
+				block_sum += row_sum[x];
+			preview_data[(preview_y*preview_ncols)+preview_x] = (unsigned short)((block_sum+(block_pixel_count/2))/
+										     block_pixel_count);
+		}
+	}
+}
+
+/**
+ * Find the black and white levels of a preview, the configured low and high percentiles of it's pixel values.
+ * @param preview_data The block averaged preview.
+ * @param pixel_count The number of pixels in the preview.
+ * @param low_level The address of an unsigned short to store the black level in.
+ * @param high_level The address of an unsigned short to store the white level in. This is always greater than
+ *        the black level.
+ * @see #Preview_Data
+ * @see #PREVIEW_HISTOGRAM_LENGTH
+ */
+static void Preview_Levels_Get(unsigned short *preview_data,size_t pixel_count,unsigned short *low_level,
+			       unsigned short *high_level)
+{
+	size_t low_count,high_count,cumulative_count,i;
+	int value;
+
+	memset(Preview_Data.Histogram,0,PREVIEW_HISTOGRAM_LENGTH*sizeof(unsigned int));
+	for(i = 0; i < pixel_count; i++)
+		Preview_Data.Histogram[preview_data[i]]++;
+	low_count = (size_t)((Preview_Data.Low_Percentile*((double)pixel_count))/100.0);
+	high_count = (size_t)((Preview_Data.High_Percentile*((double)pixel_count))/100.0);
+	cumulative_count = 0;
+	(*low_level) = 0;
+	(*high_level) = PREVIEW_HISTOGRAM_LENGTH-1;
+	for(value = 0; value < PREVIEW_HISTOGRAM_LENGTH; value++)
+	{
+		cumulative_count += Preview_Data.Histogram[value];
+		if(cumulative_count > low_count)
+		{
+			(*low_level) = (unsigned short)value;
+			break;
+		}
+	}
+	for(; value < PREVIEW_HISTOGRAM_LENGTH; value++)
+	{
+		if(cumulative_count >= high_count)
+		{
+			(*high_level) = (unsigned short)value;
+			break;
+		}
+		if(value+1 < PREVIEW_HISTOGRAM_LENGTH)
+			cumulative_count += Preview_Data.Histogram[value+1];
+	}
+	/* a flat image (e.g. a bias) would otherwise divide by zero when scaled */
+	if((*high_level) <= (*low_level))
+	{
+		if((*low_level) < PREVIEW_HISTOGRAM_LENGTH-1)
+			(*high_level) = (*low_level)+1;
+		else
+			(*low_level) = (*high_level)-1;
+	}
+}
+
+/**
+ * Scale a preview to 8 bits. Pixels at or below the black level become 0, pixels at or above the white
+ * level become 255, and pixels in between are scaled linearly.
+ * @param preview_data The block averaged preview.
+ * @param pixel_count The number of pixels in the preview.
+ * @param low_level The black level.
+ * @param high_level The white level, greater than low_level.
+ * @param scaled_data A buffer of at least pixel_count bytes to put the scaled preview in.
+ */
+static void Preview_Scale(unsigned short *preview_data,size_t pixel_count,unsigned short low_level,
+			  unsigned short high_level,unsigned char *scaled_data)
+{
+	float scale,value;
+	size_t i;
+
+	scale = 255.0f/((float)(high_level-low_level));
+	for(i = 0; i < pixel_count; i++)
+	{
+		value = ((float)preview_data[i]-(float)low_level)*scale;
+		if(value < 0.0f)
+			value = 0.0f;
+		if(value > 255.0f)
+			value = 255.0f;
+		scaled_data[i] = (unsigned char)(value+0.5f);
+	}
+}
+
+/**
+ * Work out the filename of a preview. This is the frame's filename, with _p&lt;bin_factor&gt; inserted before
+ * the extension. If a preview directory is configured, the frame's directory is replaced by it.
+ * @param filename The frame's FITS filename.
+ * @param bin_factor The preview's binning factor.
+ * @param preview_filename A string of at least PREVIEW_MAX_FILENAME_LENGTH characters to put the filename in.
+ * @return The routine returns TRUE on success, and FALSE if the filename is too long.
+ * @see #Preview_Data
+ * @see #PREVIEW_MAX_FILENAME_LENGTH
+ */
+static int Preview_Filename_Get(char *filename,int bin_factor,char *preview_filename)
+{
+	char *base_ptr = NULL;
+	char *extension_ptr = NULL;
+	size_t base_length;
+
+	base_ptr = filename;
+	if(strlen(Preview_Data.Directory) > 0)
+	{
+		base_ptr = strrchr(filename,'/');
+		if(base_ptr != NULL)
+			base_ptr++;
+		else
+			base_ptr = filename;
+	}
+	extension_ptr = strrchr(base_ptr,'.');
+	if(extension_ptr != NULL)
+		base_length = extension_ptr-base_ptr;
+	else
+		base_length = strlen(base_ptr);
+	/* directory, '/', base, "_pNNN", extension */
+	if((strlen(Preview_Data.Directory)+1+strlen(base_ptr)+5) >= PREVIEW_MAX_FILENAME_LENGTH)
+	{
+		Preview_Error_Number = 12;
+		sprintf(Preview_Error_String,"Preview_Filename_Get:filename too long (%lu).",
+			(unsigned long)strlen(filename));
+		return FALSE;
+	}
+	if(strlen(Preview_Data.Directory) > 0)
+		sprintf(preview_filename,"%s/",Preview_Data.Directory);
+	else
+		strcpy(preview_filename,"");
+	strncat(preview_filename,base_ptr,base_length);
+	sprintf(preview_filename+strlen(preview_filename),"_p%d",bin_factor);
+	if(extension_ptr != NULL)
+		strcat(preview_filename,extension_ptr);
+	return TRUE;
+}
+
+/**
+ * Save a scaled preview as a BITPIX = 8 FITS image, overwriting any existing file. The PREVBIN, PREVLO, PREVHI
+ * and ORIGFILE keywords record the binning factor, black and white levels and the frame's filename.
+ * @param preview_filename The filename to save the preview in.
+ * @param filename The frame's FITS filename.
+ * @param scaled_data The scaled preview.
+ * @param ncols The number of columns in the preview.
+ * @param nrows The number of rows in the preview.
+ * @param bin_factor The preview's binning factor.
+ * @param low_level The black level.
+ * @param high_level The white level.
+ * @return The routine returns TRUE on success, and FALSE if an error occurs.
+ * @see #PREVIEW_MAX_FILENAME_LENGTH
+ */
+static int Preview_Save(char *preview_filename,char *filename,unsigned char *scaled_data,int ncols,int nrows,
+			int bin_factor,unsigned short low_level,unsigned short high_level)
+{
+#ifdef CFITSIO
+	fitsfile *fp = NULL;
+	char create_filename[PREVIEW_MAX_FILENAME_LENGTH+1];
+	char buff[32]; /* fits_get_errstatus returns 30 chars max */
+	long axes_list[2];
+	int retval,status=0,ivalue;
+
+	/* a leading '!' tells CFITSIO to overwrite any existing file */
+	sprintf(create_filename,"!%s",preview_filename);
+	axes_list[0] = ncols;
+	axes_list[1] = nrows;
+	retval = fits_create_file(&fp,create_filename,&status);
+	if(retval == 0)
+		retval = fits_create_img(fp,BYTE_IMG,2,axes_list,&status);
+	if(retval == 0)
+	{
+		retval = fits_write_img(fp,TBYTE,1,ncols*nrows,scaled_data,&status);
+	}
+	if(retval == 0)
+	{
+		ivalue = bin_factor;
+		retval = fits_update_key(fp,TINT,"PREVBIN",&ivalue,"Preview binning factor",&status);
+	}
+	if(retval == 0)
+	{
+		ivalue = low_level;
+		retval = fits_update_key(fp,TINT,"PREVLO",&ivalue,"Frame value scaled to 0",&status);
+	}
+	if(retval == 0)
+	{
+		ivalue = high_level;
+		retval = fits_update_key(fp,TINT,"PREVHI",&ivalue,"Frame value scaled to 255",&status);
+	}
+	if(retval == 0)
+		retval = fits_update_key(fp,TSTRING,"ORIGFILE",filename,"Frame filename",&status);
+	if(retval)
+	{
+		fits_get_errstatus(status,buff);
+		fits_report_error(stderr,status);
+		Preview_Error_Number = 13;
+		sprintf(Preview_Error_String,"Preview_Save:Writing %s failed(%d,%s).",preview_filename,status,buff);
+		status = 0;
+		if(fp != NULL)
+			fits_close_file(fp,&status);
+		remove(preview_filename);
+		return FALSE;
+	}
+	retval = fits_close_file(fp,&status);
+	if(retval)
+	{
+		fits_get_errstatus(status,buff);
+		fits_report_error(stderr,status);
+		Preview_Error_Number = 14;
+		sprintf(Preview_Error_String,"Preview_Save:File close failed(%s,%d,%s).",preview_filename,status,buff);
+		return FALSE;
+	}
+	return TRUE;
+#else
+	Preview_Error_Number = 15;
+	sprintf(Preview_Error_String,"Preview_Save:Library not compiled with CFITSIO.");
+	return FALSE;
+#endif
+}
+
+/*
+** $Log: not supported by cvs2svn $
+*/
@@ -0,0 +1,618 @@
+/* ccd_readout_watchdog.c
+** Readout progress-rate watchdog module.
+** $Header$
+*/
+/**
+ * ccd_readout_watchdog watches the readout progress polled by CCD_Exposure_Expose, to detect a stalled
+ * readout quickly, and records readout rate anomalies for the telemetry log.
+ * <ul>
+ * <li>A history is kept for each readout setup (binned dimensions, binning, amplifier, gain, gain speed and
+ *     windows): the pixel rate and the longest gap between readout progress changes, each an exponentially
+ *     weighted average over the successful readouts of that setup.
+ * <li>Once the first pixel of a readout of a known setup has arrived, the readout is considered stalled
+ *     if the progress does not change for Stall_Factor times the learnt progress gap (or the poll period,
+ *     if longer), with a minimum of Min_Stall_Time. Before the first pixel, or for an unknown setup,
+ *     Unknown_Stall_Time is used, which defaults to the old fixed readout timeout.
+ * <li>A stalled readout is recorded as a STALL anomaly. A completed readout whose pixel rate is less than
+ *     Slow_Ratio of the learnt rate is recorded as a SLOW anomaly. The telemetry sampler polls the
+ *     last anomaly and adds it to the telemetry store.
+ * </ul>
+ * @author Chris Mottram
+ * @version $Revision$
+ */
+/**
+ * This hash define is needed before including source files give us POSIX.4/IEEE1003.1b-1993 prototypes.
+ */
+#define _POSIX_SOURCE 1
+/**
+ * This hash define is needed before including source files give us POSIX.4/IEEE1003.1b-1993 prototypes.
+ */
+#define _POSIX_C_SOURCE 199309L
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "log_udp.h"
+#include "ccd_global.h"
+#include "ccd_readout_watchdog.h"
+
+/**
+ * Revision Control System identifier.
+ */
+static char rcsid[] = "$Id$";
+
+/* hash defines */
+/**
+ * The weight given to each new readout when updating a setup's learnt pixel rate and progress gap.
+ */
+#define READOUT_WATCHDOG_HISTORY_WEIGHT	(0.25)
+/**
+ * The longest poll period that can be configured, in milliseconds. CCD_Exposure_Expose's readout remaining time
+ * assumes it polls at least once a second.
+ */
+#define READOUT_WATCHDOG_MAX_POLL_PERIOD_MS	(1000)
+
+/* data types */
+/**
+ * Data type holding the readout history of one readout setup.
+ * <dl>
+ * <dt>In_Use</dt> <dd>A boolean, whether this setup has been used.</dd>
+ * <dt>NCols</dt> <dd>The number of binned columns.</dd>
+ * <dt>NRows</dt> <dd>The number of binned rows.</dd>
+ * <dt>X_Bin</dt> <dd>The serial binning.</dd>
+ * <dt>Y_Bin</dt> <dd>The parallel binning.</dd>
+ * <dt>Amplifier</dt> <dd>The amplifier (an enum CCD_DSP_AMPLIFIER value).</dd>
+ * <dt>Gain</dt> <dd>The gain (an enum CCD_DSP_GAIN value).</dd>
+ * <dt>Gain_Speed</dt> <dd>A boolean, whether the video integrators are 'fast'.</dd>
+ * <dt>Window_Flags</dt> <dd>Which windows are read out.</dd>
+ * <dt>Expected_Pixel_Count</dt> <dd>The number of pixels read out.</dd>
+ * <dt>Last_Use</dt> <dd>The value of Readout_Watchdog_Data.Use_Count the setup was last used at.</dd>
+ * <dt>Readout_Count</dt> <dd>The number of successful readouts the history has been learnt from.</dd>
+ * <dt>Pixel_Rate</dt> <dd>The learnt pixel rate, in pixels per second.</dd>
+ * <dt>Progress_Gap</dt> <dd>The learnt longest gap between readout progress changes, in seconds.</dd>
+ * </dl>
+ */
+struct Readout_Watchdog_Config_Struct
+{
+	int In_Use;
+	int NCols;
+	int NRows;
+	int X_Bin;
+	int Y_Bin;
+	int Amplifier;
+	int Gain;
+	int Gain_Speed;
+	int Window_Flags;
+	int Expected_Pixel_Count;
+	unsigned int Last_Use;
+	unsigned int Readout_Count;
+	double Pixel_Rate;
+	double Progress_Gap;
+};
+
+/**
+ * Data type holding the progress of the readout being watched.
+ * <dl>
+ * <dt>Active</dt> <dd>A boolean, whether a readout is being watched.</dd>
+ * <dt>Config_Index</dt> <dd>The index in Readout_Watchdog_Data.Config_List of the readout's setup.</dd>
+ * <dt>Expected_Pixel_Count</dt> <dd>The number of pixels to be read out.</dd>
+ * <dt>Sample_Count</dt> <dd>The number of progress values sampled.</dd>
+ * <dt>First_Pixel_Time</dt> <dd>When a non-zero progress value was first sampled.</dd>
+ * <dt>First_Pixel_Count</dt> <dd>The first non-zero progress value sampled, or zero if no pixels have arrived.</dd>
+ * <dt>Last_Change_Time</dt> <dd>When the progress value last changed.</dd>
+ * <dt>Last_Pixel_Count</dt> <dd>The last progress value sampled.</dd>
+ * <dt>Max_Progress_Gap</dt> <dd>The longest gap between progress changes, once pixels were arriving,
+ *     in seconds.</dd>
+ * </dl>
+ */
+struct Readout_Watchdog_Readout_Struct
+{
+	int Active;
+	int Config_Index;
+	int Expected_Pixel_Count;
+	int Sample_Count;
+	struct timespec First_Pixel_Time;
+	int First_Pixel_Count;
+	struct timespec Last_Change_Time;
+	int Last_Pixel_Count;
+	double Max_Progress_Gap;
+};
+
+/**
+ * Data type holding local data to ccd_readout_watchdog.
+ * <dl>
+ * <dt>Poll_Period</dt> <dd>How long CCD_Exposure_Expose sleeps between readout progress polls, in milliseconds.</dd>
+ * <dt>Stall_Factor</dt> <dd>How many learnt progress gaps without progress is a stall.</dd>
+ * <dt>Min_Stall_Time</dt> <dd>The shortest stall time for a known setup, in milliseconds.</dd>
+ * <dt>Unknown_Stall_Time</dt> <dd>The stall time for an unknown setup, or before the first pixel,
+ *     in milliseconds.</dd>
+ * <dt>Slow_Ratio</dt> <dd>A readout slower than this fraction of the learnt pixel rate is anomalous.</dd>
+ * <dt>Config_List</dt> <dd>The history of each readout setup.</dd>
+ * <dt>Use_Count</dt> <dd>Incremented each time a readout starts, to find the least recently used setup.</dd>
+ * <dt>Readout</dt> <dd>The progress of the readout being watched.</dd>
+ * <dt>Anomaly</dt> <dd>The last anomaly recorded.</dd>
+ * <dt>Mutex</dt> <dd>Protects Anomaly, which is read by the telemetry thread.</dd>
+ * </dl>
+ * @see #Readout_Watchdog_Config_Struct
+ * @see #Readout_Watchdog_Readout_Struct
+ * @see #CCD_READOUT_WATCHDOG_MAX_CONFIG_COUNT
+ */
+struct Readout_Watchdog_Struct
+{
+	int Poll_Period;
+	double Stall_Factor;
+	int Min_Stall_Time;
+	int Unknown_Stall_Time;
+	double Slow_Ratio;
+	struct Readout_Watchdog_Config_Struct Config_List[CCD_READOUT_WATCHDOG_MAX_CONFIG_COUNT];
+	unsigned int Use_Count;
+	struct Readout_Watchdog_Readout_Struct Readout;
+	struct CCD_Readout_Watchdog_Anomaly_Struct Anomaly;
+	pthread_mutex_t Mutex;
+};
+
+/* internal variables */
+/**
+ * Variable holding error code of last operation performed by ccd_readout_watchdog.
+ */
+static int Readout_Watchdog_Error_Number = 0;
+/**
+ * Local variable holding description of the last error that occured.
+ */
+static char Readout_Watchdog_Error_String[CCD_GLOBAL_ERROR_STRING_LENGTH] = "";
+/**
+ * Local watchdog data.
+ * @see #Readout_Watchdog_Struct
+ */
+static struct Readout_Watchdog_Struct Readout_Watchdog_Data =
+{
+	CCD_READOUT_WATCHDOG_DEFAULT_POLL_PERIOD_MS,CCD_READOUT_WATCHDOG_DEFAULT_STALL_FACTOR,
+	CCD_READOUT_WATCHDOG_DEFAULT_MIN_STALL_TIME_MS,CCD_READOUT_WATCHDOG_DEFAULT_UNKNOWN_STALL_TIME_MS,
+	CCD_READOUT_WATCHDOG_DEFAULT_SLOW_RATIO,{{0}},0,{0},{0},PTHREAD_MUTEX_INITIALIZER
+};
+
+/* internal function definitions */
+static double Readout_Watchdog_Stall_Time_Get(void);
+static double Readout_Watchdog_Pixel_Rate_Get(void);
+static void Readout_Watchdog_Anomaly_Record(int type,double pixel_rate,double expected_pixel_rate,double stall_time);
+
+/* -----------------------------------------------------------------------------
+**     external functions
+** ----------------------------------------------------------------------------- */
+/**
+ * This routine sets up ccd_readout_watchdog internal variables, forgetting the readout history.
+ * It should be called at startup.
+ * @return This routine returns TRUE for success.
+ * @see #Readout_Watchdog_Data
+ */
+int CCD_Readout_Watchdog_Initialise(void)
+{
+	Readout_Watchdog_Error_Number = 0;
+/* print some compile time information to stdout */
+	fprintf(stdout,"CCD_Readout_Watchdog_Initialise:%s.\n",rcsid);
+	memset(Readout_Watchdog_Data.Config_List,0,sizeof(Readout_Watchdog_Data.Config_List));
+	Readout_Watchdog_Data.Use_Count = 0;
+	Readout_Watchdog_Data.Readout.Active = FALSE;
+	return TRUE;
+}
+
+/**
+ * Routine to configure the watchdog.
+ * @param poll_period_ms How long CCD_Exposure_Expose sleeps between readout progress polls, in milliseconds.
+ *        This must be between 1 and READOUT_WATCHDOG_MAX_POLL_PERIOD_MS.
+ * @param stall_factor How many learnt progress gaps without progress is a stall. This must be at least 1.0.
+ * @param min_stall_time_ms The shortest stall time for a known setup, in milliseconds.
+ * @param unknown_stall_time_ms The stall time for an unknown setup, or before the first pixel has arrived,
+ *        in milliseconds.
+ * @param slow_ratio A completed readout slower than this fraction of the learnt pixel rate is recorded
+ *        as a SLOW anomaly. This must be between 0.0 (never) and 1.0.
+ * @return The routine returns TRUE if the configuration was legal, and FALSE if it was not.
+ * @see #Readout_Watchdog_Data
+ * @see #READOUT_WATCHDOG_MAX_POLL_PERIOD_MS
+ */
+int CCD_Readout_Watchdog_Set_Config(int poll_period_ms,double stall_factor,int min_stall_time_ms,
+				    int unknown_stall_time_ms,double slow_ratio)
+{
+	Readout_Watchdog_Error_Number = 0;
+	if((poll_period_ms < 1)||(poll_period_ms > READOUT_WATCHDOG_MAX_POLL_PERIOD_MS))
+	{
+		Readout_Watchdog_Error_Number = 1;
+		sprintf(Readout_Watchdog_Error_String,"CCD_Readout_Watchdog_Set_Config:Illegal poll period %d ms.",
+			poll_period_ms);
+		return FALSE;
+	}
+	if(stall_factor < 1.0)
+	{
+		Readout_Watchdog_Error_Number = 2;
+		sprintf(Readout_Watchdog_Error_String,"CCD_Readout_Watchdog_Set_Config:Illegal stall factor %.3f.",
+			stall_factor);
+		return FALSE;
+	}
+	if(min_stall_time_ms < 1)
+	{
+		Readout_Watchdog_Error_Number = 3;
+		sprintf(Readout_Watchdog_Error_String,"CCD_Readout_Watchdog_Set_Config:"
+			"Illegal minimum stall time %d ms.",min_stall_time_ms);
+		return FALSE;
+	}
+	if(unknown_stall_time_ms < min_stall_time_ms)
+	{
+		Readout_Watchdog_Error_Number = 4;
+		sprintf(Readout_Watchdog_Error_String,"CCD_Readout_Watchdog_Set_Config:"
+			"Unknown setup stall time %d ms less than minimum stall time %d ms.",
+			unknown_stall_time_ms,min_stall_time_ms);
+		return FALSE;
+	}
+	if((slow_ratio < 0.0)||(slow_ratio > 1.0))
+	{
+		Readout_Watchdog_Error_Number = 5;
+		sprintf(Readout_Watchdog_Error_String,"CCD_Readout_Watchdog_Set_Config:Illegal slow ratio %.3f.",
+			slow_ratio);
+		return FALSE;
+	}
+	Readout_Watchdog_Data.Poll_Period = poll_period_ms;
+	Readout_Watchdog_Data.Stall_Factor = stall_factor;
+	Readout_Watchdog_Data.Min_Stall_Time = min_stall_time_ms;
+	Readout_Watchdog_Data.Unknown_Stall_Time = unknown_stall_time_ms;
+	Readout_Watchdog_Data.Slow_Ratio = slow_ratio;
+#if LOGGING > 4
+	CCD_Global_Log_Format(LOG_VERBOSITY_VERBOSE,"CCD_Readout_Watchdog_Set_Config:Poll period %d ms:"
+			      "Stall factor %.2f:Minimum stall time %d ms:Unknown stall time %d ms:Slow ratio %.2f.",
+			      poll_period_ms,stall_factor,min_stall_time_ms,unknown_stall_time_ms,slow_ratio);
+#endif
+	return TRUE;
+}
+
+/**
+ * Routine to get how long CCD_Exposure_Expose should sleep between readout progress polls.
+ * @return The poll period, in milliseconds.
+ * @see #Readout_Watchdog_Data
+ */
+int CCD_Readout_Watchdog_Poll_Period_Get(void)
+{
+	return Readout_Watchdog_Data.Poll_Period;
+}
+
+/**
+ * Routine called at the start of an exposure, before the readout. The readout setup is looked up (or a new, or
+ * the least recently used, setup is (re)used), and the readout progress cleared.
+ * @param ncols The number of binned columns.
+ * @param nrows The number of binned rows.
+ * @param x_bin The serial binning.
+ * @param y_bin The parallel binning.
+ * @param amplifier The amplifier being read out.
+ * @param gain The gain.
+ * @param gain_speed A boolean, whether the video integrators are 'fast'.
+ * @param window_flags Which windows are being read out.
+ * @param expected_pixel_count The number of pixels to be read out.
+ * @see #Readout_Watchdog_Data
+ */
+void CCD_Readout_Watchdog_Start(int ncols,int nrows,int x_bin,int y_bin,int amplifier,int gain,
+				int gain_speed,int window_flags,int expected_pixel_count)
+{
+	struct Readout_Watchdog_Config_Struct *config = NULL;
+	struct Readout_Watchdog_Readout_Struct *readout = &(Readout_Watchdog_Data.Readout);
+	int config_index,i;
+
+	Readout_Watchdog_Data.Use_Count++;
+	config_index = -1;
+	for(i = 0; i < CCD_READOUT_WATCHDOG_MAX_CONFIG_COUNT; i++)
+	{
+		config = &(Readout_Watchdog_Data.Config_List[i]);
+		if(config->In_Use && (config->NCols == ncols)&&(config->NRows == nrows)&&(config->X_Bin == x_bin)&&
+		   (config->Y_Bin == y_bin)&&(config->Amplifier == amplifier)&&(config->Gain == gain)&&
+		   (config->Gain_Speed == gain_speed)&&(config->Window_Flags == window_flags)&&
+		   (config->Expected_Pixel_Count == expected_pixel_count))
+		{
+			config_index = i;
+			break;
+		}
+	}
+	/* a new setup: use an unused entry, or reset the least recently used one */
+	if(config_index == -1)
+	{
+		config_index = 0;
+		for(i = 0; i < CCD_READOUT_WATCHDOG_MAX_CONFIG_COUNT; i++)
+		{
+			config = &(Readout_Watchdog_Data.Config_List[i]);
+			if(config->In_Use == FALSE)
+			{
+				config_index = i;
+				break;
+			}
+			if(config->Last_Use < Readout_Watchdog_Data.Config_List[config_index].Last_Use)
+				config_index = i;
+		}
+		config = &(Readout_Watchdog_Data.Config_List[config_index]);
+		memset(config,0,sizeof(struct Readout_Watchdog_Config_Struct));
+		config->In_Use = TRUE;
+		config->NCols = ncols;
+		config->NRows = nrows;
+		config->X_Bin = x_bin;
+		config->Y_Bin = y_bin;
+		config->Amplifier = amplifier;
+		config->Gain = gain;
+		config->Gain_Speed = gain_speed;
+		config->Window_Flags = window_flags;
+		config->Expected_Pixel_Count = expected_pixel_count;
+	}
+	Readout_Watchdog_Data.Config_List[config_index].Last_Use = Readout_Watchdog_Data.Use_Count;
+	readout->Config_Index = config_index;
+	readout->Expected_Pixel_Count = expected_pixel_count;
+	readout->Sample_Count = 0;
+	readout->First_Pixel_Count = 0;
+	readout->Last_Pixel_Count = 0;
+	readout->Max_Progress_Gap = 0.0;
+	readout->Active = TRUE;
+#if LOGGING > 9
+	config = &(Readout_Watchdog_Data.Config_List[config_index]);
+	CCD_Global_Log_Format(LOG_VERBOSITY_VERY_VERBOSE,"CCD_Readout_Watchdog_Start:Setup %d:%d readouts:"
+			      "Pixel rate %.1f pixels/s:Progress gap %.3f s.",config_index,config->Readout_Count,
+			      config->Pixel_Rate,config->Progress_Gap);
+#endif
+}
+
+/**
+ * Routine called with each readout progress value polled once the readout has started. If the progress has
+ * changed, the gap since the last change is measured. If it has not changed for longer than the stall time,
+ * the readout has stalled: a STALL anomaly is recorded and FALSE returned, so the caller can abort the readout.
+ * This does nothing if no readout is being watched, or all the pixels have been read out.
+ * @param pixel_count The number of pixels read out so far.
+ * @return The routine returns TRUE if the readout is progressing, and FALSE if it has stalled.
+ * @see #Readout_Watchdog_Data
+ * @see #Readout_Watchdog_Stall_Time_Get
+ * @see #Readout_Watchdog_Pixel_Rate_Get
+ * @see #Readout_Watchdog_Anomaly_Record
+ */
+int CCD_Readout_Watchdog_Progress(int pixel_count)
+{
+	struct Readout_Watchdog_Readout_Struct *readout = &(Readout_Watchdog_Data.Readout);
+	struct timespec current_time;
+	double gap,stall_time;
+
+	Readout_Watchdog_Error_Number = 0;
+	if((readout->Active == FALSE)||(pixel_count >= readout->Expected_Pixel_Count))
+		return TRUE;
+	clock_gettime(CLOCK_MONOTONIC,&current_time);
+	if((readout->Sample_Count == 0)||(pixel_count != readout->Last_Pixel_Count))
+	{
+		/* only gaps whilst pixels are arriving are learnt, not the delay before the first pixel */
+		if((readout->Sample_Count > 0)&&(readout->Last_Pixel_Count > 0))
+		{
+			gap = fdifftime(current_time,readout->Last_Change_Time);
+			if(gap > readout->Max_Progress_Gap)
+				readout->Max_Progress_Gap = gap;
+		}
+		if((pixel_count > 0)&&(readout->First_Pixel_Count == 0))
+		{
+			readout->First_Pixel_Time = current_time;
+			readout->First_Pixel_Count = pixel_count;
+		}
+		readout->Last_Change_Time = current_time;
+		readout->Last_Pixel_Count = pixel_count;
+		readout->Sample_Count++;
+		return TRUE;
+	}
+	readout->Sample_Count++;
+	gap = fdifftime(current_time,readout->Last_Change_Time);
+	stall_time = Readout_Watchdog_Stall_Time_Get();
+	if(gap < stall_time)
+		return TRUE;
+	Readout_Watchdog_Anomaly_Record(CCD_READOUT_WATCHDOG_ANOMALY_STALL,Readout_Watchdog_Pixel_Rate_Get(),
+		     Readout_Watchdog_Data.Config_List[readout->Config_Index].Pixel_Rate,gap);
+	readout->Active = FALSE;
+	Readout_Watchdog_Error_Number = 6;
+	sprintf(Readout_Watchdog_Error_String,"CCD_Readout_Watchdog_Progress:Readout stalled at %d of %d pixels:"
+		"No progress for %.3f s (stall time %.3f s).",pixel_count,readout->Expected_Pixel_Count,gap,stall_time);
+	return FALSE;
+}
+
+/**
+ * Routine called when a readout completes successfully. The readout's pixel rate is compared with the rate
+ * learnt for it's setup, and a SLOW anomaly recorded if it is less than Slow_Ratio of it. The readout's pixel
+ * rate and longest progress gap are then added to the setup's history. A longer progress gap than the learnt one
+ * replaces it, so the stall time grows immediately but only shrinks gradually. Readouts whose rate could
+ * not be measured (they were seen in progress at less than two samples) are not added.
+ * This does nothing if no readout is being watched.
+ * @see #Readout_Watchdog_Data
+ * @see #Readout_Watchdog_Pixel_Rate_Get
+ * @see #Readout_Watchdog_Anomaly_Record
+ * @see #READOUT_WATCHDOG_HISTORY_WEIGHT
+ */
+void CCD_Readout_Watchdog_End(void)
+{
+	struct Readout_Watchdog_Config_Struct *config = NULL;
+	struct Readout_Watchdog_Readout_Struct *readout = &(Readout_Watchdog_Data.Readout);
+	double pixel_rate;
+
+	if(readout->Active == FALSE)
+		return;
+	readout->Active = FALSE;
+	/* the last progress value sampled will be the expected pixel count, which Progress ignores */
+	pixel_rate = Readout_Watchdog_Pixel_Rate_Get();
+	if(pixel_rate <= 0.0)
+		return;
+	config = &(Readout_Watchdog_Data.Config_List[readout->Config_Index]);
+	if((config->Readout_Count > 0)&&(pixel_rate < (Readout_Watchdog_Data.Slow_Ratio*config->Pixel_Rate)))
+	{
+		Readout_Watchdog_Anomaly_Record(CCD_READOUT_WATCHDOG_ANOMALY_SLOW,pixel_rate,config->Pixel_Rate,0.0);
+	}
+	if(config->Readout_Count == 0)
+	{
+		config->Pixel_Rate = pixel_rate;
+		config->Progress_Gap = readout->Max_Progress_Gap;
+	}
+	else
+	{
+		config->Pixel_Rate += READOUT_WATCHDOG_HISTORY_WEIGHT*(pixel_rate-config->Pixel_Rate);
+		if(readout->Max_Progress_Gap > config->Progress_Gap)
+			config->Progress_Gap = readout->Max_Progress_Gap;
+		else
+		{
+			config->Progress_Gap += READOUT_WATCHDOG_HISTORY_WEIGHT*
+				(readout->Max_Progress_Gap-config->Progress_Gap);
+		}
+	}
+	config->Readout_Count++;
+#if LOGGING > 4
+	CCD_Global_Log_Format(LOG_VERBOSITY_VERBOSE,"CCD_Readout_Watchdog_End:Setup %d:Readout %.1f pixels/s:"
+			      "Longest progress gap %.3f s:Learnt %.1f pixels/s:Learnt progress gap %.3f s.",
+			      readout->Config_Index,pixel_rate,readout->Max_Progress_Gap,config->Pixel_Rate,
+			      config->Progress_Gap);
+#endif
+}
+
+/**
+ * Routine to get the last readout rate anomaly recorded. The telemetry sampler calls this every poll,
+ * and compares the anomaly's Count with the last one it saw.
+ * @param anomaly The address of a structure to fill in with the last anomaly. If no anomaly has been recorded
+ *        it's Count is zero and it's Type is CCD_READOUT_WATCHDOG_ANOMALY_NONE.
+ * @return The routine returns TRUE if the anomaly was returned, and FALSE if anomaly was NULL.
+ * @see #Readout_Watchdog_Data
+ */
+int CCD_Readout_Watchdog_Anomaly_Get(struct CCD_Readout_Watchdog_Anomaly_Struct *anomaly)
+{
+	Readout_Watchdog_Error_Number = 0;
+	if(anomaly == NULL)
+	{
+		Readout_Watchdog_Error_Number = 7;
+		sprintf(Readout_Watchdog_Error_String,"CCD_Readout_Watchdog_Anomaly_Get:anomaly was NULL.");
+		return FALSE;
+	}
+	pthread_mutex_lock(&(Readout_Watchdog_Data.Mutex));
+	(*anomaly) = Readout_Watchdog_Data.Anomaly;
+	pthread_mutex_unlock(&(Readout_Watchdog_Data.Mutex));
+	return TRUE;
+}
+
+/**
+ * Get the current value of the error number.
+ * @return The current value of the error number.
+ * @see #Readout_Watchdog_Error_Number
+ */
+int CCD_Readout_Watchdog_Get_Error_Number(void)
+{
+	return Readout_Watchdog_Error_Number;
+}
+
+/**
+ * The error routine that reports any errors occuring in ccd_readout_watchdog in a standard way.
+ * @see ccd_global.html#CCD_Global_Get_Current_Time_String
+ * @see #Readout_Watchdog_Error_Number
+ * @see #Readout_Watchdog_Error_String
+ */
+void CCD_Readout_Watchdog_Error(void)
+{
+	char time_string[32];
+
+	CCD_Global_Get_Current_Time_String(time_string,32);
+	/* if the error number is zero an error message has not been set up
+	** This is in itself an error as we should not be calling this routine
+	** without there being an error to display */
+	if(Readout_Watchdog_Error_Number == 0)
+		sprintf(Readout_Watchdog_Error_String,"Logic Error:No Error defined");
+	fprintf(stderr,"%s CCD_Readout_Watchdog:Error(%d) : %s\n",time_string,Readout_Watchdog_Error_Number,
+		Readout_Watchdog_Error_String);
+}
+
+/**
+ * The error routine that reports any errors occuring in ccd_readout_watchdog in a standard way. This routine
+ * places the generated error string at the end of a passed in string argument.
+ * @param error_string A string to put the generated error in. This string should be initialised before
+ * 	being passed to this routine. The routine will try to concatenate it's error string onto the end
+ * 	of any string already in existance.
+ * @see ccd_global.html#CCD_Global_Get_Current_Time_String
+ */
+void CCD_Readout_Watchdog_Error_String(char *error_string)
+{
+	char time_string[32];
+
+	CCD_Global_Get_Current_Time_String(time_string,32);
+	/* if the error number is zero an error message has not been set up
+	** This is in itself an error as we should not be calling this routine
+	** without there being an error to display */
+	if(Readout_Watchdog_Error_Number == 0)
+		sprintf(Readout_Watchdog_Error_String,"Logic Error:No Error defined");
+	sprintf(error_string+strlen(error_string),"%s CCD_Readout_Watchdog:Error(%d) : %s\n",time_string,
+		Readout_Watchdog_Error_Number,Readout_Watchdog_Error_String);
+}
+
+/* -----------------------------------------------------------------------------
+** 	internal functions
+** ----------------------------------------------------------------------------- */
+/**
+ * Get how long the readout being watched can make no progress for before it has stalled. Once pixels
+ * are arriving for a setup with history, this is Stall_Factor times the learnt progress gap or the poll period,
+ * whichever is longer, but at least Min_Stall_Time. Otherwise it is Unknown_Stall_Time.
+ * @return The stall time, in seconds.
+ * @see #Readout_Watchdog_Data
+ */
+static double Readout_Watchdog_Stall_Time_Get(void)
+{
+	struct Readout_Watchdog_Config_Struct *config = NULL;
+	double stall_time,gap;
+
+	config = &(Readout_Watchdog_Data.Config_List[Readout_Watchdog_Data.Readout.Config_Index]);
+	if((Readout_Watchdog_Data.Readout.First_Pixel_Count == 0)||(config->Readout_Count == 0))
+		return ((double)Readout_Watchdog_Data.Unknown_Stall_Time)/1000.0;
+	gap = config->Progress_Gap;
+	if(gap < (((double)Readout_Watchdog_Data.Poll_Period)/1000.0))
+		gap = ((double)Readout_Watchdog_Data.Poll_Period)/1000.0;
+	stall_time = Readout_Watchdog_Data.Stall_Factor*gap;
+	if(stall_time < (((double)Readout_Watchdog_Data.Min_Stall_Time)/1000.0))
+		stall_time = ((double)Readout_Watchdog_Data.Min_Stall_Time)/1000.0;
+	return stall_time;
+}
+
+/**
+ * Get the pixel rate of the readout being watched, between the first non-zero progress value and the last change.
+ * @return The pixel rate in pixels per second, or 0.0 if the readout has not been seen in progress at two
+ *         samples.
+ * @see #Readout_Watchdog_Data
+ */
+static double Readout_Watchdog_Pixel_Rate_Get(void)
+{
+	struct Readout_Watchdog_Readout_Struct *readout = &(Readout_Watchdog_Data.Readout);
+	double duration;
+
+	if((readout->First_Pixel_Count == 0)||(readout->Last_Pixel_Count <= readout->First_Pixel_Count))
+		return 0.0;
+	duration = fdifftime(readout->Last_Change_Time,readout->First_Pixel_Time);
+	if(duration <= 0.0)
+		return 0.0;
+	return ((double)(readout->Last_Pixel_Count-readout->First_Pixel_Count))/duration;
+}
+
+/**
+ * Record an anomaly for the readout being watched, for the telemetry sampler to pick up.
+ * @param type The anomaly type, one of CCD_READOUT_WATCHDOG_ANOMALY_*.
+ * @param pixel_rate The readout's measured pixel rate, in pixels per second.
+ * @param expected_pixel_rate The pixel rate learnt for the readout's setup, in pixels per second.
+ * @param stall_time How long the readout made no progress for, in seconds.
+ * @see #Readout_Watchdog_Data
+ */
+static void Readout_Watchdog_Anomaly_Record(int type,double pixel_rate,double expected_pixel_rate,double stall_time)
+{
+	struct CCD_Readout_Watchdog_Anomaly_Struct *anomaly = &(Readout_Watchdog_Data.Anomaly);
+
+	pthread_mutex_lock(&(Readout_Watchdog_Data.Mutex));
+	anomaly->Count++;
+	clock_gettime(CLOCK_REALTIME,&(anomaly->Time));
+	anomaly->Type = type;
+	anomaly->Pixel_Rate = pixel_rate;
+	anomaly->Expected_Pixel_Rate = expected_pixel_rate;
+	anomaly->Pixel_Count = Readout_Watchdog_Data.Readout.Last_Pixel_Count;
+	anomaly->Expected_Pixel_Count = Readout_Watchdog_Data.Readout.Expected_Pixel_Count;
+	anomaly->Stall_Time = stall_time;
+	pthread_mutex_unlock(&(Readout_Watchdog_Data.Mutex));
+#if LOGGING > 0
+	CCD_Global_Log_Format(LOG_VERBOSITY_TERSE,"Readout_Watchdog_Anomaly_Record:%s readout:%d of %d pixels:"
+			      "%.1f pixels/s (expected %.1f pixels/s):Stall time %.3f s.",
+			      (type == CCD_READOUT_WATCHDOG_ANOMALY_STALL) ? "Stalled" : "Slow",anomaly->Pixel_Count,
+			      anomaly->Expected_Pixel_Count,pixel_rate,expected_pixel_rate,stall_time);
+#endif
+}
+
+/*
+** $Log: not supported by cvs2svn $
+*/
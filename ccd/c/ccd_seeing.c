@@ -0,0 +1,1223 @@
+/* ccd_seeing.c
+** Seeing (FWHM) estimator module.
+** $Header$
+*/
+/**
+ * ccd_seeing holds the routines for estimating the seeing of a de-interlaced frame, whilst it is still in memory
+ * after readout. It is used by TELFOCUS to measure each frame's seeing without saving the frame and sending it
+ * to the real time data pipeline.
+ * <ul>
+ * <li>The background and it's standard deviation are estimated using CCD_Source_Find_Background_Get.
+ * <li>The frame is split into row bands, and each band is searched in a separate thread for candidate sources:
+ *     local maxima more than Threshold_Sigma standard deviations above the background, whose direct
+ *     neighbours are bright enough for them not to be hot pixels or cosmic rays.
+ * <li>The candidates are sorted by peak value, and the brightest Max_Source_Count candidates with no brighter
+ *     candidate within their cutout are selected.
+ * <li>The selected candidates are measured across the threads. Candidates with a saturated pixel in their cutout
+ *     are rejected. The second order moments of each cutout give a moment-based FWHM and ellipticity,
+ *     which are then used as the starting point of a Levenberg-Marquardt 2D (elliptical) Gaussian fit.
+ *     If the fit converges it's FWHM and ellipticity are used, otherwise the moment-based ones are.
+ * <li>The median FWHM and ellipticity of the measured sources are returned.
+ * </ul>
+ * @author Chris Mottram
+ * @version $Revision$
+ */
+/**
+ * This hash define is needed before including source files give us POSIX.4/IEEE1003.1b-1993 prototypes.
+ */
+#define _POSIX_SOURCE 1
+/**
+ * This hash define is needed before including source files give us POSIX.4/IEEE1003.1b-1993 prototypes.
+ */
+#define _POSIX_C_SOURCE 199309L
+#include <errno.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "log_udp.h"
+#include "ccd_global.h"
+#include "ccd_source_find.h"
+#include "ccd_seeing.h"
+
+/**
+ * Revision Control System identifier.
+ */
+static char rcsid[] = "$Id$";
+
+/* hash defines */
+/**
+ * Conversion factor from a Gaussian's standard deviation to it's FWHM (2 sqrt(2 ln 2)).
+ */
+#define SEEING_SIGMA_TO_FWHM			(2.35482)
+/**
+ * Conversion factor from median absolute deviation to standard deviation, for a normal distribution.
+ */
+#define SEEING_MAD_TO_SIGMA			(1.4826)
+/**
+ * The mean of a candidate's four direct neighbours (above the background) must be at least this fraction
+ * of the candidate's peak (above the background). This rejects hot pixels and most cosmic ray hits.
+ */
+#define SEEING_MIN_NEIGHBOUR_RATIO		(0.2)
+/**
+ * The smallest FWHM a source can have, in binned pixels, to be measured.
+ */
+#define SEEING_MIN_FWHM				(1.0)
+/**
+ * The initial number of candidates allocated per row band. The candidate list grows as required.
+ */
+#define SEEING_INITIAL_CANDIDATE_COUNT		(256)
+/**
+ * The number of parameters in the 2D Gaussian fit: background, amplitude, x centre, y centre, and the
+ * three coefficients of the quadratic form a.dx^2 + 2b.dx.dy + c.dy^2.
+ */
+#define SEEING_FIT_PARAMETER_COUNT		(7)
+/**
+ * The maximum number of Levenberg-Marquardt iterations attempted for each source.
+ */
+#define SEEING_FIT_MAX_ITERATION_COUNT		(30)
+/**
+ * The fit has converged when an iteration reduces the chi squared by less than this fraction.
+ */
+#define SEEING_FIT_CONVERGED_FRACTION		(1.0e-6)
+/**
+ * The Levenberg-Marquardt damping factor the fit starts with.
+ */
+#define SEEING_FIT_START_LAMBDA			(0.001)
+/**
+ * If the Levenberg-Marquardt damping factor grows above this, no step reduces the chi squared and
+ * the fit has converged (or stalled).
+ */
+#define SEEING_FIT_MAX_LAMBDA			(1.0e10)
+/**
+ * The maximum distance, in binned pixels, the fitted centre can move from the candidate's peak pixel.
+ */
+#define SEEING_FIT_MAX_CENTRE_SHIFT		(2.0)
+
+/* data types */
+/**
+ * Data type holding local data to ccd_seeing. This consists of the following:
+ * <dl>
+ * <dt>Threshold_Sigma</dt> <dd>How many background standard deviations above the background a pixel must be
+ *     to be a candidate source's peak.</dd>
+ * <dt>Cutout_Radius</dt> <dd>The radius of the square cutout measured around each source, in binned pixels.</dd>
+ * <dt>Saturation_Counts</dt> <dd>A cutout with a pixel at or above this value is saturated.</dd>
+ * <dt>Max_Source_Count</dt> <dd>The maximum number of sources measured in each frame.</dd>
+ * <dt>Thread_Count</dt> <dd>The number of threads to split the frame across.</dd>
+ * <dt>Enable</dt> <dd>A boolean, whether CCD_Seeing_Post_Readout runs the seeing estimator.</dd>
+ * <dt>Last_Result_Valid</dt> <dd>A boolean, whether Last_Result holds the result for the last frame read out
+ *     since the seeing estimator was enabled.</dd>
+ * <dt>Last_Result</dt> <dd>The result of running the seeing estimator on the last frame read out.</dd>
+ * </dl>
+ * @see #CCD_Seeing_Result_Struct
+ */
+struct Seeing_Struct
+{
+	double Threshold_Sigma;
+	int Cutout_Radius;
+	int Saturation_Counts;
+	int Max_Source_Count;
+	int Thread_Count;
+	int Enable;
+	int Last_Result_Valid;
+	struct CCD_Seeing_Result_Struct Last_Result;
+};
+
+/**
+ * Data type holding one candidate source.
+ * <dl>
+ * <dt>X</dt> <dd>The (zero based) column of the candidate's peak pixel.</dd>
+ * <dt>Y</dt> <dd>The (zero based) row of the candidate's peak pixel.</dd>
+ * <dt>Peak</dt> <dd>The value of the candidate's peak pixel.</dd>
+ * <dt>Is_Measured</dt> <dd>A boolean, TRUE if the candidate was successfully measured.</dd>
+ * <dt>Is_Fitted</dt> <dd>A boolean, TRUE if the candidate's 2D Gaussian fit converged.</dd>
+ * <dt>Moment_FWHM</dt> <dd>The moment-based FWHM, in binned pixels.</dd>
+ * <dt>FWHM</dt> <dd>The fitted FWHM (or the moment-based FWHM if the fit failed), in binned pixels.</dd>
+ * <dt>Ellipticity</dt> <dd>The fitted ellipticity (or the moment-based ellipticity if the fit failed).</dd>
+ * </dl>
+ */
+struct Seeing_Candidate_Struct
+{
+	int X;
+	int Y;
+	int Peak;
+	int Is_Measured;
+	int Is_Fitted;
+	double Moment_FWHM;
+	double FWHM;
+	double Ellipticity;
+};
+
+/**
+ * Data type holding the data for one seeing estimator thread. In the search phase, each thread searches a band
+ * of rows for candidates. In the measure phase, each thread measures every Thread_Count'th selected candidate,
+ * starting at Thread_Index.
+ * <dl>
+ * <dt>Image_Data</dt> <dd>The frame.</dd>
+ * <dt>NCols</dt> <dd>The number of columns in the frame.</dd>
+ * <dt>NRows</dt> <dd>The number of rows in the frame.</dd>
+ * <dt>Start_Row</dt> <dd>The first row in the band searched.</dd>
+ * <dt>End_Row</dt> <dd>One more than the last row in the band searched.</dd>
+ * <dt>Background</dt> <dd>The background level.</dd>
+ * <dt>Threshold</dt> <dd>Candidate peaks are above this value.</dd>
+ * <dt>Candidate_List</dt> <dd>In the search phase, the candidates found in this band. In the measure phase,
+ *     the list of selected candidates shared by all the threads.</dd>
+ * <dt>Candidate_Count</dt> <dd>The number of candidates in Candidate_List.</dd>
+ * <dt>Candidate_Allocated_Count</dt> <dd>The number of candidates allocated in Candidate_List
+ *     (search phase only).</dd>
+ * <dt>Thread_Index</dt> <dd>The index of this thread (measure phase only).</dd>
+ * <dt>Thread_Count</dt> <dd>The number of threads (measure phase only).</dd>
+ * <dt>Thread</dt> <dd>The thread.</dd>
+ * <dt>Thread_Started</dt> <dd>A boolean, whether Thread was successfully started.</dd>
+ * <dt>Success</dt> <dd>A boolean, whether the thread succeeded.</dd>
+ * </dl>
+ */
+struct Seeing_Thread_Struct
+{
+	unsigned short *Image_Data;
+	int NCols;
+	int NRows;
+	int Start_Row;
+	int End_Row;
+	double Background;
+	int Threshold;
+	struct Seeing_Candidate_Struct *Candidate_List;
+	int Candidate_Count;
+	int Candidate_Allocated_Count;
+	int Thread_Index;
+	int Thread_Count;
+	pthread_t Thread;
+	int Thread_Started;
+	int Success;
+};
+
+/* internal variables */
+/**
+ * Variable holding error code of last operation performed by ccd_seeing.
+ */
+static int Seeing_Error_Number = 0;
+/**
+ * Local variable holding description of the last error that occured.
+ */
+static char Seeing_Error_String[CCD_GLOBAL_ERROR_STRING_LENGTH] = "";
+/**
+ * Local seeing estimator data.
+ * @see #Seeing_Struct
+ */
+static struct Seeing_Struct Seeing_Data;
+
+/* internal function definitions */
+static void Seeing_Threads_Run(struct Seeing_Thread_Struct *thread_list,int thread_count,
+			       void *(*thread_routine)(void *));
+static void *Seeing_Search_Thread(void *user_arg);
+static void *Seeing_Measure_Thread(void *user_arg);
+static int Seeing_Candidate_Select(struct Seeing_Candidate_Struct *candidate_list,int candidate_count,int ncols,
+				   int nrows);
+static int Seeing_Candidate_Peak_Compare(const void *p1,const void *p2);
+static double Seeing_Median(double *value_list,int value_count);
+static void Seeing_Measure(unsigned short *image_data,int ncols,double background,
+			   struct Seeing_Candidate_Struct *candidate);
+static int Seeing_Gaussian_Fit(unsigned short *image_data,int ncols,int x_peak,int y_peak,
+			       double parameter_list[SEEING_FIT_PARAMETER_COUNT]);
+static double Seeing_Gaussian_Chi_Squared(unsigned short *image_data,int ncols,int x_peak,int y_peak,
+					  double parameter_list[SEEING_FIT_PARAMETER_COUNT]);
+static int Seeing_Linear_Solve(double matrix[SEEING_FIT_PARAMETER_COUNT][SEEING_FIT_PARAMETER_COUNT],
+			       double vector[SEEING_FIT_PARAMETER_COUNT]);
+
+/* -----------------------------------------------------------------------------
+**     external functions
+** ----------------------------------------------------------------------------- */
+/**
+ * This routine sets up ccd_seeing internal variables.
+ * It should be called at startup.
+ * @return This routine returns TRUE for success.
+ * @see #Seeing_Data
+ */
+int CCD_Seeing_Initialise(void)
+{
+	Seeing_Error_Number = 0;
+/* print some compile time information to stdout */
+	fprintf(stdout,"CCD_Seeing_Initialise:%s.\n",rcsid);
+	memset(&Seeing_Data,0,sizeof(Seeing_Data));
+	Seeing_Data.Threshold_Sigma = CCD_SEEING_DEFAULT_THRESHOLD_SIGMA;
+	Seeing_Data.Cutout_Radius = CCD_SEEING_DEFAULT_CUTOUT_RADIUS;
+	Seeing_Data.Saturation_Counts = CCD_SEEING_DEFAULT_SATURATION_COUNTS;
+	Seeing_Data.Max_Source_Count = CCD_SEEING_DEFAULT_MAX_SOURCE_COUNT;
+	Seeing_Data.Thread_Count = CCD_SEEING_DEFAULT_THREAD_COUNT;
+	Seeing_Data.Enable = FALSE;
+	Seeing_Data.Last_Result_Valid = FALSE;
+	return TRUE;
+}
+
+/**
+ * Routine to configure the seeing estimator.
+ * @param threshold_sigma How many background standard deviations above the background a pixel must be
+ *        to be a candidate source's peak. Must be greater than zero.
+ * @param cutout_radius The radius of the square cutout measured around each source, in binned pixels,
+ *        from 2 to CCD_SEEING_MAX_CUTOUT_RADIUS. It should be at least twice the largest expected FWHM.
+ * @param saturation_counts A source with a pixel at or above this value in it's cutout is not measured.
+ *        Must be greater than zero.
+ * @param max_source_count The maximum number of sources measured in each frame. Must be at least one.
+ * @param thread_count The number of threads to split the frame across, from 1 to CCD_SEEING_MAX_THREAD_COUNT.
+ * @return The routine returns TRUE on success, and FALSE if an argument is out of range.
+ * @see #Seeing_Data
+ * @see #CCD_SEEING_MAX_CUTOUT_RADIUS
+ * @see #CCD_SEEING_MAX_THREAD_COUNT
+ */
+int CCD_Seeing_Set_Config(double threshold_sigma,int cutout_radius,int saturation_counts,
+			  int max_source_count,int thread_count)
+{
+	Seeing_Error_Number = 0;
+	if(threshold_sigma <= 0.0)
+	{
+		Seeing_Error_Number = 1;
+		sprintf(Seeing_Error_String,"CCD_Seeing_Set_Config:Illegal threshold sigma %.2f.",threshold_sigma);
+		return FALSE;
+	}
+	if((cutout_radius < 2)||(cutout_radius > CCD_SEEING_MAX_CUTOUT_RADIUS))
+	{
+		Seeing_Error_Number = 2;
+		sprintf(Seeing_Error_String,"CCD_Seeing_Set_Config:Illegal cutout radius %d (2..%d).",
+			cutout_radius,CCD_SEEING_MAX_CUTOUT_RADIUS);
+		return FALSE;
+	}
+	if(saturation_counts < 1)
+	{
+		Seeing_Error_Number = 3;
+		sprintf(Seeing_Error_String,"CCD_Seeing_Set_Config:Illegal saturation counts %d.",saturation_counts);
+		return FALSE;
+	}
+	if(max_source_count < 1)
+	{
+		Seeing_Error_Number = 4;
+		sprintf(Seeing_Error_String,"CCD_Seeing_Set_Config:Illegal maximum source count %d.",
+			max_source_count);
+		return FALSE;
+	}
+	if((thread_count < 1)||(thread_count > CCD_SEEING_MAX_THREAD_COUNT))
+	{
+		Seeing_Error_Number = 5;
+		sprintf(Seeing_Error_String,"CCD_Seeing_Set_Config:Illegal thread count %d (1..%d).",
+			thread_count,CCD_SEEING_MAX_THREAD_COUNT);
+		return FALSE;
+	}
+	Seeing_Data.Threshold_Sigma = threshold_sigma;
+	Seeing_Data.Cutout_Radius = cutout_radius;
+	Seeing_Data.Saturation_Counts = saturation_counts;
+	Seeing_Data.Max_Source_Count = max_source_count;
+	Seeing_Data.Thread_Count = thread_count;
+#if LOGGING > 4
+	CCD_Global_Log_Format(LOG_VERBOSITY_VERBOSE,"CCD_Seeing_Set_Config:threshold sigma %.2f:cutout radius %d:"
+			      "saturation counts %d:maximum source count %d:thread count %d.",threshold_sigma,
+			      cutout_radius,saturation_counts,max_source_count,thread_count);
+#endif
+	return TRUE;
+}
+
+/**
+ * Routine to enable or disable running the seeing estimator on each frame after readout.
+ * Enabling the seeing estimator invalidates the last result.
+ * @param enable A boolean, TRUE to run the seeing estimator on subsequent frames, FALSE to stop.
+ * @return The routine returns TRUE on success, and FALSE if enable was not a boolean.
+ * @see #Seeing_Data
+ * @see #CCD_Seeing_Post_Readout
+ */
+int CCD_Seeing_Set_Enable(int enable)
+{
+	Seeing_Error_Number = 0;
+	if(!CCD_GLOBAL_IS_BOOLEAN(enable))
+	{
+		Seeing_Error_Number = 6;
+		sprintf(Seeing_Error_String,"CCD_Seeing_Set_Enable:Illegal enable %d.",enable);
+		return FALSE;
+	}
+	if(enable)
+		Seeing_Data.Last_Result_Valid = FALSE;
+	Seeing_Data.Enable = enable;
+	return TRUE;
+}
+
+/**
+ * Routine to return whether the seeing estimator is run on each frame after readout.
+ * @return A boolean, TRUE if the seeing estimator is enabled.
+ * @see #Seeing_Data
+ */
+int CCD_Seeing_Get_Enable(void)
+{
+	return Seeing_Data.Enable;
+}
+
+/**
+ * Routine to estimate the seeing of a frame.
+ * <ul>
+ * <li>The background is estimated using CCD_Source_Find_Background_Get.
+ * <li>The frame is split into row bands, and each band is searched for candidates in a separate thread
+ *     (Seeing_Search_Thread). If a thread cannot be started, the band is searched in this thread instead.
+ * <li>The band candidate lists are concatenated, and the brightest isolated candidates are selected
+ *     (Seeing_Candidate_Select).
+ * <li>The selected candidates are measured across the threads (Seeing_Measure_Thread).
+ * <li>The medians of the measured sources' FWHMs and ellipticities are computed.
+ * </ul>
+ * If no sources could be measured, the routine still succeeds, with a Source_Count of zero.
+ * @param image_data The frame, ncols by nrows unsigned shorts, row 0 first.
+ * @param ncols The number of columns in the frame.
+ * @param nrows The number of rows in the frame.
+ * @param result The address of a structure to fill in with the results.
+ * @return The routine returns TRUE on success, and FALSE if an error occurs.
+ * @see #Seeing_Data
+ * @see #Seeing_Threads_Run
+ * @see #Seeing_Search_Thread
+ * @see #Seeing_Candidate_Select
+ * @see #Seeing_Measure_Thread
+ * @see #Seeing_Median
+ * @see #SEEING_MAD_TO_SIGMA
+ * @see ccd_source_find.html#CCD_Source_Find_Background_Get
+ * @see ccd_global.html#fdifftime
+ */
+int CCD_Seeing_Measure(unsigned short *image_data,int ncols,int nrows,struct CCD_Seeing_Result_Struct *result)
+{
+	struct Seeing_Thread_Struct thread_list[CCD_SEEING_MAX_THREAD_COUNT];
+	struct Seeing_Candidate_Struct *candidate_list = NULL;
+	struct timespec start_time,end_time;
+	double *fwhm_list = NULL;
+	double *moment_fwhm_list = NULL;
+	double *ellipticity_list = NULL;
+	int thread_count,thread_index,candidate_count,candidate_index,selected_count,source_count;
+	int first_row,last_row,success;
+
+	Seeing_Error_Number = 0;
+	if(image_data == NULL)
+	{
+		Seeing_Error_Number = 7;
+		sprintf(Seeing_Error_String,"CCD_Seeing_Measure:image_data was NULL.");
+		return FALSE;
+	}
+	if((ncols <= 0)||(nrows <= 0))
+	{
+		Seeing_Error_Number = 8;
+		sprintf(Seeing_Error_String,"CCD_Seeing_Measure:Illegal dimensions (%d,%d).",ncols,nrows);
+		return FALSE;
+	}
+	if(result == NULL)
+	{
+		Seeing_Error_Number = 9;
+		sprintf(Seeing_Error_String,"CCD_Seeing_Measure:result was NULL.");
+		return FALSE;
+	}
+	clock_gettime(CLOCK_REALTIME,&start_time);
+	memset(result,0,sizeof(struct CCD_Seeing_Result_Struct));
+	result->NCols = ncols;
+	result->NRows = nrows;
+	if(!CCD_Source_Find_Background_Get(image_data,ncols,nrows,&(result->Background),
+					   &(result->Background_Sigma)))
+	{
+		Seeing_Error_Number = 10;
+		sprintf(Seeing_Error_String,"CCD_Seeing_Measure:Failed to get background.");
+		return FALSE;
+	}
+	/* candidates must have a whole cutout inside the frame */
+	first_row = Seeing_Data.Cutout_Radius;
+	last_row = nrows-Seeing_Data.Cutout_Radius;
+	if((ncols <= (2*Seeing_Data.Cutout_Radius))||(last_row <= first_row))
+	{
+#if LOGGING > 4
+		CCD_Global_Log_Format(LOG_VERBOSITY_VERBOSE,"CCD_Seeing_Measure:(%d,%d):Frame too small for "
+				      "cutout radius %d.",ncols,nrows,Seeing_Data.Cutout_Radius);
+#endif
+		clock_gettime(CLOCK_REALTIME,&end_time);
+		result->Elapsed_Time = fdifftime(end_time,start_time);
+		return TRUE;
+	}
+	/* search row bands for candidates */
+	thread_count = Seeing_Data.Thread_Count;
+	if(thread_count > (last_row-first_row))
+		thread_count = last_row-first_row;
+	memset(thread_list,0,sizeof(thread_list));
+	for(thread_index = 0; thread_index < thread_count; thread_index++)
+	{
+		thread_list[thread_index].Image_Data = image_data;
+		thread_list[thread_index].NCols = ncols;
+		thread_list[thread_index].NRows = nrows;
+		thread_list[thread_index].Start_Row = first_row+((thread_index*(last_row-first_row))/thread_count);
+		thread_list[thread_index].End_Row = first_row+(((thread_index+1)*(last_row-first_row))/thread_count);
+		thread_list[thread_index].Background = result->Background;
+		thread_list[thread_index].Threshold = (int)(result->Background+
+							    (Seeing_Data.Threshold_Sigma*result->Background_Sigma));
+	}
+	Seeing_Threads_Run(thread_list,thread_count,Seeing_Search_Thread);
+	/* check bands succeeded, and concatenate their candidates */
+	success = TRUE;
+	candidate_count = 0;
+	for(thread_index = 0; thread_index < thread_count; thread_index++)
+	{
+		if(thread_list[thread_index].Success == FALSE)
+			success = FALSE;
+		candidate_count += thread_list[thread_index].Candidate_Count;
+	}
+	if(success == FALSE)
+	{
+		Seeing_Error_Number = 11;
+		sprintf(Seeing_Error_String,"CCD_Seeing_Measure:Failed to allocate memory whilst searching.");
+	}
+	else if(candidate_count > 0)
+	{
+		candidate_list = (struct Seeing_Candidate_Struct *)malloc(candidate_count*
+									  sizeof(struct Seeing_Candidate_Struct));
+		fwhm_list = (double *)malloc(candidate_count*sizeof(double));
+		moment_fwhm_list = (double *)malloc(candidate_count*sizeof(double));
+		ellipticity_list = (double *)malloc(candidate_count*sizeof(double));
+		if((candidate_list == NULL)||(fwhm_list == NULL)||(moment_fwhm_list == NULL)||
+		   (ellipticity_list == NULL))
+		{
+			Seeing_Error_Number = 12;
+			sprintf(Seeing_Error_String,"CCD_Seeing_Measure:Failed to allocate %d candidates.",
+				candidate_count);
+			success = FALSE;
+		}
+	}
+	if(success && (candidate_count > 0))
+	{
+		candidate_index = 0;
+		for(thread_index = 0; thread_index < thread_count; thread_index++)
+		{
+			memcpy(candidate_list+candidate_index,thread_list[thread_index].Candidate_List,
+			       thread_list[thread_index].Candidate_Count*sizeof(struct Seeing_Candidate_Struct));
+			candidate_index += thread_list[thread_index].Candidate_Count;
+			free(thread_list[thread_index].Candidate_List);
+			thread_list[thread_index].Candidate_List = NULL;
+		}
+		result->Candidate_Count = candidate_count;
+		selected_count = Seeing_Candidate_Select(candidate_list,candidate_count,ncols,nrows);
+		if(selected_count < 0)
+		{
+			Seeing_Error_Number = 13;
+			sprintf(Seeing_Error_String,"CCD_Seeing_Measure:Failed to allocate selection grid.");
+			success = FALSE;
+		}
+	}
+	if(success && (candidate_count > 0))
+	{
+		/* measure the selected candidates, interleaved across the threads */
+		for(thread_index = 0; thread_index < thread_count; thread_index++)
+		{
+			thread_list[thread_index].Candidate_List = candidate_list;
+			thread_list[thread_index].Candidate_Count = selected_count;
+			thread_list[thread_index].Thread_Index = thread_index;
+			thread_list[thread_index].Thread_Count = thread_count;
+		}
+		Seeing_Threads_Run(thread_list,thread_count,Seeing_Measure_Thread);
+		source_count = 0;
+		for(candidate_index = 0; candidate_index < selected_count; candidate_index++)
+		{
+			if(candidate_list[candidate_index].Is_Measured == FALSE)
+				continue;
+			fwhm_list[source_count] = candidate_list[candidate_index].FWHM;
+			moment_fwhm_list[source_count] = candidate_list[candidate_index].Moment_FWHM;
+			ellipticity_list[source_count] = candidate_list[candidate_index].Ellipticity;
+			if(candidate_list[candidate_index].Is_Fitted)
+				result->Fit_Count++;
+			source_count++;
+		}
+		result->Source_Count = source_count;
+		if(source_count > 0)
+		{
+			result->FWHM = Seeing_Median(fwhm_list,source_count);
+			result->Moment_FWHM = Seeing_Median(moment_fwhm_list,source_count);
+			result->Ellipticity = Seeing_Median(ellipticity_list,source_count);
+			/* re-use moment_fwhm_list for the absolute deviations of the FWHMs */
+			for(candidate_index = 0; candidate_index < source_count; candidate_index++)
+				moment_fwhm_list[candidate_index] = fabs(fwhm_list[candidate_index]-result->FWHM);
+			result->FWHM_Sigma = SEEING_MAD_TO_SIGMA*Seeing_Median(moment_fwhm_list,source_count);
+		}
+	}
+	/* free allocated memory. The thread candidate lists now point to candidate_list */
+	for(thread_index = 0; thread_index < thread_count; thread_index++)
+	{
+		if((thread_list[thread_index].Candidate_List != NULL)&&
+		   (thread_list[thread_index].Candidate_List != candidate_list))
+			free(thread_list[thread_index].Candidate_List);
+	}
+	if(candidate_list != NULL)
+		free(candidate_list);
+	if(fwhm_list != NULL)
+		free(fwhm_list);
+	if(moment_fwhm_list != NULL)
+		free(moment_fwhm_list);
+	if(ellipticity_list != NULL)
+		free(ellipticity_list);
+	if(success == FALSE)
+		return FALSE;
+	clock_gettime(CLOCK_REALTIME,&end_time);
+	result->Elapsed_Time = fdifftime(end_time,start_time);
+#if LOGGING > 4
+	CCD_Global_Log_Format(LOG_VERBOSITY_VERBOSE,"CCD_Seeing_Measure:(%d,%d):background %.2f:sigma %.2f:"
+			      "%d candidates:%d sources (%d fitted):FWHM %.3f (sigma %.3f, moments %.3f) pixels:"
+			      "ellipticity %.3f:%.3f seconds.",ncols,nrows,result->Background,
+			      result->Background_Sigma,result->Candidate_Count,result->Source_Count,result->Fit_Count,
+			      result->FWHM,result->FWHM_Sigma,result->Moment_FWHM,result->Ellipticity,
+			      result->Elapsed_Time);
+#endif
+	return TRUE;
+}
+
+/**
+ * Routine called after a frame has been read out and de-interlaced, but before it is saved to disk.
+ * If the seeing estimator is enabled, CCD_Seeing_Measure is run on the frame and the result kept for
+ * CCD_Seeing_Get_Last_Result. If the seeing estimator is disabled, this routine does nothing.
+ * @param image_data The de-interlaced frame, ncols by nrows unsigned shorts, row 0 first.
+ * @param ncols The number of binned columns in the frame.
+ * @param nrows The number of binned rows in the frame.
+ * @return The routine returns TRUE on success (or if the seeing estimator is disabled),
+ *         and FALSE if an error occurs.
+ * @see #Seeing_Data
+ * @see #CCD_Seeing_Measure
+ * @see #CCD_Seeing_Get_Last_Result
+ */
+int CCD_Seeing_Post_Readout(unsigned short *image_data,int ncols,int nrows)
+{
+	if(Seeing_Data.Enable == FALSE)
+		return TRUE;
+	Seeing_Data.Last_Result_Valid = FALSE;
+	if(!CCD_Seeing_Measure(image_data,ncols,nrows,&(Seeing_Data.Last_Result)))
+		return FALSE;
+	Seeing_Data.Last_Result_Valid = TRUE;
+	return TRUE;
+}
+
+/**
+ * Routine to retrieve the result of running the seeing estimator on the last frame read out.
+ * @param result The address of a structure to fill in with the results.
+ * @return The routine returns TRUE on success, and FALSE if no frame has been successfully processed since
+ *         the seeing estimator was enabled.
+ * @see #Seeing_Data
+ * @see #CCD_Seeing_Set_Enable
+ */
+int CCD_Seeing_Get_Last_Result(struct CCD_Seeing_Result_Struct *result)
+{
+	Seeing_Error_Number = 0;
+	if(result == NULL)
+	{
+		Seeing_Error_Number = 14;
+		sprintf(Seeing_Error_String,"CCD_Seeing_Get_Last_Result:result was NULL.");
+		return FALSE;
+	}
+	if(Seeing_Data.Last_Result_Valid == FALSE)
+	{
+		Seeing_Error_Number = 15;
+		sprintf(Seeing_Error_String,"CCD_Seeing_Get_Last_Result:"
+			"No frame processed since the seeing estimator was enabled.");
+		return FALSE;
+	}
+	(*result) = Seeing_Data.Last_Result;
+	return TRUE;
+}
+
+/**
+ * Get the current value of the error number.
+ * @return The current value of the error number.
+ * @see #Seeing_Error_Number
+ */
+int CCD_Seeing_Get_Error_Number(void)
+{
+	return Seeing_Error_Number;
+}
+
+/**
+ * The error routine that reports any errors occuring in ccd_seeing in a standard way.
+ * @see ccd_global.html#CCD_Global_Get_Current_Time_String
+ * @see #Seeing_Error_Number
+ * @see #Seeing_Error_String
+ */
+void CCD_Seeing_Error(void)
+{
+	char time_string[32];
+
+	CCD_Global_Get_Current_Time_String(time_string,32);
+	/* if the error number is zero an error message has not been set up
+	** This is in itself an error as we should not be calling this routine
+	** without there being an error to display */
+	if(Seeing_Error_Number == 0)
+		sprintf(Seeing_Error_String,"Logic Error:No Error defined");
+	fprintf(stderr,"%s CCD_Seeing:Error(%d) : %s\n",time_string,Seeing_Error_Number,Seeing_Error_String);
+}
+
+/**
+ * The error routine that reports any errors occuring in ccd_seeing in a standard way. This routine places the
+ * generated error string at the end of a passed in string argument.
+ * @param error_string A string to put the generated error in. This string should be initialised before
+ * 	being passed to this routine. The routine will try to concatenate it's error string onto the end
+ * 	of any string already in existance.
+ * @see ccd_global.html#CCD_Global_Get_Current_Time_String
+ */
+void CCD_Seeing_Error_String(char *error_string)
+{
+	char time_string[32];
+
+	CCD_Global_Get_Current_Time_String(time_string,32);
+	/* if the error number is zero an error message has not been set up
+	** This is in itself an error as we should not be calling this routine
+	** without there being an error to display */
+	if(Seeing_Error_Number == 0)
+		sprintf(Seeing_Error_String,"Logic Error:No Error defined");
+	sprintf(error_string+strlen(error_string),"%s CCD_Seeing:Error(%d) : %s\n",time_string,
+		Seeing_Error_Number,Seeing_Error_String);
+}
+
+/* -----------------------------------------------------------------------------
+** 	internal functions
+** ----------------------------------------------------------------------------- */
+/**
+ * Run a thread routine over a list of thread data. Threads 1.. are started as new threads, thread 0 is run
+ * in the calling thread. If a thread cannot be started, it's routine is run in the calling thread once
+ * the others have been joined.
+ * @param thread_list The list of thread data.
+ * @param thread_count The number of threads in thread_list.
+ * @param thread_routine The routine to run for each thread.
+ */
+static void Seeing_Threads_Run(struct Seeing_Thread_Struct *thread_list,int thread_count,
+			       void *(*thread_routine)(void *))
+{
+	int thread_index,retval;
+
+	for(thread_index = 1; thread_index < thread_count; thread_index++)
+	{
+		retval = pthread_create(&(thread_list[thread_index].Thread),NULL,thread_routine,
+					(void *)&(thread_list[thread_index]));
+		thread_list[thread_index].Thread_Started = (retval == 0);
+	}
+	thread_routine((void *)&(thread_list[0]));
+	for(thread_index = 1; thread_index < thread_count; thread_index++)
+	{
+		if(thread_list[thread_index].Thread_Started)
+			pthread_join(thread_list[thread_index].Thread,NULL);
+		else
+			thread_routine((void *)&(thread_list[thread_index]));
+		thread_list[thread_index].Thread_Started = FALSE;
+	}
+}
+
+/**
+ * Thread routine that searches one row band of a frame for candidate sources. A candidate is a pixel above the
+ * threshold that is a local maximum (strictly greater than the already scanned neighbours to the left and above,
+ * and at least as great as the others, so a flat topped peak gives one candidate), whose four direct neighbours
+ * have a mean above the background of at least SEEING_MIN_NEIGHBOUR_RATIO of it's own.
+ * The band rows, and the columns searched, are at least Cutout_Radius from the edge of the frame.
+ * @param user_arg A pointer to the Seeing_Thread_Struct to search.
+ * @return Always NULL. thread->Success is set to TRUE if the search succeeded.
+ * @see #SEEING_MIN_NEIGHBOUR_RATIO
+ * @see #SEEING_INITIAL_CANDIDATE_COUNT
+ */
+static void *Seeing_Search_Thread(void *user_arg)
+{
+	struct Seeing_Thread_Struct *thread = NULL;
+	struct Seeing_Candidate_Struct *candidate_list = NULL;
+	unsigned short *row_data = NULL;
+	int x,y,ncols,radius,value,allocated_count;
+	double neighbour_mean;
+
+	thread = (struct Seeing_Thread_Struct *)user_arg;
+	thread->Success = FALSE;
+	thread->Candidate_List = NULL;
+	thread->Candidate_Count = 0;
+	thread->Candidate_Allocated_Count = 0;
+	ncols = thread->NCols;
+	radius = Seeing_Data.Cutout_Radius;
+	for(y = thread->Start_Row; y < thread->End_Row; y++)
+	{
+		row_data = thread->Image_Data+(y*ncols);
+		for(x = radius; x < (ncols-radius); x++)
+		{
+			value = row_data[x];
+			if(value <= thread->Threshold)
+				continue;
+			if((value <= row_data[x-1])||(value < row_data[x+1])||
+			   (value <= row_data[x-ncols-1])||(value <= row_data[x-ncols])||(value <= row_data[x-ncols+1])||
+			   (value < row_data[x+ncols-1])||(value < row_data[x+ncols])||(value < row_data[x+ncols+1]))
+				continue;
+			neighbour_mean = (((double)row_data[x-1])+((double)row_data[x+1])+((double)row_data[x-ncols])+
+					  ((double)row_data[x+ncols]))/4.0;
+			if((neighbour_mean-thread->Background) <
+			   (SEEING_MIN_NEIGHBOUR_RATIO*(((double)value)-thread->Background)))
+				continue;
+			if(thread->Candidate_Count >= thread->Candidate_Allocated_Count)
+			{
+				if(thread->Candidate_Allocated_Count == 0)
+					allocated_count = SEEING_INITIAL_CANDIDATE_COUNT;
+				else
+					allocated_count = thread->Candidate_Allocated_Count*2;
+				candidate_list = (struct Seeing_Candidate_Struct *)realloc(thread->Candidate_List,
+							allocated_count*sizeof(struct Seeing_Candidate_Struct));
+				if(candidate_list == NULL)
+					return NULL;
+				thread->Candidate_List = candidate_list;
+				thread->Candidate_Allocated_Count = allocated_count;
+			}
+			memset(&(thread->Candidate_List[thread->Candidate_Count]),0,
+			       sizeof(struct Seeing_Candidate_Struct));
+			thread->Candidate_List[thread->Candidate_Count].X = x;
+			thread->Candidate_List[thread->Candidate_Count].Y = y;
+			thread->Candidate_List[thread->Candidate_Count].Peak = value;
+			thread->Candidate_Count++;
+		}
+	}
+	thread->Success = TRUE;
+	return NULL;
+}
+
+/**
+ * Thread routine that measures every Thread_Count'th selected candidate, starting at Thread_Index,
+ * using Seeing_Measure. Each thread writes to different candidates, so no locking is needed.
+ * @param user_arg A pointer to the Seeing_Thread_Struct.
+ * @return Always NULL. thread->Success is set to TRUE.
+ * @see #Seeing_Measure
+ */
+static void *Seeing_Measure_Thread(void *user_arg)
+{
+	struct Seeing_Thread_Struct *thread = NULL;
+	int candidate_index;
+
+	thread = (struct Seeing_Thread_Struct *)user_arg;
+	for(candidate_index = thread->Thread_Index; candidate_index < thread->Candidate_Count;
+	    candidate_index += thread->Thread_Count)
+	{
+		Seeing_Measure(thread->Image_Data,thread->NCols,thread->Background,
+			       &(thread->Candidate_List[candidate_index]));
+	}
+	thread->Success = TRUE;
+	return NULL;
+}
+
+/**
+ * Select the candidates to measure. The candidates are sorted by peak value, brightest first. Walking down
+ * the sorted list, a candidate is rejected if a brighter candidate (selected or not) lies within it's cutout,
+ * as it is blended (or part of a brighter source's wings). Candidates with a saturated peak are not selected,
+ * so they do not use up the Max_Source_Count, but still stop fainter neighbours being selected. A grid of cells Cutout_Radius+1 pixels square,
+ * each holding a list of the candidates already walked, means only the neighbouring cells are checked.
+ * The walk stops once Max_Source_Count candidates are selected. The selected candidates are then moved to
+ * the start of candidate_list, brightest first.
+ * @param candidate_list The list of candidates.
+ * @param candidate_count The number of candidates in candidate_list.
+ * @param ncols The number of columns in the frame.
+ * @param nrows The number of rows in the frame.
+ * @return The number of selected candidates, or -1 if the grid could not be allocated.
+ * @see #Seeing_Candidate_Peak_Compare
+ */
+static int Seeing_Candidate_Select(struct Seeing_Candidate_Struct *candidate_list,int candidate_count,int ncols,
+				   int nrows)
+{
+	int *cell_head_list = NULL;
+	int *next_list = NULL;
+	int *selected_list = NULL;
+	int cell_size,grid_ncols,grid_nrows,candidate_index,selected_count,cell_x,cell_y,cx,cy,other_index;
+	int radius,is_isolated;
+
+	radius = Seeing_Data.Cutout_Radius;
+	cell_size = radius+1;
+	grid_ncols = (ncols/cell_size)+1;
+	grid_nrows = (nrows/cell_size)+1;
+	cell_head_list = (int *)malloc(grid_ncols*grid_nrows*sizeof(int));
+	next_list = (int *)malloc(candidate_count*sizeof(int));
+	selected_list = (int *)malloc(candidate_count*sizeof(int));
+	if((cell_head_list == NULL)||(next_list == NULL)||(selected_list == NULL))
+	{
+		if(cell_head_list != NULL)
+			free(cell_head_list);
+		if(next_list != NULL)
+			free(next_list);
+		if(selected_list != NULL)
+			free(selected_list);
+		return -1;
+	}
+	for(cell_x = 0; cell_x < (grid_ncols*grid_nrows); cell_x++)
+		cell_head_list[cell_x] = -1;
+	qsort(candidate_list,candidate_count,sizeof(struct Seeing_Candidate_Struct),Seeing_Candidate_Peak_Compare);
+	selected_count = 0;
+	for(candidate_index = 0; (candidate_index < candidate_count)&&
+		    (selected_count < Seeing_Data.Max_Source_Count); candidate_index++)
+	{
+		cell_x = candidate_list[candidate_index].X/cell_size;
+		cell_y = candidate_list[candidate_index].Y/cell_size;
+		is_isolated = TRUE;
+		for(cy = cell_y-1; (cy <= cell_y+1) && is_isolated; cy++)
+		{
+			if((cy < 0)||(cy >= grid_nrows))
+				continue;
+			for(cx = cell_x-1; (cx <= cell_x+1) && is_isolated; cx++)
+			{
+				if((cx < 0)||(cx >= grid_ncols))
+					continue;
+				for(other_index = cell_head_list[(cy*grid_ncols)+cx]; other_index > -1;
+				    other_index = next_list[other_index])
+				{
+					if((abs(candidate_list[other_index].X-candidate_list[candidate_index].X) <= radius)&&
+					   (abs(candidate_list[other_index].Y-candidate_list[candidate_index].Y) <= radius))
+					{
+						is_isolated = FALSE;
+						break;
+					}
+				}
+			}
+		}
+		next_list[candidate_index] = cell_head_list[(cell_y*grid_ncols)+cell_x];
+		cell_head_list[(cell_y*grid_ncols)+cell_x] = candidate_index;
+		if(is_isolated && (candidate_list[candidate_index].Peak < Seeing_Data.Saturation_Counts))
+			selected_list[selected_count++] = candidate_index;
+	}
+	/* move the selected candidates to the start of the list. selected_list is increasing, and
+	** selected_list[i] >= i, so no candidate is overwritten before it is moved */
+	for(candidate_index = 0; candidate_index < selected_count; candidate_index++)
+		candidate_list[candidate_index] = candidate_list[selected_list[candidate_index]];
+	free(cell_head_list);
+	free(next_list);
+	free(selected_list);
+	return selected_count;
+}
+
+/**
+ * Comparison routine passed to qsort, to sort candidates into descending order of peak value.
+ * @param p1 A pointer to the first Seeing_Candidate_Struct.
+ * @param p2 A pointer to the second Seeing_Candidate_Struct.
+ * @return Less than zero if the first candidate's peak is brighter, greater than zero if the second's is,
+ *         and zero if they are the same.
+ */
+static int Seeing_Candidate_Peak_Compare(const void *p1,const void *p2)
+{
+	const struct Seeing_Candidate_Struct *candidate1 = (const struct Seeing_Candidate_Struct *)p1;
+	const struct Seeing_Candidate_Struct *candidate2 = (const struct Seeing_Candidate_Struct *)p2;
+
+	return candidate2->Peak-candidate1->Peak;
+}
+
+/**
+ * Return the median of a list of values. The list is sorted in place.
+ * @param value_list The list of values.
+ * @param value_count The number of values in the list, which must be at least one.
+ * @return The median value.
+ * @see ccd_global.html#CCD_Global_Double_Compare
+ */
+static double Seeing_Median(double *value_list,int value_count)
+{
+	qsort(value_list,value_count,sizeof(double),CCD_Global_Double_Compare);
+	if((value_count % 2) == 1)
+		return value_list[value_count/2];
+	return (value_list[(value_count/2)-1]+value_list[value_count/2])/2.0;
+}
+
+/**
+ * Measure one candidate source, in the square cutout of Cutout_Radius around it's peak pixel.
+ * <ul>
+ * <li>If any pixel in the cutout is at or above Saturation_Counts, the candidate is not measured.
+ * <li>The flux weighted centroid and second order moments of the background subtracted pixels within
+ *     Cutout_Radius of the peak are computed. The eigenvalues of the moment matrix are the variances along the
+ *     major and minor axes, which give the moment-based FWHM (geometric mean of the axes) and ellipticity.
+ *     If the moments are not positive, or the FWHM is less than SEEING_MIN_FWHM, the candidate is not measured.
+ * <li>A 2D Gaussian is fitted to the cutout using Seeing_Gaussian_Fit, starting from the moments. If the fit
+ *     converges, and gives a positive definite quadratic form with a centre near the peak, it's FWHM and
+ *     ellipticity are used.
+ * </ul>
+ * @param image_data The frame.
+ * @param ncols The number of columns in the frame.
+ * @param background The background level.
+ * @param candidate The candidate to measure. The measured values are filled in.
+ * @see #Seeing_Data
+ * @see #Seeing_Gaussian_Fit
+ * @see #SEEING_SIGMA_TO_FWHM
+ * @see #SEEING_MIN_FWHM
+ * @see #SEEING_FIT_MAX_CENTRE_SHIFT
+ */
+static void Seeing_Measure(unsigned short *image_data,int ncols,double background,
+			   struct Seeing_Candidate_Struct *candidate)
+{
+	double parameter_list[SEEING_FIT_PARAMETER_COUNT];
+	double flux,total_flux,sum_x,sum_y,sum_xx,sum_yy,sum_xy,x_centre,y_centre,mxx,myy,mxy;
+	double trace,determinant,discriminant,major,minor,dx,dy;
+	int x,y,radius,radius_squared;
+
+	candidate->Is_Measured = FALSE;
+	candidate->Is_Fitted = FALSE;
+	radius = Seeing_Data.Cutout_Radius;
+	radius_squared = radius*radius;
+	/* reject saturated sources, and get the first moments */
+	total_flux = 0.0;
+	sum_x = 0.0;
+	sum_y = 0.0;
+	for(y = -radius; y <= radius; y++)
+	{
+		for(x = -radius; x <= radius; x++)
+		{
+			if(image_data[((candidate->Y+y)*ncols)+candidate->X+x] >= Seeing_Data.Saturation_Counts)
+				return;
+			if(((x*x)+(y*y)) > radius_squared)
+				continue;
+			flux = ((double)image_data[((candidate->Y+y)*ncols)+candidate->X+x])-background;
+			total_flux += flux;
+			sum_x += flux*((double)x);
+			sum_y += flux*((double)y);
+		}
+	}
+	if(total_flux <= 0.0)
+		return;
+	x_centre = sum_x/total_flux;
+	y_centre = sum_y/total_flux;
+	/* second moments about the centroid */
+	sum_xx = 0.0;
+	sum_yy = 0.0;
+	sum_xy = 0.0;
+	for(y = -radius; y <= radius; y++)
+	{
+		for(x = -radius; x <= radius; x++)
+		{
+			if(((x*x)+(y*y)) > radius_squared)
+				continue;
+			flux = ((double)image_data[((candidate->Y+y)*ncols)+candidate->X+x])-background;
+			dx = ((double)x)-x_centre;
+			dy = ((double)y)-y_centre;
+			sum_xx += flux*dx*dx;
+			sum_yy += flux*dy*dy;
+			sum_xy += flux*dx*dy;
+		}
+	}
+	mxx = sum_xx/total_flux;
+	myy = sum_yy/total_flux;
+	mxy = sum_xy/total_flux;
+	trace = mxx+myy;
+	determinant = (mxx*myy)-(mxy*mxy);
+	discriminant = sqrt((((mxx-myy)*(mxx-myy))/4.0)+(mxy*mxy));
+	major = (trace/2.0)+discriminant;
+	minor = (trace/2.0)-discriminant;
+	if((minor <= 0.0)||(determinant <= 0.0))
+		return;
+	candidate->Moment_FWHM = SEEING_SIGMA_TO_FWHM*sqrt(sqrt(major*minor));
+	if(candidate->Moment_FWHM < SEEING_MIN_FWHM)
+		return;
+	candidate->FWHM = candidate->Moment_FWHM;
+	candidate->Ellipticity = 1.0-sqrt(minor/major);
+	candidate->Is_Measured = TRUE;
+	/* refine with a 2D Gaussian fit, starting from the moments. The quadratic form is the inverse of the
+	** moment (covariance) matrix */
+	parameter_list[0] = background;
+	parameter_list[1] = ((double)candidate->Peak)-background;
+	parameter_list[2] = x_centre;
+	parameter_list[3] = y_centre;
+	parameter_list[4] = myy/determinant;
+	parameter_list[5] = -mxy/determinant;
+	parameter_list[6] = mxx/determinant;
+	if(!Seeing_Gaussian_Fit(image_data,ncols,candidate->X,candidate->Y,parameter_list))
+		return;
+	/* the fitted quadratic form must be positive definite, with the centre near the peak */
+	determinant = (parameter_list[4]*parameter_list[6])-(parameter_list[5]*parameter_list[5]);
+	if((parameter_list[1] <= 0.0)||(parameter_list[4] <= 0.0)||(determinant <= 0.0)||
+	   (fabs(parameter_list[2]) > SEEING_FIT_MAX_CENTRE_SHIFT)||
+	   (fabs(parameter_list[3]) > SEEING_FIT_MAX_CENTRE_SHIFT))
+		return;
+	/* the eigenvalues of the quadratic form are the inverse variances along the axes */
+	trace = parameter_list[4]+parameter_list[6];
+	discriminant = sqrt((((parameter_list[4]-parameter_list[6])*(parameter_list[4]-parameter_list[6]))/4.0)+
+			    (parameter_list[5]*parameter_list[5]));
+	major = (trace/2.0)+discriminant;
+	minor = (trace/2.0)-discriminant;
+	if(minor <= 0.0)
+		return;
+	dx = SEEING_SIGMA_TO_FWHM/sqrt(sqrt(determinant));
+	if((dx < SEEING_MIN_FWHM)||(dx > (2.0*radius)))
+		return;
+	candidate->FWHM = dx;
+	candidate->Ellipticity = 1.0-sqrt(minor/major);
+	candidate->Is_Fitted = TRUE;
+}
+
+/**
+ * Fit an elliptical 2D Gaussian, B + A.exp(-(a.dx^2 + 2b.dx.dy + c.dy^2)/2), where dx and dy are relative to
+ * the centre (x0,y0), to the square cutout of Cutout_Radius around a peak pixel, using Levenberg-Marquardt.
+ * All pixels are equally weighted. The fit stops when an accepted step reduces the chi squared by less than
+ * SEEING_FIT_CONVERGED_FRACTION, or the damping factor exceeds SEEING_FIT_MAX_LAMBDA (no step reduces
+ * the chi squared). It fails if SEEING_FIT_MAX_ITERATION_COUNT iterations are reached first, or the
+ * normal equations are singular.
+ * @param image_data The frame.
+ * @param ncols The number of columns in the frame.
+ * @param x_peak The column of the peak pixel.
+ * @param y_peak The row of the peak pixel.
+ * @param parameter_list On entry, the starting parameters, on exit the fitted parameters: B, A, x0, y0 (relative
+ *        to the peak pixel), a, b, c.
+ * @return The routine returns TRUE if the fit converged, and FALSE if it failed.
+ * @see #Seeing_Gaussian_Chi_Squared
+ * @see #Seeing_Linear_Solve
+ * @see #SEEING_FIT_PARAMETER_COUNT
+ * @see #SEEING_FIT_MAX_ITERATION_COUNT
+ * @see #SEEING_FIT_CONVERGED_FRACTION
+ * @see #SEEING_FIT_START_LAMBDA
+ * @see #SEEING_FIT_MAX_LAMBDA
+ */
+static int Seeing_Gaussian_Fit(unsigned short *image_data,int ncols,int x_peak,int y_peak,
+			       double parameter_list[SEEING_FIT_PARAMETER_COUNT])
+{
+	double alpha[SEEING_FIT_PARAMETER_COUNT][SEEING_FIT_PARAMETER_COUNT];
+	double matrix[SEEING_FIT_PARAMETER_COUNT][SEEING_FIT_PARAMETER_COUNT];
+	double beta[SEEING_FIT_PARAMETER_COUNT];
+	double step[SEEING_FIT_PARAMETER_COUNT];
+	double trial_parameter_list[SEEING_FIT_PARAMETER_COUNT];
+	double derivative[SEEING_FIT_PARAMETER_COUNT];
+	double chi_squared,trial_chi_squared,lambda,dx,dy,exponential,model,residual;
+	int iteration,i,j,x,y,radius;
+
+	radius = Seeing_Data.Cutout_Radius;
+	lambda = SEEING_FIT_START_LAMBDA;
+	chi_squared = Seeing_Gaussian_Chi_Squared(image_data,ncols,x_peak,y_peak,parameter_list);
+	for(iteration = 0; iteration < SEEING_FIT_MAX_ITERATION_COUNT; iteration++)
+	{
+		/* build the normal equations J^T.J and J^T.r */
+		memset(alpha,0,sizeof(alpha));
+		memset(beta,0,sizeof(beta));
+		for(y = -radius; y <= radius; y++)
+		{
+			for(x = -radius; x <= radius; x++)
+			{
+				dx = ((double)x)-parameter_list[2];
+				dy = ((double)y)-parameter_list[3];
+				exponential = exp(-0.5*((parameter_list[4]*dx*dx)+(2.0*parameter_list[5]*dx*dy)+
+							(parameter_list[6]*dy*dy)));
+				model = parameter_list[0]+(parameter_list[1]*exponential);
+				residual = ((double)image_data[((y_peak+y)*ncols)+x_peak+x])-model;
+				derivative[0] = 1.0;
+				derivative[1] = exponential;
+				derivative[2] = parameter_list[1]*exponential*((parameter_list[4]*dx)+
+									  (parameter_list[5]*dy));
+				derivative[3] = parameter_list[1]*exponential*((parameter_list[5]*dx)+
+									  (parameter_list[6]*dy));
+				derivative[4] = -0.5*parameter_list[1]*exponential*dx*dx;
+				derivative[5] = -parameter_list[1]*exponential*dx*dy;
+				derivative[6] = -0.5*parameter_list[1]*exponential*dy*dy;
+				for(i = 0; i < SEEING_FIT_PARAMETER_COUNT; i++)
+				{
+					beta[i] += derivative[i]*residual;
+					for(j = 0; j <= i; j++)
+						alpha[i][j] += derivative[i]*derivative[j];
+				}
+			}
+		}
+		for(i = 0; i < SEEING_FIT_PARAMETER_COUNT; i++)
+		{
+			for(j = 0; j < i; j++)
+				alpha[j][i] = alpha[i][j];
+		}
+		/* find a damped step that reduces the chi squared */
+		while(TRUE)
+		{
+			memcpy(matrix,alpha,sizeof(matrix));
+			for(i = 0; i < SEEING_FIT_PARAMETER_COUNT; i++)
+			{
+				matrix[i][i] *= (1.0+lambda);
+				step[i] = beta[i];
+			}
+			if(!Seeing_Linear_Solve(matrix,step))
+				return FALSE;
+			for(i = 0; i < SEEING_FIT_PARAMETER_COUNT; i++)
+				trial_parameter_list[i] = parameter_list[i]+step[i];
+			trial_chi_squared = Seeing_Gaussian_Chi_Squared(image_data,ncols,x_peak,y_peak,
+									trial_parameter_list);
+			if(trial_chi_squared < chi_squared)
+				break;
+			lambda *= 10.0;
+			if(lambda > SEEING_FIT_MAX_LAMBDA)
+				return TRUE;
+		}
+		memcpy(parameter_list,trial_parameter_list,sizeof(trial_parameter_list));
+		lambda /= 10.0;
+		if((chi_squared-trial_chi_squared) < (SEEING_FIT_CONVERGED_FRACTION*chi_squared))
+			return TRUE;
+		chi_squared = trial_chi_squared;
+	}
+	return FALSE;
+}
+
+/**
+ * Compute the chi squared (sum of squared residuals) of a 2D Gaussian model against the square cutout of
+ * Cutout_Radius around a peak pixel.
+ * @param image_data The frame.
+ * @param ncols The number of columns in the frame.
+ * @param x_peak The column of the peak pixel.
+ * @param y_peak The row of the peak pixel.
+ * @param parameter_list The model parameters, as used by Seeing_Gaussian_Fit.
+ * @return The chi squared.
+ * @see #Seeing_Gaussian_Fit
+ */
+static double Seeing_Gaussian_Chi_Squared(unsigned short *image_data,int ncols,int x_peak,int y_peak,
+					  double parameter_list[SEEING_FIT_PARAMETER_COUNT])
+{
+	double chi_squared,dx,dy,residual;
+	int x,y,radius;
+
+	radius = Seeing_Data.Cutout_Radius;
+	chi_squared = 0.0;
+	for(y = -radius; y <= radius; y++)
+	{
+		for(x = -radius; x <= radius; x++)
+		{
+			dx = ((double)x)-parameter_list[2];
+			dy = ((double)y)-parameter_list[3];
+			residual = ((double)image_data[((y_peak+y)*ncols)+x_peak+x])-parameter_list[0]-
+				(parameter_list[1]*exp(-0.5*((parameter_list[4]*dx*dx)+(2.0*parameter_list[5]*dx*dy)+
+							     (parameter_list[6]*dy*dy))));
+			chi_squared += residual*residual;
+		}
+	}
+	return chi_squared;
+}
+
+/**
+ * Solve the linear equations matrix.x = vector, using Gaussian elimination with partial pivoting.
+ * @param matrix The matrix. This is overwritten.
+ * @param vector On entry the right hand side, on exit the solution x.
+ * @return The routine returns TRUE on success, and FALSE if the matrix is singular.
+ * @see #SEEING_FIT_PARAMETER_COUNT
+ */
+static int Seeing_Linear_Solve(double matrix[SEEING_FIT_PARAMETER_COUNT][SEEING_FIT_PARAMETER_COUNT],
+			       double vector[SEEING_FIT_PARAMETER_COUNT])
+{
+	double factor,swap;
+	int row,pivot_row,column,i;
+
+	for(column = 0; column < SEEING_FIT_PARAMETER_COUNT; column++)
+	{
+		pivot_row = column;
+		for(row = column+1; row < SEEING_FIT_PARAMETER_COUNT; row++)
+		{
+			if(fabs(matrix[row][column]) > fabs(matrix[pivot_row][column]))
+				pivot_row = row;
+		}
+		if(fabs(matrix[pivot_row][column]) < 1.0e-300)
+			return FALSE;
+		if(pivot_row != column)
+		{
+			for(i = 0; i < SEEING_FIT_PARAMETER_COUNT; i++)
+			{
+				swap = matrix[column][i];
+				matrix[column][i] = matrix[pivot_row][i];
+				matrix[pivot_row][i] = swap;
+			}
+			swap = vector[column];
+			vector[column] = vector[pivot_row];
+			vector[pivot_row] = swap;
+		}
+		for(row = column+1; row < SEEING_FIT_PARAMETER_COUNT; row++)
+		{
+			factor = matrix[row][column]/matrix[column][column];
+			for(i = column; i < SEEING_FIT_PARAMETER_COUNT; i++)
+				matrix[row][i] -= factor*matrix[column][i];
+			vector[row] -= factor*vector[column];
+		}
+	}
+	for(row = SEEING_FIT_PARAMETER_COUNT-1; row >= 0; row--)
+	{
+		for(i = row+1; i < SEEING_FIT_PARAMETER_COUNT; i++)
+			vector[row] -= matrix[row][i]*vector[i];
+		vector[row] /= matrix[row][row];
+	}
+	return TRUE;
+}
+
+/*
+** $Log: not supported by cvs2svn $
+*/
@@ -31,6 +31,7 @@
 #include "ccd_global.h"
 #include "ccd_dsp.h"
 #include "ccd_dsp_download.h"
+#include "ccd_frame_view.h"
 #include "ccd_interface.h"
 #include "ccd_interface_private.h"
 #include "ccd_temperature.h"
@@ -195,6 +196,7 @@ void CCD_Setup_Data_Initialise(CCD_Interface_Handle_T* handle)
 	handle->Setup_Data.NSBin = 0;
 	handle->Setup_Data.NPBin = 0;
 	handle->Setup_Data.Gain = CCD_DSP_GAIN_ONE;
+	handle->Setup_Data.Gain_Speed = TRUE;
 	handle->Setup_Data.Amplifier = CCD_DSP_AMPLIFIER_BOTTOM_LEFT;
 	handle->Setup_Data.Is_Dummy = FALSE;
 	handle->Setup_Data.Idle = FALSE;
@@ -283,6 +285,7 @@ void CCD_Setup_Data_Initialise(CCD_Interface_Handle_T* handle)
  * @see ccd_setup_private.html#CCD_Setup_Struct
  * @see ccd_dsp.html#CCD_DSP_Command_Flush_Reply_Buffer
  * @see ccd_interface.html#CCD_Interface_Handle_T
+ * @see ccd_frame_view.html#CCD_Frame_View_Raw_Invalidate
  */
 int CCD_Setup_Startup(CCD_Interface_Handle_T* handle,enum CCD_SETUP_LOAD_TYPE pci_load_type,char *pci_filename,
 		      long memory_map_length,int load_timing_software,
@@ -348,6 +351,8 @@ int CCD_Setup_Startup(CCD_Interface_Handle_T* handle,enum CCD_SETUP_LOAD_TYPE pc
 /* memory map initialisation */
 /* done after PCI download, as astropci sends a WRITE_PCI_ADDRESS HCVR command to the PCI board
 ** in response to a mmap call. */
+/* views of the raw readout buffer must not outlive the old mapping */
+	CCD_Frame_View_Raw_Invalidate();
 	if(!CCD_Interface_Memory_Map(handle,memory_map_length))
 	{
 		handle->Setup_Data.Setup_In_Progress = FALSE;
@@ -505,6 +510,7 @@ int CCD_Setup_Startup(CCD_Interface_Handle_T* handle,enum CCD_SETUP_LOAD_TYPE pc
  * @see #CCD_Setup_Startup
  * @see ccd_setup_private.html#CCD_Setup_Struct
  * @see ccd_interface.html#CCD_Interface_Handle_T
+ * @see ccd_frame_view.html#CCD_Frame_View_Raw_Invalidate
  */
 int CCD_Setup_Shutdown(CCD_Interface_Handle_T* handle)
 {
@@ -528,7 +534,8 @@ int CCD_Setup_Shutdown(CCD_Interface_Handle_T* handle)
 		sprintf(Setup_Error_String,"CCD_Setup_Startup:Aborted");
 		return FALSE;
 	}
-/* memory map un-mapped */
+/* memory map un-mapped, invalidating any views of the raw readout buffer first */
+	CCD_Frame_View_Raw_Invalidate();
 	if(!CCD_Interface_Memory_UnMap(handle))
 	{
 		Setup_Error_Number = 50;
@@ -1151,6 +1158,18 @@ enum CCD_DSP_GAIN CCD_Setup_Get_Gain(CCD_Interface_Handle_T* handle)
 	return handle->Setup_Data.Gain;
 }
 
+/**
+ * Routine to return the speed the video integrators were set to, with the gain, by CCD_Setup_Startup.
+ * @param handle The address of a CCD_Interface_Handle_T that holds the device connection specific information.
+ * @return TRUE if the integrators are 'fast', FALSE if they are 'slow'.
+ * @see ccd_setup_private.html#CCD_Setup_Struct
+ * @see ccd_interface.html#CCD_Interface_Handle_T
+ */
+int CCD_Setup_Get_Gain_Speed(CCD_Interface_Handle_T* handle)
+{
+	return handle->Setup_Data.Gain_Speed;
+}
+
 /**
  * Routine to return the amplifier used by the CCD Camera.
  * @param handle The address of a CCD_Interface_Handle_T that holds the device connection specific information.
@@ -1766,6 +1785,7 @@ static int Setup_Gain(CCD_Interface_Handle_T* handle,enum CCD_DSP_GAIN gain,int
 		sprintf(Setup_Error_String,"Setup_Gain:Gain Speed %d  (gain = %d)  has illegal value.",speed,gain);
 		return FALSE;
 	}
+	handle->Setup_Data.Gain_Speed = speed;
 	ret_val = CCD_DSP_Command_SGN(handle,handle->Setup_Data.Gain,speed);
 	if(ret_val!=CCD_DSP_DON)
 	{
@@ -0,0 +1,869 @@
+/* ccd_source_find.c
+** Source finder module.
+** $Header$
+*/
+/**
+ * ccd_source_find holds the routines for finding objects in a de-interlaced frame, whilst it is still in memory
+ * after readout. It is used by ACQUIRE (brightest object mode) to find the position of the brightest object
+ * without saving the frame and sending it to the real time data pipeline.
+ * <ul>
+ * <li>The background and it's standard deviation are estimated from the median and median absolute deviation
+ *     of a histogram of a sub-sample of the frame's pixels.
+ * <li>Pixels more than Threshold_Sigma standard deviations above the background are connected into objects
+ *     (8-connectivity) using a single pass union-find labelling. The frame is split into row bands, each band
+ *     being labelled by a separate thread.
+ * <li>Objects spanning band boundaries are merged by comparing the last row of labels of one band with
+ *     the first row of labels of the next.
+ * <li>The total flux above the background, and the flux weighted centroid, of each object are computed,
+ *     and the brightest object with at least Min_Pixel_Count pixels is returned.
+ * </ul>
+ * @author Chris Mottram
+ * @version $Revision$
+ */
+/**
+ * This hash define is needed before including source files give us POSIX.4/IEEE1003.1b-1993 prototypes.
+ */
+#define _POSIX_SOURCE 1
+/**
+ * This hash define is needed before including source files give us POSIX.4/IEEE1003.1b-1993 prototypes.
+ */
+#define _POSIX_C_SOURCE 199309L
+#include <errno.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "log_udp.h"
+#include "ccd_global.h"
+#include "ccd_source_find.h"
+
+/**
+ * Revision Control System identifier.
+ */
+static char rcsid[] = "$Id$";
+
+/* hash defines */
+/**
+ * The number of bins in the background histogram, one per possible pixel value.
+ */
+#define SOURCE_FIND_HISTOGRAM_BIN_COUNT		(65536)
+/**
+ * The approximate maximum number of pixels sampled when estimating the background.
+ * @see #CCD_Source_Find_Background_Get
+ */
+#define SOURCE_FIND_BACKGROUND_SAMPLE_COUNT	(262144)
+/**
+ * The smallest background standard deviation we allow, in counts. This stops noiseless (e.g. synthetic) frames
+ * having a threshold equal to the background.
+ */
+#define SOURCE_FIND_MIN_BACKGROUND_SIGMA	(1.0)
+/**
+ * Conversion factor from median absolute deviation to standard deviation, for a normal distribution.
+ */
+#define SOURCE_FIND_MAD_TO_SIGMA		(1.4826)
+/**
+ * A pixel value at or above this is considered saturated.
+ */
+#define SOURCE_FIND_SATURATION_COUNTS		(65535)
+/**
+ * The initial number of labels allocated per row band. The label list grows as required.
+ */
+#define SOURCE_FIND_INITIAL_LABEL_COUNT		(1024)
+
+/* data types */
+/**
+ * Data type holding local data to ccd_source_find. This consists of the following:
+ * <dl>
+ * <dt>Threshold_Sigma</dt> <dd>How many background standard deviations above the background a pixel must be
+ *     to be part of an object.</dd>
+ * <dt>Min_Pixel_Count</dt> <dd>The minimum number of pixels an object must have.</dd>
+ * <dt>Thread_Count</dt> <dd>The number of row bands (threads) to split the frame into.</dd>
+ * <dt>Enable</dt> <dd>A boolean, whether CCD_Source_Find_Post_Readout runs the source finder.</dd>
+ * <dt>Last_Result_Valid</dt> <dd>A boolean, whether Last_Result holds the result for the last frame read out
+ *     since the source finder was enabled.</dd>
+ * <dt>Last_Result</dt> <dd>The result of running the source finder on the last frame read out.</dd>
+ * </dl>
+ * @see #CCD_Source_Find_Result_Struct
+ */
+struct Source_Find_Struct
+{
+	double Threshold_Sigma;
+	int Min_Pixel_Count;
+	int Thread_Count;
+	int Enable;
+	int Last_Result_Valid;
+	struct CCD_Source_Find_Result_Struct Last_Result;
+};
+
+/**
+ * Data type holding the accumulated moments of one label (connected group of pixels).
+ * <dl>
+ * <dt>Parent</dt> <dd>The label this label has been merged into. A label that is it's own parent is a root.</dd>
+ * <dt>Flux</dt> <dd>The sum of the pixel values above the background.</dd>
+ * <dt>Sum_X</dt> <dd>The sum of the flux weighted (zero based) X positions.</dd>
+ * <dt>Sum_Y</dt> <dd>The sum of the flux weighted (zero based) Y positions.</dd>
+ * <dt>Peak</dt> <dd>The maximum pixel value.</dd>
+ * <dt>Pixel_Count</dt> <dd>The number of pixels.</dd>
+ * </dl>
+ * Until the labels are resolved, the moments only include pixels assigned directly to this label.
+ */
+struct Source_Find_Label_Struct
+{
+	int Parent;
+	double Flux;
+	double Sum_X;
+	double Sum_Y;
+	int Peak;
+	int Pixel_Count;
+};
+
+/**
+ * Data type holding the data for labelling one row band of a frame.
+ * <dl>
+ * <dt>Image_Data</dt> <dd>The frame.</dd>
+ * <dt>NCols</dt> <dd>The number of columns in the frame.</dd>
+ * <dt>Start_Row</dt> <dd>The first row in the band.</dd>
+ * <dt>End_Row</dt> <dd>One more than the last row in the band.</dd>
+ * <dt>Background</dt> <dd>The background level.</dd>
+ * <dt>Threshold</dt> <dd>Pixels above this value are part of an object.</dd>
+ * <dt>First_Row_Labels</dt> <dd>The labels of the first row in the band (ncols), used to merge bands.</dd>
+ * <dt>Last_Row_Labels</dt> <dd>The labels of the last row in the band (ncols), used to merge bands.</dd>
+ * <dt>Label_List</dt> <dd>The list of labels. Label 0 is the background, and is not used.</dd>
+ * <dt>Label_Count</dt> <dd>The number of labels used in Label_List (including label 0).</dd>
+ * <dt>Label_Allocated_Count</dt> <dd>The number of labels allocated in Label_List.</dd>
+ * <dt>Thread</dt> <dd>The thread labelling this band.</dd>
+ * <dt>Thread_Started</dt> <dd>A boolean, whether Thread was successfully started.</dd>
+ * <dt>Success</dt> <dd>A boolean, whether the labelling succeeded.</dd>
+ * </dl>
+ */
+struct Source_Find_Band_Struct
+{
+	unsigned short *Image_Data;
+	int NCols;
+	int Start_Row;
+	int End_Row;
+	double Background;
+	int Threshold;
+	int *First_Row_Labels;
+	int *Last_Row_Labels;
+	struct Source_Find_Label_Struct *Label_List;
+	int Label_Count;
+	int Label_Allocated_Count;
+	pthread_t Thread;
+	int Thread_Started;
+	int Success;
+};
+
+/* internal variables */
+/**
+ * Variable holding error code of last operation performed by ccd_source_find.
+ */
+static int Source_Find_Error_Number = 0;
+/**
+ * Local variable holding description of the last error that occured.
+ */
+static char Source_Find_Error_String[CCD_GLOBAL_ERROR_STRING_LENGTH] = "";
+/**
+ * Local source finder data.
+ * @see #Source_Find_Struct
+ */
+static struct Source_Find_Struct Source_Find_Data;
+
+/* internal function definitions */
+static void *Source_Find_Band_Thread(void *user_arg);
+static int Source_Find_Band_Label_New(struct Source_Find_Band_Struct *band);
+static int Source_Find_Label_Root_Get(struct Source_Find_Label_Struct *label_list,int label);
+static int Source_Find_Label_Union(struct Source_Find_Label_Struct *label_list,int label1,int label2);
+
+/* -----------------------------------------------------------------------------
+**     external functions
+** ----------------------------------------------------------------------------- */
+/**
+ * This routine sets up ccd_source_find internal variables.
+ * It should be called at startup.
+ * @return This routine returns TRUE for success.
+ * @see #Source_Find_Data
+ */
+int CCD_Source_Find_Initialise(void)
+{
+	Source_Find_Error_Number = 0;
+/* print some compile time information to stdout */
+	fprintf(stdout,"CCD_Source_Find_Initialise:%s.\n",rcsid);
+	memset(&Source_Find_Data,0,sizeof(Source_Find_Data));
+	Source_Find_Data.Threshold_Sigma = CCD_SOURCE_FIND_DEFAULT_THRESHOLD_SIGMA;
+	Source_Find_Data.Min_Pixel_Count = CCD_SOURCE_FIND_DEFAULT_MIN_PIXEL_COUNT;
+	Source_Find_Data.Thread_Count = CCD_SOURCE_FIND_DEFAULT_THREAD_COUNT;
+	Source_Find_Data.Enable = FALSE;
+	Source_Find_Data.Last_Result_Valid = FALSE;
+	return TRUE;
+}
+
+/**
+ * Routine to configure the source finder.
+ * @param threshold_sigma How many background standard deviations above the background a pixel must be
+ *        to be part of an object. Must be greater than zero.
+ * @param min_pixel_count The minimum number of connected pixels above the threshold an object must have.
+ *        Must be at least one.
+ * @param thread_count The number of row bands (threads) to split the frame into,
+ *        from 1 to CCD_SOURCE_FIND_MAX_THREAD_COUNT.
+ * @return The routine returns TRUE on success, and FALSE if an argument is out of range.
+ * @see #Source_Find_Data
+ * @see #CCD_SOURCE_FIND_MAX_THREAD_COUNT
+ */
+int CCD_Source_Find_Set_Config(double threshold_sigma,int min_pixel_count,int thread_count)
+{
+	Source_Find_Error_Number = 0;
+	if(threshold_sigma <= 0.0)
+	{
+		Source_Find_Error_Number = 1;
+		sprintf(Source_Find_Error_String,"CCD_Source_Find_Set_Config:Illegal threshold sigma %.2f.",
+			threshold_sigma);
+		return FALSE;
+	}
+	if(min_pixel_count < 1)
+	{
+		Source_Find_Error_Number = 2;
+		sprintf(Source_Find_Error_String,"CCD_Source_Find_Set_Config:Illegal minimum pixel count %d.",
+			min_pixel_count);
+		return FALSE;
+	}
+	if((thread_count < 1)||(thread_count > CCD_SOURCE_FIND_MAX_THREAD_COUNT))
+	{
+		Source_Find_Error_Number = 3;
+		sprintf(Source_Find_Error_String,"CCD_Source_Find_Set_Config:Illegal thread count %d (1..%d).",
+			thread_count,CCD_SOURCE_FIND_MAX_THREAD_COUNT);
+		return FALSE;
+	}
+	Source_Find_Data.Threshold_Sigma = threshold_sigma;
+	Source_Find_Data.Min_Pixel_Count = min_pixel_count;
+	Source_Find_Data.Thread_Count = thread_count;
+#if LOGGING > 4
+	CCD_Global_Log_Format(LOG_VERBOSITY_VERBOSE,"CCD_Source_Find_Set_Config:threshold sigma %.2f:"
+			      "minimum pixel count %d:thread count %d.",threshold_sigma,min_pixel_count,thread_count);
+#endif
+	return TRUE;
+}
+
+/**
+ * Routine to enable or disable running the source finder on each full frame after readout.
+ * Enabling the source finder invalidates the last result.
+ * @param enable A boolean, TRUE to run the source finder on subsequent frames, FALSE to stop.
+ * @return The routine returns TRUE on success, and FALSE if enable was not a boolean.
+ * @see #Source_Find_Data
+ * @see #CCD_Source_Find_Post_Readout
+ */
+int CCD_Source_Find_Set_Enable(int enable)
+{
+	Source_Find_Error_Number = 0;
+	if(!CCD_GLOBAL_IS_BOOLEAN(enable))
+	{
+		Source_Find_Error_Number = 4;
+		sprintf(Source_Find_Error_String,"CCD_Source_Find_Set_Enable:Illegal enable %d.",enable);
+		return FALSE;
+	}
+	if(enable)
+		Source_Find_Data.Last_Result_Valid = FALSE;
+	Source_Find_Data.Enable = enable;
+	return TRUE;
+}
+
+/**
+ * Routine to return whether the source finder is run on each full frame after readout.
+ * @return A boolean, TRUE if the source finder is enabled.
+ * @see #Source_Find_Data
+ */
+int CCD_Source_Find_Get_Enable(void)
+{
+	return Source_Find_Data.Enable;
+}
+
+/**
+ * Routine to find objects in a frame.
+ * <ul>
+ * <li>The background is estimated using CCD_Source_Find_Background_Get.
+ * <li>The frame is split into row bands, and each band is labelled in a separate thread
+ *     (Source_Find_Band_Thread). If a thread cannot be started, the band is labelled in this thread instead.
+ * <li>The band label lists are concatenated into one list, and labels that touch across band boundaries
+ *     are merged.
+ * <li>The moments of each label are added to it's root label.
+ * <li>The root labels with at least Min_Pixel_Count pixels are counted, and the one with the largest flux
+ *     is returned as the brightest object.
+ * </ul>
+ * @param image_data The frame, ncols by nrows unsigned shorts, row 0 first.
+ * @param ncols The number of columns in the frame.
+ * @param nrows The number of rows in the frame.
+ * @param result The address of a structure to fill in with the results.
+ * @return The routine returns TRUE on success, and FALSE if an error occurs.
+ * @see #Source_Find_Data
+ * @see #CCD_Source_Find_Background_Get
+ * @see #Source_Find_Band_Thread
+ * @see #Source_Find_Label_Root_Get
+ * @see #Source_Find_Label_Union
+ * @see #SOURCE_FIND_SATURATION_COUNTS
+ * @see ccd_global.html#fdifftime
+ */
+int CCD_Source_Find(unsigned short *image_data,int ncols,int nrows,struct CCD_Source_Find_Result_Struct *result)
+{
+	struct Source_Find_Band_Struct band_list[CCD_SOURCE_FIND_MAX_THREAD_COUNT];
+	struct Source_Find_Label_Struct *label_list = NULL;
+	struct Source_Find_Label_Struct *label = NULL;
+	struct timespec start_time,end_time;
+	int band_count,band_index,label_count,label_index,label_offset[CCD_SOURCE_FIND_MAX_THREAD_COUNT];
+	int x,dx,root,retval,success,brightest_label;
+
+	Source_Find_Error_Number = 0;
+	if(image_data == NULL)
+	{
+		Source_Find_Error_Number = 5;
+		sprintf(Source_Find_Error_String,"CCD_Source_Find:image_data was NULL.");
+		return FALSE;
+	}
+	if((ncols <= 0)||(nrows <= 0))
+	{
+		Source_Find_Error_Number = 6;
+		sprintf(Source_Find_Error_String,"CCD_Source_Find:Illegal dimensions (%d,%d).",ncols,nrows);
+		return FALSE;
+	}
+	if(result == NULL)
+	{
+		Source_Find_Error_Number = 7;
+		sprintf(Source_Find_Error_String,"CCD_Source_Find:result was NULL.");
+		return FALSE;
+	}
+	clock_gettime(CLOCK_REALTIME,&start_time);
+	memset(result,0,sizeof(struct CCD_Source_Find_Result_Struct));
+	result->NCols = ncols;
+	result->NRows = nrows;
+	if(!CCD_Source_Find_Background_Get(image_data,ncols,nrows,&(result->Background),&(result->Background_Sigma)))
+		return FALSE;
+	result->Threshold = result->Background+(Source_Find_Data.Threshold_Sigma*result->Background_Sigma);
+#if LOGGING > 4
+	CCD_Global_Log_Format(LOG_VERBOSITY_VERBOSE,"CCD_Source_Find:(%d,%d):background %.2f:sigma %.2f:"
+			      "threshold %.2f.",ncols,nrows,result->Background,result->Background_Sigma,
+			      result->Threshold);
+#endif
+	/* split into row bands */
+	band_count = Source_Find_Data.Thread_Count;
+	if(band_count > nrows)
+		band_count = nrows;
+	memset(band_list,0,sizeof(band_list));
+	for(band_index = 0; band_index < band_count; band_index++)
+	{
+		band_list[band_index].Image_Data = image_data;
+		band_list[band_index].NCols = ncols;
+		band_list[band_index].Start_Row = (band_index*nrows)/band_count;
+		band_list[band_index].End_Row = ((band_index+1)*nrows)/band_count;
+		band_list[band_index].Background = result->Background;
+		band_list[band_index].Threshold = (int)(result->Threshold);
+		/* bands 1.. are labelled by new threads, band 0 in this thread */
+		if(band_index > 0)
+		{
+			retval = pthread_create(&(band_list[band_index].Thread),NULL,Source_Find_Band_Thread,
+						(void *)&(band_list[band_index]));
+			band_list[band_index].Thread_Started = (retval == 0);
+		}
+	}
+	Source_Find_Band_Thread((void *)&(band_list[0]));
+	for(band_index = 1; band_index < band_count; band_index++)
+	{
+		if(band_list[band_index].Thread_Started)
+			pthread_join(band_list[band_index].Thread,NULL);
+		else
+			Source_Find_Band_Thread((void *)&(band_list[band_index]));
+	}
+	/* check bands succeeded, and work out where each band's labels go in the combined list */
+	success = TRUE;
+	label_count = 0;
+	for(band_index = 0; band_index < band_count; band_index++)
+	{
+		if(band_list[band_index].Success == FALSE)
+			success = FALSE;
+		label_offset[band_index] = label_count;
+		label_count += band_list[band_index].Label_Count;
+	}
+	if(success)
+	{
+		label_list = (struct Source_Find_Label_Struct *)malloc(label_count*
+								       sizeof(struct Source_Find_Label_Struct));
+		if(label_list == NULL)
+		{
+			Source_Find_Error_Number = 8;
+			sprintf(Source_Find_Error_String,"CCD_Source_Find:Failed to allocate %d labels.",label_count);
+			success = FALSE;
+		}
+	}
+	else
+	{
+		Source_Find_Error_Number = 9;
+		sprintf(Source_Find_Error_String,"CCD_Source_Find:Failed to allocate memory whilst labelling.");
+	}
+	if(success)
+	{
+		/* combine band labels, offsetting parents into the combined list */
+		for(band_index = 0; band_index < band_count; band_index++)
+		{
+			for(label_index = 0; label_index < band_list[band_index].Label_Count; label_index++)
+			{
+				label_list[label_offset[band_index]+label_index] =
+					band_list[band_index].Label_List[label_index];
+				label_list[label_offset[band_index]+label_index].Parent += label_offset[band_index];
+			}
+		}
+		/* merge objects touching across band boundaries (8-connectivity) */
+		for(band_index = 1; band_index < band_count; band_index++)
+		{
+			for(x = 0; x < ncols; x++)
+			{
+				if(band_list[band_index].First_Row_Labels[x] == 0)
+					continue;
+				for(dx = -1; dx <= 1; dx++)
+				{
+					if(((x+dx) < 0)||((x+dx) >= ncols))
+						continue;
+					if(band_list[band_index-1].Last_Row_Labels[x+dx] == 0)
+						continue;
+					Source_Find_Label_Union(label_list,
+					     label_offset[band_index]+band_list[band_index].First_Row_Labels[x],
+					     label_offset[band_index-1]+band_list[band_index-1].Last_Row_Labels[x+dx]);
+				}
+			}
+		}
+		/* add each label's moments to it's root */
+		for(label_index = 0; label_index < label_count; label_index++)
+		{
+			label = &(label_list[label_index]);
+			if(label->Pixel_Count == 0)
+				continue;
+			root = Source_Find_Label_Root_Get(label_list,label_index);
+			if(root == label_index)
+				continue;
+			label_list[root].Flux += label->Flux;
+			label_list[root].Sum_X += label->Sum_X;
+			label_list[root].Sum_Y += label->Sum_Y;
+			label_list[root].Pixel_Count += label->Pixel_Count;
+			if(label->Peak > label_list[root].Peak)
+				label_list[root].Peak = label->Peak;
+			label->Pixel_Count = 0;
+		}
+		/* find the brightest object */
+		brightest_label = -1;
+		for(label_index = 0; label_index < label_count; label_index++)
+		{
+			label = &(label_list[label_index]);
+			if((label->Parent != label_index)||(label->Pixel_Count < Source_Find_Data.Min_Pixel_Count)||
+			   (label->Flux <= 0.0))
+				continue;
+			result->Object_Count++;
+			if((brightest_label < 0)||(label->Flux > label_list[brightest_label].Flux))
+				brightest_label = label_index;
+		}
+		if(brightest_label > -1)
+		{
+			label = &(label_list[brightest_label]);
+			result->Brightest.X = (label->Sum_X/label->Flux)+1.0;
+			result->Brightest.Y = (label->Sum_Y/label->Flux)+1.0;
+			result->Brightest.Flux = label->Flux;
+			result->Brightest.Peak = label->Peak;
+			result->Brightest.Pixel_Count = label->Pixel_Count;
+			result->Brightest.Is_Saturated = (label->Peak >= SOURCE_FIND_SATURATION_COUNTS);
+		}
+	}
+	/* free allocated memory */
+	if(label_list != NULL)
+		free(label_list);
+	for(band_index = 0; band_index < band_count; band_index++)
+	{
+		if(band_list[band_index].First_Row_Labels != NULL)
+			free(band_list[band_index].First_Row_Labels);
+		if(band_list[band_index].Last_Row_Labels != NULL)
+			free(band_list[band_index].Last_Row_Labels);
+		if(band_list[band_index].Label_List != NULL)
+			free(band_list[band_index].Label_List);
+	}
+	if(success == FALSE)
+		return FALSE;
+	clock_gettime(CLOCK_REALTIME,&end_time);
+	result->Elapsed_Time = fdifftime(end_time,start_time);
+#if LOGGING > 4
+	CCD_Global_Log_Format(LOG_VERBOSITY_VERBOSE,"CCD_Source_Find:Found %d objects in %d bands in %.3f seconds:"
+			      "brightest at (%.2f,%.2f) flux %.1f peak %d pixels %d.",result->Object_Count,band_count,
+			      result->Elapsed_Time,result->Brightest.X,result->Brightest.Y,result->Brightest.Flux,
+			      result->Brightest.Peak,result->Brightest.Pixel_Count);
+#endif
+	return TRUE;
+}
+
+/**
+ * Routine called after a full frame has been read out and de-interlaced, but before it is saved to disk.
+ * If the source finder is enabled, CCD_Source_Find is run on the frame and the result kept for
+ * CCD_Source_Find_Get_Last_Result. If the source finder is disabled, this routine does nothing.
+ * @param image_data The de-interlaced frame, ncols by nrows unsigned shorts, row 0 first.
+ * @param ncols The number of binned columns in the frame.
+ * @param nrows The number of binned rows in the frame.
+ * @return The routine returns TRUE on success (or if the source finder is disabled), and FALSE if an error occurs.
+ * @see #Source_Find_Data
+ * @see #CCD_Source_Find
+ * @see #CCD_Source_Find_Get_Last_Result
+ */
+int CCD_Source_Find_Post_Readout(unsigned short *image_data,int ncols,int nrows)
+{
+	if(Source_Find_Data.Enable == FALSE)
+		return TRUE;
+	Source_Find_Data.Last_Result_Valid = FALSE;
+	if(!CCD_Source_Find(image_data,ncols,nrows,&(Source_Find_Data.Last_Result)))
+		return FALSE;
+	Source_Find_Data.Last_Result_Valid = TRUE;
+	return TRUE;
+}
+
+/**
+ * Routine to retrieve the result of running the source finder on the last frame read out.
+ * @param result The address of a structure to fill in with the results.
+ * @return The routine returns TRUE on success, and FALSE if no frame has been successfully processed since
+ *         the source finder was enabled.
+ * @see #Source_Find_Data
+ * @see #CCD_Source_Find_Set_Enable
+ */
+int CCD_Source_Find_Get_Last_Result(struct CCD_Source_Find_Result_Struct *result)
+{
+	Source_Find_Error_Number = 0;
+	if(result == NULL)
+	{
+		Source_Find_Error_Number = 10;
+		sprintf(Source_Find_Error_String,"CCD_Source_Find_Get_Last_Result:result was NULL.");
+		return FALSE;
+	}
+	if(Source_Find_Data.Last_Result_Valid == FALSE)
+	{
+		Source_Find_Error_Number = 11;
+		sprintf(Source_Find_Error_String,"CCD_Source_Find_Get_Last_Result:"
+			"No frame processed since the source finder was enabled.");
+		return FALSE;
+	}
+	(*result) = Source_Find_Data.Last_Result;
+	return TRUE;
+}
+
+/**
+ * Estimate the background level and it's standard deviation. A histogram is made of a regular sub-sample
+ * of around SOURCE_FIND_BACKGROUND_SAMPLE_COUNT pixels. The background is the median of the histogram,
+ * and the standard deviation is derived from the median absolute deviation, which are both insensitive
+ * to the objects in the frame. It is also used by ccd_seeing.
+ * @param image_data The frame.
+ * @param ncols The number of columns in the frame.
+ * @param nrows The number of rows in the frame.
+ * @param background The address of a double to store the background level.
+ * @param background_sigma The address of a double to store the background standard deviation.
+ * @return The routine returns TRUE on success, and FALSE if an error occurs.
+ * @see #SOURCE_FIND_HISTOGRAM_BIN_COUNT
+ * @see #SOURCE_FIND_BACKGROUND_SAMPLE_COUNT
+ * @see #SOURCE_FIND_MAD_TO_SIGMA
+ * @see #SOURCE_FIND_MIN_BACKGROUND_SIGMA
+ */
+int CCD_Source_Find_Background_Get(unsigned short *image_data,int ncols,int nrows,double *background,
+				   double *background_sigma)
+{
+	unsigned int *histogram = NULL;
+	int stride,x,y,median,deviation,sample_count,half_count,count;
+
+	Source_Find_Error_Number = 0;
+	histogram = (unsigned int *)calloc(SOURCE_FIND_HISTOGRAM_BIN_COUNT,sizeof(unsigned int));
+	if(histogram == NULL)
+	{
+		Source_Find_Error_Number = 12;
+		sprintf(Source_Find_Error_String,"CCD_Source_Find_Background_Get:Failed to allocate histogram.");
+		return FALSE;
+	}
+	/* sample every stride'th pixel in every stride'th row */
+	stride = (int)sqrt(((double)ncols*(double)nrows)/SOURCE_FIND_BACKGROUND_SAMPLE_COUNT);
+	if(stride < 1)
+		stride = 1;
+	sample_count = 0;
+	for(y = 0; y < nrows; y += stride)
+	{
+		for(x = 0; x < ncols; x += stride)
+		{
+			histogram[image_data[(y*ncols)+x]]++;
+			sample_count++;
+		}
+	}
+	/* median */
+	half_count = (sample_count+1)/2;
+	count = 0;
+	for(median = 0; median < SOURCE_FIND_HISTOGRAM_BIN_COUNT; median++)
+	{
+		count += histogram[median];
+		if(count >= half_count)
+			break;
+	}
+	/* median absolute deviation: grow a window around the median until it holds half the samples */
+	count = histogram[median];
+	deviation = 0;
+	while((count < half_count)&&(deviation < SOURCE_FIND_HISTOGRAM_BIN_COUNT))
+	{
+		deviation++;
+		if((median-deviation) >= 0)
+			count += histogram[median-deviation];
+		if((median+deviation) < SOURCE_FIND_HISTOGRAM_BIN_COUNT)
+			count += histogram[median+deviation];
+	}
+	free(histogram);
+	(*background) = (double)median;
+	(*background_sigma) = SOURCE_FIND_MAD_TO_SIGMA*((double)deviation);
+	if((*background_sigma) < SOURCE_FIND_MIN_BACKGROUND_SIGMA)
+		(*background_sigma) = SOURCE_FIND_MIN_BACKGROUND_SIGMA;
+	return TRUE;
+}
+
+/**
+ * Get the current value of the error number.
+ * @return The current value of the error number.
+ * @see #Source_Find_Error_Number
+ */
+int CCD_Source_Find_Get_Error_Number(void)
+{
+	return Source_Find_Error_Number;
+}
+
+/**
+ * The error routine that reports any errors occuring in ccd_source_find in a standard way.
+ * @see ccd_global.html#CCD_Global_Get_Current_Time_String
+ * @see #Source_Find_Error_Number
+ * @see #Source_Find_Error_String
+ */
+void CCD_Source_Find_Error(void)
+{
+	char time_string[32];
+
+	CCD_Global_Get_Current_Time_String(time_string,32);
+	/* if the error number is zero an error message has not been set up
+	** This is in itself an error as we should not be calling this routine
+	** without there being an error to display */
+	if(Source_Find_Error_Number == 0)
+		sprintf(Source_Find_Error_String,"Logic Error:No Error defined");
+	fprintf(stderr,"%s CCD_Source_Find:Error(%d) : %s\n",time_string,
+		Source_Find_Error_Number,Source_Find_Error_String);
+}
+
+/**
+ * The error routine that reports any errors occuring in ccd_source_find in a standard way. This routine places the
+ * generated error string at the end of a passed in string argument.
+ * @param error_string A string to put the generated error in. This string should be initialised before
+ * 	being passed to this routine. The routine will try to concatenate it's error string onto the end
+ * 	of any string already in existance.
+ * @see ccd_global.html#CCD_Global_Get_Current_Time_String
+ */
+void CCD_Source_Find_Error_String(char *error_string)
+{
+	char time_string[32];
+
+	CCD_Global_Get_Current_Time_String(time_string,32);
+	/* if the error number is zero an error message has not been set up
+	** This is in itself an error as we should not be calling this routine
+	** without there being an error to display */
+	if(Source_Find_Error_Number == 0)
+		sprintf(Source_Find_Error_String,"Logic Error:No Error defined");
+	sprintf(error_string+strlen(error_string),"%s CCD_Source_Find:Error(%d) : %s\n",time_string,
+		Source_Find_Error_Number,Source_Find_Error_String);
+}
+
+/* -----------------------------------------------------------------------------
+** 	internal functions
+** ----------------------------------------------------------------------------- */
+/**
+ * Thread routine that labels the pixels above the threshold in one row band of a frame.
+ * Each pixel above the threshold takes the label of it's already labelled neighbours (left, and the three
+ * above it), merging their labels if they differ, or gets a new label if it has none. Only two rows of labels
+ * are kept, plus a copy of the first row for merging bands. On return, band->Last_Row_Labels holds the
+ * labels of the last row. The pixel's flux above the background and flux weighted position are added to
+ * it's label's moments.
+ * @param user_arg A pointer to the Source_Find_Band_Struct to label.
+ * @return Always NULL. band->Success is set to TRUE if the labelling succeeded.
+ * @see #Source_Find_Band_Label_New
+ * @see #Source_Find_Label_Root_Get
+ * @see #Source_Find_Label_Union
+ */
+static void *Source_Find_Band_Thread(void *user_arg)
+{
+	struct Source_Find_Band_Struct *band = NULL;
+	struct Source_Find_Label_Struct *label = NULL;
+	unsigned short *row_data = NULL;
+	int *previous_row_labels = NULL;
+	int *current_row_labels = NULL;
+	int *swap_row_labels = NULL;
+	int x,y,ncols,neighbour_index,neighbour,label_index,root;
+	int neighbour_list[4];
+	double flux;
+
+	band = (struct Source_Find_Band_Struct *)user_arg;
+	band->Success = FALSE;
+	ncols = band->NCols;
+	band->First_Row_Labels = (int *)malloc(ncols*sizeof(int));
+	previous_row_labels = (int *)calloc(ncols,sizeof(int));
+	current_row_labels = (int *)calloc(ncols,sizeof(int));
+	if((band->First_Row_Labels == NULL)||(previous_row_labels == NULL)||(current_row_labels == NULL))
+	{
+		if(previous_row_labels != NULL)
+			free(previous_row_labels);
+		if(current_row_labels != NULL)
+			free(current_row_labels);
+		return NULL;
+	}
+	/* label 0 is the background */
+	band->Label_Count = 0;
+	band->Label_Allocated_Count = 0;
+	band->Label_List = NULL;
+	if(Source_Find_Band_Label_New(band) != 0)
+	{
+		free(previous_row_labels);
+		free(current_row_labels);
+		return NULL;
+	}
+	for(y = band->Start_Row; y < band->End_Row; y++)
+	{
+		row_data = band->Image_Data+(y*ncols);
+		for(x = 0; x < ncols; x++)
+		{
+			if(row_data[x] <= band->Threshold)
+			{
+				current_row_labels[x] = 0;
+				continue;
+			}
+			/* previous_row_labels is all zero for the first row in the band */
+			neighbour_list[0] = (x > 0) ? current_row_labels[x-1] : 0;
+			neighbour_list[1] = (x > 0) ? previous_row_labels[x-1] : 0;
+			neighbour_list[2] = previous_row_labels[x];
+			neighbour_list[3] = (x < (ncols-1)) ? previous_row_labels[x+1] : 0;
+			label_index = 0;
+			for(neighbour_index = 0; neighbour_index < 4; neighbour_index++)
+			{
+				neighbour = neighbour_list[neighbour_index];
+				if(neighbour == 0)
+					continue;
+				if(label_index == 0)
+					label_index = Source_Find_Label_Root_Get(band->Label_List,neighbour);
+				else
+					label_index = Source_Find_Label_Union(band->Label_List,label_index,neighbour);
+			}
+			if(label_index == 0)
+			{
+				label_index = Source_Find_Band_Label_New(band);
+				if(label_index < 0)
+				{
+					free(previous_row_labels);
+					free(current_row_labels);
+					return NULL;
+				}
+			}
+			current_row_labels[x] = label_index;
+			label = &(band->Label_List[label_index]);
+			flux = ((double)row_data[x])-band->Background;
+			label->Flux += flux;
+			label->Sum_X += flux*((double)x);
+			label->Sum_Y += flux*((double)y);
+			label->Pixel_Count++;
+			if(row_data[x] > label->Peak)
+				label->Peak = row_data[x];
+		}
+		if(y == band->Start_Row)
+			memcpy(band->First_Row_Labels,current_row_labels,ncols*sizeof(int));
+		swap_row_labels = previous_row_labels;
+		previous_row_labels = current_row_labels;
+		current_row_labels = swap_row_labels;
+	}
+	/* labels are only resolved to their root when merging bands, so resolve the boundary rows now */
+	for(x = 0; x < ncols; x++)
+	{
+		if(band->First_Row_Labels[x] != 0)
+			band->First_Row_Labels[x] = Source_Find_Label_Root_Get(band->Label_List,
+									       band->First_Row_Labels[x]);
+		if(previous_row_labels[x] != 0)
+		{
+			root = Source_Find_Label_Root_Get(band->Label_List,previous_row_labels[x]);
+			previous_row_labels[x] = root;
+		}
+	}
+	band->Last_Row_Labels = previous_row_labels;
+	free(current_row_labels);
+	band->Success = TRUE;
+	return NULL;
+}
+
+/**
+ * Add a new label to a band's label list, growing the list if necessary. The new label is it's own root,
+ * with zero moments.
+ * @param band The band to add the label to.
+ * @return The index of the new label, or -1 if the label list could not be grown.
+ * @see #SOURCE_FIND_INITIAL_LABEL_COUNT
+ */
+static int Source_Find_Band_Label_New(struct Source_Find_Band_Struct *band)
+{
+	struct Source_Find_Label_Struct *label_list = NULL;
+	int allocated_count,label_index;
+
+	if(band->Label_Count >= band->Label_Allocated_Count)
+	{
+		if(band->Label_Allocated_Count == 0)
+			allocated_count = SOURCE_FIND_INITIAL_LABEL_COUNT;
+		else
+			allocated_count = band->Label_Allocated_Count*2;
+		label_list = (struct Source_Find_Label_Struct *)realloc(band->Label_List,allocated_count*
+								      sizeof(struct Source_Find_Label_Struct));
+		if(label_list == NULL)
+			return -1;
+		band->Label_List = label_list;
+		band->Label_Allocated_Count = allocated_count;
+	}
+	label_index = band->Label_Count++;
+	memset(&(band->Label_List[label_index]),0,sizeof(struct Source_Find_Label_Struct));
+	band->Label_List[label_index].Parent = label_index;
+	return label_index;
+}
+
+/**
+ * Find the root label of a label, compressing the path to the root as we go.
+ * @param label_list The list of labels.
+ * @param label The label to find the root of.
+ * @return The root label.
+ */
+static int Source_Find_Label_Root_Get(struct Source_Find_Label_Struct *label_list,int label)
+{
+	while(label_list[label].Parent != label)
+	{
+		label_list[label].Parent = label_list[label_list[label].Parent].Parent;
+		label = label_list[label].Parent;
+	}
+	return label;
+}
+
+/**
+ * Merge two labels, by making the root with the larger index a child of the root with the smaller index.
+ * Moments are not moved, they are added to the root once all labelling is complete.
+ * @param label_list The list of labels.
+ * @param label1 The first label.
+ * @param label2 The second label.
+ * @return The root of the merged label.
+ * @see #Source_Find_Label_Root_Get
+ */
+static int Source_Find_Label_Union(struct Source_Find_Label_Struct *label_list,int label1,int label2)
+{
+	int root1,root2;
+
+	root1 = Source_Find_Label_Root_Get(label_list,label1);
+	root2 = Source_Find_Label_Root_Get(label_list,label2);
+	if(root1 == root2)
+		return root1;
+	if(root1 < root2)
+	{
+		label_list[root2].Parent = root1;
+		return root1;
+	}
+	label_list[root1].Parent = root2;
+	return root2;
+}
+
+/*
+** $Log: not supported by cvs2svn $
+*/
@@ -0,0 +1,385 @@
+/* ccd_status.c
+** Batched status module.
+** $Header$
+*/
+/**
+ * ccd_status fills in a CCD_Status_Struct with all the values a status request needs (setup dimensions,
+ * exposure status and times, elapsed exposure time, temperatures and supply voltages) in one call, so a client
+ * (i.e. the Java layer's GET_STATUS implementation) does not have to make a separate call for each value.
+ * <ul>
+ * <li>The setup and exposure values are read from the interface handle together. If the exposure status
+ *     changes whilst the snapshot is being taken, they are read again, so they always describe the same phase
+ *     of the exposure.
+ * <li>The temperatures and supply voltages are copied from the telemetry sampler's snapshot if the sampler
+ *     is running, which does not involve the controller at all. Otherwise they are read from the controller.
+ * <li>Callers are serialised by a module mutex, so concurrent status requests do not interleave their
+ *     controller commands.
+ * </ul>
+ * @author Chris Mottram
+ * @version $Revision$
+ */
+/**
+ * This hash define is needed before including source files give us POSIX.4/IEEE1003.1b-1993 prototypes.
+ */
+#define _POSIX_SOURCE 1
+/**
+ * This hash define is needed before including source files give us POSIX.4/IEEE1003.1b-1993 prototypes.
+ */
+#define _POSIX_C_SOURCE 199309L
+#include <errno.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "log_udp.h"
+#include "ccd_global.h"
+#include "ccd_dsp.h"
+#include "ccd_exposure.h"
+#include "ccd_setup.h"
+#include "ccd_telemetry.h"
+#include "ccd_temperature.h"
+#include "ccd_status.h"
+
+/* hash defines */
+/**
+ * The number of times CCD_Status_Get re-reads the setup and exposure values, if the exposure status
+ * keeps changing whilst they are being read.
+ * @see #CCD_Status_Get
+ */
+#define STATUS_MAX_RETRY_COUNT		(3)
+
+/**
+ * Revision Control System identifier.
+ */
+static char rcsid[] = "$Id$";
+
+/* data types */
+/**
+ * Data type holding local data to ccd_status.
+ * <dl>
+ * <dt>Mutex</dt> <dd>Held for the whole of CCD_Status_Get, so only one snapshot is taken at a time.</dd>
+ * </dl>
+ */
+struct Status_Struct
+{
+	pthread_mutex_t Mutex;
+};
+
+/* internal variables */
+/**
+ * Variable holding error code of last operation performed by ccd_status.
+ */
+static int Status_Error_Number = 0;
+/**
+ * Local variable holding description of the last error that occured.
+ */
+static char Status_Error_String[CCD_GLOBAL_ERROR_STRING_LENGTH] = "";
+/**
+ * Local status data.
+ * @see #Status_Struct
+ */
+static struct Status_Struct Status_Data =
+{
+	PTHREAD_MUTEX_INITIALIZER
+};
+
+/* internal function definitions */
+static void Status_Handle_Get(CCD_Interface_Handle_T* handle,struct CCD_Status_Struct *status);
+static void Status_Elapsed_Exposure_Time_Get(CCD_Interface_Handle_T* handle,struct CCD_Status_Struct *status);
+static void Status_Cached_Get(struct CCD_Telemetry_Struct *telemetry,int flags,struct CCD_Status_Struct *status);
+static void Status_Live_Temperature_Get(CCD_Interface_Handle_T* handle,struct CCD_Status_Struct *status);
+static void Status_Live_Supply_Voltage_Get(CCD_Interface_Handle_T* handle,struct CCD_Status_Struct *status);
+
+/* -----------------------------------------------------------------------------
+**     external functions
+** ----------------------------------------------------------------------------- */
+/**
+ * This routine sets up ccd_status internal variables.
+ * It should be called at startup.
+ * @return This routine returns TRUE for success.
+ */
+int CCD_Status_Initialise(void)
+{
+	Status_Error_Number = 0;
+/* print some compile time information to stdout */
+	fprintf(stdout,"CCD_Status_Initialise:%s.\n",rcsid);
+	return TRUE;
+}
+
+/**
+ * Routine to fill in a status snapshot.
+ * <ul>
+ * <li>The setup and exposure values are read from the handle.
+ * <li>If CCD_STATUS_FLAG_ELAPSED_EXPOSURE_TIME is set, the elapsed exposure time is read from the controller.
+ * <li>The exposure status is read again. If it has changed, the setup and exposure values are re-read
+ *     (up to STATUS_MAX_RETRY_COUNT times).
+ * <li>If CCD_STATUS_FLAG_TEMPERATURE or CCD_STATUS_FLAG_SUPPLY_VOLTAGE is set, the telemetry snapshot is
+ *     retrieved. If the sampler is running, the values are copied from it, otherwise they are read from the
+ *     controller.
+ * </ul>
+ * A controller read failing does not make this routine fail: the relevant Valid member is left FALSE, and the
+ * error numbers are recorded in the status structure.
+ * @param handle The address of a CCD_Interface_Handle_T that holds the device connection specific information.
+ * @param flags A bit mask of CCD_STATUS_FLAG_ELAPSED_EXPOSURE_TIME, CCD_STATUS_FLAG_TEMPERATURE and
+ *        CCD_STATUS_FLAG_SUPPLY_VOLTAGE, saying which controller values to get.
+ * @param status The address of a CCD_Status_Struct to fill in.
+ * @return The routine returns TRUE if the snapshot was filled in, and FALSE if an error occured.
+ * @see #Status_Data
+ * @see #STATUS_MAX_RETRY_COUNT
+ * @see #Status_Handle_Get
+ * @see #Status_Elapsed_Exposure_Time_Get
+ * @see #Status_Cached_Get
+ * @see #Status_Live_Temperature_Get
+ * @see #Status_Live_Supply_Voltage_Get
+ * @see ccd_exposure.html#CCD_Exposure_Get_Exposure_Status
+ * @see ccd_telemetry.html#CCD_Telemetry_Get
+ */
+int CCD_Status_Get(CCD_Interface_Handle_T* handle,int flags,struct CCD_Status_Struct *status)
+{
+	struct CCD_Telemetry_Struct telemetry;
+	int retry_count;
+
+	Status_Error_Number = 0;
+#if LOGGING > 9
+	CCD_Global_Log_Format(LOG_VERBOSITY_VERY_VERBOSE,"CCD_Status_Get(flags=%#x) started.",flags);
+#endif
+	if(handle == NULL)
+	{
+		Status_Error_Number = 1;
+		sprintf(Status_Error_String,"CCD_Status_Get:Handle was NULL.");
+		return FALSE;
+	}
+	if(status == NULL)
+	{
+		Status_Error_Number = 2;
+		sprintf(Status_Error_String,"CCD_Status_Get:status was NULL.");
+		return FALSE;
+	}
+	memset(status,0,sizeof(struct CCD_Status_Struct));
+	pthread_mutex_lock(&(Status_Data.Mutex));
+	Status_Handle_Get(handle,status);
+	if(flags & CCD_STATUS_FLAG_ELAPSED_EXPOSURE_TIME)
+		Status_Elapsed_Exposure_Time_Get(handle,status);
+	/* if the exposure moved on whilst we were reading, re-read the handle values so they match */
+	retry_count = 0;
+	while((CCD_Exposure_Get_Exposure_Status(handle) != status->Exposure_Status)&&
+	      (retry_count < STATUS_MAX_RETRY_COUNT))
+	{
+		Status_Handle_Get(handle,status);
+		retry_count++;
+	}
+	if(flags & (CCD_STATUS_FLAG_TEMPERATURE|CCD_STATUS_FLAG_SUPPLY_VOLTAGE))
+	{
+		if(CCD_Telemetry_Get(&telemetry) && telemetry.Running)
+			Status_Cached_Get(&telemetry,flags,status);
+		else
+		{
+			if(flags & CCD_STATUS_FLAG_TEMPERATURE)
+				Status_Live_Temperature_Get(handle,status);
+			if(flags & CCD_STATUS_FLAG_SUPPLY_VOLTAGE)
+				Status_Live_Supply_Voltage_Get(handle,status);
+		}
+	}
+	pthread_mutex_unlock(&(Status_Data.Mutex));
+#if LOGGING > 9
+	CCD_Global_Log_Format(LOG_VERBOSITY_VERY_VERBOSE,"CCD_Status_Get:exposure status %d:retry count %d:"
+			      "telemetry running %d:returned TRUE.",status->Exposure_Status,retry_count,
+			      status->Telemetry_Running);
+#endif
+	return TRUE;
+}
+
+/**
+ * Get the current value of the error number.
+ * @return The current value of the error number.
+ */
+int CCD_Status_Get_Error_Number(void)
+{
+	return Status_Error_Number;
+}
+
+/**
+ * The error routine that reports any errors occuring in ccd_status in a standard way.
+ * @see ccd_global.html#CCD_Global_Get_Current_Time_String
+ */
+void CCD_Status_Error(void)
+{
+	char time_string[32];
+
+	CCD_Global_Get_Current_Time_String(time_string,32);
+	/* if the error number is zero an error message has not been set up
+	** This is in itself an error as we should not be calling this routine
+	** without there being an error to display */
+	if(Status_Error_Number == 0)
+		sprintf(Status_Error_String,"Logic Error:No Error defined");
+	fprintf(stderr,"%s CCD_Status:Error(%d) : %s\n",time_string,Status_Error_Number,Status_Error_String);
+}
+
+/**
+ * The error routine that reports any errors occuring in ccd_status in a standard way. This routine
+ * places the generated error string at the end of a passed in string argument.
+ * @param error_string A string to put the generated error in. This string should be initialised before
+ * being passed to this routine. The routine will try to concatenate it's error string onto the end
+ * of any string already in existance.
+ * @see ccd_global.html#CCD_Global_Get_Current_Time_String
+ */
+void CCD_Status_Error_String(char *error_string)
+{
+	char time_string[32];
+
+	CCD_Global_Get_Current_Time_String(time_string,32);
+	/* if the error number is zero an error message has not been set up
+	** This is in itself an error as we should not be calling this routine
+	** without there being an error to display */
+	if(Status_Error_Number == 0)
+		sprintf(Status_Error_String,"Logic Error:No Error defined");
+	sprintf(error_string+strlen(error_string),"%s CCD_Status:Error(%d) : %s\n",time_string,
+		Status_Error_Number,Status_Error_String);
+}
+
+/* -----------------------------------------------------------------------------
+**     internal functions
+** ----------------------------------------------------------------------------- */
+/**
+ * Read the setup and exposure values stored in the interface handle. This does not communicate with the
+ * controller.
+ * @param handle The address of a CCD_Interface_Handle_T that holds the device connection specific information.
+ * @param status The address of the status structure to fill in.
+ * @see ccd_exposure.html#CCD_Exposure_Get_Exposure_Status
+ * @see ccd_exposure.html#CCD_Exposure_Get_Exposure_Length
+ * @see ccd_exposure.html#CCD_Exposure_Get_Exposure_Start_Time
+ * @see ccd_setup.html#CCD_Setup_Get_Setup_Complete
+ * @see ccd_setup.html#CCD_Setup_Get_Setup_In_Progress
+ * @see ccd_setup.html#CCD_Setup_Get_Binned_NCols
+ * @see ccd_setup.html#CCD_Setup_Get_Binned_NRows
+ * @see ccd_setup.html#CCD_Setup_Get_NSBin
+ * @see ccd_setup.html#CCD_Setup_Get_NPBin
+ * @see ccd_setup.html#CCD_Setup_Get_Window_Flags
+ */
+static void Status_Handle_Get(CCD_Interface_Handle_T* handle,struct CCD_Status_Struct *status)
+{
+	status->Exposure_Status = CCD_Exposure_Get_Exposure_Status(handle);
+	status->Exposure_Length = CCD_Exposure_Get_Exposure_Length(handle);
+	status->Exposure_Start_Time = CCD_Exposure_Get_Exposure_Start_Time(handle);
+	status->Setup_Complete = CCD_Setup_Get_Setup_Complete(handle);
+	status->Setup_In_Progress = CCD_Setup_Get_Setup_In_Progress(handle);
+	status->Binned_NCols = CCD_Setup_Get_Binned_NCols(handle);
+	status->Binned_NRows = CCD_Setup_Get_Binned_NRows(handle);
+	status->X_Bin = CCD_Setup_Get_NSBin(handle);
+	status->Y_Bin = CCD_Setup_Get_NPBin(handle);
+	status->Window_Flags = CCD_Setup_Get_Window_Flags(handle);
+}
+
+/**
+ * Read the elapsed exposure time from the controller. This fails whilst the controller is reading out.
+ * @param handle The address of a CCD_Interface_Handle_T that holds the device connection specific information.
+ * @param status The address of the status structure to fill in.
+ * @see ccd_dsp.html#CCD_DSP_Command_RET
+ * @see ccd_dsp.html#CCD_DSP_Get_Error_Number
+ */
+static void Status_Elapsed_Exposure_Time_Get(CCD_Interface_Handle_T* handle,struct CCD_Status_Struct *status)
+{
+	int elapsed_exposure_time;
+
+	elapsed_exposure_time = CCD_DSP_Command_RET(handle);
+	if((elapsed_exposure_time == 0)&&(CCD_DSP_Get_Error_Number() != 0))
+	{
+		status->Elapsed_Exposure_Time_Valid = FALSE;
+		status->Elapsed_Exposure_Time = 0;
+		status->Elapsed_Exposure_Time_DSP_Error_Number = CCD_DSP_Get_Error_Number();
+	}
+	else
+	{
+		status->Elapsed_Exposure_Time_Valid = TRUE;
+		status->Elapsed_Exposure_Time = elapsed_exposure_time;
+	}
+}
+
+/**
+ * Copy the requested temperature and supply voltage values from the telemetry sampler's snapshot.
+ * A group that has never been sampled is left invalid.
+ * @param telemetry The address of the telemetry snapshot.
+ * @param flags The flags passed to CCD_Status_Get.
+ * @param status The address of the status structure to fill in.
+ * @see ccd_telemetry.html#CCD_Telemetry_Age_Get
+ */
+static void Status_Cached_Get(struct CCD_Telemetry_Struct *telemetry,int flags,struct CCD_Status_Struct *status)
+{
+	status->Telemetry_Running = TRUE;
+	if((flags & CCD_STATUS_FLAG_TEMPERATURE)&&(telemetry->Temperature_Timestamp.tv_sec != 0))
+	{
+		status->Temperature_Valid = TRUE;
+		status->Temperature = telemetry->Temperature;
+		status->Temperature_ADU_Valid = TRUE;
+		status->Heater_ADU = telemetry->Heater_ADU;
+		status->Utility_Board_ADU = telemetry->Utility_Board_ADU;
+		status->Temperature_Age = CCD_Telemetry_Age_Get(telemetry->Temperature_Timestamp);
+	}
+	if((flags & CCD_STATUS_FLAG_SUPPLY_VOLTAGE)&&(telemetry->Supply_Voltage_Timestamp.tv_sec != 0))
+	{
+		status->Supply_Voltage_Valid = TRUE;
+		status->High_Voltage_ADU = telemetry->High_Voltage_ADU;
+		status->Low_Voltage_ADU = telemetry->Low_Voltage_ADU;
+		status->Minus_Low_Voltage_ADU = telemetry->Minus_Low_Voltage_ADU;
+		status->Supply_Voltage_Age = CCD_Telemetry_Age_Get(telemetry->Supply_Voltage_Timestamp);
+	}
+}
+
+/**
+ * Read the temperature, heater ADU and utility board ADU from the controller. These involve reads of the
+ * utility board, which fail whilst exposing. The temperature and the ADUs are read (and marked valid)
+ * separately, as before.
+ * @param handle The address of a CCD_Interface_Handle_T that holds the device connection specific information.
+ * @param status The address of the status structure to fill in.
+ * @see ccd_temperature.html#CCD_Temperature_Get
+ * @see ccd_temperature.html#CCD_Temperature_Get_Heater_ADU
+ * @see ccd_temperature.html#CCD_Temperature_Get_Utility_Board_ADU
+ */
+static void Status_Live_Temperature_Get(CCD_Interface_Handle_T* handle,struct CCD_Status_Struct *status)
+{
+	if(CCD_Temperature_Get(handle,&(status->Temperature)))
+		status->Temperature_Valid = TRUE;
+	else
+	{
+		status->Temperature_Error_Number = CCD_Temperature_Get_Error_Number();
+		status->Temperature_DSP_Error_Number = CCD_DSP_Get_Error_Number();
+	}
+	if(CCD_Temperature_Get_Heater_ADU(handle,&(status->Heater_ADU))&&
+	   CCD_Temperature_Get_Utility_Board_ADU(handle,&(status->Utility_Board_ADU)))
+	{
+		status->Temperature_ADU_Valid = TRUE;
+	}
+	else if(status->Temperature_Error_Number == 0)
+	{
+		status->Temperature_Error_Number = CCD_Temperature_Get_Error_Number();
+		status->Temperature_DSP_Error_Number = CCD_DSP_Get_Error_Number();
+	}
+}
+
+/**
+ * Read the SDSU supply voltage ADUs from the controller. These involve reads of the utility board,
+ * which fail whilst exposing.
+ * @param handle The address of a CCD_Interface_Handle_T that holds the device connection specific information.
+ * @param status The address of the status structure to fill in.
+ * @see ccd_setup.html#CCD_Setup_Get_High_Voltage_Analogue_ADU
+ * @see ccd_setup.html#CCD_Setup_Get_Low_Voltage_Analogue_ADU
+ * @see ccd_setup.html#CCD_Setup_Get_Minus_Low_Voltage_Analogue_ADU
+ */
+static void Status_Live_Supply_Voltage_Get(CCD_Interface_Handle_T* handle,struct CCD_Status_Struct *status)
+{
+	if(CCD_Setup_Get_High_Voltage_Analogue_ADU(handle,&(status->High_Voltage_ADU))&&
+	   CCD_Setup_Get_Low_Voltage_Analogue_ADU(handle,&(status->Low_Voltage_ADU))&&
+	   CCD_Setup_Get_Minus_Low_Voltage_Analogue_ADU(handle,&(status->Minus_Low_Voltage_ADU)))
+	{
+		status->Supply_Voltage_Valid = TRUE;
+	}
+	else
+	{
+		status->Supply_Voltage_Error_Number = CCD_Setup_Get_Error_Number();
+		status->Supply_Voltage_DSP_Error_Number = CCD_DSP_Get_Error_Number();
+	}
+}
+
+/*
+** $Log: not supported by cvs2svn $
+*/
@@ -0,0 +1,754 @@
+/* ccd_telemetry.c
+** Telemetry sampler module.
+** $Header$
+*/
+/**
+ * ccd_telemetry holds the routines for sampling controller telemetry (CCD temperature, heater and utility board
+ * ADUs, supply voltage ADUs and library state) in a background thread, and keeping a timestamped snapshot
+ * of the results. Readers can retrieve the snapshot without sending any commands to the controller,
+ * which means status can be returned at any point during an exposure, when the utility board cannot be read.
+ * Between samples the thread polls the library state (exposure and filter wheel status) every
+ * TELEMETRY_STATE_POLL_MS milliseconds, so status transitions are noticed promptly.
+ * If a telemetry store is open (see ccd_telemetry_store), every sample and state transition is also
+ * recorded in the store.
+ * The snapshot is protected by a sequence lock: the sampler thread (the only writer) increments a sequence
+ * number before and after updating the snapshot, and readers retry the copy if the sequence number was odd
+ * or changed during the copy. Readers therefore never block the sampler, or each other.
+ * The library's error numbers and strings are module globals, which the sampler's controller reads would
+ * overwrite. Callers (the JNI layer) therefore bracket each command and the reading of it's error with
+ * CCD_Telemetry_Command_Start and CCD_Telemetry_Command_End, and the sampler skips the controller reads
+ * of a sample whilst any command is active.
+ * @author Chris Mottram
+ * @version $Revision$
+ */
+/**
+ * This hash define is needed before including source files give us POSIX.4/IEEE1003.1b-1993 prototypes.
+ */
+#define _POSIX_SOURCE 1
+/**
+ * This hash define is needed before including source files give us POSIX.4/IEEE1003.1b-1993 prototypes.
+ */
+#define _POSIX_C_SOURCE 199309L
+#include <errno.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "log_udp.h"
+#include "ccd_global.h"
+#include "ccd_exposure.h"
+#include "ccd_filter_wheel.h"
+#include "ccd_readout_watchdog.h"
+#include "ccd_setup.h"
+#include "ccd_temperature.h"
+#include "ccd_telemetry.h"
+#include "ccd_telemetry_store.h"
+
+/**
+ * Revision Control System identifier.
+ */
+static char rcsid[] = "$Id$";
+
+/**
+ * The minimum period between telemetry samples we allow, in milliseconds. CCD_Temperature_Get on it's own
+ * takes around 100ms.
+ * @see #CCD_Telemetry_Start
+ */
+#define TELEMETRY_MIN_PERIOD_MS			(500)
+/**
+ * How often, in milliseconds, the sampler thread checks the library state (exposure and filter wheel status)
+ * for transitions between samples.
+ * @see #Telemetry_State_Poll
+ */
+#define TELEMETRY_STATE_POLL_MS			(100)
+
+/* data types */
+/**
+ * Data type holding local data to ccd_telemetry. This consists of the following:
+ * <dl>
+ * <dt>Sequence</dt> <dd>The sequence lock counter. This is odd whilst the snapshot is being updated.</dd>
+ * <dt>Snapshot</dt> <dd>The last published telemetry snapshot.</dd>
+ * <dt>Handle</dt> <dd>The interface handle the sampler thread uses to talk to the controller.</dd>
+ * <dt>Period_Ms</dt> <dd>The period between samples, in milliseconds.</dd>
+ * <dt>Thread</dt> <dd>The sampler thread.</dd>
+ * <dt>Thread_Active</dt> <dd>A boolean, TRUE between CCD_Telemetry_Start and CCD_Telemetry_Stop.</dd>
+ * <dt>Stop_Requested</dt> <dd>A boolean, set by CCD_Telemetry_Stop to tell the sampler thread to exit.</dd>
+ * <dt>Wait_Mutex</dt> <dd>Mutex used with Wait_Condition.</dd>
+ * <dt>Wait_Condition</dt> <dd>Condition variable the sampler thread waits on between samples,
+ *     signalled by CCD_Telemetry_Stop so the thread exits promptly.</dd>
+ * </dl>
+ * @see #CCD_Telemetry_Struct
+ */
+struct Telemetry_Struct
+{
+	volatile unsigned int Sequence;
+	struct CCD_Telemetry_Struct Snapshot;
+	CCD_Interface_Handle_T* Handle;
+	int Period_Ms;
+	pthread_t Thread;
+	int Thread_Active;
+	volatile int Stop_Requested;
+	pthread_mutex_t Wait_Mutex;
+	pthread_cond_t Wait_Condition;
+};
+
+/**
+ * Data type used to serialise the sampler's controller reads with commands from other threads.
+ * <dl>
+ * <dt>Mutex</dt> <dd>Mutex protecting the other fields, and used with Condition.</dd>
+ * <dt>Condition</dt> <dd>Condition variable signalled when the sampler finishes it's controller reads.</dd>
+ * <dt>Active_Count</dt> <dd>The number of commands between CCD_Telemetry_Command_Start and
+ *     CCD_Telemetry_Command_End.</dd>
+ * <dt>Sample_In_Progress</dt> <dd>A boolean, TRUE whilst the sampler is reading the controller.</dd>
+ * </dl>
+ * @see #CCD_Telemetry_Command_Start
+ * @see #CCD_Telemetry_Command_End
+ * @see #Telemetry_Sample
+ */
+struct Telemetry_Command_Struct
+{
+	pthread_mutex_t Mutex;
+	pthread_cond_t Condition;
+	int Active_Count;
+	int Sample_In_Progress;
+};
+
+/* internal variables */
+/**
+ * Variable holding error code of last operation performed by ccd_telemetry.
+ */
+static int Telemetry_Error_Number = 0;
+/**
+ * Local variable holding description of the last error that occured.
+ */
+static char Telemetry_Error_String[CCD_GLOBAL_ERROR_STRING_LENGTH] = "";
+/**
+ * Local telemetry data.
+ * @see #Telemetry_Struct
+ */
+static struct Telemetry_Struct Telemetry_Data;
+/**
+ * Command serialisation data. This is statically initialised, as commands can be started before
+ * CCD_Telemetry_Initialise is called.
+ * @see #Telemetry_Command_Struct
+ */
+static struct Telemetry_Command_Struct Telemetry_Command = 
+{
+	PTHREAD_MUTEX_INITIALIZER,PTHREAD_COND_INITIALIZER,0,FALSE
+};
+
+/* internal function definitions */
+static void *Telemetry_Thread(void *user_arg);
+static void Telemetry_Sample(void);
+static void Telemetry_State_Poll(void);
+static int Telemetry_State_Get(struct CCD_Telemetry_Struct *telemetry);
+static int Telemetry_Readout_Anomaly_Get(struct CCD_Telemetry_Struct *telemetry);
+static void Telemetry_Publish(struct CCD_Telemetry_Struct *telemetry);
+static void Telemetry_Store(struct CCD_Telemetry_Struct *telemetry,unsigned int flags);
+static int Telemetry_Sample_Read_Start(void);
+static void Telemetry_Sample_Read_End(void);
+
+/* -----------------------------------------------------------------------------
+**     external functions
+** ----------------------------------------------------------------------------- */
+/**
+ * This routine sets up ccd_telemetry internal variables.
+ * It should be called at startup, before CCD_Telemetry_Start.
+ * @return This routine returns TRUE for success.
+ * @see #Telemetry_Data
+ */
+int CCD_Telemetry_Initialise(void)
+{
+	Telemetry_Error_Number = 0;
+/* print some compile time information to stdout */
+	fprintf(stdout,"CCD_Telemetry_Initialise:%s.\n",rcsid);
+	if(Telemetry_Data.Thread_Active)
+		return TRUE;
+	memset(&Telemetry_Data,0,sizeof(Telemetry_Data));
+	Telemetry_Data.Snapshot.Exposure_Status = CCD_EXPOSURE_STATUS_NONE;
+	Telemetry_Data.Snapshot.Filter_Wheel_Status = CCD_FILTER_WHEEL_STATUS_NONE;
+	Telemetry_Data.Snapshot.Filter_Wheel_Position = -1;
+	Telemetry_Data.Period_Ms = CCD_TELEMETRY_DEFAULT_PERIOD_MS;
+	pthread_mutex_init(&(Telemetry_Data.Wait_Mutex),NULL);
+	pthread_cond_init(&(Telemetry_Data.Wait_Condition),NULL);
+	return TRUE;
+}
+
+/**
+ * Routine to start the telemetry sampler thread.
+ * @param handle The address of a CCD_Interface_Handle_T that holds the device connection specific information.
+ *        This must remain open until CCD_Telemetry_Stop has been called.
+ * @param period_ms The period between samples, in milliseconds. This must be at least TELEMETRY_MIN_PERIOD_MS.
+ * @return The routine returns TRUE if the thread was started, and FALSE if an error occured.
+ * @see #Telemetry_Data
+ * @see #Telemetry_Thread
+ * @see #TELEMETRY_MIN_PERIOD_MS
+ */
+int CCD_Telemetry_Start(CCD_Interface_Handle_T* handle,int period_ms)
+{
+	int retval;
+
+	Telemetry_Error_Number = 0;
+#if LOGGING > 0
+	CCD_Global_Log_Format(LOG_VERBOSITY_VERY_VERBOSE,"CCD_Telemetry_Start(period=%d ms) started.",period_ms);
+#endif
+	if(handle == NULL)
+	{
+		Telemetry_Error_Number = 1;
+		sprintf(Telemetry_Error_String,"CCD_Telemetry_Start:Handle was NULL.");
+		return FALSE;
+	}
+	if(period_ms < TELEMETRY_MIN_PERIOD_MS)
+	{
+		Telemetry_Error_Number = 2;
+		sprintf(Telemetry_Error_String,"CCD_Telemetry_Start:Illegal period %d ms (< %d ms).",period_ms,
+			TELEMETRY_MIN_PERIOD_MS);
+		return FALSE;
+	}
+	if(Telemetry_Data.Thread_Active)
+	{
+		Telemetry_Error_Number = 3;
+		sprintf(Telemetry_Error_String,"CCD_Telemetry_Start:Sampler thread already running.");
+		return FALSE;
+	}
+	Telemetry_Data.Handle = handle;
+	Telemetry_Data.Period_Ms = period_ms;
+	Telemetry_Data.Stop_Requested = FALSE;
+	Telemetry_Data.Thread_Active = TRUE;
+	retval = pthread_create(&(Telemetry_Data.Thread),NULL,Telemetry_Thread,NULL);
+	if(retval != 0)
+	{
+		Telemetry_Data.Thread_Active = FALSE;
+		Telemetry_Error_Number = 4;
+		sprintf(Telemetry_Error_String,"CCD_Telemetry_Start:Failed to create sampler thread (%d,%s).",
+			retval,strerror(retval));
+		return FALSE;
+	}
+#if LOGGING > 0
+	CCD_Global_Log(LOG_VERBOSITY_VERY_VERBOSE,"CCD_Telemetry_Start() returned TRUE.");
+#endif
+	return TRUE;
+}
+
+/**
+ * Routine to stop the telemetry sampler thread. This waits for any sample in progress to finish.
+ * It is not an error to call this routine when the sampler is not running.
+ * This must be called before the interface handle passed to CCD_Telemetry_Start is closed.
+ * @return The routine returns TRUE if the thread was stopped (or was not running), and FALSE if an error occured.
+ * @see #Telemetry_Data
+ */
+int CCD_Telemetry_Stop(void)
+{
+	struct CCD_Telemetry_Struct telemetry;
+	int retval;
+
+	Telemetry_Error_Number = 0;
+#if LOGGING > 0
+	CCD_Global_Log(LOG_VERBOSITY_VERY_VERBOSE,"CCD_Telemetry_Stop() started.");
+#endif
+	if(Telemetry_Data.Thread_Active == FALSE)
+		return TRUE;
+	pthread_mutex_lock(&(Telemetry_Data.Wait_Mutex));
+	Telemetry_Data.Stop_Requested = TRUE;
+	pthread_cond_signal(&(Telemetry_Data.Wait_Condition));
+	pthread_mutex_unlock(&(Telemetry_Data.Wait_Mutex));
+	retval = pthread_join(Telemetry_Data.Thread,NULL);
+	Telemetry_Data.Thread_Active = FALSE;
+	if(retval != 0)
+	{
+		Telemetry_Error_Number = 5;
+		sprintf(Telemetry_Error_String,"CCD_Telemetry_Stop:Failed to join sampler thread (%d,%s).",
+			retval,strerror(retval));
+		return FALSE;
+	}
+	/* the sampler thread has exited, so we are the only writer */
+	telemetry = Telemetry_Data.Snapshot;
+	telemetry.Running = FALSE;
+	Telemetry_Publish(&telemetry);
+	Telemetry_Data.Handle = NULL;
+#if LOGGING > 0
+	CCD_Global_Log(LOG_VERBOSITY_VERY_VERBOSE,"CCD_Telemetry_Stop() returned TRUE.");
+#endif
+	return TRUE;
+}
+
+/**
+ * Routine to get a copy of the latest telemetry snapshot. This does not communicate with the controller,
+ * and never blocks waiting for the sampler thread. Use CCD_Telemetry_Age_Get on the timestamps to determine
+ * how old each group of values is.
+ * @param telemetry The address of a CCD_Telemetry_Struct to copy the snapshot into.
+ * @return The routine returns TRUE if the snapshot was copied, and FALSE if an error occured.
+ * @see #Telemetry_Data
+ * @see #CCD_Telemetry_Age_Get
+ */
+int CCD_Telemetry_Get(struct CCD_Telemetry_Struct *telemetry)
+{
+	unsigned int start_sequence,end_sequence;
+
+	Telemetry_Error_Number = 0;
+	if(telemetry == NULL)
+	{
+		Telemetry_Error_Number = 6;
+		sprintf(Telemetry_Error_String,"CCD_Telemetry_Get:telemetry was NULL.");
+		return FALSE;
+	}
+	do
+	{
+		start_sequence = Telemetry_Data.Sequence;
+		__sync_synchronize();
+		(*telemetry) = Telemetry_Data.Snapshot;
+		__sync_synchronize();
+		end_sequence = Telemetry_Data.Sequence;
+	}
+	while((start_sequence != end_sequence)||(start_sequence & 1));
+	return TRUE;
+}
+
+/**
+ * Routine to return how long ago the specified snapshot timestamp was.
+ * @param timestamp One of the timestamps in a CCD_Telemetry_Struct.
+ * @return The age in seconds, or -1.0 if the timestamp is not set (that group has never been sampled).
+ * @see #CCD_Telemetry_Struct
+ */
+double CCD_Telemetry_Age_Get(struct timespec timestamp)
+{
+	struct timespec current_time;
+
+	if(timestamp.tv_sec == 0)
+		return -1.0;
+	clock_gettime(CLOCK_REALTIME,&current_time);
+	return fdifftime(current_time,timestamp);
+}
+
+/**
+ * Routine called before a command that may talk to the controller, and report an error through the
+ * library's error routines. If the sampler is reading the controller, this waits for it to finish.
+ * The sampler will not read the controller until CCD_Telemetry_Command_End is called, so it cannot overwrite
+ * the command's error number and string before they are read. Commands do not block each other.
+ * @see #Telemetry_Command
+ * @see #CCD_Telemetry_Command_End
+ */
+void CCD_Telemetry_Command_Start(void)
+{
+	pthread_mutex_lock(&(Telemetry_Command.Mutex));
+	while(Telemetry_Command.Sample_In_Progress)
+		pthread_cond_wait(&(Telemetry_Command.Condition),&(Telemetry_Command.Mutex));
+	Telemetry_Command.Active_Count++;
+	pthread_mutex_unlock(&(Telemetry_Command.Mutex));
+}
+
+/**
+ * Routine called after a command started with CCD_Telemetry_Command_Start has finished, and any error it
+ * generated has been read.
+ * @see #Telemetry_Command
+ * @see #CCD_Telemetry_Command_Start
+ */
+void CCD_Telemetry_Command_End(void)
+{
+	pthread_mutex_lock(&(Telemetry_Command.Mutex));
+	if(Telemetry_Command.Active_Count > 0)
+		Telemetry_Command.Active_Count--;
+	pthread_mutex_unlock(&(Telemetry_Command.Mutex));
+}
+
+/**
+ * Get the current value of the error number.
+ * @return The current value of the error number.
+ */
+int CCD_Telemetry_Get_Error_Number(void)
+{
+	return Telemetry_Error_Number;
+}
+
+/**
+ * The error routine that reports any errors occuring in ccd_telemetry in a standard way.
+ * @see ccd_global.html#CCD_Global_Get_Current_Time_String
+ * @see #Telemetry_Error_Number
+ * @see #Telemetry_Error_String
+ */
+void CCD_Telemetry_Error(void)
+{
+	char time_string[32];
+
+	CCD_Global_Get_Current_Time_String(time_string,32);
+	/* if the error number is zero an error message has not been set up
+	** This is in itself an error as we should not be calling this routine
+	** without there being an error to display */
+	if(Telemetry_Error_Number == 0)
+		sprintf(Telemetry_Error_String,"Logic Error:No Error defined");
+	fprintf(stderr,"%s CCD_Telemetry:Error(%d) : %s\n",time_string,
+		Telemetry_Error_Number,Telemetry_Error_String);
+}
+
+/**
+ * The error routine that reports any errors occuring in ccd_telemetry in a standard way. This routine places the
+ * generated error string at the end of a passed in string argument.
+ * @param error_string A string to put the generated error in. This string should be initialised before
+ * 	being passed to this routine. The routine will try to concatenate it's error string onto the end
+ * 	of any string already in existance.
+ * @see ccd_global.html#CCD_Global_Get_Current_Time_String
+ */
+void CCD_Telemetry_Error_String(char *error_string)
+{
+	char time_string[32];
+
+	CCD_Global_Get_Current_Time_String(time_string,32);
+	/* if the error number is zero an error message has not been set up
+	** This is in itself an error as we should not be calling this routine
+	** without there being an error to display */
+	if(Telemetry_Error_Number == 0)
+		sprintf(Telemetry_Error_String,"Logic Error:No Error defined");
+	sprintf(error_string+strlen(error_string),"%s CCD_Telemetry:Error(%d) : %s\n",time_string,
+		Telemetry_Error_Number,Telemetry_Error_String);
+}
+
+/* -----------------------------------------------------------------------------
+** 	internal functions
+** ----------------------------------------------------------------------------- */
+/**
+ * Thread routine started by CCD_Telemetry_Start. Calls Telemetry_Sample every Telemetry_Data.Period_Ms
+ * milliseconds, and Telemetry_State_Poll every TELEMETRY_STATE_POLL_MS milliseconds in between. 
+ * The thread waits on Telemetry_Data.Wait_Condition, so exits promptly when CCD_Telemetry_Stop
+ * sets Telemetry_Data.Stop_Requested.
+ * @param user_arg Not used.
+ * @return Always NULL.
+ * @see #Telemetry_Data
+ * @see #Telemetry_Sample
+ * @see #Telemetry_State_Poll
+ * @see #TELEMETRY_STATE_POLL_MS
+ * @see ccd_global.html#CCD_Global_Add_Time_Ms
+ */
+static void *Telemetry_Thread(void *user_arg)
+{
+	struct timespec current_time,sample_time,wake_time;
+	int retval;
+
+#if LOGGING > 0
+	CCD_Global_Log(LOG_VERBOSITY_VERBOSE,"Telemetry_Thread:Sampler thread started.");
+#endif
+	clock_gettime(CLOCK_REALTIME,&sample_time);
+	while(Telemetry_Data.Stop_Requested == FALSE)
+	{
+		clock_gettime(CLOCK_REALTIME,&current_time);
+		if(fdifftime(current_time,sample_time) >= 0.0)
+		{
+			Telemetry_Sample();
+			/* schedule the next sample from now, so a slow sample does not cause a burst of samples */
+			clock_gettime(CLOCK_REALTIME,&sample_time);
+			CCD_Global_Add_Time_Ms(&sample_time,Telemetry_Data.Period_Ms);
+		}
+		else
+			Telemetry_State_Poll();
+		/* wait until the next state poll, or the next sample if that is sooner */
+		clock_gettime(CLOCK_REALTIME,&wake_time);
+		CCD_Global_Add_Time_Ms(&wake_time,TELEMETRY_STATE_POLL_MS);
+		if(fdifftime(sample_time,wake_time) < 0.0)
+			wake_time = sample_time;
+		pthread_mutex_lock(&(Telemetry_Data.Wait_Mutex));
+		retval = 0;
+		while((Telemetry_Data.Stop_Requested == FALSE)&&(retval != ETIMEDOUT))
+		{
+			retval = pthread_cond_timedwait(&(Telemetry_Data.Wait_Condition),
+							&(Telemetry_Data.Wait_Mutex),&wake_time);
+		}
+		pthread_mutex_unlock(&(Telemetry_Data.Wait_Mutex));
+	}
+#if LOGGING > 0
+	CCD_Global_Log(LOG_VERBOSITY_VERBOSE,"Telemetry_Thread:Sampler thread stopped.");
+#endif
+	return NULL;
+}
+
+/**
+ * Take one telemetry sample, publish it, and record it in the telemetry store.
+ * <ul>
+ * <li>The library state (exposure status, filter wheel status and position) is always sampled.
+ * <li>The readout watchdog's last anomaly is always sampled.
+ * <li>If no exposure is in progress, the controller is not being setup, the filter wheel is not moving,
+ *     and no command is active (see CCD_Telemetry_Command_Start),
+ *     the CCD temperature ADU, heater ADU and utility board ADU are read from the utility board.
+ *     If all three reads succeed, the group and it's timestamp are updated.
+ * <li>Under the same conditions, the supply voltage ADUs are read, and the group and it's timestamp updated
+ *     if all three reads succeed.
+ * <li>Groups that were not read keep their previous values and timestamps, so their age increases.
+ * </ul>
+ * Read failures are logged, but are not reported through the error routines. The utility board can start
+ * refusing reads (DSP error 64) at any time if an exposure is started during a sample.
+ * @see #Telemetry_Data
+ * @see #Telemetry_State_Get
+ * @see #Telemetry_Readout_Anomaly_Get
+ * @see #Telemetry_Publish
+ * @see #Telemetry_Store
+ * @see #Telemetry_Sample_Read_Start
+ * @see #Telemetry_Sample_Read_End
+ * @see ccd_setup.html#CCD_Setup_Get_Setup_In_Progress
+ * @see ccd_temperature.html#CCD_Temperature_Get_ADU
+ * @see ccd_temperature.html#CCD_Temperature_ADU_To_Centigrade
+ * @see ccd_temperature.html#CCD_Temperature_Get_Heater_ADU
+ * @see ccd_temperature.html#CCD_Temperature_Get_Utility_Board_ADU
+ * @see ccd_setup.html#CCD_Setup_Get_High_Voltage_Analogue_ADU
+ * @see ccd_setup.html#CCD_Setup_Get_Low_Voltage_Analogue_ADU
+ * @see ccd_setup.html#CCD_Setup_Get_Minus_Low_Voltage_Analogue_ADU
+ */
+static void Telemetry_Sample(void)
+{
+	struct CCD_Telemetry_Struct telemetry;
+	CCD_Interface_Handle_T* handle = NULL;
+	double temperature;
+	int temperature_adu,heater_adu,utility_board_adu,hv_adu,lv_adu,minus_lv_adu;
+	int utility_board_allowed;
+	unsigned int flags;
+
+	handle = Telemetry_Data.Handle;
+	/* we are the only writer, so can read the snapshot without the sequence lock */
+	telemetry = Telemetry_Data.Snapshot;
+	telemetry.Running = TRUE;
+	telemetry.Sample_Count++;
+	flags = 0;
+	/* library state */
+	if(Telemetry_State_Get(&telemetry))
+		flags |= CCD_TELEMETRY_STORE_FLAG_STATE_CHANGE;
+	if(Telemetry_Readout_Anomaly_Get(&telemetry))
+		flags |= CCD_TELEMETRY_STORE_FLAG_READOUT_ANOMALY;
+	/* are we allowed to read the utility board at the moment */
+	utility_board_allowed = (telemetry.Exposure_Status == CCD_EXPOSURE_STATUS_NONE)&&
+		(CCD_Setup_Get_Setup_In_Progress(handle) == FALSE)&&
+		((telemetry.Filter_Wheel_Status == CCD_FILTER_WHEEL_STATUS_NONE)||
+		 (telemetry.Filter_Wheel_Status == CCD_FILTER_WHEEL_STATUS_ABORTED))&&
+		Telemetry_Sample_Read_Start();
+	if(utility_board_allowed)
+	{
+		/* temperature group */
+		if(CCD_Temperature_Get_ADU(handle,&temperature_adu)&&
+		   CCD_Temperature_ADU_To_Centigrade(temperature_adu,&temperature)&&
+		   CCD_Temperature_Get_Heater_ADU(handle,&heater_adu)&&
+		   CCD_Temperature_Get_Utility_Board_ADU(handle,&utility_board_adu))
+		{
+			clock_gettime(CLOCK_REALTIME,&(telemetry.Temperature_Timestamp));
+			telemetry.Temperature = temperature;
+			telemetry.Temperature_ADU = temperature_adu;
+			telemetry.Heater_ADU = heater_adu;
+			telemetry.Utility_Board_ADU = utility_board_adu;
+			flags |= CCD_TELEMETRY_STORE_FLAG_TEMPERATURE;
+		}
+#if LOGGING > 4
+		else
+		{
+			CCD_Global_Log_Format(LOG_VERBOSITY_VERBOSE,"Telemetry_Sample:Temperature sample failed"
+					      " (temperature error %d).",CCD_Temperature_Get_Error_Number());
+		}
+#endif
+		/* supply voltage group */
+		if(CCD_Setup_Get_High_Voltage_Analogue_ADU(handle,&hv_adu)&&
+		   CCD_Setup_Get_Low_Voltage_Analogue_ADU(handle,&lv_adu)&&
+		   CCD_Setup_Get_Minus_Low_Voltage_Analogue_ADU(handle,&minus_lv_adu))
+		{
+			clock_gettime(CLOCK_REALTIME,&(telemetry.Supply_Voltage_Timestamp));
+			telemetry.High_Voltage_ADU = hv_adu;
+			telemetry.Low_Voltage_ADU = lv_adu;
+			telemetry.Minus_Low_Voltage_ADU = minus_lv_adu;
+			flags |= CCD_TELEMETRY_STORE_FLAG_SUPPLY_VOLTAGE;
+		}
+#if LOGGING > 4
+		else
+		{
+			CCD_Global_Log_Format(LOG_VERBOSITY_VERBOSE,"Telemetry_Sample:Supply voltage sample failed"
+					      " (setup error %d).",CCD_Setup_Get_Error_Number());
+		}
+#endif
+		Telemetry_Sample_Read_End();
+	}
+	Telemetry_Publish(&telemetry);
+	Telemetry_Store(&telemetry,flags);
+#if LOGGING > 9
+	CCD_Global_Log_Format(LOG_VERBOSITY_VERY_VERBOSE,"Telemetry_Sample:Sample %u:utility board read %s:"
+			      "temperature %.2f C.",telemetry.Sample_Count,utility_board_allowed ? "allowed" : "skipped",
+			      telemetry.Temperature);
+#endif
+}
+
+/**
+ * Check the library state (exposure status, filter wheel status and position) for a transition, and the
+ * readout watchdog for a new readout rate anomaly.
+ * If either has changed since the last sample or poll, a new snapshot is published, and a state change and/or 
+ * readout anomaly record is added to the telemetry store. This does not communicate with the controller.
+ * @see #Telemetry_Data
+ * @see #Telemetry_State_Get
+ * @see #Telemetry_Readout_Anomaly_Get
+ * @see #Telemetry_Publish
+ * @see #Telemetry_Store
+ */
+static void Telemetry_State_Poll(void)
+{
+	struct CCD_Telemetry_Struct telemetry;
+	unsigned int flags;
+
+	/* we are the only writer, so can read the snapshot without the sequence lock */
+	telemetry = Telemetry_Data.Snapshot;
+	flags = 0;
+	if(Telemetry_State_Get(&telemetry))
+		flags |= CCD_TELEMETRY_STORE_FLAG_STATE_CHANGE;
+	if(Telemetry_Readout_Anomaly_Get(&telemetry))
+		flags |= CCD_TELEMETRY_STORE_FLAG_READOUT_ANOMALY;
+	if(flags != 0)
+	{
+		Telemetry_Publish(&telemetry);
+		Telemetry_Store(&telemetry,flags);
+#if LOGGING > 5
+		CCD_Global_Log_Format(LOG_VERBOSITY_VERY_VERBOSE,"Telemetry_State_Poll:State changed:"
+				      "exposure status %d:filter wheel status %d:filter wheel position %d:"
+				      "readout anomaly count %u.",telemetry.Exposure_Status,
+				      telemetry.Filter_Wheel_Status,telemetry.Filter_Wheel_Position,
+				      telemetry.Readout_Anomaly_Count);
+#endif
+	}
+}
+
+/**
+ * Update the library state (exposure status, filter wheel status and position) and it's timestamp 
+ * in a telemetry snapshot.
+ * @param telemetry The address of the snapshot to update.
+ * @return TRUE if the state changed from the values in the snapshot, FALSE if it is the same.
+ * @see #Telemetry_Data
+ * @see ccd_exposure.html#CCD_Exposure_Get_Exposure_Status
+ * @see ccd_filter_wheel.html#CCD_Filter_Wheel_Get_Status
+ * @see ccd_filter_wheel.html#CCD_Filter_Wheel_Get_Position
+ */
+static int Telemetry_State_Get(struct CCD_Telemetry_Struct *telemetry)
+{
+	enum CCD_EXPOSURE_STATUS exposure_status;
+	enum CCD_FILTER_WHEEL_STATUS filter_wheel_status;
+	int position,changed;
+
+	exposure_status = CCD_Exposure_Get_Exposure_Status(Telemetry_Data.Handle);
+	filter_wheel_status = CCD_Filter_Wheel_Get_Status();
+	if(!CCD_Filter_Wheel_Get_Position(&position))
+		position = telemetry->Filter_Wheel_Position;
+	changed = (exposure_status != telemetry->Exposure_Status)||
+		(filter_wheel_status != telemetry->Filter_Wheel_Status)||
+		(position != telemetry->Filter_Wheel_Position);
+	telemetry->Exposure_Status = exposure_status;
+	telemetry->Filter_Wheel_Status = filter_wheel_status;
+	telemetry->Filter_Wheel_Position = position;
+	clock_gettime(CLOCK_REALTIME,&(telemetry->State_Timestamp));
+	return changed;
+}
+
+/**
+ * Update the last readout rate anomaly in a telemetry snapshot, from the readout watchdog.
+ * @param telemetry The address of the snapshot to update.
+ * @return TRUE if the watchdog has recorded a new anomaly since the snapshot, FALSE if it has not.
+ * @see ccd_readout_watchdog.html#CCD_Readout_Watchdog_Anomaly_Get
+ */
+static int Telemetry_Readout_Anomaly_Get(struct CCD_Telemetry_Struct *telemetry)
+{
+	struct CCD_Readout_Watchdog_Anomaly_Struct anomaly;
+
+	if(!CCD_Readout_Watchdog_Anomaly_Get(&anomaly))
+		return FALSE;
+	if(anomaly.Count == telemetry->Readout_Anomaly_Count)
+		return FALSE;
+	telemetry->Readout_Anomaly_Count = anomaly.Count;
+	telemetry->Readout_Anomaly_Timestamp = anomaly.Time;
+	telemetry->Readout_Anomaly_Type = anomaly.Type;
+	telemetry->Readout_Pixel_Rate = anomaly.Pixel_Rate;
+	telemetry->Readout_Expected_Pixel_Rate = anomaly.Expected_Pixel_Rate;
+	return TRUE;
+}
+
+/**
+ * Publish a new telemetry snapshot, using the sequence lock. This must only be called by one writer at a time
+ * (the sampler thread, or CCD_Telemetry_Stop after the sampler thread has been joined).
+ * @param telemetry The address of the new snapshot to publish.
+ * @see #Telemetry_Data
+ */
+static void Telemetry_Publish(struct CCD_Telemetry_Struct *telemetry)
+{
+	Telemetry_Data.Sequence++;
+	__sync_synchronize();
+	Telemetry_Data.Snapshot = (*telemetry);
+	__sync_synchronize();
+	Telemetry_Data.Sequence++;
+}
+
+/**
+ * Add a record of a telemetry snapshot to the telemetry store, if one is open. Failures are logged,
+ * but are not reported through the error routines.
+ * @param telemetry The address of the snapshot to record.
+ * @param flags A bit-mask of CCD_TELEMETRY_STORE_FLAG_* values, saying why the record is being made and
+ *        which values were read from the controller.
+ * @see #Telemetry_Data
+ * @see ccd_telemetry_store.html#CCD_Telemetry_Store_Is_Open
+ * @see ccd_telemetry_store.html#CCD_Telemetry_Store_Add
+ */
+static void Telemetry_Store(struct CCD_Telemetry_Struct *telemetry,unsigned int flags)
+{
+	struct CCD_Telemetry_Store_Record_Struct record;
+
+	if(CCD_Telemetry_Store_Is_Open() == FALSE)
+		return;
+	memset(&record,0,sizeof(record));
+	record.Flags = flags;
+	record.Time_Sec = telemetry->State_Timestamp.tv_sec;
+	record.Time_Nsec = telemetry->State_Timestamp.tv_nsec;
+	record.Temperature_ADU = telemetry->Temperature_ADU;
+	record.Heater_ADU = telemetry->Heater_ADU;
+	record.Utility_Board_ADU = telemetry->Utility_Board_ADU;
+	record.High_Voltage_ADU = telemetry->High_Voltage_ADU;
+	record.Low_Voltage_ADU = telemetry->Low_Voltage_ADU;
+	record.Minus_Low_Voltage_ADU = telemetry->Minus_Low_Voltage_ADU;
+	record.Exposure_Status = telemetry->Exposure_Status;
+	record.Filter_Wheel_Status = telemetry->Filter_Wheel_Status;
+	record.Filter_Wheel_Position = telemetry->Filter_Wheel_Position;
+	if(flags & CCD_TELEMETRY_STORE_FLAG_READOUT_ANOMALY)
+	{
+		record.Readout_Anomaly_Type = telemetry->Readout_Anomaly_Type;
+		record.Readout_Pixel_Rate = (int)(telemetry->Readout_Pixel_Rate+0.5);
+		record.Readout_Expected_Pixel_Rate = (int)(telemetry->Readout_Expected_Pixel_Rate+0.5);
+	}
+	if(!CCD_Telemetry_Store_Add(&record))
+	{
+#if LOGGING > 4
+		CCD_Global_Log_Format(LOG_VERBOSITY_VERBOSE,"Telemetry_Store:Failed to add record "
+				      "(telemetry store error %d).",CCD_Telemetry_Store_Get_Error_Number());
+#endif
+	}
+}
+
+/**
+ * Routine called by the sampler before reading the controller. If no command is active, the sample is marked as
+ * in progress, which makes CCD_Telemetry_Command_Start wait until Telemetry_Sample_Read_End is called.
+ * @return The routine returns TRUE if the sampler can read the controller, and FALSE if a command is active,
+ *         in which case the controller reads are skipped for this sample.
+ * @see #Telemetry_Command
+ * @see #Telemetry_Sample_Read_End
+ */
+static int Telemetry_Sample_Read_Start(void)
+{
+	int retval;
+
+	pthread_mutex_lock(&(Telemetry_Command.Mutex));
+	retval = (Telemetry_Command.Active_Count == 0);
+	if(retval)
+		Telemetry_Command.Sample_In_Progress = TRUE;
+	pthread_mutex_unlock(&(Telemetry_Command.Mutex));
+	return retval;
+}
+
+/**
+ * Routine called by the sampler when it has finished reading the controller, after Telemetry_Sample_Read_Start
+ * returned TRUE. Wakes any commands waiting in CCD_Telemetry_Command_Start.
+ * @see #Telemetry_Command
+ * @see #Telemetry_Sample_Read_Start
+ */
+static void Telemetry_Sample_Read_End(void)
+{
+	pthread_mutex_lock(&(Telemetry_Command.Mutex));
+	Telemetry_Command.Sample_In_Progress = FALSE;
+	pthread_cond_broadcast(&(Telemetry_Command.Condition));
+	pthread_mutex_unlock(&(Telemetry_Command.Mutex));
+}
+
+/*
+** $Log: not supported by cvs2svn $
+*/
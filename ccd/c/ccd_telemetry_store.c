@@ -0,0 +1,732 @@
+/* ccd_telemetry_store.c
+** Telemetry store module.
+** $Header$
+*/
+/**
+ * ccd_telemetry_store holds the routines for recording telemetry samples into a fixed size, memory mapped,
+ * binary ring file, and querying time ranges from it. The file consists of a header followed by an array of
+ * CCD_Telemetry_Store_Record_Struct records. The header holds a count of how many records have been written,
+ * which is used to find the next slot in the ring to write to. Records are written in time order, so time
+ * ranges can be found with a binary search.
+ * There is one writer (the telemetry sampler in the instrument process), and any number of readers, which can be
+ * in other processes (see ccd_telemetry_query). Each record holds a sequence number, which is zeroed whilst
+ * the record is being written, so readers can detect and skip records that are overwritten whilst they are
+ * being read.
+ * @author Chris Mottram
+ * @version $Revision$
+ */
+/**
+ * This hash define is needed before including source files give us POSIX.4/IEEE1003.1b-1993 prototypes.
+ */
+#define _POSIX_SOURCE 1
+/**
+ * This hash define is needed before including source files give us POSIX.4/IEEE1003.1b-1993 prototypes.
+ */
+#define _POSIX_C_SOURCE 199309L
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include "log_udp.h"
+#include "ccd_global.h"
+#include "ccd_telemetry_store.h"
+
+/**
+ * Revision Control System identifier.
+ */
+static char rcsid[] = "$Id$";
+
+/**
+ * Magic number at the start of a telemetry store file ('OTLM').
+ */
+#define TELEMETRY_STORE_MAGIC			(0x4f544c4d)
+/**
+ * Version of the telemetry store file format. See CCD_Telemetry_Store_Record_Struct for the record layout
+ * of each version.
+ * @see ccd_telemetry_store.html#CCD_Telemetry_Store_Record_Struct
+ */
+#define TELEMETRY_STORE_VERSION			(2)
+/**
+ * The minimum number of records a telemetry store can hold.
+ */
+#define TELEMETRY_STORE_MIN_RECORD_COUNT	(2)
+
+/* data types */
+/**
+ * Structure holding the header at the start of a telemetry store file. The header is 64 bytes long.
+ * <dl>
+ * <dt>Magic</dt> <dd>TELEMETRY_STORE_MAGIC.</dd>
+ * <dt>Version</dt> <dd>TELEMETRY_STORE_VERSION.</dd>
+ * <dt>Header_Size</dt> <dd>The size of this header in bytes.</dd>
+ * <dt>Record_Size</dt> <dd>The size of a CCD_Telemetry_Store_Record_Struct in bytes.</dd>
+ * <dt>Record_Count</dt> <dd>The number of records in the ring.</dd>
+ * <dt>Write_Count</dt> <dd>The number of records ever written to the ring. The next record is written at index
+ *     Write_Count % Record_Count.</dd>
+ * <dt>Spare</dt> <dd>Padding, reserved for future use.</dd>
+ * </dl>
+ */
+struct Telemetry_Store_Header_Struct
+{
+	unsigned int Magic;
+	unsigned int Version;
+	unsigned int Header_Size;
+	unsigned int Record_Size;
+	unsigned int Record_Count;
+	volatile unsigned int Write_Count;
+	unsigned int Spare[10];
+};
+
+/**
+ * Data type holding local data to ccd_telemetry_store. This consists of the following:
+ * <dl>
+ * <dt>Fd</dt> <dd>The file descriptor of the open store file, or -1.</dd>
+ * <dt>Writable</dt> <dd>A boolean, whether the store was opened for writing.</dd>
+ * <dt>Map</dt> <dd>The address of the memory mapped file, or NULL.</dd>
+ * <dt>Map_Length</dt> <dd>The length of the memory map in bytes.</dd>
+ * <dt>Header</dt> <dd>The address of the header in the memory map.</dd>
+ * <dt>Record_List</dt> <dd>The address of the first record in the memory map.</dd>
+ * </dl>
+ */
+struct Telemetry_Store_Struct
+{
+	int Fd;
+	int Writable;
+	void *Map;
+	size_t Map_Length;
+	struct Telemetry_Store_Header_Struct *Header;
+	struct CCD_Telemetry_Store_Record_Struct *Record_List;
+};
+
+/* internal variables */
+/**
+ * Variable holding error code of last operation performed by ccd_telemetry_store.
+ */
+static int Telemetry_Store_Error_Number = 0;
+/**
+ * Local variable holding description of the last error that occured.
+ */
+static char Telemetry_Store_Error_String[CCD_GLOBAL_ERROR_STRING_LENGTH] = "";
+/**
+ * Local telemetry store data.
+ * @see #Telemetry_Store_Struct
+ */
+static struct Telemetry_Store_Struct Telemetry_Store_Data = {-1,FALSE,NULL,0,NULL,NULL};
+
+/* internal function definitions */
+static int Telemetry_Store_Header_Check(struct Telemetry_Store_Header_Struct *header,size_t file_length);
+static int Telemetry_Store_Record_Read(unsigned int index,struct CCD_Telemetry_Store_Record_Struct *record);
+static double Telemetry_Store_Record_Time(struct CCD_Telemetry_Store_Record_Struct *record);
+
+/* -----------------------------------------------------------------------------
+**     external functions
+** ----------------------------------------------------------------------------- */
+/**
+ * This routine sets up ccd_telemetry_store internal variables.
+ * It should be called at startup.
+ * @return This routine returns TRUE for success.
+ */
+int CCD_Telemetry_Store_Initialise(void)
+{
+	Telemetry_Store_Error_Number = 0;
+/* print some compile time information to stdout */
+	fprintf(stdout,"CCD_Telemetry_Store_Initialise:%s.\n",rcsid);
+	return TRUE;
+}
+
+/**
+ * Open a telemetry store ring file, and memory map it.
+ * <ul>
+ * <li>If writable is TRUE, the file is created if it does not exist. If the file exists but was created
+ *     with a different number of records or a different file format, it is re-initialised (emptied).
+ * <li>If writable is FALSE, the file must exist and have a valid header. record_count is ignored.
+ * </ul>
+ * Only one store can be open at a time.
+ * @param filename The filename of the store.
+ * @param record_count The number of records in the ring, when opening for writing.
+ * @param writable A boolean, TRUE to open the store for writing (the instrument), FALSE to open it for
+ *        reading only (query programs).
+ * @return The routine returns TRUE if it succeeded, and FALSE if it failed.
+ * @see #Telemetry_Store_Data
+ * @see #Telemetry_Store_Header_Check
+ */
+int CCD_Telemetry_Store_Open(char *filename,int record_count,int writable)
+{
+	struct Telemetry_Store_Header_Struct header;
+	struct stat file_stat;
+	size_t file_length;
+	int fd,prot;
+
+	Telemetry_Store_Error_Number = 0;
+#if LOGGING > 0
+	CCD_Global_Log_Format(LOG_VERBOSITY_VERBOSE,"CCD_Telemetry_Store_Open(filename=%s,record_count=%d,"
+			      "writable=%d) started.",filename,record_count,writable);
+#endif
+	if(filename == NULL)
+	{
+		Telemetry_Store_Error_Number = 1;
+		sprintf(Telemetry_Store_Error_String,"CCD_Telemetry_Store_Open:filename was NULL.");
+		return FALSE;
+	}
+	if(Telemetry_Store_Data.Map != NULL)
+	{
+		Telemetry_Store_Error_Number = 2;
+		sprintf(Telemetry_Store_Error_String,"CCD_Telemetry_Store_Open:A store is already open.");
+		return FALSE;
+	}
+	if(writable)
+	{
+		if(record_count < TELEMETRY_STORE_MIN_RECORD_COUNT)
+		{
+			Telemetry_Store_Error_Number = 3;
+			sprintf(Telemetry_Store_Error_String,"CCD_Telemetry_Store_Open:Illegal record count %d.",
+				record_count);
+			return FALSE;
+		}
+		fd = open(filename,O_RDWR|O_CREAT,S_IRUSR|S_IWUSR|S_IRGRP|S_IROTH);
+	}
+	else
+		fd = open(filename,O_RDONLY);
+	if(fd < 0)
+	{
+		Telemetry_Store_Error_Number = 4;
+		sprintf(Telemetry_Store_Error_String,"CCD_Telemetry_Store_Open:Failed to open '%s' (%d,%s).",
+			filename,errno,strerror(errno));
+		return FALSE;
+	}
+	if(fstat(fd,&file_stat) != 0)
+	{
+		Telemetry_Store_Error_Number = 5;
+		sprintf(Telemetry_Store_Error_String,"CCD_Telemetry_Store_Open:Failed to stat '%s' (%d,%s).",
+			filename,errno,strerror(errno));
+		close(fd);
+		return FALSE;
+	}
+	file_length = file_stat.st_size;
+	/* read the existing header, if there is one */
+	memset(&header,0,sizeof(header));
+	if(file_length >= sizeof(header))
+	{
+		if(read(fd,&header,sizeof(header)) != sizeof(header))
+			memset(&header,0,sizeof(header));
+	}
+	if(writable)
+	{
+		/* re-initialise the file if it is not a store of the right size */
+		if((Telemetry_Store_Header_Check(&header,file_length) == FALSE)||
+		   (header.Record_Count != (unsigned int)record_count))
+		{
+#if LOGGING > 1
+			CCD_Global_Log_Format(LOG_VERBOSITY_VERBOSE,"CCD_Telemetry_Store_Open:"
+					      "Initialising '%s' with %d records.",filename,record_count);
+#endif
+			file_length = sizeof(struct Telemetry_Store_Header_Struct)+
+				(record_count*sizeof(struct CCD_Telemetry_Store_Record_Struct));
+			if((ftruncate(fd,0) != 0)||(ftruncate(fd,file_length) != 0))
+			{
+				Telemetry_Store_Error_Number = 6;
+				sprintf(Telemetry_Store_Error_String,"CCD_Telemetry_Store_Open:"
+					"Failed to size '%s' to %ld bytes (%d,%s).",filename,(long)file_length,
+					errno,strerror(errno));
+				close(fd);
+				return FALSE;
+			}
+			memset(&header,0,sizeof(header));
+			header.Magic = TELEMETRY_STORE_MAGIC;
+			header.Version = TELEMETRY_STORE_VERSION;
+			header.Header_Size = sizeof(struct Telemetry_Store_Header_Struct);
+			header.Record_Size = sizeof(struct CCD_Telemetry_Store_Record_Struct);
+			header.Record_Count = record_count;
+			header.Write_Count = 0;
+			if((lseek(fd,0,SEEK_SET) != 0)||(write(fd,&header,sizeof(header)) != sizeof(header)))
+			{
+				Telemetry_Store_Error_Number = 7;
+				sprintf(Telemetry_Store_Error_String,"CCD_Telemetry_Store_Open:"
+					"Failed to write header to '%s' (%d,%s).",filename,errno,strerror(errno));
+				close(fd);
+				return FALSE;
+			}
+		}
+		prot = PROT_READ|PROT_WRITE;
+	}
+	else
+	{
+		if(Telemetry_Store_Header_Check(&header,file_length) == FALSE)
+		{
+			Telemetry_Store_Error_Number = 8;
+			sprintf(Telemetry_Store_Error_String,"CCD_Telemetry_Store_Open:"
+				"'%s' is not a telemetry store (magic %#x, version %d, length %ld).",filename,
+				header.Magic,header.Version,(long)file_length);
+			close(fd);
+			return FALSE;
+		}
+		prot = PROT_READ;
+	}
+	Telemetry_Store_Data.Map = mmap(NULL,file_length,prot,MAP_SHARED,fd,0);
+	if(Telemetry_Store_Data.Map == MAP_FAILED)
+	{
+		Telemetry_Store_Data.Map = NULL;
+		Telemetry_Store_Error_Number = 9;
+		sprintf(Telemetry_Store_Error_String,"CCD_Telemetry_Store_Open:Failed to map '%s' (%d,%s).",
+			filename,errno,strerror(errno));
+		close(fd);
+		return FALSE;
+	}
+	Telemetry_Store_Data.Fd = fd;
+	Telemetry_Store_Data.Writable = writable;
+	Telemetry_Store_Data.Map_Length = file_length;
+	Telemetry_Store_Data.Header = (struct Telemetry_Store_Header_Struct *)Telemetry_Store_Data.Map;
+	Telemetry_Store_Data.Record_List = (struct CCD_Telemetry_Store_Record_Struct *)
+		(((char *)Telemetry_Store_Data.Map)+Telemetry_Store_Data.Header->Header_Size);
+#if LOGGING > 0
+	CCD_Global_Log_Format(LOG_VERBOSITY_VERBOSE,"CCD_Telemetry_Store_Open:Opened '%s':%d records,"
+			      "%u written.",filename,Telemetry_Store_Data.Header->Record_Count,
+			      Telemetry_Store_Data.Header->Write_Count);
+#endif
+	return TRUE;
+}
+
+/**
+ * Close the currently open telemetry store. It is not an error to call this if no store is open.
+ * The telemetry sampler must not be adding records when this is called.
+ * @return The routine returns TRUE if it succeeded, and FALSE if it failed.
+ * @see #Telemetry_Store_Data
+ */
+int CCD_Telemetry_Store_Close(void)
+{
+	int retval;
+
+	Telemetry_Store_Error_Number = 0;
+#if LOGGING > 0
+	CCD_Global_Log(LOG_VERBOSITY_VERBOSE,"CCD_Telemetry_Store_Close() started.");
+#endif
+	if(Telemetry_Store_Data.Map == NULL)
+		return TRUE;
+	if(Telemetry_Store_Data.Writable)
+		msync(Telemetry_Store_Data.Map,Telemetry_Store_Data.Map_Length,MS_ASYNC);
+	retval = munmap(Telemetry_Store_Data.Map,Telemetry_Store_Data.Map_Length);
+	Telemetry_Store_Data.Map = NULL;
+	Telemetry_Store_Data.Header = NULL;
+	Telemetry_Store_Data.Record_List = NULL;
+	close(Telemetry_Store_Data.Fd);
+	Telemetry_Store_Data.Fd = -1;
+	if(retval != 0)
+	{
+		Telemetry_Store_Error_Number = 10;
+		sprintf(Telemetry_Store_Error_String,"CCD_Telemetry_Store_Close:munmap failed (%d,%s).",
+			errno,strerror(errno));
+		return FALSE;
+	}
+	return TRUE;
+}
+
+/**
+ * Return whether a telemetry store is currently open.
+ * @return TRUE if a store is open, FALSE if it is not.
+ * @see #Telemetry_Store_Data
+ */
+int CCD_Telemetry_Store_Is_Open(void)
+{
+	return (Telemetry_Store_Data.Map != NULL);
+}
+
+/**
+ * Add a record to the end of the telemetry store ring, overwriting the oldest record if the ring is full.
+ * The record's Sequence is zeroed whilst the rest of the record is written, and then set to the
+ * record's write index plus one. Only one thread should add records.
+ * @param record The address of the record to add. Sequence and Count are set by this routine.
+ * @return The routine returns TRUE if it succeeded, and FALSE if it failed.
+ * @see #Telemetry_Store_Data
+ */
+int CCD_Telemetry_Store_Add(struct CCD_Telemetry_Store_Record_Struct *record)
+{
+	struct CCD_Telemetry_Store_Record_Struct *store_record = NULL;
+	unsigned int write_count;
+
+	Telemetry_Store_Error_Number = 0;
+	if(record == NULL)
+	{
+		Telemetry_Store_Error_Number = 11;
+		sprintf(Telemetry_Store_Error_String,"CCD_Telemetry_Store_Add:record was NULL.");
+		return FALSE;
+	}
+	if((Telemetry_Store_Data.Map == NULL)||(Telemetry_Store_Data.Writable == FALSE))
+	{
+		Telemetry_Store_Error_Number = 12;
+		sprintf(Telemetry_Store_Error_String,"CCD_Telemetry_Store_Add:No store open for writing.");
+		return FALSE;
+	}
+	write_count = Telemetry_Store_Data.Header->Write_Count;
+	store_record = &(Telemetry_Store_Data.Record_List[write_count%Telemetry_Store_Data.Header->Record_Count]);
+	store_record->Sequence = 0;
+	__sync_synchronize();
+	store_record->Flags = record->Flags;
+	store_record->Time_Sec = record->Time_Sec;
+	store_record->Time_Nsec = record->Time_Nsec;
+	store_record->Temperature_ADU = record->Temperature_ADU;
+	store_record->Heater_ADU = record->Heater_ADU;
+	store_record->Utility_Board_ADU = record->Utility_Board_ADU;
+	store_record->High_Voltage_ADU = record->High_Voltage_ADU;
+	store_record->Low_Voltage_ADU = record->Low_Voltage_ADU;
+	store_record->Minus_Low_Voltage_ADU = record->Minus_Low_Voltage_ADU;
+	store_record->Exposure_Status = record->Exposure_Status;
+	store_record->Filter_Wheel_Status = record->Filter_Wheel_Status;
+	store_record->Filter_Wheel_Position = record->Filter_Wheel_Position;
+	store_record->Readout_Anomaly_Type = record->Readout_Anomaly_Type;
+	store_record->Readout_Pixel_Rate = record->Readout_Pixel_Rate;
+	store_record->Readout_Expected_Pixel_Rate = record->Readout_Expected_Pixel_Rate;
+	store_record->Count = 1;
+	__sync_synchronize();
+	store_record->Sequence = write_count+1;
+	__sync_synchronize();
+	Telemetry_Store_Data.Header->Write_Count = write_count+1;
+	return TRUE;
+}
+
+/**
+ * Get information about the currently open telemetry store.
+ * @param record_count If non-NULL, the address of an integer to store the number of records in the ring.
+ * @param write_count If non-NULL, the address of an integer to store the number of records ever written.
+ * @param oldest_time If non-NULL, the address of a timespec to store the time of the oldest record.
+ *        This is zero if the store is empty.
+ * @param newest_time If non-NULL, the address of a timespec to store the time of the newest record.
+ *        This is zero if the store is empty.
+ * @return The routine returns TRUE if it succeeded, and FALSE if it failed.
+ * @see #Telemetry_Store_Data
+ * @see #Telemetry_Store_Record_Read
+ */
+int CCD_Telemetry_Store_Info_Get(int *record_count,unsigned int *write_count,
+				 struct timespec *oldest_time,struct timespec *newest_time)
+{
+	struct CCD_Telemetry_Store_Record_Struct record;
+	unsigned int current_write_count,first_index,index;
+
+	Telemetry_Store_Error_Number = 0;
+	if(Telemetry_Store_Data.Map == NULL)
+	{
+		Telemetry_Store_Error_Number = 13;
+		sprintf(Telemetry_Store_Error_String,"CCD_Telemetry_Store_Info_Get:No store open.");
+		return FALSE;
+	}
+	current_write_count = Telemetry_Store_Data.Header->Write_Count;
+	__sync_synchronize();
+	if(current_write_count > Telemetry_Store_Data.Header->Record_Count)
+		first_index = current_write_count-Telemetry_Store_Data.Header->Record_Count;
+	else
+		first_index = 0;
+	if(record_count != NULL)
+		(*record_count) = Telemetry_Store_Data.Header->Record_Count;
+	if(write_count != NULL)
+		(*write_count) = current_write_count;
+	if(oldest_time != NULL)
+	{
+		oldest_time->tv_sec = 0;
+		oldest_time->tv_nsec = 0;
+		/* the oldest record may be being overwritten, in which case try the next one */
+		for(index = first_index; index < current_write_count; index++)
+		{
+			if(Telemetry_Store_Record_Read(index,&record))
+			{
+				oldest_time->tv_sec = record.Time_Sec;
+				oldest_time->tv_nsec = record.Time_Nsec;
+				break;
+			}
+		}
+	}
+	if(newest_time != NULL)
+	{
+		newest_time->tv_sec = 0;
+		newest_time->tv_nsec = 0;
+		if((current_write_count > 0)&&Telemetry_Store_Record_Read(current_write_count-1,&record))
+		{
+			newest_time->tv_sec = record.Time_Sec;
+			newest_time->tv_nsec = record.Time_Nsec;
+		}
+	}
+	return TRUE;
+}
+
+/**
+ * Query the currently open telemetry store for records between two times. If there are more than
+ * max_record_count records in the range, the range is decimated: it is split into max_record_count (or fewer)
+ * buckets of consecutive records, and one record returned per bucket.
+ * In a returned record:
+ * <ul>
+ * <li>Time_Sec/Time_Nsec are the time of the first record in the bucket.
+ * <li>The ADU values are the mean of the records in the bucket where those values are valid.
+ * <li>Flags is the bitwise OR of the records' flags.
+ * <li>The exposure and filter wheel status/position are those of the last record in the bucket.
+ * <li>The readout anomaly fields are those of the worst (highest type) readout anomaly record in the bucket.
+ * <li>Count is the number of records in the bucket.
+ * <li>Sequence is the index of the first record in the bucket.
+ * </ul>
+ * Records being overwritten whilst the query is running are skipped.
+ * @param start_time The start of the time range.
+ * @param end_time The end of the time range (inclusive).
+ * @param max_record_count The maximum number of records to return, the length of record_list.
+ * @param record_list A user allocated list of at least max_record_count records, to fill in.
+ * @param record_count The address of an integer, to store the number of records returned in record_list.
+ * @return The routine returns TRUE if it succeeded, and FALSE if it failed.
+ * @see #Telemetry_Store_Data
+ * @see #Telemetry_Store_Record_Read
+ * @see #Telemetry_Store_Record_Time
+ */
+int CCD_Telemetry_Store_Query(struct timespec start_time,struct timespec end_time,int max_record_count,
+			      struct CCD_Telemetry_Store_Record_Struct *record_list,int *record_count)
+{
+	struct CCD_Telemetry_Store_Record_Struct record;
+	struct CCD_Telemetry_Store_Record_Struct *bucket = NULL;
+	double start_secs,end_secs;
+	long long temperature_sum,heater_sum,utility_board_sum,hv_sum,lv_sum,minus_lv_sum;
+	unsigned int current_write_count,first_index,start_index,end_index,bucket_index,index,low,high,middle;
+	unsigned int range_count,stride;
+	int temperature_count,supply_voltage_count;
+
+	Telemetry_Store_Error_Number = 0;
+	if((record_list == NULL)||(record_count == NULL))
+	{
+		Telemetry_Store_Error_Number = 14;
+		sprintf(Telemetry_Store_Error_String,"CCD_Telemetry_Store_Query:record_list or record_count was NULL.");
+		return FALSE;
+	}
+	if(max_record_count < 1)
+	{
+		Telemetry_Store_Error_Number = 15;
+		sprintf(Telemetry_Store_Error_String,"CCD_Telemetry_Store_Query:Illegal max record count %d.",
+			max_record_count);
+		return FALSE;
+	}
+	if(Telemetry_Store_Data.Map == NULL)
+	{
+		Telemetry_Store_Error_Number = 16;
+		sprintf(Telemetry_Store_Error_String,"CCD_Telemetry_Store_Query:No store open.");
+		return FALSE;
+	}
+	(*record_count) = 0;
+	start_secs = ((double)start_time.tv_sec)+(((double)start_time.tv_nsec)/CCD_GLOBAL_ONE_SECOND_NS);
+	end_secs = ((double)end_time.tv_sec)+(((double)end_time.tv_nsec)/CCD_GLOBAL_ONE_SECOND_NS);
+	current_write_count = Telemetry_Store_Data.Header->Write_Count;
+	__sync_synchronize();
+	if(current_write_count > Telemetry_Store_Data.Header->Record_Count)
+		first_index = current_write_count-Telemetry_Store_Data.Header->Record_Count;
+	else
+		first_index = 0;
+	/* binary search for the first record at or after start_time. Unreadable records are
+	** being overwritten, i.e. they are the oldest */
+	low = first_index;
+	high = current_write_count;
+	while(low < high)
+	{
+		middle = low+((high-low)/2);
+		if((Telemetry_Store_Record_Read(middle,&record) == FALSE)||
+		   (Telemetry_Store_Record_Time(&record) < start_secs))
+			low = middle+1;
+		else
+			high = middle;
+	}
+	start_index = low;
+	/* binary search for the first record after end_time */
+	high = current_write_count;
+	while(low < high)
+	{
+		middle = low+((high-low)/2);
+		if((Telemetry_Store_Record_Read(middle,&record) == FALSE)||
+		   (Telemetry_Store_Record_Time(&record) <= end_secs))
+			low = middle+1;
+		else
+			high = middle;
+	}
+	end_index = low;
+	if(end_index <= start_index)
+		return TRUE;
+	range_count = end_index-start_index;
+	stride = (range_count+max_record_count-1)/max_record_count;
+#if LOGGING > 5
+	CCD_Global_Log_Format(LOG_VERBOSITY_VERY_VERBOSE,"CCD_Telemetry_Store_Query:%u records in range "
+			      "(%u,%u), stride %u.",range_count,start_index,end_index,stride);
+#endif
+	for(bucket_index = start_index; bucket_index < end_index; bucket_index += stride)
+	{
+		bucket = &(record_list[(*record_count)]);
+		memset(bucket,0,sizeof(struct CCD_Telemetry_Store_Record_Struct));
+		bucket->Sequence = bucket_index;
+		temperature_sum = 0;
+		heater_sum = 0;
+		utility_board_sum = 0;
+		hv_sum = 0;
+		lv_sum = 0;
+		minus_lv_sum = 0;
+		temperature_count = 0;
+		supply_voltage_count = 0;
+		for(index = bucket_index; (index < bucket_index+stride)&&(index < end_index); index++)
+		{
+			if(Telemetry_Store_Record_Read(index,&record) == FALSE)
+				continue;
+			if(bucket->Count == 0)
+			{
+				bucket->Time_Sec = record.Time_Sec;
+				bucket->Time_Nsec = record.Time_Nsec;
+			}
+			bucket->Count++;
+			bucket->Flags |= record.Flags;
+			bucket->Exposure_Status = record.Exposure_Status;
+			bucket->Filter_Wheel_Status = record.Filter_Wheel_Status;
+			bucket->Filter_Wheel_Position = record.Filter_Wheel_Position;
+			if((record.Flags & CCD_TELEMETRY_STORE_FLAG_READOUT_ANOMALY)&&
+			   (record.Readout_Anomaly_Type >= bucket->Readout_Anomaly_Type))
+			{
+				bucket->Readout_Anomaly_Type = record.Readout_Anomaly_Type;
+				bucket->Readout_Pixel_Rate = record.Readout_Pixel_Rate;
+				bucket->Readout_Expected_Pixel_Rate = record.Readout_Expected_Pixel_Rate;
+			}
+			if(record.Flags & CCD_TELEMETRY_STORE_FLAG_TEMPERATURE)
+			{
+				temperature_sum += record.Temperature_ADU;
+				heater_sum += record.Heater_ADU;
+				utility_board_sum += record.Utility_Board_ADU;
+				temperature_count++;
+			}
+			if(record.Flags & CCD_TELEMETRY_STORE_FLAG_SUPPLY_VOLTAGE)
+			{
+				hv_sum += record.High_Voltage_ADU;
+				lv_sum += record.Low_Voltage_ADU;
+				minus_lv_sum += record.Minus_Low_Voltage_ADU;
+				supply_voltage_count++;
+			}
+		}
+		if(bucket->Count == 0)
+			continue;
+		if(temperature_count > 0)
+		{
+			bucket->Temperature_ADU = (int)(temperature_sum/temperature_count);
+			bucket->Heater_ADU = (int)(heater_sum/temperature_count);
+			bucket->Utility_Board_ADU = (int)(utility_board_sum/temperature_count);
+		}
+		if(supply_voltage_count > 0)
+		{
+			bucket->High_Voltage_ADU = (int)(hv_sum/supply_voltage_count);
+			bucket->Low_Voltage_ADU = (int)(lv_sum/supply_voltage_count);
+			bucket->Minus_Low_Voltage_ADU = (int)(minus_lv_sum/supply_voltage_count);
+		}
+		(*record_count)++;
+	}
+	return TRUE;
+}
+
+/**
+ * Get the current value of the error number.
+ * @return The current value of the error number.
+ */
+int CCD_Telemetry_Store_Get_Error_Number(void)
+{
+	return Telemetry_Store_Error_Number;
+}
+
+/**
+ * The error routine that reports any errors occuring in ccd_telemetry_store in a standard way.
+ * @see ccd_global.html#CCD_Global_Get_Current_Time_String
+ * @see #Telemetry_Store_Error_Number
+ * @see #Telemetry_Store_Error_String
+ */
+void CCD_Telemetry_Store_Error(void)
+{
+	char time_string[32];
+
+	CCD_Global_Get_Current_Time_String(time_string,32);
+	/* if the error number is zero an error message has not been set up
+	** This is in itself an error as we should not be calling this routine
+	** without there being an error to display */
+	if(Telemetry_Store_Error_Number == 0)
+		sprintf(Telemetry_Store_Error_String,"Logic Error:No Error defined");
+	fprintf(stderr,"%s CCD_Telemetry_Store:Error(%d) : %s\n",time_string,
+		Telemetry_Store_Error_Number,Telemetry_Store_Error_String);
+}
+
+/**
+ * The error routine that reports any errors occuring in ccd_telemetry_store in a standard way. This routine
+ * places the generated error string at the end of a passed in string argument.
+ * @param error_string A string to put the generated error in. This string should be initialised before
+ * 	being passed to this routine. The routine will try to concatenate it's error string onto the end
+ * 	of any string already in existance.
+ * @see ccd_global.html#CCD_Global_Get_Current_Time_String
+ */
+void CCD_Telemetry_Store_Error_String(char *error_string)
+{
+	char time_string[32];
+
+	CCD_Global_Get_Current_Time_String(time_string,32);
+	/* if the error number is zero an error message has not been set up
+	** This is in itself an error as we should not be calling this routine
+	** without there being an error to display */
+	if(Telemetry_Store_Error_Number == 0)
+		sprintf(Telemetry_Store_Error_String,"Logic Error:No Error defined");
+	sprintf(error_string+strlen(error_string),"%s CCD_Telemetry_Store:Error(%d) : %s\n",time_string,
+		Telemetry_Store_Error_Number,Telemetry_Store_Error_String);
+}
+
+/* -----------------------------------------------------------------------------
+** 	internal functions
+** ----------------------------------------------------------------------------- */
+/**
+ * Check whether a header read from a file is a valid telemetry store header for a file of the specified length.
+ * @param header The address of the header.
+ * @param file_length The length of the file in bytes.
+ * @return TRUE if the header is valid, FALSE if it is not.
+ * @see #TELEMETRY_STORE_MAGIC
+ * @see #TELEMETRY_STORE_VERSION
+ */
+static int Telemetry_Store_Header_Check(struct Telemetry_Store_Header_Struct *header,size_t file_length)
+{
+	if(header->Magic != TELEMETRY_STORE_MAGIC)
+		return FALSE;
+	if(header->Version != TELEMETRY_STORE_VERSION)
+		return FALSE;
+	if(header->Header_Size != sizeof(struct Telemetry_Store_Header_Struct))
+		return FALSE;
+	if(header->Record_Size != sizeof(struct CCD_Telemetry_Store_Record_Struct))
+		return FALSE;
+	if(header->Record_Count < TELEMETRY_STORE_MIN_RECORD_COUNT)
+		return FALSE;
+	if(file_length != header->Header_Size+(((size_t)header->Record_Count)*header->Record_Size))
+		return FALSE;
+	return TRUE;
+}
+
+/**
+ * Copy a record out of the store, checking it was not being overwritten whilst it was copied.
+ * @param index The write index of the record (not the ring index).
+ * @param record The address of a record to copy into.
+ * @return TRUE if the record was copied successfully, FALSE if it was being written or has been overwritten.
+ * @see #Telemetry_Store_Data
+ */
+static int Telemetry_Store_Record_Read(unsigned int index,struct CCD_Telemetry_Store_Record_Struct *record)
+{
+	struct CCD_Telemetry_Store_Record_Struct *store_record = NULL;
+	unsigned int start_sequence,end_sequence;
+
+	store_record = &(Telemetry_Store_Data.Record_List[index%Telemetry_Store_Data.Header->Record_Count]);
+	start_sequence = *((volatile unsigned int *)&(store_record->Sequence));
+	__sync_synchronize();
+	(*record) = (*store_record);
+	__sync_synchronize();
+	end_sequence = *((volatile unsigned int *)&(store_record->Sequence));
+	return ((start_sequence == end_sequence)&&(start_sequence == index+1));
+}
+
+/**
+ * Return the time a record was made, as a number of seconds since the epoch.
+ * @param record The address of the record.
+ * @return The time in seconds.
+ */
+static double Telemetry_Store_Record_Time(struct CCD_Telemetry_Store_Record_Struct *record)
+{
+	return ((double)record->Time_Sec)+(((double)record->Time_Nsec)/CCD_GLOBAL_ONE_SECOND_NS);
+}
+
+/*
+** $Log: not supported by cvs2svn $
+*/
@@ -168,26 +168,20 @@ static int Temperature_Centigrade_To_ADU(double target_temperature,int *adu);
 /* external functions */
 /**
  * This routine gets the current temperature of the CCD in the dewar using the SDSU CCD Controller utility board.
- * It reads the utility board using CCD_DSP_Command_RDM to read memory which has the digital counts 
- * of the voltage from the temperature sensor in it. This is done TEMPERATURE_MAX_CHECKS times.
+ * CCD_Temperature_Get_ADU is called to get the averaged ADU counts from the temperature sensor.
  * The temperature is calculated from the adu by calling Temperature_ADU_To_Centigrade. 
  * @param handle The address of a CCD_Interface_Handle_T that holds the device connection specific information.
  * @param temperature The address of a variable to hold the calculated temperature to be returned.
  * 	The returned temperature is in degrees centigrade.
  * @return TRUE if the operation was successfull and the temperature returned was sensible, FALSE
  * 	if a failure occured or the temperature returned was not sensible.
- * @see #TEMPERATURE_MAX_CHECKS
- * @see #TEMPERATURE_CURRENT_ADU_ADDRESS
- * @see #TEMPERATURE_GET_SLEEP_MS
+ * @see #CCD_Temperature_Get_ADU
  * @see #Temperature_ADU_To_Centigrade
- * @see ccd_dsp.html#CCD_DSP_Command_RDM
  * @see ccd_interface.html#CCD_Interface_Handle_T
  */
 int CCD_Temperature_Get(CCD_Interface_Handle_T* handle,double *temperature)
 {
-	struct timespec sleep_time;
-	int adu,retval;
-	int i;
+	int adu;
 	double voltage;
 
 	Temperature_Error_Number = 0;
@@ -200,7 +194,52 @@ int CCD_Temperature_Get(CCD_Interface_Handle_T* handle,double *temperature)
 		sprintf(Temperature_Error_String,"CCD_Temperature_Get:temperature pointer was NULL.");
 		return FALSE;
 	}
-	adu = 0;
+	if(!CCD_Temperature_Get_ADU(handle,&adu))
+		return FALSE;
+	/* Calculate the temperature */
+	if(!Temperature_ADU_To_Centigrade((float)adu,temperature,&voltage))
+		return FALSE;
+#if LOGGING > 5
+	CCD_Global_Log_Format(LOG_VERBOSITY_VERBOSE,"CCD_Temperature_Get():Temperature:%.2f.",(*temperature));
+#endif
+#if LOGGING > 5
+	CCD_Global_Log_Format(LOG_VERBOSITY_VERBOSE,"CCD_Temperature_Get():Voltage:%.6f v.",voltage);
+#endif
+#if LOGGING > 0
+	CCD_Global_Log_Format(LOG_VERBOSITY_VERBOSE,"CCD_Temperature_Get() finished.");
+#endif
+	return TRUE;
+}
+
+/**
+ * This routine gets the current ADU counts of the CCD (dewar) temperature sensor, 
+ * using the SDSU CCD Controller utility board.
+ * It reads the utility board using CCD_DSP_Command_RDM to read memory which has the digital counts 
+ * of the voltage from the temperature sensor in it. This is done TEMPERATURE_MAX_CHECKS times,
+ * and the average returned.
+ * @param handle The address of a CCD_Interface_Handle_T that holds the device connection specific information.
+ * @param adu The address of an integer to hold the averaged ADU counts.
+ * @return TRUE if the operation was successfull, FALSE if a failure occured.
+ * @see #TEMPERATURE_MAX_CHECKS
+ * @see #TEMPERATURE_CURRENT_ADU_ADDRESS
+ * @see #TEMPERATURE_GET_SLEEP_MS
+ * @see ccd_dsp.html#CCD_DSP_Command_RDM
+ * @see ccd_interface.html#CCD_Interface_Handle_T
+ */
+int CCD_Temperature_Get_ADU(CCD_Interface_Handle_T* handle,int *adu)
+{
+	struct timespec sleep_time;
+	int adu_sum,retval;
+	int i;
+
+	Temperature_Error_Number = 0;
+	if(adu == NULL)
+	{
+		Temperature_Error_Number = 12;
+		sprintf(Temperature_Error_String,"CCD_Temperature_Get_ADU:adu pointer was NULL.");
+		return FALSE;
+	}
+	adu_sum = 0;
 	for (i = 0; i < TEMPERATURE_MAX_CHECKS; i++)
 	{
 		retval = CCD_DSP_Command_RDM(handle,CCD_DSP_UTIL_BOARD_ID,CCD_DSP_MEM_SPACE_Y,
@@ -212,11 +251,11 @@ int CCD_Temperature_Get(CCD_Interface_Handle_T* handle,double *temperature)
 			return FALSE;
 		}
 #if LOGGING > 9
-		CCD_Global_Log_Format(LOG_VERBOSITY_VERBOSE,"CCD_Temperature_Get():RDM returned %d.",retval);
+		CCD_Global_Log_Format(LOG_VERBOSITY_VERBOSE,"CCD_Temperature_Get_ADU():RDM returned %d.",retval);
 #endif
 	/* ensure returned adu in range */
 		retval = retval & 0xFFF;
-		adu += retval;
+		adu_sum += retval;
 	/* Sleep for 2 milliseconds. The controller only updates the temperature adu value every 3 ms. */
 		sleep_time.tv_sec = 0;
 		sleep_time.tv_nsec = TEMPERATURE_GET_SLEEP_MS*CCD_GLOBAL_ONE_MILLISECOND_NS;
@@ -224,28 +263,34 @@ int CCD_Temperature_Get(CCD_Interface_Handle_T* handle,double *temperature)
 	}
 
 #if LOGGING > 9
-	CCD_Global_Log_Format(LOG_VERBOSITY_VERBOSE,"CCD_Temperature_Get():%d RDMs returned %d.",
-			TEMPERATURE_MAX_CHECKS,adu);
+	CCD_Global_Log_Format(LOG_VERBOSITY_VERBOSE,"CCD_Temperature_Get_ADU():%d RDMs returned %d.",
+			TEMPERATURE_MAX_CHECKS,adu_sum);
 #endif
 	/* Average the adu counts */
-	adu = adu / TEMPERATURE_MAX_CHECKS;
+	(*adu) = adu_sum / TEMPERATURE_MAX_CHECKS;
 #if LOGGING > 9
-	CCD_Global_Log_Format(LOG_VERBOSITY_VERBOSE,"CCD_Temperature_Get():Average adu:%d.",adu);
-#endif
-	/* Calculate the temperature */
-	retval = Temperature_ADU_To_Centigrade((float)adu,temperature,&voltage);
-#if LOGGING > 5
-	CCD_Global_Log_Format(LOG_VERBOSITY_VERBOSE,"CCD_Temperature_Get():Temperature:%.2f.",(*temperature));
-#endif
-#if LOGGING > 5
-	CCD_Global_Log_Format(LOG_VERBOSITY_VERBOSE,"CCD_Temperature_Get():Voltage:%.6f v.",voltage);
-#endif
-#if LOGGING > 0
-	CCD_Global_Log_Format(LOG_VERBOSITY_VERBOSE,"CCD_Temperature_Get() finished.");
+	CCD_Global_Log_Format(LOG_VERBOSITY_VERBOSE,"CCD_Temperature_Get_ADU():Average adu:%d.",(*adu));
 #endif
 	return TRUE;
 }
 
+/**
+ * Convert an ADU count from the CCD (dewar) temperature sensor, as returned by CCD_Temperature_Get_ADU,
+ * into a temperature.
+ * @param adu The ADU count.
+ * @param temperature The address of a double to store the temperature, in degrees centigrade.
+ * @return Returns TRUE if sucessful and FALSE if there was an error.
+ * @see #CCD_Temperature_Get_ADU
+ * @see #Temperature_ADU_To_Centigrade
+ */
+int CCD_Temperature_ADU_To_Centigrade(int adu,double *temperature)
+{
+	double voltage;
+
+	Temperature_Error_Number = 0;
+	return Temperature_ADU_To_Centigrade((float)adu,temperature,&voltage);
+}
+
 /**
  * This routine gets the current ADU of the utility board temperature sensor.
  * It reads the utility board using CCD_DSP_Command_RDM to read memory which has the digital counts 
@@ -0,0 +1,731 @@
+/* ccd_timing.c
+** Exposure phase timing module.
+** $Header$
+*/
+/**
+ * ccd_timing holds the routines for timing each phase of an exposure, so we can see where the per-frame overhead
+ * goes. CCD_Exposure_Expose and the pixel stream code mark the start and end of each phase (see the
+ * CCD_TIMING_PHASE_* definitions) with CLOCK_MONOTONIC timestamps. When an exposure completes successfully,
+ * the duration of each phase is added to a histogram for that phase and the exposure's configuration
+ * (binning, amplifier and whether windowed).
+ * <ul>
+ * <li>The histograms are log-linear (in the style of HDR histograms): durations are kept in microseconds,
+ *     each power of two range is split into TIMING_SUB_BUCKET_COUNT buckets, so any duration from a microsecond
+ *     to hours is kept to about 6% precision in a fixed, small amount of memory.
+ * <li>Marking a phase is a clock_gettime call, and adding an exposure to the histograms a few array increments,
+ *     so the instrumentation is always on.
+ * <li>Percentiles of each phase can be retrieved per configuration, or over all configurations.
+ * </ul>
+ * The timing of the exposure in progress is only accessed from the thread doing the exposure. The histograms
+ * are protected by a mutex, as they are read by the status thread.
+ * @author Chris Mottram
+ * @version $Revision$
+ */
+/**
+ * This hash define is needed before including source files give us POSIX.4/IEEE1003.1b-1993 prototypes.
+ */
+#define _POSIX_SOURCE 1
+/**
+ * This hash define is needed before including source files give us POSIX.4/IEEE1003.1b-1993 prototypes.
+ */
+#define _POSIX_C_SOURCE 199309L
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "log_udp.h"
+#include "ccd_global.h"
+#include "ccd_timing.h"
+
+/**
+ * Revision Control System identifier.
+ */
+static char rcsid[] = "$Id$";
+
+/* hash defines */
+/**
+ * The number of microseconds in one second.
+ */
+#define TIMING_ONE_SECOND_US		(1000000)
+/**
+ * The number of bits of precision kept for each duration in a histogram.
+ * @see #TIMING_SUB_BUCKET_COUNT
+ */
+#define TIMING_SUB_BUCKET_BITS		(4)
+/**
+ * The number of histogram buckets each power of two range of durations is split into.
+ * @see #TIMING_SUB_BUCKET_BITS
+ */
+#define TIMING_SUB_BUCKET_COUNT		(1<<TIMING_SUB_BUCKET_BITS)
+/**
+ * The longest duration kept in a histogram is 2 to the power of this, in microseconds (about 19 hours).
+ * Longer durations are added to the last bucket.
+ */
+#define TIMING_MAX_EXPONENT		(36)
+/**
+ * The number of buckets in a histogram. The first 2*TIMING_SUB_BUCKET_COUNT buckets are one microsecond wide,
+ * after that each power of two has TIMING_SUB_BUCKET_COUNT buckets.
+ * @see #TIMING_SUB_BUCKET_COUNT
+ * @see #TIMING_MAX_EXPONENT
+ */
+#define TIMING_BUCKET_COUNT		((TIMING_MAX_EXPONENT-TIMING_SUB_BUCKET_BITS+1)*TIMING_SUB_BUCKET_COUNT)
+
+/* data types */
+/**
+ * Data type holding a histogram of the durations of one phase.
+ * <dl>
+ * <dt>Bucket_List</dt> <dd>The number of durations in each bucket.</dd>
+ * <dt>Count</dt> <dd>The total number of durations in the histogram.</dd>
+ * <dt>Max_Duration</dt> <dd>The longest duration in the histogram, in microseconds.</dd>
+ * </dl>
+ * @see #TIMING_BUCKET_COUNT
+ */
+struct Timing_Histogram_Struct
+{
+	unsigned int Bucket_List[TIMING_BUCKET_COUNT];
+	unsigned int Count;
+	unsigned long long Max_Duration;
+};
+
+/**
+ * Data type holding the histograms for one exposure configuration.
+ * <dl>
+ * <dt>In_Use</dt> <dd>A boolean, whether this configuration has been used.</dd>
+ * <dt>X_Bin</dt> <dd>The serial binning.</dd>
+ * <dt>Y_Bin</dt> <dd>The parallel binning.</dd>
+ * <dt>Amplifier</dt> <dd>The amplifier (an enum CCD_DSP_AMPLIFIER value).</dd>
+ * <dt>Windowed</dt> <dd>A boolean, whether the exposures were windowed.</dd>
+ * <dt>Last_Use</dt> <dd>The value of Timing_Data.Use_Count the configuration was last used at.</dd>
+ * <dt>Histogram_List</dt> <dd>A histogram for each phase.</dd>
+ * </dl>
+ * @see #Timing_Histogram_Struct
+ */
+struct Timing_Config_Struct
+{
+	int In_Use;
+	int X_Bin;
+	int Y_Bin;
+	int Amplifier;
+	int Windowed;
+	unsigned int Last_Use;
+	struct Timing_Histogram_Struct Histogram_List[CCD_TIMING_PHASE_COUNT];
+};
+
+/**
+ * Data type holding the timing of the exposure in progress.
+ * <dl>
+ * <dt>Active</dt> <dd>A boolean, whether an exposure is being timed.</dd>
+ * <dt>Config_Index</dt> <dd>The index in Timing_Data.Config_List of the exposure's configuration.</dd>
+ * <dt>Phase_Start_List</dt> <dd>When each phase was last started.</dd>
+ * <dt>Phase_Started_List</dt> <dd>A boolean for each phase, whether it has been started and not ended.</dd>
+ * <dt>Phase_Duration_List</dt> <dd>The total duration of each phase, in microseconds. Phases which are started
+ *     more than once (i.e. de-interlacing several windows) accumulate.</dd>
+ * <dt>Phase_Measured_List</dt> <dd>A boolean for each phase, whether it has a duration.</dd>
+ * <dt>Progress_Time_List</dt> <dd>When the last two readout progress values were sampled.</dd>
+ * <dt>Progress_Count_List</dt> <dd>The last two readout progress values (pixel counts), the latest first.</dd>
+ * <dt>Progress_Sample_Count</dt> <dd>The number of readout progress values sampled.</dd>
+ * <dt>End_Time</dt> <dd>When the last successful exposure ended, used to time the return to Java.</dd>
+ * <dt>Return_Config_Index</dt> <dd>The configuration of the last successful exposure, or -1 if the return
+ *     to Java is not to be timed.</dd>
+ * </dl>
+ */
+struct Timing_Exposure_Struct
+{
+	int Active;
+	int Config_Index;
+	struct timespec Phase_Start_List[CCD_TIMING_PHASE_COUNT];
+	int Phase_Started_List[CCD_TIMING_PHASE_COUNT];
+	unsigned long long Phase_Duration_List[CCD_TIMING_PHASE_COUNT];
+	int Phase_Measured_List[CCD_TIMING_PHASE_COUNT];
+	struct timespec Progress_Time_List[2];
+	int Progress_Count_List[2];
+	int Progress_Sample_Count;
+	struct timespec End_Time;
+	int Return_Config_Index;
+};
+
+/**
+ * Data type holding local data to ccd_timing.
+ * <dl>
+ * <dt>Config_List</dt> <dd>The histograms for each exposure configuration.</dd>
+ * <dt>Use_Count</dt> <dd>Incremented each time an exposure starts, to find the least recently used
+ *     configuration.</dd>
+ * <dt>Exposure</dt> <dd>The timing of the exposure in progress.</dd>
+ * <dt>Mutex</dt> <dd>Protects Config_List, which is read by the status thread.</dd>
+ * </dl>
+ * @see #Timing_Config_Struct
+ * @see #Timing_Exposure_Struct
+ * @see #CCD_TIMING_MAX_CONFIG_COUNT
+ */
+struct Timing_Struct
+{
+	struct Timing_Config_Struct Config_List[CCD_TIMING_MAX_CONFIG_COUNT];
+	unsigned int Use_Count;
+	struct Timing_Exposure_Struct Exposure;
+	pthread_mutex_t Mutex;
+};
+
+/* internal variables */
+/**
+ * Variable holding error code of last operation performed by ccd_timing.
+ */
+static int Timing_Error_Number = 0;
+/**
+ * Local variable holding description of the last error that occured.
+ */
+static char Timing_Error_String[CCD_GLOBAL_ERROR_STRING_LENGTH] = "";
+/**
+ * Local timing data. This is large (the histograms), and zeroed at startup, apart from the mutex.
+ * @see #Timing_Struct
+ */
+static struct Timing_Struct Timing_Data =
+{
+	{{0}},0,{0},PTHREAD_MUTEX_INITIALIZER
+};
+/**
+ * The name of each phase, for logging and status reporting.
+ * @see #CCD_Timing_Phase_Name_Get
+ */
+static char *Timing_Phase_Name_List[CCD_TIMING_PHASE_COUNT] =
+{
+	"Setup","Wait Start","Clear","Expose","Pre Readout","Readout","Readout Detect","DeInterlace","Save",
+	"Post Readout","Return","Total"
+};
+
+/* internal function definitions */
+static unsigned long long Timing_Duration_Get(struct timespec end_time,struct timespec start_time);
+static void Timing_Histogram_Add(struct Timing_Histogram_Struct *histogram,unsigned long long duration);
+static int Timing_Bucket_Index_Get(unsigned long long duration);
+static unsigned long long Timing_Bucket_Duration_Get(int bucket_index);
+
+/* -----------------------------------------------------------------------------
+**     external functions
+** ----------------------------------------------------------------------------- */
+/**
+ * This routine sets up ccd_timing internal variables, clearing all the histograms.
+ * It should be called at startup.
+ * @return This routine returns TRUE for success.
+ * @see #CCD_Timing_Reset
+ */
+int CCD_Timing_Initialise(void)
+{
+	Timing_Error_Number = 0;
+/* print some compile time information to stdout */
+	fprintf(stdout,"CCD_Timing_Initialise:%s.\n",rcsid);
+	Timing_Data.Exposure.Active = FALSE;
+	Timing_Data.Exposure.Return_Config_Index = -1;
+	return CCD_Timing_Reset();
+}
+
+/**
+ * Routine called at the start of an exposure. The configuration is looked up (or a new, or the least recently
+ * used, configuration is (re)used), the exposure's phase timings cleared, and the SETUP and TOTAL phases started.
+ * @param x_bin The serial binning.
+ * @param y_bin The parallel binning.
+ * @param amplifier The amplifier being read out.
+ * @param windowed A boolean, whether the exposure is windowed.
+ * @see #Timing_Data
+ * @see #CCD_Timing_Phase_Start
+ */
+void CCD_Timing_Exposure_Start(int x_bin,int y_bin,int amplifier,int windowed)
+{
+	struct Timing_Config_Struct *config = NULL;
+	int config_index,i;
+
+	pthread_mutex_lock(&(Timing_Data.Mutex));
+	Timing_Data.Use_Count++;
+	config_index = -1;
+	for(i = 0; i < CCD_TIMING_MAX_CONFIG_COUNT; i++)
+	{
+		config = &(Timing_Data.Config_List[i]);
+		if(config->In_Use && (config->X_Bin == x_bin)&&(config->Y_Bin == y_bin)&&
+		   (config->Amplifier == amplifier)&&(config->Windowed == windowed))
+		{
+			config_index = i;
+			break;
+		}
+	}
+	/* a new configuration: use an unused entry, or reset the least recently used one */
+	if(config_index == -1)
+	{
+		config_index = 0;
+		for(i = 0; i < CCD_TIMING_MAX_CONFIG_COUNT; i++)
+		{
+			config = &(Timing_Data.Config_List[i]);
+			if(config->In_Use == FALSE)
+			{
+				config_index = i;
+				break;
+			}
+			if(config->Last_Use < Timing_Data.Config_List[config_index].Last_Use)
+				config_index = i;
+		}
+		config = &(Timing_Data.Config_List[config_index]);
+		memset(config,0,sizeof(struct Timing_Config_Struct));
+		config->In_Use = TRUE;
+		config->X_Bin = x_bin;
+		config->Y_Bin = y_bin;
+		config->Amplifier = amplifier;
+		config->Windowed = windowed;
+	}
+	Timing_Data.Config_List[config_index].Last_Use = Timing_Data.Use_Count;
+	pthread_mutex_unlock(&(Timing_Data.Mutex));
+	Timing_Data.Exposure.Config_Index = config_index;
+	for(i = 0; i < CCD_TIMING_PHASE_COUNT; i++)
+	{
+		Timing_Data.Exposure.Phase_Started_List[i] = FALSE;
+		Timing_Data.Exposure.Phase_Duration_List[i] = 0;
+		Timing_Data.Exposure.Phase_Measured_List[i] = FALSE;
+	}
+	Timing_Data.Exposure.Progress_Sample_Count = 0;
+	Timing_Data.Exposure.Return_Config_Index = -1;
+	Timing_Data.Exposure.Active = TRUE;
+	CCD_Timing_Phase_Start(CCD_TIMING_PHASE_TOTAL);
+	CCD_Timing_Phase_Start(CCD_TIMING_PHASE_SETUP);
+}
+
+/**
+ * Routine to mark the start of a phase of the exposure in progress. This does nothing if no exposure is being
+ * timed, or the phase is not a legal phase.
+ * @param phase The phase, one of the CCD_TIMING_PHASE_* values.
+ * @see #Timing_Data
+ * @see #CCD_TIMING_IS_PHASE
+ */
+void CCD_Timing_Phase_Start(int phase)
+{
+	if((Timing_Data.Exposure.Active == FALSE)||(!CCD_TIMING_IS_PHASE(phase)))
+		return;
+	clock_gettime(CLOCK_MONOTONIC,&(Timing_Data.Exposure.Phase_Start_List[phase]));
+	Timing_Data.Exposure.Phase_Started_List[phase] = TRUE;
+}
+
+/**
+ * Routine to mark the end of a phase of the exposure in progress. The time since the phase was started is
+ * added to it's duration. This does nothing if no exposure is being timed, or the phase has not been started
+ * (or has already ended), so it can safely be called at every point a phase may end.
+ * @param phase The phase, one of the CCD_TIMING_PHASE_* values.
+ * @see #Timing_Data
+ * @see #Timing_Duration_Get
+ * @see #CCD_TIMING_IS_PHASE
+ */
+void CCD_Timing_Phase_End(int phase)
+{
+	struct timespec end_time;
+
+	if((Timing_Data.Exposure.Active == FALSE)||(!CCD_TIMING_IS_PHASE(phase)))
+		return;
+	if(Timing_Data.Exposure.Phase_Started_List[phase] == FALSE)
+		return;
+	clock_gettime(CLOCK_MONOTONIC,&end_time);
+	Timing_Data.Exposure.Phase_Duration_List[phase] += Timing_Duration_Get(end_time,
+								  Timing_Data.Exposure.Phase_Start_List[phase]);
+	Timing_Data.Exposure.Phase_Started_List[phase] = FALSE;
+	Timing_Data.Exposure.Phase_Measured_List[phase] = TRUE;
+}
+
+/**
+ * Routine called each time the readout progress is polled, used to estimate the READOUT_DETECT phase:
+ * the time between the last pixel arriving and the readout polling detecting it. When the pixel count first
+ * reaches the expected pixel count, the readout rate between the previous two samples is used to estimate
+ * when the last pixel arrived. If the readout was not seen in progress at two samples, the rate is not known,
+ * and the phase is not measured.
+ * @param pixel_count The number of pixels read out so far.
+ * @param expected_pixel_count The number of pixels to be read out.
+ * @see #Timing_Data
+ * @see #Timing_Duration_Get
+ */
+void CCD_Timing_Readout_Progress(int pixel_count,int expected_pixel_count)
+{
+	struct Timing_Exposure_Struct *exposure = &(Timing_Data.Exposure);
+	struct timespec current_time;
+	double rate,last_pixel_delay,sample_gap;
+
+	if(exposure->Active == FALSE)
+		return;
+	clock_gettime(CLOCK_MONOTONIC,&current_time);
+	if((pixel_count >= expected_pixel_count)&&(exposure->Phase_Measured_List[CCD_TIMING_PHASE_READOUT_DETECT]
+						   == FALSE))
+	{
+		if((exposure->Progress_Sample_Count >= 2)&&(exposure->Progress_Count_List[1] > 0)&&
+		   (exposure->Progress_Count_List[0] > exposure->Progress_Count_List[1]))
+		{
+			/* pixels per second between the last two samples */
+			rate = ((double)(exposure->Progress_Count_List[0]-exposure->Progress_Count_List[1]))/
+				fdifftime(exposure->Progress_Time_List[0],exposure->Progress_Time_List[1]);
+			/* when the last pixel arrived, after the previous sample */
+			last_pixel_delay = ((double)(expected_pixel_count-exposure->Progress_Count_List[0]))/rate;
+			sample_gap = fdifftime(current_time,exposure->Progress_Time_List[0]);
+			if(last_pixel_delay > sample_gap)
+				last_pixel_delay = sample_gap;
+			exposure->Phase_Duration_List[CCD_TIMING_PHASE_READOUT_DETECT] = (unsigned long long)
+				((sample_gap-last_pixel_delay)*((double)TIMING_ONE_SECOND_US));
+			exposure->Phase_Measured_List[CCD_TIMING_PHASE_READOUT_DETECT] = TRUE;
+		}
+	}
+	exposure->Progress_Time_List[1] = exposure->Progress_Time_List[0];
+	exposure->Progress_Count_List[1] = exposure->Progress_Count_List[0];
+	exposure->Progress_Time_List[0] = current_time;
+	exposure->Progress_Count_List[0] = pixel_count;
+	exposure->Progress_Sample_Count++;
+}
+
+/**
+ * Routine called when an exposure completes successfully. The TOTAL phase is ended, and every phase that
+ * was measured is added to the histograms of the exposure's configuration. The end time is kept so
+ * CCD_Timing_Return_End can time the return to Java. Failed or aborted exposures are not added, as they
+ * would distort the phase timings; the next CCD_Timing_Exposure_Start discards their timings.
+ * @see #Timing_Data
+ * @see #Timing_Histogram_Add
+ * @see #CCD_Timing_Phase_End
+ */
+void CCD_Timing_Exposure_End(void)
+{
+	struct Timing_Config_Struct *config = NULL;
+	int phase;
+
+	if(Timing_Data.Exposure.Active == FALSE)
+		return;
+	CCD_Timing_Phase_End(CCD_TIMING_PHASE_TOTAL);
+	pthread_mutex_lock(&(Timing_Data.Mutex));
+	config = &(Timing_Data.Config_List[Timing_Data.Exposure.Config_Index]);
+	for(phase = 0; phase < CCD_TIMING_PHASE_COUNT; phase++)
+	{
+		if(Timing_Data.Exposure.Phase_Measured_List[phase])
+		{
+			Timing_Histogram_Add(&(config->Histogram_List[phase]),
+					     Timing_Data.Exposure.Phase_Duration_List[phase]);
+		}
+	}
+	pthread_mutex_unlock(&(Timing_Data.Mutex));
+#if LOGGING > 4
+	CCD_Global_Log_Format(LOG_VERBOSITY_VERBOSE,"CCD_Timing_Exposure_End:Config %d:Total %.3f s:"
+			      "Readout %.3f s:Readout Detect %.3f s:DeInterlace %.3f s:Save %.3f s:"
+			      "Post Readout %.3f s.",Timing_Data.Exposure.Config_Index,
+		 ((double)Timing_Data.Exposure.Phase_Duration_List[CCD_TIMING_PHASE_TOTAL])/TIMING_ONE_SECOND_US,
+		 ((double)Timing_Data.Exposure.Phase_Duration_List[CCD_TIMING_PHASE_READOUT])/TIMING_ONE_SECOND_US,
+	  ((double)Timing_Data.Exposure.Phase_Duration_List[CCD_TIMING_PHASE_READOUT_DETECT])/TIMING_ONE_SECOND_US,
+	     ((double)Timing_Data.Exposure.Phase_Duration_List[CCD_TIMING_PHASE_DEINTERLACE])/TIMING_ONE_SECOND_US,
+		 ((double)Timing_Data.Exposure.Phase_Duration_List[CCD_TIMING_PHASE_SAVE])/TIMING_ONE_SECOND_US,
+	    ((double)Timing_Data.Exposure.Phase_Duration_List[CCD_TIMING_PHASE_POST_READOUT])/TIMING_ONE_SECOND_US);
+#endif
+	clock_gettime(CLOCK_MONOTONIC,&(Timing_Data.Exposure.End_Time));
+	Timing_Data.Exposure.Return_Config_Index = Timing_Data.Exposure.Config_Index;
+	Timing_Data.Exposure.Active = FALSE;
+}
+
+/**
+ * Routine called by the JNI layer just before it returns to Java from a successful exposure. The time since
+ * CCD_Timing_Exposure_End is added to the RETURN phase histogram of the exposure's configuration.
+ * This does nothing if the last exposure was not successful (or has already been timed).
+ * @see #Timing_Data
+ * @see #Timing_Histogram_Add
+ * @see #Timing_Duration_Get
+ */
+void CCD_Timing_Return_End(void)
+{
+	struct timespec current_time;
+	int config_index;
+
+	config_index = Timing_Data.Exposure.Return_Config_Index;
+	if(config_index < 0)
+		return;
+	clock_gettime(CLOCK_MONOTONIC,&current_time);
+	pthread_mutex_lock(&(Timing_Data.Mutex));
+	Timing_Histogram_Add(&(Timing_Data.Config_List[config_index].Histogram_List[CCD_TIMING_PHASE_RETURN]),
+			     Timing_Duration_Get(current_time,Timing_Data.Exposure.End_Time));
+	pthread_mutex_unlock(&(Timing_Data.Mutex));
+	Timing_Data.Exposure.Return_Config_Index = -1;
+}
+
+/**
+ * Routine to clear all the histograms, and forget all the configurations.
+ * @return The routine returns TRUE.
+ * @see #Timing_Data
+ */
+int CCD_Timing_Reset(void)
+{
+	Timing_Error_Number = 0;
+	pthread_mutex_lock(&(Timing_Data.Mutex));
+	memset(Timing_Data.Config_List,0,sizeof(Timing_Data.Config_List));
+	Timing_Data.Use_Count = 0;
+	pthread_mutex_unlock(&(Timing_Data.Mutex));
+	return TRUE;
+}
+
+/**
+ * Routine to get the name of a phase.
+ * @param phase The phase, one of the CCD_TIMING_PHASE_* values.
+ * @return The name of the phase, or NULL if the phase is not legal.
+ * @see #Timing_Phase_Name_List
+ */
+char *CCD_Timing_Phase_Name_Get(int phase)
+{
+	if(!CCD_TIMING_IS_PHASE(phase))
+		return NULL;
+	return Timing_Phase_Name_List[phase];
+}
+
+/**
+ * Routine to get an exposure configuration being timed.
+ * @param config_index The index of the configuration, from 0 to CCD_TIMING_MAX_CONFIG_COUNT-1.
+ * @param in_use The address of an integer, set to TRUE if the configuration has been used, and FALSE if it
+ *        has not (in which case the other values are not set).
+ * @param x_bin The address of an integer to store the serial binning in.
+ * @param y_bin The address of an integer to store the parallel binning in.
+ * @param amplifier The address of an integer to store the amplifier in.
+ * @param windowed The address of an integer to store whether the exposures were windowed in.
+ * @return The routine returns TRUE on success, and FALSE if an argument is illegal.
+ * @see #Timing_Data
+ */
+int CCD_Timing_Config_Get(int config_index,int *in_use,int *x_bin,int *y_bin,int *amplifier,int *windowed)
+{
+	struct Timing_Config_Struct *config = NULL;
+
+	Timing_Error_Number = 0;
+	if((config_index < 0)||(config_index >= CCD_TIMING_MAX_CONFIG_COUNT))
+	{
+		Timing_Error_Number = 1;
+		sprintf(Timing_Error_String,"CCD_Timing_Config_Get:Illegal config index %d.",config_index);
+		return FALSE;
+	}
+	if((in_use == NULL)||(x_bin == NULL)||(y_bin == NULL)||(amplifier == NULL)||(windowed == NULL))
+	{
+		Timing_Error_Number = 2;
+		sprintf(Timing_Error_String,"CCD_Timing_Config_Get:NULL argument.");
+		return FALSE;
+	}
+	pthread_mutex_lock(&(Timing_Data.Mutex));
+	config = &(Timing_Data.Config_List[config_index]);
+	(*in_use) = config->In_Use;
+	if(config->In_Use)
+	{
+		(*x_bin) = config->X_Bin;
+		(*y_bin) = config->Y_Bin;
+		(*amplifier) = config->Amplifier;
+		(*windowed) = config->Windowed;
+	}
+	pthread_mutex_unlock(&(Timing_Data.Mutex));
+	return TRUE;
+}
+
+/**
+ * Routine to get a percentile of the durations of a phase. The duration returned is the middle of the histogram
+ * bucket the percentile falls in (or the longest duration, for the 100th percentile).
+ * @param config_index The index of the configuration, from 0 to CCD_TIMING_MAX_CONFIG_COUNT-1, or
+ *        CCD_TIMING_CONFIG_ALL to combine all the configurations.
+ * @param phase The phase, one of the CCD_TIMING_PHASE_* values.
+ * @param percentile The percentile, from 0 to 100 (i.e. 50 for the median, 100 for the maximum).
+ * @param duration The address of a double to store the duration in, in seconds. This is set to 0.0
+ *        if there are no durations.
+ * @param count The address of an integer to store the number of durations the percentile was computed from.
+ * @return The routine returns TRUE on success, and FALSE if an argument is illegal.
+ * @see #Timing_Data
+ * @see #Timing_Bucket_Duration_Get
+ * @see ccd_global.html#CCD_Global_Percentile_Index
+ */
+int CCD_Timing_Percentile_Get(int config_index,int phase,double percentile,double *duration,int *count)
+{
+	struct Timing_Histogram_Struct *histogram = NULL;
+	unsigned int bucket_list[TIMING_BUCKET_COUNT];
+	unsigned long long max_duration,bucket_duration;
+	unsigned int total_count,rank,cumulative_count;
+	int i,bucket_index;
+
+	Timing_Error_Number = 0;
+	if((config_index != CCD_TIMING_CONFIG_ALL)&&((config_index < 0)||(config_index >= CCD_TIMING_MAX_CONFIG_COUNT)))
+	{
+		Timing_Error_Number = 3;
+		sprintf(Timing_Error_String,"CCD_Timing_Percentile_Get:Illegal config index %d.",config_index);
+		return FALSE;
+	}
+	if(!CCD_TIMING_IS_PHASE(phase))
+	{
+		Timing_Error_Number = 4;
+		sprintf(Timing_Error_String,"CCD_Timing_Percentile_Get:Illegal phase %d.",phase);
+		return FALSE;
+	}
+	if((percentile < 0.0)||(percentile > 100.0))
+	{
+		Timing_Error_Number = 5;
+		sprintf(Timing_Error_String,"CCD_Timing_Percentile_Get:Illegal percentile %.2f.",percentile);
+		return FALSE;
+	}
+	if((duration == NULL)||(count == NULL))
+	{
+		Timing_Error_Number = 6;
+		sprintf(Timing_Error_String,"CCD_Timing_Percentile_Get:NULL argument.");
+		return FALSE;
+	}
+	/* copy (or combine) the histogram, so the mutex is not held whilst searching it */
+	memset(bucket_list,0,sizeof(bucket_list));
+	total_count = 0;
+	max_duration = 0;
+	pthread_mutex_lock(&(Timing_Data.Mutex));
+	for(i = 0; i < CCD_TIMING_MAX_CONFIG_COUNT; i++)
+	{
+		if((config_index != CCD_TIMING_CONFIG_ALL)&&(i != config_index))
+			continue;
+		if(Timing_Data.Config_List[i].In_Use == FALSE)
+			continue;
+		histogram = &(Timing_Data.Config_List[i].Histogram_List[phase]);
+		if(histogram->Count == 0)
+			continue;
+		for(bucket_index = 0; bucket_index < TIMING_BUCKET_COUNT; bucket_index++)
+			bucket_list[bucket_index] += histogram->Bucket_List[bucket_index];
+		total_count += histogram->Count;
+		if(histogram->Max_Duration > max_duration)
+			max_duration = histogram->Max_Duration;
+	}
+	pthread_mutex_unlock(&(Timing_Data.Mutex));
+	(*count) = (int)total_count;
+	(*duration) = 0.0;
+	if(total_count == 0)
+		return TRUE;
+	/* nearest rank, counting from one */
+	rank = (unsigned int)CCD_Global_Percentile_Index(percentile,(int)total_count)+1;
+	bucket_duration = max_duration;
+	cumulative_count = 0;
+	for(bucket_index = 0; bucket_index < TIMING_BUCKET_COUNT; bucket_index++)
+	{
+		cumulative_count += bucket_list[bucket_index];
+		if(cumulative_count >= rank)
+		{
+			bucket_duration = Timing_Bucket_Duration_Get(bucket_index);
+			break;
+		}
+	}
+	if((rank >= total_count)||(bucket_duration > max_duration))
+		bucket_duration = max_duration;
+	(*duration) = ((double)bucket_duration)/((double)TIMING_ONE_SECOND_US);
+	return TRUE;
+}
+
+/**
+ * Get the current value of the error number.
+ * @return The current value of the error number.
+ */
+int CCD_Timing_Get_Error_Number(void)
+{
+	return Timing_Error_Number;
+}
+
+/**
+ * The error routine that reports any errors occuring in ccd_timing in a standard way.
+ * @see ccd_global.html#CCD_Global_Get_Current_Time_String
+ */
+void CCD_Timing_Error(void)
+{
+	char time_string[32];
+
+	CCD_Global_Get_Current_Time_String(time_string,32);
+	/* if the error number is zero an error message has not been set up
+	** This is in itself an error as we should not be calling this routine
+	** without there being an error to display */
+	if(Timing_Error_Number == 0)
+		sprintf(Timing_Error_String,"Logic Error:No Error defined");
+	fprintf(stderr,"%s CCD_Timing:Error(%d) : %s\n",time_string,Timing_Error_Number,Timing_Error_String);
+}
+
+/**
+ * The error routine that reports any errors occuring in ccd_timing in a standard way. This routine places the
+ * generated error string at the end of a passed in string argument.
+ * @param error_string A string to put the generated error in. This string should be initialised before
+ * being passed to this routine. The routine will try to concatenate it's error string onto the end
+ * of any string already in existance.
+ * @see ccd_global.html#CCD_Global_Get_Current_Time_String
+ */
+void CCD_Timing_Error_String(char *error_string)
+{
+	char time_string[32];
+
+	CCD_Global_Get_Current_Time_String(time_string,32);
+	/* if the error number is zero an error message has not been set up
+	** This is in itself an error as we should not be calling this routine
+	** without there being an error to display */
+	if(Timing_Error_Number == 0)
+		sprintf(Timing_Error_String,"Logic Error:No Error defined");
+	sprintf(error_string+strlen(error_string),"%s CCD_Timing:Error(%d) : %s\n",time_string,
+		Timing_Error_Number,Timing_Error_String);
+}
+
+/* -----------------------------------------------------------------------------
+**     internal functions
+** ----------------------------------------------------------------------------- */
+/**
+ * Get the duration between two CLOCK_MONOTONIC times, in microseconds.
+ * @param end_time The later time.
+ * @param start_time The earlier time.
+ * @return The duration in microseconds, or 0 if end_time is before start_time.
+ */
+static unsigned long long Timing_Duration_Get(struct timespec end_time,struct timespec start_time)
+{
+	long long duration;
+
+	duration = (((long long)(end_time.tv_sec-start_time.tv_sec))*TIMING_ONE_SECOND_US)+
+		(((long long)(end_time.tv_nsec-start_time.tv_nsec))/CCD_GLOBAL_ONE_MICROSECOND_NS);
+	if(duration < 0)
+		return 0;
+	return (unsigned long long)duration;
+}
+
+/**
+ * Add a duration to a histogram.
+ * @param histogram The histogram.
+ * @param duration The duration, in microseconds.
+ * @see #Timing_Bucket_Index_Get
+ */
+static void Timing_Histogram_Add(struct Timing_Histogram_Struct *histogram,unsigned long long duration)
+{
+	histogram->Bucket_List[Timing_Bucket_Index_Get(duration)]++;
+	histogram->Count++;
+	if(duration > histogram->Max_Duration)
+		histogram->Max_Duration = duration;
+}
+
+/**
+ * Get the histogram bucket a duration is in. Durations below 2*TIMING_SUB_BUCKET_COUNT microseconds have their
+ * own bucket. Above that, a duration between 2^e and 2^(e+1) microseconds is in one of the
+ * TIMING_SUB_BUCKET_COUNT buckets for e, selected by it's top TIMING_SUB_BUCKET_BITS+1 bits.
+ * @param duration The duration, in microseconds.
+ * @return The bucket index, from 0 to TIMING_BUCKET_COUNT-1.
+ * @see #TIMING_SUB_BUCKET_BITS
+ * @see #TIMING_SUB_BUCKET_COUNT
+ * @see #TIMING_BUCKET_COUNT
+ */
+static int Timing_Bucket_Index_Get(unsigned long long duration)
+{
+	int exponent,shift;
+
+	if(duration < (2*TIMING_SUB_BUCKET_COUNT))
+		return (int)duration;
+	if(duration >= (1ULL<<TIMING_MAX_EXPONENT))
+		return TIMING_BUCKET_COUNT-1;
+	exponent = TIMING_SUB_BUCKET_BITS+1;
+	while((duration >> (exponent+1)) != 0)
+		exponent++;
+	shift = exponent-TIMING_SUB_BUCKET_BITS;
+	return (shift*TIMING_SUB_BUCKET_COUNT)+(int)(duration >> shift);
+}
+
+/**
+ * Get the duration represented by a histogram bucket, the middle of the range of durations in the bucket.
+ * @param bucket_index The bucket index, from 0 to TIMING_BUCKET_COUNT-1.
+ * @return The duration, in microseconds.
+ * @see #Timing_Bucket_Index_Get
+ */
+static unsigned long long Timing_Bucket_Duration_Get(int bucket_index)
+{
+	unsigned long long lower_duration;
+	int shift;
+
+	if(bucket_index < (2*TIMING_SUB_BUCKET_COUNT))
+		return (unsigned long long)bucket_index;
+	shift = (bucket_index/TIMING_SUB_BUCKET_COUNT)-1;
+	lower_duration = ((unsigned long long)((bucket_index%TIMING_SUB_BUCKET_COUNT)+TIMING_SUB_BUCKET_COUNT))
+		<< shift;
+	return lower_duration+((1ULL<<shift)/2);
+}
+
+/*
+** $Log: not supported by cvs2svn $
+*/
@@ -0,0 +1,865 @@
+/* ccd_trace.c
+** Controller request tracing module.
+** $Header$
+*/
+/**
+ * ccd_trace records every request sent to the SDSU controller device driver (all of which go through
+ * CCD_Interface_Command and CCD_Interface_Command_List), so that slow or failing controller traffic can be
+ * diagnosed on a production system, without rebuilding with a high LOGGING level.
+ * <ul>
+ * <li>Each request is timed with CLOCK_MONOTONIC. The request, the board and DSP command (for manual commands),
+ *     the first argument, the reply, the return value, the duration and how long the thread waited for the
+ *     controller access mutex (in ccd_dsp.c) before it are recorded.
+ * <li>The record is written into a ring buffer belonging to the calling thread, which holds the last
+ *     CCD_TRACE_RING_LENGTH requests. As only the owning thread writes into it, no locking is needed.
+ * <li>Latency counters (count, failures, TOUT and ERR replies, mean and maximum duration and mutex wait) are
+ *     kept for each request and DSP command. These are updated under a mutex that is only held for a few
+ *     additions.
+ * <li>CCD_Trace_Dump writes the counters and the contents of all the ring buffers to a file on demand.
+ * </ul>
+ * Tracing is on by default, and can be turned off with CCD_Trace_Set_Enable.
+ * @author Chris Mottram
+ * @version $Revision$
+ */
+/**
+ * This hash define is needed before including source files give us POSIX.4/IEEE1003.1b-1993 prototypes.
+ */
+#define _POSIX_SOURCE 1
+/**
+ * This hash define is needed before including source files give us POSIX.4/IEEE1003.1b-1993 prototypes.
+ */
+#define _POSIX_C_SOURCE 199309L
+#include <errno.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "log_udp.h"
+#include "ccd_global.h"
+#include "ccd_interface.h"
+#include "ccd_pci.h"
+#include "ccd_dsp.h"
+#include "ccd_trace.h"
+
+/**
+ * Revision Control System identifier.
+ */
+static char rcsid[] = "$Id$";
+
+/* hash defines */
+/**
+ * The value of the Command field of a record or counter, when the request does not have a DSP command
+ * or HCVR vector associated with it.
+ */
+#define TRACE_NO_COMMAND		(-1)
+/**
+ * The number of microseconds in one second.
+ */
+#define TRACE_ONE_SECOND_US		(1000000)
+/**
+ * The column headings of the latency counter lines.
+ * @see #Trace_Counter_To_String
+ */
+#define TRACE_COUNTER_HEADER		"# Request Command Count Fail TOUT ERR Mean(us) Max(us) Mean_Mutex_Wait(us) "\
+					"Max_Mutex_Wait(us)"
+/**
+ * The length of the string describing one latency counter.
+ * @see #Trace_Counter_To_String
+ */
+#define TRACE_COUNTER_STRING_LENGTH	(256)
+
+/* data types */
+/**
+ * Data type holding one traced controller request.
+ * <dl>
+ * <dt>Time</dt> <dd>When the request was sent (CLOCK_REALTIME), so the record can be matched against the logs.</dd>
+ * <dt>Request</dt> <dd>The ioctl request, one of the CCD_PCI_IOCTL_* values.</dd>
+ * <dt>Board</dt> <dd>The board the DSP command was sent to, for CCD_PCI_IOCTL_COMMAND requests.</dd>
+ * <dt>Command</dt> <dd>The DSP manual command for CCD_PCI_IOCTL_COMMAND requests, the HCVR vector for
+ *     CCD_PCI_IOCTL_SET_HCVR requests, or TRACE_NO_COMMAND.</dd>
+ * <dt>Argument</dt> <dd>The first argument of the DSP command, or the value sent for other requests.</dd>
+ * <dt>Reply</dt> <dd>The value returned by the request.</dd>
+ * <dt>Return_Value</dt> <dd>The return value of the interface command routine (TRUE or FALSE).</dd>
+ * <dt>Duration</dt> <dd>How long the request took, in microseconds.</dd>
+ * <dt>Mutex_Wait</dt> <dd>How long the thread waited for the controller access mutex before the request,
+ *     in microseconds.</dd>
+ * </dl>
+ */
+struct Trace_Record_Struct
+{
+	struct timespec Time;
+	int Request;
+	int Board;
+	int Command;
+	int Argument;
+	int Reply;
+	int Return_Value;
+	unsigned int Duration;
+	unsigned int Mutex_Wait;
+};
+
+/**
+ * Data type holding the trace ring buffer for one thread.
+ * <dl>
+ * <dt>In_Use</dt> <dd>A boolean, whether a thread owns this ring buffer.</dd>
+ * <dt>Thread_Number</dt> <dd>A number identifying the owning thread in the dump, incremented for each new
+ *     thread traced.</dd>
+ * <dt>Record_Count</dt> <dd>The number of requests recorded. The next record is written at
+ *     Record_Count % CCD_TRACE_RING_LENGTH.</dd>
+ * <dt>Pending_Mutex_Wait</dt> <dd>The mutex wait time (in microseconds) to add to the thread's next request.</dd>
+ * <dt>Record_List</dt> <dd>The ring buffer of requests.</dd>
+ * </dl>
+ * @see #Trace_Record_Struct
+ * @see #CCD_TRACE_RING_LENGTH
+ */
+struct Trace_Ring_Struct
+{
+	int In_Use;
+	unsigned int Thread_Number;
+	volatile unsigned int Record_Count;
+	unsigned int Pending_Mutex_Wait;
+	struct Trace_Record_Struct Record_List[CCD_TRACE_RING_LENGTH];
+};
+
+/**
+ * Data type holding the latency counters for one request and DSP command.
+ * <dl>
+ * <dt>Request</dt> <dd>The ioctl request, one of the CCD_PCI_IOCTL_* values.</dd>
+ * <dt>Command</dt> <dd>The DSP manual command, HCVR vector or TRACE_NO_COMMAND.</dd>
+ * <dt>Count</dt> <dd>The number of requests sent.</dd>
+ * <dt>Fail_Count</dt> <dd>The number of requests where the interface command routine returned FALSE.</dd>
+ * <dt>Tout_Count</dt> <dd>The number of requests that returned a TOUT (timeout) reply.</dd>
+ * <dt>Err_Count</dt> <dd>The number of requests that returned an ERR reply.</dd>
+ * <dt>Total_Duration</dt> <dd>The sum of the request durations, in microseconds.</dd>
+ * <dt>Max_Duration</dt> <dd>The longest request duration, in microseconds.</dd>
+ * <dt>Total_Mutex_Wait</dt> <dd>The sum of the mutex wait times, in microseconds.</dd>
+ * <dt>Max_Mutex_Wait</dt> <dd>The longest mutex wait time, in microseconds.</dd>
+ * </dl>
+ */
+struct Trace_Counter_Struct
+{
+	int Request;
+	int Command;
+	unsigned int Count;
+	unsigned int Fail_Count;
+	unsigned int Tout_Count;
+	unsigned int Err_Count;
+	unsigned long long Total_Duration;
+	unsigned int Max_Duration;
+	unsigned long long Total_Mutex_Wait;
+	unsigned int Max_Mutex_Wait;
+};
+
+/**
+ * Data type holding local data to ccd_trace.
+ * <dl>
+ * <dt>Enable</dt> <dd>A boolean, whether requests are traced.</dd>
+ * <dt>Ring_List</dt> <dd>The per-thread ring buffers.</dd>
+ * <dt>Thread_Count</dt> <dd>The number of threads that have been given a ring buffer.</dd>
+ * <dt>Counter_List</dt> <dd>The latency counters.</dd>
+ * <dt>Counter_Count</dt> <dd>The number of latency counters in use.</dd>
+ * <dt>Overflow_Counter</dt> <dd>The latency counter used when Counter_List is full.</dd>
+ * <dt>Mutex</dt> <dd>Protects allocating ring buffers and the latency counters.</dd>
+ * <dt>Key</dt> <dd>The thread specific data key holding the calling thread's ring buffer.</dd>
+ * <dt>Key_Once</dt> <dd>Used to create the key once only.</dd>
+ * </dl>
+ * @see #Trace_Ring_Struct
+ * @see #Trace_Counter_Struct
+ * @see #CCD_TRACE_MAX_THREAD_COUNT
+ * @see #CCD_TRACE_MAX_COUNTER_COUNT
+ */
+struct Trace_Struct
+{
+	volatile int Enable;
+	struct Trace_Ring_Struct Ring_List[CCD_TRACE_MAX_THREAD_COUNT];
+	unsigned int Thread_Count;
+	struct Trace_Counter_Struct Counter_List[CCD_TRACE_MAX_COUNTER_COUNT];
+	int Counter_Count;
+	struct Trace_Counter_Struct Overflow_Counter;
+	pthread_mutex_t Mutex;
+	pthread_key_t Key;
+	pthread_once_t Key_Once;
+};
+
+/* internal variables */
+/**
+ * Variable holding error code of last operation performed by ccd_trace.
+ */
+static int Trace_Error_Number = 0;
+/**
+ * Local variable holding description of the last error that occured.
+ */
+static char Trace_Error_String[CCD_GLOBAL_ERROR_STRING_LENGTH] = "";
+/**
+ * Local trace data. This is zeroed at startup, apart from tracing being enabled and the mutex and once control.
+ * @see #Trace_Struct
+ */
+static struct Trace_Struct Trace_Data =
+{
+	TRUE,{{0}},0,{{0}},0,{0},PTHREAD_MUTEX_INITIALIZER,0,PTHREAD_ONCE_INIT
+};
+/**
+ * A value stored against the key for threads that could not be given a ring buffer (all
+ * CCD_TRACE_MAX_THREAD_COUNT were in use), so we don't try to allocate one for every request they send.
+ * @see #Trace_Ring_Get
+ */
+static struct Trace_Ring_Struct Trace_No_Ring;
+
+/* internal function definitions */
+static void Trace_Key_Create(void);
+static void Trace_Ring_Release(void *ring_ptr);
+static struct Trace_Ring_Struct *Trace_Ring_Get(void);
+static void Trace_Counter_Add(struct Trace_Record_Struct *record);
+static unsigned int Trace_Duration_Get(struct timespec end_time,struct timespec start_time);
+static char *Trace_Request_To_String(int request);
+static void Trace_Command_To_String(int request,int command,char *command_string);
+static int Trace_Counter_List_Copy(struct Trace_Counter_Struct *counter_list);
+static void Trace_Counter_To_String(struct Trace_Counter_Struct *counter,char *counter_string);
+
+/* -----------------------------------------------------------------------------
+**     external functions
+** ----------------------------------------------------------------------------- */
+/**
+ * This routine sets up ccd_trace internal variables, clearing the counters and ring buffers.
+ * It should be called at startup.
+ * @return This routine returns TRUE for success.
+ * @see #CCD_Trace_Reset
+ */
+int CCD_Trace_Initialise(void)
+{
+	Trace_Error_Number = 0;
+/* print some compile time information to stdout */
+	fprintf(stdout,"CCD_Trace_Initialise:%s.\n",rcsid);
+	pthread_once(&(Trace_Data.Key_Once),Trace_Key_Create);
+	return CCD_Trace_Reset();
+}
+
+/**
+ * Routine to turn controller request tracing on or off.
+ * @param enable A boolean, whether to trace requests.
+ * @see #Trace_Data
+ */
+void CCD_Trace_Set_Enable(int enable)
+{
+	Trace_Data.Enable = enable;
+}
+
+/**
+ * Routine to get whether controller request tracing is on.
+ * @return A boolean, TRUE if requests are being traced.
+ * @see #Trace_Data
+ */
+int CCD_Trace_Get_Enable(void)
+{
+	return Trace_Data.Enable;
+}
+
+/**
+ * Routine called by the interface command routines before they send a request to the device. This just gets
+ * the start time of the request, or zeroes it if tracing is off.
+ * @param start_time The address of a timespec to store the start time in.
+ * @see #Trace_Data
+ * @see #CCD_Trace_Request_End
+ * @see ccd_interface.html#CCD_Interface_Command
+ * @see ccd_interface.html#CCD_Interface_Command_List
+ */
+void CCD_Trace_Request_Start(struct timespec *start_time)
+{
+	if(Trace_Data.Enable)
+		clock_gettime(CLOCK_MONOTONIC,start_time);
+	else
+	{
+		start_time->tv_sec = 0;
+		start_time->tv_nsec = 0;
+	}
+}
+
+/**
+ * Routine called by the interface command routines after a request has been sent to the device. The request
+ * is recorded in the calling thread's ring buffer (if it has one), and added to the latency counters.
+ * For CCD_PCI_IOCTL_COMMAND requests the board and DSP command are decoded from the header and command words
+ * passed in, for CCD_PCI_IOCTL_SET_HCVR requests the HCVR vector is the value that was passed in.
+ * @param start_time The start time returned by CCD_Trace_Request_Start. If this is zero, tracing was off
+ *        when the request was sent, and the request is not traced.
+ * @param request The ioctl request sent, one of the CCD_PCI_IOCTL_* values.
+ * @param argument_list The argument list sent to the device, as it was before the request was sent.
+ * @param argument_count The number of arguments in argument_list.
+ * @param reply The value returned by the request (the first element of the argument list after the request).
+ * @param return_value The return value of the device specific command routine.
+ * @see #Trace_Data
+ * @see #Trace_Ring_Get
+ * @see #Trace_Counter_Add
+ * @see #CCD_Trace_Request_Start
+ */
+void CCD_Trace_Request_End(struct timespec start_time,int request,int *argument_list,int argument_count,
+			   int reply,int return_value)
+{
+	struct Trace_Ring_Struct *ring = NULL;
+	struct Trace_Record_Struct record;
+	struct timespec end_time;
+
+	if((start_time.tv_sec == 0)&&(start_time.tv_nsec == 0))
+		return;
+	clock_gettime(CLOCK_MONOTONIC,&end_time);
+	clock_gettime(CLOCK_REALTIME,&(record.Time));
+	record.Duration = Trace_Duration_Get(end_time,start_time);
+	/* convert to the realtime clock time the request was sent */
+	record.Time.tv_sec -= record.Duration/TRACE_ONE_SECOND_US;
+	record.Time.tv_nsec -= (record.Duration%TRACE_ONE_SECOND_US)*CCD_GLOBAL_ONE_MICROSECOND_NS;
+	if(record.Time.tv_nsec < 0)
+	{
+		record.Time.tv_sec--;
+		record.Time.tv_nsec += CCD_GLOBAL_ONE_SECOND_NS;
+	}
+	record.Request = request;
+	record.Board = 0;
+	record.Command = TRACE_NO_COMMAND;
+	record.Argument = 0;
+	if((request == CCD_PCI_IOCTL_COMMAND)&&(argument_list != NULL)&&(argument_count >= 2))
+	{
+		record.Board = (argument_list[0] >> 8)&0xff;
+		record.Command = argument_list[1];
+		if(argument_count > 2)
+			record.Argument = argument_list[2];
+	}
+	else if((argument_list != NULL)&&(argument_count >= 1))
+	{
+		if(request == CCD_PCI_IOCTL_SET_HCVR)
+			record.Command = argument_list[0];
+		else
+			record.Argument = argument_list[0];
+	}
+	record.Reply = reply;
+	record.Return_Value = return_value;
+	record.Mutex_Wait = 0;
+	ring = Trace_Ring_Get();
+	if(ring != NULL)
+	{
+		record.Mutex_Wait = ring->Pending_Mutex_Wait;
+		ring->Pending_Mutex_Wait = 0;
+		ring->Record_List[ring->Record_Count%CCD_TRACE_RING_LENGTH] = record;
+		ring->Record_Count++;
+	}
+	Trace_Counter_Add(&record);
+}
+
+/**
+ * Routine called by ccd_dsp.c when it has acquired the controller access mutex. The time waited is added to the
+ * next request the calling thread sends.
+ * @param start_time When the thread started waiting for the mutex (CLOCK_MONOTONIC).
+ * @see #Trace_Data
+ * @see #Trace_Ring_Get
+ */
+void CCD_Trace_Mutex_Wait(struct timespec start_time)
+{
+	struct Trace_Ring_Struct *ring = NULL;
+	struct timespec end_time;
+
+	if(Trace_Data.Enable == FALSE)
+		return;
+	clock_gettime(CLOCK_MONOTONIC,&end_time);
+	ring = Trace_Ring_Get();
+	if(ring != NULL)
+		ring->Pending_Mutex_Wait += Trace_Duration_Get(end_time,start_time);
+}
+
+/**
+ * Routine to clear the latency counters and all the ring buffers.
+ * @return The routine returns TRUE.
+ * @see #Trace_Data
+ */
+int CCD_Trace_Reset(void)
+{
+	int i;
+
+	Trace_Error_Number = 0;
+	pthread_mutex_lock(&(Trace_Data.Mutex));
+	memset(Trace_Data.Counter_List,0,sizeof(Trace_Data.Counter_List));
+	Trace_Data.Counter_Count = 0;
+	memset(&(Trace_Data.Overflow_Counter),0,sizeof(struct Trace_Counter_Struct));
+	Trace_Data.Overflow_Counter.Request = -1;
+	Trace_Data.Overflow_Counter.Command = TRACE_NO_COMMAND;
+	for(i = 0; i < CCD_TRACE_MAX_THREAD_COUNT; i++)
+		Trace_Data.Ring_List[i].Record_Count = 0;
+	pthread_mutex_unlock(&(Trace_Data.Mutex));
+	return TRUE;
+}
+
+/**
+ * Routine to dump the latency counters and ring buffers to a file.
+ * @param filename The filename to write the dump to. The file is overwritten.
+ * @return The routine returns TRUE on success, and FALSE if an error occurs.
+ * @see #CCD_Trace_Dump_Stream
+ */
+int CCD_Trace_Dump(char *filename)
+{
+	FILE *fp = NULL;
+	int retval;
+
+	Trace_Error_Number = 0;
+	if(filename == NULL)
+	{
+		Trace_Error_Number = 1;
+		sprintf(Trace_Error_String,"CCD_Trace_Dump:filename was NULL.");
+		return FALSE;
+	}
+#if LOGGING > 4
+	CCD_Global_Log_Format(LOG_VERBOSITY_VERBOSE,"CCD_Trace_Dump:Dumping controller trace to %s.",filename);
+#endif
+	fp = fopen(filename,"w");
+	if(fp == NULL)
+	{
+		Trace_Error_Number = 2;
+		sprintf(Trace_Error_String,"CCD_Trace_Dump:Failed to open '%s' (%d:%s).",filename,errno,
+			strerror(errno));
+		return FALSE;
+	}
+	retval = CCD_Trace_Dump_Stream(fp);
+	if(fclose(fp) != 0)
+	{
+		if(retval == FALSE)
+			return FALSE;
+		Trace_Error_Number = 3;
+		sprintf(Trace_Error_String,"CCD_Trace_Dump:Failed to close '%s' (%d:%s).",filename,errno,
+			strerror(errno));
+		return FALSE;
+	}
+	return retval;
+}
+
+/**
+ * Routine to dump the latency counters and ring buffers to a stream. The counters are written first, one line
+ * per request/DSP command, followed by the ring buffer of each thread, oldest request first. The ring buffers
+ * are copied without stopping the threads writing into them, so the request being recorded whilst the dump
+ * is taken may be inconsistent.
+ * @param fp The stream to write to.
+ * @return The routine returns TRUE on success, and FALSE if an error occurs.
+ * @see #Trace_Data
+ * @see #Trace_Counter_List_Copy
+ * @see #Trace_Counter_To_String
+ * @see #Trace_Request_To_String
+ * @see #Trace_Command_To_String
+ */
+int CCD_Trace_Dump_Stream(FILE *fp)
+{
+	struct Trace_Counter_Struct counter_list[CCD_TRACE_MAX_COUNTER_COUNT+1];
+	struct Trace_Record_Struct *record = NULL;
+	struct tm time_tm;
+	char counter_string[TRACE_COUNTER_STRING_LENGTH];
+	char command_string[32];
+	char time_string[32];
+	unsigned int record_count,thread_number,first,i;
+	int counter_count,ring_index,in_use;
+
+	Trace_Error_Number = 0;
+	if(fp == NULL)
+	{
+		Trace_Error_Number = 4;
+		sprintf(Trace_Error_String,"CCD_Trace_Dump_Stream:fp was NULL.");
+		return FALSE;
+	}
+	/* copy the counters, so the mutex is not held whilst writing them */
+	counter_count = Trace_Counter_List_Copy(counter_list);
+	fprintf(fp,"# Controller request latency counters (tracing %s).\n",Trace_Data.Enable ? "on" : "off");
+	fprintf(fp,"%s\n",TRACE_COUNTER_HEADER);
+	for(i = 0; i < (unsigned int)counter_count; i++)
+	{
+		Trace_Counter_To_String(&(counter_list[i]),counter_string);
+		fprintf(fp,"%s\n",counter_string);
+	}
+	for(ring_index = 0; ring_index < CCD_TRACE_MAX_THREAD_COUNT; ring_index++)
+	{
+		pthread_mutex_lock(&(Trace_Data.Mutex));
+		in_use = Trace_Data.Ring_List[ring_index].In_Use;
+		thread_number = Trace_Data.Ring_List[ring_index].Thread_Number;
+		record_count = Trace_Data.Ring_List[ring_index].Record_Count;
+		pthread_mutex_unlock(&(Trace_Data.Mutex));
+		if(record_count == 0)
+			continue;
+		if(record_count > CCD_TRACE_RING_LENGTH)
+			first = record_count-CCD_TRACE_RING_LENGTH;
+		else
+			first = 0;
+		fprintf(fp,"# Thread %u%s: last %u of %u requests.\n",thread_number,in_use ? "" : " (exited)",
+			record_count-first,record_count);
+		fprintf(fp,"# Time Request Board Command Argument Reply Return Duration(us) Mutex_Wait(us)\n");
+		for(i = first; i < record_count; i++)
+		{
+			record = &(Trace_Data.Ring_List[ring_index].Record_List[i%CCD_TRACE_RING_LENGTH]);
+			gmtime_r(&(record->Time.tv_sec),&time_tm);
+			strftime(time_string,32,"%Y-%m-%dT%H:%M:%S",&time_tm);
+			Trace_Command_To_String(record->Request,record->Command,command_string);
+			fprintf(fp,"%s.%06ld %s %s %s %#x %#x %s %u %u\n",time_string,
+				record->Time.tv_nsec/CCD_GLOBAL_ONE_MICROSECOND_NS,
+				Trace_Request_To_String(record->Request),
+				(record->Request == CCD_PCI_IOCTL_COMMAND) ?
+				CCD_DSP_Print_Board_ID((enum CCD_DSP_BOARD_ID)(record->Board)) : "-",
+				command_string,record->Argument,record->Reply,record->Return_Value ? "TRUE" : "FALSE",
+				record->Duration,record->Mutex_Wait);
+		}
+	}
+	if(ferror(fp))
+	{
+		Trace_Error_Number = 5;
+		sprintf(Trace_Error_String,"CCD_Trace_Dump_Stream:Writing the dump failed.");
+		return FALSE;
+	}
+	return TRUE;
+}
+
+/**
+ * Routine to get the latency counters (but not the ring buffers) as a string, one line per request/DSP
+ * command, in the same format as CCD_Trace_Dump_Stream. This does no file I/O, so it is cheap enough
+ * to call from a status request.
+ * @param counters_string A string to put the counters in.
+ * @param counters_string_length The length of counters_string. CCD_TRACE_COUNTERS_STRING_LENGTH is always
+ *        long enough, counters that do not fit into a shorter string are left out.
+ * @return The routine returns TRUE on success, and FALSE if an error occurs.
+ * @see #Trace_Counter_List_Copy
+ * @see #Trace_Counter_To_String
+ * @see #CCD_TRACE_COUNTERS_STRING_LENGTH
+ */
+int CCD_Trace_Counters_Get(char *counters_string,size_t counters_string_length)
+{
+	struct Trace_Counter_Struct counter_list[CCD_TRACE_MAX_COUNTER_COUNT+1];
+	char counter_string[TRACE_COUNTER_STRING_LENGTH];
+	size_t length,counter_length;
+	int counter_count,i;
+
+	Trace_Error_Number = 0;
+	if(counters_string == NULL)
+	{
+		Trace_Error_Number = 6;
+		sprintf(Trace_Error_String,"CCD_Trace_Counters_Get:counters_string was NULL.");
+		return FALSE;
+	}
+	if(counters_string_length < (strlen(TRACE_COUNTER_HEADER)+2))
+	{
+		Trace_Error_Number = 7;
+		sprintf(Trace_Error_String,"CCD_Trace_Counters_Get:counters_string too short (%lu).",
+			(unsigned long)counters_string_length);
+		return FALSE;
+	}
+	counter_count = Trace_Counter_List_Copy(counter_list);
+	strcpy(counters_string,TRACE_COUNTER_HEADER);
+	strcat(counters_string,"\n");
+	length = strlen(counters_string);
+	for(i = 0; i < counter_count; i++)
+	{
+		Trace_Counter_To_String(&(counter_list[i]),counter_string);
+		counter_length = strlen(counter_string);
+		if((length+counter_length+2) > counters_string_length)
+			break;
+		strcpy(counters_string+length,counter_string);
+		strcpy(counters_string+length+counter_length,"\n");
+		length += counter_length+1;
+	}
+	return TRUE;
+}
+
+/**
+ * Get the current value of the error number.
+ * @return The current value of the error number.
+ */
+int CCD_Trace_Get_Error_Number(void)
+{
+	return Trace_Error_Number;
+}
+
+/**
+ * The error routine that reports any errors occuring in ccd_trace in a standard way.
+ * @see ccd_global.html#CCD_Global_Get_Current_Time_String
+ */
+void CCD_Trace_Error(void)
+{
+	char time_string[32];
+
+	CCD_Global_Get_Current_Time_String(time_string,32);
+	/* if the error number is zero an error message has not been set up
+	** This is in itself an error as we should not be calling this routine
+	** without there being an error to display */
+	if(Trace_Error_Number == 0)
+		sprintf(Trace_Error_String,"Logic Error:No Error defined");
+	fprintf(stderr,"%s CCD_Trace:Error(%d) : %s\n",time_string,Trace_Error_Number,Trace_Error_String);
+}
+
+/**
+ * The error routine that reports any errors occuring in ccd_trace in a standard way. This routine places the
+ * generated error string at the end of a passed in string argument.
+ * @param error_string A string to put the generated error in. This string should be initialised before
+ * being passed to this routine. The routine will try to concatenate it's error string onto the end
+ * of any string already in existance.
+ * @see ccd_global.html#CCD_Global_Get_Current_Time_String
+ */
+void CCD_Trace_Error_String(char *error_string)
+{
+	char time_string[32];
+
+	CCD_Global_Get_Current_Time_String(time_string,32);
+	/* if the error number is zero an error message has not been set up
+	** This is in itself an error as we should not be calling this routine
+	** without there being an error to display */
+	if(Trace_Error_Number == 0)
+		sprintf(Trace_Error_String,"Logic Error:No Error defined");
+	sprintf(error_string+strlen(error_string),"%s CCD_Trace:Error(%d) : %s\n",time_string,
+		Trace_Error_Number,Trace_Error_String);
+}
+
+/* -----------------------------------------------------------------------------
+**     internal functions
+** ----------------------------------------------------------------------------- */
+/**
+ * Create the thread specific data key used to find each thread's ring buffer. Called once only,
+ * using pthread_once.
+ * @see #Trace_Data
+ * @see #Trace_Ring_Release
+ */
+static void Trace_Key_Create(void)
+{
+	pthread_key_create(&(Trace_Data.Key),Trace_Ring_Release);
+}
+
+/**
+ * Thread specific data destructor, called when a thread with a ring buffer exits. The ring buffer is marked
+ * as free, so another thread can use it. It's records are kept until then, so they still appear in a dump.
+ * @param ring_ptr The thread's ring buffer, or Trace_No_Ring.
+ * @see #Trace_Data
+ * @see #Trace_No_Ring
+ */
+static void Trace_Ring_Release(void *ring_ptr)
+{
+	struct Trace_Ring_Struct *ring = (struct Trace_Ring_Struct *)ring_ptr;
+
+	if((ring == NULL)||(ring == &Trace_No_Ring))
+		return;
+	pthread_mutex_lock(&(Trace_Data.Mutex));
+	ring->In_Use = FALSE;
+	pthread_mutex_unlock(&(Trace_Data.Mutex));
+}
+
+/**
+ * Get the calling thread's ring buffer. The first time a thread calls this a free ring buffer is found for it
+ * (preferring one that has never been used, and otherwise one belonging to an exited thread).
+ * @return The thread's ring buffer, or NULL if there were no free ring buffers for the thread.
+ * @see #Trace_Data
+ * @see #Trace_No_Ring
+ */
+static struct Trace_Ring_Struct *Trace_Ring_Get(void)
+{
+	struct Trace_Ring_Struct *ring = NULL;
+	int i,ring_index;
+
+	pthread_once(&(Trace_Data.Key_Once),Trace_Key_Create);
+	ring = (struct Trace_Ring_Struct *)pthread_getspecific(Trace_Data.Key);
+	if(ring == &Trace_No_Ring)
+		return NULL;
+	if(ring != NULL)
+		return ring;
+	pthread_mutex_lock(&(Trace_Data.Mutex));
+	ring_index = -1;
+	for(i = 0; i < CCD_TRACE_MAX_THREAD_COUNT; i++)
+	{
+		if(Trace_Data.Ring_List[i].In_Use)
+			continue;
+		if(Trace_Data.Ring_List[i].Record_Count == 0)
+		{
+			ring_index = i;
+			break;
+		}
+		if(ring_index == -1)
+			ring_index = i;
+	}
+	if(ring_index == -1)
+	{
+		pthread_mutex_unlock(&(Trace_Data.Mutex));
+		pthread_setspecific(Trace_Data.Key,&Trace_No_Ring);
+		return NULL;
+	}
+	ring = &(Trace_Data.Ring_List[ring_index]);
+	ring->In_Use = TRUE;
+	ring->Thread_Number = Trace_Data.Thread_Count++;
+	ring->Record_Count = 0;
+	ring->Pending_Mutex_Wait = 0;
+	pthread_mutex_unlock(&(Trace_Data.Mutex));
+	pthread_setspecific(Trace_Data.Key,ring);
+	return ring;
+}
+
+/**
+ * Add a request to the latency counters. The counter for the request and DSP command is found (or created),
+ * or the overflow counter is used if there are no free counters.
+ * @param record The traced request.
+ * @see #Trace_Data
+ */
+static void Trace_Counter_Add(struct Trace_Record_Struct *record)
+{
+	struct Trace_Counter_Struct *counter = NULL;
+	int i;
+
+	pthread_mutex_lock(&(Trace_Data.Mutex));
+	for(i = 0; i < Trace_Data.Counter_Count; i++)
+	{
+		if((Trace_Data.Counter_List[i].Request == record->Request)&&
+		   (Trace_Data.Counter_List[i].Command == record->Command))
+		{
+			counter = &(Trace_Data.Counter_List[i]);
+			break;
+		}
+	}
+	if(counter == NULL)
+	{
+		if(Trace_Data.Counter_Count < CCD_TRACE_MAX_COUNTER_COUNT)
+		{
+			counter = &(Trace_Data.Counter_List[Trace_Data.Counter_Count++]);
+			counter->Request = record->Request;
+			counter->Command = record->Command;
+		}
+		else
+			counter = &(Trace_Data.Overflow_Counter);
+	}
+	counter->Count++;
+	if(record->Return_Value == FALSE)
+		counter->Fail_Count++;
+	if(record->Reply == CCD_DSP_TOUT)
+		counter->Tout_Count++;
+	else if(record->Reply == CCD_DSP_ERR)
+		counter->Err_Count++;
+	counter->Total_Duration += record->Duration;
+	if(record->Duration > counter->Max_Duration)
+		counter->Max_Duration = record->Duration;
+	counter->Total_Mutex_Wait += record->Mutex_Wait;
+	if(record->Mutex_Wait > counter->Max_Mutex_Wait)
+		counter->Max_Mutex_Wait = record->Mutex_Wait;
+	pthread_mutex_unlock(&(Trace_Data.Mutex));
+}
+
+/**
+ * Get the duration between two CLOCK_MONOTONIC times, in microseconds.
+ * @param end_time The later time.
+ * @param start_time The earlier time.
+ * @return The duration in microseconds, or 0 if end_time is before start_time.
+ */
+static unsigned int Trace_Duration_Get(struct timespec end_time,struct timespec start_time)
+{
+	long long duration;
+
+	duration = (((long long)(end_time.tv_sec-start_time.tv_sec))*TRACE_ONE_SECOND_US)+
+		(((long long)(end_time.tv_nsec-start_time.tv_nsec))/CCD_GLOBAL_ONE_MICROSECOND_NS);
+	if(duration < 0)
+		return 0;
+	return (unsigned int)duration;
+}
+
+/**
+ * Get a name for an ioctl request.
+ * @param request The ioctl request, one of the CCD_PCI_IOCTL_* values.
+ * @return A string describing the request, i.e. "COMMAND", or "UNKNOWN".
+ */
+static char *Trace_Request_To_String(int request)
+{
+	switch(request)
+	{
+		case CCD_PCI_IOCTL_GET_HCTR:
+			return "GET_HCTR";
+		case CCD_PCI_IOCTL_GET_PROGRESS:
+			return "GET_PROGRESS";
+		case CCD_PCI_IOCTL_GET_DMA_ADDR:
+			return "GET_DMA_ADDR";
+		case CCD_PCI_IOCTL_GET_HSTR:
+			return "GET_HSTR";
+		case CCD_PCI_IOCTL_HCVR_DATA:
+			return "HCVR_DATA";
+		case CCD_PCI_IOCTL_SET_HCTR:
+			return "SET_HCTR";
+		case CCD_PCI_IOCTL_SET_HCVR:
+			return "SET_HCVR";
+		case CCD_PCI_IOCTL_PCI_DOWNLOAD:
+			return "PCI_DOWNLOAD";
+		case CCD_PCI_IOCTL_PCI_DOWNLOAD_WAIT:
+			return "PCI_DOWNLOAD_WAIT";
+		case CCD_PCI_IOCTL_COMMAND:
+			return "COMMAND";
+		case CCD_PCI_IOCTL_SET_CMDR:
+			return "SET_CMDR";
+		case CCD_PCI_IOCTL_SET_DESTINATION:
+			return "SET_DESTINATION";
+		case CCD_PCI_IOCTL_SET_IMAGE_BUFFERS:
+			return "SET_IMAGE_BUFFERS";
+		case CCD_PCI_IOCTL_SET_UTIL_OPTIONS:
+			return "SET_UTIL_OPTIONS";
+		case CCD_PCI_IOCTL_ABORT_READ:
+			return "ABORT_READ";
+		default:
+			return "UNKNOWN";
+	}
+}
+
+/**
+ * Get a description of the DSP command or HCVR vector sent by a request.
+ * @param request The ioctl request, one of the CCD_PCI_IOCTL_* values.
+ * @param command The DSP manual command, HCVR vector or TRACE_NO_COMMAND.
+ * @param command_string A string of at least 32 characters to put the description in. This is the
+ *        three letter mnemonic for a DSP manual command, the vector (in hex) for a HCVR request,
+ *        and "-" otherwise.
+ * @see ccd_dsp.html#CCD_DSP_Command_Manual_To_String
+ */
+static void Trace_Command_To_String(int request,int command,char *command_string)
+{
+	if(command == TRACE_NO_COMMAND)
+		strcpy(command_string,"-");
+	else if(request == CCD_PCI_IOCTL_COMMAND)
+	{
+		/* CCD_DSP_Command_Manual_To_String returns a static buffer, copy it straight away */
+		strncpy(command_string,CCD_DSP_Command_Manual_To_String(command),31);
+		command_string[31] = '\0';
+	}
+	else
+		sprintf(command_string,"%#x",command);
+}
+
+/**
+ * Copy the latency counters (and the overflow counter, if it has been used), holding the mutex only
+ * whilst copying.
+ * @param counter_list A list of at least CCD_TRACE_MAX_COUNTER_COUNT+1 counters to copy into.
+ * @return The number of counters copied.
+ * @see #Trace_Data
+ */
+static int Trace_Counter_List_Copy(struct Trace_Counter_Struct *counter_list)
+{
+	int counter_count;
+
+	pthread_mutex_lock(&(Trace_Data.Mutex));
+	counter_count = Trace_Data.Counter_Count;
+	memcpy(counter_list,Trace_Data.Counter_List,counter_count*sizeof(struct Trace_Counter_Struct));
+	if(Trace_Data.Overflow_Counter.Count > 0)
+	{
+		counter_list[counter_count] = Trace_Data.Overflow_Counter;
+		counter_count++;
+	}
+	pthread_mutex_unlock(&(Trace_Data.Mutex));
+	return counter_count;
+}
+
+/**
+ * Describe one latency counter, in the columns given by TRACE_COUNTER_HEADER.
+ * @param counter The counter to describe.
+ * @param counter_string A string of at least TRACE_COUNTER_STRING_LENGTH characters to put the description in.
+ * @see #TRACE_COUNTER_HEADER
+ * @see #TRACE_COUNTER_STRING_LENGTH
+ * @see #Trace_Request_To_String
+ * @see #Trace_Command_To_String
+ */
+static void Trace_Counter_To_String(struct Trace_Counter_Struct *counter,char *counter_string)
+{
+	char command_string[32];
+
+	Trace_Command_To_String(counter->Request,counter->Command,command_string);
+	sprintf(counter_string,"%s %s %u %u %u %u %.1f %u %.1f %u",Trace_Request_To_String(counter->Request),
+		command_string,counter->Count,counter->Fail_Count,counter->Tout_Count,counter->Err_Count,
+		((double)counter->Total_Duration)/((double)counter->Count),counter->Max_Duration,
+		((double)counter->Total_Mutex_Wait)/((double)counter->Count),counter->Max_Mutex_Wait);
+}
+
+/*
+** $Log: not supported by cvs2svn $
+*/
@@ -22,16 +22,33 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdint.h>
 #include <jni.h>
 #include <time.h>
+#include "log_udp.h"
 #include "ccd_global.h"
+#include "ccd_combine.h"
+#include "ccd_compress.h"
+#include "ccd_disk_write.h"
+#include "ccd_frame_ring.h"
+#include "ccd_preview.h"
+#include "ccd_timing.h"
+#include "ccd_trace.h"
+#include "ccd_frame_view.h"
+#include "ccd_exposure_event.h"
+#include "ccd_status.h"
 #include "ccd_dsp.h"
 #include "ccd_exposure.h"
 #include "ccd_filter_wheel.h"
 #include "ccd_interface.h"
 #include "ccd_pci.h"
 #include "ccd_pixel_stream.h"
+#include "ccd_seeing.h"
+#include "ccd_readout_watchdog.h"
 #include "ccd_setup.h"
+#include "ccd_source_find.h"
+#include "ccd_telemetry.h"
+#include "ccd_telemetry_store.h"
 #include "ccd_temperature.h"
 #include "ccd_text.h"
 #include "ngat_o_ccd_CCDLibrary.h"
@@ -46,24 +63,29 @@
 #define CCD_ERROR_LENGTH	1024
 
 /**
- * Hash define for the size of the array holding CCDLibrary Instance (jobject) maps to CCD_Interface_Handle_T.
+ * Hash define for the size of the array holding the CCD_Interface_Handle_T's opened by CCDLibrary instances.
  * Set to 5.
  */
 #define HANDLE_MAP_SIZE         (5)
 
 /* internal structures */
 /**
- * Structure holding mapping between CCDLibrary Instances (jobject) to CCD_Interface_Handle_T.
+ * Structure holding a CCD_Interface_Handle_T opened by a CCDLibrary instance.
  * This means each CCDLibrary object talks to one SDSU controller.
+ * The CCDLibrary instance holds the generation in it's nativeHandleGeneration field. The generation is unique
+ * to each open, and encodes the map index (generation % HANDLE_MAP_SIZE), so the handle can be found
+ * without searching the map, and a stale generation (from an instance that has been closed) never matches.
  * <dl>
- * <dt>CCDLibrary_Instance_Handle</dt> <dd>jobject reference for the CCDLibrary instance.</dd>
- * <dt>Interface_Handle</dt> <dd>Pointer to the CCD_Interface_Handle_T for that CCDLibrary instance.</dd>
+ * <dt>Interface_Handle</dt> <dd>Pointer to the CCD_Interface_Handle_T for that CCDLibrary instance, or NULL if
+ *     this map entry is not in use.</dd>
+ * <dt>Generation</dt> <dd>The generation number given to the handle when it was added.</dd>
  * </dl>
+ * @see #HANDLE_MAP_SIZE
  */
 struct Handle_Map_Struct
 {
-	jobject CCDLibrary_Instance_Handle;
 	CCD_Interface_Handle_T* Interface_Handle;
+	jint Generation;
 };
 
 /* internal variables */
@@ -88,18 +110,82 @@ static jobject logger = NULL;
  */
 static jmethodID log_method_id = NULL;
 /**
- * Internal list of maps between CCDLibrary jobject's (i.e. CCDLibrary references), and
- * CCD_Interface_Handle_T handles (which control which /dev/astropci port we talk to).
+ * Internal list of CCD_Interface_Handle_T handles (which control which /dev/astropci port we talk to)
+ * opened by CCDLibrary instances.
  * @see #Handle_Map_Struct
  * @see #HANDLE_MAP_SIZE
  */
 static struct Handle_Map_Struct Handle_Map_List[HANDLE_MAP_SIZE] = 
 {
-	{NULL,NULL},
-	{NULL,NULL},
-	{NULL,NULL},
-	{NULL,NULL},
-	{NULL,NULL}
+	{NULL,0},
+	{NULL,0},
+	{NULL,0},
+	{NULL,0},
+	{NULL,0}
+};
+/**
+ * The number of handles added to Handle_Map_List, used to generate each handle's generation number.
+ * @see #Handle_Map_List
+ * @see #CCDLibrary_Handle_Map_Add
+ */
+static jint Handle_Map_Add_Count = 0;
+/**
+ * Cached field ID of CCDLibrary's nativeHandleGeneration (int) field.
+ * @see #CCDLibrary_Handle_Field_ID_Get
+ */
+static jfieldID handle_generation_field_id = NULL;
+/**
+ * Structure holding the name, signature and cached field ID of one of CCDLibraryStatus's fields.
+ * <dl>
+ * <dt>Name</dt> <dd>The field name.</dd>
+ * <dt>Signature</dt> <dd>The field's JNI type signature.</dd>
+ * <dt>Field_ID</dt> <dd>The cached field ID, or NULL if it has not been retrieved yet.</dd>
+ * </dl>
+ * @see #Status_Field_List
+ */
+struct Status_Field_Struct
+{
+	char *Name;
+	char *Signature;
+	jfieldID Field_ID;
+};
+/**
+ * Indexes into Status_Field_List, one per CCDLibraryStatus field set by CCD_Status_Get.
+ * @see #Status_Field_List
+ */
+enum STATUS_FIELD
+{
+	STATUS_FIELD_EXPOSURE_STATUS=0,STATUS_FIELD_SETUP_COMPLETE,STATUS_FIELD_SETUP_IN_PROGRESS,
+	STATUS_FIELD_BINNED_NCOLS,STATUS_FIELD_BINNED_NROWS,STATUS_FIELD_X_BIN,STATUS_FIELD_Y_BIN,
+	STATUS_FIELD_WINDOW_FLAGS,STATUS_FIELD_EXPOSURE_LENGTH,STATUS_FIELD_EXPOSURE_START_TIME,
+	STATUS_FIELD_ELAPSED_EXPOSURE_TIME_VALID,STATUS_FIELD_ELAPSED_EXPOSURE_TIME,
+	STATUS_FIELD_ELAPSED_EXPOSURE_TIME_DSP_ERROR_NUMBER,STATUS_FIELD_TELEMETRY_RUNNING,
+	STATUS_FIELD_TEMPERATURE_VALID,STATUS_FIELD_TEMPERATURE,STATUS_FIELD_TEMPERATURE_ADU_VALID,
+	STATUS_FIELD_HEATER_ADU,STATUS_FIELD_UTILITY_BOARD_ADU,STATUS_FIELD_TEMPERATURE_AGE,
+	STATUS_FIELD_TEMPERATURE_ERROR_NUMBER,STATUS_FIELD_TEMPERATURE_DSP_ERROR_NUMBER,
+	STATUS_FIELD_SUPPLY_VOLTAGE_VALID,STATUS_FIELD_HIGH_VOLTAGE_ADU,STATUS_FIELD_LOW_VOLTAGE_ADU,
+	STATUS_FIELD_MINUS_LOW_VOLTAGE_ADU,STATUS_FIELD_SUPPLY_VOLTAGE_AGE,STATUS_FIELD_SUPPLY_VOLTAGE_ERROR_NUMBER,
+	STATUS_FIELD_SUPPLY_VOLTAGE_DSP_ERROR_NUMBER,STATUS_FIELD_COUNT
+};
+/**
+ * The CCDLibraryStatus fields set by CCD_Status_Get, in STATUS_FIELD order. The field IDs are
+ * retrieved the first time CCD_Status_Get is called, so later calls do no lookups.
+ * @see #STATUS_FIELD
+ * @see #CCDLibrary_Status_Field_ID_Get
+ */
+static struct Status_Field_Struct Status_Field_List[STATUS_FIELD_COUNT] = 
+{
+	{"exposureStatus","I",NULL},{"setupComplete","Z",NULL},{"setupInProgress","Z",NULL},
+	{"binnedNCols","I",NULL},{"binnedNRows","I",NULL},{"xBin","I",NULL},{"yBin","I",NULL},
+	{"windowFlags","I",NULL},{"exposureLength","I",NULL},{"exposureStartTime","J",NULL},
+	{"elapsedExposureTimeValid","Z",NULL},{"elapsedExposureTime","I",NULL},
+	{"elapsedExposureTimeDSPErrorNumber","I",NULL},{"telemetryRunning","Z",NULL},
+	{"temperatureValid","Z",NULL},{"temperature","D",NULL},{"temperatureADUValid","Z",NULL},
+	{"heaterADU","I",NULL},{"utilityBoardADU","I",NULL},{"temperatureAge","D",NULL},
+	{"temperatureErrorNumber","I",NULL},{"temperatureDSPErrorNumber","I",NULL},
+	{"supplyVoltageValid","Z",NULL},{"highVoltageADU","I",NULL},{"lowVoltageADU","I",NULL},
+	{"minusLowVoltageADU","I",NULL},{"supplyVoltageAge","D",NULL},{"supplyVoltageErrorNumber","I",NULL},
+	{"supplyVoltageDSPErrorNumber","I",NULL}
 };
 
 /* internal routines */
@@ -115,6 +201,14 @@ static int CCDLibrary_Java_String_List_Free(JNIEnv *env,jobject obj,
 static int CCDLibrary_Handle_Map_Add(JNIEnv *env,jobject instance,CCD_Interface_Handle_T* interface_handle);
 static int CCDLibrary_Handle_Map_Delete(JNIEnv *env,jobject instance);
 static int CCDLibrary_Handle_Map_Find(JNIEnv *env,jobject instance,CCD_Interface_Handle_T** interface_handle);
+static int CCDLibrary_Handle_Map_Index_Get(JNIEnv *env,jobject instance,CCD_Interface_Handle_T** interface_handle,
+					   int *index);
+static int CCDLibrary_Handle_Field_ID_Get(JNIEnv *env,jobject instance);
+static int CCDLibrary_Status_Field_ID_Get(JNIEnv *env,jobject status_instance);
+static jobject CCDLibrary_Frame_Create(JNIEnv *env,unsigned short *pixel_data,size_t pixel_count,
+				       unsigned int sequence,int ncols,int nrows,int x_bin,int y_bin,int window_number,
+				       int raw);
+static jobject CCDLibrary_Raw_Buffer_Copy(JNIEnv *env,unsigned int sequence,size_t pixel_count);
 
 /* ------------------------------------------------------------------------------
 ** 		External routines
@@ -213,10 +307,12 @@ JNIEXPORT jint JNICALL Java_ngat_o_ccd_CCDLibrary_CCD_1DSP_1Command_1RET(JNIEnv
 	/* get interface handle from CCDLibrary instance map */
 	if(!CCDLibrary_Handle_Map_Find(env,obj,&handle))
 		return -1; /* CCDLibrary_Handle_Map_Find throws an exception on failure */
+	CCD_Telemetry_Command_Start();
 	/* real elapsed time */
 	retval = CCD_DSP_Command_RET(handle);
 	if((retval == 0)&&(CCD_DSP_Get_Error_Number()))
 		CCDLibrary_Throw_Exception(env,obj,"CCD_DSP_Command_Read_Exposure_Time");
+	CCD_Telemetry_Command_End();
 	return retval;
 }
 
@@ -233,6 +329,49 @@ JNIEXPORT jint JNICALL Java_ngat_o_ccd_CCDLibrary_CCD_1DSP_1Get_1Error_1Number(J
 	return CCD_DSP_Get_Error_Number();
 }
 
+/**
+ * Class:     ngat_o_ccd_CCDLibrary<br>
+ * Method:    CCD_DSP_Abort_Latency_Get<br>
+ * Signature: (D)D<br>
+ * Java Native Interface implementation of 
+ * <a href="ccd_dsp.html#CCD_DSP_Abort_Latency_Get">CCD_DSP_Abort_Latency_Get</a>,
+ * which returns a percentile of the recent abort latencies (from the abort request to the aborted operation
+ * returning), in seconds.
+ * If an error occurs a CCDLibraryNativeException is thrown.
+ * @see ccd_dsp.html#CCD_DSP_Abort_Latency_Get
+ * @see #CCDLibrary_Throw_Exception
+ */
+JNIEXPORT jdouble JNICALL Java_ngat_o_ccd_CCDLibrary_CCD_1DSP_1Abort_1Latency_1Get(JNIEnv *env,jobject obj,
+										  jdouble percentile)
+{
+	double latency = 0.0;
+	int retval,sample_count;
+
+	retval = CCD_DSP_Abort_Latency_Get((double)percentile,&latency,&sample_count);
+	/* if an error occured throw an exception. */
+	if(retval == FALSE)
+		CCDLibrary_Throw_Exception(env,obj,"CCD_DSP_Abort_Latency_Get");
+	return (jdouble)latency;
+}
+
+/**
+ * Class:     ngat_o_ccd_CCDLibrary<br>
+ * Method:    CCD_DSP_Abort_Latency_Sample_Count_Get<br>
+ * Signature: ()I<br>
+ * Java Native Interface routine returning the number of abort latencies
+ * <a href="ccd_dsp.html#CCD_DSP_Abort_Latency_Get">CCD_DSP_Abort_Latency_Get</a> computes percentiles from.
+ * @see ccd_dsp.html#CCD_DSP_Abort_Latency_Get
+ */
+JNIEXPORT jint JNICALL Java_ngat_o_ccd_CCDLibrary_CCD_1DSP_1Abort_1Latency_1Sample_1Count_1Get(JNIEnv *env,
+											     jobject obj)
+{
+	double latency;
+	int sample_count = 0;
+
+	CCD_DSP_Abort_Latency_Get(100.0,&latency,&sample_count);
+	return (jint)sample_count;
+}
+
 /* ------------------------------------------------------------------------------
 ** 		ccd_exposure.c
 ** ------------------------------------------------------------------------------ */
@@ -240,8 +379,11 @@ JNIEXPORT jint JNICALL Java_ngat_o_ccd_CCDLibrary_CCD_1DSP_1Get_1Error_1Number(J
  * Class:     ngat_o_ccd_CCDLibrary<br>
  * Method:    CCD_Exposure_Expose<br>
  * Signature: (ZJILjava/util/List;)V<br>
- * Java Native Interface routine to do an exposure.
+ * Java Native Interface routine to do an exposure. If it succeeds, CCD_Timing_Return_End times the return
+ * to Java. If it fails, CCD_DSP_Abort_Complete records the abort latency (if it was aborted).
  * @see ccd_exposure.html#CCD_Exposure_Expose
+ * @see ccd_timing.html#CCD_Timing_Return_End
+ * @see ccd_dsp.html#CCD_DSP_Abort_Complete
  * @see #CCDLibrary_Throw_Exception
  * @see #CCDLibrary_Java_String_List_To_C_List
  * @see #CCDLibrary_Java_String_List_Free
@@ -258,12 +400,16 @@ JNIEXPORT void JNICALL Java_ngat_o_ccd_CCDLibrary_CCD_1Exposure_1Expose(JNIEnv *
 	/* get interface handle from CCDLibrary instance map */
 	if(!CCDLibrary_Handle_Map_Find(env,obj,&handle))
 		return; /* CCDLibrary_Handle_Map_Find throws an exception on failure */
+	CCD_Telemetry_Command_Start();
 	/* convert filenameList to filename_list (Java to C) */
 	retval = CCDLibrary_Java_String_List_To_C_List(env,obj,filename_list_object,
 						 &jni_filename_list,&jni_filename_count,
 						 &filename_list,&filename_count);
 	if(retval == FALSE)
+	{
+		CCD_Telemetry_Command_End();
 		return; /* CCDLibrary_Java_String_List_To_C_List throws exception */
+	}
 	/* convert start_time_long to start_time */
 	if(start_time_long > -1)
 	{
@@ -283,16 +429,23 @@ JNIEXPORT void JNICALL Java_ngat_o_ccd_CCDLibrary_CCD_1Exposure_1Expose(JNIEnv *
 	/* if an error occured throw an exception. */
 	if(retval == FALSE)
 	{
+		CCD_DSP_Abort_Complete();
 		CCDLibrary_Throw_Exception(env,obj,"CCD_Exposure_Expose");
 	}
+	else
+		CCD_Timing_Return_End();
+	CCD_Telemetry_Command_End();
 }
 
 /**
  * Class:     ngat_o_ccd_CCDLibrary<br>
  * Method:    CCD_Exposure_Bias<br>
  * Signature: (Ljava/lang/String;)V<br>
- * Java Native Interface routine to take a bias frame.
+ * Java Native Interface routine to take a bias frame. If it succeeds, CCD_Timing_Return_End times the return
+ * to Java. If it fails, CCD_DSP_Abort_Complete records the abort latency (if it was aborted).
  * @see ccd_exposure.html#CCD_Exposure_Bias
+ * @see ccd_timing.html#CCD_Timing_Return_End
+ * @see ccd_dsp.html#CCD_DSP_Abort_Complete
  * @see #CCDLibrary_Throw_Exception
  * @see ccd_interface.html#CCD_Interface_Handle_T
  * @see #CCDLibrary_Handle_Map_Find
@@ -306,6 +459,7 @@ JNIEXPORT void JNICALL Java_ngat_o_ccd_CCDLibrary_CCD_1Exposure_1Bias(JNIEnv *en
 	/* get interface handle from CCDLibrary instance map */
 	if(!CCDLibrary_Handle_Map_Find(env,obj,&handle))
 		return; /* CCDLibrary_Handle_Map_Find throws an exception on failure */
+	CCD_Telemetry_Command_Start();
 	/* Change the java strings to a c null terminated string
 	** If the java String is null the C string should be null as well */
 	if(filename != NULL)
@@ -317,8 +471,13 @@ JNIEXPORT void JNICALL Java_ngat_o_ccd_CCDLibrary_CCD_1Exposure_1Bias(JNIEnv *en
 		(*env)->ReleaseStringUTFChars(env,filename,cfilename);
 	/* if an error occured throw an exception. */
 	if(retval == FALSE)
+	{
+		CCD_DSP_Abort_Complete();
 		CCDLibrary_Throw_Exception(env,obj,"CCD_Exposure_Bias");
-
+	}
+	else
+		CCD_Timing_Return_End();
+	CCD_Telemetry_Command_End();
 }
 
 /**
@@ -514,6 +673,72 @@ JNIEXPORT jint JNICALL Java_ngat_o_ccd_CCDLibrary_CCD_1Exposure_1Readout_1Delay_
 	return (jint)CCD_Exposure_Readout_Delay_Get();
 }
 
+/**
+ * Class:     ngat_o_ccd_CCDLibrary<br>
+ * Method:    CCD_Exposure_Start_Approach_Set<br>
+ * Signature: (IZ)V<br>
+ * Java Native Interface implementation of 
+ * <a href="ccd_exposure.html#CCD_Exposure_Start_Approach_Set">CCD_Exposure_Start_Approach_Set</a>,
+ * which configures the final approach to a timed exposure start.
+ * If an error occurs a CCDLibraryNativeException is thrown.
+ * @see ccd_exposure.html#CCD_Exposure_Start_Approach_Set
+ * @see #CCDLibrary_Throw_Exception
+ */
+JNIEXPORT void JNICALL Java_ngat_o_ccd_CCDLibrary_CCD_1Exposure_1Start_1Approach_1Set(JNIEnv *env,jobject obj,
+										    jint approach_ms,
+										    jboolean increase_priority)
+{
+	int retval;
+
+	retval = CCD_Exposure_Start_Approach_Set((int)approach_ms,(int)increase_priority);
+	/* if an error occured throw an exception. */
+	if(retval == FALSE)
+		CCDLibrary_Throw_Exception(env,obj,"CCD_Exposure_Start_Approach_Set");
+}
+
+/**
+ * Class:     ngat_o_ccd_CCDLibrary<br>
+ * Method:    CCD_Exposure_Start_Error_Percentile_Get<br>
+ * Signature: (D)D<br>
+ * Java Native Interface implementation of 
+ * <a href="ccd_exposure.html#CCD_Exposure_Start_Error_Percentile_Get">CCD_Exposure_Start_Error_Percentile_Get</a>,
+ * which returns a percentile of the recent timed exposure absolute start errors, in seconds.
+ * If an error occurs a CCDLibraryNativeException is thrown.
+ * @see ccd_exposure.html#CCD_Exposure_Start_Error_Percentile_Get
+ * @see #CCDLibrary_Throw_Exception
+ */
+JNIEXPORT jdouble JNICALL Java_ngat_o_ccd_CCDLibrary_CCD_1Exposure_1Start_1Error_1Percentile_1Get(JNIEnv *env,
+											jobject obj,jdouble percentile)
+{
+	double start_error = 0.0;
+	int retval,sample_count;
+
+	retval = CCD_Exposure_Start_Error_Percentile_Get((double)percentile,&start_error,&sample_count);
+	/* if an error occured throw an exception. */
+	if(retval == FALSE)
+		CCDLibrary_Throw_Exception(env,obj,"CCD_Exposure_Start_Error_Percentile_Get");
+	return (jdouble)start_error;
+}
+
+/**
+ * Class:     ngat_o_ccd_CCDLibrary<br>
+ * Method:    CCD_Exposure_Start_Error_Sample_Count_Get<br>
+ * Signature: ()I<br>
+ * Java Native Interface routine returning the number of timed exposure start errors
+ * <a href="ccd_exposure.html#CCD_Exposure_Start_Error_Percentile_Get">CCD_Exposure_Start_Error_Percentile_Get</a>
+ * computes percentiles from.
+ * @see ccd_exposure.html#CCD_Exposure_Start_Error_Percentile_Get
+ */
+JNIEXPORT jint JNICALL Java_ngat_o_ccd_CCDLibrary_CCD_1Exposure_1Start_1Error_1Sample_1Count_1Get(JNIEnv *env,
+											jobject obj)
+{
+	double start_error;
+	int sample_count = 0;
+
+	CCD_Exposure_Start_Error_Percentile_Get(100.0,&start_error,&sample_count);
+	return (jint)sample_count;
+}
+
 /**
  * Class:     ngat_o_ccd_CCDLibrary<br>
  * Method:    CCD_Exposure_Get_Error_Number<br>
@@ -539,7 +764,12 @@ JNIEXPORT jint JNICALL Java_ngat_o_ccd_CCDLibrary_CCD_1Exposure_1Get_1Error_1Num
 JNIEXPORT void JNICALL Java_ngat_o_ccd_CCDLibrary_CCD_1Filter_1Wheel_1Position_1Count_1Set(JNIEnv *env,jobject obj,
 											   jint position_count)
 {
-	CCD_Filter_Wheel_Position_Count_Set((int)position_count);
+	int retval;
+
+	retval = CCD_Filter_Wheel_Position_Count_Set((int)position_count);
+	/* if an error occured throw an exception. */
+	if(retval == FALSE)
+		CCDLibrary_Throw_Exception(env,obj,"CCD_Filter_Wheel_Position_Count_Set");
 }
 
 /**
@@ -559,10 +789,12 @@ JNIEXPORT void JNICALL Java_ngat_o_ccd_CCDLibrary_CCD_1Filter_1Wheel_1Reset(JNIE
 	/* get interface handle from CCDLibrary instance map */
 	if(!CCDLibrary_Handle_Map_Find(env,obj,&handle))
 		return; /* CCDLibrary_Handle_Map_Find throws an exception on failure */
+	CCD_Telemetry_Command_Start();
 	retval = CCD_Filter_Wheel_Reset(handle);
 	/* if an error occured throw an exception. */
 	if(retval == FALSE)
 		CCDLibrary_Throw_Exception(env,obj,"CCD_Filter_Wheel_Reset");
+	CCD_Telemetry_Command_End();
 }
 
 /**
@@ -582,10 +814,76 @@ JNIEXPORT void JNICALL Java_ngat_o_ccd_CCDLibrary_CCD_1Filter_1Wheel_1Move(JNIEn
 	/* get interface handle from CCDLibrary instance map */
 	if(!CCDLibrary_Handle_Map_Find(env,obj,&handle))
 		return; /* CCDLibrary_Handle_Map_Find throws an exception on failure */
+	CCD_Telemetry_Command_Start();
 	retval = CCD_Filter_Wheel_Move(handle,(int)position);
 	/* if an error occured throw an exception. */
 	if(retval == FALSE)
 		CCDLibrary_Throw_Exception(env,obj,"CCD_Filter_Wheel_Move");
+	CCD_Telemetry_Command_End();
+}
+
+/**
+ * Class:     ngat_o_ccd_CCDLibrary<br>
+ * Method:    CCD_Filter_Wheel_Move_Start<br>
+ * Signature: (I)V<br>
+ * @see #CCDLibrary_Handle_Map_Find
+ * @see #CCDLibrary_Throw_Exception
+ * @see ccd_filter_wheel.html#CCD_Filter_Wheel_Move_Start
+ * @see ccd_interface.html#CCD_Interface_Handle_T
+ */
+JNIEXPORT void JNICALL Java_ngat_o_ccd_CCDLibrary_CCD_1Filter_1Wheel_1Move_1Start(JNIEnv *env,jobject obj,jint position)
+{
+	CCD_Interface_Handle_T* handle = NULL;
+	int retval;
+
+	/* get interface handle from CCDLibrary instance map */
+	if(!CCDLibrary_Handle_Map_Find(env,obj,&handle))
+		return; /* CCDLibrary_Handle_Map_Find throws an exception on failure */
+	CCD_Telemetry_Command_Start();
+	retval = CCD_Filter_Wheel_Move_Start(handle,(int)position);
+	/* if an error occured throw an exception. */
+	if(retval == FALSE)
+		CCDLibrary_Throw_Exception(env,obj,"CCD_Filter_Wheel_Move_Start");
+	CCD_Telemetry_Command_End();
+}
+
+/**
+ * Class:     ngat_o_ccd_CCDLibrary<br>
+ * Method:    CCD_Filter_Wheel_Move_Wait<br>
+ * Signature: ()V<br>
+ * @see #CCDLibrary_Throw_Exception
+ * @see ccd_filter_wheel.html#CCD_Filter_Wheel_Move_Wait
+ */
+JNIEXPORT void JNICALL Java_ngat_o_ccd_CCDLibrary_CCD_1Filter_1Wheel_1Move_1Wait(JNIEnv *env,jobject obj)
+{
+	int retval;
+
+	CCD_Telemetry_Command_Start();
+	retval = CCD_Filter_Wheel_Move_Wait();
+	/* if an error occured throw an exception. */
+	if(retval == FALSE)
+		CCDLibrary_Throw_Exception(env,obj,"CCD_Filter_Wheel_Move_Wait");
+	CCD_Telemetry_Command_End();
+}
+
+/**
+ * Class:     ngat_o_ccd_CCDLibrary<br>
+ * Method:    CCD_Filter_Wheel_Move_Time_Estimate<br>
+ * Signature: (II)D<br>
+ * @see #CCDLibrary_Throw_Exception
+ * @see ccd_filter_wheel.html#CCD_Filter_Wheel_Move_Time_Estimate
+ */
+JNIEXPORT jdouble JNICALL Java_ngat_o_ccd_CCDLibrary_CCD_1Filter_1Wheel_1Move_1Time_1Estimate(JNIEnv *env,
+							jobject obj,jint from_position,jint to_position)
+{
+	double estimate_secs = 0.0;
+	int retval;
+
+	retval = CCD_Filter_Wheel_Move_Time_Estimate((int)from_position,(int)to_position,&estimate_secs);
+	/* if an error occured throw an exception. */
+	if(retval == FALSE)
+		CCDLibrary_Throw_Exception(env,obj,"CCD_Filter_Wheel_Move_Time_Estimate");
+	return (jdouble)estimate_secs;
 }
 
 /**
@@ -739,6 +1037,7 @@ JNIEXPORT void JNICALL Java_ngat_o_ccd_CCDLibrary_CCD_1Interface_1Open(JNIEnv *e
  * Java programs that don't call the setup method, but still want to readout the CCD.
  * @see ccd_interface.html#CCD_Interface_Handle_T
  * @see ccd_interface.html#CCD_Interface_Memory_Map
+ * @see ccd_frame_view.html#CCD_Frame_View_Raw_Invalidate
  * @see #CCDLibrary_Handle_Map_Find
  */
 JNIEXPORT void JNICALL Java_ngat_o_ccd_CCDLibrary_CCD_1Interface_1Memory_1Map(JNIEnv *env, jobject obj,jlong length)
@@ -749,14 +1048,19 @@ JNIEXPORT void JNICALL Java_ngat_o_ccd_CCDLibrary_CCD_1Interface_1Memory_1Map(JN
 	/* get interface handle from CCDLibrary instance map */
 	if(!CCDLibrary_Handle_Map_Find(env,obj,&handle))
 		return; /* CCDLibrary_Handle_Map_Find throws an exception on failure */
+	CCD_Telemetry_Command_Start();
+	/* any view of the old raw readout buffer must not outlive the old mapping */
+	CCD_Frame_View_Raw_Invalidate();
 	/* create mmap */
 	retval = CCD_Interface_Memory_Map(handle,(long)length);
 	/* if an error occured throw an exception. */
 	if(retval == FALSE)
 	{
 		CCDLibrary_Throw_Exception(env,obj,"CCD_Interface_Memory_Map");
+		CCD_Telemetry_Command_End();
 		return;
 	}
+	CCD_Telemetry_Command_End();
 }
 
 
@@ -780,12 +1084,14 @@ JNIEXPORT void JNICALL Java_ngat_o_ccd_CCDLibrary_CCD_1Interface_1Close(JNIEnv *
 	/* get interface handle from CCDLibrary instance map */
 	if(!CCDLibrary_Handle_Map_Find(env,obj,&handle))
 		return; /* CCDLibrary_Handle_Map_Find throws an exception on failure */
+	CCD_Telemetry_Command_Start();
 	/* close handle */
 	retval = CCD_Interface_Close(&handle);
 	/* if an error occured throw an exception. */
 	if(retval == FALSE)
 	{
 		CCDLibrary_Throw_Exception(env,obj,"CCD_Interface_Close");
+		CCD_Telemetry_Command_End();
 		return;
 	}
 	/* remove mapping from CCDLibrary instance to interface handle */
@@ -793,8 +1099,10 @@ JNIEXPORT void JNICALL Java_ngat_o_ccd_CCDLibrary_CCD_1Interface_1Close(JNIEnv *
 	if(retval == FALSE)
 	{
 		/* CCDLibrary_Handle_Map_Delete should have thrown an error if it fails */
+		CCD_Telemetry_Command_End();
 		return;
 	}
+	CCD_Telemetry_Command_End();
 }
 
 /**
@@ -847,6 +1155,7 @@ JNIEXPORT void JNICALL Java_ngat_o_ccd_CCDLibrary_CCD_1Pixel_1Stream_1Set_1Pixel
 	/* get interface handle from CCDLibrary instance map */
 	if(!CCDLibrary_Handle_Map_Find(env,obj,&handle))
 		return; /* CCDLibrary_Handle_Map_Find throws an exception on failure */
+	CCD_Telemetry_Command_Start();
 	/* Change the java strings to a c null terminated string
 	** If the java String is null the C string should be null as well */
 	if(pixel_list_jstring != NULL)
@@ -865,6 +1174,7 @@ JNIEXPORT void JNICALL Java_ngat_o_ccd_CCDLibrary_CCD_1Pixel_1Stream_1Set_1Pixel
 	/* if an error occured throw an exception. */
 	if(retval == FALSE)
 		CCDLibrary_Throw_Exception(env,obj,"CCD_Pixel_Stream_Set_Pixel_Stream_Entry");
+	CCD_Telemetry_Command_End();
 }
 
 /**
@@ -890,8 +1200,10 @@ JNIEXPORT jint JNICALL Java_ngat_o_ccd_CCDLibrary_CCD_1Pixel_1Stream_1Get_1Error
  * Java Native Interface implementation of <a href="ccd_setup.html#CCD_Setup_Startup">CCD_Setup_Startup</a>,
  * a routine to setup the SDSU CCD Controller for exposures. This routine translates the pci_filename_string, 
  * timing_filename_string and utility_filename_string parameters from Java Strings to C Strings.
- * If an error occurs a CCDLibraryNativeException is thrown.
+ * If an error occurs a CCDLibraryNativeException is thrown, after CCD_DSP_Abort_Complete records the abort latency
+ * (if it was aborted).
  * @see ccd_setup.html#CCD_Setup_Startup
+ * @see ccd_dsp.html#CCD_DSP_Abort_Complete
  * @see ccd_interface.html#CCD_Interface_Handle_T
  * @see #CCDLibrary_Handle_Map_Find
  * @see #CCDLibrary_Throw_Exception
@@ -911,6 +1223,7 @@ JNIEXPORT void JNICALL Java_ngat_o_ccd_CCDLibrary_CCD_1Setup_1Startup(JNIEnv *en
 	/* get interface handle from CCDLibrary instance map */
 	if(!CCDLibrary_Handle_Map_Find(env,obj,&handle))
 		return; /* CCDLibrary_Handle_Map_Find throws an exception on failure */
+	CCD_Telemetry_Command_Start();
 	/* Change the java strings to a c null terminated string
 	** If the java String is null the C string should be null as well */
 	if(pci_filename_string != NULL)
@@ -935,7 +1248,11 @@ JNIEXPORT void JNICALL Java_ngat_o_ccd_CCDLibrary_CCD_1Setup_1Startup(JNIEnv *en
 		(*env)->ReleaseStringUTFChars(env,utility_filename_string,utility_filename);
 	/* if an error occured throw an exception. */
 	if(retval == FALSE)
+	{
+		CCD_DSP_Abort_Complete();
 		CCDLibrary_Throw_Exception(env,obj,"CCD_Setup_Startup");
+	}
+	CCD_Telemetry_Command_End();
 }
 
 /**
@@ -958,11 +1275,13 @@ JNIEXPORT void JNICALL Java_ngat_o_ccd_CCDLibrary_CCD_1Setup_1Shutdown(JNIEnv *e
 	/* get interface handle from CCDLibrary instance map */
 	if(!CCDLibrary_Handle_Map_Find(env,obj,&handle))
 		return; /* CCDLibrary_Handle_Map_Find throws an exception on failure */
+	CCD_Telemetry_Command_Start();
 	/* shutdown */
 	retval = CCD_Setup_Shutdown(handle);
 	/* if an error occured throw an exception. */
 	if(retval == FALSE)
 		CCDLibrary_Throw_Exception(env,obj,"CCD_Setup_Shutdown");
+	CCD_Telemetry_Command_End();
 }
 
 /**
@@ -975,6 +1294,7 @@ JNIEXPORT void JNICALL Java_ngat_o_ccd_CCDLibrary_CCD_1Setup_1Shutdown(JNIEnv *e
  * If the class cannot be found one of the following exception is thrown: 
  * ClassFormatError, ClassCircularityError, NoClassDefFoundError, OutOfMemoryError.
  * @see ccd_setup.html#CCD_Setup_Dimensions
+ * @see ccd_dsp.html#CCD_DSP_Abort_Complete
  * @see ccd_interface.html#CCD_Interface_Handle_T
  * @see #CCDLibrary_Handle_Map_Find
  * @see #CCDLibrary_Throw_Exception
@@ -995,6 +1315,7 @@ JNIEXPORT void JNICALL Java_ngat_o_ccd_CCDLibrary_CCD_1Setup_1Dimensions(JNIEnv
 	/* get interface handle from CCDLibrary instance map */
 	if(!CCDLibrary_Handle_Map_Find(env,obj,&handle))
 		return; /* CCDLibrary_Handle_Map_Find throws an exception on failure */
+	CCD_Telemetry_Command_Start();
 /* convert window_object_list to window_list */
 	/* check array is not NULL */
 	if(window_object_list == NULL)
@@ -1002,6 +1323,7 @@ JNIEXPORT void JNICALL Java_ngat_o_ccd_CCDLibrary_CCD_1Setup_1Dimensions(JNIEnv
 		/* N.B. This error occured in the JNI interface, not the libfrodospec_ccd - no error string set */
 		sprintf(error_string,"CCD_Setup_Dimensions:window list was NULL.");
 		CCDLibrary_Throw_Exception_String(env,obj,"CCD_Setup_Dimensions",error_string);
+		CCD_Telemetry_Command_End();
 		return;
 	}
 	/* check size of array */
@@ -1012,6 +1334,7 @@ JNIEXPORT void JNICALL Java_ngat_o_ccd_CCDLibrary_CCD_1Setup_1Dimensions(JNIEnv
 		sprintf(error_string,"CCD_Setup_Dimensions:window list has wrong number of elements(%d,%d).",
 			window_count,CCD_SETUP_WINDOW_COUNT);
 		CCDLibrary_Throw_Exception_String(env,obj,"CCD_Setup_Dimensions",error_string);
+		CCD_Telemetry_Command_End();
 		return;
 	}
 /* get the class of CCDLibrarySetupWindow */
@@ -1019,7 +1342,10 @@ JNIEXPORT void JNICALL Java_ngat_o_ccd_CCDLibrary_CCD_1Setup_1Dimensions(JNIEnv
 	/* if the class is null, one of the following exceptions occured:
 	** ClassFormatError,ClassCircularityError,NoClassDefFoundError,OutOfMemoryError */
 	if(cls == NULL)
+	{
+		CCD_Telemetry_Command_End();
 		return;
+	}
 /* get relevant method ids to call */
 /* getXStart */
 	get_x_start_method_id = (*env)->GetMethodID(env,cls,"getXStart","()I");
@@ -1027,6 +1353,7 @@ JNIEXPORT void JNICALL Java_ngat_o_ccd_CCDLibrary_CCD_1Setup_1Dimensions(JNIEnv
 	{
 		/* One of the following exceptions has been thrown:
 		** NoSuchMethodError, ExceptionInInitializerError, OutOfMemoryError */
+		CCD_Telemetry_Command_End();
 		return;
 	}
 /* getYStart */
@@ -1035,6 +1362,7 @@ JNIEXPORT void JNICALL Java_ngat_o_ccd_CCDLibrary_CCD_1Setup_1Dimensions(JNIEnv
 	{
 		/* One of the following exceptions has been thrown:
 		** NoSuchMethodError, ExceptionInInitializerError, OutOfMemoryError */
+		CCD_Telemetry_Command_End();
 		return;
 	}
 /* getXEnd */
@@ -1043,6 +1371,7 @@ JNIEXPORT void JNICALL Java_ngat_o_ccd_CCDLibrary_CCD_1Setup_1Dimensions(JNIEnv
 	{
 		/* One of the following exceptions has been thrown:
 		** NoSuchMethodError, ExceptionInInitializerError, OutOfMemoryError */
+		CCD_Telemetry_Command_End();
 		return;
 	}
 /* getYEnd */
@@ -1051,6 +1380,7 @@ JNIEXPORT void JNICALL Java_ngat_o_ccd_CCDLibrary_CCD_1Setup_1Dimensions(JNIEnv
 	{
 		/* One of the following exceptions has been thrown:
 		** NoSuchMethodError, ExceptionInInitializerError, OutOfMemoryError */
+		CCD_Telemetry_Command_End();
 		return;
 	}
 /* for each window, get each position from the window_object_list into the window_list */
@@ -1071,7 +1401,11 @@ JNIEXPORT void JNICALL Java_ngat_o_ccd_CCDLibrary_CCD_1Setup_1Dimensions(JNIEnv
 	retval = CCD_Setup_Dimensions(handle,ncols,nrows,nsbin,npbin,amplifier,window_flags,window_list);
 	/* if an error occured throw an exception. */
 	if(retval == FALSE)
+	{
+		CCD_DSP_Abort_Complete();
 		CCDLibrary_Throw_Exception(env,obj,"CCD_Setup_Dimensions");
+	}
+	CCD_Telemetry_Command_End();
 }
 
 /**
@@ -1094,11 +1428,13 @@ JNIEXPORT void JNICALL Java_ngat_o_ccd_CCDLibrary_CCD_1Setup_1Hardware_1Test(JNI
 	/* get interface handle from CCDLibrary instance map */
 	if(!CCDLibrary_Handle_Map_Find(env,obj,&handle))
 		return; /* CCDLibrary_Handle_Map_Find throws an exception on failure */
+	CCD_Telemetry_Command_Start();
 	/* hardware test */
 	retval = CCD_Setup_Hardware_Test(handle,test_count,TRUE,TRUE);
 	/* if an error occured throw an exception. */
 	if(retval == FALSE)
 		CCDLibrary_Throw_Exception(env,obj,"CCD_Setup_Hardware_Test");
+	CCD_Telemetry_Command_End();
 }
 
 /**
@@ -1306,10 +1642,12 @@ JNIEXPORT jobject JNICALL Java_ngat_o_ccd_CCDLibrary_CCD_1Setup_1Get_1Window(JNI
 	/* get interface handle from CCDLibrary instance map */
 	if(!CCDLibrary_Handle_Map_Find(env,obj,&handle))
 		return NULL; /* CCDLibrary_Handle_Map_Find throws an exception on failure */
+	CCD_Telemetry_Command_Start();
 	retval = CCD_Setup_Get_Window(handle,index,&window);
 	if(retval == FALSE)
 	{
 		CCDLibrary_Throw_Exception(env,obj,"CCD_Setup_Get_Window");
+		CCD_Telemetry_Command_End();
 		return NULL;
 	}
 /* get the class of CCDLibrarySetupWindow */
@@ -1317,13 +1655,17 @@ JNIEXPORT jobject JNICALL Java_ngat_o_ccd_CCDLibrary_CCD_1Setup_1Get_1Window(JNI
 	/* if the class is null, one of the following exceptions occured:
 	** ClassFormatError,ClassCircularityError,NoClassDefFoundError,OutOfMemoryError */
 	if(cls == NULL)
+	{
+		CCD_Telemetry_Command_End();
 		return NULL;
+	}
 /* get CCDLibrarySetupWindow constructor */
 	mid = (*env)->GetMethodID(env,cls,"<init>","(IIII)V");	
 	if(mid == 0)
 	{
 		/* One of the following exceptions has been thrown:
 		** NoSuchMethodError, ExceptionInInitializerError, OutOfMemoryError */
+		CCD_Telemetry_Command_End();
 		return NULL;
 	}
 /* call constructor */
@@ -1333,8 +1675,10 @@ JNIEXPORT jobject JNICALL Java_ngat_o_ccd_CCDLibrary_CCD_1Setup_1Get_1Window(JNI
 	{
 		/* One of the following exceptions has been thrown:
 		** InstantiationException, OutOfMemoryError */
+		CCD_Telemetry_Command_End();
 		return NULL;
 	}
+	CCD_Telemetry_Command_End();
 	return windowInstance;
 }
 
@@ -1393,11 +1737,13 @@ JNIEXPORT jint JNICALL Java_ngat_o_ccd_CCDLibrary_CCD_1Setup_1Get_1High_1Voltage
 	/* get interface handle from CCDLibrary instance map */
 	if(!CCDLibrary_Handle_Map_Find(env,obj,&handle))
 		return -1; /* CCDLibrary_Handle_Map_Find throws an exception on failure */
+	CCD_Telemetry_Command_Start();
 	/* get high voltage ADU */
 	retval = CCD_Setup_Get_High_Voltage_Analogue_ADU(handle,&adu);
 	/* if an error occured throw an exception. */
 	if(retval == FALSE)
 		CCDLibrary_Throw_Exception(env,obj,"CCD_Setup_Get_High_Voltage_Analogue_ADU");
+	CCD_Telemetry_Command_End();
 	return adu;
 }
 
@@ -1417,11 +1763,13 @@ JNIEXPORT jint JNICALL Java_ngat_o_ccd_CCDLibrary_CCD_1Setup_1Get_1Low_1Voltage_
 	/* get interface handle from CCDLibrary instance map */
 	if(!CCDLibrary_Handle_Map_Find(env,obj,&handle))
 		return -1; /* CCDLibrary_Handle_Map_Find throws an exception on failure */
+	CCD_Telemetry_Command_Start();
 	/* get low voltage ADU */
 	retval = CCD_Setup_Get_Low_Voltage_Analogue_ADU(handle,&adu);
 	/* if an error occured throw an exception. */
 	if(retval == FALSE)
 		CCDLibrary_Throw_Exception(env,obj,"CCD_Setup_Get_Low_Voltage_Analogue_ADU");
+	CCD_Telemetry_Command_End();
 	return adu;
 }
 
@@ -1442,11 +1790,13 @@ JNIEXPORT jint JNICALL Java_ngat_o_ccd_CCDLibrary_CCD_1Setup_1Get_1Minus_1Low_1V
 	/* get interface handle from CCDLibrary instance map */
 	if(!CCDLibrary_Handle_Map_Find(env,obj,&handle))
 		return -1; /* CCDLibrary_Handle_Map_Find throws an exception on failure */
+	CCD_Telemetry_Command_Start();
 	/* get voltage ADU */
 	retval = CCD_Setup_Get_Minus_Low_Voltage_Analogue_ADU(handle,&adu);
 	/* if an error occured throw an exception. */
 	if(retval == FALSE)
 		CCDLibrary_Throw_Exception(env,obj,"CCD_Setup_Get_Minus_Low_Voltage_Analogue_ADU");
+	CCD_Telemetry_Command_End();
 	return adu;
 }
 
@@ -1466,167 +1816,1509 @@ JNIEXPORT jint JNICALL Java_ngat_o_ccd_CCDLibrary_CCD_1Setup_1Get_1Error_1Number
 }
 
 /* ------------------------------------------------------------------------------
-** 		ccd_temperature.c
+** 		ccd_combine.c
 ** ------------------------------------------------------------------------------ */
 /**
  * Class:     ngat_o_ccd_CCDLibrary<br>
- * Method:    CCD_Temperature_Get<br>
- * Signature: ()D<br>
- * Java Native Interface implementation of <a href="ccd_temperature.html#CCD_Temperature_Get">CCD_Temperature_Get</a>,
- * which gets the current temperature of the CCD. 
- * @see ccd_interface.html#CCD_Interface_Handle_T
- * @see ccd_temperature.html#CCD_Temperature_Get
+ * Method:    CCD_Combine_Set_Config<br>
+ * Signature: (IDII)V<br>
+ * Java Native Interface implementation of 
+ * <a href="ccd_combine.html#CCD_Combine_Set_Config">CCD_Combine_Set_Config</a>,
+ * which configures the master frame combine.
+ * If an error occurs a CCDLibraryNativeException is thrown.
+ * @see ccd_combine.html#CCD_Combine_Set_Config
  * @see #CCDLibrary_Throw_Exception
- * @see #CCDLibrary_Handle_Map_Find
  */
-JNIEXPORT jdouble JNICALL Java_ngat_o_ccd_CCDLibrary_CCD_1Temperature_1Get(JNIEnv *env,jobject obj)
+JNIEXPORT void JNICALL Java_ngat_o_ccd_CCDLibrary_CCD_1Combine_1Set_1Config(JNIEnv *env,jobject obj,
+						jint method,jdouble clip_sigma,jint thread_count,jint memory_limit)
 {
-	CCD_Interface_Handle_T *handle = NULL;
-	double dvalue;
 	int retval;
 
-	/* get interface handle from CCDLibrary instance map */
-	if(!CCDLibrary_Handle_Map_Find(env,obj,&handle))
-		return -1.0; /* CCDLibrary_Handle_Map_Find throws an exception on failure */
-	/* get temperature */
-	retval = CCD_Temperature_Get(handle,&dvalue);
+	retval = CCD_Combine_Set_Config((int)method,(double)clip_sigma,(int)thread_count,(int)memory_limit);
 	/* if an error occured throw an exception. */
 	if(retval == FALSE)
-	{
-		CCDLibrary_Throw_Exception(env,obj,"CCD_Temperature_Get");
-		return ((jdouble)dvalue);
-	}
-	return ((jdouble)dvalue);
+		CCDLibrary_Throw_Exception(env,obj,"CCD_Combine_Set_Config");
 }
 
 /**
  * Class:     ngat_o_ccd_CCDLibrary<br>
- * Method:    CCD_Temperature_Set<br>
- * Signature: (D)V<br>
- * Java Native Interface implementation of <a href="ccd_temperature.html#CCD_Temperature_Set">CCD_Temperature_Set</a>,
- * which sets the temperature of the CCD. 
+ * Method:    CCD_Combine_Start<br>
+ * Signature: ()V<br>
+ * Java Native Interface implementation of <a href="ccd_combine.html#CCD_Combine_Start">CCD_Combine_Start</a>,
+ * which starts a master frame combine.
  * If an error occurs a CCDLibraryNativeException is thrown.
- * @see ccd_interface.html#CCD_Interface_Handle_T
- * @see ccd_temperature.html#CCD_Temperature_Set
+ * @see ccd_combine.html#CCD_Combine_Start
  * @see #CCDLibrary_Throw_Exception
- * @see #CCDLibrary_Handle_Map_Find
  */
-JNIEXPORT void JNICALL Java_ngat_o_ccd_CCDLibrary_CCD_1Temperature_1Set(JNIEnv *env,jobject obj,
-									jdouble target_temperature)
+JNIEXPORT void JNICALL Java_ngat_o_ccd_CCDLibrary_CCD_1Combine_1Start(JNIEnv *env,jobject obj)
 {
-	CCD_Interface_Handle_T *handle = NULL;
 	int retval;
 
-	/* get interface handle from CCDLibrary instance map */
-	if(!CCDLibrary_Handle_Map_Find(env,obj,&handle))
-		return; /* CCDLibrary_Handle_Map_Find throws an exception on failure */
-	/* set temperature */
-	retval = CCD_Temperature_Set(handle,target_temperature);
+	retval = CCD_Combine_Start();
 	/* if an error occured throw an exception. */
 	if(retval == FALSE)
-		CCDLibrary_Throw_Exception(env,obj,"CCD_Temperature_Set");
+		CCDLibrary_Throw_Exception(env,obj,"CCD_Combine_Start");
 }
 
 /**
  * Class:     ngat_o_ccd_CCDLibrary<br>
- * Method:    CCD_Temperature_Get_Utility_Board_ADU<br>
+ * Method:    CCD_Combine_Get_Frame_Count<br>
  * Signature: ()I<br>
- * Java Native Interface implementation of CCD_Temperature_Get_Utility_Board_ADU,
- * which gets the Analogue to Digital counts from the utility board mounted temperature sensor. 
+ * Java Native Interface implementation of 
+ * <a href="ccd_combine.html#CCD_Combine_Get_Frame_Count">CCD_Combine_Get_Frame_Count</a>,
+ * which returns the number of frames added to the combine.
+ * @see ccd_combine.html#CCD_Combine_Get_Frame_Count
+ */
+JNIEXPORT jint JNICALL Java_ngat_o_ccd_CCDLibrary_CCD_1Combine_1Get_1Frame_1Count(JNIEnv *env,jobject obj)
+{
+	return (jint)CCD_Combine_Get_Frame_Count();
+}
+
+/**
+ * Class:     ngat_o_ccd_CCDLibrary<br>
+ * Method:    CCD_Combine_Save<br>
+ * Signature: (Ljava/lang/String;)V<br>
+ * Java Native Interface implementation of <a href="ccd_combine.html#CCD_Combine_Save">CCD_Combine_Save</a>,
+ * which saves the master frame and finishes the combine.
  * If an error occurs a CCDLibraryNativeException is thrown.
- * @return The current ADU count is returned. If an error occurs an exception is thrown, and this routine
- * 	returns -1.
- * @see ccd_interface.html#CCD_Interface_Handle_T
- * @see ccd_temperature.html#CCD_Temperature_Get_Utility_Board_ADU
+ * @see ccd_combine.html#CCD_Combine_Save
  * @see #CCDLibrary_Throw_Exception
- * @see #CCDLibrary_Handle_Map_Find
  */
-JNIEXPORT jint JNICALL Java_ngat_o_ccd_CCDLibrary_CCD_1Temperature_1Get_1Utility_1Board_1ADU(JNIEnv *env,jobject obj)
+JNIEXPORT void JNICALL Java_ngat_o_ccd_CCDLibrary_CCD_1Combine_1Save(JNIEnv *env,jobject obj,jstring filename)
 {
-	CCD_Interface_Handle_T *handle = NULL;
-	int retval,adu = -1;
+	int retval;
+	const char *cfilename = NULL;
 
-	/* get interface handle from CCDLibrary instance map */
-	if(!CCDLibrary_Handle_Map_Find(env,obj,&handle))
-		return -1; /* CCDLibrary_Handle_Map_Find throws an exception on failure */
-	/* get utility board ADU */
-	retval = CCD_Temperature_Get_Utility_Board_ADU(handle,&adu);
+	/* Change the java strings to a c null terminated string
+	** If the java String is null the C string should be null as well */
+	if(filename != NULL)
+		cfilename = (*env)->GetStringUTFChars(env,filename,0);
+	retval = CCD_Combine_Save((char*)cfilename);
+	/* If we created the C strings we need to free the memory it uses */
+	if(filename != NULL)
+		(*env)->ReleaseStringUTFChars(env,filename,cfilename);
 	/* if an error occured throw an exception. */
 	if(retval == FALSE)
-	{
-		CCDLibrary_Throw_Exception(env,obj,"CCD_Temperature_Get_Utility_Board_ADU");
-		return ((jint)adu);
-	}
-	return ((jint)adu);
+		CCDLibrary_Throw_Exception(env,obj,"CCD_Combine_Save");
 }
 
 /**
  * Class:     ngat_o_ccd_CCDLibrary<br>
- * Method:    CCD_Temperature_Get_Heater_ADU<br>
- * Signature: ()I<br>
- * Java Native Interface implementation of CCD_Temperature_Get_Heater_ADU,
- * which gets the current heater Analogue to Digital counts from the utility board. 
+ * Method:    CCD_Combine_Abort<br>
+ * Signature: ()V<br>
+ * Java Native Interface implementation of <a href="ccd_combine.html#CCD_Combine_Abort">CCD_Combine_Abort</a>,
+ * which aborts the combine.
  * If an error occurs a CCDLibraryNativeException is thrown.
- * @return The current ADU count is returned. If an error occurs an exception is thrown, and this routine
- * 	returns -1.
- * @see ccd_interface.html#CCD_Interface_Handle_T
- * @see ccd_temperature.html#CCD_Temperature_Get_Heater_ADU
+ * @see ccd_combine.html#CCD_Combine_Abort
  * @see #CCDLibrary_Throw_Exception
- * @see #CCDLibrary_Handle_Map_Find
  */
-JNIEXPORT jint JNICALL Java_ngat_o_ccd_CCDLibrary_CCD_1Temperature_1Get_1Heater_1ADU(JNIEnv *env,jobject obj)
+JNIEXPORT void JNICALL Java_ngat_o_ccd_CCDLibrary_CCD_1Combine_1Abort(JNIEnv *env,jobject obj)
 {
-	CCD_Interface_Handle_T *handle = NULL;
-	int retval,adu = -1;
+	int retval;
 
-	/* get interface handle from CCDLibrary instance map */
-	if(!CCDLibrary_Handle_Map_Find(env,obj,&handle))
-		return -1; /* CCDLibrary_Handle_Map_Find throws an exception on failure */
-	/* get heater ADU */
-	retval = CCD_Temperature_Get_Heater_ADU(handle,&adu);
+	retval = CCD_Combine_Abort();
 	/* if an error occured throw an exception. */
 	if(retval == FALSE)
-	{
-		CCDLibrary_Throw_Exception(env,obj,"CCD_Temperature_Get_Heater_ADU");
-		return ((jint)adu);
-	}
-	return ((jint)adu);
+		CCDLibrary_Throw_Exception(env,obj,"CCD_Combine_Abort");
 }
 
+/* ------------------------------------------------------------------------------
+** 		ccd_compress.c
+** ------------------------------------------------------------------------------ */
 /**
  * Class:     ngat_o_ccd_CCDLibrary<br>
- * Method:    CCD_Temperature_Heater_ADU_To_Power<br>
- * Signature: (I)D<br>
- * Java Native Interface implementation of CCD_Temperature_Heater_ADU_To_Power,
- * which converts a heater adu into a measure of power (in Watts) put into the dewar.
+ * Method:    CCD_Compress_Set_Config<br>
+ * Signature: (II)V<br>
+ * Java Native Interface implementation of 
+ * <a href="ccd_compress.html#CCD_Compress_Set_Config">CCD_Compress_Set_Config</a>,
+ * which configures whether subsequent images are saved tile-compressed.
  * If an error occurs a CCDLibraryNativeException is thrown.
- * @return The heater power in Watts is returned.
- * @see ccd_temperature.html#CCD_Temperature_Heater_ADU_To_Power
+ * @see ccd_compress.html#CCD_Compress_Set_Config
  * @see #CCDLibrary_Throw_Exception
  */
-JNIEXPORT jdouble JNICALL Java_ngat_o_ccd_CCDLibrary_CCD_1Temperature_1Heater_1ADU_1To_1Power(JNIEnv *env, jobject obj,
-											      jint heater_adu)
+JNIEXPORT void JNICALL Java_ngat_o_ccd_CCDLibrary_CCD_1Compress_1Set_1Config(JNIEnv *env,jobject obj,
+									   jint type,jint thread_count)
 {
 	int retval;
-	double power;
 
-	retval = CCD_Temperature_Heater_ADU_To_Power(heater_adu,&power);
+	retval = CCD_Compress_Set_Config((int)type,(int)thread_count);
 	/* if an error occured throw an exception. */
 	if(retval == FALSE)
-	{
-		CCDLibrary_Throw_Exception(env,obj,"CCD_Temperature_Heater_ADU_To_Power");
-		return ((jdouble)power);
-	}
-	return (jdouble)power;
+		CCDLibrary_Throw_Exception(env,obj,"CCD_Compress_Set_Config");
 }
 
 /**
  * Class:     ngat_o_ccd_CCDLibrary<br>
- * Method:    CCD_Temperature_Get_Error_Number<br>
+ * Method:    CCD_Compress_Get_Type<br>
  * Signature: ()I<br>
- * Java Native Interface routine to get the error number for the ccd_temperature part of the library.
- * @return The current error number of ccd_temperature. A zero error number means an error has not occured.
- * @see ccd_temperature.html#CCD_Temperature_Get_Error_Number
+ * Java Native Interface implementation of 
+ * <a href="ccd_compress.html#CCD_Compress_Get_Type">CCD_Compress_Get_Type</a>,
+ * which returns the configured compression type.
+ * @see ccd_compress.html#CCD_Compress_Get_Type
+ */
+JNIEXPORT jint JNICALL Java_ngat_o_ccd_CCDLibrary_CCD_1Compress_1Get_1Type(JNIEnv *env,jobject obj)
+{
+	return (jint)CCD_Compress_Get_Type();
+}
+
+/* ------------------------------------------------------------------------------
+** 		ccd_disk_write.c
+** ------------------------------------------------------------------------------ */
+/**
+ * Class:     ngat_o_ccd_CCDLibrary<br>
+ * Method:    CCD_Disk_Write_Set_Config<br>
+ * Signature: (ZI)V<br>
+ * Java Native Interface implementation of 
+ * <a href="ccd_disk_write.html#CCD_Disk_Write_Set_Config">CCD_Disk_Write_Set_Config</a>,
+ * which configures whether subsequent image data is written directly to disc.
+ * If an error occurs a CCDLibraryNativeException is thrown.
+ * @see ccd_disk_write.html#CCD_Disk_Write_Set_Config
+ * @see #CCDLibrary_Throw_Exception
+ */
+JNIEXPORT void JNICALL Java_ngat_o_ccd_CCDLibrary_CCD_1Disk_1Write_1Set_1Config(JNIEnv *env,jobject obj,
+									      jboolean enable,jint fsync_policy)
+{
+	int retval;
+
+	retval = CCD_Disk_Write_Set_Config((int)enable,(int)fsync_policy);
+	/* if an error occured throw an exception. */
+	if(retval == FALSE)
+		CCDLibrary_Throw_Exception(env,obj,"CCD_Disk_Write_Set_Config");
+}
+
+/**
+ * Class:     ngat_o_ccd_CCDLibrary<br>
+ * Method:    CCD_Disk_Write_Get_Enable<br>
+ * Signature: ()Z<br>
+ * Java Native Interface implementation of 
+ * <a href="ccd_disk_write.html#CCD_Disk_Write_Get_Enable">CCD_Disk_Write_Get_Enable</a>,
+ * which returns whether image data is written directly to disc.
+ * @see ccd_disk_write.html#CCD_Disk_Write_Get_Enable
+ */
+JNIEXPORT jboolean JNICALL Java_ngat_o_ccd_CCDLibrary_CCD_1Disk_1Write_1Get_1Enable(JNIEnv *env,jobject obj)
+{
+	return (jboolean)CCD_Disk_Write_Get_Enable();
+}
+
+/**
+ * Class:     ngat_o_ccd_CCDLibrary<br>
+ * Method:    CCD_Disk_Write_Latency_Get<br>
+ * Signature: (D)D<br>
+ * Java Native Interface implementation of 
+ * <a href="ccd_disk_write.html#CCD_Disk_Write_Latency_Get">CCD_Disk_Write_Latency_Get</a>,
+ * which returns a percentile of the recent per-frame direct disc write latencies, in seconds.
+ * If an error occurs a CCDLibraryNativeException is thrown.
+ * @see ccd_disk_write.html#CCD_Disk_Write_Latency_Get
+ * @see #CCDLibrary_Throw_Exception
+ */
+JNIEXPORT jdouble JNICALL Java_ngat_o_ccd_CCDLibrary_CCD_1Disk_1Write_1Latency_1Get(JNIEnv *env,jobject obj,
+										  jdouble percentile)
+{
+	double latency = 0.0;
+	int retval,sample_count;
+
+	retval = CCD_Disk_Write_Latency_Get((double)percentile,&latency,&sample_count);
+	/* if an error occured throw an exception. */
+	if(retval == FALSE)
+		CCDLibrary_Throw_Exception(env,obj,"CCD_Disk_Write_Latency_Get");
+	return (jdouble)latency;
+}
+
+/**
+ * Class:     ngat_o_ccd_CCDLibrary<br>
+ * Method:    CCD_Disk_Write_Latency_Sample_Count_Get<br>
+ * Signature: ()I<br>
+ * Java Native Interface routine returning the number of per-frame direct disc write latencies
+ * <a href="ccd_disk_write.html#CCD_Disk_Write_Latency_Get">CCD_Disk_Write_Latency_Get</a> computes
+ * percentiles from.
+ * @see ccd_disk_write.html#CCD_Disk_Write_Latency_Get
+ */
+JNIEXPORT jint JNICALL Java_ngat_o_ccd_CCDLibrary_CCD_1Disk_1Write_1Latency_1Sample_1Count_1Get(JNIEnv *env,
+											      jobject obj)
+{
+	double latency;
+	int sample_count = 0;
+
+	CCD_Disk_Write_Latency_Get(100.0,&latency,&sample_count);
+	return (jint)sample_count;
+}
+
+/* ------------------------------------------------------------------------------
+** 		ccd_frame_ring.c
+** ------------------------------------------------------------------------------ */
+/**
+ * Class:     ngat_o_ccd_CCDLibrary<br>
+ * Method:    CCD_Frame_Ring_Open<br>
+ * Signature: (Ljava/lang/String;II)V<br>
+ * Java Native Interface implementation of 
+ * <a href="ccd_frame_ring.html#CCD_Frame_Ring_Open">CCD_Frame_Ring_Open</a>,
+ * which creates the shared memory frame ring read out frames are published into.
+ * If an error occurs a CCDLibraryNativeException is thrown.
+ * @see ccd_frame_ring.html#CCD_Frame_Ring_Open
+ * @see #CCDLibrary_Throw_Exception
+ */
+JNIEXPORT void JNICALL Java_ngat_o_ccd_CCDLibrary_CCD_1Frame_1Ring_1Open(JNIEnv *env,jobject obj,jstring name,
+									jint slot_count,jint slot_pixel_count)
+{
+	int retval;
+	const char *cname = NULL;
+
+	/* Change the java strings to a c null terminated string
+	** If the java String is null the C string should be null as well */
+	if(name != NULL)
+		cname = (*env)->GetStringUTFChars(env,name,0);
+	retval = CCD_Frame_Ring_Open((char*)cname,(int)slot_count,(int)slot_pixel_count);
+	/* If we created the C strings we need to free the memory it uses */
+	if(name != NULL)
+		(*env)->ReleaseStringUTFChars(env,name,cname);
+	/* if an error occured throw an exception. */
+	if(retval == FALSE)
+		CCDLibrary_Throw_Exception(env,obj,"CCD_Frame_Ring_Open");
+}
+
+/**
+ * Class:     ngat_o_ccd_CCDLibrary<br>
+ * Method:    CCD_Frame_Ring_Close<br>
+ * Signature: ()V<br>
+ * Java Native Interface implementation of 
+ * <a href="ccd_frame_ring.html#CCD_Frame_Ring_Close">CCD_Frame_Ring_Close</a>,
+ * which closes (and unlinks) the shared memory frame ring.
+ * If an error occurs a CCDLibraryNativeException is thrown.
+ * @see ccd_frame_ring.html#CCD_Frame_Ring_Close
+ * @see #CCDLibrary_Throw_Exception
+ */
+JNIEXPORT void JNICALL Java_ngat_o_ccd_CCDLibrary_CCD_1Frame_1Ring_1Close(JNIEnv *env,jobject obj)
+{
+	int retval;
+
+	retval = CCD_Frame_Ring_Close();
+	/* if an error occured throw an exception. */
+	if(retval == FALSE)
+		CCDLibrary_Throw_Exception(env,obj,"CCD_Frame_Ring_Close");
+}
+
+/* ------------------------------------------------------------------------------
+** 		ccd_preview.c
+** ------------------------------------------------------------------------------ */
+/**
+ * Class:     ngat_o_ccd_CCDLibrary<br>
+ * Method:    CCD_Preview_Set_Config<br>
+ * Signature: (ZLjava/lang/String;[IDD)V<br>
+ * Java Native Interface implementation of 
+ * <a href="ccd_preview.html#CCD_Preview_Set_Config">CCD_Preview_Set_Config</a>,
+ * which configures the quick-look previews produced for subsequent full frames.
+ * If an error occurs a CCDLibraryNativeException is thrown.
+ * @see ccd_preview.html#CCD_Preview_Set_Config
+ * @see #CCDLibrary_Throw_Exception
+ */
+JNIEXPORT void JNICALL Java_ngat_o_ccd_CCDLibrary_CCD_1Preview_1Set_1Config(JNIEnv *env,jobject obj,
+									  jboolean enable,jstring directory,
+									  jintArray bin_factor_list,
+									  jdouble low_percentile,
+									  jdouble high_percentile)
+{
+	int retval,bin_factor_count = 0;
+	const char *cdirectory = NULL;
+	jint *cbin_factor_list = NULL;
+
+	/* Change the java strings to a c null terminated string
+	** If the java String is null the C string should be null as well */
+	if(directory != NULL)
+		cdirectory = (*env)->GetStringUTFChars(env,directory,0);
+	/* If the java array is null, CCD_Preview_Set_Config will fail with a NULL list */
+	if(bin_factor_list != NULL)
+	{
+		bin_factor_count = (*env)->GetArrayLength(env,bin_factor_list);
+		cbin_factor_list = (*env)->GetIntArrayElements(env,bin_factor_list,0);
+	}
+	retval = CCD_Preview_Set_Config((int)enable,(char*)cdirectory,(int*)cbin_factor_list,bin_factor_count,
+					(double)low_percentile,(double)high_percentile);
+	/* If we created the C strings and arrays we need to free the memory they use */
+	if(directory != NULL)
+		(*env)->ReleaseStringUTFChars(env,directory,cdirectory);
+	if(cbin_factor_list != NULL)
+		(*env)->ReleaseIntArrayElements(env,bin_factor_list,cbin_factor_list,JNI_ABORT);
+	/* if an error occured throw an exception. */
+	if(retval == FALSE)
+		CCDLibrary_Throw_Exception(env,obj,"CCD_Preview_Set_Config");
+}
+
+/* ------------------------------------------------------------------------------
+** 		ccd_timing.c
+** ------------------------------------------------------------------------------ */
+/**
+ * Class:     ngat_o_ccd_CCDLibrary<br>
+ * Method:    CCD_Timing_Percentile_Get<br>
+ * Signature: (IID)D<br>
+ * Java Native Interface implementation of 
+ * <a href="ccd_timing.html#CCD_Timing_Percentile_Get">CCD_Timing_Percentile_Get</a>,
+ * which returns a percentile of the durations of an exposure phase, in seconds.
+ * If an error occurs a CCDLibraryNativeException is thrown.
+ * @see ccd_timing.html#CCD_Timing_Percentile_Get
+ * @see #CCDLibrary_Throw_Exception
+ */
+JNIEXPORT jdouble JNICALL Java_ngat_o_ccd_CCDLibrary_CCD_1Timing_1Percentile_1Get(JNIEnv *env,jobject obj,
+										jint config_index,jint phase,
+										jdouble percentile)
+{
+	double duration = 0.0;
+	int retval,count;
+
+	retval = CCD_Timing_Percentile_Get((int)config_index,(int)phase,(double)percentile,&duration,&count);
+	/* if an error occured throw an exception. */
+	if(retval == FALSE)
+		CCDLibrary_Throw_Exception(env,obj,"CCD_Timing_Percentile_Get");
+	return (jdouble)duration;
+}
+
+/**
+ * Class:     ngat_o_ccd_CCDLibrary<br>
+ * Method:    CCD_Timing_Count_Get<br>
+ * Signature: (II)I<br>
+ * Java Native Interface routine returning the number of durations of an exposure phase
+ * <a href="ccd_timing.html#CCD_Timing_Percentile_Get">CCD_Timing_Percentile_Get</a> computes
+ * percentiles from.
+ * If an error occurs a CCDLibraryNativeException is thrown.
+ * @see ccd_timing.html#CCD_Timing_Percentile_Get
+ * @see #CCDLibrary_Throw_Exception
+ */
+JNIEXPORT jint JNICALL Java_ngat_o_ccd_CCDLibrary_CCD_1Timing_1Count_1Get(JNIEnv *env,jobject obj,
+									jint config_index,jint phase)
+{
+	double duration;
+	int retval,count = 0;
+
+	retval = CCD_Timing_Percentile_Get((int)config_index,(int)phase,100.0,&duration,&count);
+	/* if an error occured throw an exception. */
+	if(retval == FALSE)
+		CCDLibrary_Throw_Exception(env,obj,"CCD_Timing_Count_Get");
+	return (jint)count;
+}
+
+/**
+ * Class:     ngat_o_ccd_CCDLibrary<br>
+ * Method:    CCD_Timing_Config_Get<br>
+ * Signature: (I)[I<br>
+ * Java Native Interface implementation of 
+ * <a href="ccd_timing.html#CCD_Timing_Config_Get">CCD_Timing_Config_Get</a>,
+ * which returns a timed exposure configuration, as an array of 5 ints: in use, serial binning, parallel binning,
+ * amplifier and windowed.
+ * If an error occurs a CCDLibraryNativeException is thrown.
+ * @see ccd_timing.html#CCD_Timing_Config_Get
+ * @see #CCDLibrary_Throw_Exception
+ */
+JNIEXPORT jintArray JNICALL Java_ngat_o_ccd_CCDLibrary_CCD_1Timing_1Config_1Get(JNIEnv *env,jobject obj,
+									      jint config_index)
+{
+	jintArray config_array = NULL;
+	jint config_list[5];
+	int retval,in_use,x_bin = 0,y_bin = 0,amplifier = 0,windowed = FALSE;
+
+	retval = CCD_Timing_Config_Get((int)config_index,&in_use,&x_bin,&y_bin,&amplifier,&windowed);
+	/* if an error occured throw an exception. */
+	if(retval == FALSE)
+	{
+		CCDLibrary_Throw_Exception(env,obj,"CCD_Timing_Config_Get");
+		return NULL;
+	}
+	config_list[0] = (jint)in_use;
+	config_list[1] = (jint)x_bin;
+	config_list[2] = (jint)y_bin;
+	config_list[3] = (jint)amplifier;
+	config_list[4] = (jint)windowed;
+	config_array = (*env)->NewIntArray(env,5);
+	if(config_array != NULL)
+		(*env)->SetIntArrayRegion(env,config_array,0,5,config_list);
+	return config_array;
+}
+
+/**
+ * Class:     ngat_o_ccd_CCDLibrary<br>
+ * Method:    CCD_Timing_Phase_Name_Get<br>
+ * Signature: (I)Ljava/lang/String;<br>
+ * Java Native Interface implementation of 
+ * <a href="ccd_timing.html#CCD_Timing_Phase_Name_Get">CCD_Timing_Phase_Name_Get</a>,
+ * which returns the name of an exposure phase, or null if the phase is not legal.
+ * @see ccd_timing.html#CCD_Timing_Phase_Name_Get
+ */
+JNIEXPORT jstring JNICALL Java_ngat_o_ccd_CCDLibrary_CCD_1Timing_1Phase_1Name_1Get(JNIEnv *env,jobject obj,
+										 jint phase)
+{
+	char *name = NULL;
+
+	name = CCD_Timing_Phase_Name_Get((int)phase);
+	if(name == NULL)
+		return NULL;
+	return (*env)->NewStringUTF(env,name);
+}
+
+/**
+ * Class:     ngat_o_ccd_CCDLibrary<br>
+ * Method:    CCD_Timing_Reset<br>
+ * Signature: ()V<br>
+ * Java Native Interface implementation of 
+ * <a href="ccd_timing.html#CCD_Timing_Reset">CCD_Timing_Reset</a>,
+ * which clears the exposure phase histograms.
+ * If an error occurs a CCDLibraryNativeException is thrown.
+ * @see ccd_timing.html#CCD_Timing_Reset
+ * @see #CCDLibrary_Throw_Exception
+ */
+JNIEXPORT void JNICALL Java_ngat_o_ccd_CCDLibrary_CCD_1Timing_1Reset(JNIEnv *env,jobject obj)
+{
+	int retval;
+
+	retval = CCD_Timing_Reset();
+	/* if an error occured throw an exception. */
+	if(retval == FALSE)
+		CCDLibrary_Throw_Exception(env,obj,"CCD_Timing_Reset");
+}
+
+/* ------------------------------------------------------------------------------
+** 		ccd_trace.c
+** ------------------------------------------------------------------------------ */
+/**
+ * Class:     ngat_o_ccd_CCDLibrary<br>
+ * Method:    CCD_Trace_Set_Enable<br>
+ * Signature: (Z)V<br>
+ * Java Native Interface implementation of 
+ * <a href="ccd_trace.html#CCD_Trace_Set_Enable">CCD_Trace_Set_Enable</a>,
+ * which turns controller request tracing on or off.
+ * @see ccd_trace.html#CCD_Trace_Set_Enable
+ */
+JNIEXPORT void JNICALL Java_ngat_o_ccd_CCDLibrary_CCD_1Trace_1Set_1Enable(JNIEnv *env,jobject obj,jboolean enable)
+{
+	CCD_Trace_Set_Enable((int)enable);
+}
+
+/**
+ * Class:     ngat_o_ccd_CCDLibrary<br>
+ * Method:    CCD_Trace_Get_Enable<br>
+ * Signature: ()Z<br>
+ * Java Native Interface implementation of 
+ * <a href="ccd_trace.html#CCD_Trace_Get_Enable">CCD_Trace_Get_Enable</a>,
+ * which returns whether controller requests are being traced.
+ * @see ccd_trace.html#CCD_Trace_Get_Enable
+ */
+JNIEXPORT jboolean JNICALL Java_ngat_o_ccd_CCDLibrary_CCD_1Trace_1Get_1Enable(JNIEnv *env,jobject obj)
+{
+	return (jboolean)CCD_Trace_Get_Enable();
+}
+
+/**
+ * Class:     ngat_o_ccd_CCDLibrary<br>
+ * Method:    CCD_Trace_Dump<br>
+ * Signature: (Ljava/lang/String;)V<br>
+ * Java Native Interface implementation of 
+ * <a href="ccd_trace.html#CCD_Trace_Dump">CCD_Trace_Dump</a>,
+ * which writes the controller request latency counters and trace ring buffers to a file.
+ * If an error occurs a CCDLibraryNativeException is thrown.
+ * @see ccd_trace.html#CCD_Trace_Dump
+ * @see #CCDLibrary_Throw_Exception
+ */
+JNIEXPORT void JNICALL Java_ngat_o_ccd_CCDLibrary_CCD_1Trace_1Dump(JNIEnv *env,jobject obj,jstring filename)
+{
+	int retval;
+	const char *cfilename = NULL;
+
+	/* Change the java strings to a c null terminated string
+	** If the java String is null the C string should be null as well */
+	if(filename != NULL)
+		cfilename = (*env)->GetStringUTFChars(env,filename,0);
+	retval = CCD_Trace_Dump((char*)cfilename);
+	/* If we created the C strings we need to free the memory it uses */
+	if(filename != NULL)
+		(*env)->ReleaseStringUTFChars(env,filename,cfilename);
+	/* if an error occured throw an exception. */
+	if(retval == FALSE)
+		CCDLibrary_Throw_Exception(env,obj,"CCD_Trace_Dump");
+}
+
+/**
+ * Class:     ngat_o_ccd_CCDLibrary<br>
+ * Method:    CCD_Trace_Counters_Get<br>
+ * Signature: ()Ljava/lang/String;<br>
+ * Java Native Interface implementation of 
+ * <a href="ccd_trace.html#CCD_Trace_Counters_Get">CCD_Trace_Counters_Get</a>,
+ * which returns the controller request latency counters as a string, one line per request/DSP command.
+ * If an error occurs a CCDLibraryNativeException is thrown.
+ * @see ccd_trace.html#CCD_Trace_Counters_Get
+ * @see ccd_trace.html#CCD_TRACE_COUNTERS_STRING_LENGTH
+ * @see #CCDLibrary_Throw_Exception
+ */
+JNIEXPORT jstring JNICALL Java_ngat_o_ccd_CCDLibrary_CCD_1Trace_1Counters_1Get(JNIEnv *env,jobject obj)
+{
+	char counters_string[CCD_TRACE_COUNTERS_STRING_LENGTH];
+	int retval;
+
+	retval = CCD_Trace_Counters_Get(counters_string,CCD_TRACE_COUNTERS_STRING_LENGTH);
+	/* if an error occured throw an exception. */
+	if(retval == FALSE)
+	{
+		CCDLibrary_Throw_Exception(env,obj,"CCD_Trace_Counters_Get");
+		return NULL;
+	}
+	return (*env)->NewStringUTF(env,counters_string);
+}
+
+/**
+ * Class:     ngat_o_ccd_CCDLibrary<br>
+ * Method:    CCD_Trace_Reset<br>
+ * Signature: ()V<br>
+ * Java Native Interface implementation of 
+ * <a href="ccd_trace.html#CCD_Trace_Reset">CCD_Trace_Reset</a>,
+ * which clears the controller request latency counters and trace ring buffers.
+ * If an error occurs a CCDLibraryNativeException is thrown.
+ * @see ccd_trace.html#CCD_Trace_Reset
+ * @see #CCDLibrary_Throw_Exception
+ */
+JNIEXPORT void JNICALL Java_ngat_o_ccd_CCDLibrary_CCD_1Trace_1Reset(JNIEnv *env,jobject obj)
+{
+	int retval;
+
+	retval = CCD_Trace_Reset();
+	/* if an error occured throw an exception. */
+	if(retval == FALSE)
+		CCDLibrary_Throw_Exception(env,obj,"CCD_Trace_Reset");
+}
+
+/* ------------------------------------------------------------------------------
+** 		ccd_frame_view.c
+** ------------------------------------------------------------------------------ */
+/**
+ * Class:     ngat_o_ccd_CCDLibrary<br>
+ * Method:    CCD_Frame_View_Set_Enable<br>
+ * Signature: (Z)V<br>
+ * Java Native Interface implementation of 
+ * <a href="ccd_frame_view.html#CCD_Frame_View_Set_Enable">CCD_Frame_View_Set_Enable</a>,
+ * which turns frame viewing (retaining read out frames in memory) on or off.
+ * @see ccd_frame_view.html#CCD_Frame_View_Set_Enable
+ */
+JNIEXPORT void JNICALL Java_ngat_o_ccd_CCDLibrary_CCD_1Frame_1View_1Set_1Enable(JNIEnv *env,jobject obj,
+										jboolean enable)
+{
+	CCD_Frame_View_Set_Enable((int)enable);
+}
+
+/**
+ * Class:     ngat_o_ccd_CCDLibrary<br>
+ * Method:    CCD_Frame_View_Get_Enable<br>
+ * Signature: ()Z<br>
+ * Java Native Interface implementation of 
+ * <a href="ccd_frame_view.html#CCD_Frame_View_Get_Enable">CCD_Frame_View_Get_Enable</a>,
+ * which returns whether read out frames are being retained in memory.
+ * @see ccd_frame_view.html#CCD_Frame_View_Get_Enable
+ */
+JNIEXPORT jboolean JNICALL Java_ngat_o_ccd_CCDLibrary_CCD_1Frame_1View_1Get_1Enable(JNIEnv *env,jobject obj)
+{
+	return (jboolean)CCD_Frame_View_Get_Enable();
+}
+
+/**
+ * Class:     ngat_o_ccd_CCDLibrary<br>
+ * Method:    CCD_Frame_View_Acquire<br>
+ * Signature: ()Lngat/o/ccd/CCDLibraryFrame;<br>
+ * Java Native Interface implementation of 
+ * <a href="ccd_frame_view.html#CCD_Frame_View_Acquire">CCD_Frame_View_Acquire</a>,
+ * which acquires the latest de-interlaced frame. The frame's pixels are wrapped in a direct ByteBuffer
+ * (with NewDirectByteBuffer), so they are not copied. If the CCDLibraryFrame cannot be created,
+ * the frame is released again.
+ * @return A new instance of CCDLibraryFrame, or NULL if an error occurs (and an exception is thrown).
+ * @see ccd_frame_view.html#CCD_Frame_View_Acquire
+ * @see ccd_frame_view.html#CCD_Frame_View_Release
+ * @see #CCDLibrary_Throw_Exception
+ * @see #CCDLibrary_Frame_Create
+ */
+JNIEXPORT jobject JNICALL Java_ngat_o_ccd_CCDLibrary_CCD_1Frame_1View_1Acquire(JNIEnv *env,jobject obj)
+{
+	unsigned short *image_data = NULL;
+	unsigned int sequence;
+	jobject frameInstance;
+	int ncols,nrows,x_bin,y_bin,window_number,retval;
+
+	retval = CCD_Frame_View_Acquire(&image_data,&ncols,&nrows,&x_bin,&y_bin,&window_number,&sequence);
+	if(retval == FALSE)
+	{
+		CCDLibrary_Throw_Exception(env,obj,"CCD_Frame_View_Acquire");
+		return NULL;
+	}
+	frameInstance = CCDLibrary_Frame_Create(env,image_data,((size_t)ncols)*((size_t)nrows),sequence,ncols,nrows,
+						x_bin,y_bin,window_number,FALSE);
+	if(frameInstance == NULL)
+		CCD_Frame_View_Release(sequence);
+	return frameInstance;
+}
+
+/**
+ * Class:     ngat_o_ccd_CCDLibrary<br>
+ * Method:    CCD_Frame_View_Release<br>
+ * Signature: (I)V<br>
+ * Java Native Interface implementation of 
+ * <a href="ccd_frame_view.html#CCD_Frame_View_Release">CCD_Frame_View_Release</a>,
+ * which releases an acquired de-interlaced frame.
+ * If an error occurs a CCDLibraryNativeException is thrown.
+ * @see ccd_frame_view.html#CCD_Frame_View_Release
+ * @see #CCDLibrary_Throw_Exception
+ */
+JNIEXPORT void JNICALL Java_ngat_o_ccd_CCDLibrary_CCD_1Frame_1View_1Release(JNIEnv *env,jobject obj,jint sequence)
+{
+	int retval;
+
+	retval = CCD_Frame_View_Release((unsigned int)sequence);
+	/* if an error occured throw an exception. */
+	if(retval == FALSE)
+		CCDLibrary_Throw_Exception(env,obj,"CCD_Frame_View_Release");
+}
+
+/**
+ * Class:     ngat_o_ccd_CCDLibrary<br>
+ * Method:    CCD_Frame_View_Raw_Get<br>
+ * Signature: ()Lngat/o/ccd/CCDLibraryFrame;<br>
+ * Java Native Interface implementation of 
+ * <a href="ccd_frame_view.html#CCD_Frame_View_Raw_Get">CCD_Frame_View_Raw_Get</a>,
+ * which gets the raw readout buffer of the last readout. The raw readout buffer is unmapped or remapped by
+ * CCD_Setup_Startup, CCD_Setup_Shutdown and CCD_Interface_Memory_Map, so it is not wrapped in a direct
+ * ByteBuffer (which would crash the JVM if read afterwards). Instead CCDLibrary_Frame_Create copies it into
+ * a Java byte array, failing if it has been overwritten or invalidated since CCD_Frame_View_Raw_Get returned.
+ * @return A new instance of CCDLibraryFrame, or NULL if an error occurs (and an exception is thrown).
+ * @see ccd_frame_view.html#CCD_Frame_View_Raw_Get
+ * @see #CCDLibrary_Throw_Exception
+ * @see #CCDLibrary_Frame_Create
+ */
+JNIEXPORT jobject JNICALL Java_ngat_o_ccd_CCDLibrary_CCD_1Frame_1View_1Raw_1Get(JNIEnv *env,jobject obj)
+{
+	unsigned short *raw_data = NULL;
+	unsigned int sequence;
+	size_t pixel_count;
+	int retval;
+
+	retval = CCD_Frame_View_Raw_Get(&raw_data,&pixel_count,&sequence);
+	if(retval == FALSE)
+	{
+		CCDLibrary_Throw_Exception(env,obj,"CCD_Frame_View_Raw_Get");
+		return NULL;
+	}
+	return CCDLibrary_Frame_Create(env,raw_data,pixel_count,sequence,(int)pixel_count,1,1,1,0,TRUE);
+}
+
+/**
+ * Class:     ngat_o_ccd_CCDLibrary<br>
+ * Method:    CCD_Frame_View_Raw_Sequence_Get<br>
+ * Signature: ()I<br>
+ * Java Native Interface implementation of 
+ * <a href="ccd_frame_view.html#CCD_Frame_View_Raw_Sequence_Get">CCD_Frame_View_Raw_Sequence_Get</a>,
+ * which gets the current raw readout buffer sequence number.
+ * @return The raw sequence number.
+ * @see ccd_frame_view.html#CCD_Frame_View_Raw_Sequence_Get
+ */
+JNIEXPORT jint JNICALL Java_ngat_o_ccd_CCDLibrary_CCD_1Frame_1View_1Raw_1Sequence_1Get(JNIEnv *env,jobject obj)
+{
+	return (jint)CCD_Frame_View_Raw_Sequence_Get();
+}
+
+/* ------------------------------------------------------------------------------
+** 		ccd_exposure_event.c
+** ------------------------------------------------------------------------------ */
+/**
+ * Class:     ngat_o_ccd_CCDLibrary<br>
+ * Method:    CCD_Exposure_Event_Wait<br>
+ * Signature: (I)[Lngat/o/ccd/CCDLibraryExposureEvent;<br>
+ * Java Native Interface implementation of 
+ * <a href="ccd_exposure_event.html#CCD_Exposure_Event_Wait">CCD_Exposure_Event_Wait</a>,
+ * which waits for exposure events. The batch of events is returned as an array of CCDLibraryExposureEvent,
+ * which is empty if the timeout expired.
+ * @param timeout_ms The maximum time to wait, in milliseconds.
+ * @return An array of CCDLibraryExposureEvent, or NULL if an error occurs (and an exception is thrown).
+ * @see ccd_exposure_event.html#CCD_Exposure_Event_Wait
+ * @see ccd_exposure_event.html#CCD_EXPOSURE_EVENT_QUEUE_LENGTH
+ * @see #CCDLibrary_Throw_Exception
+ */
+JNIEXPORT jobjectArray JNICALL Java_ngat_o_ccd_CCDLibrary_CCD_1Exposure_1Event_1Wait(JNIEnv *env,jobject obj,
+										     jint timeout_ms)
+{
+	struct CCD_Exposure_Event_Struct event_list[CCD_EXPOSURE_EVENT_QUEUE_LENGTH];
+	jclass cls;
+	jmethodID mid;
+	jobjectArray eventArray = NULL;
+	jobject eventInstance = NULL;
+	jlong time_stamp;
+	int event_count,i,retval;
+
+	retval = CCD_Exposure_Event_Wait((int)timeout_ms,event_list,CCD_EXPOSURE_EVENT_QUEUE_LENGTH,&event_count);
+	if(retval == FALSE)
+	{
+		CCDLibrary_Throw_Exception(env,obj,"CCD_Exposure_Event_Wait");
+		return NULL;
+	}
+/* get the class of CCDLibraryExposureEvent */
+	cls = (*env)->FindClass(env,"ngat/o/ccd/CCDLibraryExposureEvent");
+	/* if the class is null, one of the following exceptions occured:
+	** ClassFormatError,ClassCircularityError,NoClassDefFoundError,OutOfMemoryError */
+	if(cls == NULL)
+		return NULL;
+/* get CCDLibraryExposureEvent constructor */
+	mid = (*env)->GetMethodID(env,cls,"<init>","(IJIIII)V");
+	if(mid == 0)
+	{
+		/* One of the following exceptions has been thrown:
+		** NoSuchMethodError, ExceptionInInitializerError, OutOfMemoryError */
+		return NULL;
+	}
+	eventArray = (*env)->NewObjectArray(env,event_count,cls,NULL);
+	if(eventArray == NULL)
+		return NULL;
+	for(i = 0; i < event_count; i++)
+	{
+		time_stamp = ((jlong)event_list[i].Time_Stamp.tv_sec)*((jlong)CCD_GLOBAL_ONE_SECOND_MS)+
+			((jlong)event_list[i].Time_Stamp.tv_nsec)/((jlong)CCD_GLOBAL_ONE_MILLISECOND_NS);
+		eventInstance = (*env)->NewObject(env,cls,mid,(jint)event_list[i].Type,time_stamp,
+						  (jint)event_list[i].Exposure_Status,(jint)event_list[i].Pixel_Count,
+						  (jint)event_list[i].Expected_Pixel_Count,(jint)event_list[i].Id);
+		if(eventInstance == NULL)
+		{
+			/* One of the following exceptions has been thrown:
+			** InstantiationException, OutOfMemoryError */
+			return NULL;
+		}
+		(*env)->SetObjectArrayElement(env,eventArray,i,eventInstance);
+		(*env)->DeleteLocalRef(env,eventInstance);
+	}
+	return eventArray;
+}
+
+/**
+ * Class:     ngat_o_ccd_CCDLibrary<br>
+ * Method:    CCD_Exposure_Event_Post_Complete<br>
+ * Signature: (I)V<br>
+ * Java Native Interface implementation of 
+ * <a href="ccd_exposure_event.html#CCD_Exposure_Event_Post_Complete">CCD_Exposure_Event_Post_Complete</a>,
+ * which posts a complete event for an asynchronous exposure.
+ * @param id The identifier of the asynchronous exposure.
+ * @see ccd_exposure_event.html#CCD_Exposure_Event_Post_Complete
+ */
+JNIEXPORT void JNICALL Java_ngat_o_ccd_CCDLibrary_CCD_1Exposure_1Event_1Post_1Complete(JNIEnv *env,jobject obj,
+										       jint id)
+{
+	CCD_Exposure_Event_Post_Complete((int)id);
+}
+
+/**
+ * Class:     ngat_o_ccd_CCDLibrary<br>
+ * Method:    CCD_Exposure_Event_Flush<br>
+ * Signature: ()V<br>
+ * Java Native Interface implementation of 
+ * <a href="ccd_exposure_event.html#CCD_Exposure_Event_Flush">CCD_Exposure_Event_Flush</a>,
+ * which removes all queued exposure events.
+ * @see ccd_exposure_event.html#CCD_Exposure_Event_Flush
+ */
+JNIEXPORT void JNICALL Java_ngat_o_ccd_CCDLibrary_CCD_1Exposure_1Event_1Flush(JNIEnv *env,jobject obj)
+{
+	CCD_Exposure_Event_Flush();
+}
+
+/**
+ * Class:     ngat_o_ccd_CCDLibrary<br>
+ * Method:    CCD_Exposure_Event_Get_Dropped_Count<br>
+ * Signature: ()I<br>
+ * Java Native Interface implementation of 
+ * <a href="ccd_exposure_event.html#CCD_Exposure_Event_Get_Dropped_Count">CCD_Exposure_Event_Get_Dropped_Count</a>,
+ * which returns the number of exposure events dropped because the queue was full.
+ * @return The number of dropped events.
+ * @see ccd_exposure_event.html#CCD_Exposure_Event_Get_Dropped_Count
+ */
+JNIEXPORT jint JNICALL Java_ngat_o_ccd_CCDLibrary_CCD_1Exposure_1Event_1Get_1Dropped_1Count(JNIEnv *env,
+											   jobject obj)
+{
+	return (jint)CCD_Exposure_Event_Get_Dropped_Count();
+}
+
+/* ------------------------------------------------------------------------------
+** 		ccd_status.c
+** ------------------------------------------------------------------------------ */
+/**
+ * Class:     ngat_o_ccd_CCDLibrary<br>
+ * Method:    CCD_Status_Get<br>
+ * Signature: (Lngat/o/ccd/CCDLibraryStatus;I)V<br>
+ * Java Native Interface implementation of <a href="ccd_status.html#CCD_Status_Get">CCD_Status_Get</a>,
+ * which takes a status snapshot. The snapshot is copied into the fields of the passed in
+ * CCDLibraryStatus instance, so nothing is allocated.
+ * @param status_instance The CCDLibraryStatus instance to fill in.
+ * @param flags Which controller values to get, a bit mask of CCDLibraryStatus.FLAG_*.
+ * @see ccd_status.html#CCD_Status_Get
+ * @see #Status_Field_List
+ * @see #CCDLibrary_Status_Field_ID_Get
+ * @see #CCDLibrary_Handle_Map_Find
+ * @see #CCDLibrary_Throw_Exception
+ */
+JNIEXPORT void JNICALL Java_ngat_o_ccd_CCDLibrary_CCD_1Status_1Get(JNIEnv *env,jobject obj,jobject status_instance,
+								  jint flags)
+{
+	CCD_Interface_Handle_T* handle = NULL;
+	struct CCD_Status_Struct status;
+	jlong start_time;
+	int retval;
+
+	/* get interface handle from CCDLibrary instance map */
+	if(!CCDLibrary_Handle_Map_Find(env,obj,&handle))
+		return; /* CCDLibrary_Handle_Map_Find throws an exception on failure */
+	CCD_Telemetry_Command_Start();
+	if(!CCDLibrary_Status_Field_ID_Get(env,status_instance))
+	{
+		CCD_Telemetry_Command_End();
+		return; /* CCDLibrary_Status_Field_ID_Get throws an exception on failure */
+	}
+	retval = CCD_Status_Get(handle,(int)flags,&status);
+	if(retval == FALSE)
+	{
+		CCDLibrary_Throw_Exception(env,obj,"CCD_Status_Get");
+		CCD_Telemetry_Command_End();
+		return;
+	}
+	start_time = ((jlong)status.Exposure_Start_Time.tv_sec)*((jlong)CCD_GLOBAL_ONE_SECOND_MS)+
+		((jlong)status.Exposure_Start_Time.tv_nsec)/((jlong)CCD_GLOBAL_ONE_MILLISECOND_NS);
+	(*env)->SetIntField(env,status_instance,Status_Field_List[STATUS_FIELD_EXPOSURE_STATUS].Field_ID,
+			    (jint)status.Exposure_Status);
+	(*env)->SetBooleanField(env,status_instance,Status_Field_List[STATUS_FIELD_SETUP_COMPLETE].Field_ID,
+				(jboolean)status.Setup_Complete);
+	(*env)->SetBooleanField(env,status_instance,Status_Field_List[STATUS_FIELD_SETUP_IN_PROGRESS].Field_ID,
+				(jboolean)status.Setup_In_Progress);
+	(*env)->SetIntField(env,status_instance,Status_Field_List[STATUS_FIELD_BINNED_NCOLS].Field_ID,
+			    (jint)status.Binned_NCols);
+	(*env)->SetIntField(env,status_instance,Status_Field_List[STATUS_FIELD_BINNED_NROWS].Field_ID,
+			    (jint)status.Binned_NRows);
+	(*env)->SetIntField(env,status_instance,Status_Field_List[STATUS_FIELD_X_BIN].Field_ID,(jint)status.X_Bin);
+	(*env)->SetIntField(env,status_instance,Status_Field_List[STATUS_FIELD_Y_BIN].Field_ID,(jint)status.Y_Bin);
+	(*env)->SetIntField(env,status_instance,Status_Field_List[STATUS_FIELD_WINDOW_FLAGS].Field_ID,
+			    (jint)status.Window_Flags);
+	(*env)->SetIntField(env,status_instance,Status_Field_List[STATUS_FIELD_EXPOSURE_LENGTH].Field_ID,
+			    (jint)status.Exposure_Length);
+	(*env)->SetLongField(env,status_instance,Status_Field_List[STATUS_FIELD_EXPOSURE_START_TIME].Field_ID,
+			     start_time);
+	(*env)->SetBooleanField(env,status_instance,
+				Status_Field_List[STATUS_FIELD_ELAPSED_EXPOSURE_TIME_VALID].Field_ID,
+				(jboolean)status.Elapsed_Exposure_Time_Valid);
+	(*env)->SetIntField(env,status_instance,Status_Field_List[STATUS_FIELD_ELAPSED_EXPOSURE_TIME].Field_ID,
+			    (jint)status.Elapsed_Exposure_Time);
+	(*env)->SetIntField(env,status_instance,
+			    Status_Field_List[STATUS_FIELD_ELAPSED_EXPOSURE_TIME_DSP_ERROR_NUMBER].Field_ID,
+			    (jint)status.Elapsed_Exposure_Time_DSP_Error_Number);
+	(*env)->SetBooleanField(env,status_instance,Status_Field_List[STATUS_FIELD_TELEMETRY_RUNNING].Field_ID,
+				(jboolean)status.Telemetry_Running);
+	(*env)->SetBooleanField(env,status_instance,Status_Field_List[STATUS_FIELD_TEMPERATURE_VALID].Field_ID,
+				(jboolean)status.Temperature_Valid);
+	(*env)->SetDoubleField(env,status_instance,Status_Field_List[STATUS_FIELD_TEMPERATURE].Field_ID,
+			       (jdouble)status.Temperature);
+	(*env)->SetBooleanField(env,status_instance,Status_Field_List[STATUS_FIELD_TEMPERATURE_ADU_VALID].Field_ID,
+				(jboolean)status.Temperature_ADU_Valid);
+	(*env)->SetIntField(env,status_instance,Status_Field_List[STATUS_FIELD_HEATER_ADU].Field_ID,
+			    (jint)status.Heater_ADU);
+	(*env)->SetIntField(env,status_instance,Status_Field_List[STATUS_FIELD_UTILITY_BOARD_ADU].Field_ID,
+			    (jint)status.Utility_Board_ADU);
+	(*env)->SetDoubleField(env,status_instance,Status_Field_List[STATUS_FIELD_TEMPERATURE_AGE].Field_ID,
+			       (jdouble)status.Temperature_Age);
+	(*env)->SetIntField(env,status_instance,Status_Field_List[STATUS_FIELD_TEMPERATURE_ERROR_NUMBER].Field_ID,
+			    (jint)status.Temperature_Error_Number);
+	(*env)->SetIntField(env,status_instance,
+			    Status_Field_List[STATUS_FIELD_TEMPERATURE_DSP_ERROR_NUMBER].Field_ID,
+			    (jint)status.Temperature_DSP_Error_Number);
+	(*env)->SetBooleanField(env,status_instance,Status_Field_List[STATUS_FIELD_SUPPLY_VOLTAGE_VALID].Field_ID,
+				(jboolean)status.Supply_Voltage_Valid);
+	(*env)->SetIntField(env,status_instance,Status_Field_List[STATUS_FIELD_HIGH_VOLTAGE_ADU].Field_ID,
+			    (jint)status.High_Voltage_ADU);
+	(*env)->SetIntField(env,status_instance,Status_Field_List[STATUS_FIELD_LOW_VOLTAGE_ADU].Field_ID,
+			    (jint)status.Low_Voltage_ADU);
+	(*env)->SetIntField(env,status_instance,Status_Field_List[STATUS_FIELD_MINUS_LOW_VOLTAGE_ADU].Field_ID,
+			    (jint)status.Minus_Low_Voltage_ADU);
+	(*env)->SetDoubleField(env,status_instance,Status_Field_List[STATUS_FIELD_SUPPLY_VOLTAGE_AGE].Field_ID,
+			       (jdouble)status.Supply_Voltage_Age);
+	(*env)->SetIntField(env,status_instance,
+			    Status_Field_List[STATUS_FIELD_SUPPLY_VOLTAGE_ERROR_NUMBER].Field_ID,
+			    (jint)status.Supply_Voltage_Error_Number);
+	(*env)->SetIntField(env,status_instance,
+			    Status_Field_List[STATUS_FIELD_SUPPLY_VOLTAGE_DSP_ERROR_NUMBER].Field_ID,
+			    (jint)status.Supply_Voltage_DSP_Error_Number);
+	CCD_Telemetry_Command_End();
+}
+
+/**
+ * Class:     ngat_o_ccd_CCDLibrary<br>
+ * Method:    CCD_Status_Get_Error_Number<br>
+ * Signature: ()I<br>
+ * Java Native Interface routine to get the error number for the ccd_status part of the library.
+ * @return The current error number of ccd_status. A zero error number means an error has not occured.
+ * @see ccd_status.html#CCD_Status_Get_Error_Number
+ */
+JNIEXPORT jint JNICALL Java_ngat_o_ccd_CCDLibrary_CCD_1Status_1Get_1Error_1Number(JNIEnv *env,jobject obj)
+{
+	return CCD_Status_Get_Error_Number();
+}
+
+/* ------------------------------------------------------------------------------
+** 		ccd_source_find.c
+** ------------------------------------------------------------------------------ */
+/**
+ * Class:     ngat_o_ccd_CCDLibrary<br>
+ * Method:    CCD_Source_Find_Set_Config<br>
+ * Signature: (DII)V<br>
+ * Java Native Interface implementation of 
+ * <a href="ccd_source_find.html#CCD_Source_Find_Set_Config">CCD_Source_Find_Set_Config</a>,
+ * which configures the source finder.
+ * If an error occurs a CCDLibraryNativeException is thrown.
+ * @see ccd_source_find.html#CCD_Source_Find_Set_Config
+ * @see #CCDLibrary_Throw_Exception
+ */
+JNIEXPORT void JNICALL Java_ngat_o_ccd_CCDLibrary_CCD_1Source_1Find_1Set_1Config(JNIEnv *env,jobject obj,
+							jdouble threshold_sigma,jint min_pixel_count,jint thread_count)
+{
+	int retval;
+
+	retval = CCD_Source_Find_Set_Config((double)threshold_sigma,(int)min_pixel_count,(int)thread_count);
+	/* if an error occured throw an exception. */
+	if(retval == FALSE)
+		CCDLibrary_Throw_Exception(env,obj,"CCD_Source_Find_Set_Config");
+}
+
+/**
+ * Class:     ngat_o_ccd_CCDLibrary<br>
+ * Method:    CCD_Source_Find_Set_Enable<br>
+ * Signature: (Z)V<br>
+ * Java Native Interface implementation of 
+ * <a href="ccd_source_find.html#CCD_Source_Find_Set_Enable">CCD_Source_Find_Set_Enable</a>,
+ * which turns running the source finder on each full frame after readout on or off.
+ * If an error occurs a CCDLibraryNativeException is thrown.
+ * @see ccd_source_find.html#CCD_Source_Find_Set_Enable
+ * @see #CCDLibrary_Throw_Exception
+ */
+JNIEXPORT void JNICALL Java_ngat_o_ccd_CCDLibrary_CCD_1Source_1Find_1Set_1Enable(JNIEnv *env,jobject obj,
+										   jboolean enable)
+{
+	int retval;
+
+	retval = CCD_Source_Find_Set_Enable((int)enable);
+	/* if an error occured throw an exception. */
+	if(retval == FALSE)
+		CCDLibrary_Throw_Exception(env,obj,"CCD_Source_Find_Set_Enable");
+}
+
+/**
+ * Class:     ngat_o_ccd_CCDLibrary<br>
+ * Method:    CCD_Source_Find_Get_Last_Result<br>
+ * Signature: ()Lngat/o/ccd/CCDLibrarySourceFindResult;<br>
+ * Java Native Interface implementation of 
+ * <a href="ccd_source_find.html#CCD_Source_Find_Get_Last_Result">CCD_Source_Find_Get_Last_Result</a>,
+ * which gets the result of running the source finder on the last frame read out.
+ * @return A new instance of CCDLibrarySourceFindResult, or NULL if an error occurs (and an exception is thrown).
+ * @see ccd_source_find.html#CCD_Source_Find_Get_Last_Result
+ * @see #CCDLibrary_Throw_Exception
+ */
+JNIEXPORT jobject JNICALL Java_ngat_o_ccd_CCDLibrary_CCD_1Source_1Find_1Get_1Last_1Result(JNIEnv *env,jobject obj)
+{
+	struct CCD_Source_Find_Result_Struct result;
+	jclass cls;
+	jmethodID mid;
+	jobject resultInstance;
+	int retval;
+
+	retval = CCD_Source_Find_Get_Last_Result(&result);
+	if(retval == FALSE)
+	{
+		CCDLibrary_Throw_Exception(env,obj,"CCD_Source_Find_Get_Last_Result");
+		return NULL;
+	}
+/* get the class of CCDLibrarySourceFindResult */
+	cls = (*env)->FindClass(env,"ngat/o/ccd/CCDLibrarySourceFindResult");
+	/* if the class is null, one of the following exceptions occured:
+	** ClassFormatError,ClassCircularityError,NoClassDefFoundError,OutOfMemoryError */
+	if(cls == NULL)
+		return NULL;
+/* get CCDLibrarySourceFindResult constructor */
+	mid = (*env)->GetMethodID(env,cls,"<init>","(IIDDDIDDDIIZD)V");
+	if(mid == 0)
+	{
+		/* One of the following exceptions has been thrown:
+		** NoSuchMethodError, ExceptionInInitializerError, OutOfMemoryError */
+		return NULL;
+	}
+/* call constructor */
+	resultInstance = (*env)->NewObject(env,cls,mid,(jint)result.NCols,(jint)result.NRows,
+				(jdouble)result.Background,(jdouble)result.Background_Sigma,
+				(jdouble)result.Threshold,(jint)result.Object_Count,
+				(jdouble)result.Brightest.X,(jdouble)result.Brightest.Y,(jdouble)result.Brightest.Flux,
+				(jint)result.Brightest.Peak,(jint)result.Brightest.Pixel_Count,
+				(jboolean)result.Brightest.Is_Saturated,(jdouble)result.Elapsed_Time);
+	if(resultInstance == NULL)
+	{
+		/* One of the following exceptions has been thrown:
+		** InstantiationException, OutOfMemoryError */
+		return NULL;
+	}
+	return resultInstance;
+}
+
+/* ------------------------------------------------------------------------------
+** 		ccd_seeing.c
+** ------------------------------------------------------------------------------ */
+/**
+ * Class:     ngat_o_ccd_CCDLibrary<br>
+ * Method:    CCD_Seeing_Set_Config<br>
+ * Signature: (DIIII)V<br>
+ * Java Native Interface implementation of 
+ * <a href="ccd_seeing.html#CCD_Seeing_Set_Config">CCD_Seeing_Set_Config</a>,
+ * which configures the seeing estimator.
+ * If an error occurs a CCDLibraryNativeException is thrown.
+ * @see ccd_seeing.html#CCD_Seeing_Set_Config
+ * @see #CCDLibrary_Throw_Exception
+ */
+JNIEXPORT void JNICALL Java_ngat_o_ccd_CCDLibrary_CCD_1Seeing_1Set_1Config(JNIEnv *env,jobject obj,
+					jdouble threshold_sigma,jint cutout_radius,jint saturation_counts,
+					jint max_source_count,jint thread_count)
+{
+	int retval;
+
+	retval = CCD_Seeing_Set_Config((double)threshold_sigma,(int)cutout_radius,(int)saturation_counts,
+				       (int)max_source_count,(int)thread_count);
+	/* if an error occured throw an exception. */
+	if(retval == FALSE)
+		CCDLibrary_Throw_Exception(env,obj,"CCD_Seeing_Set_Config");
+}
+
+/**
+ * Class:     ngat_o_ccd_CCDLibrary<br>
+ * Method:    CCD_Seeing_Set_Enable<br>
+ * Signature: (Z)V<br>
+ * Java Native Interface implementation of 
+ * <a href="ccd_seeing.html#CCD_Seeing_Set_Enable">CCD_Seeing_Set_Enable</a>,
+ * which turns running the seeing estimator on each frame after readout on or off.
+ * If an error occurs a CCDLibraryNativeException is thrown.
+ * @see ccd_seeing.html#CCD_Seeing_Set_Enable
+ * @see #CCDLibrary_Throw_Exception
+ */
+JNIEXPORT void JNICALL Java_ngat_o_ccd_CCDLibrary_CCD_1Seeing_1Set_1Enable(JNIEnv *env,jobject obj,jboolean enable)
+{
+	int retval;
+
+	retval = CCD_Seeing_Set_Enable((int)enable);
+	/* if an error occured throw an exception. */
+	if(retval == FALSE)
+		CCDLibrary_Throw_Exception(env,obj,"CCD_Seeing_Set_Enable");
+}
+
+/**
+ * Class:     ngat_o_ccd_CCDLibrary<br>
+ * Method:    CCD_Seeing_Get_Last_Result<br>
+ * Signature: ()Lngat/o/ccd/CCDLibrarySeeingResult;<br>
+ * Java Native Interface implementation of 
+ * <a href="ccd_seeing.html#CCD_Seeing_Get_Last_Result">CCD_Seeing_Get_Last_Result</a>,
+ * which gets the result of running the seeing estimator on the last frame read out.
+ * @return A new instance of CCDLibrarySeeingResult, or NULL if an error occurs (and an exception is thrown).
+ * @see ccd_seeing.html#CCD_Seeing_Get_Last_Result
+ * @see #CCDLibrary_Throw_Exception
+ */
+JNIEXPORT jobject JNICALL Java_ngat_o_ccd_CCDLibrary_CCD_1Seeing_1Get_1Last_1Result(JNIEnv *env,jobject obj)
+{
+	struct CCD_Seeing_Result_Struct result;
+	jclass cls;
+	jmethodID mid;
+	jobject resultInstance;
+	int retval;
+
+	retval = CCD_Seeing_Get_Last_Result(&result);
+	if(retval == FALSE)
+	{
+		CCDLibrary_Throw_Exception(env,obj,"CCD_Seeing_Get_Last_Result");
+		return NULL;
+	}
+/* get the class of CCDLibrarySeeingResult */
+	cls = (*env)->FindClass(env,"ngat/o/ccd/CCDLibrarySeeingResult");
+	/* if the class is null, one of the following exceptions occured:
+	** ClassFormatError,ClassCircularityError,NoClassDefFoundError,OutOfMemoryError */
+	if(cls == NULL)
+		return NULL;
+/* get CCDLibrarySeeingResult constructor */
+	mid = (*env)->GetMethodID(env,cls,"<init>","(IIDDIIIDDDDD)V");
+	if(mid == 0)
+	{
+		/* One of the following exceptions has been thrown:
+		** NoSuchMethodError, ExceptionInInitializerError, OutOfMemoryError */
+		return NULL;
+	}
+/* call constructor */
+	resultInstance = (*env)->NewObject(env,cls,mid,(jint)result.NCols,(jint)result.NRows,
+				(jdouble)result.Background,(jdouble)result.Background_Sigma,
+				(jint)result.Candidate_Count,(jint)result.Source_Count,(jint)result.Fit_Count,
+				(jdouble)result.Moment_FWHM,(jdouble)result.FWHM,(jdouble)result.FWHM_Sigma,
+				(jdouble)result.Ellipticity,(jdouble)result.Elapsed_Time);
+	if(resultInstance == NULL)
+	{
+		/* One of the following exceptions has been thrown:
+		** InstantiationException, OutOfMemoryError */
+		return NULL;
+	}
+	return resultInstance;
+}
+
+/* ------------------------------------------------------------------------------
+** 		ccd_readout_watchdog.c
+** ------------------------------------------------------------------------------ */
+/**
+ * Class:     ngat_o_ccd_CCDLibrary<br>
+ * Method:    CCD_Readout_Watchdog_Set_Config<br>
+ * Signature: (IDIID)V<br>
+ * Java Native Interface implementation of 
+ * <a href="ccd_readout_watchdog.html#CCD_Readout_Watchdog_Set_Config">CCD_Readout_Watchdog_Set_Config</a>,
+ * which configures the readout progress-rate watchdog.
+ * If an error occurs a CCDLibraryNativeException is thrown.
+ * @see ccd_readout_watchdog.html#CCD_Readout_Watchdog_Set_Config
+ * @see #CCDLibrary_Throw_Exception
+ */
+JNIEXPORT void JNICALL Java_ngat_o_ccd_CCDLibrary_CCD_1Readout_1Watchdog_1Set_1Config(JNIEnv *env,jobject obj,
+					jint poll_period_ms,jdouble stall_factor,jint min_stall_time_ms,
+					jint unknown_stall_time_ms,jdouble slow_ratio)
+{
+	int retval;
+
+	retval = CCD_Readout_Watchdog_Set_Config((int)poll_period_ms,(double)stall_factor,(int)min_stall_time_ms,
+						 (int)unknown_stall_time_ms,(double)slow_ratio);
+	/* if an error occured throw an exception. */
+	if(retval == FALSE)
+		CCDLibrary_Throw_Exception(env,obj,"CCD_Readout_Watchdog_Set_Config");
+}
+
+/* ------------------------------------------------------------------------------
+** 		ccd_telemetry.c
+** ------------------------------------------------------------------------------ */
+/**
+ * Class:     ngat_o_ccd_CCDLibrary<br>
+ * Method:    CCD_Telemetry_Start<br>
+ * Signature: (I)V<br>
+ * Java Native Interface implementation of <a href="ccd_telemetry.html#CCD_Telemetry_Start">CCD_Telemetry_Start</a>,
+ * which starts the telemetry sampler thread.
+ * If an error occurs a CCDLibraryNativeException is thrown.
+ * @see ccd_interface.html#CCD_Interface_Handle_T
+ * @see ccd_telemetry.html#CCD_Telemetry_Start
+ * @see #CCDLibrary_Throw_Exception
+ * @see #CCDLibrary_Handle_Map_Find
+ */
+JNIEXPORT void JNICALL Java_ngat_o_ccd_CCDLibrary_CCD_1Telemetry_1Start(JNIEnv *env,jobject obj,jint period_ms)
+{
+	CCD_Interface_Handle_T *handle = NULL;
+	int retval;
+
+	/* get interface handle from CCDLibrary instance map */
+	if(!CCDLibrary_Handle_Map_Find(env,obj,&handle))
+		return; /* CCDLibrary_Handle_Map_Find throws an exception on failure */
+	retval = CCD_Telemetry_Start(handle,(int)period_ms);
+	/* if an error occured throw an exception. */
+	if(retval == FALSE)
+		CCDLibrary_Throw_Exception(env,obj,"CCD_Telemetry_Start");
+}
+
+/**
+ * Class:     ngat_o_ccd_CCDLibrary<br>
+ * Method:    CCD_Telemetry_Stop<br>
+ * Signature: ()V<br>
+ * Java Native Interface implementation of <a href="ccd_telemetry.html#CCD_Telemetry_Stop">CCD_Telemetry_Stop</a>,
+ * which stops the telemetry sampler thread.
+ * If an error occurs a CCDLibraryNativeException is thrown.
+ * @see ccd_telemetry.html#CCD_Telemetry_Stop
+ * @see #CCDLibrary_Throw_Exception
+ */
+JNIEXPORT void JNICALL Java_ngat_o_ccd_CCDLibrary_CCD_1Telemetry_1Stop(JNIEnv *env,jobject obj)
+{
+	int retval;
+
+	retval = CCD_Telemetry_Stop();
+	/* if an error occured throw an exception. */
+	if(retval == FALSE)
+		CCDLibrary_Throw_Exception(env,obj,"CCD_Telemetry_Stop");
+}
+
+/**
+ * Class:     ngat_o_ccd_CCDLibrary<br>
+ * Method:    CCD_Telemetry_Get<br>
+ * Signature: ()Lngat/o/ccd/CCDLibraryTelemetry;<br>
+ * Java Native Interface implementation of <a href="ccd_telemetry.html#CCD_Telemetry_Get">CCD_Telemetry_Get</a>,
+ * which gets a copy of the latest telemetry snapshot. The ages of each group of values are calculated
+ * here using CCD_Telemetry_Age_Get, and passed to the CCDLibraryTelemetry constructor.
+ * @return A new instance of CCDLibraryTelemetry, or NULL if an error occurs (and an exception is thrown).
+ * @see ccd_telemetry.html#CCD_Telemetry_Get
+ * @see ccd_telemetry.html#CCD_Telemetry_Age_Get
+ * @see #CCDLibrary_Throw_Exception
+ */
+JNIEXPORT jobject JNICALL Java_ngat_o_ccd_CCDLibrary_CCD_1Telemetry_1Get(JNIEnv *env,jobject obj)
+{
+	struct CCD_Telemetry_Struct telemetry;
+	jclass cls;
+	jmethodID mid;
+	jobject telemetryInstance;
+	int retval;
+
+	retval = CCD_Telemetry_Get(&telemetry);
+	if(retval == FALSE)
+	{
+		CCDLibrary_Throw_Exception(env,obj,"CCD_Telemetry_Get");
+		return NULL;
+	}
+/* get the class of CCDLibraryTelemetry */
+	cls = (*env)->FindClass(env,"ngat/o/ccd/CCDLibraryTelemetry");
+	/* if the class is null, one of the following exceptions occured:
+	** ClassFormatError,ClassCircularityError,NoClassDefFoundError,OutOfMemoryError */
+	if(cls == NULL)
+		return NULL;
+/* get CCDLibraryTelemetry constructor */
+	mid = (*env)->GetMethodID(env,cls,"<init>","(ZIDDIIDIIIDIII)V");
+	if(mid == 0)
+	{
+		/* One of the following exceptions has been thrown:
+		** NoSuchMethodError, ExceptionInInitializerError, OutOfMemoryError */
+		return NULL;
+	}
+/* call constructor */
+	telemetryInstance = (*env)->NewObject(env,cls,mid,(jboolean)telemetry.Running,(jint)telemetry.Sample_Count,
+				(jdouble)telemetry.Temperature,
+				(jdouble)CCD_Telemetry_Age_Get(telemetry.Temperature_Timestamp),
+				(jint)telemetry.Heater_ADU,(jint)telemetry.Utility_Board_ADU,
+				(jdouble)CCD_Telemetry_Age_Get(telemetry.Supply_Voltage_Timestamp),
+				(jint)telemetry.High_Voltage_ADU,(jint)telemetry.Low_Voltage_ADU,
+				(jint)telemetry.Minus_Low_Voltage_ADU,
+				(jdouble)CCD_Telemetry_Age_Get(telemetry.State_Timestamp),
+				(jint)telemetry.Exposure_Status,(jint)telemetry.Filter_Wheel_Status,
+				(jint)telemetry.Filter_Wheel_Position);
+	if(telemetryInstance == NULL)
+	{
+		/* One of the following exceptions has been thrown:
+		** InstantiationException, OutOfMemoryError */
+		return NULL;
+	}
+	return telemetryInstance;
+}
+
+/* ------------------------------------------------------------------------------
+** 		ccd_telemetry_store.c
+** ------------------------------------------------------------------------------ */
+/**
+ * Class:     ngat_o_ccd_CCDLibrary<br>
+ * Method:    CCD_Telemetry_Store_Open<br>
+ * Signature: (Ljava/lang/String;I)V<br>
+ * Java Native Interface implementation of 
+ * <a href="ccd_telemetry_store.html#CCD_Telemetry_Store_Open">CCD_Telemetry_Store_Open</a>,
+ * which opens (creating if necessary) the telemetry store ring file for writing.
+ * If an error occurs a CCDLibraryNativeException is thrown.
+ * @see ccd_telemetry_store.html#CCD_Telemetry_Store_Open
+ * @see #CCDLibrary_Throw_Exception
+ */
+JNIEXPORT void JNICALL Java_ngat_o_ccd_CCDLibrary_CCD_1Telemetry_1Store_1Open(JNIEnv *env,jobject obj,
+									       jstring filename,jint record_count)
+{
+	int retval;
+	const char *cfilename = NULL;
+
+	/* Change the java strings to a c null terminated string
+	** If the java String is null the C string should be null as well */
+	if(filename != NULL)
+		cfilename = (*env)->GetStringUTFChars(env,filename,0);
+	retval = CCD_Telemetry_Store_Open((char*)cfilename,(int)record_count,TRUE);
+	/* If we created the C strings we need to free the memory it uses */
+	if(filename != NULL)
+		(*env)->ReleaseStringUTFChars(env,filename,cfilename);
+	/* if an error occured throw an exception. */
+	if(retval == FALSE)
+		CCDLibrary_Throw_Exception(env,obj,"CCD_Telemetry_Store_Open");
+}
+
+/**
+ * Class:     ngat_o_ccd_CCDLibrary<br>
+ * Method:    CCD_Telemetry_Store_Close<br>
+ * Signature: ()V<br>
+ * Java Native Interface implementation of 
+ * <a href="ccd_telemetry_store.html#CCD_Telemetry_Store_Close">CCD_Telemetry_Store_Close</a>,
+ * which closes the telemetry store ring file.
+ * If an error occurs a CCDLibraryNativeException is thrown.
+ * @see ccd_telemetry_store.html#CCD_Telemetry_Store_Close
+ * @see #CCDLibrary_Throw_Exception
+ */
+JNIEXPORT void JNICALL Java_ngat_o_ccd_CCDLibrary_CCD_1Telemetry_1Store_1Close(JNIEnv *env,jobject obj)
+{
+	int retval;
+
+	retval = CCD_Telemetry_Store_Close();
+	/* if an error occured throw an exception. */
+	if(retval == FALSE)
+		CCDLibrary_Throw_Exception(env,obj,"CCD_Telemetry_Store_Close");
+}
+
+/* ------------------------------------------------------------------------------
+** 		ccd_temperature.c
+** ------------------------------------------------------------------------------ */
+/**
+ * Class:     ngat_o_ccd_CCDLibrary<br>
+ * Method:    CCD_Temperature_Get<br>
+ * Signature: ()D<br>
+ * Java Native Interface implementation of <a href="ccd_temperature.html#CCD_Temperature_Get">CCD_Temperature_Get</a>,
+ * which gets the current temperature of the CCD. 
+ * @see ccd_interface.html#CCD_Interface_Handle_T
+ * @see ccd_temperature.html#CCD_Temperature_Get
+ * @see #CCDLibrary_Throw_Exception
+ * @see #CCDLibrary_Handle_Map_Find
+ */
+JNIEXPORT jdouble JNICALL Java_ngat_o_ccd_CCDLibrary_CCD_1Temperature_1Get(JNIEnv *env,jobject obj)
+{
+	CCD_Interface_Handle_T *handle = NULL;
+	double dvalue;
+	int retval;
+
+	/* get interface handle from CCDLibrary instance map */
+	if(!CCDLibrary_Handle_Map_Find(env,obj,&handle))
+		return -1.0; /* CCDLibrary_Handle_Map_Find throws an exception on failure */
+	CCD_Telemetry_Command_Start();
+	/* get temperature */
+	retval = CCD_Temperature_Get(handle,&dvalue);
+	/* if an error occured throw an exception. */
+	if(retval == FALSE)
+	{
+		CCDLibrary_Throw_Exception(env,obj,"CCD_Temperature_Get");
+		CCD_Telemetry_Command_End();
+		return ((jdouble)dvalue);
+	}
+	CCD_Telemetry_Command_End();
+	return ((jdouble)dvalue);
+}
+
+/**
+ * Class:     ngat_o_ccd_CCDLibrary<br>
+ * Method:    CCD_Temperature_Set<br>
+ * Signature: (D)V<br>
+ * Java Native Interface implementation of <a href="ccd_temperature.html#CCD_Temperature_Set">CCD_Temperature_Set</a>,
+ * which sets the temperature of the CCD. 
+ * If an error occurs a CCDLibraryNativeException is thrown.
+ * @see ccd_interface.html#CCD_Interface_Handle_T
+ * @see ccd_temperature.html#CCD_Temperature_Set
+ * @see #CCDLibrary_Throw_Exception
+ * @see #CCDLibrary_Handle_Map_Find
+ */
+JNIEXPORT void JNICALL Java_ngat_o_ccd_CCDLibrary_CCD_1Temperature_1Set(JNIEnv *env,jobject obj,
+									jdouble target_temperature)
+{
+	CCD_Interface_Handle_T *handle = NULL;
+	int retval;
+
+	/* get interface handle from CCDLibrary instance map */
+	if(!CCDLibrary_Handle_Map_Find(env,obj,&handle))
+		return; /* CCDLibrary_Handle_Map_Find throws an exception on failure */
+	CCD_Telemetry_Command_Start();
+	/* set temperature */
+	retval = CCD_Temperature_Set(handle,target_temperature);
+	/* if an error occured throw an exception. */
+	if(retval == FALSE)
+		CCDLibrary_Throw_Exception(env,obj,"CCD_Temperature_Set");
+	CCD_Telemetry_Command_End();
+}
+
+/**
+ * Class:     ngat_o_ccd_CCDLibrary<br>
+ * Method:    CCD_Temperature_Get_Utility_Board_ADU<br>
+ * Signature: ()I<br>
+ * Java Native Interface implementation of CCD_Temperature_Get_Utility_Board_ADU,
+ * which gets the Analogue to Digital counts from the utility board mounted temperature sensor. 
+ * If an error occurs a CCDLibraryNativeException is thrown.
+ * @return The current ADU count is returned. If an error occurs an exception is thrown, and this routine
+ * 	returns -1.
+ * @see ccd_interface.html#CCD_Interface_Handle_T
+ * @see ccd_temperature.html#CCD_Temperature_Get_Utility_Board_ADU
+ * @see #CCDLibrary_Throw_Exception
+ * @see #CCDLibrary_Handle_Map_Find
+ */
+JNIEXPORT jint JNICALL Java_ngat_o_ccd_CCDLibrary_CCD_1Temperature_1Get_1Utility_1Board_1ADU(JNIEnv *env,jobject obj)
+{
+	CCD_Interface_Handle_T *handle = NULL;
+	int retval,adu = -1;
+
+	/* get interface handle from CCDLibrary instance map */
+	if(!CCDLibrary_Handle_Map_Find(env,obj,&handle))
+		return -1; /* CCDLibrary_Handle_Map_Find throws an exception on failure */
+	CCD_Telemetry_Command_Start();
+	/* get utility board ADU */
+	retval = CCD_Temperature_Get_Utility_Board_ADU(handle,&adu);
+	/* if an error occured throw an exception. */
+	if(retval == FALSE)
+	{
+		CCDLibrary_Throw_Exception(env,obj,"CCD_Temperature_Get_Utility_Board_ADU");
+		CCD_Telemetry_Command_End();
+		return ((jint)adu);
+	}
+	CCD_Telemetry_Command_End();
+	return ((jint)adu);
+}
+
+/**
+ * Class:     ngat_o_ccd_CCDLibrary<br>
+ * Method:    CCD_Temperature_Get_Heater_ADU<br>
+ * Signature: ()I<br>
+ * Java Native Interface implementation of CCD_Temperature_Get_Heater_ADU,
+ * which gets the current heater Analogue to Digital counts from the utility board. 
+ * If an error occurs a CCDLibraryNativeException is thrown.
+ * @return The current ADU count is returned. If an error occurs an exception is thrown, and this routine
+ * 	returns -1.
+ * @see ccd_interface.html#CCD_Interface_Handle_T
+ * @see ccd_temperature.html#CCD_Temperature_Get_Heater_ADU
+ * @see #CCDLibrary_Throw_Exception
+ * @see #CCDLibrary_Handle_Map_Find
+ */
+JNIEXPORT jint JNICALL Java_ngat_o_ccd_CCDLibrary_CCD_1Temperature_1Get_1Heater_1ADU(JNIEnv *env,jobject obj)
+{
+	CCD_Interface_Handle_T *handle = NULL;
+	int retval,adu = -1;
+
+	/* get interface handle from CCDLibrary instance map */
+	if(!CCDLibrary_Handle_Map_Find(env,obj,&handle))
+		return -1; /* CCDLibrary_Handle_Map_Find throws an exception on failure */
+	CCD_Telemetry_Command_Start();
+	/* get heater ADU */
+	retval = CCD_Temperature_Get_Heater_ADU(handle,&adu);
+	/* if an error occured throw an exception. */
+	if(retval == FALSE)
+	{
+		CCDLibrary_Throw_Exception(env,obj,"CCD_Temperature_Get_Heater_ADU");
+		CCD_Telemetry_Command_End();
+		return ((jint)adu);
+	}
+	CCD_Telemetry_Command_End();
+	return ((jint)adu);
+}
+
+/**
+ * Class:     ngat_o_ccd_CCDLibrary<br>
+ * Method:    CCD_Temperature_Heater_ADU_To_Power<br>
+ * Signature: (I)D<br>
+ * Java Native Interface implementation of CCD_Temperature_Heater_ADU_To_Power,
+ * which converts a heater adu into a measure of power (in Watts) put into the dewar.
+ * If an error occurs a CCDLibraryNativeException is thrown.
+ * @return The heater power in Watts is returned.
+ * @see ccd_temperature.html#CCD_Temperature_Heater_ADU_To_Power
+ * @see #CCDLibrary_Throw_Exception
+ */
+JNIEXPORT jdouble JNICALL Java_ngat_o_ccd_CCDLibrary_CCD_1Temperature_1Heater_1ADU_1To_1Power(JNIEnv *env, jobject obj,
+											      jint heater_adu)
+{
+	int retval;
+	double power;
+
+	retval = CCD_Temperature_Heater_ADU_To_Power(heater_adu,&power);
+	/* if an error occured throw an exception. */
+	if(retval == FALSE)
+	{
+		CCDLibrary_Throw_Exception(env,obj,"CCD_Temperature_Heater_ADU_To_Power");
+		return ((jdouble)power);
+	}
+	return (jdouble)power;
+}
+
+/**
+ * Class:     ngat_o_ccd_CCDLibrary<br>
+ * Method:    CCD_Temperature_Get_Error_Number<br>
+ * Signature: ()I<br>
+ * Java Native Interface routine to get the error number for the ccd_temperature part of the library.
+ * @return The current error number of ccd_temperature. A zero error number means an error has not occured.
+ * @see ccd_temperature.html#CCD_Temperature_Get_Error_Number
  */
 JNIEXPORT jint JNICALL Java_ngat_o_ccd_CCDLibrary_CCD_1Temperature_1Get_1Error_1Number(JNIEnv *env,jobject obj)
 {
@@ -1952,32 +3644,31 @@ static int CCDLibrary_Java_String_List_Free(JNIEnv *env,jobject obj,
 
 /**
  * Routine to add a mapping from the CCDLibrary instance instance to the opened CCD Interface Handle
- * interface_handle, in the Handle_Map_List.
+ * interface_handle. If the instance already has a valid handle, the map entry is updated. Otherwise a free
+ * entry in Handle_Map_List is used, and given a new generation number (Handle_Map_Add_Count*HANDLE_MAP_SIZE
+ * plus the index). The generation number is stored in the instance's nativeHandleGeneration field.
  * @param instance The CCDLibrary instance.
  * @param interface_handle The interface handle.
  * @return The routine returns TRUE if the map is added (or updated), FALSE if there was no room left
- *         in the mapping list. 
+ *         in the mapping list, or the fields could not be found.
  *         CCDLibrary_Throw_Exception_String is used to throw a Java exception if the routine returns FALSE.
  * @see #HANDLE_MAP_SIZE
  * @see #Handle_Map_List
+ * @see #Handle_Map_Add_Count
+ * @see #handle_generation_field_id
+ * @see #CCDLibrary_Handle_Field_ID_Get
+ * @see #CCDLibrary_Handle_Map_Index_Get
  * @see #CCDLibrary_Throw_Exception_String
  */
 static int CCDLibrary_Handle_Map_Add(JNIEnv *env,jobject instance,CCD_Interface_Handle_T* interface_handle)
 {
+	CCD_Interface_Handle_T* old_interface_handle = NULL;
 	int i,done;
-	jobject global_instance = NULL;
 
+	if(!CCDLibrary_Handle_Field_ID_Get(env,instance))
+		return FALSE; /* CCDLibrary_Handle_Field_ID_Get throws an exception on failure */
 	/* does the map already exist? */
-	i = 0;
-	done = FALSE;
-	while((i < HANDLE_MAP_SIZE)&&(done == FALSE))
-	{
-		if((*env)->IsSameObject(env,Handle_Map_List[i].CCDLibrary_Instance_Handle,instance))
-			done = TRUE;
-		else
-			i++;
-	}
-	if(done == TRUE)/* found an existing interface handle for this CCDLIbrary instance */
+	if(CCDLibrary_Handle_Map_Index_Get(env,instance,&old_interface_handle,&i))
 	{
 		/* update handle */
 		Handle_Map_List[i].Interface_Handle = interface_handle;
@@ -1989,7 +3680,7 @@ static int CCDLibrary_Handle_Map_Add(JNIEnv *env,jobject instance,CCD_Interface_
 		done = FALSE;
 		while((i < HANDLE_MAP_SIZE)&&(done == FALSE))
 		{
-			if(Handle_Map_List[i].CCDLibrary_Instance_Handle == NULL)
+			if(Handle_Map_List[i].Interface_Handle == NULL)
 				done = TRUE;
 			else
 				i++;
@@ -2000,48 +3691,37 @@ static int CCDLibrary_Handle_Map_Add(JNIEnv *env,jobject instance,CCD_Interface_
 							  "No empty slots in handle map.");
 			return FALSE;
 		}
-		/* index i is free, add handle map here */
-		global_instance = (*env)->NewGlobalRef(env,instance);
-		if(global_instance == NULL)
-		{
-			CCDLibrary_Throw_Exception_String(env,instance,"CCDLibrary_Handle_Map_Add",
-							  "Failed to create Global reference of instance.");
-			return FALSE;
-		}
-		fprintf(stdout,"CCDLibrary_Handle_Map_Add:Adding instance %p with handle %p at map index %d.\n",
-			(void*)global_instance,(void*)interface_handle,i);
-		Handle_Map_List[i].CCDLibrary_Instance_Handle = global_instance;
+		/* index i is free, add handle map here, with a new generation number that encodes the index */
+		Handle_Map_Add_Count++;
+		Handle_Map_List[i].Generation = (Handle_Map_Add_Count*HANDLE_MAP_SIZE)+i;
 		Handle_Map_List[i].Interface_Handle = interface_handle;
+#if LOGGING > 4
+		CCD_Global_Log_Format(LOG_VERBOSITY_VERBOSE,"CCDLibrary_Handle_Map_Add:"
+				      "Adding handle %p at map index %d with generation %d.",
+				      (void*)interface_handle,i,Handle_Map_List[i].Generation);
+#endif
 	}
+	(*env)->SetIntField(env,instance,handle_generation_field_id,Handle_Map_List[i].Generation);
 	return TRUE;
 }
 
 /**
- * Routine to delete a mapping from the CCDLibrary instance instance to the opened CCD Interface Handle
- * interface_handle, in the Handle_Map_List.
+ * Routine to delete the mapping from the CCDLibrary instance instance to it's opened CCD Interface Handle.
+ * The map entry is freed, and the instance's nativeHandleGeneration field is cleared.
  * @param instance The CCDLibrary instance to remove from the list.
- * @return The routine returns TRUE if the map is deleted (or updated), FALSE if the mapping could not be found
- *         in the mapping list.
+ * @return The routine returns TRUE if the map is deleted, FALSE if the instance does not have a valid handle.
  *         CCDLibrary_Throw_Exception_String is used to throw a Java exception if the routine returns FALSE.
  * @see #HANDLE_MAP_SIZE
  * @see #Handle_Map_List
+ * @see #CCDLibrary_Handle_Map_Index_Get
  * @see #CCDLibrary_Throw_Exception_String
  */
 static int CCDLibrary_Handle_Map_Delete(JNIEnv *env,jobject instance)
 {
-	int i,done;
+	CCD_Interface_Handle_T* interface_handle = NULL;
+	int i;
 
-  	/* does the map already exist? */
-	i = 0;
-	done = FALSE;
-	while((i < HANDLE_MAP_SIZE)&&(done == FALSE))
-	{
-		if((*env)->IsSameObject(env,Handle_Map_List[i].CCDLibrary_Instance_Handle,instance))
-			done = TRUE;
-		else
-			i++;
-	}
-	if(done == FALSE)
+	if(!CCDLibrary_Handle_Map_Index_Get(env,instance,&interface_handle,&i))
 	{
 		CCDLibrary_Throw_Exception_String(env,instance,"CCDLibrary_Handle_Map_Delete",
 						  "Failed to find CCDLibrary instance in handle map.");
@@ -2049,30 +3729,33 @@ static int CCDLibrary_Handle_Map_Delete(JNIEnv *env,jobject instance)
 	}
 	/* found an existing interface handle for this CCDLIbrary instance at index i */
 	/* delete this map at index i */
-	fprintf(stdout,"CCDLibrary_Handle_Map_Delete:Deleting instance %p with handle %p at map index %d.\n",
-		(void*)Handle_Map_List[i].CCDLibrary_Instance_Handle,(void*)Handle_Map_List[i].Interface_Handle,i);
-	(*env)->DeleteGlobalRef(env,Handle_Map_List[i].CCDLibrary_Instance_Handle);
-	Handle_Map_List[i].CCDLibrary_Instance_Handle = NULL;
+#if LOGGING > 4
+	CCD_Global_Log_Format(LOG_VERBOSITY_VERBOSE,"CCDLibrary_Handle_Map_Delete:"
+			      "Deleting handle %p at map index %d with generation %d.",
+			      (void*)Handle_Map_List[i].Interface_Handle,i,Handle_Map_List[i].Generation);
+#endif
 	Handle_Map_List[i].Interface_Handle = NULL;
+	Handle_Map_List[i].Generation = 0;
+	(*env)->SetIntField(env,instance,handle_generation_field_id,(jint)0);
 	return TRUE;
 }
 
 /**
- * Routine to find a mapping from the CCDLibrary instance instance to the opened CCD Interface Handle
- * interface_handle, in the Handle_Map_List.
+ * Routine to find the opened CCD Interface Handle of the CCDLibrary instance instance.
+ * This is called by almost every JNI routine, so the handle is found in Handle_Map_List using the
+ * generation number in the instance's nativeHandleGeneration field, without searching.
  * @param instance The CCDLibrary instance.
  * @param interface_handle The address of an interface handle, to fill with the interface handle for
  *        this CCDLibrary instance, if one is successfully found.
  * @return The routine returns TRUE if the mapping is found and returned,, FALSE if there was no mapping
  *         for this CCDLibrary instance, or the interface_handle pointer was NULL.
  *         CCDLibrary_Throw_Exception_String is used to throw a Java exception if the routine returns FALSE.
- * @see #HANDLE_MAP_SIZE
- * @see #Handle_Map_List
+ * @see #CCDLibrary_Handle_Map_Index_Get
  * @see #CCDLibrary_Throw_Exception_String
  */
 static int CCDLibrary_Handle_Map_Find(JNIEnv *env,jobject instance,CCD_Interface_Handle_T** interface_handle)
 {
-	int i,done;
+	int i;
 
 	if(interface_handle == NULL)
 	{
@@ -2080,26 +3763,239 @@ static int CCDLibrary_Handle_Map_Find(JNIEnv *env,jobject instance,CCD_Interface
 						  "interface handle was NULL.");
 		return FALSE;
 	}
-	i = 0;
-	done = FALSE;
-	while((i < HANDLE_MAP_SIZE)&&(done == FALSE))
-	{
-		if((*env)->IsSameObject(env,Handle_Map_List[i].CCDLibrary_Instance_Handle,instance))
-			done = TRUE;
-		else
-			i++;
-	}
-	if(done == FALSE)
+	if(!CCDLibrary_Handle_Map_Index_Get(env,instance,interface_handle,&i))
 	{
-		fprintf(stdout,"CCDLibrary_Handle_Map_Find:Failed to find instance %p.\n",(void*)instance);
 		CCDLibrary_Throw_Exception_String(env,instance,"CCDLibrary_Handle_Map_Find",
 						  "CCDLibrary instance handle was not found.");
 		return FALSE;
 	}
+	return TRUE;
+}
+
+/**
+ * Routine to get and validate the CCD Interface Handle stored in the CCDLibrary instance instance.
+ * Only the nativeHandleGeneration field is read (one JNI call). The generation gives the index in
+ * Handle_Map_List, and the handle is valid if that entry is in use and has the same generation.
+ * No exception is thrown.
+ * @param instance The CCDLibrary instance.
+ * @param interface_handle The address of an interface handle, filled with the instance's handle if it is valid.
+ * @param index The address of an integer, filled with the handle's index in Handle_Map_List if it is valid.
+ * @return The routine returns TRUE if the instance has a valid handle, and FALSE if it does not (it has not
+ *         been opened, has been closed, or the field IDs have not been retrieved yet).
+ * @see #HANDLE_MAP_SIZE
+ * @see #Handle_Map_List
+ * @see #handle_generation_field_id
+ */
+static int CCDLibrary_Handle_Map_Index_Get(JNIEnv *env,jobject instance,CCD_Interface_Handle_T** interface_handle,
+					   int *index)
+{
+	jint generation;
+	int i;
+
+	if(handle_generation_field_id == NULL)
+		return FALSE;
+	generation = (*env)->GetIntField(env,instance,handle_generation_field_id);
+	if(generation <= 0)
+		return FALSE;
+	i = generation%HANDLE_MAP_SIZE;
+	if((Handle_Map_List[i].Generation != generation)||(Handle_Map_List[i].Interface_Handle == NULL))
+		return FALSE;
 	(*interface_handle) = Handle_Map_List[i].Interface_Handle;
+	(*index) = i;
+	return TRUE;
+}
+
+/**
+ * Routine to get and cache the field ID of CCDLibrary's nativeHandleGeneration field,
+ * if it has not already been retrieved.
+ * @param instance The CCDLibrary instance.
+ * @return The routine returns TRUE if the field ID is available, and FALSE if it could not be
+ *         retrieved (and an exception has been thrown).
+ * @see #handle_generation_field_id
+ */
+static int CCDLibrary_Handle_Field_ID_Get(JNIEnv *env,jobject instance)
+{
+	jclass cls = NULL;
+
+	if(handle_generation_field_id != NULL)
+		return TRUE;
+	cls = (*env)->GetObjectClass(env,instance);
+	handle_generation_field_id = (*env)->GetFieldID(env,cls,"nativeHandleGeneration","I");
+	if(handle_generation_field_id == NULL)
+	{
+		/* One of the following exceptions has been thrown:
+		** NoSuchFieldError, ExceptionInInitializerError, OutOfMemoryError */
+		return FALSE;
+	}
+	return TRUE;
+}
+
+/**
+ * Routine to get and cache the field IDs of the CCDLibraryStatus fields in Status_Field_List,
+ * if they have not already been retrieved.
+ * @param status_instance A CCDLibraryStatus instance.
+ * @return The routine returns TRUE if the field IDs are available, and FALSE if they could not be
+ *         retrieved (and an exception has been thrown).
+ * @see #Status_Field_List
+ * @see #STATUS_FIELD_COUNT
+ */
+static int CCDLibrary_Status_Field_ID_Get(JNIEnv *env,jobject status_instance)
+{
+	jclass cls = NULL;
+	int i;
+
+	if(Status_Field_List[STATUS_FIELD_COUNT-1].Field_ID != NULL)
+		return TRUE;
+	cls = (*env)->GetObjectClass(env,status_instance);
+	for(i = 0; i < STATUS_FIELD_COUNT; i++)
+	{
+		Status_Field_List[i].Field_ID = (*env)->GetFieldID(env,cls,Status_Field_List[i].Name,
+								   Status_Field_List[i].Signature);
+		if(Status_Field_List[i].Field_ID == NULL)
+		{
+			/* One of the following exceptions has been thrown:
+			** NoSuchFieldError, ExceptionInInitializerError, OutOfMemoryError */
+			return FALSE;
+		}
+	}
 	return TRUE;
 }
 
+/**
+ * Routine to create a CCDLibraryFrame instance viewing some pixel data in native memory. The pixel data of a
+ * de-interlaced frame is wrapped in a direct ByteBuffer using NewDirectByteBuffer, so it is not copied.
+ * The pixel data of a raw frame is copied with CCDLibrary_Raw_Buffer_Copy, as the raw readout buffer can be
+ * unmapped whilst the Java layer still holds the frame.
+ * @param env The JNI environment pointer.
+ * @param pixel_data The pixel data (not used for a raw frame).
+ * @param pixel_count The number of pixels in pixel_data.
+ * @param sequence The frame's sequence number.
+ * @param ncols The number of columns in the frame.
+ * @param nrows The number of rows in the frame.
+ * @param x_bin The serial binning.
+ * @param y_bin The parallel binning.
+ * @param window_number The window number (0 for a full frame).
+ * @param raw A boolean, whether the pixel data is the raw readout buffer.
+ * @return A new instance of CCDLibraryFrame, or NULL if an error occurs (and a Java exception has been thrown).
+ * @see ccd_global.html#CCD_GLOBAL_BYTES_PER_PIXEL
+ * @see #CCDLibrary_Raw_Buffer_Copy
+ */
+static jobject CCDLibrary_Frame_Create(JNIEnv *env,unsigned short *pixel_data,size_t pixel_count,
+				       unsigned int sequence,int ncols,int nrows,int x_bin,int y_bin,int window_number,
+				       int raw)
+{
+	jclass cls;
+	jmethodID mid;
+	jobject buffer,frameInstance;
+
+/* copy the raw readout buffer, it may be unmapped whilst the frame is still in use */
+	if(raw)
+	{
+		buffer = CCDLibrary_Raw_Buffer_Copy(env,sequence,pixel_count);
+		if(buffer == NULL)
+			return NULL; /* CCDLibrary_Raw_Buffer_Copy throws an exception on failure */
+	}
+/* wrap the pixels in a direct ByteBuffer, without copying them */
+	else
+		buffer = (*env)->NewDirectByteBuffer(env,(void*)pixel_data,
+						     (jlong)(pixel_count*CCD_GLOBAL_BYTES_PER_PIXEL));
+	/* if the buffer is null, the JVM does not support JNI access to direct buffers,
+	** or an OutOfMemoryError has been thrown */
+	if(buffer == NULL)
+	{
+		if(!(*env)->ExceptionCheck(env))
+		{
+			CCDLibrary_Throw_Exception_String(env,NULL,"CCDLibrary_Frame_Create",
+							  "NewDirectByteBuffer failed.");
+		}
+		return NULL;
+	}
+/* get the class of CCDLibraryFrame */
+	cls = (*env)->FindClass(env,"ngat/o/ccd/CCDLibraryFrame");
+	/* if the class is null, one of the following exceptions occured:
+	** ClassFormatError,ClassCircularityError,NoClassDefFoundError,OutOfMemoryError */
+	if(cls == NULL)
+		return NULL;
+/* get CCDLibraryFrame constructor */
+	mid = (*env)->GetMethodID(env,cls,"<init>","(Ljava/nio/ByteBuffer;IIIIIIZ)V");
+	if(mid == 0)
+	{
+		/* One of the following exceptions has been thrown:
+		** NoSuchMethodError, ExceptionInInitializerError, OutOfMemoryError */
+		return NULL;
+	}
+/* call constructor */
+	frameInstance = (*env)->NewObject(env,cls,mid,buffer,(jint)sequence,(jint)ncols,(jint)nrows,(jint)x_bin,
+					  (jint)y_bin,(jint)window_number,(jboolean)raw);
+	if(frameInstance == NULL)
+	{
+		/* One of the following exceptions has been thrown:
+		** InstantiationException, OutOfMemoryError */
+		return NULL;
+	}
+	return frameInstance;
+}
+
+/**
+ * Routine to copy the raw readout buffer into a new Java byte array, and wrap it in a (heap) ByteBuffer.
+ * The copy is made by CCD_Frame_View_Raw_Copy, which holds the frame view mutex, so the raw readout buffer
+ * cannot be invalidated and unmapped whilst it is being copied, and fails if it has been invalidated or
+ * overwritten since the raw sequence number was retrieved.
+ * @param env The JNI environment pointer.
+ * @param sequence The raw sequence number, returned by CCD_Frame_View_Raw_Get.
+ * @param pixel_count The number of pixels to copy.
+ * @return A new ByteBuffer, or NULL if an error occurs (and a Java exception has been thrown).
+ * @see #CCDLibrary_Throw_Exception
+ * @see #CCDLibrary_Throw_Exception_String
+ * @see ccd_frame_view.html#CCD_Frame_View_Raw_Copy
+ * @see ccd_global.html#CCD_GLOBAL_BYTES_PER_PIXEL
+ */
+static jobject CCDLibrary_Raw_Buffer_Copy(JNIEnv *env,unsigned int sequence,size_t pixel_count)
+{
+	jclass cls;
+	jmethodID mid;
+	jbyteArray byte_array;
+	jbyte *array_data = NULL;
+	size_t byte_count;
+	int retval;
+
+	byte_count = pixel_count*CCD_GLOBAL_BYTES_PER_PIXEL;
+	if(byte_count > (size_t)INT32_MAX)
+	{
+		CCDLibrary_Throw_Exception_String(env,NULL,"CCDLibrary_Raw_Buffer_Copy",
+						  "Raw readout buffer too large to copy into a Java array.");
+		return NULL;
+	}
+	byte_array = (*env)->NewByteArray(env,(jsize)byte_count);
+	if(byte_array == NULL)
+		return NULL; /* an OutOfMemoryError has been thrown */
+	/* no JNI calls can be made until the array is released, CCD_Frame_View_Raw_Copy just copies memory */
+	array_data = (*env)->GetPrimitiveArrayCritical(env,byte_array,NULL);
+	if(array_data == NULL)
+		return NULL; /* an OutOfMemoryError has been thrown */
+	retval = CCD_Frame_View_Raw_Copy(sequence,(unsigned short *)array_data,pixel_count);
+	(*env)->ReleasePrimitiveArrayCritical(env,byte_array,array_data,0);
+	if(retval == FALSE)
+	{
+		CCDLibrary_Throw_Exception(env,NULL,"CCD_Frame_View_Raw_Copy");
+		return NULL;
+	}
+/* wrap the copy in a ByteBuffer with ByteBuffer.wrap */
+	cls = (*env)->FindClass(env,"java/nio/ByteBuffer");
+	/* if the class is null, one of the following exceptions occured:
+	** ClassFormatError,ClassCircularityError,NoClassDefFoundError,OutOfMemoryError */
+	if(cls == NULL)
+		return NULL;
+	mid = (*env)->GetStaticMethodID(env,cls,"wrap","([B)Ljava/nio/ByteBuffer;");
+	if(mid == 0)
+	{
+		/* One of the following exceptions has been thrown:
+		** NoSuchMethodError, ExceptionInInitializerError, OutOfMemoryError */
+		return NULL;
+	}
+	return (*env)->CallStaticObjectMethod(env,cls,mid,byte_array);
+}
+
 /*
 ** $Log: not supported by cvs2svn $
 ** Revision 1.3  2013/01/25 14:21:08  cjm
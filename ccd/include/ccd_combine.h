@@ -0,0 +1,75 @@
+/* ccd_combine.h
+** $Header$
+*/
+#ifndef CCD_COMBINE_H
+#define CCD_COMBINE_H
+
+/**
+ * Combine method: The master frame is the mean of the frames.
+ * @see #CCD_Combine_Set_Config
+ */
+#define CCD_COMBINE_METHOD_MEAN			(0)
+/**
+ * Combine method: The master frame is the sigma clipped mean of the frames.
+ * @see #CCD_Combine_Set_Config
+ */
+#define CCD_COMBINE_METHOD_CLIPPED_MEAN		(1)
+/**
+ * Combine method: The master frame is the median of the frames.
+ * @see #CCD_Combine_Set_Config
+ */
+#define CCD_COMBINE_METHOD_MEDIAN		(2)
+/**
+ * Macro to check whether the parameter is a legal combine method.
+ * @see #CCD_COMBINE_METHOD_MEAN
+ * @see #CCD_COMBINE_METHOD_CLIPPED_MEAN
+ * @see #CCD_COMBINE_METHOD_MEDIAN
+ */
+#define CCD_COMBINE_IS_METHOD(method)	(((method) == CCD_COMBINE_METHOD_MEAN)|| \
+	((method) == CCD_COMBINE_METHOD_CLIPPED_MEAN)||((method) == CCD_COMBINE_METHOD_MEDIAN))
+/**
+ * The default number of standard deviations from the mean a pixel value must be to be rejected,
+ * when using CCD_COMBINE_METHOD_CLIPPED_MEAN.
+ * @see #CCD_Combine_Set_Config
+ */
+#define CCD_COMBINE_DEFAULT_CLIP_SIGMA		(3.0)
+/**
+ * The default number of threads (row bands) each frame is split into.
+ * @see #CCD_Combine_Set_Config
+ */
+#define CCD_COMBINE_DEFAULT_THREAD_COUNT	(4)
+/**
+ * The maximum number of threads (row bands) each frame can be split into.
+ * @see #CCD_Combine_Set_Config
+ */
+#define CCD_COMBINE_MAX_THREAD_COUNT		(16)
+/**
+ * The default amount of memory, in megabytes, that can be used to keep copies of the frames
+ * for the median/clipped mean combine methods.
+ * @see #CCD_Combine_Set_Config
+ */
+#define CCD_COMBINE_DEFAULT_MEMORY_LIMIT	(1024)
+/**
+ * The maximum number of frames kept in memory for the median/clipped mean combine methods.
+ * If more frames than this (or than fit in the memory limit) are read out, the master frame is the mean.
+ */
+#define CCD_COMBINE_MAX_STACK_FRAME_COUNT	(64)
+
+extern int CCD_Combine_Initialise(void);
+extern int CCD_Combine_Set_Config(int method,double clip_sigma,int thread_count,int memory_limit);
+extern int CCD_Combine_Start(void);
+extern int CCD_Combine_Is_Active(void);
+extern int CCD_Combine_Add(unsigned short *image_data,int ncols,int nrows);
+extern int CCD_Combine_Post_Readout(unsigned short *image_data,int ncols,int nrows);
+extern int CCD_Combine_Get_Frame_Count(void);
+extern int CCD_Combine_Save(char *filename);
+extern int CCD_Combine_Abort(void);
+
+extern int CCD_Combine_Get_Error_Number(void);
+extern void CCD_Combine_Error(void);
+extern void CCD_Combine_Error_String(char *error_string);
+
+/*
+** $Log: not supported by cvs2svn $
+*/
+#endif
@@ -0,0 +1,48 @@
+/* ccd_compress.h
+** $Header$
+*/
+#ifndef CCD_COMPRESS_H
+#define CCD_COMPRESS_H
+
+/**
+ * Compression type: Images are saved uncompressed (the default).
+ * @see #CCD_Compress_Set_Config
+ */
+#define CCD_COMPRESS_TYPE_NONE			(0)
+/**
+ * Compression type: Images are saved as lossless Rice tile-compressed images (FITS tiled image
+ * compression convention, ZCMPTYPE = 'RICE_1').
+ * @see #CCD_Compress_Set_Config
+ */
+#define CCD_COMPRESS_TYPE_RICE			(1)
+/**
+ * Macro to check whether the parameter is a legal compression type.
+ * @see #CCD_COMPRESS_TYPE_NONE
+ * @see #CCD_COMPRESS_TYPE_RICE
+ */
+#define CCD_COMPRESS_IS_TYPE(type)		(((type) == CCD_COMPRESS_TYPE_NONE)|| \
+						 ((type) == CCD_COMPRESS_TYPE_RICE))
+/**
+ * The default number of threads the tiles of each image are compressed by.
+ * @see #CCD_Compress_Set_Config
+ */
+#define CCD_COMPRESS_DEFAULT_THREAD_COUNT	(4)
+/**
+ * The maximum number of threads the tiles of each image can be compressed by.
+ * @see #CCD_Compress_Set_Config
+ */
+#define CCD_COMPRESS_MAX_THREAD_COUNT		(16)
+
+extern int CCD_Compress_Initialise(void);
+extern int CCD_Compress_Set_Config(int type,int thread_count);
+extern int CCD_Compress_Get_Type(void);
+extern int CCD_Compress_Save(char *filename,unsigned short *exposure_data_list[],int exposure_data_count,
+			     int ncols,int nrows);
+extern int CCD_Compress_Get_Error_Number(void);
+extern void CCD_Compress_Error(void);
+extern void CCD_Compress_Error_String(char *error_string);
+
+/*
+** $Log: not supported by cvs2svn $
+*/
+#endif
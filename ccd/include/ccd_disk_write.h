@@ -0,0 +1,50 @@
+/* ccd_disk_write.h
+** $Header$
+*/
+#ifndef CCD_DISK_WRITE_H
+#define CCD_DISK_WRITE_H
+
+/**
+ * Fsync policy: The image data is not synchronised to disc when the file is closed. With O_DIRECT the data
+ * has already bypassed the page cache, but the file's metadata (size and allocation) may not be on disc yet.
+ * @see #CCD_Disk_Write_Set_Config
+ */
+#define CCD_DISK_WRITE_FSYNC_NONE		(0)
+/**
+ * Fsync policy: fdatasync is called on each file before it is closed, so the data and file size are on disc.
+ * @see #CCD_Disk_Write_Set_Config
+ */
+#define CCD_DISK_WRITE_FSYNC_DATA		(1)
+/**
+ * Fsync policy: fsync is called on each file before it is closed, so the data and all metadata are on disc.
+ * @see #CCD_Disk_Write_Set_Config
+ */
+#define CCD_DISK_WRITE_FSYNC_FULL		(2)
+/**
+ * Macro to check whether the parameter is a legal fsync policy.
+ * @see #CCD_DISK_WRITE_FSYNC_NONE
+ * @see #CCD_DISK_WRITE_FSYNC_DATA
+ * @see #CCD_DISK_WRITE_FSYNC_FULL
+ */
+#define CCD_DISK_WRITE_IS_FSYNC(policy)		(((policy) == CCD_DISK_WRITE_FSYNC_NONE)|| \
+						 ((policy) == CCD_DISK_WRITE_FSYNC_DATA)|| \
+						 ((policy) == CCD_DISK_WRITE_FSYNC_FULL))
+/**
+ * The number of most recent per-frame write latencies kept to compute percentiles from.
+ * @see #CCD_Disk_Write_Latency_Get
+ */
+#define CCD_DISK_WRITE_LATENCY_SAMPLE_COUNT	(256)
+
+extern int CCD_Disk_Write_Initialise(void);
+extern int CCD_Disk_Write_Set_Config(int enable,int fsync_policy);
+extern int CCD_Disk_Write_Get_Enable(void);
+extern int CCD_Disk_Write_Save(char *filename,long long data_offset,unsigned short *image_data,int ncols,int nrows);
+extern int CCD_Disk_Write_Latency_Get(double percentile,double *latency,int *sample_count);
+extern int CCD_Disk_Write_Get_Error_Number(void);
+extern void CCD_Disk_Write_Error(void);
+extern void CCD_Disk_Write_Error_String(char *error_string);
+
+/*
+** $Log: not supported by cvs2svn $
+*/
+#endif
@@ -343,6 +343,13 @@ enum CCD_DSP_AMPLIFIER
 #define CCD_DSP_CONTROLLER_CONFIG_BIT_BOTH_READOUTS		(0x3000)
 #define CCD_DSP_CONTROLLER_CONFIG_BIT_MPP_CAPABLE		(0x4000)
 
+/**
+ * The number of abort latencies (the time from an abort being requested to the aborted operation returning)
+ * kept, and used to compute the abort latency percentiles.
+ * @see #CCD_DSP_Abort_Latency_Get
+ */
+#define CCD_DSP_ABORT_LATENCY_SAMPLE_COUNT			(100)
+
 extern int CCD_DSP_Initialise(void);
 /* Boot commands */
 extern int CCD_DSP_Command_LDA(CCD_Interface_Handle_T* handle,enum CCD_DSP_BOARD_ID board_id,int application_number);
@@ -391,6 +398,9 @@ extern char *CCD_DSP_Print_Mem_Space(enum CCD_DSP_MEM_SPACE mem_space);
 
 extern int CCD_DSP_Get_Abort(void);
 extern int CCD_DSP_Set_Abort(int value);
+extern int CCD_DSP_Abort_Sleep(struct timespec sleep_time);
+extern void CCD_DSP_Abort_Complete(void);
+extern int CCD_DSP_Abort_Latency_Get(double percentile,double *latency,int *sample_count);
 extern int CCD_DSP_Get_Error_Number(void);
 extern void CCD_DSP_Error(void);
 extern void CCD_DSP_Error_String(char *error_string);
@@ -68,6 +68,12 @@ enum CCD_EXPOSURE_STATUS
 	((status) == CCD_EXPOSURE_STATUS_CLEAR)||((status) == CCD_EXPOSURE_STATUS_EXPOSE)|| \
         ((status) == CCD_EXPOSURE_STATUS_READOUT)||((status) == CCD_EXPOSURE_STATUS_POST_READOUT))
 
+/**
+ * The number of timed exposure start errors kept, and used to compute the start error percentiles.
+ * @see #CCD_Exposure_Start_Error_Percentile_Get
+ */
+#define CCD_EXPOSURE_START_ERROR_SAMPLE_COUNT	(100)
+
 extern void CCD_Exposure_Initialise(void);
 extern void CCD_Exposure_Data_Initialise(CCD_Interface_Handle_T* handle);
 extern int CCD_Exposure_Expose(CCD_Interface_Handle_T* handle,int clear_array,int open_shutter,
@@ -103,6 +109,12 @@ extern void CCD_Exposure_Shutter_Close_Delay_Set(int delay_ms);
 extern int CCD_Exposure_Shutter_Close_Delay_Get(void);
 extern void CCD_Exposure_Readout_Delay_Set(int delay_ms);
 extern int CCD_Exposure_Readout_Delay_Get(void);
+extern int CCD_Exposure_Start_Approach_Set(int approach_ms,int increase_priority);
+extern int CCD_Exposure_Start_Approach_Time_Get(void);
+extern int CCD_Exposure_Start_Approach_Priority_Get(void);
+extern void CCD_Exposure_Set_Start_Error(CCD_Interface_Handle_T* handle,double start_error);
+extern int CCD_Exposure_Get_Start_Error(CCD_Interface_Handle_T* handle,double *start_error);
+extern int CCD_Exposure_Start_Error_Percentile_Get(double percentile,double *start_error,int *sample_count);
 
 extern int CCD_Exposure_Get_Error_Number(void);
 extern void CCD_Exposure_Error(void);
@@ -0,0 +1,71 @@
+/* ccd_exposure_event.h
+** $Header$
+*/
+#ifndef CCD_EXPOSURE_EVENT_H
+#define CCD_EXPOSURE_EVENT_H
+#include <time.h>
+#include "ccd_exposure.h" /* enum CCD_EXPOSURE_STATUS declaration */
+
+/* These #define/enum definitions should match with those in CCDLibraryExposureEvent.java */
+/**
+ * The number of events the exposure event queue can hold. If the queue is full when an event is posted,
+ * the oldest event is dropped.
+ */
+#define CCD_EXPOSURE_EVENT_QUEUE_LENGTH		(64)
+
+/**
+ * The type of an exposure event.
+ * <ul>
+ * <li>CCD_EXPOSURE_EVENT_TYPE_PHASE means the exposure status has changed.
+ * <li>CCD_EXPOSURE_EVENT_TYPE_READOUT_PROGRESS means more pixels have been read out. Consecutive readout progress
+ *     events are merged in the queue, so only the latest progress is delivered.
+ * <li>CCD_EXPOSURE_EVENT_TYPE_COMPLETE means an asynchronous exposure has finished.
+ * </ul>
+ * @see ../../javadocs/ngat/o/ccd/CCDLibraryExposureEvent.html#TYPE_PHASE
+ * @see ../../javadocs/ngat/o/ccd/CCDLibraryExposureEvent.html#TYPE_READOUT_PROGRESS
+ * @see ../../javadocs/ngat/o/ccd/CCDLibraryExposureEvent.html#TYPE_COMPLETE
+ */
+enum CCD_EXPOSURE_EVENT_TYPE
+{
+	CCD_EXPOSURE_EVENT_TYPE_PHASE=0,CCD_EXPOSURE_EVENT_TYPE_READOUT_PROGRESS=1,
+	CCD_EXPOSURE_EVENT_TYPE_COMPLETE=2
+};
+
+/**
+ * Structure holding one exposure event.
+ * <dl>
+ * <dt>Type</dt> <dd>The type of event.</dd>
+ * <dt>Time_Stamp</dt> <dd>When the event was posted.</dd>
+ * <dt>Exposure_Status</dt> <dd>The exposure status after the event.</dd>
+ * <dt>Pixel_Count</dt> <dd>For readout progress events, the number of pixels read out so far.</dd>
+ * <dt>Expected_Pixel_Count</dt> <dd>For readout progress events, the number of pixels in the readout.</dd>
+ * <dt>Id</dt> <dd>For complete events, the identifier of the asynchronous exposure that has finished.</dd>
+ * </dl>
+ * @see #CCD_EXPOSURE_EVENT_TYPE
+ */
+struct CCD_Exposure_Event_Struct
+{
+	enum CCD_EXPOSURE_EVENT_TYPE Type;
+	struct timespec Time_Stamp;
+	enum CCD_EXPOSURE_STATUS Exposure_Status;
+	int Pixel_Count;
+	int Expected_Pixel_Count;
+	int Id;
+};
+
+extern int CCD_Exposure_Event_Initialise(void);
+extern void CCD_Exposure_Event_Post_Phase(enum CCD_EXPOSURE_STATUS exposure_status);
+extern void CCD_Exposure_Event_Post_Readout_Progress(int pixel_count,int expected_pixel_count);
+extern void CCD_Exposure_Event_Post_Complete(int id);
+extern int CCD_Exposure_Event_Wait(int timeout_ms,struct CCD_Exposure_Event_Struct *event_list,int max_event_count,
+				   int *event_count);
+extern void CCD_Exposure_Event_Flush(void);
+extern int CCD_Exposure_Event_Get_Dropped_Count(void);
+extern int CCD_Exposure_Event_Get_Error_Number(void);
+extern void CCD_Exposure_Event_Error(void);
+extern void CCD_Exposure_Event_Error_String(char *error_string);
+
+/*
+** $Log: not supported by cvs2svn $
+*/
+#endif
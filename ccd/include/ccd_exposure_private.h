@@ -16,6 +16,10 @@
  *     the SET command. This has the shutter trigger delay (STD) added, and the Shutter Close Delay SCD subtracted.
  *     See the shutter timing documentation for details.</dd>
  * <dt>Exposure_Start_Time</dt> <dd>The time stamp when the START_EXPOSURE command was sent to the controller.</dd>
+ * <dt>Start_Error_Valid</dt> <dd>A boolean, TRUE if the last exposure was a timed exposure, and Start_Error
+ *     is set.</dd>
+ * <dt>Start_Error</dt> <dd>For a timed exposure, the time the START_EXPOSURE command was sent less the time it
+ *     was due to be sent, in seconds.</dd>
  * </dl>
  * @see ccd_exposure.html#CCD_EXPOSURE_STATUS
  */
@@ -25,6 +29,8 @@ struct CCD_Exposure_Struct
 	int Exposure_Length;
 	int Modified_Exposure_Length;
 	struct timespec Exposure_Start_Time;
+	int Start_Error_Valid;
+	double Start_Error;
 };
 
 
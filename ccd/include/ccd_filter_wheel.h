@@ -32,6 +32,10 @@ extern int CCD_Filter_Wheel_Position_Count_Set(int position_count);
 extern int CCD_Filter_Wheel_Position_Count_Get(void);
 extern int CCD_Filter_Wheel_Reset(CCD_Interface_Handle_T* handle);
 extern int CCD_Filter_Wheel_Move(CCD_Interface_Handle_T* handle,int position);
+extern int CCD_Filter_Wheel_Move_Start(CCD_Interface_Handle_T* handle,int position);
+extern int CCD_Filter_Wheel_Move_Wait(void);
+extern int CCD_Filter_Wheel_Move_Offset_Get(int from_position,int to_position);
+extern int CCD_Filter_Wheel_Move_Time_Estimate(int from_position,int to_position,double *estimate_secs);
 /* CCD_Filter_Wheel_Move_Relative is external for engineering/test software only. See API. */
 extern int CCD_Filter_Wheel_Move_Relative(CCD_Interface_Handle_T* handle,int direction,int relative_position,
 					  int check_home);
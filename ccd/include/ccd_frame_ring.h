@@ -0,0 +1,125 @@
+/* ccd_frame_ring.h
+** $Header$
+*/
+#ifndef CCD_FRAME_RING_H
+#define CCD_FRAME_RING_H
+#include <time.h>
+
+/**
+ * The value of the Magic field of a frame ring header, "OFRG".
+ * @see #CCD_Frame_Ring_Header_Struct
+ */
+#define CCD_FRAME_RING_MAGIC			(0x4f465247)
+/**
+ * The version of the frame ring shared memory layout. This is incremented whenever the layout of
+ * CCD_Frame_Ring_Header_Struct or CCD_Frame_Ring_Slot_Struct changes.
+ * @see #CCD_Frame_Ring_Header_Struct
+ * @see #CCD_Frame_Ring_Slot_Struct
+ */
+#define CCD_FRAME_RING_VERSION			(1)
+/**
+ * The default POSIX shared memory object name of the frame ring.
+ */
+#define CCD_FRAME_RING_DEFAULT_NAME		("/o_frame_ring")
+/**
+ * The default number of slots (frames) in the frame ring.
+ */
+#define CCD_FRAME_RING_DEFAULT_SLOT_COUNT	(4)
+/**
+ * The default maximum number of pixels in a slot, enough for the largest unbinned full frame (4400x4112).
+ */
+#define CCD_FRAME_RING_DEFAULT_SLOT_PIXEL_COUNT	(4400*4112)
+/**
+ * The length of the Filename field in a slot.
+ * @see #CCD_Frame_Ring_Slot_Struct
+ */
+#define CCD_FRAME_RING_FILENAME_LENGTH		(256)
+
+/**
+ * Structure at the start of the frame ring shared memory object.
+ * <dl>
+ * <dt>Magic</dt> <dd>CCD_FRAME_RING_MAGIC.</dd>
+ * <dt>Version</dt> <dd>CCD_FRAME_RING_VERSION.</dd>
+ * <dt>Slot_Count</dt> <dd>The number of slots in the ring.</dd>
+ * <dt>Slot_Pixel_Count</dt> <dd>The maximum number of pixels in a slot.</dd>
+ * <dt>Slot_Offset</dt> <dd>The offset of the first slot from the start of the shared memory, in bytes.</dd>
+ * <dt>Slot_Length</dt> <dd>The length of each slot (slot header and pixel data), in bytes.</dd>
+ * <dt>Publish_Count</dt> <dd>The number of frames published. Frame number N (starting from 1) is in slot
+ *     (N-1) modulo Slot_Count. This is also the futex readers wait on for new frames.</dd>
+ * <dt>Pad</dt> <dd>Unused.</dd>
+ * </dl>
+ * @see #CCD_FRAME_RING_MAGIC
+ * @see #CCD_FRAME_RING_VERSION
+ */
+struct CCD_Frame_Ring_Header_Struct
+{
+	unsigned int Magic;
+	unsigned int Version;
+	unsigned int Slot_Count;
+	unsigned int Slot_Pixel_Count;
+	unsigned int Slot_Offset;
+	unsigned int Slot_Length;
+	volatile unsigned int Publish_Count;
+	unsigned int Pad;
+};
+
+/**
+ * Structure at the start of each slot in the frame ring. The pixel data follows it, at Data_Offset bytes
+ * from the start of the slot, NCols*NRows unsigned shorts, de-interlaced, in the same order as the FITS image.
+ * <dl>
+ * <dt>Sequence</dt> <dd>Incremented before and after the slot is written, so it is odd whilst the slot is being
+ *     written. A reader should check it is even and unchanged before and after using the slot.</dd>
+ * <dt>Frame_Number</dt> <dd>The frame number in the slot (Publish_Count after it was published).</dd>
+ * <dt>Data_Offset</dt> <dd>The offset of the pixel data from the start of the slot, in bytes.</dd>
+ * <dt>NCols</dt> <dd>The number of columns in the frame.</dd>
+ * <dt>NRows</dt> <dd>The number of rows in the frame.</dd>
+ * <dt>X_Bin</dt> <dd>The serial binning.</dd>
+ * <dt>Y_Bin</dt> <dd>The parallel binning.</dd>
+ * <dt>Window_Number</dt> <dd>0 for a full frame, or the window number (1..4) of a windowed frame.</dd>
+ * <dt>Exposure_Length</dt> <dd>The exposure length, in milliseconds.</dd>
+ * <dt>Start_Time_Sec</dt> <dd>The exposure start time, seconds since the epoch.</dd>
+ * <dt>Start_Time_Nsec</dt> <dd>The exposure start time, nanoseconds.</dd>
+ * <dt>Publish_Time_Sec</dt> <dd>When the frame was published, seconds since the epoch.</dd>
+ * <dt>Publish_Time_Nsec</dt> <dd>When the frame was published, nanoseconds.</dd>
+ * <dt>Filename</dt> <dd>The FITS filename the frame is being saved to. The file is only complete once
+ *     the O has removed it's lock file.</dd>
+ * </dl>
+ */
+struct CCD_Frame_Ring_Slot_Struct
+{
+	volatile unsigned int Sequence;
+	unsigned int Frame_Number;
+	unsigned int Data_Offset;
+	int NCols;
+	int NRows;
+	int X_Bin;
+	int Y_Bin;
+	int Window_Number;
+	int Exposure_Length;
+	int Start_Time_Sec;
+	int Start_Time_Nsec;
+	int Publish_Time_Sec;
+	int Publish_Time_Nsec;
+	char Filename[CCD_FRAME_RING_FILENAME_LENGTH];
+};
+
+extern int CCD_Frame_Ring_Initialise(void);
+extern int CCD_Frame_Ring_Open(char *name,int slot_count,int slot_pixel_count);
+extern int CCD_Frame_Ring_Close(void);
+extern int CCD_Frame_Ring_Is_Open(void);
+extern int CCD_Frame_Ring_Publish(unsigned short *image_data,int ncols,int nrows,int x_bin,int y_bin,
+				  int window_number,int exposure_length,struct timespec start_time,char *filename);
+extern int CCD_Frame_Ring_Attach(char *name);
+extern int CCD_Frame_Ring_Detach(void);
+extern int CCD_Frame_Ring_Wait(unsigned int last_frame_number,int timeout_ms,unsigned int *frame_number);
+extern int CCD_Frame_Ring_Slot_Get(unsigned int frame_number,struct CCD_Frame_Ring_Slot_Struct **slot,
+				   unsigned short **image_data,unsigned int *sequence);
+extern int CCD_Frame_Ring_Slot_Check(struct CCD_Frame_Ring_Slot_Struct *slot,unsigned int sequence);
+extern int CCD_Frame_Ring_Get_Error_Number(void);
+extern void CCD_Frame_Ring_Error(void);
+extern void CCD_Frame_Ring_Error_String(char *error_string);
+
+/*
+** $Log: not supported by cvs2svn $
+*/
+#endif
@@ -0,0 +1,35 @@
+/* ccd_frame_view.h
+** $Header$
+*/
+#ifndef CCD_FRAME_VIEW_H
+#define CCD_FRAME_VIEW_H
+#include <stddef.h>
+
+/**
+ * The maximum number of de-interlaced frames retained at once: the latest frame, plus older frames that are
+ * still acquired (have not been released).
+ * @see #CCD_Frame_View_Post_Readout
+ */
+#define CCD_FRAME_VIEW_MAX_FRAME_COUNT	(4)
+
+extern int CCD_Frame_View_Initialise(void);
+extern void CCD_Frame_View_Set_Enable(int enable);
+extern int CCD_Frame_View_Get_Enable(void);
+extern void CCD_Frame_View_Post_Readout(unsigned short **image_data,int ncols,int nrows,int x_bin,int y_bin,
+					int window_number);
+extern int CCD_Frame_View_Acquire(unsigned short **image_data,int *ncols,int *nrows,int *x_bin,int *y_bin,
+				  int *window_number,unsigned int *sequence);
+extern int CCD_Frame_View_Release(unsigned int sequence);
+extern void CCD_Frame_View_Raw_Set(unsigned short *raw_data,size_t pixel_count);
+extern void CCD_Frame_View_Raw_Invalidate(void);
+extern int CCD_Frame_View_Raw_Get(unsigned short **raw_data,size_t *pixel_count,unsigned int *sequence);
+extern int CCD_Frame_View_Raw_Copy(unsigned int sequence,unsigned short *buffer,size_t pixel_count);
+extern unsigned int CCD_Frame_View_Raw_Sequence_Get(void);
+extern int CCD_Frame_View_Get_Error_Number(void);
+extern void CCD_Frame_View_Error(void);
+extern void CCD_Frame_View_Error_String(char *error_string);
+
+/*
+** $Log: not supported by cvs2svn $
+*/
+#endif
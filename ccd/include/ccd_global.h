@@ -94,4 +94,9 @@ extern int CCD_Global_Memory_UnLock_All(void);
 extern void CCD_Global_Add_Time_Ms(struct timespec *time,int ms);
 extern void CCD_Global_Subtract_Time_Ms(struct timespec *time,int ms);
 
+/* percentiles of recent samples */
+extern int CCD_Global_Percentile_Index(double percentile,int count);
+extern double CCD_Global_Percentile(double *list,int count,double percentile);
+extern int CCD_Global_Double_Compare(const void *p1,const void *p2);
+
 #endif
@@ -0,0 +1,40 @@
+/* ccd_preview.h
+** $Header$
+*/
+#ifndef CCD_PREVIEW_H
+#define CCD_PREVIEW_H
+
+/**
+ * The maximum number of preview binning factors.
+ * @see #CCD_Preview_Set_Config
+ */
+#define CCD_PREVIEW_MAX_BIN_FACTOR_COUNT	(4)
+/**
+ * The maximum preview binning factor.
+ * @see #CCD_Preview_Set_Config
+ */
+#define CCD_PREVIEW_MAX_BIN_FACTOR		(256)
+/**
+ * The default percentile of preview pixels scaled to black (0).
+ * @see #CCD_Preview_Set_Config
+ */
+#define CCD_PREVIEW_DEFAULT_LOW_PERCENTILE	(0.5)
+/**
+ * The default percentile of preview pixels scaled to white (255).
+ * @see #CCD_Preview_Set_Config
+ */
+#define CCD_PREVIEW_DEFAULT_HIGH_PERCENTILE	(99.5)
+
+extern int CCD_Preview_Initialise(void);
+extern int CCD_Preview_Set_Config(int enable,char *directory,int *bin_factor_list,int bin_factor_count,
+				  double low_percentile,double high_percentile);
+extern int CCD_Preview_Get_Enable(void);
+extern int CCD_Preview_Post_Readout(char *filename,unsigned short *image_data,int ncols,int nrows);
+extern int CCD_Preview_Get_Error_Number(void);
+extern void CCD_Preview_Error(void);
+extern void CCD_Preview_Error_String(char *error_string);
+
+/*
+** $Log: not supported by cvs2svn $
+*/
+#endif
@@ -0,0 +1,106 @@
+/* ccd_readout_watchdog.h
+** $Header$
+*/
+#ifndef CCD_READOUT_WATCHDOG_H
+#define CCD_READOUT_WATCHDOG_H
+#include <time.h>
+
+/**
+ * The default time, in milliseconds, CCD_Exposure_Expose sleeps between readout progress polls
+ * once the readout is about to start.
+ * @see #CCD_Readout_Watchdog_Set_Config
+ */
+#define CCD_READOUT_WATCHDOG_DEFAULT_POLL_PERIOD_MS		(100)
+/**
+ * The default number of learnt progress intervals (the longest gap between readout progress changes seen
+ * for the readout setup) without progress before the readout is considered stalled.
+ * @see #CCD_Readout_Watchdog_Set_Config
+ */
+#define CCD_READOUT_WATCHDOG_DEFAULT_STALL_FACTOR		(4.0)
+/**
+ * The default shortest time without readout progress, in milliseconds, that is considered a stall for a
+ * readout setup that has been seen before.
+ * @see #CCD_Readout_Watchdog_Set_Config
+ */
+#define CCD_READOUT_WATCHDOG_DEFAULT_MIN_STALL_TIME_MS		(500)
+/**
+ * The default time without readout progress, in milliseconds, that is considered a stall for a readout
+ * setup that has not been seen before, or before the first pixel has been read out. This is the same as the
+ * old fixed readout timeout (five unchanged polls one second apart).
+ * @see #CCD_Readout_Watchdog_Set_Config
+ */
+#define CCD_READOUT_WATCHDOG_DEFAULT_UNKNOWN_STALL_TIME_MS	(5000)
+/**
+ * The default fraction of the learnt pixel rate below which a completed readout is recorded as slow.
+ * @see #CCD_Readout_Watchdog_Set_Config
+ */
+#define CCD_READOUT_WATCHDOG_DEFAULT_SLOW_RATIO			(0.5)
+/**
+ * The number of readout setups the watchdog keeps pixel rate history for. When more setups are used,
+ * the least recently used one is forgotten.
+ */
+#define CCD_READOUT_WATCHDOG_MAX_CONFIG_COUNT			(8)
+
+/**
+ * Anomaly type: no readout anomaly has been recorded.
+ * @see #CCD_Readout_Watchdog_Anomaly_Struct
+ */
+#define CCD_READOUT_WATCHDOG_ANOMALY_NONE	(0)
+/**
+ * Anomaly type: the readout completed, but at less than the slow ratio of the learnt pixel rate.
+ * @see #CCD_Readout_Watchdog_Anomaly_Struct
+ */
+#define CCD_READOUT_WATCHDOG_ANOMALY_SLOW	(1)
+/**
+ * Anomaly type: the readout made no progress for longer than the stall time, and was aborted.
+ * @see #CCD_Readout_Watchdog_Anomaly_Struct
+ */
+#define CCD_READOUT_WATCHDOG_ANOMALY_STALL	(2)
+
+/**
+ * Structure holding the last readout rate anomaly the watchdog recorded.
+ * <dl>
+ * <dt>Count</dt> <dd>The number of anomalies recorded since startup. This changes each time a new anomaly
+ *     is recorded.</dd>
+ * <dt>Time</dt> <dd>When the anomaly was recorded (CLOCK_REALTIME).</dd>
+ * <dt>Type</dt> <dd>The anomaly type, one of CCD_READOUT_WATCHDOG_ANOMALY_*.</dd>
+ * <dt>Pixel_Rate</dt> <dd>The pixel rate measured for the readout, in pixels per second, or 0.0 if
+ *     it was not measured.</dd>
+ * <dt>Expected_Pixel_Rate</dt> <dd>The pixel rate learnt for the readout setup, in pixels per second,
+ *     or 0.0 if the setup had not been seen before.</dd>
+ * <dt>Pixel_Count</dt> <dd>The number of pixels that had been read out.</dd>
+ * <dt>Expected_Pixel_Count</dt> <dd>The number of pixels that should have been read out.</dd>
+ * <dt>Stall_Time</dt> <dd>For a stall, how long the readout made no progress for, in seconds.</dd>
+ * </dl>
+ * @see #CCD_Readout_Watchdog_Anomaly_Get
+ */
+struct CCD_Readout_Watchdog_Anomaly_Struct
+{
+	unsigned int Count;
+	struct timespec Time;
+	int Type;
+	double Pixel_Rate;
+	double Expected_Pixel_Rate;
+	int Pixel_Count;
+	int Expected_Pixel_Count;
+	double Stall_Time;
+};
+
+extern int CCD_Readout_Watchdog_Initialise(void);
+extern int CCD_Readout_Watchdog_Set_Config(int poll_period_ms,double stall_factor,int min_stall_time_ms,
+					   int unknown_stall_time_ms,double slow_ratio);
+extern int CCD_Readout_Watchdog_Poll_Period_Get(void);
+extern void CCD_Readout_Watchdog_Start(int ncols,int nrows,int x_bin,int y_bin,int amplifier,int gain,
+				       int gain_speed,int window_flags,int expected_pixel_count);
+extern int CCD_Readout_Watchdog_Progress(int pixel_count);
+extern void CCD_Readout_Watchdog_End(void);
+extern int CCD_Readout_Watchdog_Anomaly_Get(struct CCD_Readout_Watchdog_Anomaly_Struct *anomaly);
+
+extern int CCD_Readout_Watchdog_Get_Error_Number(void);
+extern void CCD_Readout_Watchdog_Error(void);
+extern void CCD_Readout_Watchdog_Error_String(char *error_string);
+
+/*
+** $Log: not supported by cvs2svn $
+*/
+#endif
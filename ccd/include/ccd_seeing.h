@@ -0,0 +1,98 @@
+/* ccd_seeing.h
+** $Header$
+*/
+#ifndef CCD_SEEING_H
+#define CCD_SEEING_H
+
+/**
+ * The default number of background standard deviations above the background a pixel must be to be
+ * the peak of a candidate source.
+ * @see #CCD_Seeing_Set_Config
+ */
+#define CCD_SEEING_DEFAULT_THRESHOLD_SIGMA	(10.0)
+/**
+ * The default radius of the square cutout around each source that is measured, in binned pixels.
+ * @see #CCD_Seeing_Set_Config
+ */
+#define CCD_SEEING_DEFAULT_CUTOUT_RADIUS	(8)
+/**
+ * The maximum radius of the square cutout around each source that is measured, in binned pixels.
+ * @see #CCD_Seeing_Set_Config
+ */
+#define CCD_SEEING_MAX_CUTOUT_RADIUS		(32)
+/**
+ * The default pixel value at or above which a source's cutout is considered saturated, and the source
+ * is not measured.
+ * @see #CCD_Seeing_Set_Config
+ */
+#define CCD_SEEING_DEFAULT_SATURATION_COUNTS	(60000)
+/**
+ * The default maximum number of (the brightest isolated) sources measured in each frame.
+ * @see #CCD_Seeing_Set_Config
+ */
+#define CCD_SEEING_DEFAULT_MAX_SOURCE_COUNT	(100)
+/**
+ * The default number of threads the frame is split across.
+ * @see #CCD_Seeing_Set_Config
+ */
+#define CCD_SEEING_DEFAULT_THREAD_COUNT		(4)
+/**
+ * The maximum number of threads the frame can be split across.
+ * @see #CCD_Seeing_Set_Config
+ */
+#define CCD_SEEING_MAX_THREAD_COUNT		(16)
+
+/**
+ * Structure holding the results of running the seeing estimator on a frame. FWHMs are in binned pixels,
+ * the caller converts them to arcseconds using the plate scale. The FWHM of an elliptical source is the geometric
+ * mean of the FWHM along it's major and minor axes.
+ * <dl>
+ * <dt>NCols</dt> <dd>The number of binned columns in the frame.</dd>
+ * <dt>NRows</dt> <dd>The number of binned rows in the frame.</dd>
+ * <dt>Background</dt> <dd>The estimated background level, in counts.</dd>
+ * <dt>Background_Sigma</dt> <dd>The estimated standard deviation of the background, in counts.</dd>
+ * <dt>Candidate_Count</dt> <dd>The number of local maxima above the threshold found in the frame.</dd>
+ * <dt>Source_Count</dt> <dd>The number of unsaturated, isolated sources that were successfully measured.</dd>
+ * <dt>Fit_Count</dt> <dd>The number of measured sources whose 2D Gaussian fit converged. The other measured sources
+ *     use their moment-based FWHM and ellipticity.</dd>
+ * <dt>Moment_FWHM</dt> <dd>The median moment-based FWHM of the measured sources, in binned pixels.</dd>
+ * <dt>FWHM</dt> <dd>The median FWHM of the measured sources, in binned pixels.</dd>
+ * <dt>FWHM_Sigma</dt> <dd>The robust (median absolute deviation) standard deviation of the FWHMs,
+ *     in binned pixels.</dd>
+ * <dt>Ellipticity</dt> <dd>The median ellipticity (1 - minor/major axis) of the measured sources.</dd>
+ * <dt>Elapsed_Time</dt> <dd>How long the seeing estimator took to run, in seconds.</dd>
+ * </dl>
+ */
+struct CCD_Seeing_Result_Struct
+{
+	int NCols;
+	int NRows;
+	double Background;
+	double Background_Sigma;
+	int Candidate_Count;
+	int Source_Count;
+	int Fit_Count;
+	double Moment_FWHM;
+	double FWHM;
+	double FWHM_Sigma;
+	double Ellipticity;
+	double Elapsed_Time;
+};
+
+extern int CCD_Seeing_Initialise(void);
+extern int CCD_Seeing_Set_Config(double threshold_sigma,int cutout_radius,int saturation_counts,
+				 int max_source_count,int thread_count);
+extern int CCD_Seeing_Set_Enable(int enable);
+extern int CCD_Seeing_Get_Enable(void);
+extern int CCD_Seeing_Measure(unsigned short *image_data,int ncols,int nrows,struct CCD_Seeing_Result_Struct *result);
+extern int CCD_Seeing_Post_Readout(unsigned short *image_data,int ncols,int nrows);
+extern int CCD_Seeing_Get_Last_Result(struct CCD_Seeing_Result_Struct *result);
+
+extern int CCD_Seeing_Get_Error_Number(void);
+extern void CCD_Seeing_Error(void);
+extern void CCD_Seeing_Error_String(char *error_string);
+
+/*
+** $Log: not supported by cvs2svn $
+*/
+#endif
@@ -122,6 +122,7 @@ extern int CCD_Setup_Get_Window_Pixel_Count(CCD_Interface_Handle_T* handle,int w
 extern int CCD_Setup_Get_Window_Width(CCD_Interface_Handle_T* handle,int window_index);
 extern int CCD_Setup_Get_Window_Height(CCD_Interface_Handle_T* handle,int window_index);
 extern enum CCD_DSP_GAIN CCD_Setup_Get_Gain(CCD_Interface_Handle_T* handle);
+extern int CCD_Setup_Get_Gain_Speed(CCD_Interface_Handle_T* handle);
 extern enum CCD_DSP_AMPLIFIER CCD_Setup_Get_Amplifier(CCD_Interface_Handle_T* handle);
 extern int CCD_Setup_Get_Idle(CCD_Interface_Handle_T* handle);
 extern int CCD_Setup_Get_Window_Flags(CCD_Interface_Handle_T* handle);
@@ -20,6 +20,7 @@
  * <dt>Final_NCols</dt> <dd>The number of columns sent to the SDSU timing board.</dd>
  * <dt>Final_NRows</dt> <dd>The number of rows sent to the SDSU timing board.</dd>
  * <dt>Gain</dt> <dd>The gain setting used to configure the CCD electronics.</dd>
+ * <dt>Gain_Speed</dt> <dd>A boolean, TRUE if the video integrators were set to 'fast', FALSE for 'slow'.</dd>
  * <dt>Amplifier</dt> <dd>The amplifier setting used to configure the CCD electronics.</dd>
  * <dt>Is_Dummy</dt> <dd>A boolean, TRUE if the amplifier setting includes a dummy output which receive no charge, 
  *                   in addition to real outputs.
@@ -53,6 +54,7 @@ struct CCD_Setup_Struct
 	int Final_NCols;
 	int Final_NRows;
 	enum CCD_DSP_GAIN Gain;
+	int Gain_Speed;
 	enum CCD_DSP_AMPLIFIER Amplifier;
 	int Is_Dummy;
 	int Idle;
@@ -0,0 +1,95 @@
+/* ccd_source_find.h
+** $Header$
+*/
+#ifndef CCD_SOURCE_FIND_H
+#define CCD_SOURCE_FIND_H
+
+/**
+ * The default number of background standard deviations above the background a pixel must be to be
+ * part of an object.
+ * @see #CCD_Source_Find_Set_Config
+ */
+#define CCD_SOURCE_FIND_DEFAULT_THRESHOLD_SIGMA	(5.0)
+/**
+ * The default minimum number of connected pixels above the threshold an object must have. This stops single hot
+ * pixels and cosmic ray hits being picked as the brightest object.
+ * @see #CCD_Source_Find_Set_Config
+ */
+#define CCD_SOURCE_FIND_DEFAULT_MIN_PIXEL_COUNT	(4)
+/**
+ * The default number of threads (row bands) the frame is split into.
+ * @see #CCD_Source_Find_Set_Config
+ */
+#define CCD_SOURCE_FIND_DEFAULT_THREAD_COUNT	(4)
+/**
+ * The maximum number of threads (row bands) the frame can be split into.
+ * @see #CCD_Source_Find_Set_Config
+ */
+#define CCD_SOURCE_FIND_MAX_THREAD_COUNT	(16)
+
+/**
+ * Structure describing one object found in a frame.
+ * <dl>
+ * <dt>X</dt> <dd>The flux weighted centroid X position, in binned FITS pixels (the first pixel is 1.0).</dd>
+ * <dt>Y</dt> <dd>The flux weighted centroid Y position, in binned FITS pixels (the first pixel is 1.0).</dd>
+ * <dt>Flux</dt> <dd>The total counts above the background of the object's pixels.</dd>
+ * <dt>Peak</dt> <dd>The value of the brightest pixel in the object, including the background.</dd>
+ * <dt>Pixel_Count</dt> <dd>The number of connected pixels above the threshold in the object.</dd>
+ * <dt>Is_Saturated</dt> <dd>A boolean, TRUE if the object's brightest pixel is saturated.</dd>
+ * </dl>
+ */
+struct CCD_Source_Find_Object_Struct
+{
+	double X;
+	double Y;
+	double Flux;
+	int Peak;
+	int Pixel_Count;
+	int Is_Saturated;
+};
+
+/**
+ * Structure holding the results of running the source finder on a frame.
+ * <dl>
+ * <dt>NCols</dt> <dd>The number of binned columns in the frame.</dd>
+ * <dt>NRows</dt> <dd>The number of binned rows in the frame.</dd>
+ * <dt>Background</dt> <dd>The estimated background level, in counts.</dd>
+ * <dt>Background_Sigma</dt> <dd>The estimated standard deviation of the background, in counts.</dd>
+ * <dt>Threshold</dt> <dd>The threshold pixels had to be above to be part of an object, in counts.</dd>
+ * <dt>Object_Count</dt> <dd>The number of objects found (with at least the minimum pixel count).</dd>
+ * <dt>Brightest</dt> <dd>The object with the largest flux. Only valid if Object_Count is greater than zero.</dd>
+ * <dt>Elapsed_Time</dt> <dd>How long the source finder took to run, in seconds.</dd>
+ * </dl>
+ * @see #CCD_Source_Find_Object_Struct
+ */
+struct CCD_Source_Find_Result_Struct
+{
+	int NCols;
+	int NRows;
+	double Background;
+	double Background_Sigma;
+	double Threshold;
+	int Object_Count;
+	struct CCD_Source_Find_Object_Struct Brightest;
+	double Elapsed_Time;
+};
+
+extern int CCD_Source_Find_Initialise(void);
+extern int CCD_Source_Find_Set_Config(double threshold_sigma,int min_pixel_count,int thread_count);
+extern int CCD_Source_Find_Set_Enable(int enable);
+extern int CCD_Source_Find_Get_Enable(void);
+extern int CCD_Source_Find(unsigned short *image_data,int ncols,int nrows,
+			   struct CCD_Source_Find_Result_Struct *result);
+extern int CCD_Source_Find_Background_Get(unsigned short *image_data,int ncols,int nrows,double *background,
+					  double *background_sigma);
+extern int CCD_Source_Find_Post_Readout(unsigned short *image_data,int ncols,int nrows);
+extern int CCD_Source_Find_Get_Last_Result(struct CCD_Source_Find_Result_Struct *result);
+
+extern int CCD_Source_Find_Get_Error_Number(void);
+extern void CCD_Source_Find_Error(void);
+extern void CCD_Source_Find_Error_String(char *error_string);
+
+/*
+** $Log: not supported by cvs2svn $
+*/
+#endif
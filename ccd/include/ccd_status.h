@@ -0,0 +1,115 @@
+/* ccd_status.h
+** $Header$
+*/
+#ifndef CCD_STATUS_H
+#define CCD_STATUS_H
+#include <time.h>
+/* definition of CCD_Interface_Handle_T */
+#include "ccd_interface.h"
+/* enum CCD_EXPOSURE_STATUS */
+#include "ccd_exposure.h"
+
+/* These #define/enum definitions should match with those in CCDLibraryStatus.java */
+/**
+ * Flag bit passed to CCD_Status_Get, to read the elapsed exposure time from the controller.
+ * @see #CCD_Status_Get
+ */
+#define CCD_STATUS_FLAG_ELAPSED_EXPOSURE_TIME	(1<<0)
+/**
+ * Flag bit passed to CCD_Status_Get, to get the CCD temperature, heater and utility board ADUs.
+ * @see #CCD_Status_Get
+ */
+#define CCD_STATUS_FLAG_TEMPERATURE		(1<<1)
+/**
+ * Flag bit passed to CCD_Status_Get, to get the SDSU supply voltage ADUs.
+ * @see #CCD_Status_Get
+ */
+#define CCD_STATUS_FLAG_SUPPLY_VOLTAGE		(1<<2)
+
+/**
+ * Structure holding a snapshot of the library's status, as filled in by CCD_Status_Get.
+ * The setup and exposure values are always filled in. The controller values are only filled in
+ * if the relevant flag was passed to CCD_Status_Get: each group has a Valid boolean, and if the group could not be
+ * read, the error number of the module that failed and the DSP error number are kept, so the caller can ignore
+ * expected failures (e.g. utility board reads during an exposure).
+ * <dl>
+ * <dt>Exposure_Status</dt> <dd>The exposure status.</dd>
+ * <dt>Setup_Complete</dt> <dd>A boolean, whether the last setup completed.</dd>
+ * <dt>Setup_In_Progress</dt> <dd>A boolean, whether a setup is in progress.</dd>
+ * <dt>Binned_NCols</dt> <dd>The number of binned columns.</dd>
+ * <dt>Binned_NRows</dt> <dd>The number of binned rows.</dd>
+ * <dt>X_Bin</dt> <dd>The serial binning.</dd>
+ * <dt>Y_Bin</dt> <dd>The parallel binning.</dd>
+ * <dt>Window_Flags</dt> <dd>The window flags.</dd>
+ * <dt>Exposure_Length</dt> <dd>The length of the current (or last) exposure, in milliseconds.</dd>
+ * <dt>Exposure_Start_Time</dt> <dd>The start time of the current (or last) exposure.</dd>
+ * <dt>Elapsed_Exposure_Time_Valid</dt> <dd>A boolean, whether Elapsed_Exposure_Time was read.</dd>
+ * <dt>Elapsed_Exposure_Time</dt> <dd>The elapsed exposure time, in milliseconds, read from the controller.</dd>
+ * <dt>Elapsed_Exposure_Time_DSP_Error_Number</dt> <dd>The DSP error number, if the elapsed exposure time
+ *     could not be read.</dd>
+ * <dt>Telemetry_Running</dt> <dd>A boolean, if TRUE the temperature and supply voltage values came from the
+ *     telemetry sampler's snapshot, otherwise they were read from the controller.</dd>
+ * <dt>Temperature_Valid</dt> <dd>A boolean, whether Temperature was read.</dd>
+ * <dt>Temperature</dt> <dd>The CCD temperature, in degrees centigrade.</dd>
+ * <dt>Temperature_ADU_Valid</dt> <dd>A boolean, whether Heater_ADU and Utility_Board_ADU were read.</dd>
+ * <dt>Heater_ADU</dt> <dd>The dewar heater ADU counts.</dd>
+ * <dt>Utility_Board_ADU</dt> <dd>The utility board temperature sensor ADU counts.</dd>
+ * <dt>Temperature_Age</dt> <dd>How old the temperature values are, in seconds.</dd>
+ * <dt>Temperature_Error_Number</dt> <dd>The ccd_temperature error number, if a temperature value
+ *     could not be read.</dd>
+ * <dt>Temperature_DSP_Error_Number</dt> <dd>The DSP error number, if a temperature value could not be read.</dd>
+ * <dt>Supply_Voltage_Valid</dt> <dd>A boolean, whether the supply voltage ADUs were read.</dd>
+ * <dt>High_Voltage_ADU</dt> <dd>The SDSU high voltage supply ADU counts.</dd>
+ * <dt>Low_Voltage_ADU</dt> <dd>The SDSU low voltage supply ADU counts.</dd>
+ * <dt>Minus_Low_Voltage_ADU</dt> <dd>The SDSU negative low voltage supply ADU counts.</dd>
+ * <dt>Supply_Voltage_Age</dt> <dd>How old the supply voltage values are, in seconds.</dd>
+ * <dt>Supply_Voltage_Error_Number</dt> <dd>The ccd_setup error number, if the supply voltages
+ *     could not be read.</dd>
+ * <dt>Supply_Voltage_DSP_Error_Number</dt> <dd>The DSP error number, if the supply voltages could not
+ *     be read.</dd>
+ * </dl>
+ * @see #CCD_Status_Get
+ */
+struct CCD_Status_Struct
+{
+	enum CCD_EXPOSURE_STATUS Exposure_Status;
+	int Setup_Complete;
+	int Setup_In_Progress;
+	int Binned_NCols;
+	int Binned_NRows;
+	int X_Bin;
+	int Y_Bin;
+	int Window_Flags;
+	int Exposure_Length;
+	struct timespec Exposure_Start_Time;
+	int Elapsed_Exposure_Time_Valid;
+	int Elapsed_Exposure_Time;
+	int Elapsed_Exposure_Time_DSP_Error_Number;
+	int Telemetry_Running;
+	int Temperature_Valid;
+	double Temperature;
+	int Temperature_ADU_Valid;
+	int Heater_ADU;
+	int Utility_Board_ADU;
+	double Temperature_Age;
+	int Temperature_Error_Number;
+	int Temperature_DSP_Error_Number;
+	int Supply_Voltage_Valid;
+	int High_Voltage_ADU;
+	int Low_Voltage_ADU;
+	int Minus_Low_Voltage_ADU;
+	double Supply_Voltage_Age;
+	int Supply_Voltage_Error_Number;
+	int Supply_Voltage_DSP_Error_Number;
+};
+
+extern int CCD_Status_Initialise(void);
+extern int CCD_Status_Get(CCD_Interface_Handle_T* handle,int flags,struct CCD_Status_Struct *status);
+extern int CCD_Status_Get_Error_Number(void);
+extern void CCD_Status_Error(void);
+extern void CCD_Status_Error_String(char *error_string);
+
+/*
+** $Log: not supported by cvs2svn $
+*/
+#endif
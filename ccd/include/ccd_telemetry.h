@@ -0,0 +1,89 @@
+/* ccd_telemetry.h
+** $Header$
+*/
+#ifndef CCD_TELEMETRY_H
+#define CCD_TELEMETRY_H
+#include <time.h>
+/* definition of CCD_Interface_Handle_T */
+#include "ccd_interface.h"
+/* enum CCD_EXPOSURE_STATUS */
+#include "ccd_exposure.h"
+/* enum CCD_FILTER_WHEEL_STATUS */
+#include "ccd_filter_wheel.h"
+
+/**
+ * The default period between telemetry samples, in milliseconds.
+ * @see #CCD_Telemetry_Start
+ */
+#define CCD_TELEMETRY_DEFAULT_PERIOD_MS		(10000)
+
+/**
+ * Structure holding a snapshot of the controller telemetry, as sampled by the telemetry thread.
+ * Each group of values has a timestamp of when it was last successfully read. A timestamp with tv_sec
+ * of zero means that group has never been sampled.
+ * <dl>
+ * <dt>Running</dt> <dd>A boolean, TRUE if the telemetry sampler thread is running.</dd>
+ * <dt>Sample_Count</dt> <dd>The number of sampler loops completed since CCD_Telemetry_Start.</dd>
+ * <dt>Temperature_Timestamp</dt> <dd>When Temperature, Temperature_ADU, Heater_ADU and Utility_Board_ADU 
+ *     were last read.</dd>
+ * <dt>Temperature</dt> <dd>The CCD temperature, in degrees centigrade.</dd>
+ * <dt>Temperature_ADU</dt> <dd>The CCD temperature sensor ADU counts.</dd>
+ * <dt>Heater_ADU</dt> <dd>The dewar heater ADU counts.</dd>
+ * <dt>Utility_Board_ADU</dt> <dd>The utility board temperature sensor ADU counts.</dd>
+ * <dt>Supply_Voltage_Timestamp</dt> <dd>When the supply voltage ADUs were last read.</dd>
+ * <dt>High_Voltage_ADU</dt> <dd>The SDSU high voltage supply ADU counts.</dd>
+ * <dt>Low_Voltage_ADU</dt> <dd>The SDSU low voltage supply ADU counts.</dd>
+ * <dt>Minus_Low_Voltage_ADU</dt> <dd>The SDSU negative low voltage supply ADU counts.</dd>
+ * <dt>State_Timestamp</dt> <dd>When the library state below was last sampled.</dd>
+ * <dt>Exposure_Status</dt> <dd>The exposure status.</dd>
+ * <dt>Filter_Wheel_Status</dt> <dd>The filter wheel status.</dd>
+ * <dt>Filter_Wheel_Position</dt> <dd>The filter wheel position, or -1 if it is unknown.</dd>
+ * <dt>Readout_Anomaly_Count</dt> <dd>The number of readout rate anomalies the readout watchdog has recorded.</dd>
+ * <dt>Readout_Anomaly_Timestamp</dt> <dd>When the last readout rate anomaly was recorded.</dd>
+ * <dt>Readout_Anomaly_Type</dt> <dd>The last anomaly's type, one of CCD_READOUT_WATCHDOG_ANOMALY_*.</dd>
+ * <dt>Readout_Pixel_Rate</dt> <dd>The last anomalous readout's pixel rate, in pixels per second.</dd>
+ * <dt>Readout_Expected_Pixel_Rate</dt> <dd>The pixel rate learnt for the last anomalous readout's setup,
+ *     in pixels per second.</dd>
+ * </dl>
+ * @see #CCD_Telemetry_Get
+ */
+struct CCD_Telemetry_Struct
+{
+	int Running;
+	unsigned int Sample_Count;
+	struct timespec Temperature_Timestamp;
+	double Temperature;
+	int Temperature_ADU;
+	int Heater_ADU;
+	int Utility_Board_ADU;
+	struct timespec Supply_Voltage_Timestamp;
+	int High_Voltage_ADU;
+	int Low_Voltage_ADU;
+	int Minus_Low_Voltage_ADU;
+	struct timespec State_Timestamp;
+	enum CCD_EXPOSURE_STATUS Exposure_Status;
+	enum CCD_FILTER_WHEEL_STATUS Filter_Wheel_Status;
+	int Filter_Wheel_Position;
+	unsigned int Readout_Anomaly_Count;
+	struct timespec Readout_Anomaly_Timestamp;
+	int Readout_Anomaly_Type;
+	double Readout_Pixel_Rate;
+	double Readout_Expected_Pixel_Rate;
+};
+
+extern int CCD_Telemetry_Initialise(void);
+extern int CCD_Telemetry_Start(CCD_Interface_Handle_T* handle,int period_ms);
+extern int CCD_Telemetry_Stop(void);
+extern int CCD_Telemetry_Get(struct CCD_Telemetry_Struct *telemetry);
+extern double CCD_Telemetry_Age_Get(struct timespec timestamp);
+extern void CCD_Telemetry_Command_Start(void);
+extern void CCD_Telemetry_Command_End(void);
+
+extern int CCD_Telemetry_Get_Error_Number(void);
+extern void CCD_Telemetry_Error(void);
+extern void CCD_Telemetry_Error_String(char *error_string);
+
+/*
+** $Log: not supported by cvs2svn $
+*/
+#endif
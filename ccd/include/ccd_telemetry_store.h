@@ -0,0 +1,113 @@
+/* ccd_telemetry_store.h
+** $Header$
+*/
+#ifndef CCD_TELEMETRY_STORE_H
+#define CCD_TELEMETRY_STORE_H
+#include <time.h>
+
+/**
+ * Record flag bit, set if the record's Temperature_ADU, Heater_ADU and Utility_Board_ADU were read
+ * from the controller when the record was made.
+ * @see #CCD_Telemetry_Store_Record_Struct
+ */
+#define CCD_TELEMETRY_STORE_FLAG_TEMPERATURE		(1<<0)
+/**
+ * Record flag bit, set if the record's supply voltage ADUs were read from the controller when the record was made.
+ * @see #CCD_Telemetry_Store_Record_Struct
+ */
+#define CCD_TELEMETRY_STORE_FLAG_SUPPLY_VOLTAGE		(1<<1)
+/**
+ * Record flag bit, set if the record was made because the exposure or filter wheel status changed.
+ * @see #CCD_Telemetry_Store_Record_Struct
+ */
+#define CCD_TELEMETRY_STORE_FLAG_STATE_CHANGE		(1<<2)
+/**
+ * Record flag bit, set if the record was made because the readout watchdog recorded a readout rate anomaly.
+ * The record's Readout_Anomaly_Type, Readout_Pixel_Rate and Readout_Expected_Pixel_Rate are valid.
+ * @see #CCD_Telemetry_Store_Record_Struct
+ */
+#define CCD_TELEMETRY_STORE_FLAG_READOUT_ANOMALY	(1<<3)
+/**
+ * The default number of records in a telemetry store ring file. At one record every 10 seconds, this is
+ * just over a week of telemetry.
+ * @see #CCD_Telemetry_Store_Open
+ */
+#define CCD_TELEMETRY_STORE_DEFAULT_RECORD_COUNT	(65536)
+
+/**
+ * Structure holding one telemetry store record. This is the on-disk format, so all fields are 32 bit.
+ * <dl>
+ * <dt>Sequence</dt> <dd>Used to detect records being overwritten whilst they are read.
+ *     In a record returned by CCD_Telemetry_Store_Query this is the index of the first raw record in the bucket.</dd>
+ * <dt>Flags</dt> <dd>A bit-mask of CCD_TELEMETRY_STORE_FLAG_* values, saying which fields are valid.</dd>
+ * <dt>Time_Sec</dt> <dd>When the record was made, seconds since the epoch.</dd>
+ * <dt>Time_Nsec</dt> <dd>When the record was made, nanoseconds.</dd>
+ * <dt>Temperature_ADU</dt> <dd>The CCD (dewar) temperature sensor ADU counts.</dd>
+ * <dt>Heater_ADU</dt> <dd>The dewar heater ADU counts.</dd>
+ * <dt>Utility_Board_ADU</dt> <dd>The utility board temperature sensor ADU counts.</dd>
+ * <dt>High_Voltage_ADU</dt> <dd>The SDSU high voltage supply ADU counts.</dd>
+ * <dt>Low_Voltage_ADU</dt> <dd>The SDSU low voltage supply ADU counts.</dd>
+ * <dt>Minus_Low_Voltage_ADU</dt> <dd>The SDSU negative low voltage supply ADU counts.</dd>
+ * <dt>Exposure_Status</dt> <dd>The exposure status (enum CCD_EXPOSURE_STATUS).</dd>
+ * <dt>Filter_Wheel_Status</dt> <dd>The filter wheel status (enum CCD_FILTER_WHEEL_STATUS).</dd>
+ * <dt>Filter_Wheel_Position</dt> <dd>The filter wheel position, or -1 if unknown.</dd>
+ * <dt>Readout_Anomaly_Type</dt> <dd>The readout anomaly type (CCD_READOUT_WATCHDOG_ANOMALY_*).</dd>
+ * <dt>Readout_Pixel_Rate</dt> <dd>The anomalous readout's measured pixel rate, in pixels per second.</dd>
+ * <dt>Readout_Expected_Pixel_Rate</dt> <dd>The pixel rate learnt for the anomalous readout's setup,
+ *     in pixels per second.</dd>
+ * <dt>Count</dt> <dd>The number of raw records merged into this record. This is 1 in the file,
+ *     and may be larger in records returned by CCD_Telemetry_Store_Query.</dd>
+ * </dl>
+ * The store file is a 64 byte header, followed by the ring of records. Each on-disk file format version
+ * has a different record layout:
+ * <ul>
+ * <li>Version 1: 14 fields, 56 bytes. Sequence to Filter_Wheel_Position, then Count.
+ * <li>Version 2: 17 fields, 68 bytes. The version 1 fields, with Readout_Anomaly_Type, Readout_Pixel_Rate and
+ *     Readout_Expected_Pixel_Rate inserted before Count. This is the current version.
+ * </ul>
+ * A store with a different version is re-initialised (emptied) when opened for writing, and refused when
+ * opened for reading only.
+ * @see #CCD_TELEMETRY_STORE_FLAG_TEMPERATURE
+ * @see #CCD_TELEMETRY_STORE_FLAG_SUPPLY_VOLTAGE
+ * @see #CCD_TELEMETRY_STORE_FLAG_STATE_CHANGE
+ * @see #CCD_TELEMETRY_STORE_FLAG_READOUT_ANOMALY
+ */
+struct CCD_Telemetry_Store_Record_Struct
+{
+	unsigned int Sequence;
+	unsigned int Flags;
+	unsigned int Time_Sec;
+	int Time_Nsec;
+	int Temperature_ADU;
+	int Heater_ADU;
+	int Utility_Board_ADU;
+	int High_Voltage_ADU;
+	int Low_Voltage_ADU;
+	int Minus_Low_Voltage_ADU;
+	int Exposure_Status;
+	int Filter_Wheel_Status;
+	int Filter_Wheel_Position;
+	int Readout_Anomaly_Type;
+	int Readout_Pixel_Rate;
+	int Readout_Expected_Pixel_Rate;
+	int Count;
+};
+
+extern int CCD_Telemetry_Store_Initialise(void);
+extern int CCD_Telemetry_Store_Open(char *filename,int record_count,int writable);
+extern int CCD_Telemetry_Store_Close(void);
+extern int CCD_Telemetry_Store_Is_Open(void);
+extern int CCD_Telemetry_Store_Add(struct CCD_Telemetry_Store_Record_Struct *record);
+extern int CCD_Telemetry_Store_Info_Get(int *record_count,unsigned int *write_count,
+					struct timespec *oldest_time,struct timespec *newest_time);
+extern int CCD_Telemetry_Store_Query(struct timespec start_time,struct timespec end_time,int max_record_count,
+				     struct CCD_Telemetry_Store_Record_Struct *record_list,int *record_count);
+
+extern int CCD_Telemetry_Store_Get_Error_Number(void);
+extern void CCD_Telemetry_Store_Error(void);
+extern void CCD_Telemetry_Store_Error_String(char *error_string);
+
+/*
+** $Log: not supported by cvs2svn $
+*/
+#endif
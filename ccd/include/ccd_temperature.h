@@ -6,6 +6,8 @@
 #include "ccd_interface.h"
 
 extern int CCD_Temperature_Get(CCD_Interface_Handle_T* handle,double *temperature);
+extern int CCD_Temperature_Get_ADU(CCD_Interface_Handle_T* handle,int *adu);
+extern int CCD_Temperature_ADU_To_Centigrade(int adu,double *temperature);
 extern int CCD_Temperature_Get_Utility_Board_ADU(CCD_Interface_Handle_T* handle,int *adu);
 extern int CCD_Temperature_Set(CCD_Interface_Handle_T* handle,double target_temperature);
 extern int CCD_Temperature_Get_Heater_ADU(CCD_Interface_Handle_T* handle,int *heater_adu);
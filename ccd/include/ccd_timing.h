@@ -0,0 +1,95 @@
+/* ccd_timing.h
+** $Header$
+*/
+#ifndef CCD_TIMING_H
+#define CCD_TIMING_H
+
+/**
+ * Exposure phase: from the start of CCD_Exposure_Expose to the start of the wait/clear (shutter control,
+ * exposure length and SHDEL configuration).
+ */
+#define CCD_TIMING_PHASE_SETUP		(0)
+/**
+ * Exposure phase: waiting for the requested start time (CCD_EXPOSURE_STATUS_WAIT_START).
+ */
+#define CCD_TIMING_PHASE_WAIT_START	(1)
+/**
+ * Exposure phase: clearing the array (CCD_EXPOSURE_STATUS_CLEAR).
+ */
+#define CCD_TIMING_PHASE_CLEAR		(2)
+/**
+ * Exposure phase: from sending SEX to switching to CCD_EXPOSURE_STATUS_PRE_READOUT (or detecting readout).
+ */
+#define CCD_TIMING_PHASE_EXPOSE		(3)
+/**
+ * Exposure phase: CCD_EXPOSURE_STATUS_PRE_READOUT, until readout is detected.
+ */
+#define CCD_TIMING_PHASE_PRE_READOUT	(4)
+/**
+ * Exposure phase: CCD_EXPOSURE_STATUS_READOUT, from readout being detected to all the pixels being detected.
+ */
+#define CCD_TIMING_PHASE_READOUT	(5)
+/**
+ * Exposure phase: the (estimated) gap between the last pixel arriving and it being detected by the readout
+ * progress polling.
+ */
+#define CCD_TIMING_PHASE_READOUT_DETECT	(6)
+/**
+ * Exposure phase: de-interlacing the read out data.
+ */
+#define CCD_TIMING_PHASE_DEINTERLACE	(7)
+/**
+ * Exposure phase: saving the image data into the FITS file(s).
+ */
+#define CCD_TIMING_PHASE_SAVE		(8)
+/**
+ * Exposure phase: CCD_EXPOSURE_STATUS_POST_READOUT, all post-readout processing (including de-interlacing
+ * and saving).
+ */
+#define CCD_TIMING_PHASE_POST_READOUT	(9)
+/**
+ * Exposure phase: from CCD_Exposure_Expose returning to the JNI layer returning to Java.
+ */
+#define CCD_TIMING_PHASE_RETURN		(10)
+/**
+ * Exposure phase: the whole of CCD_Exposure_Expose.
+ */
+#define CCD_TIMING_PHASE_TOTAL		(11)
+/**
+ * The number of exposure phases timed.
+ */
+#define CCD_TIMING_PHASE_COUNT		(12)
+/**
+ * Macro to check whether the phase is a legal exposure phase.
+ */
+#define CCD_TIMING_IS_PHASE(phase)	(((phase) >= 0)&&((phase) < CCD_TIMING_PHASE_COUNT))
+/**
+ * The maximum number of exposure configurations (binning, amplifier and windowing) timed separately.
+ * When more configurations are used, the least recently used one is reset and reused.
+ */
+#define CCD_TIMING_MAX_CONFIG_COUNT	(8)
+/**
+ * The config_index to pass into CCD_Timing_Percentile_Get to combine all configurations.
+ * @see #CCD_Timing_Percentile_Get
+ */
+#define CCD_TIMING_CONFIG_ALL		(-1)
+
+extern int CCD_Timing_Initialise(void);
+extern void CCD_Timing_Exposure_Start(int x_bin,int y_bin,int amplifier,int windowed);
+extern void CCD_Timing_Phase_Start(int phase);
+extern void CCD_Timing_Phase_End(int phase);
+extern void CCD_Timing_Readout_Progress(int pixel_count,int expected_pixel_count);
+extern void CCD_Timing_Exposure_End(void);
+extern void CCD_Timing_Return_End(void);
+extern int CCD_Timing_Reset(void);
+extern char *CCD_Timing_Phase_Name_Get(int phase);
+extern int CCD_Timing_Config_Get(int config_index,int *in_use,int *x_bin,int *y_bin,int *amplifier,int *windowed);
+extern int CCD_Timing_Percentile_Get(int config_index,int phase,double percentile,double *duration,int *count);
+extern int CCD_Timing_Get_Error_Number(void);
+extern void CCD_Timing_Error(void);
+extern void CCD_Timing_Error_String(char *error_string);
+
+/*
+** $Log: not supported by cvs2svn $
+*/
+#endif
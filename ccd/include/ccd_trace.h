@@ -0,0 +1,46 @@
+/* ccd_trace.h
+** $Header$
+*/
+#ifndef CCD_TRACE_H
+#define CCD_TRACE_H
+#include <stdio.h>
+#include <time.h>
+
+/**
+ * The number of controller requests kept in each thread's trace ring buffer.
+ */
+#define CCD_TRACE_RING_LENGTH		(256)
+/**
+ * The maximum number of threads that can have their own trace ring buffer at the same time. Requests from
+ * further threads are still counted, but not recorded in a ring buffer.
+ */
+#define CCD_TRACE_MAX_THREAD_COUNT	(16)
+/**
+ * The maximum number of different controller requests (ioctl request and DSP command pairs) that have
+ * latency counters. Further requests are counted together in an overflow counter.
+ */
+#define CCD_TRACE_MAX_COUNTER_COUNT	(64)
+/**
+ * A string length long enough for CCD_Trace_Counters_Get to fit every latency counter into.
+ */
+#define CCD_TRACE_COUNTERS_STRING_LENGTH	((CCD_TRACE_MAX_COUNTER_COUNT+2)*256)
+
+extern int CCD_Trace_Initialise(void);
+extern void CCD_Trace_Set_Enable(int enable);
+extern int CCD_Trace_Get_Enable(void);
+extern void CCD_Trace_Request_Start(struct timespec *start_time);
+extern void CCD_Trace_Request_End(struct timespec start_time,int request,int *argument_list,int argument_count,
+				  int reply,int return_value);
+extern void CCD_Trace_Mutex_Wait(struct timespec start_time);
+extern int CCD_Trace_Reset(void);
+extern int CCD_Trace_Dump(char *filename);
+extern int CCD_Trace_Dump_Stream(FILE *fp);
+extern int CCD_Trace_Counters_Get(char *counters_string,size_t counters_string_length);
+extern int CCD_Trace_Get_Error_Number(void);
+extern void CCD_Trace_Error(void);
+extern void CCD_Trace_Error_String(char *error_string);
+
+/*
+** $Log: not supported by cvs2svn $
+*/
+#endif
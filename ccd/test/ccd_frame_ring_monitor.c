@@ -0,0 +1,253 @@
+/* ccd_frame_ring_monitor.c
+ * $Header$
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "ccd_frame_ring.h"
+#include "ccd_global.h"
+
+/**
+ * This program attaches to the O's shared memory frame ring, and prints a line for each frame published into it:
+ * the frame number, dimensions, binning, window, exposure length and start time, how long after the end of the
+ * exposure the frame was published, the mean pixel value and the FITS filename.
+ * It is an example of a frame ring consumer, using the frame data in place (without copying it).
+ * <pre>
+ * ccd_frame_ring_monitor [-n[ame] &lt;shared memory name&gt;][-c[ount] &lt;n&gt;][-t[imeout] &lt;ms&gt;]
+ * 	[-l[og_level] &lt;n&gt;][-h[elp]]
+ * </pre>
+ * @author $Author$
+ * @version $Revision$
+ */
+/* hash definitions */
+/**
+ * Maximum length of some of the strings in this program.
+ */
+#define MAX_STRING_LENGTH	(256)
+
+/* internal variables */
+/**
+ * Revision control system identifier.
+ */
+static char rcsid[] = "$Id$";
+/**
+ * The log level to use.
+ */
+static int Log_Level = 0;
+/**
+ * The shared memory object name of the frame ring.
+ * @see ../cdocs/ccd_frame_ring.html#CCD_FRAME_RING_DEFAULT_NAME
+ */
+static char Name[MAX_STRING_LENGTH] = CCD_FRAME_RING_DEFAULT_NAME;
+/**
+ * The number of frames to print before stopping, or 0 to run forever.
+ */
+static int Frame_Count = 0;
+/**
+ * How long to wait for each frame, in milliseconds.
+ */
+static int Timeout_Ms = 60000;
+
+/* internal routines */
+static int Parse_Arguments(int argc, char *argv[]);
+static void Help(void);
+
+/**
+ * Main program.
+ * @param argc The number of arguments to the program.
+ * @param argv An array of argument strings.
+ * @return This function returns 0 if the program succeeds, and a positive integer if it fails.
+ * @see #Name
+ * @see #Frame_Count
+ * @see #Timeout_Ms
+ * @see ../cdocs/ccd_frame_ring.html#CCD_Frame_Ring_Attach
+ * @see ../cdocs/ccd_frame_ring.html#CCD_Frame_Ring_Wait
+ * @see ../cdocs/ccd_frame_ring.html#CCD_Frame_Ring_Slot_Get
+ * @see ../cdocs/ccd_frame_ring.html#CCD_Frame_Ring_Slot_Check
+ * @see ../cdocs/ccd_frame_ring.html#CCD_Frame_Ring_Detach
+ */
+int main(int argc, char *argv[])
+{
+	struct CCD_Frame_Ring_Slot_Struct *slot = NULL;
+	struct timespec start_time,publish_time;
+	unsigned short *image_data = NULL;
+	unsigned int last_frame_number,frame_number,sequence;
+	double total,publish_delay;
+	size_t pixel_count,i;
+	int printed_count = 0;
+
+	if(!Parse_Arguments(argc,argv))
+		return 1;
+	/* we don't need to call CCD_Global_Initialise, as we are not talking to the controller */
+	CCD_Global_Set_Log_Handler_Function(CCD_Global_Log_Handler_Stdout);
+	CCD_Global_Set_Log_Filter_Function(CCD_Global_Log_Filter_Level_Absolute);
+	CCD_Global_Set_Log_Filter_Level(Log_Level);
+	if(!CCD_Frame_Ring_Attach(Name))
+	{
+		CCD_Frame_Ring_Error();
+		return 2;
+	}
+	/* only report frames published from now on */
+	if(!CCD_Frame_Ring_Wait(0,0,&last_frame_number))
+	{
+		CCD_Frame_Ring_Error();
+		return 3;
+	}
+	fprintf(stdout,"# Frame NCols NRows XBin YBin Window Exposure(ms) Start Publish_Delay(s) Mean Filename\n");
+	while((Frame_Count == 0)||(printed_count < Frame_Count))
+	{
+		if(!CCD_Frame_Ring_Wait(last_frame_number,Timeout_Ms,&frame_number))
+		{
+			CCD_Frame_Ring_Error();
+			return 4;
+		}
+		if(frame_number == last_frame_number)
+		{
+			fprintf(stderr,"ccd_frame_ring_monitor:No frame published in %d ms.\n",Timeout_Ms);
+			continue;
+		}
+		/* if we fell behind, skip to the latest frame */
+		last_frame_number = frame_number;
+		if(!CCD_Frame_Ring_Slot_Get(frame_number,&slot,&image_data,&sequence))
+		{
+			CCD_Frame_Ring_Error();
+			continue;
+		}
+		pixel_count = ((size_t)slot->NCols)*((size_t)slot->NRows);
+		total = 0.0;
+		for(i = 0; i < pixel_count; i++)
+			total += (double)(image_data[i]);
+		start_time.tv_sec = slot->Start_Time_Sec;
+		start_time.tv_nsec = slot->Start_Time_Nsec;
+		publish_time.tv_sec = slot->Publish_Time_Sec;
+		publish_time.tv_nsec = slot->Publish_Time_Nsec;
+		publish_delay = fdifftime(publish_time,start_time)-(((double)slot->Exposure_Length)/
+								   ((double)CCD_GLOBAL_ONE_SECOND_MS));
+		fprintf(stdout,"%u %d %d %d %d %d %d %d.%09d %.3f %.2f %s%s\n",frame_number,slot->NCols,slot->NRows,
+			slot->X_Bin,slot->Y_Bin,slot->Window_Number,slot->Exposure_Length,slot->Start_Time_Sec,
+			slot->Start_Time_Nsec,publish_delay,(pixel_count > 0) ? total/((double)pixel_count) : 0.0,
+			slot->Filename,CCD_Frame_Ring_Slot_Check(slot,sequence) ? "" : " (overwritten)");
+		fflush(stdout);
+		printed_count++;
+	}
+	CCD_Frame_Ring_Detach();
+	return 0;
+}
+
+/**
+ * Routine to parse command line arguments.
+ * @param argc The number of arguments sent to the program.
+ * @param argv An array of argument strings.
+ * @see #Help
+ * @see #Name
+ * @see #Frame_Count
+ * @see #Timeout_Ms
+ * @see #Log_Level
+ */
+static int Parse_Arguments(int argc, char *argv[])
+{
+	int i,retval;
+
+	for(i=1;i<argc;i++)
+	{
+		if((strcmp(argv[i],"-count")==0)||(strcmp(argv[i],"-c")==0))
+		{
+			if((i+1)<argc)
+			{
+				retval = sscanf(argv[i+1],"%d",&Frame_Count);
+				if((retval != 1)||(Frame_Count < 0))
+				{
+					fprintf(stderr,"Parse_Arguments:Count was not a non-negative integer:%s.\n",
+						argv[i+1]);
+					return FALSE;
+				}
+				i++;
+			}
+			else
+			{
+				fprintf(stderr,"Parse_Arguments:Count requires a non-negative integer.\n");
+				return FALSE;
+			}
+		}
+		else if((strcmp(argv[i],"-help")==0)||(strcmp(argv[i],"-h")==0))
+		{
+			Help();
+			exit(0);
+		}
+		else if((strcmp(argv[i],"-log_level")==0)||(strcmp(argv[i],"-l")==0))
+		{
+			if((i+1)<argc)
+			{
+				retval = sscanf(argv[i+1],"%d",&Log_Level);
+				if(retval != 1)
+				{
+					fprintf(stderr,"Parse_Arguments:Log Level was not an integer:%s.\n",argv[i+1]);
+					return FALSE;
+				}
+				i++;
+			}
+			else
+			{
+				fprintf(stderr,"Parse_Arguments:Log level requires a non-negative integer.\n");
+				return FALSE;
+			}
+		}
+		else if((strcmp(argv[i],"-name")==0)||(strcmp(argv[i],"-n")==0))
+		{
+			if((i+1)<argc)
+			{
+				strncpy(Name,argv[i+1],MAX_STRING_LENGTH-1);
+				i++;
+			}
+			else
+			{
+				fprintf(stderr,"Parse_Arguments:Name requires a shared memory object name.\n");
+				return FALSE;
+			}
+		}
+		else if((strcmp(argv[i],"-timeout")==0)||(strcmp(argv[i],"-t")==0))
+		{
+			if((i+1)<argc)
+			{
+				retval = sscanf(argv[i+1],"%d",&Timeout_Ms);
+				if((retval != 1)||(Timeout_Ms < 1))
+				{
+					fprintf(stderr,"Parse_Arguments:Timeout was not a positive integer:%s.\n",argv[i+1]);
+					return FALSE;
+				}
+				i++;
+			}
+			else
+			{
+				fprintf(stderr,"Parse_Arguments:Timeout requires a positive integer.\n");
+				return FALSE;
+			}
+		}
+		else
+		{
+			fprintf(stderr,"Parse_Arguments:argument '%s' not recognized.\n",argv[i]);
+			return FALSE;
+		}
+	}
+	return TRUE;
+}
+
+/**
+ * Help routine.
+ */
+static void Help(void)
+{
+	fprintf(stdout,"CCD Frame Ring Monitor:Help.\n");
+	fprintf(stdout,"CCD Frame Ring Monitor prints the frames the O publishes into it's shared memory frame ring.\n");
+	fprintf(stdout,"ccd_frame_ring_monitor [-n[ame] <shared memory name>][-c[ount] <n>][-t[imeout] <ms>]\n");
+	fprintf(stdout,"\t[-l[og_level] <0..5>][-h[elp]]\n");
+	fprintf(stdout,"\n");
+	fprintf(stdout,"\t-name is the frame ring shared memory object name (default %s).\n",CCD_FRAME_RING_DEFAULT_NAME);
+	fprintf(stdout,"\t-count is the number of frames to print before stopping (default 0, forever).\n");
+	fprintf(stdout,"\t-timeout is how long to wait for each frame, in milliseconds (default 60000).\n");
+	fprintf(stdout,"\t-help prints out this message and stops the program.\n");
+}
+/*
+** $Log: not supported by cvs2svn $
+*/
@@ -0,0 +1,358 @@
+/* ccd_telemetry_query.c
+ * $Header$
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "ccd_global.h"
+#include "ccd_telemetry_store.h"
+#include "ccd_temperature.h"
+
+/**
+ * This program queries a telemetry store ring file written by the instrument's telemetry sampler, and prints
+ * the (decimated) records in a time range as whitespace separated columns, suitable for plotting.
+ * It does not talk to the controller, and can be run whilst the instrument is running.
+ * <pre>
+ * ccd_telemetry_query -f[ilename] &lt;filename&gt; [-s[tart] &lt;time&gt;][-e[nd] &lt;time&gt;]
+ * 	[-m[ax_count] &lt;n&gt;][-i[nfo]][-l[og_level] &lt;n&gt;][-h[elp]]
+ * </pre>
+ * Times are seconds since the epoch, or if negative, seconds before now.
+ * @author $Author$
+ * @version $Revision$
+ */
+/* hash definitions */
+/**
+ * Maximum length of some of the strings in this program.
+ */
+#define MAX_STRING_LENGTH	(256)
+/**
+ * Default maximum number of records to print.
+ */
+#define DEFAULT_MAX_COUNT	(1000)
+
+/* internal variables */
+/**
+ * Revision control system identifier.
+ */
+static char rcsid[] = "$Id$";
+/**
+ * The log level to use.
+ */
+static int Log_Level = 0;
+/**
+ * The filename of the telemetry store.
+ */
+static char Filename[MAX_STRING_LENGTH] = "";
+/**
+ * The start of the time range to query. Negative values are relative to now. The default is the last day.
+ */
+static double Start_Time = -86400.0;
+/**
+ * The end of the time range to query. Negative values are relative to now, zero means now.
+ */
+static double End_Time = 0.0;
+/**
+ * The maximum number of (decimated) records to print.
+ */
+static int Max_Count = DEFAULT_MAX_COUNT;
+/**
+ * Whether to just print information about the store.
+ */
+static int Info = FALSE;
+
+/* internal routines */
+static int Parse_Arguments(int argc, char *argv[]);
+static void Help(void);
+static void Time_Get(double time_secs,struct timespec *time_spec);
+static void Time_To_String(unsigned int time_sec,int time_nsec,char *time_string);
+
+/**
+ * Main program.
+ * @param argc The number of arguments to the program.
+ * @param argv An array of argument strings.
+ * @return This function returns 0 if the program succeeds, and a positive integer if it fails.
+ * @see #Filename
+ * @see #Start_Time
+ * @see #End_Time
+ * @see #Max_Count
+ * @see #Info
+ * @see #Log_Level
+ * @see ../cdocs/ccd_global.html#CCD_Global_Set_Log_Handler_Function
+ * @see ../cdocs/ccd_global.html#CCD_Global_Log_Handler_Stdout
+ * @see ../cdocs/ccd_global.html#CCD_Global_Set_Log_Filter_Function
+ * @see ../cdocs/ccd_global.html#CCD_Global_Log_Filter_Level_Absolute
+ * @see ../cdocs/ccd_global.html#CCD_Global_Set_Log_Filter_Level
+ * @see ../cdocs/ccd_telemetry_store.html#CCD_Telemetry_Store_Open
+ * @see ../cdocs/ccd_telemetry_store.html#CCD_Telemetry_Store_Info_Get
+ * @see ../cdocs/ccd_telemetry_store.html#CCD_Telemetry_Store_Query
+ * @see ../cdocs/ccd_telemetry_store.html#CCD_Telemetry_Store_Close
+ * @see ../cdocs/ccd_temperature.html#CCD_Temperature_ADU_To_Centigrade
+ * @see ../cdocs/ccd_temperature.html#CCD_Temperature_Heater_ADU_To_Power
+ */
+int main(int argc, char *argv[])
+{
+	struct CCD_Telemetry_Store_Record_Struct *record_list = NULL;
+	struct timespec start_time,end_time,oldest_time,newest_time;
+	char time_string[MAX_STRING_LENGTH];
+	double temperature,heater_power;
+	unsigned int write_count;
+	int record_count,i;
+
+	if(!Parse_Arguments(argc,argv))
+		return 1;
+	if(strlen(Filename) == 0)
+	{
+		fprintf(stderr,"ccd_telemetry_query:No filename specified.\n");
+		Help();
+		return 1;
+	}
+	/* we don't need to call CCD_Global_Initialise, as we are not talking to the controller */
+	CCD_Global_Set_Log_Handler_Function(CCD_Global_Log_Handler_Stdout);
+	CCD_Global_Set_Log_Filter_Function(CCD_Global_Log_Filter_Level_Absolute);
+	CCD_Global_Set_Log_Filter_Level(Log_Level);
+	if(!CCD_Telemetry_Store_Open(Filename,0,FALSE))
+	{
+		CCD_Telemetry_Store_Error();
+		return 2;
+	}
+	if(Info)
+	{
+		if(!CCD_Telemetry_Store_Info_Get(&record_count,&write_count,&oldest_time,&newest_time))
+		{
+			CCD_Telemetry_Store_Error();
+			CCD_Telemetry_Store_Close();
+			return 3;
+		}
+		fprintf(stdout,"Filename:%s\n",Filename);
+		fprintf(stdout,"Record Count:%d\n",record_count);
+		fprintf(stdout,"Write Count:%u\n",write_count);
+		Time_To_String(oldest_time.tv_sec,oldest_time.tv_nsec,time_string);
+		fprintf(stdout,"Oldest:%s\n",time_string);
+		Time_To_String(newest_time.tv_sec,newest_time.tv_nsec,time_string);
+		fprintf(stdout,"Newest:%s\n",time_string);
+		CCD_Telemetry_Store_Close();
+		return 0;
+	}
+	record_list = (struct CCD_Telemetry_Store_Record_Struct *)malloc(Max_Count*
+						sizeof(struct CCD_Telemetry_Store_Record_Struct));
+	if(record_list == NULL)
+	{
+		fprintf(stderr,"ccd_telemetry_query:Failed to allocate %d records.\n",Max_Count);
+		CCD_Telemetry_Store_Close();
+		return 4;
+	}
+	Time_Get(Start_Time,&start_time);
+	Time_Get(End_Time,&end_time);
+	if(!CCD_Telemetry_Store_Query(start_time,end_time,Max_Count,record_list,&record_count))
+	{
+		CCD_Telemetry_Store_Error();
+		free(record_list);
+		CCD_Telemetry_Store_Close();
+		return 5;
+	}
+	fprintf(stdout,"# Time Count Flags Temperature(C) Temperature_ADU Heater_ADU Heater_Power(W) "
+		"Utility_Board_ADU High_Voltage_ADU Low_Voltage_ADU Minus_Low_Voltage_ADU "
+		"Exposure_Status Filter_Wheel_Status Filter_Wheel_Position Readout_Anomaly_Type "
+		"Readout_Pixel_Rate Readout_Expected_Pixel_Rate\n");
+	for(i = 0; i < record_count; i++)
+	{
+		Time_To_String(record_list[i].Time_Sec,record_list[i].Time_Nsec,time_string);
+		if(!CCD_Temperature_ADU_To_Centigrade(record_list[i].Temperature_ADU,&temperature))
+			temperature = 0.0;
+		if(!CCD_Temperature_Heater_ADU_To_Power(record_list[i].Heater_ADU,&heater_power))
+			heater_power = 0.0;
+		fprintf(stdout,"%s %d %#x %.2f %d %d %.3f %d %d %d %d %d %d %d %d %d %d\n",time_string,record_list[i].Count,
+			record_list[i].Flags,temperature,record_list[i].Temperature_ADU,record_list[i].Heater_ADU,
+			heater_power,record_list[i].Utility_Board_ADU,record_list[i].High_Voltage_ADU,
+			record_list[i].Low_Voltage_ADU,record_list[i].Minus_Low_Voltage_ADU,
+			record_list[i].Exposure_Status,record_list[i].Filter_Wheel_Status,
+			record_list[i].Filter_Wheel_Position,record_list[i].Readout_Anomaly_Type,
+			record_list[i].Readout_Pixel_Rate,record_list[i].Readout_Expected_Pixel_Rate);
+	}
+	free(record_list);
+	CCD_Telemetry_Store_Close();
+	return 0;
+}
+
+/**
+ * Routine to parse command line arguments.
+ * @param argc The number of arguments sent to the program.
+ * @param argv An array of argument strings.
+ * @see #Help
+ * @see #Filename
+ * @see #Start_Time
+ * @see #End_Time
+ * @see #Max_Count
+ * @see #Info
+ * @see #Log_Level
+ */
+static int Parse_Arguments(int argc, char *argv[])
+{
+	int i,retval;
+
+	for(i=1;i<argc;i++)
+	{
+		if((strcmp(argv[i],"-end")==0)||(strcmp(argv[i],"-e")==0))
+		{
+			if((i+1)<argc)
+			{
+				retval = sscanf(argv[i+1],"%lf",&End_Time);
+				if(retval != 1)
+				{
+					fprintf(stderr,"Parse_Arguments:End time was not a number:%s.\n",argv[i+1]);
+					return FALSE;
+				}
+				i++;
+			}
+			else
+			{
+				fprintf(stderr,"Parse_Arguments:End time requires a number.\n");
+				return FALSE;
+			}
+		}
+		else if((strcmp(argv[i],"-filename")==0)||(strcmp(argv[i],"-f")==0))
+		{
+			if((i+1)<argc)
+			{
+				strncpy(Filename,argv[i+1],MAX_STRING_LENGTH-1);
+				i++;
+			}
+			else
+			{
+				fprintf(stderr,"Parse_Arguments:Filename requires a filename.\n");
+				return FALSE;
+			}
+		}
+		else if((strcmp(argv[i],"-help")==0)||(strcmp(argv[i],"-h")==0))
+		{
+			Help();
+			exit(0);
+		}
+		else if((strcmp(argv[i],"-info")==0)||(strcmp(argv[i],"-i")==0))
+		{
+			Info = TRUE;
+		}
+		else if((strcmp(argv[i],"-log_level")==0)||(strcmp(argv[i],"-l")==0))
+		{
+			if((i+1)<argc)
+			{
+				retval = sscanf(argv[i+1],"%d",&Log_Level);
+				if(retval != 1)
+				{
+					fprintf(stderr,"Parse_Arguments:Log Level was not an integer:%s.\n",argv[i+1]);
+					return FALSE;
+				}
+				i++;
+			}
+			else
+			{
+				fprintf(stderr,"Parse_Arguments:Log level requires a non-negative integer.\n");
+				return FALSE;
+			}
+		}
+		else if((strcmp(argv[i],"-max_count")==0)||(strcmp(argv[i],"-m")==0))
+		{
+			if((i+1)<argc)
+			{
+				retval = sscanf(argv[i+1],"%d",&Max_Count);
+				if((retval != 1)||(Max_Count < 1))
+				{
+					fprintf(stderr,"Parse_Arguments:Max count was not a positive integer:%s.\n",
+						argv[i+1]);
+					return FALSE;
+				}
+				i++;
+			}
+			else
+			{
+				fprintf(stderr,"Parse_Arguments:Max count requires a positive integer.\n");
+				return FALSE;
+			}
+		}
+		else if((strcmp(argv[i],"-start")==0)||(strcmp(argv[i],"-s")==0))
+		{
+			if((i+1)<argc)
+			{
+				retval = sscanf(argv[i+1],"%lf",&Start_Time);
+				if(retval != 1)
+				{
+					fprintf(stderr,"Parse_Arguments:Start time was not a number:%s.\n",argv[i+1]);
+					return FALSE;
+				}
+				i++;
+			}
+			else
+			{
+				fprintf(stderr,"Parse_Arguments:Start time requires a number.\n");
+				return FALSE;
+			}
+		}
+		else
+		{
+			fprintf(stderr,"Parse_Arguments:argument '%s' not recognized.\n",argv[i]);
+			return FALSE;
+		}
+	}
+	return TRUE;
+}
+
+/**
+ * Help routine.
+ */
+static void Help(void)
+{
+	fprintf(stdout,"CCD Telemetry Query:Help.\n");
+	fprintf(stdout,"CCD Telemetry Query prints records from a telemetry store ring file.\n");
+	fprintf(stdout,"ccd_telemetry_query -f[ilename] <filename>\n");
+	fprintf(stdout,"\t[-s[tart] <time>][-e[nd] <time>][-m[ax_count] <n>]\n");
+	fprintf(stdout,"\t[-i[nfo]][-l[og_level] <0..5>][-h[elp]]\n");
+	fprintf(stdout,"\n");
+	fprintf(stdout,"\t-filename is the telemetry store written by the instrument (o.ccd.telemetry.store.filename).\n");
+	fprintf(stdout,"\t-start and -end select the time range, the default is the last day.\n");
+	fprintf(stdout,"\t-max_count limits the number of records printed, records are averaged together "
+		"to fit (default %d).\n",DEFAULT_MAX_COUNT);
+	fprintf(stdout,"\t-info prints the size and time range of the store, and stops.\n");
+	fprintf(stdout,"\t-help prints out this message and stops the program.\n");
+	fprintf(stdout,"\n");
+	fprintf(stdout,"\t<time> is seconds since the epoch, or if negative, seconds before now (0 is now).\n");
+}
+
+/**
+ * Convert a time argument into a timespec. Times less than or equal to zero are relative to now.
+ * @param time_secs The time argument, in seconds.
+ * @param time_spec The address of a timespec to fill in.
+ */
+static void Time_Get(double time_secs,struct timespec *time_spec)
+{
+	struct timespec current_time;
+
+	if(time_secs <= 0.0)
+	{
+		clock_gettime(CLOCK_REALTIME,&current_time);
+		time_secs += ((double)current_time.tv_sec)+(((double)current_time.tv_nsec)/CCD_GLOBAL_ONE_SECOND_NS);
+	}
+	time_spec->tv_sec = (time_t)time_secs;
+	time_spec->tv_nsec = (long)((time_secs-((double)time_spec->tv_sec))*CCD_GLOBAL_ONE_SECOND_NS);
+}
+
+/**
+ * Convert a record time into an ISO 8601 UTC string, with milliseconds.
+ * @param time_sec The seconds since the epoch.
+ * @param time_nsec The nanoseconds.
+ * @param time_string A string of at least 32 characters to put the result in.
+ */
+static void Time_To_String(unsigned int time_sec,int time_nsec,char *time_string)
+{
+	struct tm *tm_time = NULL;
+	time_t seconds;
+
+	seconds = (time_t)time_sec;
+	tm_time = gmtime(&seconds);
+	strftime(time_string,32,"%Y-%m-%dT%H:%M:%S",tm_time);
+	sprintf(time_string+strlen(time_string),".%03d",time_nsec/CCD_GLOBAL_ONE_MILLISECOND_NS);
+}
+
+/*
+** $Log: not supported by cvs2svn $
+*/
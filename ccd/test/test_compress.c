@@ -0,0 +1,476 @@
+/* test_compress.c
+ * $Header$
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include "fitsio.h"
+#include "ccd_compress.h"
+#include "ccd_global.h"
+
+/**
+ * This program benchmarks saving images as tile-compressed FITS images, using the same ccd_compress code
+ * the instrument uses when o.ccd.compress.type is RICE. It does not talk to the controller.
+ * Each input file (i.e. real IO:O bias, flat and sky frames) is read, and saved to the output file:
+ * uncompressed (as Pixel_Stream_Save does), and then Rice compressed with 1,2,4.. threads up to the maximum thread
+ * count. For each save the time, throughput (uncompressed Mb/s) and compression ratio are printed,
+ * and the compressed image is read back and compared with the original, to check it is lossless.
+ * <pre>
+ * test_compress -i[nput] &lt;filename&gt; [-i[nput] &lt;filename&gt; ...] -o[utput] &lt;filename&gt;
+ * 	[-t[hread_count] &lt;n&gt;][-r[epeat] &lt;n&gt;][-l[og_level] &lt;n&gt;][-h[elp]]
+ * </pre>
+ * @author $Author$
+ * @version $Revision$
+ */
+/* hash definitions */
+/**
+ * Maximum length of some of the strings in this program.
+ */
+#define MAX_STRING_LENGTH	(256)
+/**
+ * The maximum number of input files.
+ */
+#define MAX_INPUT_COUNT		(16)
+
+/* internal variables */
+/**
+ * Revision control system identifier.
+ */
+static char rcsid[] = "$Id$";
+/**
+ * The log level to use.
+ */
+static int Log_Level = 0;
+/**
+ * The list of input FITS filenames.
+ */
+static char Input_Filename_List[MAX_INPUT_COUNT][MAX_STRING_LENGTH];
+/**
+ * The number of input FITS filenames.
+ */
+static int Input_Filename_Count = 0;
+/**
+ * The output FITS filename, overwritten by each save.
+ */
+static char Output_Filename[MAX_STRING_LENGTH] = "";
+/**
+ * The maximum number of compression threads to benchmark.
+ */
+static int Max_Thread_Count = CCD_COMPRESS_DEFAULT_THREAD_COUNT;
+/**
+ * The number of times to repeat each save. The fastest is reported.
+ */
+static int Repeat_Count = 3;
+
+/* internal routines */
+static int Parse_Arguments(int argc, char *argv[]);
+static void Help(void);
+static int Read_Image(char *filename,fitsfile **fp,unsigned short **image_data,int *ncols,int *nrows);
+static int Save_Headers(fitsfile *in_fp,char *filename);
+static int Save_Uncompressed(fitsfile *in_fp,char *filename,unsigned short *image_data,int ncols,int nrows);
+static int Verify_Compressed(char *filename,unsigned short *image_data,int ncols,int nrows);
+static void Print_Result(char *input_filename,char *type,int thread_count,double elapsed_time,int ncols,
+			 int nrows);
+
+/**
+ * Main program.
+ * @param argc The number of arguments to the program.
+ * @param argv An array of argument strings.
+ * @return This function returns 0 if the program succeeds, and a positive integer if it fails.
+ * @see #Input_Filename_List
+ * @see #Output_Filename
+ * @see #Max_Thread_Count
+ * @see #Repeat_Count
+ * @see #Read_Image
+ * @see #Save_Headers
+ * @see #Save_Uncompressed
+ * @see #Verify_Compressed
+ * @see #Print_Result
+ * @see ../cdocs/ccd_compress.html#CCD_Compress_Initialise
+ * @see ../cdocs/ccd_compress.html#CCD_Compress_Set_Config
+ * @see ../cdocs/ccd_compress.html#CCD_Compress_Save
+ */
+int main(int argc, char *argv[])
+{
+	struct timespec start_time,end_time;
+	fitsfile *in_fp = NULL;
+	unsigned short *image_data = NULL;
+	double elapsed_time,best_time;
+	int input_index,thread_count,repeat,ncols,nrows,status;
+
+	if(!Parse_Arguments(argc,argv))
+		return 1;
+	if((Input_Filename_Count == 0)||(strlen(Output_Filename) == 0))
+	{
+		fprintf(stderr,"test_compress:Input and output filenames must be specified.\n");
+		Help();
+		return 1;
+	}
+	/* we don't need to call CCD_Global_Initialise, as we are not talking to the controller */
+	CCD_Global_Set_Log_Handler_Function(CCD_Global_Log_Handler_Stdout);
+	CCD_Global_Set_Log_Filter_Function(CCD_Global_Log_Filter_Level_Absolute);
+	CCD_Global_Set_Log_Filter_Level(Log_Level);
+	CCD_Compress_Initialise();
+	fprintf(stdout,"# Input Type Threads Time(s) Throughput(Mb/s) Size(bytes) Ratio\n");
+	for(input_index = 0; input_index < Input_Filename_Count; input_index++)
+	{
+		if(!Read_Image(Input_Filename_List[input_index],&in_fp,&image_data,&ncols,&nrows))
+			return 2;
+		/* uncompressed */
+		best_time = 0.0;
+		for(repeat = 0; repeat < Repeat_Count; repeat++)
+		{
+			clock_gettime(CLOCK_REALTIME,&start_time);
+			if(!Save_Uncompressed(in_fp,Output_Filename,image_data,ncols,nrows))
+				return 3;
+			clock_gettime(CLOCK_REALTIME,&end_time);
+			elapsed_time = fdifftime(end_time,start_time);
+			if((repeat == 0)||(elapsed_time < best_time))
+				best_time = elapsed_time;
+		}
+		Print_Result(Input_Filename_List[input_index],"NONE",1,best_time,ncols,nrows);
+		/* Rice compressed, 1,2,4.. threads */
+		for(thread_count = 1; thread_count <= Max_Thread_Count; thread_count *= 2)
+		{
+			if(!CCD_Compress_Set_Config(CCD_COMPRESS_TYPE_RICE,thread_count))
+			{
+				CCD_Compress_Error();
+				return 4;
+			}
+			best_time = 0.0;
+			for(repeat = 0; repeat < Repeat_Count; repeat++)
+			{
+				/* the headers are written before the exposure, and are not part of the save time */
+				if(!Save_Headers(in_fp,Output_Filename))
+					return 5;
+				clock_gettime(CLOCK_REALTIME,&start_time);
+				if(!CCD_Compress_Save(Output_Filename,&image_data,1,ncols,nrows))
+				{
+					CCD_Compress_Error();
+					return 6;
+				}
+				clock_gettime(CLOCK_REALTIME,&end_time);
+				elapsed_time = fdifftime(end_time,start_time);
+				if((repeat == 0)||(elapsed_time < best_time))
+					best_time = elapsed_time;
+			}
+			Print_Result(Input_Filename_List[input_index],"RICE",thread_count,best_time,ncols,nrows);
+			if(!Verify_Compressed(Output_Filename,image_data,ncols,nrows))
+				return 7;
+		}
+		free(image_data);
+		status = 0;
+		fits_close_file(in_fp,&status);
+	}
+	return 0;
+}
+
+/**
+ * Routine to parse command line arguments.
+ * @param argc The number of arguments sent to the program.
+ * @param argv An array of argument strings.
+ * @see #Help
+ * @see #Input_Filename_List
+ * @see #Input_Filename_Count
+ * @see #Output_Filename
+ * @see #Max_Thread_Count
+ * @see #Repeat_Count
+ * @see #Log_Level
+ */
+static int Parse_Arguments(int argc, char *argv[])
+{
+	int i,retval;
+
+	for(i=1;i<argc;i++)
+	{
+		if((strcmp(argv[i],"-help")==0)||(strcmp(argv[i],"-h")==0))
+		{
+			Help();
+			exit(0);
+		}
+		else if((strcmp(argv[i],"-input")==0)||(strcmp(argv[i],"-i")==0))
+		{
+			if(((i+1)<argc)&&(Input_Filename_Count < MAX_INPUT_COUNT))
+			{
+				strncpy(Input_Filename_List[Input_Filename_Count],argv[i+1],MAX_STRING_LENGTH-1);
+				Input_Filename_List[Input_Filename_Count][MAX_STRING_LENGTH-1] = '\0';
+				Input_Filename_Count++;
+				i++;
+			}
+			else
+			{
+				fprintf(stderr,"Parse_Arguments:Input requires a filename (maximum %d).\n",
+					MAX_INPUT_COUNT);
+				return FALSE;
+			}
+		}
+		else if((strcmp(argv[i],"-log_level")==0)||(strcmp(argv[i],"-l")==0))
+		{
+			if((i+1)<argc)
+			{
+				retval = sscanf(argv[i+1],"%d",&Log_Level);
+				if(retval != 1)
+				{
+					fprintf(stderr,"Parse_Arguments:Log Level was not an integer:%s.\n",argv[i+1]);
+					return FALSE;
+				}
+				i++;
+			}
+			else
+			{
+				fprintf(stderr,"Parse_Arguments:Log level requires a non-negative integer.\n");
+				return FALSE;
+			}
+		}
+		else if((strcmp(argv[i],"-output")==0)||(strcmp(argv[i],"-o")==0))
+		{
+			if((i+1)<argc)
+			{
+				strncpy(Output_Filename,argv[i+1],MAX_STRING_LENGTH-1);
+				i++;
+			}
+			else
+			{
+				fprintf(stderr,"Parse_Arguments:Output requires a filename.\n");
+				return FALSE;
+			}
+		}
+		else if((strcmp(argv[i],"-repeat")==0)||(strcmp(argv[i],"-r")==0))
+		{
+			if((i+1)<argc)
+			{
+				retval = sscanf(argv[i+1],"%d",&Repeat_Count);
+				if((retval != 1)||(Repeat_Count < 1))
+				{
+					fprintf(stderr,"Parse_Arguments:Repeat was not a positive integer:%s.\n",argv[i+1]);
+					return FALSE;
+				}
+				i++;
+			}
+			else
+			{
+				fprintf(stderr,"Parse_Arguments:Repeat requires a positive integer.\n");
+				return FALSE;
+			}
+		}
+		else if((strcmp(argv[i],"-thread_count")==0)||(strcmp(argv[i],"-t")==0))
+		{
+			if((i+1)<argc)
+			{
+				retval = sscanf(argv[i+1],"%d",&Max_Thread_Count);
+				if((retval != 1)||(Max_Thread_Count < 1)||(Max_Thread_Count > CCD_COMPRESS_MAX_THREAD_COUNT))
+				{
+					fprintf(stderr,"Parse_Arguments:Thread count was not an integer (1..%d):%s.\n",
+						CCD_COMPRESS_MAX_THREAD_COUNT,argv[i+1]);
+					return FALSE;
+				}
+				i++;
+			}
+			else
+			{
+				fprintf(stderr,"Parse_Arguments:Thread count requires a positive integer.\n");
+				return FALSE;
+			}
+		}
+		else
+		{
+			fprintf(stderr,"Parse_Arguments:argument '%s' not recognized.\n",argv[i]);
+			return FALSE;
+		}
+	}
+	return TRUE;
+}
+
+/**
+ * Help routine.
+ */
+static void Help(void)
+{
+	fprintf(stdout,"Test Compress:Help.\n");
+	fprintf(stdout,"Test Compress benchmarks saving images uncompressed and Rice tile-compressed.\n");
+	fprintf(stdout,"test_compress -i[nput] <filename> [-i[nput] <filename> ...] -o[utput] <filename>\n");
+	fprintf(stdout,"\t[-t[hread_count] <n>][-r[epeat] <n>][-l[og_level] <0..5>][-h[elp]]\n");
+	fprintf(stdout,"\n");
+	fprintf(stdout,"\t-input is an uncompressed FITS image (i.e. a bias, flat or sky frame), up to %d can be given.\n",
+		MAX_INPUT_COUNT);
+	fprintf(stdout,"\t-output is overwritten by each save, put it on the disk the instrument writes to.\n");
+	fprintf(stdout,"\t-thread_count is the maximum number of compression threads (default %d).\n",
+		CCD_COMPRESS_DEFAULT_THREAD_COUNT);
+	fprintf(stdout,"\t-repeat is the number of times each save is repeated, the fastest is reported (default 3).\n");
+	fprintf(stdout,"\t-help prints out this message and stops the program.\n");
+}
+
+/**
+ * Read the primary image of a FITS file as unsigned shorts. The file is left open, so it's headers can be
+ * copied into the output file.
+ * @param filename The FITS filename.
+ * @param fp The address of a fitsfile pointer, set to the open file.
+ * @param image_data The address of a pointer, set to the allocated image data. This should be freed.
+ * @param ncols The address of an integer, set to the number of columns.
+ * @param nrows The address of an integer, set to the number of rows.
+ * @return The routine returns TRUE on success and FALSE on failure.
+ */
+static int Read_Image(char *filename,fitsfile **fp,unsigned short **image_data,int *ncols,int *nrows)
+{
+	long axes_list[2];
+	int status = 0;
+
+	if(fits_open_file(fp,filename,READONLY,&status))
+	{
+		fits_report_error(stderr,status);
+		return FALSE;
+	}
+	if(fits_get_img_size(*fp,2,axes_list,&status))
+	{
+		fits_report_error(stderr,status);
+		fits_close_file(*fp,&status);
+		return FALSE;
+	}
+	(*ncols) = axes_list[0];
+	(*nrows) = axes_list[1];
+	(*image_data) = (unsigned short *)malloc(((size_t)(*ncols))*((size_t)(*nrows))*sizeof(unsigned short));
+	if((*image_data) == NULL)
+	{
+		fprintf(stderr,"Read_Image:Failed to allocate image data (%d,%d).\n",(*ncols),(*nrows));
+		fits_close_file(*fp,&status);
+		return FALSE;
+	}
+	if(fits_read_img(*fp,TUSHORT,1,(*ncols)*(*nrows),NULL,(*image_data),NULL,&status))
+	{
+		fits_report_error(stderr,status);
+		free(*image_data);
+		fits_close_file(*fp,&status);
+		return FALSE;
+	}
+	return TRUE;
+}
+
+/**
+ * Create a new FITS file containing a copy of the input file's primary headers, as the Java layer does before
+ * each exposure.
+ * @param in_fp The open input file.
+ * @param filename The filename to create (overwritten if it exists).
+ * @return The routine returns TRUE on success and FALSE on failure.
+ */
+static int Save_Headers(fitsfile *in_fp,char *filename)
+{
+	fitsfile *out_fp = NULL;
+	char create_filename[MAX_STRING_LENGTH+1];
+	int status = 0;
+
+	sprintf(create_filename,"!%s",filename);
+	fits_create_file(&out_fp,create_filename,&status);
+	fits_copy_header(in_fp,out_fp,&status);
+	fits_close_file(out_fp,&status);
+	if(status)
+	{
+		fits_report_error(stderr,status);
+		return FALSE;
+	}
+	return TRUE;
+}
+
+/**
+ * Save the image uncompressed, as Pixel_Stream_Save does: the headers are written, then the file re-opened
+ * and the image data written.
+ * @param in_fp The open input file.
+ * @param filename The filename to save to (overwritten if it exists).
+ * @param image_data The image data.
+ * @param ncols The number of columns.
+ * @param nrows The number of rows.
+ * @return The routine returns TRUE on success and FALSE on failure.
+ * @see #Save_Headers
+ */
+static int Save_Uncompressed(fitsfile *in_fp,char *filename,unsigned short *image_data,int ncols,int nrows)
+{
+	fitsfile *out_fp = NULL;
+	int status = 0;
+
+	if(!Save_Headers(in_fp,filename))
+		return FALSE;
+	fits_open_file(&out_fp,filename,READWRITE,&status);
+	fits_write_img(out_fp,TUSHORT,1,ncols*nrows,image_data,&status);
+	fits_close_file(out_fp,&status);
+	if(status)
+	{
+		fits_report_error(stderr,status);
+		return FALSE;
+	}
+	return TRUE;
+}
+
+/**
+ * Read back the compressed image (HDU 2), and check it is identical to the original.
+ * @param filename The compressed filename.
+ * @param image_data The original image data.
+ * @param ncols The number of columns.
+ * @param nrows The number of rows.
+ * @return The routine returns TRUE if the images are identical, and FALSE if they differ or an error occurs.
+ */
+static int Verify_Compressed(char *filename,unsigned short *image_data,int ncols,int nrows)
+{
+	fitsfile *fp = NULL;
+	unsigned short *read_data = NULL;
+	size_t pixel_count,i;
+	int status = 0;
+
+	pixel_count = ((size_t)ncols)*((size_t)nrows);
+	read_data = (unsigned short *)malloc(pixel_count*sizeof(unsigned short));
+	if(read_data == NULL)
+	{
+		fprintf(stderr,"Verify_Compressed:Failed to allocate image data (%d,%d).\n",ncols,nrows);
+		return FALSE;
+	}
+	fits_open_file(&fp,filename,READONLY,&status);
+	fits_movabs_hdu(fp,2,NULL,&status);
+	fits_read_img(fp,TUSHORT,1,pixel_count,NULL,read_data,NULL,&status);
+	fits_close_file(fp,&status);
+	if(status)
+	{
+		fits_report_error(stderr,status);
+		free(read_data);
+		return FALSE;
+	}
+	for(i = 0; i < pixel_count; i++)
+	{
+		if(read_data[i] != image_data[i])
+		{
+			fprintf(stderr,"Verify_Compressed:%s differs at pixel %lu (%hu != %hu).\n",filename,
+				(unsigned long)i,read_data[i],image_data[i]);
+			free(read_data);
+			return FALSE;
+		}
+	}
+	free(read_data);
+	return TRUE;
+}
+
+/**
+ * Print a benchmark result line: the input filename, compression type, thread count, time, throughput
+ * (uncompressed megabytes per second), size of the output file and compression ratio.
+ * @param input_filename The input filename.
+ * @param type The compression type string.
+ * @param thread_count The number of compression threads.
+ * @param elapsed_time The (fastest) save time, in seconds.
+ * @param ncols The number of columns.
+ * @param nrows The number of rows.
+ * @see #Output_Filename
+ */
+static void Print_Result(char *input_filename,char *type,int thread_count,double elapsed_time,int ncols,
+			 int nrows)
+{
+	struct stat stat_buffer;
+	double image_size;
+
+	image_size = ((double)ncols)*((double)nrows)*sizeof(unsigned short);
+	if(stat(Output_Filename,&stat_buffer) != 0)
+		stat_buffer.st_size = 0;
+	fprintf(stdout,"%s %s %d %.4f %.1f %ld %.3f\n",input_filename,type,thread_count,elapsed_time,
+		(elapsed_time > 0.0) ? (image_size/(1024.0*1024.0))/elapsed_time : 0.0,(long)stat_buffer.st_size,
+		(stat_buffer.st_size > 0) ? image_size/((double)stat_buffer.st_size) : 0.0);
+}
+/*
+** $Log: not supported by cvs2svn $
+*/
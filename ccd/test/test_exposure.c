@@ -31,7 +31,7 @@
  *      [-pixel_stream_entry &lt;amplifier&gt; &lt;pixel stream&gt; &lt;is_split_serial&gt;]
  * 	[-w[indow] &lt;no&gt; &lt;xstart&gt; &lt;ystart&gt; &lt;xend&gt; &lt;yend&gt;]
  * 	[-b[ias]][-d[ark] &lt;exposure length&gt;][-e[xpose] &lt;exposure length&gt;]\n");
- * 	[-f[ilename] &lt;filename&gt;]
+ * 	[-f[ilename] &lt;filename&gt;][-start_delay &lt;delay&gt;]
  * 	[-t[ext_print_level] &lt;commands|replies|values|all&gt;][-h[elp]]
  * </pre>
  * @author $Author: cjm $
@@ -174,6 +174,11 @@ static enum COMMAND_ID Command = COMMAND_ID_NONE;
  * If doing a dark or exposure, the exposure length.
  */
 static int Exposure_Length = 0;
+/**
+ * If doing a dark or exposure, how long after the command is issued to schedule the exposure start,
+ * in milliseconds. If zero, the exposure starts as soon as possible.
+ */
+static int Start_Delay = 0;
 /**
  * Filename to store resultant fits image in. Unwindowed only - windowed get more complex.
  */
@@ -226,7 +231,9 @@ static void Test_Fits_Header_Error(int status);
  * @see #Window_List
  * @see #Command
  * @see #Exposure_Length
+ * @see #Start_Delay
  * @see #Filename
+ * @see ccd_exposure.html#CCD_Exposure_Get_Start_Error
  */
 int main(int argc, char *argv[])
 {
@@ -238,6 +245,7 @@ int main(int argc, char *argv[])
 	int filename_count,i;
 	int retval;
 	int value,bit_value;
+	double start_error;
 
 /* parse arguments */
 	fprintf(stdout,"Parsing Arguments.\n");
@@ -365,6 +373,18 @@ int main(int argc, char *argv[])
 /* do command */
 	start_time.tv_sec = 0;
 	start_time.tv_nsec = 0;
+	if((Start_Delay > 0)&&(Command != COMMAND_ID_BIAS))
+	{
+		clock_gettime(CLOCK_REALTIME,&start_time);
+		start_time.tv_sec += Start_Delay/1000;
+		start_time.tv_nsec += (Start_Delay%1000)*1000000;
+		if(start_time.tv_nsec >= 1000000000)
+		{
+			start_time.tv_sec++;
+			start_time.tv_nsec -= 1000000000;
+		}
+		fprintf(stdout,"Scheduling exposure start %d milliseconds from now.\n",Start_Delay);
+	}
 	switch(Command)
 	{
 		case COMMAND_ID_BIAS:
@@ -394,6 +414,8 @@ int main(int argc, char *argv[])
 		return 6;
 	}
 	fprintf(stdout,"Command Completed.\n");
+	if(CCD_Exposure_Get_Start_Error(handle,&start_error))
+		fprintf(stdout,"Exposure started %.3f milliseconds late.\n",start_error*1000.0);
 /* close interface to SDSU controller */
 	fprintf(stdout,"CCD_Interface_Close\n");
 	CCD_Interface_Close(&handle);
@@ -430,6 +452,7 @@ int main(int argc, char *argv[])
  * @see #Window_List
  * @see #Command
  * @see #Exposure_Length
+ * @see #Start_Delay
  * @see #Filename
  * @see #Log_Filter_Level
  * @see ccd_dsp.html#CCD_DSP_AMPLIFIER
@@ -571,6 +594,24 @@ static int Parse_Arguments(int argc, char *argv[])
 			}
 
 		}
+		else if(strcmp(argv[i],"-start_delay")==0)
+		{
+			if((i+1)<argc)
+			{
+				retval = sscanf(argv[i+1],"%d",&Start_Delay);
+				if((retval != 1)||(Start_Delay < 0))
+				{
+					fprintf(stderr,"Parse_Arguments:Parsing start delay %s failed.\n",argv[i+1]);
+					return FALSE;
+				}
+				i++;
+			}
+			else
+			{
+				fprintf(stderr,"Parse_Arguments:start delay requires a delay.\n");
+				return FALSE;
+			}
+		}
 		else if((strcmp(argv[i],"-filename")==0)||(strcmp(argv[i],"-f")==0))
 		{
 			if((i+1)<argc)
@@ -1036,7 +1077,7 @@ static void Help(void)
 	fprintf(stdout,"\t\tdummybottomleft|dummybottomright|dummytopleft|dummytopright>]\n");
 	fprintf(stdout,"\t[-pixel_stream_entry <amplifier> <pixel stream> <is_split_serial>]\n");
 	fprintf(stdout,"\t[-w[indow] <no> <xstart> <ystart> <xend> <yend>]\n");
-	fprintf(stdout,"\t[-f[ilename] <filename>][-noclear|-nc]\n");
+	fprintf(stdout,"\t[-f[ilename] <filename>][-noclear|-nc][-start_delay <delay>]\n");
 	fprintf(stdout,"\t[-b[ias]][-d[ark] <exposure length>][-e[xpose] <exposure length>]\n");
 	fprintf(stdout,"\t[-t[ext_print_level] <commands|replies|values|all>][-h[elp]]\n");
 	fprintf(stdout,"\t[-log_level <0-5>]\n");
@@ -1047,6 +1088,8 @@ static void Help(void)
 	fprintf(stdout,"\t-setup calls CCD_Setup_Startup, which needs the "
 		"-pci_filename|-timing_filename|-utility_filename|-temperature|-gain arguments.\n");
 	fprintf(stdout,"\t-noclear does NOT clea the array before starting an exposure.\n");
+	fprintf(stdout,"\t-start_delay schedules a dark or exposure to start <delay> milliseconds after "
+		"the command is issued, and prints how late it started.\n");
 	fprintf(stdout,"\t-help prints out this message and stops the program.\n");
 	fprintf(stdout,"\n");
 	fprintf(stdout,"\t<filename> should be a valid .lod file pathname.\n");
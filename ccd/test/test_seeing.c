@@ -0,0 +1,508 @@
+/* test_seeing.c
+ * $Header$
+ */
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "ccd_global.h"
+#include "ccd_seeing.h"
+#include "ccd_source_find.h"
+
+/**
+ * This program tests the ccd_seeing FWHM estimator against synthetic frames, using the same code the instrument
+ * runs on each de-interlaced frame after readout. It does not talk to the controller (the text device only
+ * returns a ramp, which has no sources in it).
+ * A synthetic frame is made, with a background, read noise and photon noise, and a number of elliptical Gaussian
+ * stars of the specified FWHM and ellipticity at random positions and fluxes. Some stars are made bright enough
+ * to saturate, and some hot pixels are added, to check these are rejected. The estimator is then run with 1,2,4..
+ * threads up to the maximum thread count, and the measured median FWHM, ellipticity, source count and time taken
+ * are printed. The program fails if the measured FWHM is not within the tolerance of the input FWHM.
+ * <pre>
+ * test_seeing [-c[olumns] &lt;n&gt;][-r[ows] &lt;n&gt;][-f[whm] &lt;pixels&gt;][-e[llipticity] &lt;e&gt;]
+ * 	[-s[tar_count] &lt;n&gt;][-b[ackground] &lt;counts&gt;][-t[hread_count] &lt;n&gt;][-seed &lt;n&gt;]
+ * 	[-tolerance &lt;fraction&gt;][-l[og_level] &lt;n&gt;][-h[elp]]
+ * </pre>
+ * @author $Author$
+ * @version $Revision$
+ */
+/* hash definitions */
+/**
+ * Conversion factor from a Gaussian's FWHM to it's standard deviation.
+ */
+#define FWHM_TO_SIGMA		(1.0/2.35482)
+/**
+ * The read noise added to each pixel, in counts.
+ */
+#define READ_NOISE		(5.0)
+/**
+ * The gain used to compute the photon noise, in electrons per count.
+ */
+#define GAIN			(2.0)
+/**
+ * The number of hot pixels added to the frame.
+ */
+#define HOT_PIXEL_COUNT		(200)
+/**
+ * One star in this many is made bright enough to saturate.
+ */
+#define SATURATED_STAR_RATIO	(10)
+
+/* internal variables */
+/**
+ * Revision control system identifier.
+ */
+static char rcsid[] = "$Id$";
+/**
+ * The log level to use.
+ */
+static int Log_Level = 0;
+/**
+ * The number of columns in the synthetic frame.
+ */
+static int NCols = 2048;
+/**
+ * The number of rows in the synthetic frame.
+ */
+static int NRows = 2048;
+/**
+ * The FWHM of the synthetic stars, in pixels (geometric mean of the major and minor axes).
+ */
+static double FWHM = 4.0;
+/**
+ * The ellipticity (1 - minor/major axis) of the synthetic stars.
+ */
+static double Ellipticity = 0.1;
+/**
+ * The number of synthetic stars.
+ */
+static int Star_Count = 200;
+/**
+ * The background level of the synthetic frame, in counts.
+ */
+static double Background = 1000.0;
+/**
+ * The maximum number of estimator threads to test.
+ */
+static int Max_Thread_Count = CCD_SEEING_DEFAULT_THREAD_COUNT;
+/**
+ * The random number seed.
+ */
+static unsigned int Seed = 1;
+/**
+ * The fraction of the input FWHM the measured FWHM must be within.
+ */
+static double Tolerance = 0.05;
+
+/* internal routines */
+static int Parse_Arguments(int argc, char *argv[]);
+static void Help(void);
+static void Make_Frame(unsigned short *image_data);
+static double Random_Uniform(void);
+static double Random_Normal(void);
+
+/**
+ * Main program.
+ * @param argc The number of arguments to the program.
+ * @param argv An array of argument strings.
+ * @return This function returns 0 if the program succeeds, and a positive integer if it fails.
+ * @see #Make_Frame
+ * @see #Max_Thread_Count
+ * @see #Tolerance
+ * @see ../cdocs/ccd_seeing.html#CCD_Seeing_Initialise
+ * @see ../cdocs/ccd_seeing.html#CCD_Seeing_Set_Config
+ * @see ../cdocs/ccd_seeing.html#CCD_Seeing_Measure
+ */
+int main(int argc, char *argv[])
+{
+	struct CCD_Seeing_Result_Struct result;
+	unsigned short *image_data = NULL;
+	int thread_count,retval;
+
+	if(!Parse_Arguments(argc,argv))
+		return 1;
+	/* we don't need to call CCD_Global_Initialise, as we are not talking to the controller */
+	CCD_Global_Set_Log_Handler_Function(CCD_Global_Log_Handler_Stdout);
+	CCD_Global_Set_Log_Filter_Function(CCD_Global_Log_Filter_Level_Absolute);
+	CCD_Global_Set_Log_Filter_Level(Log_Level);
+	CCD_Source_Find_Initialise();
+	CCD_Seeing_Initialise();
+	image_data = (unsigned short *)malloc(NCols*NRows*sizeof(unsigned short));
+	if(image_data == NULL)
+	{
+		fprintf(stderr,"test_seeing:Failed to allocate frame (%d,%d).\n",NCols,NRows);
+		return 2;
+	}
+	srand(Seed);
+	Make_Frame(image_data);
+	fprintf(stdout,"# Frame (%d,%d) background %.1f:%d stars:FWHM %.3f pixels:ellipticity %.3f.\n",NCols,NRows,
+		Background,Star_Count,FWHM,Ellipticity);
+	fprintf(stdout,"# Threads Candidates Sources Fitted FWHM FWHM_Sigma Moment_FWHM Ellipticity Time(s)\n");
+	retval = 0;
+	for(thread_count = 1; thread_count <= Max_Thread_Count; thread_count *= 2)
+	{
+		if(!CCD_Seeing_Set_Config(CCD_SEEING_DEFAULT_THRESHOLD_SIGMA,CCD_SEEING_DEFAULT_CUTOUT_RADIUS,
+					  CCD_SEEING_DEFAULT_SATURATION_COUNTS,CCD_SEEING_DEFAULT_MAX_SOURCE_COUNT,
+					  thread_count))
+		{
+			CCD_Seeing_Error();
+			return 3;
+		}
+		if(!CCD_Seeing_Measure(image_data,NCols,NRows,&result))
+		{
+			CCD_Seeing_Error();
+			CCD_Source_Find_Error();
+			return 4;
+		}
+		fprintf(stdout,"%d %d %d %d %.3f %.3f %.3f %.3f %.4f\n",thread_count,result.Candidate_Count,
+			result.Source_Count,result.Fit_Count,result.FWHM,result.FWHM_Sigma,result.Moment_FWHM,
+			result.Ellipticity,result.Elapsed_Time);
+		if((result.Source_Count == 0)||(fabs(result.FWHM-FWHM) > (Tolerance*FWHM)))
+		{
+			fprintf(stderr,"test_seeing:Measured FWHM %.3f with %d threads not within %.1f%% of %.3f.\n",
+				result.FWHM,thread_count,Tolerance*100.0,FWHM);
+			retval = 5;
+		}
+	}
+	free(image_data);
+	return retval;
+}
+
+/**
+ * Routine to parse command line arguments.
+ * @param argc The number of arguments sent to the program.
+ * @param argv An array of argument strings.
+ * @see #Help
+ * @see #NCols
+ * @see #NRows
+ * @see #FWHM
+ * @see #Ellipticity
+ * @see #Star_Count
+ * @see #Background
+ * @see #Max_Thread_Count
+ * @see #Seed
+ * @see #Tolerance
+ * @see #Log_Level
+ */
+static int Parse_Arguments(int argc, char *argv[])
+{
+	int i,retval;
+
+	for(i=1;i<argc;i++)
+	{
+		if((strcmp(argv[i],"-background")==0)||(strcmp(argv[i],"-b")==0))
+		{
+			if((i+1)<argc)
+			{
+				retval = sscanf(argv[i+1],"%lf",&Background);
+				if((retval != 1)||(Background < 0.0))
+				{
+					fprintf(stderr,"Parse_Arguments:Background was not a positive number:%s.\n",
+						argv[i+1]);
+					return FALSE;
+				}
+				i++;
+			}
+			else
+			{
+				fprintf(stderr,"Parse_Arguments:Background requires a number of counts.\n");
+				return FALSE;
+			}
+		}
+		else if((strcmp(argv[i],"-columns")==0)||(strcmp(argv[i],"-c")==0))
+		{
+			if((i+1)<argc)
+			{
+				retval = sscanf(argv[i+1],"%d",&NCols);
+				if((retval != 1)||(NCols < 1))
+				{
+					fprintf(stderr,"Parse_Arguments:Columns was not a positive integer:%s.\n",argv[i+1]);
+					return FALSE;
+				}
+				i++;
+			}
+			else
+			{
+				fprintf(stderr,"Parse_Arguments:Columns requires a positive integer.\n");
+				return FALSE;
+			}
+		}
+		else if((strcmp(argv[i],"-ellipticity")==0)||(strcmp(argv[i],"-e")==0))
+		{
+			if((i+1)<argc)
+			{
+				retval = sscanf(argv[i+1],"%lf",&Ellipticity);
+				if((retval != 1)||(Ellipticity < 0.0)||(Ellipticity >= 1.0))
+				{
+					fprintf(stderr,"Parse_Arguments:Ellipticity was not a number (0..1):%s.\n",
+						argv[i+1]);
+					return FALSE;
+				}
+				i++;
+			}
+			else
+			{
+				fprintf(stderr,"Parse_Arguments:Ellipticity requires a number.\n");
+				return FALSE;
+			}
+		}
+		else if((strcmp(argv[i],"-fwhm")==0)||(strcmp(argv[i],"-f")==0))
+		{
+			if((i+1)<argc)
+			{
+				retval = sscanf(argv[i+1],"%lf",&FWHM);
+				if((retval != 1)||(FWHM <= 0.0))
+				{
+					fprintf(stderr,"Parse_Arguments:FWHM was not a positive number:%s.\n",argv[i+1]);
+					return FALSE;
+				}
+				i++;
+			}
+			else
+			{
+				fprintf(stderr,"Parse_Arguments:FWHM requires a number of pixels.\n");
+				return FALSE;
+			}
+		}
+		else if((strcmp(argv[i],"-help")==0)||(strcmp(argv[i],"-h")==0))
+		{
+			Help();
+			exit(0);
+		}
+		else if((strcmp(argv[i],"-log_level")==0)||(strcmp(argv[i],"-l")==0))
+		{
+			if((i+1)<argc)
+			{
+				retval = sscanf(argv[i+1],"%d",&Log_Level);
+				if(retval != 1)
+				{
+					fprintf(stderr,"Parse_Arguments:Log Level was not an integer:%s.\n",argv[i+1]);
+					return FALSE;
+				}
+				i++;
+			}
+			else
+			{
+				fprintf(stderr,"Parse_Arguments:Log level requires a non-negative integer.\n");
+				return FALSE;
+			}
+		}
+		else if((strcmp(argv[i],"-rows")==0)||(strcmp(argv[i],"-r")==0))
+		{
+			if((i+1)<argc)
+			{
+				retval = sscanf(argv[i+1],"%d",&NRows);
+				if((retval != 1)||(NRows < 1))
+				{
+					fprintf(stderr,"Parse_Arguments:Rows was not a positive integer:%s.\n",argv[i+1]);
+					return FALSE;
+				}
+				i++;
+			}
+			else
+			{
+				fprintf(stderr,"Parse_Arguments:Rows requires a positive integer.\n");
+				return FALSE;
+			}
+		}
+		else if(strcmp(argv[i],"-seed")==0)
+		{
+			if((i+1)<argc)
+			{
+				retval = sscanf(argv[i+1],"%u",&Seed);
+				if(retval != 1)
+				{
+					fprintf(stderr,"Parse_Arguments:Seed was not an integer:%s.\n",argv[i+1]);
+					return FALSE;
+				}
+				i++;
+			}
+			else
+			{
+				fprintf(stderr,"Parse_Arguments:Seed requires an integer.\n");
+				return FALSE;
+			}
+		}
+		else if((strcmp(argv[i],"-star_count")==0)||(strcmp(argv[i],"-s")==0))
+		{
+			if((i+1)<argc)
+			{
+				retval = sscanf(argv[i+1],"%d",&Star_Count);
+				if((retval != 1)||(Star_Count < 1))
+				{
+					fprintf(stderr,"Parse_Arguments:Star count was not a positive integer:%s.\n",
+						argv[i+1]);
+					return FALSE;
+				}
+				i++;
+			}
+			else
+			{
+				fprintf(stderr,"Parse_Arguments:Star count requires a positive integer.\n");
+				return FALSE;
+			}
+		}
+		else if((strcmp(argv[i],"-thread_count")==0)||(strcmp(argv[i],"-t")==0))
+		{
+			if((i+1)<argc)
+			{
+				retval = sscanf(argv[i+1],"%d",&Max_Thread_Count);
+				if((retval != 1)||(Max_Thread_Count < 1)||(Max_Thread_Count > CCD_SEEING_MAX_THREAD_COUNT))
+				{
+					fprintf(stderr,"Parse_Arguments:Thread count was not an integer (1..%d):%s.\n",
+						CCD_SEEING_MAX_THREAD_COUNT,argv[i+1]);
+					return FALSE;
+				}
+				i++;
+			}
+			else
+			{
+				fprintf(stderr,"Parse_Arguments:Thread count requires a positive integer.\n");
+				return FALSE;
+			}
+		}
+		else if(strcmp(argv[i],"-tolerance")==0)
+		{
+			if((i+1)<argc)
+			{
+				retval = sscanf(argv[i+1],"%lf",&Tolerance);
+				if((retval != 1)||(Tolerance <= 0.0))
+				{
+					fprintf(stderr,"Parse_Arguments:Tolerance was not a positive number:%s.\n",
+						argv[i+1]);
+					return FALSE;
+				}
+				i++;
+			}
+			else
+			{
+				fprintf(stderr,"Parse_Arguments:Tolerance requires a fraction.\n");
+				return FALSE;
+			}
+		}
+		else
+		{
+			fprintf(stderr,"Parse_Arguments:argument '%s' not recognized.\n",argv[i]);
+			return FALSE;
+		}
+	}
+	return TRUE;
+}
+
+/**
+ * Help routine.
+ */
+static void Help(void)
+{
+	fprintf(stdout,"Test Seeing:Help.\n");
+	fprintf(stdout,"Test Seeing runs the seeing estimator on a synthetic star field.\n");
+	fprintf(stdout,"test_seeing [-c[olumns] <n>][-r[ows] <n>][-f[whm] <pixels>][-e[llipticity] <e>]\n");
+	fprintf(stdout,"\t[-s[tar_count] <n>][-b[ackground] <counts>][-t[hread_count] <n>][-seed <n>]\n");
+	fprintf(stdout,"\t[-tolerance <fraction>][-l[og_level] <0..5>][-h[elp]]\n");
+	fprintf(stdout,"\n");
+	fprintf(stdout,"\t-fwhm is the geometric mean of the major and minor axes FWHM, in pixels.\n");
+	fprintf(stdout,"\t-ellipticity is 1 - minor/major axis.\n");
+	fprintf(stdout,"\t-thread_count is the maximum number of estimator threads (default %d).\n",
+		CCD_SEEING_DEFAULT_THREAD_COUNT);
+	fprintf(stdout,"\t-tolerance is the fraction of the FWHM the measured FWHM must be within (default %.2f).\n",
+		Tolerance);
+}
+
+/**
+ * Make the synthetic frame. Each pixel is the background, plus the sum of the stars, plus photon and read noise.
+ * Each star is an elliptical Gaussian with major axis sigma FWHM_TO_SIGMA*FWHM/sqrt(1-Ellipticity) and minor
+ * axis sigma FWHM_TO_SIGMA*FWHM*sqrt(1-Ellipticity), at a random angle, with a random peak between 10 and 500
+ * times the read noise. One star in SATURATED_STAR_RATIO has a peak of 100000 counts, so it saturates.
+ * Stars are only added to pixels within 5 sigma of their centre. HOT_PIXEL_COUNT single hot pixels are then added.
+ * @param image_data The frame to fill in, NCols by NRows.
+ * @see #NCols
+ * @see #NRows
+ * @see #FWHM
+ * @see #Ellipticity
+ * @see #Star_Count
+ * @see #Background
+ * @see #Random_Uniform
+ * @see #Random_Normal
+ */
+static void Make_Frame(unsigned short *image_data)
+{
+	double *model = NULL;
+	double major_sigma,minor_sigma,angle,x_centre,y_centre,peak,dx,dy,u,v,value,cos_angle,sin_angle;
+	int star,x,y,x_min,x_max,y_min,y_max,extent;
+
+	model = (double *)malloc(NCols*NRows*sizeof(double));
+	if(model == NULL)
+	{
+		fprintf(stderr,"Make_Frame:Failed to allocate model.\n");
+		exit(2);
+	}
+	for(x = 0; x < (NCols*NRows); x++)
+		model[x] = Background;
+	major_sigma = FWHM_TO_SIGMA*FWHM/sqrt(1.0-Ellipticity);
+	minor_sigma = FWHM_TO_SIGMA*FWHM*sqrt(1.0-Ellipticity);
+	extent = (int)ceil(5.0*major_sigma);
+	for(star = 0; star < Star_Count; star++)
+	{
+		x_centre = Random_Uniform()*NCols;
+		y_centre = Random_Uniform()*NRows;
+		angle = Random_Uniform()*M_PI;
+		cos_angle = cos(angle);
+		sin_angle = sin(angle);
+		if((star % SATURATED_STAR_RATIO) == 0)
+			peak = 100000.0;
+		else
+			peak = READ_NOISE*(10.0+(490.0*Random_Uniform()));
+		x_min = (int)x_centre-extent;
+		x_max = (int)x_centre+extent;
+		y_min = (int)y_centre-extent;
+		y_max = (int)y_centre+extent;
+		for(y = (y_min < 0) ? 0 : y_min; (y <= y_max)&&(y < NRows); y++)
+		{
+			for(x = (x_min < 0) ? 0 : x_min; (x <= x_max)&&(x < NCols); x++)
+			{
+				dx = ((double)x)-x_centre;
+				dy = ((double)y)-y_centre;
+				u = (dx*cos_angle)+(dy*sin_angle);
+				v = (dy*cos_angle)-(dx*sin_angle);
+				model[(y*NCols)+x] += peak*exp(-0.5*(((u*u)/(major_sigma*major_sigma))+
+								     ((v*v)/(minor_sigma*minor_sigma))));
+			}
+		}
+	}
+	for(x = 0; x < (NCols*NRows); x++)
+	{
+		value = model[x]+(Random_Normal()*sqrt((READ_NOISE*READ_NOISE)+(model[x]/GAIN)));
+		if(value < 0.0)
+			value = 0.0;
+		if(value > 65535.0)
+			value = 65535.0;
+		image_data[x] = (unsigned short)value;
+	}
+	for(star = 0; star < HOT_PIXEL_COUNT; star++)
+		image_data[(int)(Random_Uniform()*(NCols*NRows))] = 30000;
+	free(model);
+}
+
+/**
+ * Return a uniformly distributed random number.
+ * @return A random number, from 0 up to (but not including) 1.
+ */
+static double Random_Uniform(void)
+{
+	return ((double)rand())/(((double)RAND_MAX)+1.0);
+}
+
+/**
+ * Return a normally distributed random number, using the Box-Muller transform.
+ * @return A random number, with a mean of 0 and standard deviation of 1.
+ * @see #Random_Uniform
+ */
+static double Random_Normal(void)
+{
+	return sqrt(-2.0*log(1.0-Random_Uniform()))*cos(2.0*M_PI*Random_Uniform());
+}
+
+/*
+** $Log: not supported by cvs2svn $
+*/
@@ -167,6 +167,33 @@ public class ACQUIREImplementation extends FITSImplementation implements JMSComm
 	 * and exit with an error.
 	 */
 	protected int maximumOffsetCount = 10;
+	/**
+	 * Whether to use the libo_ccd source finder to find the brightest object in brightest mode, rather than
+	 * sending each frame to the Real Time Data Pipeline.
+	 */
+	protected boolean sourceFind = false;
+	/**
+	 * How many background standard deviations above the background a pixel must be, for the source finder to
+	 * consider it part of an object.
+	 */
+	protected double sourceFindThresholdSigma = 5.0;
+	/**
+	 * The minimum number of connected pixels the source finder requires an object to have.
+	 */
+	protected int sourceFindMinPixelCount = 4;
+	/**
+	 * The number of threads the source finder splits each frame into.
+	 */
+	protected int sourceFindThreadCount = 4;
+	/**
+	 * Whether, in brightest mode, frames taken after the first offset are read out as a window
+	 * (region of interest) around the target pixel, rather than as full frames. Only used if sourceFind is true.
+	 */
+	protected boolean window = false;
+	/**
+	 * The width and height of the region of interest, in unbinned pixels.
+	 */
+	protected int windowSize = 512;
 
 	/**
 	 * Constructor.
@@ -404,6 +431,16 @@ public class ACQUIREImplementation extends FITSImplementation implements JMSComm
 	 *     <b>o.acquire.exposure_length.wcs</b> depending on <i>acquisitionMode</i></dd>
 	 * <dt>frameOverhead</dt><dd>Loaded from the <b>o.acquire.frame_overhead</b></dd>
 	 * <dt>maximumOffsetCount</dt><dd>Loaded from the <b>o.acquire.offset.count.maximum</b></dd>
+	 * <dt>sourceFind</dt><dd>Loaded from the <b>o.acquire.brightest.source_find</b>, false if not present.</dd>
+	 * <dt>sourceFindThresholdSigma</dt><dd>Loaded from the <b>o.acquire.brightest.source_find.threshold.sigma</b>,
+	 *     if sourceFind is true.</dd>
+	 * <dt>sourceFindMinPixelCount</dt><dd>Loaded from the 
+	 *     <b>o.acquire.brightest.source_find.pixel_count.minimum</b>, if sourceFind is true.</dd>
+	 * <dt>sourceFindThreadCount</dt><dd>Loaded from the <b>o.acquire.brightest.source_find.thread_count</b>,
+	 *     if sourceFind is true.</dd>
+	 * <dt>window</dt><dd>Loaded from the <b>o.acquire.brightest.window</b>, false if not present, 
+	 *     or if sourceFind is false.</dd>
+	 * <dt>windowSize</dt><dd>Loaded from the <b>o.acquire.brightest.window.size</b>, if window is true.</dd>
 	 * </dl>
 	 * @exception NumberFormatException Thrown if the specified property is not a valid number.
 	 * @see #bin
@@ -417,7 +454,15 @@ public class ACQUIREImplementation extends FITSImplementation implements JMSComm
 	 * @see #frameOverhead
 	 * @see #maximumOffsetCount
 	 * @see #acquisitionMode
+	 * @see #sourceFind
+	 * @see #sourceFindThresholdSigma
+	 * @see #sourceFindMinPixelCount
+	 * @see #sourceFindThreadCount
+	 * @see #window
+	 * @see #windowSize
 	 * @see OStatus#getPropertyInteger
+	 * @see OStatus#getPropertyDouble
+	 * @see OStatus#getPropertyBoolean
 	 */
 	protected void loadConfig() throws NumberFormatException
 	{
@@ -433,6 +478,24 @@ public class ACQUIREImplementation extends FITSImplementation implements JMSComm
 			exposureLength = status.getPropertyInteger("o.acquire.exposure_length.brightest");
 		frameOverhead = status.getPropertyInteger("o.acquire.frame_overhead");
 		maximumOffsetCount = status.getPropertyInteger("o.acquire.offset.count.maximum");
+		if(status.getProperty("o.acquire.brightest.source_find") != null)
+			sourceFind = status.getPropertyBoolean("o.acquire.brightest.source_find");
+		else
+			sourceFind = false;
+		if(sourceFind)
+		{
+			sourceFindThresholdSigma = status.getPropertyDouble(
+							"o.acquire.brightest.source_find.threshold.sigma");
+			sourceFindMinPixelCount = status.getPropertyInteger(
+							"o.acquire.brightest.source_find.pixel_count.minimum");
+			sourceFindThreadCount = status.getPropertyInteger("o.acquire.brightest.source_find.thread_count");
+		}
+		if(sourceFind && (status.getProperty("o.acquire.brightest.window") != null))
+			window = status.getPropertyBoolean("o.acquire.brightest.window");
+		else
+			window = false;
+		if(window)
+			windowSize = status.getPropertyInteger("o.acquire.brightest.window.size");
 	}
 
 	/**
@@ -754,7 +817,10 @@ public class ACQUIREImplementation extends FITSImplementation implements JMSComm
 	 * <li><b>sendBasicAck</b> is called to ensure the command does not time out during an exposure being taken.
 	 * <li><b>doFrame</b> is called to take an acquisition frame.
 	 * <li>An instance of ACQUIRE_ACK is sent back to the client using <b>sendAcquireAck</b>.
-	 * <li><b>reduceExpose</b> is called to pass the frame to the Real Time Data Pipeline for processing.
+	 * <li>If <b>sourceFind</b> is true, <b>getSourceFindBrightest</b> is called to retrieve the position
+	 *     of the brightest object found by the libo_ccd source finder as the frame was read out.
+	 * <li>If the source finder is not in use, or found no objects, 
+	 *     <b>reduceExpose</b> is called to pass the frame to the Real Time Data Pipeline for processing.
 	 *     WCS fitting is <b>NOT</b> attempted here.
 	 * <li><b>testAbort</b> is called to see if this command implementation has been aborted.
 	 * <li>We call <b>computeXYPixelOffset</b> to check whether we are in the correct position, 
@@ -762,11 +828,33 @@ public class ACQUIREImplementation extends FITSImplementation implements JMSComm
 	 * <li>If a new offset is required <b>doXYPixelOffset</b> is called.
 	 * <li>We check to see if the loop should be terminated.
 	 * </ul>
+	 * If <b>sourceFind</b> is true, the source finder is configured and turned on before the loop,
+	 * and turned off again afterwards.
+	 * If <b>window</b> is true, after the first offset the brightest object should be near the target pixel,
+	 * so <b>setupRegionOfInterest</b> is called to read out subsequent frames as an unbinned window
+	 * of <b>windowSize</b> pixels around the target pixel, which is much quicker than a full frame.
+	 * Object positions in the window are converted back to binned full frame pixels using
+	 * <b>regionOfInterestToFramePixel</b>. If the source finder finds nothing in the window, the full frame
+	 * configuration is restored and the next frame is a full frame again. The full frame
+	 * configuration is always restored (<b>restoreRegionOfInterest</b>) before this method returns.
 	 * @param acquireCommand The instance of ACQUIRE we are currently running.
 	 * @param acquireDone The instance of ACQUIRE_DONE to fill in with errors we receive.
 	 * @exception CCDLibraryNativeException Thrown if the exposure failed.
 	 * @exception Exception Thrown if testAbort/setFitsHeaders/getFitsHeadersFromISS/getFitsHeadersFromBSS/
 	 *            saveFitsHeaders/doXYPixelOffset failed.
+	 * @see #sourceFind
+	 * @see #sourceFindThresholdSigma
+	 * @see #sourceFindMinPixelCount
+	 * @see #sourceFindThreadCount
+	 * @see #getSourceFindBrightest
+	 * @see #window
+	 * @see #windowSize
+	 * @see #regionOfInterestToFramePixel
+	 * @see FITSImplementation#setupRegionOfInterest
+	 * @see FITSImplementation#restoreRegionOfInterest
+	 * @see FITSImplementation#regionOfInterestActive
+	 * @see ngat.o.ccd.CCDLibrary#setSourceFindConfig
+	 * @see ngat.o.ccd.CCDLibrary#setSourceFindEnable
 	 * @see #doFrame
 	 * @see #xPixelOffset
 	 * @see #yPixelOffset
@@ -796,50 +884,184 @@ public class ACQUIREImplementation extends FITSImplementation implements JMSComm
 		yPixelOffset = 0.0;
 		// keep track of how many times we attempt to offset
 		offsetCount = 0;
-		// start loop
-		done = false;
-		while(done == false)
+		// find the brightest object in each frame as it is read out, if configured
+		if(sourceFind)
 		{
-			// send an ack before the frame, so the client doesn't time out during the exposure
-			sendBasicAck(acquireCommand.getId(),exposureLength+frameOverhead);
-			// Take frame
-			filename = doFrame(acquireCommand,acquireDone);
-			// send Acquire ACK with filename back to client
-			// time to complete is reduction time, we will send another ACK after reduceCalibrate
-			sendAcquireAck(acquireCommand.getId(),frameOverhead,filename);
-			// Call pipeline to reduce data. Do NOT WCS fit.
-			reduceExpose(acquireCommand.getId(),filename,false);
-			// Test abort status.
-			if(testAbort(acquireCommand,acquireDone) == true)
+			ccd.setSourceFindConfig(sourceFindThresholdSigma,sourceFindMinPixelCount,sourceFindThreadCount);
+			ccd.setSourceFindEnable(true);
+		}
+		try
+		{
+			// start loop
+			done = false;
+			while(done == false)
 			{
-				throw new Exception(this.getClass().getName()+"ACQUIRE:"+acquireCommand.getId()+
-						    ":doAcquisitionBrightest:Aborted.");
-			}
-			// log reduction
-			o.log(Logging.VERBOSITY_VERBOSE,"Command:"+acquireCommand.getId()+
-			      ":doAcquisitionBrightest:Exposure reduction:filename:"+reducedFITSFilename+".");
-			// Calculate offset
-			// check loop termination - is offset less than threshold?
-			done = computeXYPixelOffset();
-			if(done == false)
+				// send an ack before the frame, so the client doesn't time out during the exposure
+				sendBasicAck(acquireCommand.getId(),exposureLength+frameOverhead);
+				// Take frame
+				filename = doFrame(acquireCommand,acquireDone);
+				// send Acquire ACK with filename back to client
+				// time to complete is reduction time, we will send another ACK after reduceCalibrate
+				sendAcquireAck(acquireCommand.getId(),frameOverhead,filename);
+				// Use the source finder result if we have one, otherwise
+				// call pipeline to reduce data. Do NOT WCS fit.
+				if(regionOfInterestActive)
+				{
+					// If the object is not in the window, go back to full frames
+					if(getSourceFindBrightest(acquireCommand.getId(),filename) == false)
+					{
+						o.log(Logging.VERBOSITY_VERBOSE,"Command:"+acquireCommand.getId()+
+						      ":doAcquisitionBrightest:No object in window:Restoring full frame.");
+						restoreRegionOfInterest();
+						// Test abort status, before retrying with a full frame.
+						if(testAbort(acquireCommand,acquireDone) == true)
+						{
+							throw new Exception(this.getClass().getName()+"ACQUIRE:"+
+									    acquireCommand.getId()+
+									    ":doAcquisitionBrightest:Aborted.");
+						}
+						continue;
+					}
+					regionOfInterestToFramePixel();
+				}
+				else if((sourceFind == false)||
+					(getSourceFindBrightest(acquireCommand.getId(),filename) == false))
+				{
+					reduceExpose(acquireCommand.getId(),filename,false);
+				}
+				// Test abort status.
+				if(testAbort(acquireCommand,acquireDone) == true)
+				{
+					throw new Exception(this.getClass().getName()+"ACQUIRE:"+acquireCommand.getId()+
+							    ":doAcquisitionBrightest:Aborted.");
+				}
+				// log reduction
+				o.log(Logging.VERBOSITY_VERBOSE,"Command:"+acquireCommand.getId()+
+				      ":doAcquisitionBrightest:Exposure reduction:filename:"+reducedFITSFilename+".");
+				// Calculate offset
+				// check loop termination - is offset less than threshold?
+				done = computeXYPixelOffset();
+				if(done == false)
+				{
+					// issue new XY Pixel offset
+					doXYPixelOffset(acquireCommand.getId(),xPixelOffset,yPixelOffset);
+					offsetCount++;
+					// the object should now be near the target pixel, only read out around it
+					if(window && (regionOfInterestActive == false))
+						setupRegionOfInterest(acquireXPixel,acquireYPixel,windowSize);
+				}
+				// Have we taken too many goes to acquire?
+				if(offsetCount > maximumOffsetCount)
+				{
+					throw new Exception(this.getClass().getName()+"ACQUIRE:"+acquireCommand.getId()+
+							    ":doAcquisitionBrightest:Too many attempts:"+offsetCount+".");
+				}
+			}// end while !done
+		}
+		finally
+		{
+			if(sourceFind)
+				ccd.setSourceFindEnable(false);
+			try
 			{
-				// issue new XY Pixel offset
-				doXYPixelOffset(acquireCommand.getId(),xPixelOffset,yPixelOffset);
-				offsetCount++;
+				restoreRegionOfInterest();
 			}
-			// Have we taken too many goes to acquire?
-			if(offsetCount > maximumOffsetCount)
+			catch(Exception e)
 			{
-				throw new Exception(this.getClass().getName()+"ACQUIRE:"+acquireCommand.getId()+
-						    ":doAcquisitionBrightest:Too many attempts:"+offsetCount+".");
+				o.error(this.getClass().getName()+":doAcquisitionBrightest:"+acquireCommand.getId()+
+					":Failed to restore full frame configuration:",e);
 			}
-		}// end while !done
+		}
+	}
+
+	/**
+	 * Retrieve the brightest object found by the libo_ccd source finder in the frame just read out.
+	 * If an object was found, reducedFITSFilename is set to the raw filename, 
+	 * brightestObjectXPixel and brightestObjectYPixel are set to the object's centroid, and an
+	 * ACQUIRE_DP_ACK is sent to the client (seeing and photometricity are not measured by the source finder,
+	 * and are sent as zero). 
+	 * @param id The identifier of the command being implemented.
+	 * @param filename The raw FITS image just taken.
+	 * @return true if the source finder found an object, false if it found none, or failed 
+	 *         (in which case the frame should be passed to the Real Time Data Pipeline instead).
+	 * @exception IOException Thrown if sending the ACQUIRE_DP_ACK fails.
+	 * @see #reducedFITSFilename
+	 * @see #brightestObjectXPixel
+	 * @see #brightestObjectYPixel
+	 * @see #frameOverhead
+	 * @see #sendAcquireDpAck
+	 * @see ngat.o.ccd.CCDLibrary#getSourceFindResult
+	 * @see ngat.o.ccd.CCDLibrarySourceFindResult
+	 */
+	protected boolean getSourceFindBrightest(String id,String filename) throws IOException
+	{
+		CCDLibrarySourceFindResult result = null;
+
+		try
+		{
+			result = ccd.getSourceFindResult();
+		}
+		catch(CCDLibraryNativeException e)
+		{
+			o.error(this.getClass().getName()+":getSourceFindBrightest:"+id+
+				":Failed to get source finder result, using the data pipeline instead:",e);
+			return false;
+		}
+		o.log(Logging.VERBOSITY_VERBOSE,"Command:"+id+":getSourceFindBrightest:Found "+
+		      result.getObjectCount()+" objects in "+result.getElapsedTime()+" seconds:background "+
+		      result.getBackground()+":sigma "+result.getBackgroundSigma()+".");
+		if(result.hasObject() == false)
+		{
+			o.log(Logging.VERBOSITY_VERBOSE,"Command:"+id+
+			      ":getSourceFindBrightest:No objects found, using the data pipeline instead.");
+			return false;
+		}
+		reducedFITSFilename = filename;
+		brightestObjectXPixel = result.getBrightestX();
+		brightestObjectYPixel = result.getBrightestY();
+		o.log(Logging.VERBOSITY_VERBOSE,"Command:"+id+":getSourceFindBrightest:Brightest object at ("+
+		      brightestObjectXPixel+","+brightestObjectYPixel+"):flux "+result.getBrightestFlux()+
+		      ":peak "+result.getBrightestPeak()+":pixels "+result.getBrightestPixelCount()+
+		      ":saturated "+result.isBrightestSaturated()+".");
+		sendAcquireDpAck(id,frameOverhead,filename,0.0f,(float)(result.getBrightestFlux()),
+				 (float)brightestObjectXPixel,(float)brightestObjectYPixel,0.0f,0.0f,
+				 result.isBrightestSaturated());
+		return true;
+	}
+
+	/**
+	 * Convert brightestObjectXPixel and brightestObjectYPixel from (unbinned) pixels in the region of interest
+	 * window, to binned pixels in the full frame configured by doConfig, which is what
+	 * computeXYPixelOffset expects. 
+	 * @exception CCDLibraryNativeException Thrown if getSetupWindow fails.
+	 * @see #brightestObjectXPixel
+	 * @see #brightestObjectYPixel
+	 * @see #bin
+	 * @see #computeXYPixelOffset
+	 * @see ngat.o.ccd.CCDLibrary#getSetupWindow
+	 */
+	protected void regionOfInterestToFramePixel() throws CCDLibraryNativeException
+	{
+		CCDLibrarySetupWindow roi = null;
+		double xPixel,yPixel;
+
+		roi = ccd.getSetupWindow(0);
+		// unbinned full frame pixel position
+		xPixel = ((double)(roi.getXStart()-1))+brightestObjectXPixel;
+		yPixel = ((double)(roi.getYStart()-1))+brightestObjectYPixel;
+		// binned pixel position (the centre of binned pixel 1 is unbinned pixel (bin+1)/2)
+		brightestObjectXPixel = ((xPixel-0.5)/((double)bin))+0.5;
+		brightestObjectYPixel = ((yPixel-0.5)/((double)bin))+0.5;
+		o.log(Logging.VERBOSITY_VERBOSE,"regionOfInterestToFramePixel:Window "+roi+
+		      ":Brightest Object Pixel(binned): ("+brightestObjectXPixel+", "+brightestObjectYPixel+").");
 	}
 
 	/**
 	 * Take 1 acquisition frame with the imager.
 	 * <ul>
 	 * <li>The pause and resume times are cleared, and the FITS headers setup from the current configuration.
+	 * <li>If a region of interest is being read out, <b>setFitsHeadersRegionOfInterest</b> is called
+	 *     to set the window dimension headers.
 	 * <li>Some FITS headers are got from the ISS.
 	 * <li><b>testAbort</b> is called to see if this command implementation has been aborted.
 	 * <li>The FITS headers are saved using <b>saveFitsHeaders</b>, to the temporary FITS filename.
@@ -858,6 +1080,8 @@ public class ACQUIREImplementation extends FITSImplementation implements JMSComm
 	 * @see #exposureLength
 	 * @see FITSImplementation#testAbort
 	 * @see FITSImplementation#setFitsHeaders
+	 * @see FITSImplementation#setFitsHeadersRegionOfInterest
+	 * @see FITSImplementation#regionOfInterestActive
 	 * @see FITSImplementation#getFitsHeadersFromISS
 	 * @see FITSImplementation#getFitsHeadersFromBSS
 	 * @see FITSImplementation#saveFitsHeaders
@@ -885,6 +1109,12 @@ public class ACQUIREImplementation extends FITSImplementation implements JMSComm
 					    ":doFrame:setFitsHeaders failed:"+acquireDone.getErrorNum()+
 					    ":"+acquireDone.getErrorString());
 		}
+		if(regionOfInterestActive && (setFitsHeadersRegionOfInterest(acquireCommand,acquireDone) == false))
+		{
+			throw new Exception(this.getClass().getName()+"ACQUIRE:"+acquireCommand.getId()+
+					    ":doFrame:setFitsHeadersRegionOfInterest failed:"+acquireDone.getErrorNum()+
+					    ":"+acquireDone.getErrorString());
+		}
 		if(getFitsHeadersFromISS(acquireCommand,acquireDone) == false)
 		{
 			throw new Exception(this.getClass().getName()+"ACQUIRE:"+acquireCommand.getId()+
@@ -6,6 +6,7 @@ import ngat.o.ccd.*;
 import ngat.message.base.*;
 import ngat.message.ISS_INST.CALIBRATE_DONE;
 import ngat.message.INST_DP.*;
+import ngat.util.logging.*;
 
 /**
  * This class provides the generic implementation for CALIBRATE commands sent to a server using the
@@ -169,6 +170,113 @@ public class CALIBRATEImplementation extends FITSImplementation implements JMSCo
 		return true;
 	}
 
+	/**
+	 * Start a libo_ccd master frame combine, if one is configured for this command. Each full frame read
+	 * out after this is added to the combine as it is de-interlaced.
+	 * The combine is configured using the following properties (where prefix is, for instance, "o.multbias"):
+	 * <ul>
+	 * <li><b>&lt;prefix&gt;.combine</b> Whether to combine the frames (if missing, no combine is done).
+	 * <li><b>&lt;prefix&gt;.combine.method</b> The combine method, one of MEAN, CLIPPED_MEAN or MEDIAN.
+	 * <li><b>&lt;prefix&gt;.combine.clip_sigma</b> The clipped mean rejection threshold, in standard deviations.
+	 * <li><b>&lt;prefix&gt;.combine.thread_count</b> The number of threads each frame is split into.
+	 * <li><b>&lt;prefix&gt;.combine.memory_limit</b> The memory, in megabytes, used to keep copies of the
+	 *     frames for the median/clipped mean methods.
+	 * </ul>
+	 * A failure to start the combine is logged, but is not an error, as the individual frames are still saved.
+	 * @param command The command being implemented, used for logging.
+	 * @param prefix The property prefix for the command.
+	 * @return The method returns true if a combine was started, and false if it was not.
+	 * @see #saveMasterCombine
+	 * @see #abortMasterCombine
+	 * @see ngat.o.ccd.CCDLibrary#combineMethodFromString
+	 * @see ngat.o.ccd.CCDLibrary#combineConfig
+	 * @see ngat.o.ccd.CCDLibrary#combineStart
+	 */
+	protected boolean startMasterCombine(COMMAND command,String prefix)
+	{
+		double clipSigma;
+		int method,threadCount,memoryLimit;
+
+		if(status.propertyContainsKey(prefix+".combine") == false)
+			return false;
+		try
+		{
+			if(status.getPropertyBoolean(prefix+".combine") == false)
+				return false;
+			method = CCDLibrary.combineMethodFromString(status.getProperty(prefix+".combine.method"));
+			clipSigma = status.getPropertyDouble(prefix+".combine.clip_sigma");
+			threadCount = status.getPropertyInteger(prefix+".combine.thread_count");
+			memoryLimit = status.getPropertyInteger(prefix+".combine.memory_limit");
+			ccd.combineConfig(method,clipSigma,threadCount,memoryLimit);
+			ccd.combineStart();
+		}
+		catch(Exception e)
+		{
+			o.error(this.getClass().getName()+":startMasterCombine:"+command+
+				":Failed to start master frame combine:",e);
+			return false;
+		}
+		o.log(Logging.VERBOSITY_VERBOSE,"Command:"+command.getId()+":startMasterCombine:"+
+		      "Started master frame combine using "+status.getProperty(prefix+".combine.method")+".");
+		return true;
+	}
+
+	/**
+	 * Save the master frame combined from the frames read out since startMasterCombine. The master frame is saved
+	 * alongside the last frame read out, with "_master" added before the ".fits" extension.
+	 * A failure to save the master frame is logged, but is not an error, as the individual frames have
+	 * already been saved.
+	 * @param command The command being implemented, used for logging.
+	 * @param lastFilename The filename of the last frame read out.
+	 * @return The filename of the master frame, or null if it was not saved.
+	 * @see #startMasterCombine
+	 * @see ngat.o.ccd.CCDLibrary#getCombineFrameCount
+	 * @see ngat.o.ccd.CCDLibrary#combineSave
+	 */
+	protected String saveMasterCombine(COMMAND command,String lastFilename)
+	{
+		String masterFilename = null;
+		int frameCount;
+
+		if(lastFilename.endsWith(".fits"))
+			masterFilename = lastFilename.substring(0,lastFilename.length()-5)+"_master.fits";
+		else
+			masterFilename = lastFilename+"_master";
+		frameCount = ccd.getCombineFrameCount();
+		try
+		{
+			ccd.combineSave(masterFilename);
+		}
+		catch(Exception e)
+		{
+			o.error(this.getClass().getName()+":saveMasterCombine:"+command+
+				":Failed to save master frame "+masterFilename+":",e);
+			return null;
+		}
+		o.log(Logging.VERBOSITY_TERSE,"Command:"+command.getId()+":saveMasterCombine:"+
+		      "Saved master frame combined from "+frameCount+" frames to "+masterFilename+".");
+		return masterFilename;
+	}
+
+	/**
+	 * Abort the master frame combine started by startMasterCombine, freeing it's memory. This should be called
+	 * if the command fails or is aborted before saveMasterCombine is called.
+	 * @param command The command being implemented, used for logging.
+	 * @see #startMasterCombine
+	 * @see ngat.o.ccd.CCDLibrary#combineAbort
+	 */
+	protected void abortMasterCombine(COMMAND command)
+	{
+		try
+		{
+			ccd.combineAbort();
+		}
+		catch(Exception e)
+		{
+			o.error(this.getClass().getName()+":abortMasterCombine:"+command+
+				":Failed to abort master frame combine:",e);
+		}
+	}
 }
 
 //
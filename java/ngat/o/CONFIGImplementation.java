@@ -82,9 +82,11 @@ public class CONFIGImplementation extends SETUPImplementation implements JMSComm
 	 * <li>It gets windowing information from the OConfig object passed with the command.
 	 * <li>It gets filter wheel filter names from the OConfig object and converts them to positions
 	 * 	using a configuration file.
+	 * <li>If the filter wheel is enabled, it starts moving the filter wheel asynchronously.
 	 * <li>It sends the information to the SDSU CCD Controller to configure it.
 	 * <li>It moves the neutral density filter slides to the positions specified, if the
 	 *     filter slides are configured enabled.
+	 * <li>It waits for the filter wheel move to complete.
 	 * <li>If filter wheels are enabled, we call setFocusOffset to send a focus offset to the ISS.
 	 * <li>It increments the unique configuration ID.
 	 * </ul>
@@ -109,7 +111,10 @@ public class CONFIGImplementation extends SETUPImplementation implements JMSComm
 	 * @see ngat.o.ndfilter.NDFilterArduino
 	 * @see ngat.o.ndfilter.NDFilterArduino#move
 	 * @see ngat.o.ccd.CCDLibrary#setupDimensions
-	 * @see ngat.o.ccd.CCDLibrary#filterWheelMove
+	 * @see #filterWheelMoveWaitQuietly
+	 * @see ngat.o.ccd.CCDLibrary#filterWheelMoveStart
+	 * @see ngat.o.ccd.CCDLibrary#filterWheelMoveWait
+	 * @see ngat.o.ccd.CCDLibrary#filterWheelMoveTimeEstimate
 	 * @see ngat.o.ccd.CCDLibrarySetupWindow
 	 * @see ngat.message.ISS_INST.CONFIG
 	 * @see ngat.message.ISS_INST.CONFIG#getId
@@ -149,6 +154,7 @@ public class CONFIGImplementation extends SETUPImplementation implements JMSComm
 		int numberColumns,numberRows,amplifier;
 		int filterWheelPosition,filterSlidePositionNumber;
 		boolean filterWheelEnable;
+		boolean filterWheelMoveStarted = false;
 		boolean filterSlideEnable[] = new boolean[OConfig.O_FILTER_INDEX_COUNT];
 		boolean filterSlidePosition[] = new boolean[OConfig.O_FILTER_INDEX_COUNT];
 
@@ -284,32 +290,45 @@ public class CONFIGImplementation extends SETUPImplementation implements JMSComm
 		}
 		if(testAbort(configCommand,configDone) == true)
 			return configDone;
-	// send dimension/filter wheel configuration to the SDSU controller
+	// start the filter wheel moving, then send the dimension configuration to the SDSU controller
+	// and move the filter slides whilst the wheel is moving.
 		try
 		{
-			ccd.setupDimensions(numberColumns,numberRows,detector.getXBin(),detector.getYBin(),
-					    amplifier,detector.getWindowFlags(),windowList);
-			if(testAbort(configCommand,configDone) == true)
-				return configDone;
 			if(filterWheelEnable)
 			{
-				ccd.filterWheelMove(filterWheelPosition);
+				o.log(Logging.VERBOSITY_INTERMEDIATE,this.getClass().getName()+
+				      ":processCommand:Starting filter wheel move to position "+filterWheelPosition+
+				      ":estimated move time "+
+				      ccd.filterWheelMoveTimeEstimate(ccd.filterWheelGetPosition(),filterWheelPosition)+
+				      " seconds.");
+				ccd.filterWheelMoveStart(filterWheelPosition);
+				filterWheelMoveStarted = true;
 			}
 			else
 			{
 				o.log(Logging.VERBOSITY_VERY_TERSE,this.getClass().getName()+
 					":processCommand:Filter wheels not enabled:Filter wheels NOT moved.");
 			}
+			ccd.setupDimensions(numberColumns,numberRows,detector.getXBin(),detector.getYBin(),
+					    amplifier,detector.getWindowFlags(),windowList);
 		}
 		catch(CCDLibraryNativeException e)
 		{
 			o.error(this.getClass().getName()+":processCommand:"+
 				command+":Error configuring SDSU controller:",e);
+			if(filterWheelMoveStarted)
+				filterWheelMoveWaitQuietly(command);
 			configDone.setErrorNum(OConstants.O_ERROR_CODE_BASE+804);
 			configDone.setErrorString(":processCommand:"+command+":Error configuring SDSU controller:"+e);
 			configDone.setSuccessful(false);
 			return configDone;
 		}
+		if(testAbort(configCommand,configDone) == true)
+		{
+			if(filterWheelMoveStarted)
+				filterWheelMoveWaitQuietly(command);
+			return configDone;
+		}
 		// configure filter slides by talking to the arduino
 		try
 		{
@@ -332,11 +351,30 @@ public class CONFIGImplementation extends SETUPImplementation implements JMSComm
 		{
 			o.error(this.getClass().getName()+":processCommand:"+
 				command+":Error moving filter slides:",e);
+			if(filterWheelMoveStarted)
+				filterWheelMoveWaitQuietly(command);
 			configDone.setErrorNum(OConstants.O_ERROR_CODE_BASE+809);
 			configDone.setErrorString(":processCommand:"+command+":Error moving filter slides:"+e);
 			configDone.setSuccessful(false);
 			return configDone;
 		}
+	// wait for the filter wheel move to complete
+		if(filterWheelMoveStarted)
+		{
+			try
+			{
+				ccd.filterWheelMoveWait();
+			}
+			catch(CCDLibraryNativeException e)
+			{
+				o.error(this.getClass().getName()+":processCommand:"+
+					command+":Error moving filter wheel:",e);
+				configDone.setErrorNum(OConstants.O_ERROR_CODE_BASE+811);
+				configDone.setErrorString(":processCommand:"+command+":Error moving filter wheel:"+e);
+				configDone.setSuccessful(false);
+				return configDone;
+			}
+		}
 	// test abort
 		if(testAbort(configCommand,configDone) == true)
 			return configDone;
@@ -386,6 +424,27 @@ public class CONFIGImplementation extends SETUPImplementation implements JMSComm
 	// return done object.
 		return configDone;
 	}
+
+	/**
+	 * Wait for a filter wheel move started with filterWheelMoveStart to finish, when the CONFIG is
+	 * returning early because of an error or abort. Any filter wheel error is logged, but otherwise ignored,
+	 * as the CONFIG is already failing.
+	 * @param command The command being implemented, used for logging.
+	 * @see #ccd
+	 * @see ngat.o.ccd.CCDLibrary#filterWheelMoveWait
+	 */
+	protected void filterWheelMoveWaitQuietly(COMMAND command)
+	{
+		try
+		{
+			ccd.filterWheelMoveWait();
+		}
+		catch(CCDLibraryNativeException e)
+		{
+			o.error(this.getClass().getName()+":filterWheelMoveWaitQuietly:"+
+				command+":Filter wheel move failed:",e);
+		}
+	}
 }
 //
 // $Log: not supported by cvs2svn $
@@ -91,6 +91,36 @@ public class DAY_CALIBRATEImplementation extends CALIBRATEImplementation impleme
 	 * The readout overhead for a full frame, in milliseconds.
 	 */
 	private int readoutOverhead = 0;
+	/**
+	 * The time it takes to change the binning/amplifier configuration, in milliseconds.
+	 */
+	private int configOverhead = 0;
+	/**
+	 * Whether the CCD has been configured by this invocation of the command. If false, the next
+	 * calibration must call doConfig.
+	 */
+	private boolean configured = false;
+	/**
+	 * The binning the CCD was last configured to by this invocation of the command.
+	 */
+	private int configuredBin = 0;
+	/**
+	 * Which amplifier the CCD was last configured to use by this invocation of the command.
+	 */
+	private boolean configuredUseWindowAmplifier = false;
+	/**
+	 * The number of times doConfig has been called by this invocation of the command.
+	 */
+	private int configChangeCount = 0;
+	/**
+	 * The time, in milliseconds since the epoch, the predicted schedule was calculated.
+	 * The predicted and actual start times of the calibrations are logged relative to this time.
+	 */
+	private long scheduleStartTime = 0L;
+	/**
+	 * The predicted number of configuration changes for the calibration list.
+	 */
+	private int predictedConfigChangeCount = 0;
 
 	/**
 	 * Constructor.
@@ -146,14 +176,19 @@ public class DAY_CALIBRATEImplementation extends CALIBRATEImplementation impleme
 	 * <li>loadCalibrationList is called to load a calibration list from the property file.
 	 * <li>initialiseState is called to load the saved calibration database.
 	 * <li>The readoutOverhead is retrieved from the configuration.
+	 * <li>The configOverhead and whether to schedule the calibrations are retrieved from the configuration.
 	 * <li>addSavedStateToCalibration is called, which finds the correct last time for each
 	 * 	calibration in the list and sets the relevant field.
+	 * <li>If scheduling is enabled, scheduleCalibrationList is called to re-order the calibration list.
+	 * <li>predictSchedule is called to predict when each calibration will be done.
 	 * <li>The FITS headers are cleared, and a the MULTRUN number is incremented.
 	 * <li>For each calibration, we do the following:
 	 *      <ul>
 	 *      <li>testCalibration is called, to see whether the calibration should be done.
-	 * 	<li>If it should, doCalibration is called to get the relevant frames.
+	 * 	<li>If it should, doCalibration is called to get the relevant frames. The actual start time
+	 * 		and duration are recorded.
 	 *      </ul>
+	 * <li>logSchedule is called to log the predicted against the actual schedule.
 	 * <li>sendBasicAck is called, to stop the client timing out whilst creating the master bias.
 	 * <li>The makeMasterBias method is called, to create master bias fields from the data just taken.
 	 * </ul>
@@ -172,6 +207,10 @@ public class DAY_CALIBRATEImplementation extends CALIBRATEImplementation impleme
 	 * @see #testCalibration
 	 * @see #doCalibration
 	 * @see #readoutOverhead
+	 * @see #configOverhead
+	 * @see #scheduleCalibrationList
+	 * @see #predictSchedule
+	 * @see #logSchedule
 	 */
 	public COMMAND_DONE processCommand(COMMAND command)
 	{
@@ -180,6 +219,7 @@ public class DAY_CALIBRATEImplementation extends CALIBRATEImplementation impleme
 		DAY_CALIBRATECalibration calibration = null;
 		String directoryString = null;
 		int makeBiasAckTime;
+		boolean schedule;
 
 		dayCalibrateDone.setMeanCounts(0.0f);
 		dayCalibrateDone.setPeakCounts(0.0f);
@@ -204,9 +244,38 @@ public class DAY_CALIBRATEImplementation extends CALIBRATEImplementation impleme
 			dayCalibrateDone.setSuccessful(false);
 			return dayCalibrateDone;
 		}
+	// Get the amount of time to change configuration, and whether to schedule the calibration list
+		try
+		{
+			if(status.propertyContainsKey("o.day_calibrate.config_overhead"))
+				configOverhead = status.getPropertyInteger("o.day_calibrate.config_overhead");
+			else
+				configOverhead = 0;
+			if(status.propertyContainsKey("o.day_calibrate.schedule"))
+				schedule = status.getPropertyBoolean("o.day_calibrate.schedule");
+			else
+				schedule = false;
+		}
+		catch (Exception e)
+		{
+			String errorString = new String(command.getId()+
+				":processCommand:Failed to get schedule configuration.");
+			o.error(this.getClass().getName()+":"+errorString,e);
+			dayCalibrateDone.setErrorNum(OConstants.O_ERROR_CODE_BASE+2215);
+			dayCalibrateDone.setErrorString(errorString);
+			dayCalibrateDone.setSuccessful(false);
+			return dayCalibrateDone;
+		}
 	// match saved state to calibration list (put last time into calibration list)
 		if(addSavedStateToCalibration(dayCalibrateCommand,dayCalibrateDone) == false)
 			return dayCalibrateDone;
+	// the CCD configuration is unknown, the first calibration must configure it.
+		configured = false;
+		configChangeCount = 0;
+	// re-order the calibration list, and predict when each calibration will be done
+		if(schedule)
+			scheduleCalibrationList(dayCalibrateCommand);
+		predictSchedule(dayCalibrateCommand);
 	// initialise status/fits header info, in case any frames are produced.
 	// get fits headers
 		clearFitsHeaders();
@@ -221,10 +290,14 @@ public class DAY_CALIBRATEImplementation extends CALIBRATEImplementation impleme
 		// should always return false.
 			if(testCalibration(dayCalibrateCommand,dayCalibrateDone,calibration))
 			{
+				calibration.setActualStartTime(System.currentTimeMillis());
 				if(doCalibration(dayCalibrateCommand,dayCalibrateDone,calibration) == false)
 					return dayCalibrateDone;
+				calibration.setActualDuration(System.currentTimeMillis()-
+							      calibration.getActualStartTime());
 			}
 		}// end for on calibration list
+		logSchedule(dayCalibrateCommand);
 	// send an ack before make master processing, so the client doesn't time out.
 		makeBiasAckTime = status.getPropertyInteger("o.day_calibrate.acknowledge_time.make_bias");
 		if(sendBasicAck(dayCalibrateCommand,dayCalibrateDone,makeBiasAckTime) == false)
@@ -277,6 +350,7 @@ public class DAY_CALIBRATEImplementation extends CALIBRATEImplementation impleme
 			{
 			// create calibration instance, and set it's type
 				calibration = new DAY_CALIBRATECalibration();
+				calibration.setIndex(index);
 				try
 				{
 					calibration.setType(typeString);
@@ -459,8 +533,8 @@ public class DAY_CALIBRATEImplementation extends CALIBRATEImplementation impleme
 	 * 	return false, because the DAY_CALIBRATE command should be stopping (it's run out of time).
 	 * <li>If the difference between the current time and the last time the calibration was done is
 	 * 	less than the frequency return false, it's too soon to do this calibration again.
-	 * <li>We work out how long it will take us to do the calibration, using the <b>count</b>, 
-	 * 	<b>exposureTime</b>, and the <b>readoutOverhead</b> property.
+	 * <li>We work out how long it will take us to do the calibration, using getCalibrationDuration. If the
+	 * 	calibration needs a different configuration to the current one, the configOverhead is added.
 	 * <li>If it's going to take us longer to do the calibration than the remaining time available, return
 	 * 	false.
 	 * <li>Otherwise, return true.
@@ -469,6 +543,9 @@ public class DAY_CALIBRATEImplementation extends CALIBRATEImplementation impleme
 	 * @param dayCalibrateDone The instance of DAY_CALIBRATE_DONE to fill in with errors we receive.
 	 * @param calibration The calibration we wish to determine whether to do or not.
 	 * @return The method returns true if we should do the calibration, false if we should not.
+	 * @see #getCalibrationDuration
+	 * @see #needsConfig
+	 * @see #configOverhead
 	 */
 	protected boolean testCalibration(DAY_CALIBRATE dayCalibrateCommand,DAY_CALIBRATE_DONE dayCalibrateDone,
 						DAY_CALIBRATECalibration calibration)
@@ -512,17 +589,10 @@ public class DAY_CALIBRATEImplementation extends CALIBRATEImplementation impleme
 			return false;
 		}
 	// How long will it take us to do this calibration?
-		if(calibration.isBias())
-		{
-			calibrationCompletionTime = calibration.getCount()*readoutOverhead;
-		}
-		else if(calibration.isDark())
-		{
-			calibrationCompletionTime = calibration.getCount()*
-					(calibration.getExposureTime()+readoutOverhead);
-		}
-		else // we should never get here, but if we do make method return false.
-			calibrationCompletionTime = Long.MAX_VALUE;
+		calibrationCompletionTime = getCalibrationDuration(calibration);
+		if((calibrationCompletionTime != Long.MAX_VALUE)&&
+		   needsConfig(calibration.getBin(),calibration.useWindowAmplifier()))
+			calibrationCompletionTime += configOverhead;
 	// if it's going to take us longer than the remaining time to do this, return false
 		if((now+calibrationCompletionTime) > (implementationStartTime+dayCalibrateCommand.getTimeToComplete()))
 		{
@@ -546,7 +616,8 @@ public class DAY_CALIBRATEImplementation extends CALIBRATEImplementation impleme
 	 * This method does the specified calibration.
 	 * <ul>
 	 * <li>The relevant data is retrieved from the calibration parameter.
-	 * <li><b>doConfig</b> is called for the relevant binning factor to be setup.
+	 * <li><b>doConfig</b> is called for the relevant binning factor to be setup, if the binning or amplifier
+	 * 	is different to the last calibration (see needsConfig).
 	 * <li><b>sendBasicAck</b> is called to stop the client timing out before the first frame is completed.
 	 * <li><b>doFrames</b> is called to exposure count frames with the correct exposure length (DARKs only).
 	 * <li>If the calibration suceeded, the saved state's last time is updated to now, and the state saved.
@@ -555,6 +626,7 @@ public class DAY_CALIBRATEImplementation extends CALIBRATEImplementation impleme
 	 * @param dayCalibrateDone The instance of DAY_CALIBRATE_DONE to fill in with errors we receive.
 	 * @param calibration The calibration to do.
 	 * @return The method returns true if the calibration was done successfully, false if an error occured.
+	 * @see #needsConfig
 	 * @see #doConfig
 	 * @see #doFrames
 	 * @see #sendBasicAck
@@ -579,10 +651,13 @@ public class DAY_CALIBRATEImplementation extends CALIBRATEImplementation impleme
 		useWindowAmplifier = calibration.useWindowAmplifier();
 		count = calibration.getCount();
 		exposureTime = calibration.getExposureTime();
-	// configure CCD camera
+	// configure CCD camera, unless the last calibration used the same configuration
 	// don't send a basic ack, as setting the binning takes less than 1 second
-		if(doConfig(dayCalibrateCommand,dayCalibrateDone,bin,useWindowAmplifier) == false)
-			return false;
+		if(needsConfig(bin,useWindowAmplifier))
+		{
+			if(doConfig(dayCalibrateCommand,dayCalibrateDone,bin,useWindowAmplifier) == false)
+				return false;
+		}
 	// send an ack before the frame, so the client doesn't time out during the first exposure
 		if(sendBasicAck(dayCalibrateCommand,dayCalibrateDone,exposureTime+readoutOverhead) == false)
 			return false;
@@ -620,6 +695,10 @@ public class DAY_CALIBRATEImplementation extends CALIBRATEImplementation impleme
 	 * @return The method returns true if the calibration was done successfully, false if an error occured.
 	 * @see OStatus#getNumberColumns
 	 * @see OStatus#getNumberRows
+	 * @see #configured
+	 * @see #configuredBin
+	 * @see #configuredUseWindowAmplifier
+	 * @see #configChangeCount
 	 */
 	protected boolean doConfig(DAY_CALIBRATE dayCalibrateCommand,DAY_CALIBRATE_DONE dayCalibrateDone,int bin,
 				   boolean useWindowAmplifier)
@@ -691,9 +770,270 @@ public class DAY_CALIBRATEImplementation extends CALIBRATEImplementation impleme
 	// Store name of configuration used in status object.
 	// This is queried when saving FITS headers to get the CONFNAME value.
 		status.setConfigName("DAY_CALIBRATION:"+dayCalibrateCommand.getId()+":"+bin+":"+useWindowAmplifier);
+	// Store configuration, so the next calibration can tell whether it needs to re-configure
+		configured = true;
+		configuredBin = bin;
+		configuredUseWindowAmplifier = useWindowAmplifier;
+		configChangeCount++;
 		return true;
 	}
 
+	/**
+	 * Method to determine whether the CCD needs to be configured to do a calibration with the specified
+	 * binning and amplifier, i.e. it has not been configured yet by this command, or it was configured
+	 * with a different binning or amplifier.
+	 * @param bin The binning factor the calibration uses.
+	 * @param useWindowAmplifier Whether the calibration uses the window amplifier.
+	 * @return The method returns true if doConfig needs to be called before the calibration.
+	 * @see #configured
+	 * @see #configuredBin
+	 * @see #configuredUseWindowAmplifier
+	 */
+	protected boolean needsConfig(int bin,boolean useWindowAmplifier)
+	{
+		return ((configured == false)||(bin != configuredBin)||
+			(useWindowAmplifier != configuredUseWindowAmplifier));
+	}
+
+	/**
+	 * Method to work out how long a calibration will take, using the <b>count</b>,
+	 * <b>exposureTime</b>, and the <b>readoutOverhead</b> property. The configuration overhead is not included.
+	 * @param calibration The calibration.
+	 * @return The length of time the calibration will take, in milliseconds. Long.MAX_VALUE is returned
+	 *         if the calibration type is not known.
+	 * @see #readoutOverhead
+	 */
+	protected long getCalibrationDuration(DAY_CALIBRATECalibration calibration)
+	{
+		if(calibration.isBias())
+			return ((long)calibration.getCount())*readoutOverhead;
+		else if(calibration.isDark())
+			return ((long)calibration.getCount())*(calibration.getExposureTime()+readoutOverhead);
+		// we should never get here
+		return Long.MAX_VALUE;
+	}
+
+	/**
+	 * Method to re-order the calibration list, so that more calibrations can be done in the time available.
+	 * <ul>
+	 * <li>The calibrations that are due (their frequency has elapsed since they were last done) are sorted
+	 * 	into priority order, most overdue (as a fraction of their frequency) first.
+	 * <li>The due calibrations are selected in priority order, if they fit into the remaining time
+	 * 	(the command's time to complete). The first calibration selected with each binning/amplifier
+	 * 	combination also uses up configOverhead. Calibrations that do not fit are skipped, so shorter
+	 * 	calibrations further down the list can use the remaining time.
+	 * <li>The selected calibrations are grouped by binning/amplifier, the groups are ordered by their
+	 * 	highest priority calibration. Within a group biases are done first, then darks in order of
+	 * 	increasing exposure length.
+	 * <li>The skipped calibrations follow (in priority order), in case the selected ones finish early, and then
+	 * 	the calibrations that are not due.
+	 * </ul>
+	 * Each calibration is still passed to testCalibration before it is done, so this method only changes
+	 * the order the calibrations are tried in.
+	 * @param dayCalibrateCommand The instance of DAY_CALIBRATE we are currently running.
+	 * @see #calibrationList
+	 * @see #getCalibrationDuration
+	 * @see #getConfigKey
+	 * @see #configOverhead
+	 * @see #implementationStartTime
+	 * @see DAY_CALIBRATEImplementation.DAY_CALIBRATEPriorityComparator
+	 * @see DAY_CALIBRATEImplementation.DAY_CALIBRATEGroupComparator
+	 */
+	protected void scheduleCalibrationList(DAY_CALIBRATE dayCalibrateCommand)
+	{
+		DAY_CALIBRATECalibration calibration = null;
+		List candidateList = null;
+		List notDueList = null;
+		List selectedList = null;
+		List skippedList = null;
+		List configKeyList = null;
+		List groupList = null;
+		List scheduleList = null;
+		String configKey = null;
+		long now,remainingTime,duration;
+
+		now = System.currentTimeMillis();
+		remainingTime = (implementationStartTime+dayCalibrateCommand.getTimeToComplete())-now;
+	// split into calibrations that are due, and not due
+		candidateList = new Vector();
+		notDueList = new Vector();
+		for(int i = 0; i < calibrationList.size(); i++)
+		{
+			calibration = (DAY_CALIBRATECalibration)(calibrationList.get(i));
+			if((now-calibration.getLastTime()) >= calibration.getFrequency())
+				candidateList.add(calibration);
+			else
+				notDueList.add(calibration);
+		}
+		Collections.sort(candidateList,new DAY_CALIBRATEPriorityComparator(now));
+	// select the calibrations that fit into the remaining time, in priority order
+		selectedList = new Vector();
+		skippedList = new Vector();
+		configKeyList = new Vector();
+		for(int i = 0; i < candidateList.size(); i++)
+		{
+			calibration = (DAY_CALIBRATECalibration)(candidateList.get(i));
+			configKey = getConfigKey(calibration);
+			duration = getCalibrationDuration(calibration);
+			if((duration != Long.MAX_VALUE)&&(configKeyList.contains(configKey) == false))
+				duration += configOverhead;
+			if(duration <= remainingTime)
+			{
+				selectedList.add(calibration);
+				if(configKeyList.contains(configKey) == false)
+					configKeyList.add(configKey);
+				remainingTime -= duration;
+			}
+			else
+				skippedList.add(calibration);
+		}
+	// group the selected calibrations by configuration
+		scheduleList = new Vector();
+		for(int i = 0; i < configKeyList.size(); i++)
+		{
+			configKey = (String)(configKeyList.get(i));
+			groupList = new Vector();
+			for(int j = 0; j < selectedList.size(); j++)
+			{
+				calibration = (DAY_CALIBRATECalibration)(selectedList.get(j));
+				if(getConfigKey(calibration).equals(configKey))
+					groupList.add(calibration);
+			}
+			Collections.sort(groupList,new DAY_CALIBRATEGroupComparator());
+			scheduleList.addAll(groupList);
+		}
+		scheduleList.addAll(skippedList);
+		scheduleList.addAll(notDueList);
+		calibrationList = scheduleList;
+		o.log(Logging.VERBOSITY_VERBOSE,
+		      "Command:"+dayCalibrateCommand.getClass().getName()+":scheduleCalibrationList:"+
+		      selectedList.size()+" calibrations selected in "+configKeyList.size()+" configurations,"+
+		      skippedList.size()+" due calibrations do not fit,"+notDueList.size()+" are not due.");
+	}
+
+	/**
+	 * Method to return a string describing the binning/amplifier configuration of a calibration,
+	 * calibrations with the same key can be done without re-configuring the CCD.
+	 * @param calibration The calibration.
+	 * @return A string of the form "&lt;bin&gt;:&lt;useWindowAmplifier&gt;".
+	 */
+	protected String getConfigKey(DAY_CALIBRATECalibration calibration)
+	{
+		return new String(calibration.getBin()+":"+calibration.useWindowAmplifier());
+	}
+
+	/**
+	 * Method to predict when each calibration in the calibration list will be done, by working through the
+	 * list in order as processCommand does, using the same tests as testCalibration.
+	 * The predicted start time and duration are set in each calibration (the predicted start time is -1
+	 * for calibrations that are predicted not to be done).
+	 * @param dayCalibrateCommand The instance of DAY_CALIBRATE we are currently running.
+	 * @see #calibrationList
+	 * @see #scheduleStartTime
+	 * @see #predictedConfigChangeCount
+	 * @see #getCalibrationDuration
+	 * @see #configOverhead
+	 */
+	protected void predictSchedule(DAY_CALIBRATE dayCalibrateCommand)
+	{
+		DAY_CALIBRATECalibration calibration = null;
+		long time,endTime,duration;
+		int bin = 0;
+		boolean predictConfigured,useWindowAmplifier,reconfigure;
+
+		scheduleStartTime = System.currentTimeMillis();
+		endTime = implementationStartTime+dayCalibrateCommand.getTimeToComplete();
+		time = scheduleStartTime;
+		predictedConfigChangeCount = 0;
+		predictConfigured = configured;
+		useWindowAmplifier = configuredUseWindowAmplifier;
+		bin = configuredBin;
+		for(int i = 0; i < calibrationList.size(); i++)
+		{
+			calibration = (DAY_CALIBRATECalibration)(calibrationList.get(i));
+			calibration.setPredictedStartTime(-1L);
+			calibration.setPredictedDuration(0L);
+			calibration.setActualStartTime(-1L);
+			calibration.setActualDuration(0L);
+			if((time-calibration.getLastTime()) < calibration.getFrequency())
+				continue;
+			duration = getCalibrationDuration(calibration);
+			if(duration == Long.MAX_VALUE)
+				continue;
+			reconfigure = ((predictConfigured == false)||(calibration.getBin() != bin)||
+				       (calibration.useWindowAmplifier() != useWindowAmplifier));
+			if(reconfigure)
+				duration += configOverhead;
+			if((time+duration) > endTime)
+				continue;
+			if(reconfigure)
+			{
+				predictConfigured = true;
+				bin = calibration.getBin();
+				useWindowAmplifier = calibration.useWindowAmplifier();
+				predictedConfigChangeCount++;
+			}
+			calibration.setPredictedStartTime(time);
+			calibration.setPredictedDuration(duration);
+			time += duration;
+		}
+	}
+
+	/**
+	 * Method to log the predicted schedule against what was actually done. The start times are
+	 * relative to the time the schedule was predicted.
+	 * @param dayCalibrateCommand The instance of DAY_CALIBRATE we are currently running.
+	 * @see #calibrationList
+	 * @see #scheduleStartTime
+	 * @see #predictedConfigChangeCount
+	 * @see #configChangeCount
+	 */
+	protected void logSchedule(DAY_CALIBRATE dayCalibrateCommand)
+	{
+		DAY_CALIBRATECalibration calibration = null;
+		long predictedTime,actualTime;
+		int predictedCount,actualCount;
+
+		predictedTime = 0L;
+		actualTime = 0L;
+		predictedCount = 0;
+		actualCount = 0;
+		for(int i = 0; i < calibrationList.size(); i++)
+		{
+			calibration = (DAY_CALIBRATECalibration)(calibrationList.get(i));
+			if((calibration.getPredictedStartTime() < 0)&&(calibration.getActualStartTime() < 0))
+				continue;
+			if(calibration.getPredictedStartTime() > -1)
+			{
+				predictedCount++;
+				predictedTime += calibration.getPredictedDuration();
+			}
+			if(calibration.getActualStartTime() > -1)
+			{
+				actualCount++;
+				actualTime += calibration.getActualDuration();
+			}
+			o.log(Logging.VERBOSITY_INTERMEDIATE,
+			      "Command:"+dayCalibrateCommand.getClass().getName()+":Schedule:calibration "+
+			      calibration.getIndex()+":type:"+calibration.getType()+":bin:"+calibration.getBin()+
+			      ":use window amplifier:"+calibration.useWindowAmplifier()+
+			      ":count:"+calibration.getCount()+":exposure time:"+calibration.getExposureTime()+
+			      "\n\tpredicted start:"+
+			      ((calibration.getPredictedStartTime() > -1) ?
+			       Long.toString(calibration.getPredictedStartTime()-scheduleStartTime) : "not done")+
+			      ":predicted duration:"+calibration.getPredictedDuration()+
+			      ":actual start:"+
+			      ((calibration.getActualStartTime() > -1) ?
+			       Long.toString(calibration.getActualStartTime()-scheduleStartTime) : "not done")+
+			      ":actual duration:"+calibration.getActualDuration()+".");
+		}
+		o.log(Logging.VERBOSITY_INTERMEDIATE,
+		      "Command:"+dayCalibrateCommand.getClass().getName()+":Schedule:predicted "+predictedCount+
+		      " calibrations in "+predictedTime+" ms with "+predictedConfigChangeCount+
+		      " configuration changes:actual "+actualCount+" calibrations in "+actualTime+" ms with "+
+		      configChangeCount+" configuration changes.");
+	}
+
 	/**
 	 * The method that does a series of calibration frames with the current configuration, based
 	 * on the passed in parameter set. The following occurs:
@@ -1107,6 +1447,28 @@ public class DAY_CALIBRATEImplementation extends CALIBRATEImplementation impleme
 		 * not from the calibration list.
 		 */
 		protected long lastTime;
+		/**
+		 * The index of this calibration in the property file list.
+		 */
+		protected int index = 0;
+		/**
+		 * The predicted time this calibration will start, in milliseconds since the epoch,
+		 * or -1 if it is predicted not to be done.
+		 */
+		protected long predictedStartTime = -1L;
+		/**
+		 * The predicted length of time this calibration will take (including any configuration change),
+		 * in milliseconds.
+		 */
+		protected long predictedDuration = 0L;
+		/**
+		 * The time this calibration actually started, in milliseconds since the epoch, or -1 if it was not done.
+		 */
+		protected long actualStartTime = -1L;
+		/**
+		 * The length of time this calibration actually took, in milliseconds.
+		 */
+		protected long actualDuration = 0L;
 		
 		/**
 		 * Constructor.
@@ -1321,6 +1683,188 @@ public class DAY_CALIBRATEImplementation extends CALIBRATEImplementation impleme
 		{
 			return lastTime;
 		}
+
+		/**
+		 * Method to set the index of this calibration in the property file list.
+		 * @param i The index.
+		 * @see #index
+		 */
+		public void setIndex(int i)
+		{
+			index = i;
+		}
+
+		/**
+		 * Method to get the index of this calibration in the property file list.
+		 * @return The index.
+		 * @see #index
+		 */
+		public int getIndex()
+		{
+			return index;
+		}
+
+		/**
+		 * Method to set the predicted start time of this calibration.
+		 * @param t The time, in milliseconds since the epoch, or -1 if it is predicted not to be done.
+		 * @see #predictedStartTime
+		 */
+		public void setPredictedStartTime(long t)
+		{
+			predictedStartTime = t;
+		}
+
+		/**
+		 * Method to get the predicted start time of this calibration.
+		 * @return The time, in milliseconds since the epoch, or -1 if it is predicted not to be done.
+		 * @see #predictedStartTime
+		 */
+		public long getPredictedStartTime()
+		{
+			return predictedStartTime;
+		}
+
+		/**
+		 * Method to set the predicted length of time this calibration will take.
+		 * @param t The length of time, in milliseconds.
+		 * @see #predictedDuration
+		 */
+		public void setPredictedDuration(long t)
+		{
+			predictedDuration = t;
+		}
+
+		/**
+		 * Method to get the predicted length of time this calibration will take.
+		 * @return The length of time, in milliseconds.
+		 * @see #predictedDuration
+		 */
+		public long getPredictedDuration()
+		{
+			return predictedDuration;
+		}
+
+		/**
+		 * Method to set the time this calibration actually started.
+		 * @param t The time, in milliseconds since the epoch, or -1 if it was not done.
+		 * @see #actualStartTime
+		 */
+		public void setActualStartTime(long t)
+		{
+			actualStartTime = t;
+		}
+
+		/**
+		 * Method to get the time this calibration actually started.
+		 * @return The time, in milliseconds since the epoch, or -1 if it was not done.
+		 * @see #actualStartTime
+		 */
+		public long getActualStartTime()
+		{
+			return actualStartTime;
+		}
+
+		/**
+		 * Method to set the length of time this calibration actually took.
+		 * @param t The length of time, in milliseconds.
+		 * @see #actualDuration
+		 */
+		public void setActualDuration(long t)
+		{
+			actualDuration = t;
+		}
+
+		/**
+		 * Method to get the length of time this calibration actually took.
+		 * @return The length of time, in milliseconds.
+		 * @see #actualDuration
+		 */
+		public long getActualDuration()
+		{
+			return actualDuration;
+		}
+	}
+
+	/**
+	 * Private inner class used to sort calibrations into priority order, the calibration that is
+	 * most overdue (the time since it was last done, as a fraction of it's frequency) comes first.
+	 * @see #scheduleCalibrationList
+	 */
+	private class DAY_CALIBRATEPriorityComparator implements Comparator
+	{
+		/**
+		 * The current time, in milliseconds since the epoch.
+		 */
+		protected long now = 0L;
+
+		/**
+		 * Constructor.
+		 * @param n The current time, in milliseconds since the epoch.
+		 * @see #now
+		 */
+		public DAY_CALIBRATEPriorityComparator(long n)
+		{
+			super();
+			now = n;
+		}
+
+		/**
+		 * Compare two calibrations.
+		 * @param o1 The first DAY_CALIBRATECalibration.
+		 * @param o2 The second DAY_CALIBRATECalibration.
+		 * @return A negative number if o1 is more overdue than o2, a positive number if it is less overdue,
+		 *         or zero if they are equally overdue.
+		 * @see #getOverdue
+		 */
+		public int compare(Object o1,Object o2)
+		{
+			double overdue1,overdue2;
+
+			overdue1 = getOverdue((DAY_CALIBRATECalibration)o1);
+			overdue2 = getOverdue((DAY_CALIBRATECalibration)o2);
+			if(overdue1 > overdue2)
+				return -1;
+			else if(overdue1 < overdue2)
+				return 1;
+			return 0;
+		}
+
+		/**
+		 * Get how overdue a calibration is.
+		 * @param calibration The calibration.
+		 * @return The time since the calibration was last done, divided by it's frequency.
+		 */
+		protected double getOverdue(DAY_CALIBRATECalibration calibration)
+		{
+			return ((double)(now-calibration.getLastTime()))/((double)(calibration.getFrequency()));
+		}
+	}
+
+	/**
+	 * Private inner class used to sort calibrations with the same configuration, biases
+	 * come first, followed by darks in order of increasing exposure length.
+	 * @see #scheduleCalibrationList
+	 */
+	private class DAY_CALIBRATEGroupComparator implements Comparator
+	{
+		/**
+		 * Compare two calibrations.
+		 * @param o1 The first DAY_CALIBRATECalibration.
+		 * @param o2 The second DAY_CALIBRATECalibration.
+		 * @return A negative number if o1 should be done before o2, a positive number if it should be done
+		 *         after, or zero.
+		 */
+		public int compare(Object o1,Object o2)
+		{
+			DAY_CALIBRATECalibration calibration1 = (DAY_CALIBRATECalibration)o1;
+			DAY_CALIBRATECalibration calibration2 = (DAY_CALIBRATECalibration)o2;
+
+			if(calibration1.isBias() && (calibration2.isBias() == false))
+				return -1;
+			if((calibration1.isBias() == false) && calibration2.isBias())
+				return 1;
+			return calibration1.getExposureTime()-calibration2.getExposureTime();
+		}
 	}
 }
 
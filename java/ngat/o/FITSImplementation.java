@@ -56,6 +56,33 @@ public class FITSImplementation extends HardwareImplementation implements JMSCom
 	 * units and comments for FITS header card images.
 	 */
 	protected FitsHeaderDefaults oFitsHeaderDefaults = null;
+	/**
+	 * Whether setupRegionOfInterest has windowed the CCD, and restoreRegionOfInterest has not yet been called.
+	 * @see #setupRegionOfInterest
+	 * @see #restoreRegionOfInterest
+	 */
+	protected boolean regionOfInterestActive = false;
+	/**
+	 * The X binning the CCD was configured with before setupRegionOfInterest was called.
+	 */
+	private int regionOfInterestSavedXBin = 1;
+	/**
+	 * The Y binning the CCD was configured with before setupRegionOfInterest was called.
+	 */
+	private int regionOfInterestSavedYBin = 1;
+	/**
+	 * The amplifier the CCD was configured with before setupRegionOfInterest was called.
+	 */
+	private int regionOfInterestSavedAmplifier = 0;
+	/**
+	 * The window flags the CCD was configured with before setupRegionOfInterest was called.
+	 */
+	private int regionOfInterestSavedWindowFlags = 0;
+	/**
+	 * The windows the CCD was configured with before setupRegionOfInterest was called.
+	 */
+	private CCDLibrarySetupWindow regionOfInterestSavedWindowList[] =
+		new CCDLibrarySetupWindow[CCDLibrary.SETUP_WINDOW_COUNT];
 
 	/**
 	 * This method calls the super-classes method, and tries to fill in the reference to the
@@ -1098,6 +1125,163 @@ public class FITSImplementation extends HardwareImplementation implements JMSCom
 		return ccd.dspAmplifierFromString(propertyValue);
 	}
 
+	/**
+	 * Reconfigure the CCD to read out a single square window (region of interest) centred on the
+	 * specified position. Windowed frames read out much faster than full frames, which is useful
+	 * for commands (ACQUIRE, TELFOCUS) that take a series of frames but only look at one object.
+	 * <ul>
+	 * <li>The current binning, amplifier and windows are saved, so restoreRegionOfInterest can put them back.
+	 * <li>The window is clipped to the imaging area of the CCD (the CCDXIMSI and CCDYIMSI FITS defaults).
+	 * <li>setupDimensions is called with the window in window slot one, unbinned
+	 *     (the controller cannot bin and window at the same time), using the window amplifier.
+	 * </ul>
+	 * @param xCentre The unbinned X pixel to centre the window on.
+	 * @param yCentre The unbinned Y pixel to centre the window on.
+	 * @param size The width and height of the window, in unbinned pixels.
+	 * @exception CCDLibraryNativeException Thrown if getSetupWindow or setupDimensions fails.
+	 * @exception CCDLibraryFormatException Thrown if the window amplifier is not a valid amplifier.
+	 * @exception IllegalArgumentException Thrown if the window size is too small.
+	 * @exception Exception Thrown if the CCD imaging area cannot be retrieved from the FITS defaults.
+	 * @see #regionOfInterestActive
+	 * @see #restoreRegionOfInterest
+	 * @see #getAmplifier(boolean)
+	 * @see #status
+	 * @see #oFitsHeaderDefaults
+	 * @see OStatus#getNumberColumns
+	 * @see OStatus#getNumberRows
+	 * @see ngat.o.ccd.CCDLibrary#setupDimensions
+	 * @see ngat.o.ccd.CCDLibrary#SETUP_WINDOW_ONE
+	 */
+	protected void setupRegionOfInterest(int xCentre,int yCentre,int size) throws CCDLibraryNativeException,
+		CCDLibraryFormatException,IllegalArgumentException,Exception
+	{
+		CCDLibrarySetupWindow windowList[] = new CCDLibrarySetupWindow[CCDLibrary.SETUP_WINDOW_COUNT];
+		int xImageSize,yImageSize,xStart,yStart,xEnd,yEnd;
+
+		if(size < 2)
+		{
+			throw new IllegalArgumentException(this.getClass().getName()+
+							   ":setupRegionOfInterest:Illegal window size:"+size);
+		}
+		// save the current setup, if we have not already done so
+		if(regionOfInterestActive == false)
+		{
+			regionOfInterestSavedXBin = ccd.getXBin();
+			regionOfInterestSavedYBin = ccd.getYBin();
+			regionOfInterestSavedAmplifier = ccd.getAmplifier();
+			regionOfInterestSavedWindowFlags = ccd.getSetupWindowFlags();
+			for(int i = 0; i < CCDLibrary.SETUP_WINDOW_COUNT; i++)
+			{
+				regionOfInterestSavedWindowList[i] = ccd.getSetupWindow(i);
+			}
+		}
+		// clip the window to the imaging area
+		xImageSize = oFitsHeaderDefaults.getValueInteger("CCDXIMSI");
+		yImageSize = oFitsHeaderDefaults.getValueInteger("CCDYIMSI");
+		size = Math.min(size,Math.min(xImageSize,yImageSize));
+		xStart = Math.max(1,Math.min(xCentre-(size/2),xImageSize-size+1));
+		yStart = Math.max(1,Math.min(yCentre-(size/2),yImageSize-size+1));
+		xEnd = xStart+size-1;
+		yEnd = yStart+size-1;
+		windowList[0] = new CCDLibrarySetupWindow(xStart,yStart,xEnd,yEnd);
+		for(int i = 1; i < CCDLibrary.SETUP_WINDOW_COUNT; i++)
+		{
+			windowList[i] = new CCDLibrarySetupWindow(-1,-1,-1,-1);
+		}
+		o.log(Logging.VERBOSITY_VERBOSE,this.getClass().getName()+
+		      ":setupRegionOfInterest:Centre ("+xCentre+","+yCentre+"):size "+size+":window "+windowList[0]+".");
+		// set the flag first, so a failed setup is still restored
+		regionOfInterestActive = true;
+		ccd.setupDimensions(status.getNumberColumns(1),status.getNumberRows(1),1,1,getAmplifier(true),
+				    CCDLibrary.SETUP_WINDOW_ONE,windowList);
+	}
+
+	/**
+	 * Put back the CCD configuration saved by setupRegionOfInterest. This does nothing if
+	 * setupRegionOfInterest has not been called (or the configuration has already been restored).
+	 * @exception CCDLibraryNativeException Thrown if setupDimensions fails.
+	 * @exception NumberFormatException Thrown if the number of columns/rows for the saved binning
+	 *            cannot be retrieved from the properties.
+	 * @see #regionOfInterestActive
+	 * @see #setupRegionOfInterest
+	 * @see #status
+	 * @see OStatus#getNumberColumns
+	 * @see OStatus#getNumberRows
+	 * @see ngat.o.ccd.CCDLibrary#setupDimensions
+	 */
+	protected void restoreRegionOfInterest() throws CCDLibraryNativeException,NumberFormatException
+	{
+		if(regionOfInterestActive == false)
+			return;
+		o.log(Logging.VERBOSITY_VERBOSE,this.getClass().getName()+
+		      ":restoreRegionOfInterest:Restoring binning ("+regionOfInterestSavedXBin+","+
+		      regionOfInterestSavedYBin+"):window flags "+regionOfInterestSavedWindowFlags+".");
+		// clear the flag first, so a failed restore is not retried with the same data
+		regionOfInterestActive = false;
+		ccd.setupDimensions(status.getNumberColumns(regionOfInterestSavedXBin),
+				    status.getNumberRows(regionOfInterestSavedYBin),
+				    regionOfInterestSavedXBin,regionOfInterestSavedYBin,regionOfInterestSavedAmplifier,
+				    regionOfInterestSavedWindowFlags,regionOfInterestSavedWindowList);
+	}
+
+	/**
+	 * Update the FITS headers set by setFitsHeaders for a single window (region of interest) readout,
+	 * for commands that save the window to a filename of their own choosing using
+	 * <b>saveFitsHeaders(COMMAND,COMMAND_DONE,String)</b>.
+	 * NAXIS1, NAXIS2, PRESCAN, POSTSCAN, CCDWXOFF, CCDWYOFF, CCDWXSIZ and CCDWYSIZ are set from
+	 * window one, as in <b>saveFitsHeaders(COMMAND,COMMAND_DONE,List)</b>.
+	 * @param command The command being implemented. This is used for error logging.
+	 * @param done A COMMAND_DONE subclass specific to the command being implemented. If an
+	 * 	error occurs the relevant fields are filled in with the error.
+	 * @return The routine returns a boolean to indicate whether the operation was completed
+	 *  	successfully.
+	 * @see #setupRegionOfInterest
+	 * @see #oFitsHeader
+	 * @see ngat.o.ccd.CCDLibrary#getSetupWindow
+	 * @see ngat.o.ccd.CCDLibrary#getWindowWidth
+	 * @see ngat.o.ccd.CCDLibrary#getWindowHeight
+	 */
+	public boolean setFitsHeadersRegionOfInterest(COMMAND command,COMMAND_DONE done)
+	{
+		FitsHeaderCardImage cardImage = null;
+		CCDLibrarySetupWindow window = null;
+
+		try
+		{
+			window = ccd.getSetupWindow(0);
+			cardImage = oFitsHeader.get("NAXIS1");
+			cardImage.setValue(new Integer(ccd.getWindowWidth(0)));
+			cardImage = oFitsHeader.get("NAXIS2");
+			cardImage.setValue(new Integer(ccd.getWindowHeight(0)));
+			cardImage = oFitsHeader.get("PRESCAN");
+			cardImage.setValue(new Integer(0));
+			//diddly see ccd_setup.c : SETUP_WINDOW_BIAS_WIDTH
+			cardImage = oFitsHeader.get("POSTSCAN");
+			cardImage.setValue(new Integer(53));
+			cardImage = oFitsHeader.get("CCDWXOFF");
+			cardImage.setValue(new Integer(window.getXStart()));
+			cardImage = oFitsHeader.get("CCDWYOFF");
+			cardImage.setValue(new Integer(window.getYStart()));
+			cardImage = oFitsHeader.get("CCDWXSIZ");
+			cardImage.setValue(new Integer(window.getXEnd()-window.getXStart()));
+			cardImage = oFitsHeader.get("CCDWYSIZ");
+			cardImage.setValue(new Integer(window.getYEnd()-window.getYStart()));
+		}
+		// CCDLibraryNativeException thrown by getSetupWindow
+		// NullPointerException thrown if a card image is missing
+		catch(Exception e)
+		{
+			String s = new String("Command "+command.getClass().getName()+
+					      ":Setting region of interest Fits Headers failed:"+e);
+			o.error(s,e);
+			done.setErrorNum(OConstants.O_ERROR_CODE_BASE+320);
+			done.setErrorString(s);
+			done.setSuccessful(false);
+			return false;
+		}
+		return true;
+	}
+
 	/**
 	 * This method retrieves the current Amplifier configuration used to configure the CCD controller.
 	 * This determines which readout(s) the CCD uses. The numeric setting is then converted into a 
@@ -26,6 +26,14 @@ public class GET_STATUSImplementation extends INTERRUPTImplementation implements
 	 * Revision Control System id string, showing the version of the Class.
 	 */
 	public final static String RCSID = new String("$Id: GET_STATUSImplementation.java,v 1.4 2013-06-04 08:26:15 cjm Exp $");
+	/**
+	 * A GET_STATUS level above LEVEL_FULL. As well as returning the full status, a GET_STATUS with this level
+	 * dumps the controller request trace to the file named by the <i>o.ccd.trace.dump.filename</i> property.
+	 * Routine full status requests only return the controller request latency counters, and do no file I/O.
+	 * @see ngat.message.ISS_INST.GET_STATUS#LEVEL_FULL
+	 * @see #getControllerTraceStatus
+	 */
+	public final static int LEVEL_CONTROLLER_TRACE_DUMP = GET_STATUS.LEVEL_FULL+1;
 	/**
 	 * Local copy of the O status object.
 	 * @see O#getStatus
@@ -46,6 +54,11 @@ public class GET_STATUSImplementation extends INTERRUPTImplementation implements
 	 * @see ngat.message.ISS_INST.GET_STATUS_DONE#VALUE_STATUS_UNKNOWN
 	 */
 	private String detectorTemperatureInstrumentStatus = GET_STATUS_DONE.VALUE_STATUS_UNKNOWN;
+	/**
+	 * The libo_ccd status snapshot, filled in by one native call per GET_STATUS command in getCCDStatus.
+	 * @see #getCCDStatus
+	 */
+	private CCDLibraryStatus ccdStatus = new CCDLibraryStatus();
 
 	/**
 	 * Constructor. 
@@ -85,6 +98,7 @@ public class GET_STATUSImplementation extends INTERRUPTImplementation implements
 	/**
 	 * This method implements the GET_STATUS command. 
 	 * The local hashTable is setup (returned in the done object) and a local copy of status setup.
+	 * The libo_ccd status is retrieved in one call, by calling getCCDStatus.
 	 * The current mode of the camera is returned by calling getCurrentMode.
 	 * The following data is put into the hashTable:
 	 * <ul>
@@ -110,20 +124,21 @@ public class GET_STATUSImplementation extends INTERRUPTImplementation implements
 	 * @see #status
 	 * @see #hashTable
 	 * @see #detectorTemperatureInstrumentStatus
+	 * @see #ccdStatus
+	 * @see #getCCDStatus
 	 * @see #getCurrentMode
 	 * @see #getFilterWheelStatus
 	 * @see #getIntermediateStatus
 	 * @see #getFullStatus
 	 * @see OStatus#getCurrentCommand
-	 * @see CCDLibrary#getExposureStatus
-	 * @see CCDLibrary#getExposureLength
-	 * @see CCDLibrary#getExposureStartTime
-	 * @see CCDLibrary#getBinnedNCols
-	 * @see CCDLibrary#getBinnedNRows
-	 * @see CCDLibrary#getXBin
-	 * @see CCDLibrary#getYBin
-	 * @see CCDLibrary#getSetupWindowFlags
-	 * @see CCDLibrary#getSetupComplete
+	 * @see CCDLibraryStatus#getExposureLength
+	 * @see CCDLibraryStatus#getExposureStartTime
+	 * @see CCDLibraryStatus#getBinnedNCols
+	 * @see CCDLibraryStatus#getBinnedNRows
+	 * @see CCDLibraryStatus#getXBin
+	 * @see CCDLibraryStatus#getYBin
+	 * @see CCDLibraryStatus#getSetupWindowFlags
+	 * @see CCDLibraryStatus#getSetupComplete
 	 * @see OStatus#getExposureCount
 	 * @see OStatus#getExposureNumber
 	 * @see OStatus#getProperty
@@ -144,6 +159,8 @@ public class GET_STATUSImplementation extends INTERRUPTImplementation implements
 		hashTable = new Hashtable();
 	// get local reference to OStatus object.
 		status = o.getStatus();
+	// libo_ccd status snapshot
+		getCCDStatus(getStatusCommand.getLevel());
 	// current mode
 		currentMode = getCurrentMode();
 		getStatusDone.setCurrentMode(currentMode);
@@ -161,14 +178,14 @@ public class GET_STATUSImplementation extends INTERRUPTImplementation implements
 		else
 			hashTable.put("currentCommand",currentCommand.getClass().getName());
 	// Currently, we query ccd setup stored settings, not hardware.
-		hashTable.put("NCols",new Integer(ccd.getBinnedNCols()));
-		hashTable.put("NRows",new Integer(ccd.getBinnedNRows()));
-		hashTable.put("NSBin",new Integer(ccd.getXBin()));
-		hashTable.put("NPBin",new Integer(ccd.getYBin()));
-		hashTable.put("Window Flags",new Integer(ccd.getSetupWindowFlags()));
-		hashTable.put("Setup Status",new Boolean(ccd.getSetupComplete()));
-		hashTable.put("Exposure Length",new Integer(ccd.getExposureLength()));
-		hashTable.put("Exposure Start Time",new Long(ccd.getExposureStartTime()));
+		hashTable.put("NCols",new Integer(ccdStatus.getBinnedNCols()));
+		hashTable.put("NRows",new Integer(ccdStatus.getBinnedNRows()));
+		hashTable.put("NSBin",new Integer(ccdStatus.getXBin()));
+		hashTable.put("NPBin",new Integer(ccdStatus.getYBin()));
+		hashTable.put("Window Flags",new Integer(ccdStatus.getSetupWindowFlags()));
+		hashTable.put("Setup Status",new Boolean(ccdStatus.getSetupComplete()));
+		hashTable.put("Exposure Length",new Integer(ccdStatus.getExposureLength()));
+		hashTable.put("Exposure Start Time",new Long(ccdStatus.getExposureStartTime()));
 	// filter wheel settings
 		getFilterWheelStatus();
 		// filter slide data
@@ -183,7 +200,7 @@ public class GET_STATUSImplementation extends INTERRUPTImplementation implements
 	// Get full status information.
 		if(getStatusCommand.getLevel() >= GET_STATUS.LEVEL_FULL)
 		{
-			getFullStatus();
+			getFullStatus(getStatusCommand.getLevel());
 		}
 	// set hashtable and return values.
 		getStatusDone.setDisplayInfo(hashTable);
@@ -195,19 +212,60 @@ public class GET_STATUSImplementation extends INTERRUPTImplementation implements
 	}
 
 	/**
-	 * Internal method to get the current mode, the GET_STATUS command will return.
+	 * Internal method to get the libo_ccd status snapshot, in one call to the C layer. The controller values
+	 * are only asked for if the command requests a <b>INTERMEDIATE</b> level status: the elapsed exposure time
+	 * always, the temperatures if the <i>o.get_status.temperature</i> boolean property is TRUE, and the
+	 * supply voltages if the <i>o.get_status.supply_voltages</i> boolean property is TRUE.
+	 * If the call fails, the error is reported and ccdStatus is reset, so every value is zero/invalid.
+	 * @param level The status level requested by the GET_STATUS command.
 	 * @see #ccd
-	 * @see ngat.o.ccd.CCDLibrary#getExposureStatus
+	 * @see #ccdStatus
+	 * @see CCDLibrary#getStatus
+	 * @see CCDLibraryStatus#FLAG_ELAPSED_EXPOSURE_TIME
+	 * @see CCDLibraryStatus#FLAG_TEMPERATURE
+	 * @see CCDLibraryStatus#FLAG_SUPPLY_VOLTAGE
+	 * @see OStatus#getPropertyBoolean
+	 * @see ngat.message.ISS_INST.GET_STATUS#LEVEL_INTERMEDIATE
+	 */
+	private void getCCDStatus(int level)
+	{
+		int flags;
+
+		flags = 0;
+		if(level >= GET_STATUS.LEVEL_INTERMEDIATE)
+		{
+			flags |= CCDLibraryStatus.FLAG_ELAPSED_EXPOSURE_TIME;
+			if(status.getPropertyBoolean("o.get_status.temperature"))
+				flags |= CCDLibraryStatus.FLAG_TEMPERATURE;
+			if(status.getPropertyBoolean("o.get_status.supply_voltages"))
+				flags |= CCDLibraryStatus.FLAG_SUPPLY_VOLTAGE;
+		}
+		try
+		{
+			ccd.getStatus(ccdStatus,flags);
+		}
+		catch(CCDLibraryNativeException e)
+		{
+			o.error(this.getClass().getName()+":processCommand:Get CCD Status failed.",e);
+			ccdStatus = new CCDLibraryStatus();
+		}
+	}
+
+	/**
+	 * Internal method to get the current mode, the GET_STATUS command will return.
+	 * @see #ccdStatus
+	 * @see CCDLibraryStatus#getExposureStatus
+	 * @see CCDLibraryStatus#getSetupInProgress
 	 */
 	private int getCurrentMode()
 	{
 		int currentMode;
 
 		currentMode = GET_STATUS_DONE.MODE_IDLE;
-		switch(ccd.getExposureStatus())
+		switch(ccdStatus.getExposureStatus())
 		{
 			case CCDLibrary.EXPOSURE_STATUS_NONE:
-				if(ccd.getSetupInProgress())
+				if(ccdStatus.getSetupInProgress())
 					currentMode = GET_STATUS_DONE.MODE_CONFIGURING;
 				//if(ccd.getFilterWheelStatus() != CCDLibrary.CCD_FILTER_WHEEL_STATUS_NONE)
 				//	currentMode = GET_STATUS_DONE.MODE_CONFIGURING;
@@ -371,144 +429,151 @@ public class GET_STATUSImplementation extends INTERRUPTImplementation implements
 	/**
 	 * Routine to get status, when level INTERMEDIATE has been selected.
 	 * Intermediate level status is usually useful data which can only be retrieved by querying the
-	 * SDSU controller directly. 
+	 * SDSU controller directly, or from the libo_ccd telemetry sampler's cached snapshot, if the sampler 
+	 * is running. The cached snapshot can be returned at any point during an exposure, when the utility board
+	 * cannot be read directly. These values have already been retrieved into ccdStatus by getCCDStatus.
 	 * The following data is put into the hashTable:
 	 * <ul>
 	 * <li><b>Elapsed Exposure Time</b> The Elapsed Exposure Time, this is read from the controller.
 	 * </ul>
-	 * If the <i>o.get_status.temperature</i> boolean property is TRUE, 
-	 * the following data is put into the hashTable:
-	 * <ul>
-	 * <li><b>Temperature</b> The current CCD (dewar) temperature, this is read from the controller.
-	 *       <i>setDetectorTemperatureInstrumentStatus</i> is then called to set the hashtable entry 
-	 *       KEYWORD_DETECTOR_TEMPERATURE_INSTRUMENT_STATUS and detectorTemperatureInstrumentStatus.
-	 * <li><b>Heater ADU</b> The current Heater ADU count, this is read from the controller.
-	 * <li><b>Heater Power</b> This is the power in Watts put into the heater, converted from 
-	 *        the Heater ADU just read.
-	 * <li><b>Utility Board Temperature ADU</b> The Utility Board ADU count, 
-	 * 	this is read from the utility board temperature sensor.
-	 * </ul>
-	 * If the <i>o.get_status.supply_voltages</i> boolean property is TRUE, 
-	 * the following data is put into the hashTable:
-	 * <ul>
-	 * <li><b>High Voltage Supply ADU</b> The SDSU High Voltage supply ADU count, 
-	 * 	this is read from the utility board.
-	 * <li><b>Low Voltage Supply ADU</b> The SDSU Low Voltage supply ADU count, 
-	 * 	this is read from the utility board.
-	 * <li><b>Minus Low Voltage Supply ADU</b> The SDSU Negative Voltage supply ADU count, 
-	 * 	this is read from the utility board.
-	 * </ul>
+	 * If the <i>o.get_status.temperature</i> boolean property is TRUE, getTemperatureStatus is called.
+	 * If the <i>o.get_status.supply_voltages</i> boolean property is TRUE, getSupplyVoltageStatus is called.
 	 * Finally, <i>setInstrumentStatus</i> is called to set the hashTable's overall instrument status,
 	 * in the KEYWORD_INSTRUMENT_STATUS.
-	 * @see #ccd
+	 * @see #ccdStatus
 	 * @see #status
 	 * @see #hashTable
-	 * @see #setDetectorTemperatureInstrumentStatus
+	 * @see #getTemperatureStatus
+	 * @see #getSupplyVoltageStatus
 	 * @see #setInstrumentStatus
-	 * @see #CENTIGRADE_TO_KELVIN
-	 * @see CCDLibrary#getElapsedExposureTime
-	 * @see CCDLibrary#getHighVoltageAnalogueADU
-	 * @see CCDLibrary#getLowVoltageAnalogueADU
-	 * @see CCDLibrary#getMinusLowVoltageAnalogueADU
-	 * @see CCDLibrary#getTemperature
-	 * @see CCDLibrary#getTemperatureHeaterADU
-	 * @see CCDLibrary#getTemperatureHeaterPower
-	 * @see CCDLibrary#getTemperatureUtilityBoardADU
+	 * @see CCDLibraryStatus#isElapsedExposureTimeValid
+	 * @see CCDLibraryStatus#getElapsedExposureTime
+	 * @see CCDLibraryStatus#getElapsedExposureTimeDSPErrorNumber
 	 * @see OStatus#getPropertyBoolean
 	 */
 	private void getIntermediateStatus()
 	{
-		int elapsedExposureTime,adu;
-		double ccdTemperature,dvalue;
+		int elapsedExposureTime;
 
-		// These setting are queried directly from the controller.
-		// libo_ccd routines that do DSP code may cause problems here as the instrument
-		// may be in the process of reading out or similar.
-		// With mutex support in libo_ccd around controller commands this should work.
 		// elapsed exposure time - this seems to work when an exposure is in progress.
-		try
-		{
-			elapsedExposureTime = ccd.getElapsedExposureTime();
-		}
-		catch(CCDLibraryNativeException e)
+		if(ccdStatus.isElapsedExposureTimeValid())
+			elapsedExposureTime = ccdStatus.getElapsedExposureTime();
+		else
 		{
 			// Don't report the error, if it's just we are reading out at the moment
-			if(e.getDSPErrorNumber() != 17)
+			if(ccdStatus.getElapsedExposureTimeDSPErrorNumber() != 17)
 			{
 				o.error(this.getClass().getName()+
-					  ":processCommand:Get Elapsed Exposure Time failed.",e);
+					":processCommand:Get Elapsed Exposure Time failed:DSP error "+
+					ccdStatus.getElapsedExposureTimeDSPErrorNumber()+".");
 			}
 			elapsedExposureTime = 0;
 		}
 		// Always add the exposure time, if we are reading out it has been set to 0
 		hashTable.put("Elapsed Exposure Time",new Integer(elapsedExposureTime));
 		if(status.getPropertyBoolean("o.get_status.temperature"))
-		{
-			// CCD temperature
-			// This involves a read of the utility board, which will fail when exposing...
-			// Therefore only put the temperature in the hashtable on success.
-			// Return temperature in degrees kelvin.
-			try
-			{
-				ccdTemperature = ccd.getTemperature();
-				hashTable.put("Temperature",new Double(ccdTemperature+CENTIGRADE_TO_KELVIN));
-				// set standard status value based on current temperature
-				setDetectorTemperatureInstrumentStatus(ccdTemperature);
-			}
-			catch(CCDLibraryNativeException e)
-			{
-				// Don't report the error, if it's just we are reading out at the moment
-				if(e.getDSPErrorNumber() != 64)
-				{
-					o.error(this.getClass().getName()+
-						  ":processCommand:Get Temperature failed.",e);
-				}
-			}// catch
-			// Dewar heater ADU counts - how much we are heating the dewar to control the temperature.
-		        // Utility Board ADU counts - how hot the temperature sensor is on the utility board.
-			try
-			{
-				adu = ccd.getTemperatureHeaterADU();
-				hashTable.put("Heater ADU",new Integer(adu));
-				dvalue = ccd.getTemperatureHeaterPower(adu);
-				hashTable.put("Heater Power",new Double(dvalue));
-				adu = ccd.getTemperatureUtilityBoardADU();
-				hashTable.put("Utility Board Temperature ADU",new Integer(adu));
-			}
-			catch(CCDLibraryNativeException e)
-			{
-				// Don't report the error, if it's just we are reading out at the moment
-				if(e.getDSPErrorNumber() != 64)
-				{
-					o.error(this.getClass().getName()+
-						  ":processCommand:Get ADU(s) failed.",e);
-				}
-			}// end catch
-		}// end if get temperature status
+			getTemperatureStatus();
 		// SDSU supply voltages
 		if(status.getPropertyBoolean("o.get_status.supply_voltages"))
+			getSupplyVoltageStatus();
+	// Standard status
+		setInstrumentStatus();
+	}
+
+	/**
+	 * Put the temperature status from ccdStatus into the hashTable. Only values that were read are put into
+	 * the hashTable. Errors reading the controller are reported, unless the utility board could not be read
+	 * because we are exposing.
+	 * <ul>
+	 * <li><b>Temperature</b> The current CCD (dewar) temperature, in degrees kelvin.
+	 *       <i>setDetectorTemperatureInstrumentStatus</i> is then called to set the hashtable entry 
+	 *       KEYWORD_DETECTOR_TEMPERATURE_INSTRUMENT_STATUS and detectorTemperatureInstrumentStatus.
+	 * <li><b>Heater ADU</b> The current Heater ADU count.
+	 * <li><b>Heater Power</b> This is the power in Watts put into the heater, converted from 
+	 *        the Heater ADU.
+	 * <li><b>Utility Board Temperature ADU</b> The Utility Board ADU count, 
+	 * 	this is read from the utility board temperature sensor.
+	 * <li><b>Temperature Age</b> How old the above values are in seconds (only when using the telemetry
+	 *        sampler's cached snapshot).
+	 * </ul>
+	 * @see #ccdStatus
+	 * @see #hashTable
+	 * @see #setDetectorTemperatureInstrumentStatus
+	 * @see #CENTIGRADE_TO_KELVIN
+	 * @see CCDLibrary#getTemperatureHeaterPower
+	 * @see CCDLibraryStatus#isTelemetryRunning
+	 * @see CCDLibraryStatus#isTemperatureValid
+	 * @see CCDLibraryStatus#isTemperatureADUValid
+	 */
+	private void getTemperatureStatus()
+	{
+		double dvalue;
+
+		if(ccdStatus.isTemperatureValid())
+		{
+			hashTable.put("Temperature",new Double(ccdStatus.getTemperature()+CENTIGRADE_TO_KELVIN));
+			// set standard status value based on current temperature
+			setDetectorTemperatureInstrumentStatus(ccdStatus.getTemperature());
+		}
+		if(ccdStatus.isTemperatureADUValid())
 		{
+			hashTable.put("Heater ADU",new Integer(ccdStatus.getHeaterADU()));
 			try
 			{
-				adu = ccd.getHighVoltageAnalogueADU();
-				hashTable.put("High Voltage Supply ADU",new Integer(adu));
-				adu = ccd.getLowVoltageAnalogueADU();
-				hashTable.put("Low Voltage Supply ADU",new Integer(adu));
-				adu = ccd.getMinusLowVoltageAnalogueADU();
-				hashTable.put("Minus Low Voltage Supply ADU",new Integer(adu));
+				dvalue = ccd.getTemperatureHeaterPower(ccdStatus.getHeaterADU());
+				hashTable.put("Heater Power",new Double(dvalue));
 			}
 			catch(CCDLibraryNativeException e)
 			{
-				// Don't report the error, if it's just we are reading out at the moment
-				if(e.getDSPErrorNumber() != 64)
-				{
-					o.error(this.getClass().getName()+
-						  ":processCommand:Get supply voltage ADU failed.",e);
-				}
-			}// end catch
-		}// end if get supply voltage status
-	// Standard status
-		setInstrumentStatus();
+				o.error(this.getClass().getName()+":processCommand:Get Heater Power failed.",e);
+			}
+			hashTable.put("Utility Board Temperature ADU",new Integer(ccdStatus.getUtilityBoardADU()));
+		}
+		if(ccdStatus.isTelemetryRunning() && ccdStatus.isTemperatureValid())
+			hashTable.put("Temperature Age",new Double(ccdStatus.getTemperatureAge()));
+		// Don't report the error, if it's just we are reading out at the moment
+		if((ccdStatus.getTemperatureErrorNumber() != 0)&&(ccdStatus.getTemperatureDSPErrorNumber() != 64))
+		{
+			o.error(this.getClass().getName()+":processCommand:Get Temperature failed:error "+
+				ccdStatus.getTemperatureErrorNumber()+":DSP error "+
+				ccdStatus.getTemperatureDSPErrorNumber()+".");
+		}
+	}
+
+	/**
+	 * Put the SDSU supply voltage status from ccdStatus into the hashTable. Nothing is put into the hashTable
+	 * if the supply voltages were not read. Errors reading the controller are reported, unless the utility board
+	 * could not be read because we are exposing.
+	 * <ul>
+	 * <li><b>High Voltage Supply ADU</b> The SDSU High Voltage supply ADU count.
+	 * <li><b>Low Voltage Supply ADU</b> The SDSU Low Voltage supply ADU count.
+	 * <li><b>Minus Low Voltage Supply ADU</b> The SDSU Negative Voltage supply ADU count.
+	 * <li><b>Supply Voltage Age</b> How old the above values are in seconds 
+	 *      (only when using the telemetry sampler's cached snapshot).
+	 * </ul>
+	 * @see #ccdStatus
+	 * @see #hashTable
+	 * @see CCDLibraryStatus#isTelemetryRunning
+	 * @see CCDLibraryStatus#isSupplyVoltageValid
+	 */
+	private void getSupplyVoltageStatus()
+	{
+		if(ccdStatus.isSupplyVoltageValid())
+		{
+			hashTable.put("High Voltage Supply ADU",new Integer(ccdStatus.getHighVoltageADU()));
+			hashTable.put("Low Voltage Supply ADU",new Integer(ccdStatus.getLowVoltageADU()));
+			hashTable.put("Minus Low Voltage Supply ADU",new Integer(ccdStatus.getMinusLowVoltageADU()));
+			if(ccdStatus.isTelemetryRunning())
+				hashTable.put("Supply Voltage Age",new Double(ccdStatus.getSupplyVoltageAge()));
+		}
+		// Don't report the error, if it's just we are reading out at the moment
+		else if((ccdStatus.getSupplyVoltageErrorNumber() != 0)&&
+			(ccdStatus.getSupplyVoltageDSPErrorNumber() != 64))
+		{
+			o.error(this.getClass().getName()+":processCommand:Get supply voltage ADU failed:error "+
+				ccdStatus.getSupplyVoltageErrorNumber()+":DSP error "+
+				ccdStatus.getSupplyVoltageDSPErrorNumber()+".");
+		}
 	}
 
 	/**
@@ -600,13 +665,26 @@ public class GET_STATUSImplementation extends INTERRUPTImplementation implements
 	 * <li><b>os.name, os.arch, os.version</b> The operating system type/version.
 	 * <li><b>user.name, user.home, user.dir</b> Data about the user the process is running as.
 	 * <li><b>thread.list</b> A list of threads the O process is running.
+	 * <li><b>Disk Write ...</b> The direct disc write latencies, if enabled, see getDiskWriteStatus.
+	 * <li><b>Abort ...</b> The abort latencies, see getAbortStatus.
+	 * <li><b>Start Error ...</b> The timed exposure start errors, if any, see getStartErrorStatus.
+	 * <li><b>Exposure Timing ...</b> The exposure phase durations, see getExposureTimingStatus.
+	 * <li><b>Controller Trace Counters</b> The controller request latency counters, and (for a
+	 *     LEVEL_CONTROLLER_TRACE_DUMP request) <b>Controller Trace Filename</b>, the file the controller request
+	 *     trace was dumped to, see getControllerTraceStatus.
 	 * </ul>
+	 * @param level The status level requested by the GET_STATUS command.
 	 * @see #serverConnectionThread
 	 * @see #hashTable
+	 * @see #getDiskWriteStatus
+	 * @see #getAbortStatus
+	 * @see #getStartErrorStatus
+	 * @see #getExposureTimingStatus
+	 * @see #getControllerTraceStatus
 	 * @see ExecuteCommand#run
 	 * @see OStatus#getLogLevel
 	 */
-	private void getFullStatus()
+	private void getFullStatus(int level)
 	{
 		ExecuteCommand executeCommand = null;
 		Runtime runtime = null;
@@ -641,6 +719,19 @@ public class GET_STATUSImplementation extends INTERRUPTImplementation implements
 		runtime = Runtime.getRuntime();
 		hashTable.put("Free Memory",new Long(runtime.freeMemory()));
 		hashTable.put("Total Memory",new Long(runtime.totalMemory()));
+		// direct disc write latency percentiles
+		if(ccd.getDiskWriteEnable())
+			getDiskWriteStatus();
+		// abort latency percentiles
+		getAbortStatus();
+		// timed exposure start error percentiles
+		if(ccd.getStartErrorSampleCount() > 0)
+			getStartErrorStatus();
+		// exposure phase duration percentiles
+		getExposureTimingStatus();
+		// controller request latency counters, and trace dump on request
+		if(ccd.getControllerTraceEnable())
+			getControllerTraceStatus(level);
 		// get some java vm information
 		hashTable.put("java.version",new String(System.getProperty("java.version")));
 		hashTable.put("java.vendor",new String(System.getProperty("java.vendor")));
@@ -669,6 +760,203 @@ public class GET_STATUSImplementation extends INTERRUPTImplementation implements
 		}
 		hashTable.put("thread.list",sb.toString());
 	}
+
+	/**
+	 * Get the direct disc write latency statistics, over the last few hundred frames written:
+	 * <ul>
+	 * <li><b>Disk Write Count</b> The number of frames the latencies are computed from.
+	 * <li><b>Disk Write Latency Median, Disk Write Latency 90, Disk Write Latency 99, Disk Write Latency Max</b>
+	 *     The 50th, 90th, 99th and 100th percentile time taken to write a frame, in seconds.
+	 * </ul>
+	 * @see #ccd
+	 * @see #hashTable
+	 * @see ngat.o.ccd.CCDLibrary#getDiskWriteLatencySampleCount
+	 * @see ngat.o.ccd.CCDLibrary#getDiskWriteLatency
+	 */
+	private void getDiskWriteStatus()
+	{
+		try
+		{
+			hashTable.put("Disk Write Count",new Integer(ccd.getDiskWriteLatencySampleCount()));
+			hashTable.put("Disk Write Latency Median",new Double(ccd.getDiskWriteLatency(50.0)));
+			hashTable.put("Disk Write Latency 90",new Double(ccd.getDiskWriteLatency(90.0)));
+			hashTable.put("Disk Write Latency 99",new Double(ccd.getDiskWriteLatency(99.0)));
+			hashTable.put("Disk Write Latency Max",new Double(ccd.getDiskWriteLatency(100.0)));
+		}
+		catch(CCDLibraryNativeException e)
+		{
+			o.error(this.getClass().getName()+":getDiskWriteStatus:Get disk write latency failed.",e);
+		}
+	}
+
+	/**
+	 * Get the abort latency statistics, over the last hundred aborted exposures or setups. The latency is
+	 * the time from the abort being requested to the aborted operation returning:
+	 * <ul>
+	 * <li><b>Abort Count</b> The number of aborts the latencies are computed from.
+	 * <li><b>Abort Latency Median, Abort Latency 90, Abort Latency Max</b>
+	 *     The 50th, 90th and 100th percentile abort latency, in seconds.
+	 * </ul>
+	 * @see #ccd
+	 * @see #hashTable
+	 * @see ngat.o.ccd.CCDLibrary#getAbortLatencySampleCount
+	 * @see ngat.o.ccd.CCDLibrary#getAbortLatency
+	 */
+	private void getAbortStatus()
+	{
+		try
+		{
+			hashTable.put("Abort Count",new Integer(ccd.getAbortLatencySampleCount()));
+			hashTable.put("Abort Latency Median",new Double(ccd.getAbortLatency(50.0)));
+			hashTable.put("Abort Latency 90",new Double(ccd.getAbortLatency(90.0)));
+			hashTable.put("Abort Latency Max",new Double(ccd.getAbortLatency(100.0)));
+		}
+		catch(CCDLibraryNativeException e)
+		{
+			o.error(this.getClass().getName()+":getAbortStatus:Get abort latency failed.",e);
+		}
+	}
+
+	/**
+	 * Get the timed exposure start error statistics, over the last hundred exposures started at a requested time.
+	 * The start error is how far from the requested time the exposure was started:
+	 * <ul>
+	 * <li><b>Start Error Count</b> The number of exposures the start errors are computed from.
+	 * <li><b>Start Error Median, Start Error 90, Start Error Max</b>
+	 *     The 50th, 90th and 100th percentile absolute start error, in seconds.
+	 * </ul>
+	 * @see #ccd
+	 * @see #hashTable
+	 * @see ngat.o.ccd.CCDLibrary#getStartErrorSampleCount
+	 * @see ngat.o.ccd.CCDLibrary#getStartError
+	 */
+	private void getStartErrorStatus()
+	{
+		try
+		{
+			hashTable.put("Start Error Count",new Integer(ccd.getStartErrorSampleCount()));
+			hashTable.put("Start Error Median",new Double(ccd.getStartError(50.0)));
+			hashTable.put("Start Error 90",new Double(ccd.getStartError(90.0)));
+			hashTable.put("Start Error Max",new Double(ccd.getStartError(100.0)));
+		}
+		catch(CCDLibraryNativeException e)
+		{
+			o.error(this.getClass().getName()+":getStartErrorStatus:Get start error failed.",e);
+		}
+	}
+
+	/**
+	 * Get the exposure phase duration statistics, over the successful exposures since startup. 
+	 * For each phase that has been timed (see the CCDLibrary TIMING_PHASE_* constants):
+	 * <ul>
+	 * <li><b>Exposure Timing &lt;phase&gt; Count</b> The number of exposures the phase was timed in.
+	 * <li><b>Exposure Timing &lt;phase&gt; Median, 90, 99, Max</b> The 50th, 90th, 99th and 100th percentile
+	 *     duration of the phase over all configurations, in seconds.
+	 * <li><b>Exposure Timing &lt;config&gt; &lt;phase&gt; Median</b> The median duration of the phase for each
+	 *     configuration, where &lt;config&gt; is the binning, amplifier and "Full Frame" or "Window",
+	 *     i.e. "2x2 BOTTOM_LEFT Full Frame".
+	 * </ul>
+	 * @see #ccd
+	 * @see #hashTable
+	 * @see ngat.o.ccd.CCDLibrary#TIMING_PHASE_COUNT
+	 * @see ngat.o.ccd.CCDLibrary#TIMING_MAX_CONFIG_COUNT
+	 * @see ngat.o.ccd.CCDLibrary#TIMING_CONFIG_ALL
+	 * @see ngat.o.ccd.CCDLibrary#getExposureTimingPhaseName
+	 * @see ngat.o.ccd.CCDLibrary#getExposureTimingCount
+	 * @see ngat.o.ccd.CCDLibrary#getExposureTimingPercentile
+	 * @see ngat.o.ccd.CCDLibrary#getExposureTimingConfig
+	 * @see ngat.o.ccd.CCDLibrary#dspAmplifierToString
+	 */
+	private void getExposureTimingStatus()
+	{
+		String keyPrefix = null;
+		String configString = null;
+		int config[] = null;
+		int count;
+
+		try
+		{
+			for(int phase = 0; phase < CCDLibrary.TIMING_PHASE_COUNT; phase++)
+			{
+				count = ccd.getExposureTimingCount(CCDLibrary.TIMING_CONFIG_ALL,phase);
+				if(count == 0)
+					continue;
+				keyPrefix = "Exposure Timing "+ccd.getExposureTimingPhaseName(phase);
+				hashTable.put(keyPrefix+" Count",new Integer(count));
+				hashTable.put(keyPrefix+" Median",new Double(ccd.getExposureTimingPercentile(
+						       CCDLibrary.TIMING_CONFIG_ALL,phase,50.0)));
+				hashTable.put(keyPrefix+" 90",new Double(ccd.getExposureTimingPercentile(
+						       CCDLibrary.TIMING_CONFIG_ALL,phase,90.0)));
+				hashTable.put(keyPrefix+" 99",new Double(ccd.getExposureTimingPercentile(
+						       CCDLibrary.TIMING_CONFIG_ALL,phase,99.0)));
+				hashTable.put(keyPrefix+" Max",new Double(ccd.getExposureTimingPercentile(
+						       CCDLibrary.TIMING_CONFIG_ALL,phase,100.0)));
+			}
+			for(int configIndex = 0; configIndex < CCDLibrary.TIMING_MAX_CONFIG_COUNT; configIndex++)
+			{
+				config = ccd.getExposureTimingConfig(configIndex);
+				if(config[0] == 0)
+					continue;
+				try
+				{
+					configString = CCDLibrary.dspAmplifierToString(config[3]);
+				}
+				catch(CCDLibraryFormatException e)
+				{
+					configString = "Amplifier "+config[3];
+				}
+				configString = new String(config[1]+"x"+config[2]+" "+configString+
+							  ((config[4] != 0) ? " Window" : " Full Frame"));
+				for(int phase = 0; phase < CCDLibrary.TIMING_PHASE_COUNT; phase++)
+				{
+					if(ccd.getExposureTimingCount(configIndex,phase) == 0)
+						continue;
+					hashTable.put("Exposure Timing "+configString+" "+
+						      ccd.getExposureTimingPhaseName(phase)+" Median",
+						      new Double(ccd.getExposureTimingPercentile(configIndex,phase,50.0)));
+				}
+			}
+		}
+		catch(CCDLibraryNativeException e)
+		{
+			o.error(this.getClass().getName()+":getExposureTimingStatus:Get exposure timing failed.",e);
+		}
+	}
+
+	/**
+	 * Get the controller request latency counters (one line for each request and DSP command), and put them
+	 * in the hashTable as <b>Controller Trace Counters</b>. Only if the GET_STATUS level is
+	 * LEVEL_CONTROLLER_TRACE_DUMP, and the <i>o.ccd.trace.dump.filename</i> property is set,
+	 * the whole trace (the counters and the last requests each thread sent) is dumped to that file, and
+	 * the filename is put in the hashTable as <b>Controller Trace Filename</b>.
+	 * @param level The status level requested by the GET_STATUS command.
+	 * @see #LEVEL_CONTROLLER_TRACE_DUMP
+	 * @see #ccd
+	 * @see #status
+	 * @see #hashTable
+	 * @see ngat.o.ccd.CCDLibrary#getControllerTraceCounters
+	 * @see ngat.o.ccd.CCDLibrary#dumpControllerTrace
+	 */
+	private void getControllerTraceStatus(int level)
+	{
+		String filename = null;
+
+		try
+		{
+			hashTable.put("Controller Trace Counters",ccd.getControllerTraceCounters());
+			if(level < LEVEL_CONTROLLER_TRACE_DUMP)
+				return;
+			filename = status.getProperty("o.ccd.trace.dump.filename");
+			if(filename == null)
+				return;
+			ccd.dumpControllerTrace(filename);
+			hashTable.put("Controller Trace Filename",new String(filename));
+		}
+		catch(CCDLibraryNativeException e)
+		{
+			o.error(this.getClass().getName()+":getControllerTraceStatus:Dump controller trace failed.",e);
+		}
+	}
 }
 
 //
@@ -72,6 +72,8 @@ public class MULTBIASImplementation extends CALIBRATEImplementation implements J
 	 * <li>We call checkNonWindowedSetup to ensure we are configured to read out the whole frame.
 	 * <li>The status object's exposure count and exposure number are setup.
 	 * <li>The filename object's Multrun and exposure code are setup.
+	 * <li>If configured, we call startMasterCombine to combine the bias frames into a master bias as they are
+	 *     read out.
 	 * <li>For each bias frame:
 	 *	<ul>
 	 * 	<li>We generate some FITS headers from the CCD setup, the BSS and the ISS.
@@ -82,6 +84,8 @@ public class MULTBIASImplementation extends CALIBRATEImplementation implements J
 	 *      <li>We send a filename ACK containing the newly generated FITS filename.
 	 * 	<li>Keeps track of the generated filenames in the list.
 	 * 	</ul>
+	 * <li>If a combine was started, we call saveMasterCombine to save the master bias. If the exposures fail or
+	 *     are aborted, abortMasterCombine is called instead.
 	 * <li>For each bias frame just taken:
 	 *	<ul>
 	 *      <li>We call reduceCalibrate to reduce the BIAS frame.
@@ -106,6 +110,9 @@ public class MULTBIASImplementation extends CALIBRATEImplementation implements J
 	 * @see FITSImplementation#unLockFiles
 	 * @see ngat.o.ccd.CCDLibrary#bias
 	 * @see CALIBRATEImplementation#reduceCalibrate
+	 * @see CALIBRATEImplementation#startMasterCombine
+	 * @see CALIBRATEImplementation#saveMasterCombine
+	 * @see CALIBRATEImplementation#abortMasterCombine
 	 * @see OStatus#getMaxReadoutTime
 	 */
 	public COMMAND_DONE processCommand(COMMAND command)
@@ -116,6 +123,7 @@ public class MULTBIASImplementation extends CALIBRATEImplementation implements J
 		CALIBRATE_DP_ACK calibrateDpAck = null;
 		List reduceFilenameList = null;
 		String filename = null;
+		boolean combine = false;
 		int index;
 
 		if(testAbort(multBiasCommand,multBiasDone) == true)
@@ -140,83 +148,100 @@ public class MULTBIASImplementation extends CALIBRATEImplementation implements J
 			multBiasDone.setSuccessful(false);
 			return multBiasDone;
 		}
-	// do exposures
-		index = 0;
-		reduceFilenameList = new Vector();
-		while(index < multBiasCommand.getNumberExposures())
+	// combine the frames into a master bias as they are read out, if configured
+		combine = startMasterCombine(multBiasCommand,"o.multbias");
+		try
 		{
-		// clear pause and resume times.
-			status.clearPauseResumeTimes();
-			// fits headers
-			clearFitsHeaders();
-			if(setFitsHeaders(multBiasCommand,multBiasDone,FitsHeaderDefaults.OBSTYPE_VALUE_BIAS,0,
-					  multBiasCommand.getNumberExposures()) == false)
-				return multBiasDone;
-			if(getFitsHeadersFromISS(multBiasCommand,multBiasDone) == false)
-				return multBiasDone;
-			if(getFitsHeadersFromBSS(multBiasCommand,multBiasDone) == false)
-				return multBiasDone;
-			if(testAbort(multBiasCommand,multBiasDone) == true)
-				return multBiasDone;
-			// get a new filename.
-			oFilename.nextRunNumber();
-			filename = oFilename.getFilename();
-			if(saveFitsHeaders(multBiasCommand,multBiasDone,filename) == false)
+		// do exposures
+			index = 0;
+			reduceFilenameList = new Vector();
+			while(index < multBiasCommand.getNumberExposures())
 			{
-				unLockFile(multBiasCommand,multBiasDone,filename);
-				return multBiasDone;
-			}
-			status.setExposureFilename(filename);
-			// do exposure
-			try
+			// clear pause and resume times.
+				status.clearPauseResumeTimes();
+				// fits headers
+				clearFitsHeaders();
+				if(setFitsHeaders(multBiasCommand,multBiasDone,FitsHeaderDefaults.OBSTYPE_VALUE_BIAS,0,
+						  multBiasCommand.getNumberExposures()) == false)
+					return multBiasDone;
+				if(getFitsHeadersFromISS(multBiasCommand,multBiasDone) == false)
+					return multBiasDone;
+				if(getFitsHeadersFromBSS(multBiasCommand,multBiasDone) == false)
+					return multBiasDone;
+				if(testAbort(multBiasCommand,multBiasDone) == true)
+					return multBiasDone;
+				// get a new filename.
+				oFilename.nextRunNumber();
+				filename = oFilename.getFilename();
+				if(saveFitsHeaders(multBiasCommand,multBiasDone,filename) == false)
+				{
+					unLockFile(multBiasCommand,multBiasDone,filename);
+					return multBiasDone;
+				}
+				status.setExposureFilename(filename);
+				// do exposure
+				try
+				{
+					ccd.bias(filename);
+				}
+				catch(CCDLibraryNativeException e)
+				{
+					o.error(this.getClass().getName()+":processCommand:"+
+						multBiasCommand+":"+e.toString());
+					multBiasDone.setFilename(filename);
+					multBiasDone.setErrorNum(OConstants.O_ERROR_CODE_BASE+2603);
+					multBiasDone.setErrorString(e.toString());
+					multBiasDone.setSuccessful(false);
+					unLockFile(command,multBiasDone,filename);
+					return multBiasDone;
+				}
+				// remove lock files created in saveFitsHeaders
+				if(unLockFile(multBiasCommand,multBiasDone,filename) == false)
+					return multBiasDone;
+				// Test abort status.
+				if(testAbort(multBiasCommand,multBiasDone) == true)
+					return multBiasDone;
+			// send acknowledge to say frame is completed.
+				filenameAck = new FILENAME_ACK(multBiasCommand.getId());
+				filenameAck.setTimeToComplete(serverConnectionThread.getDefaultAcknowledgeTime()+
+							      status.getMaxReadoutTime());
+				filenameAck.setFilename(filename);
+				try
+				{
+					serverConnectionThread.sendAcknowledge(filenameAck);
+				}
+				catch(IOException e)
+				{
+					o.error(this.getClass().getName()+
+						":processCommand:sendAcknowledge:"+command+":"+e.toString(),e);
+					multBiasDone.setErrorNum(OConstants.O_ERROR_CODE_BASE+2601);
+					multBiasDone.setErrorString(e.toString());
+					multBiasDone.setSuccessful(false);
+					return multBiasDone;
+				}
+				status.setExposureNumber(index+1);
+			// add filename to list for data pipeline processing.
+				reduceFilenameList.add(filename);
+			// test whether an abort has occured.
+				if(testAbort(multBiasCommand,multBiasDone) == true)
+				{
+					return multBiasDone;
+				}
+				index++;
+			}/* end while */
+		// save the combined master bias
+			if(combine)
 			{
-				ccd.bias(filename);
+				saveMasterCombine(multBiasCommand,filename);
+				combine = false;
 			}
-			catch(CCDLibraryNativeException e)
-			{
-				o.error(this.getClass().getName()+":processCommand:"+
-					multBiasCommand+":"+e.toString());
-				multBiasDone.setFilename(filename);
-				multBiasDone.setErrorNum(OConstants.O_ERROR_CODE_BASE+2603);
-				multBiasDone.setErrorString(e.toString());
-				multBiasDone.setSuccessful(false);
-				unLockFile(command,multBiasDone,filename);
-				return multBiasDone;
-			}
-			// remove lock files created in saveFitsHeaders
-			if(unLockFile(multBiasCommand,multBiasDone,filename) == false)
-				return multBiasDone;
-			// Test abort status.
-			if(testAbort(multBiasCommand,multBiasDone) == true)
-				return multBiasDone;
-		// send acknowledge to say frame is completed.
-			filenameAck = new FILENAME_ACK(multBiasCommand.getId());
-			filenameAck.setTimeToComplete(serverConnectionThread.getDefaultAcknowledgeTime()+
-						      status.getMaxReadoutTime());
-			filenameAck.setFilename(filename);
-			try
-			{
-				serverConnectionThread.sendAcknowledge(filenameAck);
-			}
-			catch(IOException e)
-			{
-				o.error(this.getClass().getName()+
-					":processCommand:sendAcknowledge:"+command+":"+e.toString(),e);
-				multBiasDone.setErrorNum(OConstants.O_ERROR_CODE_BASE+2601);
-				multBiasDone.setErrorString(e.toString());
-				multBiasDone.setSuccessful(false);
-				return multBiasDone;
-			}
-			status.setExposureNumber(index+1);
-		// add filename to list for data pipeline processing.
-			reduceFilenameList.add(filename);
-		// test whether an abort has occured.
-			if(testAbort(multBiasCommand,multBiasDone) == true)
-			{
-				return multBiasDone;
-			}
-			index++;
-		}/* end while */
+		}
+		finally
+		{
+			// free the combine if the exposures failed or were aborted
+			if(combine)
+				abortMasterCombine(multBiasCommand);
+		}
 		// start reduction loop
 		index = 0;
 		while(index < multBiasCommand.getNumberExposures())
@@ -73,6 +73,8 @@ public class MULTDARKImplementation extends CALIBRATEImplementation implements J
 	 * <li>We call checkNonWindowedSetup to ensure we are configured to read out the whole frame.
 	 * <li>The status object's exposure count and exposure number are setup.
 	 * <li>The filename object's Multrun and exposure code are setup.
+	 * <li>If configured, we call startMasterCombine to combine the dark frames into a master dark as they are
+	 *     read out.
 	 * <li>For each dark frame:
 	 *	<ul>
 	 * 	<li>We generate some FITS headers from the CCD setup, the ISS and the BSS.
@@ -83,6 +85,8 @@ public class MULTDARKImplementation extends CALIBRATEImplementation implements J
 	 *      <li>We send a filename ACK containing the newly generated FITS filename.
 	 * 	<li>Keeps track of the generated filenames in the list.
 	 * 	</ul>
+	 * <li>If a combine was started, we call saveMasterCombine to save the master dark. If the exposures fail or
+	 *     are aborted, abortMasterCombine is called instead.
 	 * <li>For each dark frame just taken:
 	 *	<ul>
 	 *      <li>We call reduceCalibrate to reduce the DARK frame.
@@ -107,6 +111,9 @@ public class MULTDARKImplementation extends CALIBRATEImplementation implements J
 	 * @see FITSImplementation#unLockFiles
 	 * @see ngat.o.ccd.CCDLibrary#expose
 	 * @see CALIBRATEImplementation#reduceCalibrate
+	 * @see CALIBRATEImplementation#startMasterCombine
+	 * @see CALIBRATEImplementation#saveMasterCombine
+	 * @see CALIBRATEImplementation#abortMasterCombine
 	 * @see OStatus#getMaxReadoutTime
 	 */
 	public COMMAND_DONE processCommand(COMMAND command)
@@ -117,6 +124,7 @@ public class MULTDARKImplementation extends CALIBRATEImplementation implements J
 		CALIBRATE_DP_ACK calibrateDpAck = null;
 		List reduceFilenameList = null;
 		String filename = null;
+		boolean combine = false;
 		int index;
 
 
@@ -142,83 +150,100 @@ public class MULTDARKImplementation extends CALIBRATEImplementation implements J
 			multDarkDone.setSuccessful(false);
 			return multDarkDone;
 		}
-	// do exposures
-		index = 0;
-		reduceFilenameList = new Vector();
-		while(index < multDarkCommand.getNumberExposures())
+	// combine the frames into a master dark as they are read out, if configured
+		combine = startMasterCombine(multDarkCommand,"o.multdark");
+		try
 		{
-		// clear pause and resume times.
-			status.clearPauseResumeTimes();
-			// fits headers
-			clearFitsHeaders();
-			if(setFitsHeaders(multDarkCommand,multDarkDone,FitsHeaderDefaults.OBSTYPE_VALUE_DARK,
-				multDarkCommand.getExposureTime(),multDarkCommand.getNumberExposures()) == false)
-				return multDarkDone;
-			if(getFitsHeadersFromISS(multDarkCommand,multDarkDone) == false)
-				return multDarkDone;
-			if(getFitsHeadersFromBSS(multDarkCommand,multDarkDone) == false)
-				return multDarkDone;
-			if(testAbort(multDarkCommand,multDarkDone) == true)
-				return multDarkDone;
-			// get a new filename.
-			oFilename.nextRunNumber();
-			filename = oFilename.getFilename();
-			if(saveFitsHeaders(multDarkCommand,multDarkDone,filename) == false)
+		// do exposures
+			index = 0;
+			reduceFilenameList = new Vector();
+			while(index < multDarkCommand.getNumberExposures())
 			{
-				unLockFile(multDarkCommand,multDarkDone,filename);
-				return multDarkDone;
-			}
-			status.setExposureFilename(filename);
-			// do exposure
-			try
+			// clear pause and resume times.
+				status.clearPauseResumeTimes();
+				// fits headers
+				clearFitsHeaders();
+				if(setFitsHeaders(multDarkCommand,multDarkDone,FitsHeaderDefaults.OBSTYPE_VALUE_DARK,
+					multDarkCommand.getExposureTime(),multDarkCommand.getNumberExposures()) == false)
+					return multDarkDone;
+				if(getFitsHeadersFromISS(multDarkCommand,multDarkDone) == false)
+					return multDarkDone;
+				if(getFitsHeadersFromBSS(multDarkCommand,multDarkDone) == false)
+					return multDarkDone;
+				if(testAbort(multDarkCommand,multDarkDone) == true)
+					return multDarkDone;
+				// get a new filename.
+				oFilename.nextRunNumber();
+				filename = oFilename.getFilename();
+				if(saveFitsHeaders(multDarkCommand,multDarkDone,filename) == false)
+				{
+					unLockFile(multDarkCommand,multDarkDone,filename);
+					return multDarkDone;
+				}
+				status.setExposureFilename(filename);
+				// do exposure
+				try
+				{
+					ccd.expose(false,-1,multDarkCommand.getExposureTime(),filename);
+				}
+				catch(CCDLibraryNativeException e)
+				{
+					o.error(this.getClass().getName()+":processCommand:"+
+						multDarkCommand+":"+e.toString());
+					multDarkDone.setFilename(filename);
+					multDarkDone.setErrorNum(OConstants.O_ERROR_CODE_BASE+2701);
+					multDarkDone.setErrorString(e.toString());
+					multDarkDone.setSuccessful(false);
+					unLockFile(command,multDarkDone,filename);
+					return multDarkDone;
+				}
+				// remove lock files created in saveFitsHeaders
+				if(unLockFile(multDarkCommand,multDarkDone,filename) == false)
+					return multDarkDone;
+				// Test abort status.
+				if(testAbort(multDarkCommand,multDarkDone) == true)
+					return multDarkDone;
+			// send acknowledge to say frame is completed.
+				filenameAck = new FILENAME_ACK(multDarkCommand.getId());
+				filenameAck.setTimeToComplete(multDarkCommand.getExposureTime()+status.getMaxReadoutTime()+
+							      serverConnectionThread.getDefaultAcknowledgeTime());
+				filenameAck.setFilename(filename);
+				try
+				{
+					serverConnectionThread.sendAcknowledge(filenameAck);
+				}
+				catch(IOException e)
+				{
+					o.error(this.getClass().getName()+
+						":processCommand:sendAcknowledge:"+command+":"+e.toString(),e);
+					multDarkDone.setErrorNum(OConstants.O_ERROR_CODE_BASE+2702);
+					multDarkDone.setErrorString(e.toString());
+					multDarkDone.setSuccessful(false);
+					return multDarkDone;
+				}
+				status.setExposureNumber(index+1);
+			// add filename to list for data pipeline processing.
+				reduceFilenameList.add(filename);
+			// test whether an abort has occured.
+				if(testAbort(multDarkCommand,multDarkDone) == true)
+				{
+					return multDarkDone;
+				}
+				index++;
+			}/* end while */
+		// save the combined master dark
+			if(combine)
 			{
-				ccd.expose(false,-1,multDarkCommand.getExposureTime(),filename);
+				saveMasterCombine(multDarkCommand,filename);
+				combine = false;
 			}
-			catch(CCDLibraryNativeException e)
-			{
-				o.error(this.getClass().getName()+":processCommand:"+
-					multDarkCommand+":"+e.toString());
-				multDarkDone.setFilename(filename);
-				multDarkDone.setErrorNum(OConstants.O_ERROR_CODE_BASE+2701);
-				multDarkDone.setErrorString(e.toString());
-				multDarkDone.setSuccessful(false);
-				unLockFile(command,multDarkDone,filename);
-				return multDarkDone;
-			}
-			// remove lock files created in saveFitsHeaders
-			if(unLockFile(multDarkCommand,multDarkDone,filename) == false)
-				return multDarkDone;
-			// Test abort status.
-			if(testAbort(multDarkCommand,multDarkDone) == true)
-				return multDarkDone;
-		// send acknowledge to say frame is completed.
-			filenameAck = new FILENAME_ACK(multDarkCommand.getId());
-			filenameAck.setTimeToComplete(multDarkCommand.getExposureTime()+status.getMaxReadoutTime()+
-						      serverConnectionThread.getDefaultAcknowledgeTime());
-			filenameAck.setFilename(filename);
-			try
-			{
-				serverConnectionThread.sendAcknowledge(filenameAck);
-			}
-			catch(IOException e)
-			{
-				o.error(this.getClass().getName()+
-					":processCommand:sendAcknowledge:"+command+":"+e.toString(),e);
-				multDarkDone.setErrorNum(OConstants.O_ERROR_CODE_BASE+2702);
-				multDarkDone.setErrorString(e.toString());
-				multDarkDone.setSuccessful(false);
-				return multDarkDone;
-			}
-			status.setExposureNumber(index+1);
-		// add filename to list for data pipeline processing.
-			reduceFilenameList.add(filename);
-		// test whether an abort has occured.
-			if(testAbort(multDarkCommand,multDarkDone) == true)
-			{
-				return multDarkDone;
-			}
-			index++;
-		}/* end while */
+		}
+		finally
+		{
+			// free the combine if the exposures failed or were aborted
+			if(combine)
+				abortMasterCombine(multDarkCommand);
+		}
 		// start reduction loop
 		index = 0;
 		while(index < multDarkCommand.getNumberExposures())
@@ -126,6 +126,11 @@ public class O
 	 * The port number to listen for Telescope Image Transfer requests.
 	 */
 	private int titPortNumber = 0;
+	/**
+	 * The object used to send commands to the ISS, BSS and DP(RT), using a pool of worker threads.
+	 * @see OTCPClientConnectionManager
+	 */
+	private OTCPClientConnectionManager clientConnectionManager = null;
 	/**
 	 * The logging logger.
 	 */
@@ -187,6 +192,7 @@ public class O
 	 * @see #ndFilterArduino
 	 * @see #libngatfits
 	 * @see #fitsHeaderDefaults
+	 * @see #clientConnectionManager
 	 * @see #initLoggers
 	 * @see #implementationList
 	 * @see #initImplementationList
@@ -243,6 +249,8 @@ public class O
 	// create hardware control objects
 		ccd = new CCDLibrary();
 		ndFilterArduino = new NDFilterArduino();
+	// create the manager used to send commands to the ISS/BSS/DpRt
+		clientConnectionManager = new OTCPClientConnectionManager(this);
 	// initialise sub-system loggers, after creating status, hardware control objects
 		setLogLevel(logLevel);
 	// Create instance of the FITS header JNI library.
@@ -884,6 +892,22 @@ public class O
 	 * <li>It gets it's configuration from the O config file.
 	 * <li>The CCD library is initialised, the interface opened, and the controller setup.
 	 * <li>It calls configurePixelStream to configure pixel stream entries (de-interlacing)
+	 * <li>If o.ccd.telemetry.period is greater than zero, the telemetry sampler thread is started, 
+	 *     sampling with that period in milliseconds. Before this, if o.ccd.telemetry.store.filename is set,
+	 *     the telemetry store ring file is opened, with o.ccd.telemetry.store.record_count records.
+	 * <li>Direct disc writing of image data is configured from o.ccd.disk_write.enable and o.ccd.disk_write.fsync.
+	 * <li>If o.ccd.frame_ring.name is set, the shared memory frame ring read out frames are published into is
+	 *     created, with o.ccd.frame_ring.slot_count slots of o.ccd.frame_ring.slot_pixel_count pixels.
+	 * <li>Quick-look previews are configured from o.ccd.preview.enable, o.ccd.preview.directory,
+	 *     o.ccd.preview.bin_factors, o.ccd.preview.percentile.low and o.ccd.preview.percentile.high.
+	 * <li>Controller request tracing is turned on or off from o.ccd.trace.enable (on if not present).
+	 * <li>Retaining read out frames in memory for viewing is turned on or off from o.ccd.frame_view.enable
+	 *     (off if not present).
+	 * <li>If o.ccd.readout_watchdog.poll_period is set, the readout watchdog is configured from it,
+	 *     o.ccd.readout_watchdog.stall_factor, o.ccd.readout_watchdog.stall_time.min,
+	 *     o.ccd.readout_watchdog.stall_time.unknown and o.ccd.readout_watchdog.slow_ratio.
+	 * <li>If o.ccd.start_approach.time is set, the final approach to a timed exposure start is configured
+	 *     from it and o.ccd.start_approach.priority.
 	 * <li>The connection information to the neutral density filter slide arduino is configured.
 	 * </ul>
 	 * @exception CCDLibraryFormatException Thrown if the configuration properties cannot be determined.
@@ -908,10 +932,22 @@ public class O
 	 * @see ngat.o.ccd.CCDLibrary#setShutterStartTimeOffset
 	 * @see ngat.o.ccd.CCDLibrary#setShutterCloseDelay
 	 * @see ngat.o.ccd.CCDLibrary#setReadoutDelay
+	 * @see ngat.o.ccd.CCDLibrary#diskWriteFsyncFromString
+	 * @see ngat.o.ccd.CCDLibrary#setDiskWrite
+	 * @see ngat.o.ccd.CCDLibrary#frameRingOpen
+	 * @see ngat.o.ccd.CCDLibrary#previewBinFactorListFromString
+	 * @see ngat.o.ccd.CCDLibrary#setPreview
+	 * @see ngat.o.ccd.CCDLibrary#setControllerTraceEnable
+	 * @see ngat.o.ccd.CCDLibrary#setFrameViewEnable
+	 * @see ngat.o.ccd.CCDLibrary#setReadoutWatchdogConfig
+	 * @see ngat.o.ccd.CCDLibrary#setStartApproach
+	 * @see ngat.o.ccd.CCDLibrary#telemetryStoreOpen
+	 * @see ngat.o.ccd.CCDLibrary#telemetryStart
 	 * @see ngat.o.ndfilter.NDFilterArduino
 	 * @see ngat.o.ndfilter.NDFilterArduino#setAddress
 	 * @see ngat.o.ndfilter.NDFilterArduino#setPortNumber
 	 * @see ngat.phase2.OConfig#O_FILTER_INDEX_FILTER_WHEEL
+	 * @see #configureCompression
 	 */
 	public void startupController() throws CCDLibraryFormatException, CCDLibraryNativeException, Exception
 	{
@@ -919,11 +955,19 @@ public class O
 		int pciLoadType,timingLoadType,timingApplicationNumber,utilityLoadType,utilityApplicationNumber,gain;
 		int startExposureClearTime,startExposureOffsetTime,readoutRemainingTime;
 		int shutterTriggerDelay,shutterOpenDelay,shutterStartTimeOffset,shutterCloseDelay,readoutDelay;
-		int filterWheelFilterCount,ndFilterArduinoPortNumber;
+		int filterWheelFilterCount,ndFilterArduinoPortNumber,telemetryPeriod,telemetryStoreRecordCount;
+		int diskWriteFsyncPolicy,frameRingSlotCount,frameRingSlotPixelCount;
+		int readoutWatchdogPollPeriod,readoutWatchdogMinStallTime,readoutWatchdogUnknownStallTime;
+		int startApproachTime;
+		int previewBinFactorList[] = null;
 		long memoryMapLength;
-		double targetTemperature;
-		boolean gainSpeed,idle,filterWheelEnable;
+		double targetTemperature,previewLowPercentile,previewHighPercentile;
+		double readoutWatchdogStallFactor,readoutWatchdogSlowRatio;
+		boolean gainSpeed,idle,filterWheelEnable,diskWriteEnable,previewEnable,traceEnable;
+		boolean frameViewEnable;
+		boolean startApproachPriority;
 		String devicePathname,pciFilename,timingFilename,utilityFilename,ndFilterArduinoAddress;
+		String telemetryStoreFilename,frameRingName,previewDirectory;
 
 	// get the relevant configuration information from the O configuration file.
 	// CCDLibraryFormatException is caught and re-thrown by this method.
@@ -966,6 +1010,105 @@ public class O
 			shutterStartTimeOffset = status.getPropertyInteger("o.config.shutter.start_time_offset");
 			shutterCloseDelay = status.getPropertyInteger("o.config.shutter.close_delay");
 			readoutDelay = status.getPropertyInteger("o.config.readout_delay");
+			// telemetry sampler period, 0 (or not present) to disable
+			if(status.propertyContainsKey("o.ccd.telemetry.period"))
+				telemetryPeriod = status.getPropertyInteger("o.ccd.telemetry.period");
+			else
+				telemetryPeriod = 0;
+			// telemetry store ring file, not opened if the filename is not present
+			telemetryStoreFilename = status.getProperty("o.ccd.telemetry.store.filename");
+			if(telemetryStoreFilename != null)
+			{
+				telemetryStoreRecordCount = status.
+					getPropertyInteger("o.ccd.telemetry.store.record_count");
+			}
+			else
+				telemetryStoreRecordCount = 0;
+			// direct disc writing of image data, disabled if not present
+			if(status.propertyContainsKey("o.ccd.disk_write.enable"))
+				diskWriteEnable = status.getPropertyBoolean("o.ccd.disk_write.enable");
+			else
+				diskWriteEnable = false;
+			if(status.propertyContainsKey("o.ccd.disk_write.fsync"))
+			{
+				diskWriteFsyncPolicy = CCDLibrary.diskWriteFsyncFromString(status.
+					getProperty("o.ccd.disk_write.fsync"));
+			}
+			else
+				diskWriteFsyncPolicy = CCDLibrary.DISK_WRITE_FSYNC_NONE;
+			// shared memory frame ring, not opened if the name is not present
+			frameRingName = status.getProperty("o.ccd.frame_ring.name");
+			if(frameRingName != null)
+			{
+				frameRingSlotCount = status.getPropertyInteger("o.ccd.frame_ring.slot_count");
+				frameRingSlotPixelCount = status.getPropertyInteger("o.ccd.frame_ring.slot_pixel_count");
+			}
+			else
+			{
+				frameRingSlotCount = 0;
+				frameRingSlotPixelCount = 0;
+			}
+			// quick-look previews, disabled if not present
+			if(status.propertyContainsKey("o.ccd.preview.enable"))
+				previewEnable = status.getPropertyBoolean("o.ccd.preview.enable");
+			else
+				previewEnable = false;
+			if(previewEnable)
+			{
+				previewDirectory = status.getProperty("o.ccd.preview.directory");
+				previewBinFactorList = CCDLibrary.previewBinFactorListFromString(status.
+					getProperty("o.ccd.preview.bin_factors"));
+				previewLowPercentile = status.getPropertyDouble("o.ccd.preview.percentile.low");
+				previewHighPercentile = status.getPropertyDouble("o.ccd.preview.percentile.high");
+			}
+			else
+			{
+				previewDirectory = null;
+				previewLowPercentile = 0.0;
+				previewHighPercentile = 100.0;
+			}
+			// controller request tracing, enabled if not present
+			if(status.propertyContainsKey("o.ccd.trace.enable"))
+				traceEnable = status.getPropertyBoolean("o.ccd.trace.enable");
+			else
+				traceEnable = true;
+			// retaining read out frames for viewing, disabled if not present
+			if(status.propertyContainsKey("o.ccd.frame_view.enable"))
+				frameViewEnable = status.getPropertyBoolean("o.ccd.frame_view.enable");
+			else
+				frameViewEnable = false;
+			// readout watchdog, library defaults used if not present
+			if(status.propertyContainsKey("o.ccd.readout_watchdog.poll_period"))
+			{
+				readoutWatchdogPollPeriod = status.
+					getPropertyInteger("o.ccd.readout_watchdog.poll_period");
+				readoutWatchdogStallFactor = status.
+					getPropertyDouble("o.ccd.readout_watchdog.stall_factor");
+				readoutWatchdogMinStallTime = status.
+					getPropertyInteger("o.ccd.readout_watchdog.stall_time.min");
+				readoutWatchdogUnknownStallTime = status.
+					getPropertyInteger("o.ccd.readout_watchdog.stall_time.unknown");
+				readoutWatchdogSlowRatio = status.getPropertyDouble("o.ccd.readout_watchdog.slow_ratio");
+			}
+			else
+			{
+				readoutWatchdogPollPeriod = 0;
+				readoutWatchdogStallFactor = 0.0;
+				readoutWatchdogMinStallTime = 0;
+				readoutWatchdogUnknownStallTime = 0;
+				readoutWatchdogSlowRatio = 0.0;
+			}
+			// timed exposure start final approach, library defaults used if not present
+			if(status.propertyContainsKey("o.ccd.start_approach.time"))
+			{
+				startApproachTime = status.getPropertyInteger("o.ccd.start_approach.time");
+				startApproachPriority = status.getPropertyBoolean("o.ccd.start_approach.priority");
+			}
+			else
+			{
+				startApproachTime = -1;
+				startApproachPriority = false;
+			}
 			// NDFilter slide configuration information
 			ndFilterArduinoAddress = status.getProperty("o.config.filter_slide.address");
 			ndFilterArduinoPortNumber = status.getPropertyInteger("o.config.filter_slide.port_number");
@@ -979,6 +1122,8 @@ public class O
 		try
 		{
 			ccd.initialise();
+			ccd.setControllerTraceEnable(traceEnable);
+			ccd.setFrameViewEnable(frameViewEnable);
 			ccd.setTextPrintLevel(textPrintLevel);
 			ccd.interfaceOpen(deviceNumber,devicePathname);
 			ccd.setup(pciLoadType,pciFilename,memoryMapLength,
@@ -995,6 +1140,29 @@ public class O
 			ccd.setShutterStartTimeOffset(shutterStartTimeOffset);
 			ccd.setShutterCloseDelay(shutterCloseDelay);
 			ccd.setReadoutDelay(readoutDelay);
+			ccd.setDiskWrite(diskWriteEnable,diskWriteFsyncPolicy);
+			if(readoutWatchdogPollPeriod > 0)
+			{
+				ccd.setReadoutWatchdogConfig(readoutWatchdogPollPeriod,readoutWatchdogStallFactor,
+							     readoutWatchdogMinStallTime,readoutWatchdogUnknownStallTime,
+							     readoutWatchdogSlowRatio);
+			}
+			if(startApproachTime > -1)
+				ccd.setStartApproach(startApproachTime,startApproachPriority);
+			if(frameRingName != null)
+				ccd.frameRingOpen(frameRingName,frameRingSlotCount,frameRingSlotPixelCount);
+			if(previewEnable)
+			{
+				ccd.setPreview(previewEnable,previewDirectory,previewBinFactorList,previewLowPercentile,
+					       previewHighPercentile);
+			}
+			// telemetry sampler
+			if(telemetryPeriod > 0)
+			{
+				if(telemetryStoreFilename != null)
+					ccd.telemetryStoreOpen(telemetryStoreFilename,telemetryStoreRecordCount);
+				ccd.telemetryStart(telemetryPeriod);
+			}
 		}
 		catch (CCDLibraryNativeException e)
 		{
@@ -1014,20 +1182,30 @@ public class O
 		}
 		// configure pixel stream entries
 		configurePixelStream();
+		// configure default image compression
+		configureCompression(null);
 	}
 
 	/**
 	 * Method to shut down the connection to the hardware controllers.
 	 * <ul>
+	 * <li>The telemetry sampler thread is stopped (it uses the interface), and the telemetry store closed.
+	 * <li>The shared memory frame ring is closed.
 	 * <li>The CCD setup is shutdown (memory map), and the interface closed.
 	 * </ul>
 	 * @exception CCDLibraryNativeException Thrown if the device failed to shut down.
 	 * @see #ccd
+	 * @see ngat.o.ccd.CCDLibrary#telemetryStop
+	 * @see ngat.o.ccd.CCDLibrary#telemetryStoreClose
+	 * @see ngat.o.ccd.CCDLibrary#frameRingClose
 	 * @see ngat.o.ccd.CCDLibrary#setupShutdown
 	 * @see ngat.o.ccd.CCDLibrary#interfaceClose
 	 */
 	public void shutdownController() throws CCDLibraryNativeException
 	{
+		ccd.telemetryStop();
+		ccd.telemetryStoreClose();
+		ccd.frameRingClose();
 		ccd.setupShutdown();
 		ccd.interfaceClose();
 	}
@@ -1082,6 +1260,53 @@ public class O
 		log(Logging.VERBOSITY_VERBOSE,this.getClass().getName()+":configurePixelStream:Finished.");
 	}
 
+	/**
+	 * Configure whether the images taken by a command are saved tile-compressed. The compression type is
+	 * read from the "o.ccd.compress.type.&lt;command&gt;" property (where &lt;command&gt; is the command's class
+	 * name without the package, i.e. MULTRUN), if it exists, otherwise "o.ccd.compress.type". Both are
+	 * one of NONE or RICE, if neither exists images are saved uncompressed. The number of threads used to compress
+	 * each image is read from "o.ccd.compress.thread_count".
+	 * @param command The command about to be run, or null to configure the default compression.
+	 * @exception CCDLibraryNativeException Thrown if setCompression fails.
+	 * @exception CCDLibraryFormatException Thrown if compressionTypeFromString fails.
+	 * @exception NumberFormatException Thrown if the thread count is not a valid integer.
+	 * @see #ccd
+	 * @see #status
+	 * @see OStatus#getProperty
+	 * @see OStatus#getPropertyInteger
+	 * @see ngat.o.ccd.CCDLibrary#compressionTypeFromString
+	 * @see ngat.o.ccd.CCDLibrary#setCompression
+	 */
+	public void configureCompression(ngat.message.base.COMMAND command) throws CCDLibraryNativeException,
+		CCDLibraryFormatException, NumberFormatException
+	{
+		String typeString = null;
+		String commandName = null;
+		int type,threadCount;
+
+		if(command != null)
+		{
+			commandName = command.getClass().getName();
+			commandName = commandName.substring(commandName.lastIndexOf('.')+1);
+			typeString = status.getProperty("o.ccd.compress.type."+commandName);
+		}
+		if(typeString == null)
+			typeString = status.getProperty("o.ccd.compress.type");
+		if(typeString == null)
+			typeString = "NONE";
+		type = CCDLibrary.compressionTypeFromString(typeString);
+		if(status.propertyContainsKey("o.ccd.compress.thread_count"))
+			threadCount = status.getPropertyInteger("o.ccd.compress.thread_count");
+		else
+			threadCount = 1;
+		if((type != ccd.getCompressionType())||(command == null))
+		{
+			log(Logging.VERBOSITY_VERBOSE,this.getClass().getName()+":configureCompression:"+
+			    commandName+":type:"+typeString+":thread count:"+threadCount+".");
+		}
+		ccd.setCompression(type,threadCount);
+	}
+
 	/**
 	 * This is the run routine. It starts a new server to handle incoming requests, and waits for the
 	 * server to terminate. A thread monitor is also started if it was requested from the command line.
@@ -1138,12 +1363,14 @@ public class O
 
 	/**
 	 * Routine to be called at the end of execution of O to close down communications.
-	 * Currently closes CCDLibrary, OTCPServer and TitServer.
+	 * Currently closes CCDLibrary, OTCPServer, TitServer and the client connection manager.
 	 * @see OTCPServer#close
 	 * @see #server
 	 * @see TitServer#close
 	 * @see #titServer
 	 * @see #shutdownController
+	 * @see #clientConnectionManager
+	 * @see OTCPClientConnectionManager#close
 	 */
 	public void close()
 	{
@@ -1157,6 +1384,17 @@ public class O
 		}
 		server.close();
 		titServer.close();
+		clientConnectionManager.close();
+	}
+
+	/**
+	 * Get the manager used to send commands to the ISS, BSS and DP(RT).
+	 * @return The client connection manager.
+	 * @see #clientConnectionManager
+	 */
+	public OTCPClientConnectionManager getClientConnectionManager()
+	{
+		return clientConnectionManager;
 	}
 
 	/**
@@ -1303,7 +1541,8 @@ public class O
 	 * @see #issAddress
 	 * @see #issPortNumber
 	 * @see #sendISSCommand(INST_TO_ISS,OTCPServerConnectionThread,boolean)
-	 * @see OTCPClientConnectionThread
+	 * @see #clientConnectionManager
+	 * @see OTCPClientConnectionManager#sendCommand
 	 * @see OTCPServerConnectionThread#getAbortProcessCommand
 	 */
 	public INST_TO_ISS_DONE sendISSCommand(INST_TO_ISS command,OTCPServerConnectionThread commandThread)
@@ -1325,43 +1564,20 @@ public class O
 	 * 	if the done was null.
 	 * @see #issAddress
 	 * @see #issPortNumber
-	 * @see OTCPClientConnectionThread
+	 * @see #clientConnectionManager
+	 * @see OTCPClientConnectionManager#sendCommand
 	 * @see OTCPServerConnectionThread#getAbortProcessCommand
 	 */
 	public INST_TO_ISS_DONE sendISSCommand(INST_TO_ISS command,OTCPServerConnectionThread commandThread,
 		boolean checkAbort)
 	{
-		OTCPClientConnectionThread thread = null;
 		INST_TO_ISS_DONE done = null;
-		boolean finished = false;
 
 		log(Logging.VERBOSITY_VERY_TERSE,
 			this.getClass().getName()+":sendISSCommand:"+command.getClass().getName());
-		thread = new OTCPClientConnectionThread(issAddress,issPortNumber,command,commandThread);
-		thread.setO(this);
-		thread.start();
-		finished = false;
-		while(finished == false)
-		{
-			try
-			{
-				thread.join(100);// wait 100 millis for the thread to finish
-			}
-			catch(InterruptedException e)
-			{
-				error("run:join interrupted:",e);
-			}
-		// If the thread has finished so has this loop
-			finished = (thread.isAlive() == false);
-		// check if the thread has been aborted, if checkAbort has been set.
-			if(checkAbort)
-			{
-			// If the commandThread has been aborted, stop processing this thread
-				if(commandThread.getAbortProcessCommand())
-					finished = true;
-			}
-		}
-		done = (INST_TO_ISS_DONE)thread.getDone();
+		// wait for the done, or (if checkAbort is set) for the commandThread to be aborted
+		done = (INST_TO_ISS_DONE)clientConnectionManager.sendCommand(issAddress,issPortNumber,command,
+									      commandThread,checkAbort);
 		if(done == null)
 		{
 			// one reason the done is null is if we escaped from the loop
@@ -1404,7 +1620,8 @@ public class O
 	 * @see #issAddress
 	 * @see #issPortNumber
 	 * @see #sendBSSCommand(INST_TO_BSS,OTCPServerConnectionThread,boolean)
-	 * @see OTCPClientConnectionThread
+	 * @see #clientConnectionManager
+	 * @see OTCPClientConnectionManager#sendCommand
 	 * @see OTCPServerConnectionThread#getAbortProcessCommand
 	 */
 	public INST_TO_BSS_DONE sendBSSCommand(INST_TO_BSS command,OTCPServerConnectionThread commandThread)
@@ -1428,45 +1645,22 @@ public class O
 	 * @see #bssUse
 	 * @see #bssAddress
 	 * @see #bssPortNumber
-	 * @see OTCPClientConnectionThread
+	 * @see #clientConnectionManager
+	 * @see OTCPClientConnectionManager#sendCommand
 	 * @see OTCPServerConnectionThread#getAbortProcessCommand
 	 */
 	public INST_TO_BSS_DONE sendBSSCommand(INST_TO_BSS command,OTCPServerConnectionThread commandThread,
 					       boolean checkAbort)
 	{
-		OTCPClientConnectionThread thread = null;
 		INST_TO_BSS_DONE done = null;
-		boolean finished = false;
 
 		log(Logging.VERBOSITY_VERY_TERSE,
 			this.getClass().getName()+":sendBSSCommand:"+command.getClass().getName());
 		if(bssUse)
 		{
-			thread = new OTCPClientConnectionThread(bssAddress,bssPortNumber,command,commandThread);
-			thread.setO(this);
-			thread.start();
-			finished = false;
-			while(finished == false)
-			{
-				try
-				{
-					thread.join(100);// wait 100 millis for the thread to finish
-				}
-				catch(InterruptedException e)
-				{
-					error("sendBSSCommand:join interrupted:",e);
-				}
-				// If the thread has finished so has this loop
-				finished = (thread.isAlive() == false);
-				// check if the thread has been aborted, if checkAbort has been set.
-				if(checkAbort)
-				{
-					// If the commandThread has been aborted, stop processing this thread
-					if(commandThread.getAbortProcessCommand())
-						finished = true;
-				}
-			}
-			done = (INST_TO_BSS_DONE)thread.getDone();
+			// wait for the done, or (if checkAbort is set) for the commandThread to be aborted
+			done = (INST_TO_BSS_DONE)clientConnectionManager.sendCommand(bssAddress,bssPortNumber,command,
+									commandThread,checkAbort);
 			if(done == null)
 			{
 				// one reason the done is null is if we escaped from the loop
@@ -1526,45 +1720,22 @@ public class O
 	 * @see #bssUse
 	 * @see #bssAddress
 	 * @see #bssPortNumber
-	 * @see OTCPClientConnectionThread
+	 * @see #clientConnectionManager
+	 * @see OTCPClientConnectionManager#sendCommand
 	 * @see OTCPServerConnectionThread#getAbortProcessCommand
 	 */
 	public RCS_TO_BSS_DONE sendBSSCommand(RCS_TO_BSS command,OTCPServerConnectionThread commandThread,
 					       boolean checkAbort)
 	{
-		OTCPClientConnectionThread thread = null;
 		RCS_TO_BSS_DONE done = null;
-		boolean finished = false;
 
 		log(Logging.VERBOSITY_VERY_TERSE,
 			this.getClass().getName()+":sendBSSCommand:"+command.getClass().getName());
 		if(bssUse)
 		{
-			thread = new OTCPClientConnectionThread(bssAddress,bssPortNumber,command,commandThread);
-			thread.setO(this);
-			thread.start();
-			finished = false;
-			while(finished == false)
-			{
-				try
-				{
-					thread.join(100);// wait 100 millis for the thread to finish
-				}
-				catch(InterruptedException e)
-				{
-					error("sendBSSCommand:join interrupted:",e);
-				}
-				// If the thread has finished so has this loop
-				finished = (thread.isAlive() == false);
-				// check if the thread has been aborted, if checkAbort has been set.
-				if(checkAbort)
-				{
-					// If the commandThread has been aborted, stop processing this thread
-					if(commandThread.getAbortProcessCommand())
-						finished = true;
-				}
-			}
-			done = (RCS_TO_BSS_DONE)thread.getDone();
+			// wait for the done, or (if checkAbort is set) for the commandThread to be aborted
+			done = (RCS_TO_BSS_DONE)clientConnectionManager.sendCommand(bssAddress,bssPortNumber,command,
+									commandThread,checkAbort);
 			if(done == null)
 			{
 				// one reason the done is null is if we escaped from the loop
@@ -1618,38 +1789,19 @@ public class O
 	 * 	if the done was null.
 	 * @see #dprtAddress
 	 * @see #dprtPortNumber
-	 * @see OTCPClientConnectionThread
+	 * @see #clientConnectionManager
+	 * @see OTCPClientConnectionManager#sendCommand
 	 * @see OTCPServerConnectionThread#getAbortProcessCommand
 	 */
 	public INST_TO_DP_DONE sendDpRtCommand(INST_TO_DP command,OTCPServerConnectionThread commandThread)
 	{
-		OTCPClientConnectionThread thread = null;
 		INST_TO_DP_DONE done = null;
-		boolean finished = false;
 
 		log(Logging.VERBOSITY_VERY_TERSE,
 			this.getClass().getName()+":sendDpRtCommand:"+command.getClass().getName());
-		thread = new OTCPClientConnectionThread(dprtAddress,dprtPortNumber,command,commandThread);
-		thread.setO(this);
-		thread.start();
-		finished = false;
-		while(finished == false)
-		{
-			try
-			{
-				thread.join(100);// wait 100 millis for the thread to finish
-			}
-			catch(InterruptedException e)
-			{
-				error("run:join interrupted:",e);
-			}
-		// If the thread has finished so has this loop
-			finished = (thread.isAlive() == false);
-		// If the commandThread has been aborted, stop processing this thread
-			if(commandThread.getAbortProcessCommand())
-				finished = true;
-		}
-		done = (INST_TO_DP_DONE)thread.getDone();
+		// wait for the done, or for the commandThread to be aborted
+		done = (INST_TO_DP_DONE)clientConnectionManager.sendCommand(dprtAddress,dprtPortNumber,command,
+									     commandThread,true);
 		if(done == null)
 		{
 			// one reason the done is null is if we escaped from the loop
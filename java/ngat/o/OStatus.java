@@ -60,10 +60,12 @@ public class OStatus
 	 */
 	private ISS_TO_INST currentCommand = null;
 	/**
-	 * A list of properties held in the properties file. This contains configuration information in O
-	 * that needs to be changed irregularily.
+	 * The properties held in the properties files, compiled into indexed tables.
+	 * This contains configuration information in O that needs to be changed irregularily.
+	 * A new instance is built by load/reload and swapped in with a single assignment, so
+	 * the getters never see a partially loaded set of properties, and don't need to be synchronized.
 	 */
-	private Properties properties = null;
+	private volatile OStatusProperties properties = null;
 	/**
 	 * The count of the number of exposures needed for the current command to be implemented.
 	 */
@@ -116,12 +118,13 @@ public class OStatus
 	{
 		pauseTimeList = new Vector();
 		resumeTimeList = new Vector();
-		properties = new Properties();
+		properties = new OStatusProperties(new Properties());
 	}
 
 	/**
 	 * The load method for the class. This loads the property file from disc, using the specified
-	 * filename. Any old properties are first cleared.
+	 * filename. Any old properties are discarded. The files are loaded into a new properties object, which is
+	 * compiled and then replaces the current properties, so a failed load leaves the current properties in use.
 	 * The configId unique persistent integer is then initialised, using a filename stored in the properties.
 	 * @param netFilename The filename of a Java property file containing network configuration for O.
 	 * 	If netFilename is null, DEFAULT_NET_PROPERTY_FILE_NAME is used.
@@ -145,34 +148,37 @@ public class OStatus
 	public void load(String netFilename,String filename,
 		String currentFilterFilename, String filterFilename) throws FileNotFoundException, IOException
 	{
+		Properties newProperties = null;
 		FileInputStream fileInputStream = null;
 
-	// clear old properties
-		properties.clear();
+	// load into new properties, the old ones are discarded when the new ones are swapped in
+		newProperties = new Properties();
 	// network properties load
 		if(netFilename == null)
 			netFilename = DEFAULT_NET_PROPERTY_FILE_NAME;
 		fileInputStream = new FileInputStream(netFilename);
-		properties.load(fileInputStream);
+		newProperties.load(fileInputStream);
 		fileInputStream.close();
 	// normal properties load
 		if(filename == null)
 			filename = DEFAULT_PROPERTY_FILE_NAME;
 		fileInputStream = new FileInputStream(filename);
-		properties.load(fileInputStream);
+		newProperties.load(fileInputStream);
 		fileInputStream.close();
 	// current filter properties load
 		if(currentFilterFilename == null)
 			currentFilterFilename = DEFAULT_CURRENT_FILTER_PROPERTY_FILE_NAME;
 		fileInputStream = new FileInputStream(currentFilterFilename);
-		properties.load(fileInputStream);
+		newProperties.load(fileInputStream);
 		fileInputStream.close();
 	// filter properties load
 		if(filterFilename == null)
 			filterFilename = DEFAULT_FILTER_PROPERTY_FILE_NAME;
 		fileInputStream = new FileInputStream(filterFilename);
-		properties.load(fileInputStream);
+		newProperties.load(fileInputStream);
 		fileInputStream.close();
+	// compile and swap in
+		properties = new OStatusProperties(newProperties);
 	// initialise configId
 		initialiseConfigId();
 	}
@@ -182,7 +188,9 @@ public class OStatus
 	 * The current properties are not cleared, as network properties are not re-loaded, as this would
 	 * involve resetting up the server connection thread which may be in use. If properties have been
 	 * deleted from the loaded files, reload does not clear these properties. Any new properties or
-	 * ones where the values have changed will change.
+	 * ones where the values have changed will change. The files are loaded into a copy of the current properties,
+	 * which is compiled and then replaces the current properties, so commands running during a reload
+	 * see either the old or the new configuration, never a mixture.
 	 * The configId unique persistent integer is then initialised, using a filename stored in the properties.
 	 * @param filename The filename of a Java property file containing general configuration for O.
 	 * 	If filename is null, DEFAULT_PROPERTY_FILE_NAME is used.
@@ -204,27 +212,32 @@ public class OStatus
 	public void reload(String filename,
 		String currentFilterFilename,String filterFilename) throws FileNotFoundException,IOException
 	{
+		Properties newProperties = null;
 		FileInputStream fileInputStream = null;
 
 	// don't clear old properties, the network properties are not re-loaded
+		newProperties = new Properties();
+		newProperties.putAll(properties.getProperties());
 	// normal properties load
 		if(filename == null)
 			filename = DEFAULT_PROPERTY_FILE_NAME;
 		fileInputStream = new FileInputStream(filename);
-		properties.load(fileInputStream);
+		newProperties.load(fileInputStream);
 		fileInputStream.close();
 	// current filter properties load
 		if(currentFilterFilename == null)
 			currentFilterFilename = DEFAULT_CURRENT_FILTER_PROPERTY_FILE_NAME;
 		fileInputStream = new FileInputStream(currentFilterFilename);
-		properties.load(fileInputStream);
+		newProperties.load(fileInputStream);
 		fileInputStream.close();
 	// filter properties load
 		if(filterFilename == null)
 			filterFilename = DEFAULT_FILTER_PROPERTY_FILE_NAME;
 		fileInputStream = new FileInputStream(filterFilename);
-		properties.load(fileInputStream);
+		newProperties.load(fileInputStream);
 		fileInputStream.close();
+	// compile and swap in
+		properties = new OStatusProperties(newProperties);
 	// initialise configId
 		initialiseConfigId();
 	}
@@ -544,6 +557,7 @@ public class OStatus
 	/**
 	 * Routine to get a properties value, given a key. The value must be a valid integer, else a 
 	 * NumberFormatException is thrown.
+	 * The parsed value is cached in the compiled properties, so the value is only parsed once per load/reload.
 	 * @param p The property key we want the value for.
 	 * @return The properties value, as an integer.
 	 * @exception NumberFormatException If the properties value string is not a valid integer, this
@@ -552,13 +566,18 @@ public class OStatus
 	 */
 	public int getPropertyInteger(String p) throws NumberFormatException
 	{
+		OStatusProperties currentProperties = null;
 		String valueString = null;
-		int returnValue = 0;
+		Integer returnValue = null;
 
-		valueString = properties.getProperty(p);
+		currentProperties = properties;
+		returnValue = currentProperties.getCachedInteger(p);
+		if(returnValue != null)
+			return returnValue.intValue();
+		valueString = currentProperties.getProperty(p);
 		try
 		{
-			returnValue = Integer.parseInt(valueString);
+			returnValue = Integer.valueOf(valueString);
 		}
 		catch(NumberFormatException e)
 		{
@@ -566,12 +585,14 @@ public class OStatus
 			throw new NumberFormatException(this.getClass().getName()+":getPropertyInteger:keyword:"+
 				p+":valueString:"+valueString);
 		}
-		return returnValue;
+		currentProperties.setCachedInteger(p,returnValue);
+		return returnValue.intValue();
 	}
 
 	/**
 	 * Routine to get a properties value, given a key. The value must be a valid long, else a 
 	 * NumberFormatException is thrown.
+	 * The parsed value is cached in the compiled properties, so the value is only parsed once per load/reload.
 	 * @param p The property key we want the value for.
 	 * @return The properties value, as a long.
 	 * @exception NumberFormatException If the properties value string is not a valid long, this
@@ -580,13 +601,18 @@ public class OStatus
 	 */
 	public long getPropertyLong(String p) throws NumberFormatException
 	{
+		OStatusProperties currentProperties = null;
 		String valueString = null;
-		long returnValue = 0;
+		Long returnValue = null;
 
-		valueString = properties.getProperty(p);
+		currentProperties = properties;
+		returnValue = currentProperties.getCachedLong(p);
+		if(returnValue != null)
+			return returnValue.longValue();
+		valueString = currentProperties.getProperty(p);
 		try
 		{
-			returnValue = Long.parseLong(valueString);
+			returnValue = Long.valueOf(valueString);
 		}
 		catch(NumberFormatException e)
 		{
@@ -594,12 +620,14 @@ public class OStatus
 			throw new NumberFormatException(this.getClass().getName()+":getPropertyLong:keyword:"+
 				p+":valueString:"+valueString);
 		}
-		return returnValue;
+		currentProperties.setCachedLong(p,returnValue);
+		return returnValue.longValue();
 	}
 
 	/**
 	 * Routine to get a properties value, given a key. The value must be a valid double, else a 
 	 * NumberFormatException is thrown.
+	 * The parsed value is cached in the compiled properties, so the value is only parsed once per load/reload.
 	 * @param p The property key we want the value for.
 	 * @return The properties value, as an double.
 	 * @exception NumberFormatException If the properties value string is not a valid double, this
@@ -608,10 +636,15 @@ public class OStatus
 	 */
 	public double getPropertyDouble(String p) throws NumberFormatException
 	{
+		OStatusProperties currentProperties = null;
 		String valueString = null;
 		Double returnValue = null;
 
-		valueString = properties.getProperty(p);
+		currentProperties = properties;
+		returnValue = currentProperties.getCachedDouble(p);
+		if(returnValue != null)
+			return returnValue.doubleValue();
+		valueString = currentProperties.getProperty(p);
 		try
 		{
 			returnValue = Double.valueOf(valueString);
@@ -622,12 +655,14 @@ public class OStatus
 			throw new NumberFormatException(this.getClass().getName()+":getPropertyDouble:keyword:"+
 				p+":valueString:"+valueString);
 		}
+		currentProperties.setCachedDouble(p,returnValue);
 		return returnValue.doubleValue();
 	}
 
 	/**
 	 * Routine to get a properties value, given a key. The value must be a valid float, else a 
 	 * NumberFormatException is thrown.
+	 * The parsed value is cached in the compiled properties, so the value is only parsed once per load/reload.
 	 * @param p The property key we want the value for.
 	 * @return The properties value, as a float.
 	 * @exception NumberFormatException If the properties value string is not a valid float, this
@@ -636,10 +671,15 @@ public class OStatus
 	 */
 	public float getPropertyFloat(String p) throws NumberFormatException
 	{
+		OStatusProperties currentProperties = null;
 		String valueString = null;
 		Float returnValue = null;
 
-		valueString = properties.getProperty(p);
+		currentProperties = properties;
+		returnValue = currentProperties.getCachedFloat(p);
+		if(returnValue != null)
+			return returnValue.floatValue();
+		valueString = currentProperties.getProperty(p);
 		try
 		{
 			returnValue = Float.valueOf(valueString);
@@ -650,6 +690,7 @@ public class OStatus
 			throw new NumberFormatException(this.getClass().getName()+":getPropertyFloat:keyword:"+
 				p+":valueString:"+valueString);
 		}
+		currentProperties.setCachedFloat(p,returnValue);
 		return returnValue.floatValue();
 	}
 
@@ -749,6 +790,8 @@ public class OStatus
 	 * Method to get the position of a filter in a filter wheel. The wheel index and type name of the 
 	 * filter are passed in. The number of the filter in this filter
 	 * wheel is returned, or an IllegalArgumentException is thrown if the filter type name does not exist.
+	 * The position is looked up in the compiled filter wheel table, the properties are only scanned if
+	 * the table does not contain the filter (to generate the same exceptions as before).
 	 * @param wheelIndex Which wheel the filter is in. Note the index is 1-based, i.e. 1-3 for IO:O. See
 	 *        O_FILTER_INDEX_FILTER_WHEEL / O_FILTER_INDEX_FILTER_SLIDE_LOWER / O_FILTER_INDEX_FILTER_SLIDE_UPPER.
 	 * @param filterTypeName The type name of the filter.
@@ -758,6 +801,7 @@ public class OStatus
 	 * @exception NumberFormatException Thrown if some of the properties are not a valid integer when
 	 * 	they should be.
 	 * @see #getPropertyInteger
+	 * @see #properties
 	 * @see ngat.phase2.OConfig#O_FILTER_INDEX_FILTER_WHEEL
 	 * @see ngat.phase2.OConfig#O_FILTER_INDEX_FILTER_SLIDE_LOWER
 	 * @see ngat.phase2.OConfig#O_FILTER_INDEX_FILTER_SLIDE_UPPER
@@ -777,6 +821,10 @@ public class OStatus
 			throw new IllegalArgumentException(this.getClass().getName()+
 				":getFilterWheelPosition:Wheel Index:"+wheelIndex+" out of range.");
 		}
+	// try the compiled filter wheel table
+		filterWheelFilterIndex = properties.getFilterWheelPosition(wheelIndex,filterTypeName);
+		if(filterWheelFilterIndex > -1)
+			return filterWheelFilterIndex;
 	// get number of filters in this wheel.
 		filterWheelFilterCount = getPropertyInteger("filterwheel."+wheelIndex+".count");
 	// compare type name against filters in wheel. Stop when we find the first match.
@@ -808,6 +856,7 @@ public class OStatus
 	 * Method to get the type name of a filter in a filter wheel. The wheel index and position of the wheel 
 	 * are passed in. The type name of the filter in that position 
 	 * in the filter wheel is returned, or an IllegalArgumentException is thrown if the position does not exist.
+	 * The compiled filter wheel table is used where possible.
 	 * @param wheelIndex Which wheel the filter is in. Note the index is 1-based, i.e. 1-3 for IO:O. See
 	 *        O_FILTER_INDEX_FILTER_WHEEL / O_FILTER_INDEX_FILTER_SLIDE_LOWER / O_FILTER_INDEX_FILTER_SLIDE_UPPER.
 	 * @param filterWheelPosition The position of that filter wheel.
@@ -817,6 +866,7 @@ public class OStatus
 	 * @exception NumberFormatException Thrown if some of the properties are not a valid integer when
 	 * 	they should be.
 	 * @see #getPropertyInteger
+	 * @see #properties
 	 * @see ngat.phase2.OConfig#O_FILTER_INDEX_FILTER_WHEEL
 	 * @see ngat.phase2.OConfig#O_FILTER_INDEX_FILTER_SLIDE_LOWER
 	 * @see ngat.phase2.OConfig#O_FILTER_INDEX_FILTER_SLIDE_UPPER
@@ -834,6 +884,10 @@ public class OStatus
 			throw new IllegalArgumentException(this.getClass().getName()+
 				":getFilterTypeName:Wheel Index:"+wheelIndex+" out of range.");
 		}
+	// try the compiled filter wheel table
+		s = properties.getFilterTypeName(wheelIndex,filterWheelPosition);
+		if(s != null)
+			return s;
 	// check position is legal
 		filterWheelFilterCount = getPropertyInteger("filterwheel."+wheelIndex+".count");
 		if((filterWheelPosition < 0)||(filterWheelPosition >= filterWheelFilterCount))
@@ -865,6 +919,9 @@ public class OStatus
 		String s = null;
 
 	// get the filter id name into s
+		s = properties.getFilterIdName(filterTypeName);
+		if(s != null)
+			return s;
 		s = getProperty("filterwheel."+filterTypeName+".id");
 		if(s == null)
 		{
@@ -888,7 +945,11 @@ public class OStatus
 	public double getFilterIdOpticalThickness(String filterIdName) throws NumberFormatException
 	{
 		String s = null;
+		Double d = null;
 
+		d = properties.getFilterIdOpticalThickness(filterIdName);
+		if(d != null)
+			return d.doubleValue();
 	// get the filter id name into s
 		s = getProperty("filter."+filterIdName+".optical_thickness");
 		if(s == null)
@@ -913,7 +974,11 @@ public class OStatus
 	public double getFilterIdWaveLength(String filterIdName) throws NumberFormatException
 	{
 		String s = null;
+		Double d = null;
 
+		d = properties.getFilterIdWaveLength(filterIdName);
+		if(d != null)
+			return d.doubleValue();
 	// get the filter id name into s
 		s = getProperty("filter."+filterIdName+".center");
 		if(s == null)
@@ -931,13 +996,20 @@ public class OStatus
 	 * dimensions to be sent to the controller depending on the binning setting, to stop bias strips appearing
 	 * in the centre of the image, or missing central columns.
 	 * This information is stored in the O property file, under the 'o.ccd.config.ncols.<binning factor>' property.
+	 * The value is looked up in the compiled per-binning table.
 	 * @param xbin The X binning factor to get the number of columns for.
 	 * @return An integer, the number of columns to configure the controller with.
 	 * @exception NumberFormatException Thrown if the property cannot be found, or parsed into a valid int.
+	 * @see #properties
 	 * @see #getPropertyInteger
 	 */
 	public int getNumberColumns(int xbin) throws NumberFormatException
 	{
+		int retval;
+
+		retval = properties.getNumberColumns(xbin);
+		if(retval > -1)
+			return retval;
 		return getPropertyInteger("o.ccd.config.ncols."+xbin);
 	}
 
@@ -947,13 +1019,20 @@ public class OStatus
 	 * dimensions to be sent to the controller depending on the binning setting, to stop bias strips appearing
 	 * in the centre of the image, or missing central rows.
 	 * This information is stored in the O property file, under the 'o.ccd.config.nrows.<binning factor>' property.
+	 * The value is looked up in the compiled per-binning table.
 	 * @param ybin The Y binning factor to get the number of rows for.
 	 * @return An integer, the number of rows to configure the controller with.
 	 * @exception NumberFormatException Thrown if the property cannot be found, or parsed into a valid int.
+	 * @see #properties
 	 * @see #getPropertyInteger
 	 */
 	public int getNumberRows(int ybin) throws NumberFormatException
 	{
+		int retval;
+
+		retval = properties.getNumberRows(ybin);
+		if(retval > -1)
+			return retval;
 		return getPropertyInteger("o.ccd.config.nrows."+ybin);
 	}
 
@@ -0,0 +1,466 @@
+// OStatusProperties.java
+// $Header$
+package ngat.o;
+
+import java.lang.*;
+import java.util.*;
+
+import ngat.phase2.*;
+
+/**
+ * This class holds a compiled copy of the O properties. When an instance is constructed, the filter wheel
+ * tables, filter id database and per-binning readout dimensions are parsed from the properties into
+ * indexed tables, so that OStatus lookups (e.g. getFilterWheelPosition, getNumberColumns) are a
+ * single hashtable/array lookup, rather than building string keys and scanning the properties each call.
+ * Numeric property values are parsed once, the first time they are asked for, and cached.
+ * <p>An instance is never changed after construction (apart from the numeric value caches), OStatus
+ * builds a new instance on load/reload and swaps it in, so readers always see a complete set of properties.
+ * <p>The tables are only built for properties that are valid. If they are not (e.g. a missing filter
+ * count), the lookup methods return null/-1, and OStatus falls back to the property based lookup, which
+ * throws the same exceptions as it always did.
+ * @author Chris Mottram
+ * @version $Revision$
+ * @see OStatus
+ */
+public class OStatusProperties
+{
+	/**
+	 * Revision Control System id string, showing the version of the Class.
+	 */
+	public final static String RCSID = new String("$Id$");
+	/**
+	 * The properties this instance was compiled from. This must not be changed after construction.
+	 */
+	private Properties properties = null;
+	/**
+	 * Cache of property keys to parsed Integer values.
+	 */
+	private Hashtable integerCache = null;
+	/**
+	 * Cache of property keys to parsed Long values.
+	 */
+	private Hashtable longCache = null;
+	/**
+	 * Cache of property keys to parsed Double values.
+	 */
+	private Hashtable doubleCache = null;
+	/**
+	 * Cache of property keys to parsed Float values.
+	 */
+	private Hashtable floatCache = null;
+	/**
+	 * For each filter wheel index, an array of the filter type names in each position.
+	 * The array is indexed by wheel index (1-based, so element 0 is unused), and an element is null if the
+	 * wheel's properties were not valid.
+	 */
+	private String filterTypeNameList[][] = null;
+	/**
+	 * For each filter wheel index, a hashtable of filter type name to the (first) position
+	 * (an Integer) of that filter in the wheel. Indexed as filterTypeNameList.
+	 * @see #filterTypeNameList
+	 */
+	private Hashtable filterPositionTable[] = null;
+	/**
+	 * A hashtable mapping filter type names to filter id names
+	 * (the 'filterwheel.&lt;filterTypeName&gt;.id' properties).
+	 */
+	private Hashtable filterIdTable = null;
+	/**
+	 * A hashtable mapping filter id names to their optical thickness, as a Double
+	 * (the valid 'filter.&lt;filterIdName&gt;.optical_thickness' properties).
+	 */
+	private Hashtable filterOpticalThicknessTable = null;
+	/**
+	 * A hashtable mapping filter id names to their central wavelength, as a Double
+	 * (the valid 'filter.&lt;filterIdName&gt;.center' properties).
+	 */
+	private Hashtable filterWaveLengthTable = null;
+	/**
+	 * A hashtable mapping X binning factors (Integer) to the number of columns to read out (Integer)
+	 * (the valid 'o.ccd.config.ncols.&lt;binning factor&gt;' properties).
+	 */
+	private Hashtable numberColumnsTable = null;
+	/**
+	 * A hashtable mapping Y binning factors (Integer) to the number of rows to read out (Integer)
+	 * (the valid 'o.ccd.config.nrows.&lt;binning factor&gt;' properties).
+	 */
+	private Hashtable numberRowsTable = null;
+
+	/**
+	 * Constructor. Takes ownership of the properties (they must not be changed afterwards), and compiles them.
+	 * @param p The properties to compile.
+	 * @see #properties
+	 * @see #compileFilterWheels
+	 * @see #compileFilterDatabase
+	 * @see #compileDimensions
+	 */
+	public OStatusProperties(Properties p)
+	{
+		super();
+		properties = p;
+		integerCache = new Hashtable();
+		longCache = new Hashtable();
+		doubleCache = new Hashtable();
+		floatCache = new Hashtable();
+		compileFilterWheels();
+		compileFilterDatabase();
+		compileDimensions();
+	}
+
+	/**
+	 * Get the properties this instance was compiled from. The returned object must not be modified.
+	 * @return The properties.
+	 * @see #properties
+	 */
+	public Properties getProperties()
+	{
+		return properties;
+	}
+
+	/**
+	 * Get a property value.
+	 * @param p The property key.
+	 * @return The value, or null if the key does not exist.
+	 */
+	public String getProperty(String p)
+	{
+		return properties.getProperty(p);
+	}
+
+	/**
+	 * Get whether the properties contain the specified key.
+	 * @param p The property key.
+	 * @return true if the key exists.
+	 */
+	public boolean containsKey(String p)
+	{
+		return properties.containsKey(p);
+	}
+
+	/**
+	 * Get a cached integer value.
+	 * @param p The property key.
+	 * @return The parsed value, or null if it has not been cached yet.
+	 * @see #integerCache
+	 */
+	public Integer getCachedInteger(String p)
+	{
+		return (Integer)(integerCache.get(p));
+	}
+
+	/**
+	 * Cache a parsed integer value.
+	 * @param p The property key.
+	 * @param i The parsed value.
+	 * @see #integerCache
+	 */
+	public void setCachedInteger(String p,Integer i)
+	{
+		integerCache.put(p,i);
+	}
+
+	/**
+	 * Get a cached long value.
+	 * @param p The property key.
+	 * @return The parsed value, or null if it has not been cached yet.
+	 * @see #longCache
+	 */
+	public Long getCachedLong(String p)
+	{
+		return (Long)(longCache.get(p));
+	}
+
+	/**
+	 * Cache a parsed long value.
+	 * @param p The property key.
+	 * @param l The parsed value.
+	 * @see #longCache
+	 */
+	public void setCachedLong(String p,Long l)
+	{
+		longCache.put(p,l);
+	}
+
+	/**
+	 * Get a cached double value.
+	 * @param p The property key.
+	 * @return The parsed value, or null if it has not been cached yet.
+	 * @see #doubleCache
+	 */
+	public Double getCachedDouble(String p)
+	{
+		return (Double)(doubleCache.get(p));
+	}
+
+	/**
+	 * Cache a parsed double value.
+	 * @param p The property key.
+	 * @param d The parsed value.
+	 * @see #doubleCache
+	 */
+	public void setCachedDouble(String p,Double d)
+	{
+		doubleCache.put(p,d);
+	}
+
+	/**
+	 * Get a cached float value.
+	 * @param p The property key.
+	 * @return The parsed value, or null if it has not been cached yet.
+	 * @see #floatCache
+	 */
+	public Float getCachedFloat(String p)
+	{
+		return (Float)(floatCache.get(p));
+	}
+
+	/**
+	 * Cache a parsed float value.
+	 * @param p The property key.
+	 * @param f The parsed value.
+	 * @see #floatCache
+	 */
+	public void setCachedFloat(String p,Float f)
+	{
+		floatCache.put(p,f);
+	}
+
+	/**
+	 * Get the position of a filter in a filter wheel.
+	 * @param wheelIndex Which wheel the filter is in (1-based).
+	 * @param filterTypeName The type name of the filter.
+	 * @return The (first) position of the filter in the wheel, or -1 if the wheel table was not compiled,
+	 *         or the filter is not in the wheel.
+	 * @see #filterPositionTable
+	 */
+	public int getFilterWheelPosition(int wheelIndex,String filterTypeName)
+	{
+		Integer position = null;
+
+		if((wheelIndex < 0)||(wheelIndex >= filterPositionTable.length)||
+		   (filterPositionTable[wheelIndex] == null)||(filterTypeName == null))
+			return -1;
+		position = (Integer)(filterPositionTable[wheelIndex].get(filterTypeName));
+		if(position == null)
+			return -1;
+		return position.intValue();
+	}
+
+	/**
+	 * Get the type name of the filter in a filter wheel position.
+	 * @param wheelIndex Which wheel the filter is in (1-based).
+	 * @param filterWheelPosition The position in the wheel.
+	 * @return The filter type name, or null if the wheel table was not compiled, or the position is not valid.
+	 * @see #filterTypeNameList
+	 */
+	public String getFilterTypeName(int wheelIndex,int filterWheelPosition)
+	{
+		if((wheelIndex < 0)||(wheelIndex >= filterTypeNameList.length)||
+		   (filterTypeNameList[wheelIndex] == null))
+			return null;
+		if((filterWheelPosition < 0)||(filterWheelPosition >= filterTypeNameList[wheelIndex].length))
+			return null;
+		return filterTypeNameList[wheelIndex][filterWheelPosition];
+	}
+
+	/**
+	 * Get a filter's id name from it's type name.
+	 * @param filterTypeName The filter type name.
+	 * @return The filter id name, or null if it is not known.
+	 * @see #filterIdTable
+	 */
+	public String getFilterIdName(String filterTypeName)
+	{
+		if(filterTypeName == null)
+			return null;
+		return (String)(filterIdTable.get(filterTypeName));
+	}
+
+	/**
+	 * Get a filter's optical thickness from it's id name.
+	 * @param filterIdName The filter id name.
+	 * @return The optical thickness, or null if it is not known.
+	 * @see #filterOpticalThicknessTable
+	 */
+	public Double getFilterIdOpticalThickness(String filterIdName)
+	{
+		if(filterIdName == null)
+			return null;
+		return (Double)(filterOpticalThicknessTable.get(filterIdName));
+	}
+
+	/**
+	 * Get a filter's central wavelength from it's id name.
+	 * @param filterIdName The filter id name.
+	 * @return The central wavelength, or null if it is not known.
+	 * @see #filterWaveLengthTable
+	 */
+	public Double getFilterIdWaveLength(String filterIdName)
+	{
+		if(filterIdName == null)
+			return null;
+		return (Double)(filterWaveLengthTable.get(filterIdName));
+	}
+
+	/**
+	 * Get the number of columns to read out for a binning factor.
+	 * @param xbin The X binning factor.
+	 * @return The number of columns, or -1 if it is not known.
+	 * @see #numberColumnsTable
+	 */
+	public int getNumberColumns(int xbin)
+	{
+		Integer i = null;
+
+		i = (Integer)(numberColumnsTable.get(new Integer(xbin)));
+		if(i == null)
+			return -1;
+		return i.intValue();
+	}
+
+	/**
+	 * Get the number of rows to read out for a binning factor.
+	 * @param ybin The Y binning factor.
+	 * @return The number of rows, or -1 if it is not known.
+	 * @see #numberRowsTable
+	 */
+	public int getNumberRows(int ybin)
+	{
+		Integer i = null;
+
+		i = (Integer)(numberRowsTable.get(new Integer(ybin)));
+		if(i == null)
+			return -1;
+		return i.intValue();
+	}
+
+	/**
+	 * Build the filter wheel tables from the 'filterwheel.&lt;wheelIndex&gt;.count' and
+	 * 'filterwheel.&lt;wheelIndex&gt;.&lt;position&gt;.type' properties. A wheel's table is left null
+	 * if the count is missing or not a valid number.
+	 * Missing type names are left null in the position list, and are not added to the position table.
+	 * @see #filterTypeNameList
+	 * @see #filterPositionTable
+	 * @see ngat.phase2.OConfig#O_FILTER_INDEX_FILTER_WHEEL
+	 * @see ngat.phase2.OConfig#O_FILTER_INDEX_FILTER_SLIDE_UPPER
+	 */
+	private void compileFilterWheels()
+	{
+		String s = null;
+		int count;
+
+		filterTypeNameList = new String[OConfig.O_FILTER_INDEX_FILTER_SLIDE_UPPER+1][];
+		filterPositionTable = new Hashtable[OConfig.O_FILTER_INDEX_FILTER_SLIDE_UPPER+1];
+		for(int wheelIndex = OConfig.O_FILTER_INDEX_FILTER_WHEEL;
+		    wheelIndex <= OConfig.O_FILTER_INDEX_FILTER_SLIDE_UPPER; wheelIndex++)
+		{
+			try
+			{
+				count = Integer.parseInt(properties.getProperty("filterwheel."+wheelIndex+".count"));
+			}
+			catch(NumberFormatException e)
+			{
+				continue;
+			}
+			if(count < 0)
+				continue;
+			filterTypeNameList[wheelIndex] = new String[count];
+			filterPositionTable[wheelIndex] = new Hashtable();
+			for(int i = 0; i < count; i++)
+			{
+				s = properties.getProperty("filterwheel."+wheelIndex+"."+i+".type");
+				filterTypeNameList[wheelIndex][i] = s;
+				// the position of the first filter of this type is returned
+				if((s != null) && (filterPositionTable[wheelIndex].containsKey(s) == false))
+					filterPositionTable[wheelIndex].put(s,new Integer(i));
+			}
+		}
+	}
+
+	/**
+	 * Build the filter id and filter database tables, by scanning the property keys once for
+	 * 'filterwheel.&lt;filterTypeName&gt;.id', 'filter.&lt;filterIdName&gt;.optical_thickness' and
+	 * 'filter.&lt;filterIdName&gt;.center' properties. Values that are not valid numbers are left out.
+	 * @see #filterIdTable
+	 * @see #filterOpticalThicknessTable
+	 * @see #filterWaveLengthTable
+	 */
+	private void compileFilterDatabase()
+	{
+		Enumeration e = null;
+		String key = null;
+		String value = null;
+
+		filterIdTable = new Hashtable();
+		filterOpticalThicknessTable = new Hashtable();
+		filterWaveLengthTable = new Hashtable();
+		e = properties.propertyNames();
+		while(e.hasMoreElements())
+		{
+			key = (String)(e.nextElement());
+			value = properties.getProperty(key);
+			if(value == null)
+				continue;
+			try
+			{
+				if(key.startsWith("filterwheel.") && key.endsWith(".id"))
+				{
+					filterIdTable.put(key.substring(12,key.length()-3),value);
+				}
+				else if(key.startsWith("filter.") && key.endsWith(".optical_thickness"))
+				{
+					filterOpticalThicknessTable.put(key.substring(7,key.length()-18),
+									Double.valueOf(value));
+				}
+				else if(key.startsWith("filter.") && key.endsWith(".center"))
+				{
+					filterWaveLengthTable.put(key.substring(7,key.length()-7),Double.valueOf(value));
+				}
+			}
+			catch(NumberFormatException nfe)
+			{
+				// leave invalid values out, the property based lookup throws the error
+			}
+		}
+	}
+
+	/**
+	 * Build the per-binning readout dimension tables from the 'o.ccd.config.ncols.&lt;binning factor&gt;'
+	 * and 'o.ccd.config.nrows.&lt;binning factor&gt;' properties.
+	 * @see #numberColumnsTable
+	 * @see #numberRowsTable
+	 */
+	private void compileDimensions()
+	{
+		Enumeration e = null;
+		String key = null;
+
+		numberColumnsTable = new Hashtable();
+		numberRowsTable = new Hashtable();
+		e = properties.propertyNames();
+		while(e.hasMoreElements())
+		{
+			key = (String)(e.nextElement());
+			try
+			{
+				if(key.startsWith("o.ccd.config.ncols."))
+				{
+					numberColumnsTable.put(Integer.valueOf(key.substring(19)),
+							       Integer.valueOf(properties.getProperty(key)));
+				}
+				else if(key.startsWith("o.ccd.config.nrows."))
+				{
+					numberRowsTable.put(Integer.valueOf(key.substring(19)),
+							    Integer.valueOf(properties.getProperty(key)));
+				}
+			}
+			catch(NumberFormatException nfe)
+			{
+				// leave invalid values out, the property based lookup throws the error
+			}
+		}
+	}
+}
+//
+// $Log: not supported by cvs2svn $
+//
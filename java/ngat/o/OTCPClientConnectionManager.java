@@ -0,0 +1,470 @@
+// OTCPClientConnectionManager.java
+// $Header$
+package ngat.o;
+
+import java.lang.*;
+import java.net.*;
+import java.util.*;
+
+import ngat.message.base.*;
+import ngat.util.logging.*;
+
+/**
+ * This class manages the sending of commands from O to the ISS, BSS and DP(RT).
+ * Previously each command started a new OTCPClientConnectionThread, and the sender polled it with
+ * join(100) until it finished, which cost a thread start per command and up to 100ms of latency
+ * on every reply. The manager instead keeps a pool of long lived worker threads, which run each
+ * command's OTCPClientConnectionThread (its run method is called directly on the worker), and the
+ * sender waits on a Request object which is notified as soon as the done message arrives, or as soon as
+ * the command thread is aborted (see abort).
+ * <p>The ISS/BSS/DP(RT) instrument protocol sends one command per socket connection (the server
+ * closes the connection after the DONE), so the socket itself cannot be kept open between commands.
+ * @author Chris Mottram
+ * @version $Revision$
+ * @see OTCPClientConnectionThread
+ */
+public class OTCPClientConnectionManager
+{
+	/**
+	 * Revision Control System id string, showing the version of the Class.
+	 */
+	public final static String RCSID = new String("$Id$");
+	/**
+	 * How long an idle worker thread waits for another command before exiting, in milliseconds.
+	 */
+	public final static long DEFAULT_WORKER_IDLE_TIMEOUT = 60000L;
+	/**
+	 * How long a sender waits before re-checking the command thread's abort status, in milliseconds.
+	 * Senders are normally woken immediately by the done message or by abort, this is a safety net.
+	 */
+	protected final static long ABORT_CHECK_TIMEOUT = 1000L;
+	/**
+	 * The O object.
+	 */
+	private O o = null;
+	/**
+	 * A list of requests that have been submitted but not yet picked up by a worker thread.
+	 */
+	private Vector pendingList = null;
+	/**
+	 * A list of requests that have been submitted but have not yet finished.
+	 * Used by abort to find the requests belonging to an aborted command thread.
+	 */
+	private Vector activeList = null;
+	/**
+	 * The number of worker threads currently running.
+	 */
+	private int workerCount = 0;
+	/**
+	 * The number of worker threads currently waiting for a request.
+	 */
+	private int idleWorkerCount = 0;
+	/**
+	 * How long an idle worker thread waits for another command before exiting, in milliseconds.
+	 */
+	private long workerIdleTimeout = DEFAULT_WORKER_IDLE_TIMEOUT;
+	/**
+	 * The number of requests sent since the manager was created.
+	 */
+	private long requestCount = 0L;
+	/**
+	 * The number of worker threads started since the manager was created.
+	 */
+	private long workerStartCount = 0L;
+	/**
+	 * Set when close is called, tells the worker threads to exit, and stops new requests being accepted.
+	 */
+	private boolean closed = false;
+
+	/**
+	 * Constructor.
+	 * @param o The O object, used for logging.
+	 * @see #pendingList
+	 * @see #activeList
+	 */
+	public OTCPClientConnectionManager(O o)
+	{
+		super();
+		this.o = o;
+		pendingList = new Vector();
+		activeList = new Vector();
+	}
+
+	/**
+	 * Set how long an idle worker thread waits for another command before exiting.
+	 * @param timeout The timeout, in milliseconds.
+	 * @see #workerIdleTimeout
+	 */
+	public synchronized void setWorkerIdleTimeout(long timeout)
+	{
+		workerIdleTimeout = timeout;
+	}
+
+	/**
+	 * Send a command to a server, and wait for the done message. The command is run by a pooled worker thread,
+	 * this thread waits until the done message has been received, the connection has failed, or
+	 * (if checkAbort is true) the commandThread has been aborted.
+	 * @param address The internet address to send the command to.
+	 * @param portNumber The port number to send the command to.
+	 * @param command The command to send.
+	 * @param commandThread The O server thread the command is being sent on behalf of. Acknowledgements
+	 *        returned by the server are passed on to it's client.
+	 * @param checkAbort Whether to stop waiting if commandThread is aborted.
+	 * @return The done message returned by the server, or null if the connection failed or the command thread
+	 *         was aborted.
+	 * @see #submit
+	 * @see OTCPClientConnectionManager.Request#waitForDone
+	 */
+	public COMMAND_DONE sendCommand(InetAddress address,int portNumber,COMMAND command,
+					OTCPServerConnectionThread commandThread,boolean checkAbort)
+	{
+		Request request = null;
+
+		request = submit(address,portNumber,command,commandThread);
+		return request.waitForDone(checkAbort);
+	}
+
+	/**
+	 * Submit a command to be sent to a server by a worker thread. If there are not enough idle worker threads
+	 * for the pending requests, a new one is started. If the manager has been closed, the command is not sent,
+	 * and the returned request has already failed (waitForDone returns null straight away).
+	 * @param address The internet address to send the command to.
+	 * @param portNumber The port number to send the command to.
+	 * @param command The command to send.
+	 * @param commandThread The O server thread the command is being sent on behalf of.
+	 * @return The request, which can be waited on for the done message.
+	 * @see #pendingList
+	 * @see #activeList
+	 * @see #idleWorkerCount
+	 * @see #closed
+	 * @see OTCPClientConnectionManager.Worker
+	 * @see OTCPClientConnectionManager.Request#fail
+	 */
+	public Request submit(InetAddress address,int portNumber,COMMAND command,
+			      OTCPServerConnectionThread commandThread)
+	{
+		OTCPClientConnectionThread connectionThread = null;
+		Request request = null;
+		Worker worker = null;
+
+		connectionThread = new OTCPClientConnectionThread(address,portNumber,command,commandThread);
+		connectionThread.setO(o);
+		request = new Request(connectionThread,commandThread);
+		synchronized(this)
+		{
+			if(closed)
+			{
+				o.error(this.getClass().getName()+":submit:Manager closed, "+
+					command.getClass().getName()+" not sent.");
+				request.fail();
+				return request;
+			}
+			requestCount++;
+			activeList.add(request);
+			pendingList.add(request);
+			if(pendingList.size() <= idleWorkerCount)
+				notify();
+			else
+			{
+				worker = new Worker();
+				workerCount++;
+				workerStartCount++;
+			}
+		}
+		if(worker != null)
+			worker.start();
+		return request;
+	}
+
+	/**
+	 * Wake up any senders waiting for a done message on behalf of the specified command thread.
+	 * This is called when the command thread is aborted, so that the sender can stop waiting straight away.
+	 * The commands themselves carry on in their worker threads until the servers reply.
+	 * @param commandThread The command thread that has been aborted.
+	 * @see #activeList
+	 * @see OTCPClientConnectionManager.Request#wakeUp
+	 */
+	public void abort(OTCPServerConnectionThread commandThread)
+	{
+		Request request = null;
+		Vector list = null;
+
+		synchronized(this)
+		{
+			list = new Vector(activeList);
+		}
+		for(int i = 0; i < list.size(); i++)
+		{
+			request = (Request)list.get(i);
+			if(request.getCommandThread() == commandThread)
+				request.wakeUp();
+		}
+	}
+
+	/**
+	 * Stop the worker threads. Workers currently sending a command finish that command first.
+	 * Requests that have been submitted but not yet picked up by a worker are failed, so their senders
+	 * stop waiting, and no new requests are accepted.
+	 * @see #closed
+	 * @see #pendingList
+	 * @see #activeList
+	 * @see OTCPClientConnectionManager.Request#fail
+	 */
+	public void close()
+	{
+		Vector list = null;
+
+		synchronized(this)
+		{
+			closed = true;
+			list = new Vector(pendingList);
+			pendingList.clear();
+			activeList.removeAll(list);
+			notifyAll();
+		}
+		for(int i = 0; i < list.size(); i++)
+		{
+			((Request)list.get(i)).fail();
+		}
+	}
+
+	/**
+	 * Get the number of worker threads currently running.
+	 * @return The number of worker threads.
+	 * @see #workerCount
+	 */
+	public synchronized int getWorkerCount()
+	{
+		return workerCount;
+	}
+
+	/**
+	 * Get the number of requests sent since the manager was created.
+	 * @return The number of requests.
+	 * @see #requestCount
+	 */
+	public synchronized long getRequestCount()
+	{
+		return requestCount;
+	}
+
+	/**
+	 * Get the number of worker threads started since the manager was created. If this is much
+	 * smaller than the request count, the worker threads are being re-used.
+	 * @return The number of worker threads started.
+	 * @see #workerStartCount
+	 */
+	public synchronized long getWorkerStartCount()
+	{
+		return workerStartCount;
+	}
+
+	/**
+	 * Called by a worker thread to get the next request to run. Waits up to workerIdleTimeout for a request.
+	 * @return The next request, or null if the worker thread should exit (it has been idle too long, or
+	 *         the manager has been closed). If null is returned, the worker count has been decremented.
+	 * @see #pendingList
+	 * @see #idleWorkerCount
+	 * @see #workerCount
+	 * @see #workerIdleTimeout
+	 */
+	protected synchronized Request getNextRequest()
+	{
+		long endTime,waitTime;
+
+		endTime = System.currentTimeMillis()+workerIdleTimeout;
+		while((pendingList.size() == 0) && (closed == false))
+		{
+			waitTime = endTime-System.currentTimeMillis();
+			if(waitTime <= 0)
+				break;
+			idleWorkerCount++;
+			try
+			{
+				wait(waitTime);
+			}
+			catch(InterruptedException e)
+			{
+			}
+			idleWorkerCount--;
+		}
+		if(closed || (pendingList.size() == 0))
+		{
+			workerCount--;
+			return null;
+		}
+		return (Request)(pendingList.remove(0));
+	}
+
+	/**
+	 * Called by a worker thread when a request has finished, to remove it from the active list.
+	 * @param request The request that has finished.
+	 * @see #activeList
+	 */
+	protected synchronized void requestFinished(Request request)
+	{
+		activeList.remove(request);
+	}
+
+	/**
+	 * A command sent to a server, which the sender can wait on for the done message.
+	 */
+	public class Request
+	{
+		/**
+		 * The client connection that sends the command and receives the acknowledgements and done.
+		 */
+		private OTCPClientConnectionThread connectionThread = null;
+		/**
+		 * The O server thread the command is being sent on behalf of.
+		 */
+		private OTCPServerConnectionThread commandThread = null;
+		/**
+		 * Whether the connection has finished (the done has been received, or the connection has failed).
+		 */
+		private boolean finished = false;
+
+		/**
+		 * Constructor.
+		 * @param connectionThread The client connection that sends the command.
+		 * @param commandThread The O server thread the command is being sent on behalf of.
+		 */
+		public Request(OTCPClientConnectionThread connectionThread,OTCPServerConnectionThread commandThread)
+		{
+			super();
+			this.connectionThread = connectionThread;
+			this.commandThread = commandThread;
+		}
+
+		/**
+		 * Get the O server thread the command is being sent on behalf of.
+		 * @return The command thread.
+		 */
+		public OTCPServerConnectionThread getCommandThread()
+		{
+			return commandThread;
+		}
+
+		/**
+		 * Get whether the connection has finished.
+		 * @return true if the done has been received, or the connection has failed.
+		 */
+		public synchronized boolean isFinished()
+		{
+			return finished;
+		}
+
+		/**
+		 * Wait for the command to finish. The method returns as soon as the worker thread
+		 * has finished with the connection, or (if checkAbort is true) as soon as the command thread is aborted.
+		 * @param checkAbort Whether to stop waiting if the command thread is aborted.
+		 * @return The done message returned by the server, or null if the connection failed or
+		 *         the command thread was aborted.
+		 * @see #finished
+		 * @see #ABORT_CHECK_TIMEOUT
+		 * @see OTCPServerConnectionThread#getAbortProcessCommand
+		 */
+		public synchronized COMMAND_DONE waitForDone(boolean checkAbort)
+		{
+			while(finished == false)
+			{
+				if(checkAbort && commandThread.getAbortProcessCommand())
+					return null;
+				try
+				{
+					wait(ABORT_CHECK_TIMEOUT);
+				}
+				catch(InterruptedException e)
+				{
+					o.error(this.getClass().getName()+":waitForDone:wait interrupted:",e);
+				}
+			}
+			return connectionThread.getDone();
+		}
+
+		/**
+		 * Mark the request as finished without running the client connection, and wake up the sender.
+		 * Used when the manager is closed before the request is run. waitForDone then returns null,
+		 * as no done message was received.
+		 * @see #finished
+		 * @see OTCPClientConnectionManager#close
+		 */
+		protected synchronized void fail()
+		{
+			finished = true;
+			notifyAll();
+		}
+
+		/**
+		 * Wake up the sender waiting in waitForDone, so it re-checks whether it should stop waiting.
+		 */
+		public synchronized void wakeUp()
+		{
+			notifyAll();
+		}
+
+		/**
+		 * Run the client connection, in the calling (worker) thread. When it has finished, the sender
+		 * is woken up.
+		 * @see #finished
+		 */
+		protected void run()
+		{
+			try
+			{
+				connectionThread.run();
+			}
+			finally
+			{
+				synchronized(this)
+				{
+					finished = true;
+					notifyAll();
+				}
+			}
+		}
+	}
+
+	/**
+	 * A worker thread, which runs requests until it has been idle for workerIdleTimeout, or the manager
+	 * is closed.
+	 * @see #getNextRequest
+	 */
+	protected class Worker extends Thread
+	{
+		/**
+		 * Constructor.
+		 */
+		public Worker()
+		{
+			super("OTCPClientConnectionManager.Worker");
+			setDaemon(true);
+		}
+
+		/**
+		 * Run requests until getNextRequest returns null.
+		 * @see OTCPClientConnectionManager#getNextRequest
+		 * @see OTCPClientConnectionManager#requestFinished
+		 */
+		public void run()
+		{
+			Request request = null;
+
+			while((request = getNextRequest()) != null)
+			{
+				try
+				{
+					request.run();
+				}
+				catch(Exception e)
+				{
+					o.error(this.getClass().getName()+":run:Client connection failed:",e);
+				}
+				requestFinished(request);
+			}
+		}
+	}
+}
+//
+// $Log: not supported by cvs2svn $
+//
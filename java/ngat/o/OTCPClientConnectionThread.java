@@ -13,7 +13,9 @@ import ngat.message.base.*;
 /**
  * The OTCPClientConnectionThread extends TCPClientConnectionThread. 
  * It implements the generic ISS/DP(RT) instrument command protocol with multiple acknowledgements. 
- * O starts one of these threads each time it wishes to send a message to the ISS/DP(RT)/BSS.
+ * O creates one of these each time it wishes to send a message to the ISS/DP(RT)/BSS, and it is run
+ * by one of the OTCPClientConnectionManager worker threads.
+ * @see OTCPClientConnectionManager
  * @author Chris Mottram
  * @version $Revision: 1.2 $
  */
@@ -130,11 +130,20 @@ public class OTCPServerConnectionThread extends TCPServerConnectionThread
 	 * operation it has half completed - e.g. switch the autoguider off.
 	 * The rest of this thread's run method should then execute
 	 * to send the DONE message back to the client.
+	 * Any sub-command this thread is waiting on (to the ISS/DpRt/BSS) is woken up, so the wait stops straight away.
+	 * This is done outside this object's lock, as the waiting thread checks getAbortProcessCommand whilst
+	 * holding the sub-command's lock.
 	 * @see #abortProcessCommand
+	 * @see OTCPClientConnectionManager#abort
 	 */
-	public synchronized void setAbortProcessCommand()
+	public void setAbortProcessCommand()
 	{
-		abortProcessCommand = true;
+		synchronized(this)
+		{
+			abortProcessCommand = true;
+		}
+		if((o != null) && (o.getClientConnectionManager() != null))
+			o.getClientConnectionManager().abort(this);
 	}
 
 	/**
@@ -214,6 +223,8 @@ public class OTCPServerConnectionThread extends TCPServerConnectionThread
 	 * If it cannot a suitable done error message is returned.
 	 * <li>If the command is not an interrupt command sub-class it sets the O's status to reflect
 	 * the command/thread(this one) currently doing the processing.
+	 * <li>If the command is not an interrupt command sub-class, O's configureCompression is called to select
+	 * whether the images taken by the command are saved tile-compressed.
 	 * <li>This method delagates the command processing to the command implementation found for the command
 	 * message class.
 	 * <li>The O's status is again updated to reflect this command/thread has finished processing. (If it's
@@ -227,6 +238,7 @@ public class OTCPServerConnectionThread extends TCPServerConnectionThread
 	 * @see OStatus#setCurrentThread
 	 * @see #commandImplementation
 	 * @see JMSCommandImplementation#processCommand
+	 * @see O#configureCompression
 	 */
 	protected void processCommand()
 	{
@@ -268,6 +280,15 @@ public class OTCPServerConnectionThread extends TCPServerConnectionThread
 		{
 			o.getStatus().setCurrentCommand((ISS_TO_INST)command);
 			o.getStatus().setCurrentThread((Thread)this);
+			// select whether this command's images are saved compressed
+			try
+			{
+				o.configureCompression(command);
+			}
+			catch(Exception e)
+			{
+				o.error(this.getClass().getName()+":processCommand:configureCompression failed:",e);
+			}
 		}
 	// setup return object.
 		try
@@ -6,6 +6,7 @@ import java.lang.*;
 import java.io.File;
 import java.io.IOException;
 import java.util.Vector;
+import java.util.concurrent.ExecutionException;
 import ngat.o.ccd.*;
 import ngat.fits.FitsHeaderDefaults;
 import ngat.math.QuadraticFit;
@@ -74,6 +75,85 @@ public class TELFOCUSImplementation extends SETUPImplementation implements JMSCo
 	 * acknowledgements with the correct time to complete.
 	 */
 	private int reduceOverhead = 0;
+	/**
+	 * Whether to read out each frame as a window (region of interest) around the focus star,
+	 * rather than as a full frame. Loaded from the "o.telfocus.window" property.
+	 */
+	private boolean window = false;
+	/**
+	 * The unbinned X pixel the region of interest is centred on.
+	 * Loaded from the "o.telfocus.window.x" property.
+	 */
+	private int windowXCentre = 0;
+	/**
+	 * The unbinned Y pixel the region of interest is centred on.
+	 * Loaded from the "o.telfocus.window.y" property.
+	 */
+	private int windowYCentre = 0;
+	/**
+	 * The width and height of the region of interest, in unbinned pixels.
+	 * Loaded from the "o.telfocus.window.size" property.
+	 */
+	private int windowSize = 0;
+	/**
+	 * Whether to stop the focus run early, once the minimum of the focus curve has been bracketed.
+	 * Loaded from the "o.telfocus.early_stop" property.
+	 * @see #focusBracketed
+	 */
+	private boolean earlyStop = false;
+	/**
+	 * The minimum number of reduced frames before the focus run can be stopped early.
+	 * Loaded from the "o.telfocus.early_stop.min_frame_count" property.
+	 * @see #focusBracketed
+	 */
+	private int earlyStopMinFrameCount = 5;
+	/**
+	 * The number of reduced frames needed on each side of the fitted best focus, before the focus run can be 
+	 * stopped early. Loaded from the "o.telfocus.early_stop.bracket_frame_count" property.
+	 * @see #focusBracketed
+	 */
+	private int earlyStopBracketFrameCount = 2;
+	/**
+	 * How much worse than the fitted best seeing, the seeing in the outermost frames on each side of the
+	 * fitted best focus must be, before the focus run can be stopped early. 
+	 * Loaded from the "o.telfocus.early_stop.rise_ratio" property.
+	 * @see #focusBracketed
+	 */
+	private double earlyStopRiseRatio = 1.2;
+	/**
+	 * Whether to use the libo_ccd seeing estimator, run on each frame straight after readout, 
+	 * rather than sending each frame to the DpRt for reduction. Frames in which the seeing estimator finds
+	 * no sources are still sent to the DpRt.
+	 * Loaded from the "o.telfocus.native_seeing" property.
+	 * @see #finishFrame
+	 * @see #reduceFrame
+	 */
+	private boolean nativeSeeing = false;
+	/**
+	 * The number of background standard deviations a source peak must be above the background, 
+	 * for the native seeing estimator. Loaded from the "o.telfocus.native_seeing.threshold_sigma" property.
+	 */
+	private double nativeSeeingThresholdSigma = 10.0;
+	/**
+	 * The radius of the cutout measured around each source, in binned pixels, for the native seeing estimator.
+	 * Loaded from the "o.telfocus.native_seeing.cutout_radius" property.
+	 */
+	private int nativeSeeingCutoutRadius = 8;
+	/**
+	 * The counts at or above which a source is saturated and not measured, for the native seeing estimator.
+	 * Loaded from the "o.telfocus.native_seeing.saturation_counts" property.
+	 */
+	private int nativeSeeingSaturationCounts = 60000;
+	/**
+	 * The maximum number of sources measured per frame, for the native seeing estimator.
+	 * Loaded from the "o.telfocus.native_seeing.max_source_count" property.
+	 */
+	private int nativeSeeingMaxSourceCount = 100;
+	/**
+	 * The number of threads the native seeing estimator splits the frame across.
+	 * Loaded from the "o.telfocus.native_seeing.thread_count" property.
+	 */
+	private int nativeSeeingThreadCount = 4;
 
 	/**
 	 * Constructor.
@@ -100,6 +180,10 @@ public class TELFOCUSImplementation extends SETUPImplementation implements JMSCo
 	 * <li>It calls the superclass's init method.
 	 * <li>It copies the command parameters.
 	 * <li>It initialises perExposureOverhead and reduceOverhead by querying the O status for them.
+	 * <li>It initialises the region of interest configuration (window, windowXCentre, windowYCentre,
+	 *     windowSize). If this fails, windowing is not used.
+	 * <li>It initialises the early stop configuration (earlyStop, earlyStopMinFrameCount, 
+	 *     earlyStopBracketFrameCount, earlyStopRiseRatio). If this fails, the focus run is not stopped early.
 	 * </ul>
 	 * @param command The command to be implemented.
 	 * @see #startFocus
@@ -108,6 +192,14 @@ public class TELFOCUSImplementation extends SETUPImplementation implements JMSCo
 	 * @see #exposureTime
 	 * @see #perExposureOverhead
 	 * @see #reduceOverhead
+	 * @see #window
+	 * @see #windowXCentre
+	 * @see #windowYCentre
+	 * @see #windowSize
+	 * @see #earlyStop
+	 * @see #earlyStopMinFrameCount
+	 * @see #earlyStopBracketFrameCount
+	 * @see #earlyStopRiseRatio
 	 */
 	public void init(COMMAND command)
 	{
@@ -143,6 +235,74 @@ public class TELFOCUSImplementation extends SETUPImplementation implements JMSCo
 				"getting reduce overhead failed:"+
 				"using default value:"+reduceOverhead+"\n\t"+e);
 		}
+	// Get the region of interest to read out, if any
+		try
+		{
+			if(status.getProperty("o.telfocus.window") != null)
+				window = status.getPropertyBoolean("o.telfocus.window");
+			else
+				window = false;
+			if(window)
+			{
+				windowXCentre = status.getPropertyInteger("o.telfocus.window.x");
+				windowYCentre = status.getPropertyInteger("o.telfocus.window.y");
+				windowSize = status.getPropertyInteger("o.telfocus.window.size");
+			}
+		}
+		catch (Exception e)
+		{
+			window = false;
+			o.error(this.getClass().getName()+":init:"+
+				"getting region of interest failed:using full frames:\n\t"+e);
+		}
+	// Get whether to stop once the best focus has been bracketed
+		try
+		{
+			if(status.getProperty("o.telfocus.early_stop") != null)
+				earlyStop = status.getPropertyBoolean("o.telfocus.early_stop");
+			else
+				earlyStop = false;
+			if(earlyStop)
+			{
+				earlyStopMinFrameCount = status.getPropertyInteger("o.telfocus.early_stop.min_frame_count");
+				earlyStopBracketFrameCount = status.getPropertyInteger(
+									"o.telfocus.early_stop.bracket_frame_count");
+				earlyStopRiseRatio = status.getPropertyDouble("o.telfocus.early_stop.rise_ratio");
+			}
+		}
+		catch (Exception e)
+		{
+			earlyStop = false;
+			o.error(this.getClass().getName()+":init:"+
+				"getting early stop configuration failed:taking every frame:\n\t"+e);
+		}
+	// Get whether to measure the seeing using the libo_ccd seeing estimator
+		try
+		{
+			if(status.getProperty("o.telfocus.native_seeing") != null)
+				nativeSeeing = status.getPropertyBoolean("o.telfocus.native_seeing");
+			else
+				nativeSeeing = false;
+			if(nativeSeeing)
+			{
+				nativeSeeingThresholdSigma = status.getPropertyDouble(
+								"o.telfocus.native_seeing.threshold_sigma");
+				nativeSeeingCutoutRadius = status.getPropertyInteger(
+								"o.telfocus.native_seeing.cutout_radius");
+				nativeSeeingSaturationCounts = status.getPropertyInteger(
+								"o.telfocus.native_seeing.saturation_counts");
+				nativeSeeingMaxSourceCount = status.getPropertyInteger(
+								"o.telfocus.native_seeing.max_source_count");
+				nativeSeeingThreadCount = status.getPropertyInteger(
+								"o.telfocus.native_seeing.thread_count");
+			}
+		}
+		catch (Exception e)
+		{
+			nativeSeeing = false;
+			o.error(this.getClass().getName()+":init:"+
+				"getting native seeing configuration failed:using the DpRt:\n\t"+e);
+		}
 	}
 
 	/**
@@ -179,20 +339,26 @@ public class TELFOCUSImplementation extends SETUPImplementation implements JMSCo
 	 * <li>The directory and exposure status are setup.
 	 * <li>The fold mirror is driven to a suitable location.
 	 * <li>The focus offset is reset to zero using resetFocusOffset.
-	 * <li>A loop is entered, from the startFocus to the endFocus in step sizes.
+	 * <li>If window is true, setupRegionOfInterest is called to read out only a window around the focus star,
+	 *     which is much quicker than reading out full frames. If this fails, full frames are taken instead.
+	 * <li>If nativeSeeing is true, the libo_ccd seeing estimator is configured and enabled. If this fails,
+	 *     the frames are reduced by the DpRt instead.
+	 * <li>setFocus is called to drive the telescope to the startFocus.
+	 * <li>A loop is entered, from the startFocus to the endFocus in step sizes. The frames are pipelined:
 	 *     <ul>
 	 *     <li>The exposure status is set, and a new element in the list of frame parameters setup.
-	 *     <li>setFocus is called to drive the telescope to the required focus.
-	 *     <li>An exposure is taken, using exposeFrame.
+	 *     <li>An exposure is started, using startFrame.
+	 *     <li>Whilst this frame is exposing, the previous frame is reduced and acknowledged using 
+	 *         reduceFrames. If earlyStop is set, focusBracketed is then called, and if the best focus is 
+	 *         bracketed, this is the last frame taken.
+	 *     <li>If there is another frame to take, we wait for the shutter to close (TELFOCUSShutterListener), 
+	 *         and call setFocus to drive the telescope to the next focus whilst this frame is reading out.
+	 *     <li>We wait for the frame to be saved, using finishFrame.
 	 *     <li>An acknowledgement is sent back to the client, using sendFrameAcknowledge.
 	 *     </ul>
-	 * <li>A loop is entered, for each filename to reduce.
-	 *     <ul>
-	 *     <li>reduceFrame is called for each filename, which sends each filename to the real, time data
-	 * 		pipeline to be reduced, and saves the returned parameters in the list of frame parameters.
-	 *     <li>An acknowledgement is sent back to the client, using sendDpAcknowledge, with the returned
-	 * 		data.
-	 *     </ul>
+	 * <li>The previous CCD configuration is restored using restoreRegionOfInterest, 
+	 *     if setupRegionOfInterest was called. The seeing estimator is disabled, if it was enabled.
+	 * <li>The last frame is reduced and acknowledged using reduceFrames.
 	 * <li>The best focus is then calculated, fitting a curve to the seeing generated from each reduced frame.
 	 *	The bottom of the curve is the best seeing - i.e. the telescope is in focus.
 	 * 	The quadraticFit method is called to do this.
@@ -204,20 +370,37 @@ public class TELFOCUSImplementation extends SETUPImplementation implements JMSCo
 	 * @see #testAbort
 	 * @see #moveFold
 	 * @see #resetFocusOffset
+	 * @see #window
+	 * @see #windowXCentre
+	 * @see #windowYCentre
+	 * @see #windowSize
+	 * @see FITSImplementation#setupRegionOfInterest
+	 * @see FITSImplementation#restoreRegionOfInterest
+	 * @see #nativeSeeing
+	 * @see CCDLibrary#setSeeingConfig
+	 * @see CCDLibrary#setSeeingEnable
 	 * @see #setFocus
-	 * @see #exposeFrame
+	 * @see #startFrame
+	 * @see #finishFrame
+	 * @see #abandonFrame
 	 * @see #sendFrameAcknowledge
-	 * @see #reduceFrame
-	 * @see #sendDpAcknowledge
+	 * @see #reduceFrames
+	 * @see #earlyStop
+	 * @see #focusBracketed
 	 * @see #quadraticFit
+	 * @see TELFOCUSShutterListener
 	 */
 	public COMMAND_DONE processCommand(COMMAND command)
 	{
 		TELFOCUS telFocusCommand = (TELFOCUS)command;
 		TELFOCUS_DONE telFocusDone = new TELFOCUS_DONE(command.getId());
 		TELFOCUSFrameParameters frameParameters = null;
+		TELFOCUSShutterListener shutterListener = null;
+		CCDLibraryExposure exposure = null;
 		Vector list = null;
-		int exposureNumber;
+		float focus,nextFocus;
+		boolean lastFrame;
+		int exposureNumber,reducedCount;
 
 		try
 		{
@@ -240,6 +423,7 @@ public class TELFOCUSImplementation extends SETUPImplementation implements JMSCo
 			}
 		// setup exposure status/directory
 			exposureNumber = 0;
+			reducedCount = 0;
 			status.setExposureCount((int)((endFocus-startFocus)/step));
 			list = new Vector();
 		// move the fold mirror to the correct location
@@ -250,25 +434,84 @@ public class TELFOCUSImplementation extends SETUPImplementation implements JMSCo
 		// reset the FOCUS_OFFSET (DFOCUS) to zero
 			if(resetFocusOffset(telFocusCommand,telFocusDone) == false)
 				return telFocusDone;
+		// only read out the region around the focus star
+			if(window)
+			{
+				try
+				{
+					setupRegionOfInterest(windowXCentre,windowYCentre,windowSize);
+				}
+				catch(Exception e)
+				{
+					o.error(this.getClass().getName()+
+						":processCommand:Failed to setup region of interest:using full frames:",e);
+				}
+			}
+		// measure the seeing of each frame as it is read out
+			if(nativeSeeing)
+			{
+				try
+				{
+					ccd.setSeeingConfig(nativeSeeingThresholdSigma,nativeSeeingCutoutRadius,
+							    nativeSeeingSaturationCounts,nativeSeeingMaxSourceCount,
+							    nativeSeeingThreadCount);
+					ccd.setSeeingEnable(true);
+				}
+				catch(CCDLibraryNativeException e)
+				{
+					nativeSeeing = false;
+					o.error(this.getClass().getName()+
+						":processCommand:Failed to enable seeing estimator:using the DpRt:",e);
+				}
+			}
+		// drive the telescope to the first focus
+			focus = startFocus;
+			if(setFocus(telFocusCommand,telFocusDone,focus) == false)
+				return telFocusDone;
 		// start exposure loop for each focus
-			for(float focus=startFocus; focus <= endFocus; focus += step)
+			lastFrame = (focus > endFocus);
+			while(lastFrame == false)
 			{
 				status.setExposureNumber(exposureNumber);
 			// Clear pause and resume times.
 				status.clearPauseResumeTimes();
 				frameParameters = new TELFOCUSFrameParameters();
+				frameParameters.setFocus(focus);
 				list.add(frameParameters);
-			// send ISS SET_FOCUS command.
-				if(setFocus(telFocusCommand,telFocusDone,focus) == false)
+				nextFocus = focus+step;
+				lastFrame = (nextFocus > endFocus);
+			// start exposure to telFocusN.fits
+				shutterListener = new TELFOCUSShutterListener();
+				exposure = startFrame(telFocusCommand,telFocusDone,exposureNumber,shutterListener);
+				if(exposure == null)
+					return telFocusDone;
+			// whilst exposing, reduce the previous frame, and see if the best focus is bracketed yet
+				if(reduceFrames(telFocusCommand,telFocusDone,list,reducedCount,exposureNumber) == false)
 				{
+					abandonFrame(telFocusCommand,exposure);
 					return telFocusDone;
 				}
-				frameParameters.setFocus(focus);
-			// do exposure to telFocusN.fits
-				if(exposeFrame(telFocusCommand,telFocusDone,exposureNumber,frameParameters) == false)
+				reducedCount = exposureNumber;
+				if(earlyStop && (lastFrame == false) && focusBracketed(telFocusCommand,list,reducedCount))
 				{
-					return telFocusDone;
+					o.log(Logging.VERBOSITY_TERSE,"Command:"+telFocusCommand.getClass().getName()+
+					      ":processCommand:Best focus bracketed after "+reducedCount+
+					      " frames:Stopping after frame "+exposureNumber+".");
+					lastFrame = true;
+				}
+			// move the telescope to the next focus, whilst this frame is reading out
+				if(lastFrame == false)
+				{
+					shutterListener.waitForShutterClosed(exposure);
+					if(setFocus(telFocusCommand,telFocusDone,nextFocus) == false)
+					{
+						abandonFrame(telFocusCommand,exposure);
+						return telFocusDone;
+					}
 				}
+			// wait for telFocusN.fits to be saved
+				if(finishFrame(telFocusCommand,telFocusDone,exposure,frameParameters) == false)
+					return telFocusDone;
 			// send acknowledge
 				if(sendFrameAcknowledge(telFocusCommand,telFocusDone,
 							frameParameters.getFilename()) == false)
@@ -277,7 +520,8 @@ public class TELFOCUSImplementation extends SETUPImplementation implements JMSCo
 				}
 			// increment frame number.
 				exposureNumber++;
-			}// end for on focus
+				focus = nextFocus;
+			}// end while on focus
 		}// end try
 	// Other exceptions (IllegalArgumentException,NumberFormatException) are not caught here, 
 	// but by the calling method catch(Exception e)
@@ -295,21 +539,34 @@ public class TELFOCUSImplementation extends SETUPImplementation implements JMSCo
 			telFocusDone.setSuccessful(false);
 			return telFocusDone;
 		}
-	// reduce data
-		for(int i = 0; i < list.size(); i++)
+		finally
 		{
-			frameParameters = (TELFOCUSFrameParameters)list.get(i);
-			if(testAbort(telFocusCommand,telFocusDone) == true)
-				return telFocusDone;
-		// call pipeline
-			if(reduceFrame(telFocusCommand,telFocusDone,frameParameters) == false)
-				return telFocusDone;
-			if(testAbort(telFocusCommand,telFocusDone) == true)
-				return telFocusDone;
-		// send data pipeline acknowledge
-			if(sendDpAcknowledge(telFocusCommand,telFocusDone,frameParameters) == false)
-				return telFocusDone;
-		}// end for on exposures
+		// put back the configuration the frames were taken with
+			try
+			{
+				restoreRegionOfInterest();
+			}
+			catch(Exception e)
+			{
+				o.error(this.getClass().getName()+
+					":processCommand:Failed to restore CCD configuration:",e);
+			}
+			if(nativeSeeing)
+			{
+				try
+				{
+					ccd.setSeeingEnable(false);
+				}
+				catch(Exception e)
+				{
+					o.error(this.getClass().getName()+
+						":processCommand:Failed to disable seeing estimator:",e);
+				}
+			}
+		}
+	// reduce the last frame
+		if(reduceFrames(telFocusCommand,telFocusDone,list,reducedCount,list.size()) == false)
+			return telFocusDone;
 	// calculate seeing / optimum focus from list of frameParameters, using a quadratic fit
 		if(quadraticFit(telFocusCommand,telFocusDone,list) == false)
 			return telFocusDone;
@@ -413,40 +670,46 @@ public class TELFOCUSImplementation extends SETUPImplementation implements JMSCo
 	}
 
 	/**
-	 * Method to take one frame needed for a TELFOCUS.
+	 * Method to start one frame needed for a TELFOCUS. The exposure is started asynchronously, so the
+	 * caller can reduce the previous frame and move the telescope focus whilst it is in progress.
 	 * <ul>
 	 * <li>The filename is generated from the exposureNumber and the "o.file.fits.path" property.
 	 * <li>Any old files of this name are deleted.
 	 * <li>The FITS headers are generated from data and ISS GET_FITS command 
 	 * 	(clearFitsHeaders, setFitsHeaders, getFitsHeadersFromISS, getFitsHeadersFromBSS).
+	 *      If a region of interest is being read out, setFitsHeadersRegionOfInterest sets the window headers.
 	 * <li>The FITS headers for this frame are saved using the saveFitsHeaders method.
-	 * <li>The exposure is performed and saved in the filename, using the expose method in libo_ccd.
-	 * <li>unLockFile is called to remove the FITS lock file created in saveFitsHeaders
-	 * <li>The frameParameters filename field is set to the saved filename.
+	 * <li>The exposure is started, using the exposeAsync method in libo_ccd.
 	 * </ul>
 	 * testAbort is called during this method to see if the command has been aborted.
+	 * finishFrame (or abandonFrame) must be called with the returned exposure, to wait for it to finish and
+	 * remove the FITS lock file created in saveFitsHeaders.
 	 * @param telFocusCommand The TELFOCUS command that is causing this exposure. It is passed
 	 * 	to saveFitsHeaders and testAbort.
 	 * @param telFocusDone The instance of TELFOCUS_DONE. This is filled in with an error message if the
 	 * 	exposure fails. It is passed to saveFitsHeaders and testAbort.
 	 * @param exposureNumber The frame number. Used to generate the filename.
-	 * @param frameParameters The frame parameters for this exposure. The filename is set in this,
-	 * 	if the exposure is completed successfully.
-	 * @return The method returns true if the exposure was completed successfully. Otherwise false is returned,
-	 * 	and the error fields in telFocusDone are filled in.
-	 * @exception CCDLibraryNativeException Thrown if the exposure fails (expose).
+	 * @param listener The listener to deliver the exposure's phase changes to.
+	 * @return The started exposure. Otherwise null is returned, and the error fields in telFocusDone are 
+	 * 	filled in.
+	 * @exception CCDLibraryNativeException Thrown if the exposure could not be started (exposeAsync).
+	 * @see #finishFrame
+	 * @see #abandonFrame
 	 * @see FITSImplementation#clearFitsHeaders
 	 * @see FITSImplementation#setFitsHeaders
+	 * @see FITSImplementation#setFitsHeadersRegionOfInterest
+	 * @see FITSImplementation#regionOfInterestActive
 	 * @see FITSImplementation#getFitsHeadersFromISS
 	 * @see FITSImplementation#getFitsHeadersFromBSS
 	 * @see FITSImplementation#saveFitsHeaders
 	 * @see FITSImplementation#unLockFile
 	 * @see FITSImplementation#testAbort
-	 * @see CCDLibrary#expose
+	 * @see CCDLibrary#exposeAsync
 	 */
-	private boolean exposeFrame(TELFOCUS telFocusCommand,TELFOCUS_DONE telFocusDone,int exposureNumber,
-		TELFOCUSFrameParameters frameParameters) throws CCDLibraryNativeException
+	private CCDLibraryExposure startFrame(TELFOCUS telFocusCommand,TELFOCUS_DONE telFocusDone,int exposureNumber,
+					      CCDLibraryExposureListener listener) throws CCDLibraryNativeException
 	{
+		CCDLibraryExposure exposure = null;
 		File file = null;
 		String directoryString = null;
 		String filename = null;
@@ -464,29 +727,84 @@ public class TELFOCUSImplementation extends SETUPImplementation implements JMSCo
 		clearFitsHeaders();
 		if(setFitsHeaders(telFocusCommand,telFocusDone,FitsHeaderDefaults.OBSTYPE_VALUE_EXPOSURE,
 			exposureTime) == false)
-			return false;
+			return null;
+		if(regionOfInterestActive && (setFitsHeadersRegionOfInterest(telFocusCommand,telFocusDone) == false))
+			return null;
 		if(getFitsHeadersFromISS(telFocusCommand,telFocusDone) == false)
-			return false;
+			return null;
 		if(getFitsHeadersFromBSS(telFocusCommand,telFocusDone) == false)
-			return false;
+			return null;
 		if(testAbort(telFocusCommand,telFocusDone) == true)
-			return false;
+			return null;
 	// save FITS headers
 		if(saveFitsHeaders(telFocusCommand,telFocusDone,filename) == false)
 		{
 			unLockFile(telFocusCommand,telFocusDone,filename);
-			return false;
+			return null;
 		}
 		if(testAbort(telFocusCommand,telFocusDone) == true)
 		{
 			unLockFile(telFocusCommand,telFocusDone,filename);
-			return false;
+			return null;
 		}
-	// do glance
+	// start glance
 		status.setExposureFilename(filename);
 		try
 		{
-			ccd.expose(true,-1,exposureTime,filename);
+			exposure = ccd.exposeAsync(true,-1,exposureTime,filename,listener);
+		}
+		catch(CCDLibraryNativeException e)
+		{
+			unLockFile(telFocusCommand,telFocusDone,filename);
+			throw e;
+		}
+		return exposure;
+	}
+
+	/**
+	 * Method to wait for a frame started by startFrame to finish.
+	 * <ul>
+	 * <li>We wait for the exposure to be saved.
+	 * <li>unLockFile is called to remove the FITS lock file created in saveFitsHeaders.
+	 * <li>The frameParameters filename field is set to the saved filename.
+	 * <li>If nativeSeeing is true, the seeing estimator result for this frame is retrieved 
+	 *     (before the next frame is read out), converted to arcseconds using the plate scale, and
+	 *     stored in the frameParameters native seeing field.
+	 * </ul>
+	 * @param telFocusCommand The TELFOCUS command that is causing this exposure.
+	 * @param telFocusDone The instance of TELFOCUS_DONE. This is filled in with an error message if the
+	 * 	exposure fails.
+	 * @param exposure The exposure returned by startFrame.
+	 * @param frameParameters The frame parameters for this exposure. The filename is set in this,
+	 * 	if the exposure is completed successfully.
+	 * @return The method returns true if the exposure was completed successfully. Otherwise false is returned,
+	 * 	and the error fields in telFocusDone are filled in.
+	 * @exception CCDLibraryNativeException Thrown if the exposure failed.
+	 * @see #startFrame
+	 * @see FITSImplementation#unLockFile
+	 * @see FITSImplementation#testAbort
+	 * @see CCDLibraryExposure#get
+	 * @see #nativeSeeing
+	 * @see CCDLibrary#getSeeingResult
+	 */
+	private boolean finishFrame(TELFOCUS telFocusCommand,TELFOCUS_DONE telFocusDone,CCDLibraryExposure exposure,
+				    TELFOCUSFrameParameters frameParameters) throws CCDLibraryNativeException
+	{
+		String filename = null;
+
+		filename = (String)(exposure.getFilenameList().get(0));
+		try
+		{
+			exposure.get();
+		}
+		catch(ExecutionException e)
+		{
+			throw (CCDLibraryNativeException)(e.getCause());
+		}
+		catch(InterruptedException e)
+		{
+			throw new CCDLibraryNativeException(this.getClass().getName()+
+							    ":finishFrame:Interrupted waiting for "+filename+".");
 		}
 		finally
 		{
@@ -497,9 +815,59 @@ public class TELFOCUSImplementation extends SETUPImplementation implements JMSCo
 		if(testAbort(telFocusCommand,telFocusDone) == true)
 			return false;
 		frameParameters.setFilename(filename);
+		if(nativeSeeing)
+		{
+			CCDLibrarySeeingResult seeingResult = null;
+			double plateScale;
+
+			try
+			{
+				seeingResult = ccd.getSeeingResult();
+				// get plate scale from FITS header defaults and current binning
+				plateScale = oFitsHeaderDefaults.getValueDouble("CCDSCALE")*((double)(ccd.getXBin()));
+				o.log(Logging.VERBOSITY_VERBOSE,"Command:"+telFocusCommand.getClass().getName()+
+				      ":finishFrame:"+filename+":seeing estimator found "+
+				      seeingResult.getSourceCount()+" sources:FWHM "+seeingResult.getFWHM()+
+				      " pixels:plate scale "+plateScale+":took "+seeingResult.getElapsedTime()+" s.");
+				if(seeingResult.hasSource())
+				{
+					frameParameters.setNativeSeeing((float)(seeingResult.getFWHM()*plateScale));
+				}
+			}
+			catch(Exception e)
+			{
+				o.error(this.getClass().getName()+":finishFrame:"+filename+
+					":Failed to get seeing estimator result:using the DpRt:",e);
+			}
+		}
 		return true;
 	}
 
+	/**
+	 * Method to wait for a frame started by startFrame to finish, after the TELFOCUS has failed for another
+	 * reason. Any exposure error is logged, and the FITS lock file is removed, without changing the
+	 * error already in the done message.
+	 * @param telFocusCommand The TELFOCUS command that is causing this exposure.
+	 * @param exposure The exposure returned by startFrame.
+	 * @see #startFrame
+	 * @see FITSImplementation#unLockFile
+	 */
+	private void abandonFrame(TELFOCUS telFocusCommand,CCDLibraryExposure exposure)
+	{
+		String filename = null;
+
+		filename = (String)(exposure.getFilenameList().get(0));
+		try
+		{
+			exposure.get();
+		}
+		catch(Exception e)
+		{
+			o.error(this.getClass().getName()+":abandonFrame:"+filename+":",e);
+		}
+		unLockFile(telFocusCommand,new TELFOCUS_DONE(telFocusCommand.getId()),filename);
+	}
+
 	/**
 	 * Method to send an acknowledgement back to the ISS, after a frame has been exposed.
 	 * An instance of TELFOCUS_ACK is constructed and returned to the client (the ISS).
@@ -544,7 +912,46 @@ public class TELFOCUSImplementation extends SETUPImplementation implements JMSCo
 	}
 
 	/**
-	 * Method to reduce a frame.
+	 * Method to reduce a range of frames, and acknowledge each one back to the client. 
+	 * This is called whilst the next frame is exposing.
+	 * @param telFocusCommand The TELFOCUS command that is caused the frame reduction to occur.
+	 * @param telFocusDone The instance of TELFOCUS_DONE. This is filled in with an error message if a
+	 * 	reduction fails.
+	 * @param list The list of TELFOCUSFrameParameters.
+	 * @param startIndex The index in list of the first frame to reduce.
+	 * @param endIndex The index in list after the last frame to reduce.
+	 * @return The method returns true if the reductions were successfull. Otherwise it returns false,
+	 * 	and telFocusDone's error fields are set.
+	 * @see #reduceFrame
+	 * @see #sendDpAcknowledge
+	 * @see #testAbort
+	 */
+	private boolean reduceFrames(TELFOCUS telFocusCommand,TELFOCUS_DONE telFocusDone,Vector list,int startIndex,
+				     int endIndex)
+	{
+		TELFOCUSFrameParameters frameParameters = null;
+
+		for(int i = startIndex; i < endIndex; i++)
+		{
+			frameParameters = (TELFOCUSFrameParameters)list.get(i);
+			if(testAbort(telFocusCommand,telFocusDone) == true)
+				return false;
+		// call pipeline
+			if(reduceFrame(telFocusCommand,telFocusDone,frameParameters) == false)
+				return false;
+			if(testAbort(telFocusCommand,telFocusDone) == true)
+				return false;
+		// send data pipeline acknowledge
+			if(sendDpAcknowledge(telFocusCommand,telFocusDone,frameParameters) == false)
+				return false;
+		}// end for on exposures
+		return true;
+	}
+
+	/**
+	 * Method to reduce a frame. If the libo_ccd seeing estimator measured a seeing for this frame
+	 * (the frameParameters native seeing is non-zero), this is used as the frame's seeing and the frame is not
+	 * sent to the DpRt. Otherwise the frame is sent to the DpRt.
 	 * @param telFocusCommand The TELFOCUS command that is caused the frame reduction to occur. The Id is used
 	 * 	as the EXPOSE_REDUCE command's id.
 	 * @param telFocusDone The instance of TELFOCUS_DONE. This is filled in with an error message if the
@@ -556,6 +963,7 @@ public class TELFOCUSImplementation extends SETUPImplementation implements JMSCo
 	 * @see O#sendDpRtCommand
 	 * @see #testAbort
 	 * @see ngat.message.INST_DP.EXPOSE_REDUCE
+	 * @see #finishFrame
 	 */
 	private boolean reduceFrame(TELFOCUS telFocusCommand,TELFOCUS_DONE telFocusDone,
 		TELFOCUSFrameParameters frameParameters)
@@ -564,6 +972,24 @@ public class TELFOCUSImplementation extends SETUPImplementation implements JMSCo
 		EXPOSE_REDUCE_DONE reduceDone = null;
 		INST_TO_DP_DONE instToDPDone = null;
 
+	// use the seeing measured by the seeing estimator, if there is one
+		if(frameParameters.getNativeSeeing() > 0.0f)
+		{
+			frameParameters.setReducedFilename(null);
+			frameParameters.setSeeing(frameParameters.getNativeSeeing());
+			frameParameters.setCounts(0.0f);
+			frameParameters.setXPix(0.0f);
+			frameParameters.setYPix(0.0f);
+			frameParameters.setPhotometricity(0.0f);
+			frameParameters.setSkyBrightness(0.0f);
+			frameParameters.setSaturation(false);
+			o.log(Logging.VERBOSITY_VERBOSE,"Command:"+telFocusCommand.getClass().getName()+
+			      ":reduceFrame:"+frameParameters.getFilename()+":using native seeing "+
+			      frameParameters.getSeeing()+".");
+			if(testAbort(telFocusCommand,telFocusDone) == true)
+				return false;
+			return true;
+		}
 		reduceCommand = new EXPOSE_REDUCE(telFocusCommand.getId());
 		reduceCommand.setFilename(frameParameters.getFilename());
 		instToDPDone = o.sendDpRtCommand(reduceCommand,serverConnectionThread);
@@ -675,29 +1101,24 @@ public class TELFOCUSImplementation extends SETUPImplementation implements JMSCo
 	}
 
 	/**
-	 * This method takes the data supplied by reducing the frames, and tries to fit an
-	 * imaginary quadratic curve through a graph of x = focus, y = seeing. It uses ngat.math.QuadraticFit,
-	 * which uses a three degree of freedom parameter search Chi Squared Fit. The best focus
-	 * is derived from this using the first derivative (find x when the slope of the curve is zero i.e.
-	 * the bottom of the curve). The calculated best seeing is got by plugging the best focus back into
-	 * the model to get a y value (seeing).
+	 * This method constructs a QuadraticFit, and fits an imaginary quadratic curve through a graph of 
+	 * x = focus, y = seeing for the first count frames in the list. It uses ngat.math.QuadraticFit,
+	 * which uses a three degree of freedom parameter search Chi Squared Fit. The fit is configured from the
+	 * "o.telfocus.quadratic_fit" properties.
 	 * @param telFocusCommand The command we are implementing. Used for logging.
-	 * @param telFocusDone The done message. We fill in the currentFocus/seeing done parameters with the
-	 * 	results calulated here.
 	 * @param list A list, containing instances of TELFOCUSFrameParameters. The focus/seeing 
 	 * 	combinations are extracted from the list and used to make the quadratic fit.
+	 * @param count The number of frames at the start of the list to fit.
+	 * @return The QuadraticFit, after the fit has been done.
 	 * @see ngat.math.QuadraticFit
-	 * @see #getFocus
-	 * @see #quadraticY
 	 */
-	protected boolean quadraticFit(TELFOCUS telFocusCommand,TELFOCUS_DONE telFocusDone,Vector list)
+	protected QuadraticFit createQuadraticFit(TELFOCUS telFocusCommand,Vector list,int count)
 	{
 		QuadraticFit quadraticFit = null;
 		TELFOCUSFrameParameters frameParameters = null;
 		String propertyString = null;
 		float focus,seeing;
 		double targetChiSquared,parameterStepCount;
-		double a,b,c,chiSquared;
 		double parameterStartMinValue[] = new double[QuadraticFit.PARAMETER_COUNT];
 		double parameterStartMaxValue[] = new double[QuadraticFit.PARAMETER_COUNT];
 		double parameterStartStepSize[] = new double[QuadraticFit.PARAMETER_COUNT];
@@ -803,7 +1224,7 @@ public class TELFOCUSImplementation extends SETUPImplementation implements JMSCo
 	// set data points to fit - print log if required
 		o.log(Logging.VERBOSITY_VERBOSE,"Command:"+telFocusCommand.getClass().getName()+
 		      ":quadraticFit:data points.");
-		for(int i = 0; i < list.size(); i++)
+		for(int i = 0; i < count; i++)
 		{
 			frameParameters = (TELFOCUSFrameParameters)list.get(i);
 			focus = frameParameters.getFocus();
@@ -816,6 +1237,31 @@ public class TELFOCUSImplementation extends SETUPImplementation implements JMSCo
 		      ":quadraticFit:loop count = "+loopCount+
 		      ":target chi squared = "+targetChiSquared+".");
 		quadraticFit.quadraticFit(loopCount,targetChiSquared);
+		return quadraticFit;
+	}
+
+	/**
+	 * This method takes the data supplied by reducing the frames, and tries to fit an
+	 * imaginary quadratic curve through a graph of x = focus, y = seeing, using createQuadraticFit. 
+	 * The best focus is derived from this using the first derivative (find x when the slope of the curve is 
+	 * zero i.e. the bottom of the curve). The calculated best seeing is got by plugging the best focus back into
+	 * the model to get a y value (seeing).
+	 * @param telFocusCommand The command we are implementing. Used for logging.
+	 * @param telFocusDone The done message. We fill in the currentFocus/seeing done parameters with the
+	 * 	results calulated here.
+	 * @param list A list, containing instances of TELFOCUSFrameParameters. The focus/seeing 
+	 * 	combinations are extracted from the list and used to make the quadratic fit.
+	 * @see #createQuadraticFit
+	 * @see #getFocus
+	 * @see #quadraticY
+	 */
+	protected boolean quadraticFit(TELFOCUS telFocusCommand,TELFOCUS_DONE telFocusDone,Vector list)
+	{
+		QuadraticFit quadraticFit = null;
+		float focus,seeing;
+		double a,b,c,chiSquared;
+
+		quadraticFit = createQuadraticFit(telFocusCommand,list,list.size());
 	// get computed best fit parameter values - print log if requested
 		a = quadraticFit.getA();
 		b = quadraticFit.getB();
@@ -874,6 +1320,77 @@ public class TELFOCUSImplementation extends SETUPImplementation implements JMSCo
 		return true;
 	}
 
+	/**
+	 * Method to determine whether the best focus has been bracketed by the frames reduced so far, so the focus run
+	 * can stop early. A quadratic is fitted to the reduced frames using createQuadraticFit. The best focus
+	 * is bracketed if:
+	 * <ul>
+	 * <li>At least earlyStopMinFrameCount frames have been reduced.
+	 * <li>The fitted curve has a minimum (a &gt; 0).
+	 * <li>At least earlyStopBracketFrameCount reduced frames have a focus either side of the fitted best focus.
+	 * <li>The seeing of the outermost reduced frame on each side is at least earlyStopRiseRatio times the 
+	 *     fitted best seeing, so the minimum is well defined.
+	 * </ul>
+	 * @param telFocusCommand The command we are implementing. Used for logging.
+	 * @param list A list, containing instances of TELFOCUSFrameParameters.
+	 * @param reducedCount The number of frames at the start of the list that have been reduced.
+	 * @return true if the best focus is bracketed, false otherwise.
+	 * @see #earlyStopMinFrameCount
+	 * @see #earlyStopBracketFrameCount
+	 * @see #earlyStopRiseRatio
+	 * @see #createQuadraticFit
+	 * @see #getFocus
+	 * @see #quadraticY
+	 */
+	protected boolean focusBracketed(TELFOCUS telFocusCommand,Vector list,int reducedCount)
+	{
+		QuadraticFit quadraticFit = null;
+		TELFOCUSFrameParameters frameParameters = null;
+		TELFOCUSFrameParameters lowFrameParameters = null;
+		TELFOCUSFrameParameters highFrameParameters = null;
+		double a,b,c,focus,seeing;
+		int lowCount,highCount;
+
+		if(reducedCount < earlyStopMinFrameCount)
+			return false;
+		quadraticFit = createQuadraticFit(telFocusCommand,list,reducedCount);
+		a = quadraticFit.getA();
+		b = quadraticFit.getB();
+		c = quadraticFit.getC();
+		if(a < NEARLY_ZERO)
+			return false;
+		focus = getFocus(a,b);
+		seeing = quadraticY(focus,a,b,c);
+		lowCount = 0;
+		highCount = 0;
+		for(int i = 0; i < reducedCount; i++)
+		{
+			frameParameters = (TELFOCUSFrameParameters)list.get(i);
+			if(frameParameters.getFocus() < focus)
+			{
+				lowCount++;
+				if((lowFrameParameters == null)||(frameParameters.getFocus() < lowFrameParameters.getFocus()))
+					lowFrameParameters = frameParameters;
+			}
+			else
+			{
+				highCount++;
+				if((highFrameParameters == null)||
+				   (frameParameters.getFocus() > highFrameParameters.getFocus()))
+					highFrameParameters = frameParameters;
+			}
+		}
+		o.log(Logging.VERBOSITY_VERBOSE,"Command:"+telFocusCommand.getClass().getName()+
+		      ":focusBracketed:reduced count = "+reducedCount+":focus = "+focus+":seeing = "+seeing+
+		      ":low count = "+lowCount+":high count = "+highCount+".");
+		if((lowCount < earlyStopBracketFrameCount)||(highCount < earlyStopBracketFrameCount))
+			return false;
+		if(seeing <= 0.0)
+			return false;
+		return (lowFrameParameters.getSeeing() >= (seeing*earlyStopRiseRatio))&&
+			(highFrameParameters.getSeeing() >= (seeing*earlyStopRiseRatio));
+	}
+
 	/**
 	 * Method to return y = a*(x*x) + (b*x) +c.
 	 * @param x The value of x to get a model y value for.
@@ -907,6 +1424,71 @@ public class TELFOCUSImplementation extends SETUPImplementation implements JMSCo
 		return (-b)/(2*a);
 	}
 
+	/**
+	 * Inner class for TELFOCUS. Listens to the phase changes of a frame's exposure, so processCommand can move
+	 * the telescope focus as soon as the shutter has closed, whilst the frame is reading out.
+	 * @see #processCommand
+	 */
+	class TELFOCUSShutterListener implements CCDLibraryExposureListener
+	{
+		/**
+		 * Whether the shutter has closed (the exposure has reached the pre-readout phase).
+		 */
+		private boolean shutterClosed = false;
+
+		/**
+		 * Default constructor.
+		 */
+		public TELFOCUSShutterListener()
+		{
+			super();
+		}
+
+		/**
+		 * Called when the exposure status changes. Once the exposure reaches the pre-readout phase 
+		 * (or later), the shutter has closed, and any thread in waitForShutterClosed is woken up.
+		 * @param exposure The exposure.
+		 * @param event The phase event.
+		 * @see CCDLibrary#EXPOSURE_STATUS_PRE_READOUT
+		 */
+		public synchronized void exposurePhaseChanged(CCDLibraryExposure exposure,CCDLibraryExposureEvent event)
+		{
+			if(event.getExposureStatus() >= CCDLibrary.EXPOSURE_STATUS_PRE_READOUT)
+			{
+				shutterClosed = true;
+				notifyAll();
+			}
+		}
+
+		/**
+		 * Called as the frame reads out. Not used.
+		 * @param exposure The exposure.
+		 * @param event The readout progress event.
+		 */
+		public void exposureReadoutProgress(CCDLibraryExposure exposure,CCDLibraryExposureEvent event)
+		{
+		}
+
+		/**
+		 * Wait until the shutter has closed, or the exposure has finished (for instance, if it failed).
+		 * The exposure is checked every 100 milliseconds, as it's completion is not signalled to this object.
+		 * @param exposure The exposure.
+		 */
+		public synchronized void waitForShutterClosed(CCDLibraryExposure exposure)
+		{
+			while((shutterClosed == false)&&(exposure.isDone() == false))
+			{
+				try
+				{
+					wait(100);
+				}
+				catch(InterruptedException e)
+				{
+				}
+			}
+		}
+	}
+
 	/**
 	 * Inner class for TELFOCUS. Stores all the data needed for each frame of the TELFOCUS.
 	 */
@@ -952,6 +1534,10 @@ public class TELFOCUSImplementation extends SETUPImplementation implements JMSCo
 	 	 * Whether the field is saturated or not.
 	 	 */
 		private boolean saturation;
+		/**
+	 	 * The seeing measured by the libo_ccd seeing estimator, in arcseconds, or 0 if it was not measured.
+	 	 */
+		private float nativeSeeing;
 
 		/**
 	 	 * Default constructor.
@@ -968,6 +1554,7 @@ public class TELFOCUSImplementation extends SETUPImplementation implements JMSCo
 			photometricity = 0.0f;
 			skyBrightness = 0.0f;
 			saturation = false;
+			nativeSeeing = 0.0f;
 		}
 
 		/**
@@ -1034,6 +1621,22 @@ public class TELFOCUSImplementation extends SETUPImplementation implements JMSCo
 			return seeing;
 		}
 
+		/**
+		 * Set method for native seeing.
+		 */
+		public void setNativeSeeing(float f)
+		{
+			nativeSeeing = f;
+		}
+
+		/**
+		 * Get method for native seeing.
+		 */
+		public float getNativeSeeing()
+		{
+			return nativeSeeing;
+		}
+
 		/**
 		 * Set method for counts.
 		 */
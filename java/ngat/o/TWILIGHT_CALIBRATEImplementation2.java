@@ -280,6 +280,73 @@ public class TWILIGHT_CALIBRATEImplementation2 extends CALIBRATEImplementation i
 	 * equal to the offsetList size at the end of the offset list loop.
 	 */
 	private int calibrationFrameCount = 0;
+	/**
+	 * Whether to use the sky brightness model to predict exposure lengths. If false (or the model has not
+	 * been fitted yet), the exposure length is scaled from the last frame's mean counts.
+	 * Loaded from the "o.twilight_calibrate.sky_model" property.
+	 * @see #skyModel
+	 */
+	private boolean useSkyModel = false;
+	/**
+	 * The sky brightness model, fitted to all the frames taken so far by this command.
+	 * @see TWILIGHT_CALIBRATESkyModel
+	 */
+	private TWILIGHT_CALIBRATESkyModel skyModel = null;
+	/**
+	 * The maximum number of (the most recent) frames the sky brightness model is fitted to.
+	 * Loaded from the "o.twilight_calibrate.sky_model.sample_count.max" property.
+	 */
+	private int skyModelMaxSampleCount = 8;
+	/**
+	 * The time, in milliseconds since the epoch, the last exposure length was decided on.
+	 * Used to measure how long it takes from deciding on an exposure length to the exposure starting.
+	 * @see #decisionIsConfig
+	 */
+	private long decisionTime = 0L;
+	/**
+	 * Whether the last exposure length was decided on in doCalibration (before a new configuration), 
+	 * rather than doFrame (before another frame with the same configuration).
+	 * @see #decisionTime
+	 */
+	private boolean decisionIsConfig = false;
+	/**
+	 * The estimated time, in milliseconds, from deciding on an exposure length in doFrame, to that exposure
+	 * starting. Initially loaded from the "o.twilight_calibrate.sky_model.frame_latency" property,
+	 * and then set to the mean measured latency.
+	 */
+	private int frameLatency = 0;
+	/**
+	 * The estimated time, in milliseconds, from deciding on an exposure length in doCalibration, to that exposure
+	 * starting. This includes configuring the CCD and filters.
+	 * Initially loaded from the "o.twilight_calibrate.sky_model.config_latency" property,
+	 * and then set to the mean measured latency.
+	 */
+	private int configLatency = 0;
+	/**
+	 * The sum of the measured frame latencies, in milliseconds.
+	 * @see #frameLatency
+	 */
+	private long frameLatencySum = 0L;
+	/**
+	 * The number of measured frame latencies.
+	 * @see #frameLatency
+	 */
+	private int frameLatencyCount = 0;
+	/**
+	 * The sum of the measured config latencies, in milliseconds.
+	 * @see #configLatency
+	 */
+	private long configLatencySum = 0L;
+	/**
+	 * The number of measured config latencies.
+	 * @see #configLatency
+	 */
+	private int configLatencyCount = 0;
+	/**
+	 * The mean counts predicted for the current frame, when it's exposure length was decided on.
+	 * Zero if no prediction was made.
+	 */
+	private float plannedMeanCounts = 0.0f;
 
 	/**
 	 * Constructor.
@@ -338,10 +405,12 @@ public class TWILIGHT_CALIBRATEImplementation2 extends CALIBRATEImplementation i
 	 * 	calibration in the list and sets the relevant field.
 	 * <li>The FITS headers are cleared, and a the MULTRUN number is incremented.
 	 * <li>The fold mirror is moved to the correct location using <b>moveFold</b>.
+	 * <li>A new sky brightness model is created.
 	 * <li>For each calibration, we do the following:
 	 *      <ul>
 	 *      <li><b>doCalibration</b> is called.
 	 *      </ul>
+	 * <li>The sky brightness model's prediction error is logged.
 	 * <li>sendBasicAck is called, to stop the client timing out whilst creating the master flat.
 	 * <li>The makeMasterFlat method is called, to create master flat fields from the data just taken.
 	 * </ul>
@@ -361,6 +430,7 @@ public class TWILIGHT_CALIBRATEImplementation2 extends CALIBRATEImplementation i
 	 * @see FITSImplementation#oFilename
 	 * @see #doCalibration
 	 * @see #frameOverhead
+	 * @see #skyModel
 	 * @see CALIBRATEImplementation#makeMasterFlat
 	 */
 	public COMMAND_DONE processCommand(COMMAND command)
@@ -426,6 +496,10 @@ public class TWILIGHT_CALIBRATEImplementation2 extends CALIBRATEImplementation i
 		}
 		// initialise meanCounts
 		meanCounts = bestMeanCounts[lastBin];
+		// initialise the sky brightness model
+		skyModel = new TWILIGHT_CALIBRATESkyModel(skyModelMaxSampleCount);
+		plannedMeanCounts = 0.0f;
+		decisionTime = 0L;
 		// initialise loop variables
 		calibrationListIndex = 0;
 		doneCalibration = false;
@@ -439,6 +513,12 @@ public class TWILIGHT_CALIBRATEImplementation2 extends CALIBRATEImplementation i
 				return twilightCalibrateDone;
 			calibrationListIndex++;
 		}// end for on calibration list
+		o.log(Logging.VERBOSITY_TERSE,"Command:"+twilightCalibrateCommand.getId()+
+		      ":processCommand:Sky model:sample count:"+skyModel.getSampleCount()+
+		      ":prediction count:"+skyModel.getPredictionErrorCount()+
+		      ":RMS prediction error:"+skyModel.getPredictionErrorRMS()+
+		      ":time constant:"+skyModel.getTimeConstant()+" ms:frame latency:"+frameLatency+
+		      " ms:config latency:"+configLatency+" ms.");
 	// send an ack before make master processing, so the client doesn't time out.
 		makeFlatAckTime = status.getPropertyInteger("o.twilight_calibrate.acknowledge_time.make_flat");
 		if(sendBasicAck(twilightCalibrateCommand,twilightCalibrateDone,makeFlatAckTime) == false)
@@ -513,6 +593,10 @@ public class TWILIGHT_CALIBRATEImplementation2 extends CALIBRATEImplementation i
 	 * @see #minMeanCounts
 	 * @see #bestMeanCounts
 	 * @see #maxMeanCounts
+	 * @see #useSkyModel
+	 * @see #skyModelMaxSampleCount
+	 * @see #frameLatency
+	 * @see #configLatency
 	 * @see #timeOfNight
 	 * @see #LIST_KEY_SUNSET_STRING
 	 * @see #LIST_KEY_SUNRISE_STRING
@@ -558,6 +642,21 @@ public class TWILIGHT_CALIBRATEImplementation2 extends CALIBRATEImplementation i
 				propertyName = LIST_KEY_STRING+"mean_counts.max."+binIndex;
 				maxMeanCounts[binIndex] = status.getPropertyInteger(propertyName);
 			}// end for on binIndex
+		// sky brightness model
+			propertyName = LIST_KEY_STRING+"sky_model";
+			if(status.getProperty(propertyName) != null)
+				useSkyModel = status.getPropertyBoolean(propertyName);
+			else
+				useSkyModel = false;
+			if(useSkyModel)
+			{
+				propertyName = LIST_KEY_STRING+"sky_model.sample_count.max";
+				skyModelMaxSampleCount = status.getPropertyInteger(propertyName);
+				propertyName = LIST_KEY_STRING+"sky_model.frame_latency";
+				frameLatency = status.getPropertyInteger(propertyName);
+				propertyName = LIST_KEY_STRING+"sky_model.config_latency";
+				configLatency = status.getPropertyInteger(propertyName);
+			}
 		}
 		catch (Exception e)
 		{
@@ -928,21 +1027,26 @@ public class TWILIGHT_CALIBRATEImplementation2 extends CALIBRATEImplementation i
 	 * <ul>
 	 * <li>The relevant data is retrieved from the calibration parameter.
 	 * <li>If we did this calibration more recently than frequency, log and return.
-	 * <li>An optimal exposure length is calculated, by dividing by the last relative sensitivity used
+	 * <li>If the sky brightness model is in use and has been fitted, the optimal exposure length is predicted
+	 *     from the model for an exposure starting after the (measured) config latency, using the new
+	 *     filter sensitivity and binning.
+	 * <li>Otherwise, an optimal exposure length is calculated, by dividing by the last relative sensitivity used
 	 * 	(to get the exposure length as if though a clear filter), and then dividing by the 
 	 * 	new relative filter sensitivity (to increase the exposure length).
-	 * <li>The optimal exposure length is recalculated to take account of differences from the last binning
+	 *      The optimal exposure length is recalculated to take account of differences from the last binning
 	 *     to the new binning.
 	 * <li>We set the exposure length to be a range bound version of optimal exposure length, between
 	 *     the minimum and maximum exposure length.
-	 * <li>We calculate the predicted mean counts, by taking the last mean counts and adjusting by the ratios
+	 * <li>We calculate the predicted mean counts, using the sky brightness model if it was used. Otherwise
+	 *     by taking the last mean counts and adjusting by the ratios
 	 *     between the old and new filter sensitivity, the old and new binning squared (as binning 2 allows
 	 *     four times the flux to fall on a pixel as binning 1), and the old and new exposure length.
 	 * <li>Check whether we expect the predicted mean counts to be too small at sunset
 	 *     (it is too dark for this filter/bin combo). If so, try the next calibration.
 	 * <li>Check whether we expect the predicted mean counts to be too big at sunrise
 	 *     (it is too light for this filter/bin combo). If so, try the next calibration.
-	 * <li>We update the  last filter sensitivity and last binning factor.
+	 * <li>We update the  last filter sensitivity and last binning factor, and record when the exposure length
+	 *     was decided on and the predicted mean counts.
 	 * <li><b>sendBasicAck</b> is called to stop the client timing out before the config is completed.
 	 * <li><b>doConfig</b> is called for the relevant binning factor/slides/filter set to be setup.
 	 * <li><b>sendBasicAck</b> is called to stop the client timing out before the first frame is completed.
@@ -962,6 +1066,11 @@ public class TWILIGHT_CALIBRATEImplementation2 extends CALIBRATEImplementation i
 	 * @see #lastBin
 	 * @see #calibrationFrameCount
 	 * @see #meanCounts
+	 * @see #useSkyModel
+	 * @see #skyModel
+	 * @see #configLatency
+	 * @see #decisionTime
+	 * @see #plannedMeanCounts
 	 */
 	protected boolean doCalibration(TWILIGHT_CALIBRATE twilightCalibrateCommand,
 			TWILIGHT_CALIBRATE_DONE twilightCalibrateDone,TWILIGHT_CALIBRATECalibration calibration)
@@ -970,10 +1079,10 @@ public class TWILIGHT_CALIBRATEImplementation2 extends CALIBRATEImplementation i
 		String lowerDichroicSlide,upperDichroicSlide,lowerFilterSlide,upperFilterSlide;
 		int bin,optimalExposureLength;
 		long lastTime,frequency;
-		long now;
+		long now,predictedStartTime;
 		float predictedMeanCounts;
 		double filterSensitivity;
-		boolean useWindowAmplifier;
+		boolean useWindowAmplifier,useModel;
 
 		o.log(Logging.VERBOSITY_VERBOSE,
 		      "Command:"+twilightCalibrateCommand.getClass().getName()+
@@ -1018,26 +1127,50 @@ public class TWILIGHT_CALIBRATEImplementation2 extends CALIBRATEImplementation i
 			return true;
 		}
 	// recalculate the exposure length
-		o.log(Logging.VERBOSITY_VERBOSE,
-		      "Command:"+twilightCalibrateCommand.getClass().getName()+
-		      ":doCalibrate:lastExposureLength:"+lastExposureLength);
-		optimalExposureLength = (int)((((double)lastExposureLength)*lastFilterSensitivity)/filterSensitivity);
-		o.log(Logging.VERBOSITY_VERBOSE,
-		      "Command:"+twilightCalibrateCommand.getClass().getName()+
-		      ":doCalibrate:optimalExposureLength after multiplication through by last filter sensitivity:"+
-		      lastFilterSensitivity+"/ filter senisitivity:"+filterSensitivity+" =:"+optimalExposureLength);
-		optimalExposureLength = (optimalExposureLength*(lastBin*lastBin))/(bin*bin);
-		o.log(Logging.VERBOSITY_VERBOSE,
-		      "Command:"+twilightCalibrateCommand.getClass().getName()+
-		      ":doCalibrate:optimalExposureLength after multiplication through by last bin:"+
-		      lastBin+" (squared) / bin:"+bin+" (squared) =:"+optimalExposureLength);
+		predictedStartTime = now+configLatency;
+		useModel = useSkyModel && skyModel.isFitted();
+		if(useModel)
+		{
+			optimalExposureLength = skyModel.getExposureLength(predictedStartTime,bestMeanCounts[bin],
+									   filterSensitivity,bin);
+			o.log(Logging.VERBOSITY_VERBOSE,
+			      "Command:"+twilightCalibrateCommand.getClass().getName()+
+			      ":doCalibrate:optimalExposureLength from sky model for start time "+predictedStartTime+
+			      " (config latency "+configLatency+" ms) =:"+optimalExposureLength);
+		}
+		else
+		{
+			o.log(Logging.VERBOSITY_VERBOSE,
+			      "Command:"+twilightCalibrateCommand.getClass().getName()+
+			      ":doCalibrate:lastExposureLength:"+lastExposureLength);
+			optimalExposureLength = (int)((((double)lastExposureLength)*lastFilterSensitivity)/
+						      filterSensitivity);
+			o.log(Logging.VERBOSITY_VERBOSE,
+			      "Command:"+twilightCalibrateCommand.getClass().getName()+
+			      ":doCalibrate:optimalExposureLength after multiplication through by last filter sensitivity:"+
+			      lastFilterSensitivity+"/ filter senisitivity:"+filterSensitivity+" =:"+optimalExposureLength);
+			optimalExposureLength = (optimalExposureLength*(lastBin*lastBin))/(bin*bin);
+			o.log(Logging.VERBOSITY_VERBOSE,
+			      "Command:"+twilightCalibrateCommand.getClass().getName()+
+			      ":doCalibrate:optimalExposureLength after multiplication through by last bin:"+
+			      lastBin+" (squared) / bin:"+bin+" (squared) =:"+optimalExposureLength);
+		}
 		exposureLength = optimalExposureLength;
 		if(optimalExposureLength < minExposureLength)
 			exposureLength = minExposureLength;
 		if(optimalExposureLength > maxExposureLength)
 			exposureLength = maxExposureLength;
-		predictedMeanCounts = meanCounts * (float)((filterSensitivity/lastFilterSensitivity) * 
-				     ((bin*bin)/(lastBin*lastBin))*(exposureLength/lastExposureLength));
+		if(useModel)
+		{
+			predictedMeanCounts = (float)(skyModel.predictMeanCounts(predictedStartTime,exposureLength,
+										 filterSensitivity,bin));
+		}
+		else
+		{
+			predictedMeanCounts = meanCounts * (float)((filterSensitivity/lastFilterSensitivity) * 
+				     (((double)(bin*bin))/((double)(lastBin*lastBin)))*
+				     (((double)exposureLength)/((double)lastExposureLength)));
+		}
 		o.log(Logging.VERBOSITY_VERBOSE,
 		      "Command:"+twilightCalibrateCommand.getClass().getName()+":doCalibrate:predictedMeanCounts are "+
 		      predictedMeanCounts+" using exposure legnth "+exposureLength);
@@ -1067,6 +1200,9 @@ public class TWILIGHT_CALIBRATEImplementation2 extends CALIBRATEImplementation i
 	// We need to think about when to do this when the new exposure length means we DON'T do the calibration
 		lastFilterSensitivity = filterSensitivity;
 		lastBin = bin;
+		decisionTime = now;
+		decisionIsConfig = true;
+		plannedMeanCounts = predictedMeanCounts;
 		if((now+exposureLength+frameOverhead) > 
 			(implementationStartTime+twilightCalibrateCommand.getTimeToComplete()))
 		{
@@ -1426,19 +1562,24 @@ public class TWILIGHT_CALIBRATEImplementation2 extends CALIBRATEImplementation i
 	 * <li>The FITS headers are saved using <b>saveFitsHeaders</b>, to the temporary FITS filename.
 	 * <li>The frame is taken, using libccd's <b>expose</b> method.
 	 * <li>The FITS file lock created in <b>saveFitsHeaders</b> is removed with a call to <b>unLockFile</b>.
-	 * <li>The last exposure length variable is updated.
+	 * <li>The last exposure length variable is updated. <b>updateLatency</b> is called with the exposure
+	 *     start time.
 	 * <li>An instance of TWILIGHT_CALIBRATE_ACK is sent back to the client using <b>sendTwilightCalibrateAck</b>.
 	 * <li><b>testAbort</b> is called to see if this command implementation has been aborted.
 	 * <li><b>reduceCalibrate</b> is called to pass the frame to the Real Time Data Pipeline for processing.
 	 * <li>The frame state is derived from the returned mean counts.
+	 * <li><b>updateSkyModel</b> is called to add the frame to the sky brightness model.
 	 * <li>If the frame state was good, the raw frame and DpRt reduced (if different) are renamed into
 	 * 	the standard FITS filename using oFilename, by incrementing the run number.
 	 * <li><b>testAbort</b> is called to see if this command implementation has been aborted.
-	 * <li>The optimal exposure Length is calculated by multiplying by the 
+	 * <li>If the sky brightness model is in use and has been fitted, the optimal exposure length is predicted
+	 *     from the model for an exposure starting after the (measured) frame latency. Otherwise
+	 *     the optimal exposure Length is calculated by multiplying by the 
 	 *     ratio of best mean counts over mean counts.
 	 * <li>We change the exposure length to be the optimal exposure length, bracketed by the
 	 *     minimum and maximum exposure lengths.
-	 * <li>We calculate the predicted mean counts for the bracketed exposure length, by multiplying
+	 * <li>We calculate the predicted mean counts for the bracketed exposure length, using the sky brightness
+	 *     model if it was used, otherwise by multiplying
 	 *     the last mean counts by the ratio of new and last exposure lengths.
 	 * <li>We check the predicted mean counts for the bracketed exposure length are within the mean counts limits, 
 	 *     otherwise we assume the next exposure will return out of range mean counts and move onto the 
@@ -1471,6 +1612,10 @@ public class TWILIGHT_CALIBRATEImplementation2 extends CALIBRATEImplementation i
 	 * @see FITSImplementation#getFitsHeadersFromBSS
 	 * @see FITSImplementation#saveFitsHeaders
 	 * @see FITSImplementation#unLockFile
+	 * @see #updateLatency
+	 * @see #updateSkyModel
+	 * @see #skyModel
+	 * @see #frameLatency
 	 * @see FITSImplementation#oFilename
 	 * @see FITSImplementation#ccd
 	 * @see ngat.o.ccd.CCDLibrary#expose
@@ -1499,9 +1644,9 @@ public class TWILIGHT_CALIBRATEImplementation2 extends CALIBRATEImplementation i
 		File newFile = null;
 		String filename = null;
 		String reducedFilename = null;
-		long now;
+		long now,exposureStartTime,predictedStartTime;
 		int frameState,optimalExposureLength;
-		boolean doneFrame;
+		boolean doneFrame,useModel;
 		float predictedMeanCounts;
 
 		doneFrame = false;
@@ -1538,6 +1683,7 @@ public class TWILIGHT_CALIBRATEImplementation2 extends CALIBRATEImplementation i
 			      ":upper filter slide:"+upperFilterSlide+":lower filter slide:"+lowerFilterSlide+
 			      ":filter:"+filter+":Attempting exposure: length:"+exposureLength+".");
 		// do exposure
+			exposureStartTime = System.currentTimeMillis();
 			try
 			{
 				ccd.expose(true,-1,exposureLength,temporaryFITSFilename);
@@ -1561,6 +1707,10 @@ public class TWILIGHT_CALIBRATEImplementation2 extends CALIBRATEImplementation i
 			}
 		// set last exposure length
 			lastExposureLength = exposureLength;
+		// use the actual exposure start time, if the library recorded it
+			if(ccd.getExposureStartTime() > exposureStartTime)
+				exposureStartTime = ccd.getExposureStartTime();
+			updateLatency(twilightCalibrateCommand,exposureStartTime);
 		// send with filename back to client
 		// time to complete is reduction time, we will send another ACK after reduceCalibrate
 			if(sendTwilightCalibrateAck(twilightCalibrateCommand,twilightCalibrateDone,frameOverhead,
@@ -1626,6 +1776,8 @@ public class TWILIGHT_CALIBRATEImplementation2 extends CALIBRATEImplementation i
 			      ":mean counts:"+meanCounts+
 			      ":peak counts:"+twilightCalibrateDone.getPeakCounts()+
 			      ":frame state:"+FRAME_STATE_NAME_LIST[frameState]+".");
+		// add the frame to the sky brightness model
+			updateSkyModel(twilightCalibrateCommand,bin,filter,exposureStartTime);
 		// if the frame was good, rename it
 			if(frameState == FRAME_STATE_OK)
 			{
@@ -1732,8 +1884,19 @@ public class TWILIGHT_CALIBRATEImplementation2 extends CALIBRATEImplementation i
 			if(testAbort(twilightCalibrateCommand,twilightCalibrateDone) == true)
 				return false;
 		// Find optimal exposure length to get the best number of mean counts
-			optimalExposureLength = (int)(((float) exposureLength) * 
-						      (((float)(bestMeanCounts[bin]))/meanCounts));
+			now = System.currentTimeMillis();
+			predictedStartTime = now+frameLatency;
+			useModel = useSkyModel && skyModel.isFitted();
+			if(useModel)
+			{
+				optimalExposureLength = skyModel.getExposureLength(predictedStartTime,bestMeanCounts[bin],
+										   lastFilterSensitivity,bin);
+			}
+			else
+			{
+				optimalExposureLength = (int)(((float) exposureLength) * 
+							      (((float)(bestMeanCounts[bin]))/meanCounts));
+			}
 		// Bracket the optimal exposure length to an allowed exposure length
 			exposureLength = optimalExposureLength;
 			if(optimalExposureLength < minExposureLength)
@@ -1741,7 +1904,18 @@ public class TWILIGHT_CALIBRATEImplementation2 extends CALIBRATEImplementation i
 			else if(optimalExposureLength > maxExposureLength)
 				exposureLength = maxExposureLength;
 		// calculate the predicted mean counts for the bracketed exposure length
-			predictedMeanCounts = meanCounts * (exposureLength/lastExposureLength);
+			if(useModel)
+			{
+				predictedMeanCounts = (float)(skyModel.predictMeanCounts(predictedStartTime,exposureLength,
+											 lastFilterSensitivity,bin));
+			}
+			else
+			{
+				predictedMeanCounts = meanCounts * (((float)exposureLength)/((float)lastExposureLength));
+			}
+			decisionTime = now;
+			decisionIsConfig = false;
+			plannedMeanCounts = predictedMeanCounts;
 			o.log(Logging.VERBOSITY_VERBOSE,
 			      "Command:"+twilightCalibrateCommand.getId()+
 			      ":doFrame:"+"bin:"+bin+
@@ -1750,6 +1924,7 @@ public class TWILIGHT_CALIBRATEImplementation2 extends CALIBRATEImplementation i
 			      ":upper filter slide:"+upperFilterSlide+
 			      ":lower filter slide:"+lowerFilterSlide+
 			      ":filter:"+filter+
+			      ":Sky model used:"+useModel+
 			      ":New Optimal exposure length:"+optimalExposureLength+
 			      ":New limited exposure length:"+exposureLength+
 			      ":Predicted mean counts:"+predictedMeanCounts+".");
@@ -1844,6 +2019,100 @@ public class TWILIGHT_CALIBRATEImplementation2 extends CALIBRATEImplementation i
 		return true;
 	}
 
+	/**
+	 * Method to update the measured latency from deciding on an exposure length, to the exposure starting.
+	 * If an exposure length was decided on, the latency is added to the config or frame latency 
+	 * (depending on whether the decision was made in doCalibration or doFrame), and the relevant mean latency
+	 * recalculated.
+	 * @param twilightCalibrateCommand The instance of TWILIGHT_CALIBRATE we are currently running.
+	 * @param exposureStartTime The time the exposure started, in milliseconds since the epoch.
+	 * @see #decisionTime
+	 * @see #decisionIsConfig
+	 * @see #frameLatency
+	 * @see #configLatency
+	 */
+	protected void updateLatency(TWILIGHT_CALIBRATE twilightCalibrateCommand,long exposureStartTime)
+	{
+		long latency;
+
+		if(decisionTime <= 0L)
+			return;
+		latency = exposureStartTime-decisionTime;
+		decisionTime = 0L;
+		if(latency < 0L)
+			return;
+		if(decisionIsConfig)
+		{
+			configLatencySum += latency;
+			configLatencyCount++;
+			configLatency = (int)(configLatencySum/configLatencyCount);
+		}
+		else
+		{
+			frameLatencySum += latency;
+			frameLatencyCount++;
+			frameLatency = (int)(frameLatencySum/frameLatencyCount);
+		}
+		o.log(Logging.VERBOSITY_VERBOSE,"Command:"+twilightCalibrateCommand.getId()+
+		      ":updateLatency:"+(decisionIsConfig ? "config" : "frame")+" latency:"+latency+
+		      " ms:mean frame latency:"+frameLatency+" ms:mean config latency:"+configLatency+" ms.");
+	}
+
+	/**
+	 * Method to add the frame just reduced to the sky brightness model.
+	 * <ul>
+	 * <li>If the model was already fitted, the mean counts it predicts for the frame (from the actual start time
+	 *     and exposure length) are compared to the measured mean counts, and the prediction error 
+	 *     added to the model's statistics. The mean counts predicted when the exposure length was
+	 *     decided on (whose error also includes the error in the estimated latency) are logged alongside.
+	 * <li>If the mean counts are positive and not above the maximum mean counts (where the detector may be 
+	 *     non-linear or saturated), the frame is added to the model, which is refitted.
+	 * </ul>
+	 * Nothing is done if useSkyModel is false.
+	 * @param twilightCalibrateCommand The instance of TWILIGHT_CALIBRATE we are currently running.
+	 * @param bin The binning factor the frame was taken at.
+	 * @param filter The type of filter used. Passed through for logging purposes.
+	 * @param exposureStartTime The time the exposure started, in milliseconds since the epoch.
+	 * @see #useSkyModel
+	 * @see #skyModel
+	 * @see #meanCounts
+	 * @see #lastExposureLength
+	 * @see #lastFilterSensitivity
+	 * @see #plannedMeanCounts
+	 * @see #maxMeanCounts
+	 */
+	protected void updateSkyModel(TWILIGHT_CALIBRATE twilightCalibrateCommand,int bin,String filter,
+				      long exposureStartTime)
+	{
+		double modelMeanCounts;
+
+		if(useSkyModel == false)
+			return;
+		if(skyModel.isFitted() && (meanCounts > 0.0f))
+		{
+			modelMeanCounts = skyModel.predictMeanCounts(exposureStartTime,lastExposureLength,
+								     lastFilterSensitivity,bin);
+			skyModel.addPredictionError(modelMeanCounts,meanCounts);
+			o.log(Logging.VERBOSITY_VERBOSE,"Command:"+twilightCalibrateCommand.getId()+
+			      ":updateSkyModel:bin:"+bin+":filter:"+filter+":mean counts:"+meanCounts+
+			      ":planned mean counts:"+plannedMeanCounts+
+			      ":model mean counts:"+modelMeanCounts+
+			      ":prediction error:"+skyModel.getLastPredictionError()+
+			      ":RMS prediction error:"+skyModel.getPredictionErrorRMS()+
+			      " over "+skyModel.getPredictionErrorCount()+" frames.");
+		}
+		if((meanCounts > 0.0f)&&(meanCounts <= maxMeanCounts[bin]))
+		{
+			skyModel.addSample(exposureStartTime,lastExposureLength,lastFilterSensitivity,bin,meanCounts);
+			o.log(Logging.VERBOSITY_VERBOSE,"Command:"+twilightCalibrateCommand.getId()+
+			      ":updateSkyModel:Added sample:start time:"+exposureStartTime+
+			      ":length:"+lastExposureLength+":filter sensitivity:"+lastFilterSensitivity+
+			      ":bin:"+bin+":mean counts:"+meanCounts+":sample count:"+skyModel.getSampleCount()+
+			      ":fitted:"+skyModel.isFitted()+":time constant:"+skyModel.getTimeConstant()+" ms.");
+		}
+		plannedMeanCounts = 0.0f;
+	}
+
 	/**
 	 * Method to send an instance of ACK back to the client. This stops the client timing out, whilst we
 	 * work out what calibration to attempt next.
@@ -2454,6 +2723,295 @@ public class TWILIGHT_CALIBRATEImplementation2 extends CALIBRATEImplementation i
 		}
 	}// end TWILIGHT_CALIBRATEOffset
 
+	/**
+	 * Private inner class that models the twilight sky brightness, so the exposure length of the next frame
+	 * can be predicted for the time it will actually start, rather than scaled from the last frame's mean counts.
+	 * The sky count rate (per millisecond, through a filter of relative sensitivity 1.0 at binning 1) is assumed
+	 * to change exponentially with time during twilight: ln(rate) = logRateZero + rateSlope*(t - timeZero).
+	 * Each frame gives a sample of the rate at the middle of the exposure, after dividing the mean counts
+	 * by the exposure length, the filter sensitivity and the binning squared, so frames from all the
+	 * filters and binnings taken so far contribute to the same fit. A straight line is least squares fitted
+	 * to ln(rate) of the most recent samples.
+	 */
+	private class TWILIGHT_CALIBRATESkyModel
+	{
+		/**
+		 * The maximum number of (the most recent) samples fitted.
+		 */
+		protected int maxSampleCount;
+		/**
+		 * The number of samples currently held.
+		 */
+		protected int sampleCount;
+		/**
+		 * The time of each sample (the middle of the exposure), in milliseconds since timeZero.
+		 */
+		protected double sampleTimeList[];
+		/**
+		 * The natural log of the normalised count rate of each sample.
+		 */
+		protected double sampleLogRateList[];
+		/**
+		 * The time, in milliseconds since the epoch, the sample times are relative to.
+		 */
+		protected long timeZero;
+		/**
+		 * Whether the model has been fitted (there are enough samples, spread over enough time).
+		 */
+		protected boolean fitted;
+		/**
+		 * The fitted natural log of the normalised count rate at timeZero.
+		 */
+		protected double logRateZero;
+		/**
+		 * The fitted rate of change of the natural log of the normalised count rate, per millisecond.
+		 * Positive at sunrise (getting lighter) and negative at sunset.
+		 */
+		protected double rateSlope;
+		/**
+		 * The sum of the squared fractional prediction errors.
+		 */
+		protected double predictionErrorSumSquares;
+		/**
+		 * The number of prediction errors added.
+		 */
+		protected int predictionErrorCount;
+		/**
+		 * The last fractional prediction error added.
+		 */
+		protected double lastPredictionError;
+
+		/**
+		 * Constructor.
+		 * @param m The maximum number of (the most recent) samples fitted, at least 2.
+		 */
+		public TWILIGHT_CALIBRATESkyModel(int m)
+		{
+			super();
+			if(m < 2)
+				m = 2;
+			maxSampleCount = m;
+			sampleCount = 0;
+			sampleTimeList = new double[maxSampleCount];
+			sampleLogRateList = new double[maxSampleCount];
+			timeZero = 0L;
+			fitted = false;
+			logRateZero = 0.0;
+			rateSlope = 0.0;
+			predictionErrorSumSquares = 0.0;
+			predictionErrorCount = 0;
+			lastPredictionError = 0.0;
+		}
+
+		/**
+		 * Add a frame to the model, and refit it. If the model already holds maxSampleCount samples,
+		 * the oldest is discarded.
+		 * @param startTime The time the exposure started, in milliseconds since the epoch.
+		 * @param exposureLength The exposure length, in milliseconds.
+		 * @param filterSensitivity The relative sensitivity of the filter used.
+		 * @param bin The binning factor used.
+		 * @param meanCounts The mean counts measured in the frame.
+		 * @see #fit
+		 */
+		public void addSample(long startTime,int exposureLength,double filterSensitivity,int bin,
+				      double meanCounts)
+		{
+			double rate;
+
+			if((exposureLength <= 0)||(filterSensitivity <= 0.0)||(bin <= 0)||(meanCounts <= 0.0))
+				return;
+			rate = meanCounts/(((double)exposureLength)*filterSensitivity*((double)(bin*bin)));
+			if(sampleCount == 0)
+				timeZero = startTime;
+			if(sampleCount == maxSampleCount)
+			{
+				for(int i = 1; i < sampleCount; i++)
+				{
+					sampleTimeList[i-1] = sampleTimeList[i];
+					sampleLogRateList[i-1] = sampleLogRateList[i];
+				}
+				sampleCount--;
+			}
+			sampleTimeList[sampleCount] = ((double)(startTime-timeZero))+(((double)exposureLength)/2.0);
+			sampleLogRateList[sampleCount] = Math.log(rate);
+			sampleCount++;
+			fit();
+		}
+
+		/**
+		 * Least squares fit a straight line to the natural log of the sample rates against time.
+		 * The model is only fitted if there are at least two samples, spread over at least a second.
+		 * @see #logRateZero
+		 * @see #rateSlope
+		 * @see #fitted
+		 */
+		protected void fit()
+		{
+			double meanTime,meanLogRate,sumTimeTime,sumTimeLogRate,dt;
+
+			fitted = false;
+			if(sampleCount < 2)
+				return;
+			meanTime = 0.0;
+			meanLogRate = 0.0;
+			for(int i = 0; i < sampleCount; i++)
+			{
+				meanTime += sampleTimeList[i];
+				meanLogRate += sampleLogRateList[i];
+			}
+			meanTime /= (double)sampleCount;
+			meanLogRate /= (double)sampleCount;
+			sumTimeTime = 0.0;
+			sumTimeLogRate = 0.0;
+			for(int i = 0; i < sampleCount; i++)
+			{
+				dt = sampleTimeList[i]-meanTime;
+				sumTimeTime += dt*dt;
+				sumTimeLogRate += dt*(sampleLogRateList[i]-meanLogRate);
+			}
+			// samples must be spread over at least a second (standard deviation) to constrain the slope
+			if(sumTimeTime < (1000.0*1000.0*((double)sampleCount)))
+				return;
+			rateSlope = sumTimeLogRate/sumTimeTime;
+			logRateZero = meanLogRate-(rateSlope*meanTime);
+			fitted = true;
+		}
+
+		/**
+		 * Get the normalised count rate predicted at the specified time.
+		 * @param time The time, in milliseconds since the epoch.
+		 * @return The count rate, in counts per millisecond through a filter of relative sensitivity 1.0
+		 *         at binning 1.
+		 */
+		protected double getRate(long time)
+		{
+			return Math.exp(logRateZero+(rateSlope*((double)(time-timeZero))));
+		}
+
+		/**
+		 * Predict the mean counts of a frame. The exponential sky rate is integrated over the exposure.
+		 * @param startTime The time the exposure will start, in milliseconds since the epoch.
+		 * @param exposureLength The exposure length, in milliseconds.
+		 * @param filterSensitivity The relative sensitivity of the filter.
+		 * @param bin The binning factor.
+		 * @return The predicted mean counts.
+		 */
+		public double predictMeanCounts(long startTime,int exposureLength,double filterSensitivity,int bin)
+		{
+			double startRate,x;
+
+			startRate = getRate(startTime)*filterSensitivity*((double)(bin*bin));
+			x = rateSlope*((double)exposureLength);
+			if(Math.abs(x) < 1.0e-6)
+				return startRate*((double)exposureLength);
+			return startRate*(Math.exp(x)-1.0)/rateSlope;
+		}
+
+		/**
+		 * Predict the exposure length needed to get the specified mean counts. The exponential sky rate is
+		 * integrated over the exposure, so a long exposure at sunset takes account of the sky fading 
+		 * during it.
+		 * @param startTime The time the exposure will start, in milliseconds since the epoch.
+		 * @param targetMeanCounts The mean counts the frame should have.
+		 * @param filterSensitivity The relative sensitivity of the filter.
+		 * @param bin The binning factor.
+		 * @return The exposure length, in milliseconds. If the sky is fading too quickly for the target mean counts
+		 *         to ever be reached, Integer.MAX_VALUE is returned.
+		 */
+		public int getExposureLength(long startTime,double targetMeanCounts,double filterSensitivity,int bin)
+		{
+			double startRate,x,length;
+
+			startRate = getRate(startTime)*filterSensitivity*((double)(bin*bin));
+			if(startRate <= 0.0)
+				return Integer.MAX_VALUE;
+			x = (targetMeanCounts*rateSlope)/startRate;
+			if(Math.abs(x) < 1.0e-6)
+				length = targetMeanCounts/startRate;
+			else if((1.0+x) <= 0.0)
+				return Integer.MAX_VALUE;
+			else
+				length = Math.log(1.0+x)/rateSlope;
+			if(length >= ((double)Integer.MAX_VALUE))
+				return Integer.MAX_VALUE;
+			return (int)length;
+		}
+
+		/**
+		 * Add a prediction error to the model's statistics.
+		 * @param predictedMeanCounts The mean counts the model predicted for a frame.
+		 * @param measuredMeanCounts The mean counts measured in the frame.
+		 */
+		public void addPredictionError(double predictedMeanCounts,double measuredMeanCounts)
+		{
+			if(predictedMeanCounts <= 0.0)
+				return;
+			lastPredictionError = (measuredMeanCounts-predictedMeanCounts)/predictedMeanCounts;
+			predictionErrorSumSquares += lastPredictionError*lastPredictionError;
+			predictionErrorCount++;
+		}
+
+		/**
+		 * Get whether the model has been fitted, and can be used to predict exposure lengths.
+		 * @return true if the model has been fitted.
+		 */
+		public boolean isFitted()
+		{
+			return fitted;
+		}
+
+		/**
+		 * Get the number of samples held by the model.
+		 * @return The number of samples.
+		 */
+		public int getSampleCount()
+		{
+			return sampleCount;
+		}
+
+		/**
+		 * Get the time constant of the sky brightness change, i.e. how long the sky takes to get e times 
+		 * brighter (positive, sunrise) or dimmer (negative, sunset).
+		 * @return The time constant, in milliseconds, or 0 if the model has not been fitted or the sky 
+		 *         brightness is constant.
+		 */
+		public double getTimeConstant()
+		{
+			if((fitted == false)||(rateSlope == 0.0))
+				return 0.0;
+			return 1.0/rateSlope;
+		}
+
+		/**
+		 * Get the last fractional prediction error, (measured-predicted)/predicted.
+		 * @return The last prediction error.
+		 */
+		public double getLastPredictionError()
+		{
+			return lastPredictionError;
+		}
+
+		/**
+		 * Get the root mean square fractional prediction error.
+		 * @return The RMS prediction error, or 0 if no prediction errors have been added.
+		 */
+		public double getPredictionErrorRMS()
+		{
+			if(predictionErrorCount == 0)
+				return 0.0;
+			return Math.sqrt(predictionErrorSumSquares/((double)predictionErrorCount));
+		}
+
+		/**
+		 * Get the number of prediction errors added.
+		 * @return The number of prediction errors.
+		 */
+		public int getPredictionErrorCount()
+		{
+			return predictionErrorCount;
+		}
+	}// end TWILIGHT_CALIBRATESkyModel
+
 }
 
 //
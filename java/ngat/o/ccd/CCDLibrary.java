@@ -248,6 +248,128 @@ public class CCDLibrary
 	 * @see #interfaceOpen
 	 */
 	public final static int INTERFACE_DEVICE_PCI = 		2;
+// ccd_combine.h
+	/* These constants should be the same as those in ccd_combine.h */
+	/**
+	 * Combine method passed to combineConfig: The master frame is the mean of the frames.
+	 * @see #combineConfig
+	 */
+	public final static int COMBINE_METHOD_MEAN =		0;
+	/**
+	 * Combine method passed to combineConfig: The master frame is the sigma clipped mean of the frames.
+	 * @see #combineConfig
+	 */
+	public final static int COMBINE_METHOD_CLIPPED_MEAN =	1;
+	/**
+	 * Combine method passed to combineConfig: The master frame is the median of the frames.
+	 * @see #combineConfig
+	 */
+	public final static int COMBINE_METHOD_MEDIAN =		2;
+// ccd_compress.h
+	/* These constants should be the same as those in ccd_compress.h */
+	/**
+	 * Compression type passed to setCompression: Images are saved uncompressed.
+	 * @see #setCompression
+	 */
+	public final static int COMPRESS_TYPE_NONE =		0;
+	/**
+	 * Compression type passed to setCompression: Images are saved as lossless Rice tile-compressed images.
+	 * @see #setCompression
+	 */
+	public final static int COMPRESS_TYPE_RICE =		1;
+// ccd_disk_write.h
+	/* These constants should be the same as those in ccd_disk_write.h */
+	/**
+	 * Fsync policy passed to setDiskWrite: Files are not synchronised to disc when closed.
+	 * @see #setDiskWrite
+	 */
+	public final static int DISK_WRITE_FSYNC_NONE =		0;
+	/**
+	 * Fsync policy passed to setDiskWrite: fdatasync is called on each file before it is closed.
+	 * @see #setDiskWrite
+	 */
+	public final static int DISK_WRITE_FSYNC_DATA =		1;
+	/**
+	 * Fsync policy passed to setDiskWrite: fsync is called on each file before it is closed.
+	 * @see #setDiskWrite
+	 */
+	public final static int DISK_WRITE_FSYNC_FULL =		2;
+// ccd_timing.h
+	/* These constants should be the same as those in ccd_timing.h */
+	/**
+	 * Exposure timing phase: From the start of the exposure to the start of the wait/clear (controller configuration).
+	 * @see #getExposureTimingPercentile
+	 */
+	public final static int TIMING_PHASE_SETUP =		0;
+	/**
+	 * Exposure timing phase: Waiting for the requested exposure start time.
+	 * @see #getExposureTimingPercentile
+	 */
+	public final static int TIMING_PHASE_WAIT_START =	1;
+	/**
+	 * Exposure timing phase: Clearing the array.
+	 * @see #getExposureTimingPercentile
+	 */
+	public final static int TIMING_PHASE_CLEAR =		2;
+	/**
+	 * Exposure timing phase: From sending SEX to pre-readout (or readout being detected).
+	 * @see #getExposureTimingPercentile
+	 */
+	public final static int TIMING_PHASE_EXPOSE =		3;
+	/**
+	 * Exposure timing phase: Pre-readout, until readout is detected.
+	 * @see #getExposureTimingPercentile
+	 */
+	public final static int TIMING_PHASE_PRE_READOUT =	4;
+	/**
+	 * Exposure timing phase: From readout being detected to all the pixels being detected.
+	 * @see #getExposureTimingPercentile
+	 */
+	public final static int TIMING_PHASE_READOUT =		5;
+	/**
+	 * Exposure timing phase: The estimated gap between the last pixel arriving and it being detected.
+	 * @see #getExposureTimingPercentile
+	 */
+	public final static int TIMING_PHASE_READOUT_DETECT =	6;
+	/**
+	 * Exposure timing phase: De-interlacing the read out data.
+	 * @see #getExposureTimingPercentile
+	 */
+	public final static int TIMING_PHASE_DEINTERLACE =	7;
+	/**
+	 * Exposure timing phase: Saving the image data into the FITS file(s).
+	 * @see #getExposureTimingPercentile
+	 */
+	public final static int TIMING_PHASE_SAVE =		8;
+	/**
+	 * Exposure timing phase: All post-readout processing (including de-interlacing and saving).
+	 * @see #getExposureTimingPercentile
+	 */
+	public final static int TIMING_PHASE_POST_READOUT =	9;
+	/**
+	 * Exposure timing phase: From the C library exposure routine returning, to the JNI layer returning to Java.
+	 * @see #getExposureTimingPercentile
+	 */
+	public final static int TIMING_PHASE_RETURN =		10;
+	/**
+	 * Exposure timing phase: The whole exposure.
+	 * @see #getExposureTimingPercentile
+	 */
+	public final static int TIMING_PHASE_TOTAL =		11;
+	/**
+	 * The number of exposure timing phases.
+	 */
+	public final static int TIMING_PHASE_COUNT =		12;
+	/**
+	 * The maximum number of exposure configurations (binning, amplifier and windowing) timed separately.
+	 * @see #getExposureTimingConfig
+	 */
+	public final static int TIMING_MAX_CONFIG_COUNT =	8;
+	/**
+	 * The configuration index to pass into getExposureTimingPercentile to combine all configurations.
+	 * @see #getExposureTimingPercentile
+	 */
+	public final static int TIMING_CONFIG_ALL =		-1;
 // ccd_setup.h 
 	/* These constants should be the same as those in ccd_setup.h */
 	/**
@@ -338,6 +460,15 @@ public class CCDLibrary
 	 * Native wrapper to return this module's error number.
 	 */
 	private native int CCD_DSP_Get_Error_Number();
+	/**
+	 * Native wrapper to libo_ccd routine that gets a percentile of the recent abort latencies.
+	 * @exception CCDLibraryNativeException This method throws a CCDLibraryNativeException if it failed.
+	 */
+	private native double CCD_DSP_Abort_Latency_Get(double percentile) throws CCDLibraryNativeException;
+	/**
+	 * Native wrapper to libo_ccd routine that gets the number of recent abort latencies.
+	 */
+	private native int CCD_DSP_Abort_Latency_Sample_Count_Get();
 // ccd_exposure.h
 	/**
 	 * Native wrapper to libo_ccd routine that does an exposure.
@@ -408,6 +539,22 @@ public class CCDLibrary
 	 * Native wrapper to get the exposure readout delay.
 	 */
 	private native int CCD_Exposure_Readout_Delay_Get();
+	/**
+	 * Native wrapper to libo_ccd routine that configures the final approach to a timed exposure start.
+	 * @exception CCDLibraryNativeException This method throws a CCDLibraryNativeException if it failed.
+	 */
+	private native void CCD_Exposure_Start_Approach_Set(int approach_ms,boolean increase_priority)
+		throws CCDLibraryNativeException;
+	/**
+	 * Native wrapper to libo_ccd routine that gets a percentile of the recent timed exposure start errors.
+	 * @exception CCDLibraryNativeException This method throws a CCDLibraryNativeException if it failed.
+	 */
+	private native double CCD_Exposure_Start_Error_Percentile_Get(double percentile)
+		throws CCDLibraryNativeException;
+	/**
+	 * Native wrapper to libo_ccd routine that gets the number of recent timed exposure start errors.
+	 */
+	private native int CCD_Exposure_Start_Error_Sample_Count_Get();
 // ccd_filter_wheel.h
 	/**
 	 * Native wrapper to libo_ccd routine that sets the number of positions in each filter wheel.
@@ -419,6 +566,22 @@ public class CCDLibrary
 	 * @exception CCDLibraryNativeException This method throws a CCDLibraryNativeException if it failed.
 	 */
 	private native void CCD_Filter_Wheel_Move(int position) throws CCDLibraryNativeException;
+	/**
+	 * Native wrapper to libo_ccd routine that starts an asynchronous filter wheel move.
+	 * @exception CCDLibraryNativeException This method throws a CCDLibraryNativeException if it failed.
+	 */
+	private native void CCD_Filter_Wheel_Move_Start(int position) throws CCDLibraryNativeException;
+	/**
+	 * Native wrapper to libo_ccd routine that waits for an asynchronous filter wheel move to complete.
+	 * @exception CCDLibraryNativeException This method throws a CCDLibraryNativeException if the move failed.
+	 */
+	private native void CCD_Filter_Wheel_Move_Wait() throws CCDLibraryNativeException;
+	/**
+	 * Native wrapper to libo_ccd routine that estimates how long a filter wheel move will take.
+	 * @exception CCDLibraryNativeException This method throws a CCDLibraryNativeException if it failed.
+	 */
+	private native double CCD_Filter_Wheel_Move_Time_Estimate(int from_position,int to_position)
+		throws CCDLibraryNativeException;
 	/**
 	 * Native wrapper to libo_ccd routine that aborts a filter wheel move or reset.
 	 * @exception CCDLibraryNativeException This method throws a CCDLibraryNativeException if it failed.
@@ -589,6 +752,269 @@ public class CCDLibrary
 	 */
 	private native int CCD_Setup_Get_Error_Number();
 
+// ccd_combine.h
+	/**
+	 * Native wrapper to libo_ccd routine that configures the master frame combine.
+	 * @exception CCDLibraryNativeException This method throws a CCDLibraryNativeException if it failed.
+	 */
+	private native void CCD_Combine_Set_Config(int method,double clip_sigma,int thread_count,int memory_limit)
+		throws CCDLibraryNativeException;
+	/**
+	 * Native wrapper to libo_ccd routine that starts a master frame combine.
+	 * @exception CCDLibraryNativeException This method throws a CCDLibraryNativeException if it failed.
+	 */
+	private native void CCD_Combine_Start() throws CCDLibraryNativeException;
+	/**
+	 * Native wrapper to libo_ccd routine that gets the number of frames added to the combine.
+	 */
+	private native int CCD_Combine_Get_Frame_Count();
+	/**
+	 * Native wrapper to libo_ccd routine that saves the master frame, and finishes the combine.
+	 * @exception CCDLibraryNativeException This method throws a CCDLibraryNativeException if it failed.
+	 */
+	private native void CCD_Combine_Save(String filename) throws CCDLibraryNativeException;
+	/**
+	 * Native wrapper to libo_ccd routine that aborts the combine.
+	 * @exception CCDLibraryNativeException This method throws a CCDLibraryNativeException if it failed.
+	 */
+	private native void CCD_Combine_Abort() throws CCDLibraryNativeException;
+
+// ccd_compress.h
+	/**
+	 * Native wrapper to libo_ccd routine that configures image compression.
+	 * @exception CCDLibraryNativeException This method throws a CCDLibraryNativeException if it failed.
+	 */
+	private native void CCD_Compress_Set_Config(int type,int thread_count) throws CCDLibraryNativeException;
+	/**
+	 * Native wrapper to libo_ccd routine that gets the configured compression type.
+	 */
+	private native int CCD_Compress_Get_Type();
+
+// ccd_disk_write.h
+	/**
+	 * Native wrapper to libo_ccd routine that configures direct disc writing.
+	 * @exception CCDLibraryNativeException This method throws a CCDLibraryNativeException if it failed.
+	 */
+	private native void CCD_Disk_Write_Set_Config(boolean enable,int fsync_policy) throws CCDLibraryNativeException;
+	/**
+	 * Native wrapper to libo_ccd routine that gets whether image data is written directly to disc.
+	 */
+	private native boolean CCD_Disk_Write_Get_Enable();
+	/**
+	 * Native wrapper to libo_ccd routine that gets a percentile of the recent direct disc write latencies.
+	 * @exception CCDLibraryNativeException This method throws a CCDLibraryNativeException if it failed.
+	 */
+	private native double CCD_Disk_Write_Latency_Get(double percentile) throws CCDLibraryNativeException;
+	/**
+	 * Native wrapper to libo_ccd routine that gets the number of recent direct disc write latencies.
+	 */
+	private native int CCD_Disk_Write_Latency_Sample_Count_Get();
+
+// ccd_frame_ring.h
+	/**
+	 * Native wrapper to libo_ccd routine that creates the shared memory frame ring.
+	 * @exception CCDLibraryNativeException This method throws a CCDLibraryNativeException if it failed.
+	 */
+	private native void CCD_Frame_Ring_Open(String name,int slot_count,int slot_pixel_count) 
+		throws CCDLibraryNativeException;
+	/**
+	 * Native wrapper to libo_ccd routine that closes the shared memory frame ring.
+	 * @exception CCDLibraryNativeException This method throws a CCDLibraryNativeException if it failed.
+	 */
+	private native void CCD_Frame_Ring_Close() throws CCDLibraryNativeException;
+
+// ccd_preview.h
+	/**
+	 * Native wrapper to libo_ccd routine that configures the quick-look previews.
+	 * @exception CCDLibraryNativeException This method throws a CCDLibraryNativeException if it failed.
+	 */
+	private native void CCD_Preview_Set_Config(boolean enable,String directory,int bin_factor_list[],
+						   double low_percentile,double high_percentile) 
+		throws CCDLibraryNativeException;
+
+// ccd_timing.h
+	/**
+	 * Native wrapper to libo_ccd routine that gets a percentile of the durations of an exposure phase.
+	 * @exception CCDLibraryNativeException This method throws a CCDLibraryNativeException if it failed.
+	 */
+	private native double CCD_Timing_Percentile_Get(int config_index,int phase,double percentile) 
+		throws CCDLibraryNativeException;
+	/**
+	 * Native wrapper to libo_ccd routine that gets the number of durations of an exposure phase.
+	 * @exception CCDLibraryNativeException This method throws a CCDLibraryNativeException if it failed.
+	 */
+	private native int CCD_Timing_Count_Get(int config_index,int phase) throws CCDLibraryNativeException;
+	/**
+	 * Native wrapper to libo_ccd routine that gets a timed exposure configuration.
+	 * @exception CCDLibraryNativeException This method throws a CCDLibraryNativeException if it failed.
+	 */
+	private native int[] CCD_Timing_Config_Get(int config_index) throws CCDLibraryNativeException;
+	/**
+	 * Native wrapper to libo_ccd routine that gets the name of an exposure phase.
+	 */
+	private native String CCD_Timing_Phase_Name_Get(int phase);
+	/**
+	 * Native wrapper to libo_ccd routine that clears the exposure phase histograms.
+	 * @exception CCDLibraryNativeException This method throws a CCDLibraryNativeException if it failed.
+	 */
+	private native void CCD_Timing_Reset() throws CCDLibraryNativeException;
+
+// ccd_trace.h
+	/**
+	 * Native wrapper to libo_ccd routine that turns controller request tracing on or off.
+	 */
+	private native void CCD_Trace_Set_Enable(boolean enable);
+	/**
+	 * Native wrapper to libo_ccd routine that returns whether controller requests are being traced.
+	 */
+	private native boolean CCD_Trace_Get_Enable();
+	/**
+	 * Native wrapper to libo_ccd routine that dumps the controller request trace to a file.
+	 * @exception CCDLibraryNativeException This method throws a CCDLibraryNativeException if it failed.
+	 */
+	private native void CCD_Trace_Dump(String filename) throws CCDLibraryNativeException;
+	/**
+	 * Native wrapper to libo_ccd routine that returns the controller request latency counters as a string.
+	 * @exception CCDLibraryNativeException This method throws a CCDLibraryNativeException if it failed.
+	 */
+	private native String CCD_Trace_Counters_Get() throws CCDLibraryNativeException;
+	/**
+	 * Native wrapper to libo_ccd routine that clears the controller request trace.
+	 * @exception CCDLibraryNativeException This method throws a CCDLibraryNativeException if it failed.
+	 */
+	private native void CCD_Trace_Reset() throws CCDLibraryNativeException;
+
+// ccd_frame_view.h
+	/**
+	 * Native wrapper to libo_ccd routine that turns frame viewing on or off.
+	 */
+	private native void CCD_Frame_View_Set_Enable(boolean enable);
+	/**
+	 * Native wrapper to libo_ccd routine that returns whether frame viewing is on.
+	 */
+	private native boolean CCD_Frame_View_Get_Enable();
+	/**
+	 * Native wrapper to libo_ccd routine that acquires a view of the latest de-interlaced frame.
+	 * @exception CCDLibraryNativeException This method throws a CCDLibraryNativeException if it failed.
+	 */
+	private native CCDLibraryFrame CCD_Frame_View_Acquire() throws CCDLibraryNativeException;
+	/**
+	 * Native wrapper to libo_ccd routine that releases an acquired de-interlaced frame.
+	 * @exception CCDLibraryNativeException This method throws a CCDLibraryNativeException if it failed.
+	 */
+	private native void CCD_Frame_View_Release(int sequence) throws CCDLibraryNativeException;
+	/**
+	 * Native wrapper to libo_ccd routine that gets a copy of the raw readout buffer.
+	 * @exception CCDLibraryNativeException This method throws a CCDLibraryNativeException if it failed.
+	 */
+	private native CCDLibraryFrame CCD_Frame_View_Raw_Get() throws CCDLibraryNativeException;
+	/**
+	 * Native wrapper to libo_ccd routine that gets the current raw readout buffer sequence number.
+	 */
+	private native int CCD_Frame_View_Raw_Sequence_Get();
+
+// ccd_exposure_event.h
+	/**
+	 * Native wrapper to libo_ccd routine that waits for exposure events, and returns them in a batch.
+	 * @exception CCDLibraryNativeException This method throws a CCDLibraryNativeException if it failed.
+	 */
+	private native CCDLibraryExposureEvent[] CCD_Exposure_Event_Wait(int timeout_ms) 
+		throws CCDLibraryNativeException;
+	/**
+	 * Native wrapper to libo_ccd routine that posts a complete event for an asynchronous exposure.
+	 */
+	private native void CCD_Exposure_Event_Post_Complete(int id);
+	/**
+	 * Native wrapper to libo_ccd routine that removes all queued exposure events.
+	 */
+	private native void CCD_Exposure_Event_Flush();
+	/**
+	 * Native wrapper to libo_ccd routine that returns the number of exposure events dropped as the queue was full.
+	 */
+	private native int CCD_Exposure_Event_Get_Dropped_Count();
+
+// ccd_status.h
+	/**
+	 * Native wrapper to libo_ccd routine that fills in a status snapshot.
+	 * @exception CCDLibraryNativeException This method throws a CCDLibraryNativeException if it failed.
+	 */
+	private native void CCD_Status_Get(CCDLibraryStatus status,int flags) throws CCDLibraryNativeException;
+	/**
+	 * Native wrapper to return ccd_status's error number.
+	 */
+	private native int CCD_Status_Get_Error_Number();
+
+// ccd_source_find.h
+	/**
+	 * Native wrapper to libo_ccd routine that configures the source finder.
+	 * @exception CCDLibraryNativeException This method throws a CCDLibraryNativeException if it failed.
+	 */
+	private native void CCD_Source_Find_Set_Config(double threshold_sigma,int min_pixel_count,int thread_count) 
+		throws CCDLibraryNativeException;
+	/**
+	 * Native wrapper to libo_ccd routine that turns the source finder on or off.
+	 * @exception CCDLibraryNativeException This method throws a CCDLibraryNativeException if it failed.
+	 */
+	private native void CCD_Source_Find_Set_Enable(boolean enable) throws CCDLibraryNativeException;
+	/**
+	 * Native wrapper to libo_ccd routine that gets the source finder result for the last frame read out.
+	 * @exception CCDLibraryNativeException This method throws a CCDLibraryNativeException if it failed.
+	 */
+	private native CCDLibrarySourceFindResult CCD_Source_Find_Get_Last_Result() throws CCDLibraryNativeException;
+
+// ccd_seeing.h
+	/**
+	 * Native wrapper to libo_ccd routine that configures the seeing estimator.
+	 * @exception CCDLibraryNativeException This method throws a CCDLibraryNativeException if it failed.
+	 */
+	private native void CCD_Seeing_Set_Config(double threshold_sigma,int cutout_radius,int saturation_counts,
+						  int max_source_count,int thread_count) throws CCDLibraryNativeException;
+	/**
+	 * Native wrapper to libo_ccd routine that turns the seeing estimator on or off.
+	 * @exception CCDLibraryNativeException This method throws a CCDLibraryNativeException if it failed.
+	 */
+	private native void CCD_Seeing_Set_Enable(boolean enable) throws CCDLibraryNativeException;
+	/**
+	 * Native wrapper to libo_ccd routine that gets the seeing estimator result for the last frame read out.
+	 * @exception CCDLibraryNativeException This method throws a CCDLibraryNativeException if it failed.
+	 */
+	private native CCDLibrarySeeingResult CCD_Seeing_Get_Last_Result() throws CCDLibraryNativeException;
+
+// ccd_readout_watchdog.h
+	/**
+	 * Native wrapper to libo_ccd routine that configures the readout progress-rate watchdog.
+	 * @exception CCDLibraryNativeException This method throws a CCDLibraryNativeException if it failed.
+	 */
+	private native void CCD_Readout_Watchdog_Set_Config(int poll_period_ms,double stall_factor,
+			   int min_stall_time_ms,int unknown_stall_time_ms,double slow_ratio) throws CCDLibraryNativeException;
+
+// ccd_telemetry.h
+	/**
+	 * Native wrapper to libo_ccd routine that starts the telemetry sampler thread.
+	 * @exception CCDLibraryNativeException This method throws a CCDLibraryNativeException if it failed.
+	 */
+	private native void CCD_Telemetry_Start(int period_ms) throws CCDLibraryNativeException;
+	/**
+	 * Native wrapper to libo_ccd routine that stops the telemetry sampler thread.
+	 * @exception CCDLibraryNativeException This method throws a CCDLibraryNativeException if it failed.
+	 */
+	private native void CCD_Telemetry_Stop() throws CCDLibraryNativeException;
+	/**
+	 * Native wrapper to libo_ccd routine that gets the latest telemetry snapshot.
+	 * @exception CCDLibraryNativeException This method throws a CCDLibraryNativeException if it failed.
+	 */
+	private native CCDLibraryTelemetry CCD_Telemetry_Get() throws CCDLibraryNativeException;
+// ccd_telemetry_store.h
+	/**
+	 * Native wrapper to libo_ccd routine that opens the telemetry store ring file for writing.
+	 * @exception CCDLibraryNativeException This method throws a CCDLibraryNativeException if it failed.
+	 */
+	private native void CCD_Telemetry_Store_Open(String filename,int record_count) throws CCDLibraryNativeException;
+	/**
+	 * Native wrapper to libo_ccd routine that closes the telemetry store ring file.
+	 * @exception CCDLibraryNativeException This method throws a CCDLibraryNativeException if it failed.
+	 */
+	private native void CCD_Telemetry_Store_Close() throws CCDLibraryNativeException;
 // ccd_temperature.h
 	/**
 	 * Native wrapper to libo_ccd routine that gets the current temperature of the CCD.
@@ -646,6 +1072,34 @@ public class CCDLibrary
 	 * The logger to log messages to.
 	 */
 	protected Logger logger = null;
+	/**
+	 * The generation number of the C layer's interface handle for this instance, or 0 if the interface is not open.
+	 * Set and read only by the JNI layer, which uses it to find the handle without searching a map on every
+	 * native call, and to check the handle is still open before using it.
+	 * @see #interfaceOpen
+	 * @see #interfaceClose
+	 */
+	private int nativeHandleGeneration = 0;
+	/**
+	 * The current (or last) asynchronous exposure, or null if exposeAsync has not been called.
+	 * @see #exposeAsync
+	 */
+	protected CCDLibraryExposure asyncExposure = null;
+	/**
+	 * The identifier given to the last asynchronous exposure.
+	 * @see #exposeAsync
+	 */
+	protected int asyncExposureId = 0;
+	/**
+	 * The thread delivering exposure events to the current asynchronous exposure. Started by the first
+	 * call to exposeAsync.
+	 * @see #exposeAsync
+	 */
+	protected ExposureEventThread exposureEventThread = null;
+	/**
+	 * Lock protecting asyncExposure, asyncExposureId and exposureEventThread.
+	 */
+	protected Object asyncExposureLock = new Object();
 
 // static code block
 	/**
@@ -703,6 +1157,29 @@ public class CCDLibrary
 		return CCD_DSP_Get_Error_Number();
 	}
 
+	/**
+	 * Method to get a percentile of the recent abort latencies, the time from an abort being requested
+	 * (abort or setupAbort) to the aborted operation (expose, bias, setupStartup or setupDimensions) returning.
+	 * @param percentile The percentile, from 0 to 100 (i.e. 50 for the median, 100 for the maximum).
+	 * @return The latency percentile, in seconds, or 0.0 if no aborts have completed.
+	 * @exception CCDLibraryNativeException This method throws a CCDLibraryNativeException if it failed.
+	 * @see #CCD_DSP_Abort_Latency_Get
+	 */
+	public double getAbortLatency(double percentile) throws CCDLibraryNativeException
+	{
+		return CCD_DSP_Abort_Latency_Get(percentile);
+	}
+
+	/**
+	 * Method to get the number of recent abort latencies the percentiles are computed from.
+	 * @return The number of latencies.
+	 * @see #CCD_DSP_Abort_Latency_Sample_Count_Get
+	 */
+	public int getAbortLatencySampleCount()
+	{
+		return CCD_DSP_Abort_Latency_Sample_Count_Get();
+	}
+
 	/**
 	 * Routine to parse a gain string and return a gain number suitable for input into
 	 * <a href="#setupStartup">setupStartup</a>, or a DSP Set Gain (SGN) command. 
@@ -1023,30 +1500,68 @@ public class CCDLibrary
 	}
 
 	/**
-	 * Returns the current error number from this module of the library. A zero means there is no error.
-	 * @return Returns an error number.
-	 * @see #CCD_Exposure_Get_Error_Number
+	 * Method to configure the final approach to a timed exposure start (an expose with a start time).
+	 * Until approach_ms before the start, the library sleeps in abortable steps of at most a second; it then
+	 * sleeps until the start time in short absolute time sleeps, checking for an abort between them.
+	 * @param approach_ms The length of the final approach, in milliseconds.
+	 * @param increase_priority Whether to increase the process priority for the final approach. This only has an
+	 *        effect if the library was compiled with a readout priority.
+	 * @exception CCDLibraryNativeException This method throws a CCDLibraryNativeException if it failed.
+	 * @see #CCD_Exposure_Start_Approach_Set
 	 */
-	public int getExposureErrorNumber()
+	public void setStartApproach(int approach_ms,boolean increase_priority) throws CCDLibraryNativeException
 	{
-		return CCD_Exposure_Get_Error_Number();
+		CCD_Exposure_Start_Approach_Set(approach_ms,increase_priority);
 	}
 
-// ccd_filter_wheel.h
 	/**
-	 * Method to setup the number of positions in the filter wheel.
-	 * @param positionCount The number of positions in the filter wheel.
+	 * Method to get a percentile of the absolute start errors of recent timed exposures, how far from the
+	 * requested time the exposure was started.
+	 * @param percentile The percentile, from 0 to 100 (i.e. 50 for the median, 100 for the maximum).
+	 * @return The start error percentile, in seconds, or 0.0 if no timed exposures have been started.
 	 * @exception CCDLibraryNativeException This method throws a CCDLibraryNativeException if it failed.
-	 * @see #CCD_Filter_Wheel_Position_Count_Set
+	 * @see #CCD_Exposure_Start_Error_Percentile_Get
 	 */
-	public void filterWheelPositionCountSet(int positionCount) throws CCDLibraryNativeException
+	public double getStartError(double percentile) throws CCDLibraryNativeException
 	{
-		CCD_Filter_Wheel_Position_Count_Set(positionCount);
+		return CCD_Exposure_Start_Error_Percentile_Get(percentile);
 	}
 
 	/**
-	 * Method to reset the filter wheel to a known position.
-	 * This routine can be aborted with filterWheelAbort.
+	 * Method to get the number of recent timed exposure start errors the percentiles are computed from.
+	 * @return The number of start errors.
+	 * @see #CCD_Exposure_Start_Error_Sample_Count_Get
+	 */
+	public int getStartErrorSampleCount()
+	{
+		return CCD_Exposure_Start_Error_Sample_Count_Get();
+	}
+
+	/**
+	 * Returns the current error number from this module of the library. A zero means there is no error.
+	 * @return Returns an error number.
+	 * @see #CCD_Exposure_Get_Error_Number
+	 */
+	public int getExposureErrorNumber()
+	{
+		return CCD_Exposure_Get_Error_Number();
+	}
+
+// ccd_filter_wheel.h
+	/**
+	 * Method to setup the number of positions in the filter wheel.
+	 * @param positionCount The number of positions in the filter wheel.
+	 * @exception CCDLibraryNativeException This method throws a CCDLibraryNativeException if it failed.
+	 * @see #CCD_Filter_Wheel_Position_Count_Set
+	 */
+	public void filterWheelPositionCountSet(int positionCount) throws CCDLibraryNativeException
+	{
+		CCD_Filter_Wheel_Position_Count_Set(positionCount);
+	}
+
+	/**
+	 * Method to reset the filter wheel to a known position.
+	 * This routine can be aborted with filterWheelAbort.
 	 * @exception CCDLibraryNativeException This method throws a CCDLibraryNativeException if it failed.
 	 * @see #filterWheelAbort
 	 * @see #CCD_Filter_Wheel_Reset
@@ -1069,6 +1584,46 @@ public class CCDLibrary
 		CCD_Filter_Wheel_Move(position);
 	}
 
+	/**
+	 * Method to start moving the filter wheel to the required position, without waiting for the move to complete.
+	 * filterWheelMoveWait <b>must</b> be called to wait for the move to finish, before another move is started.
+	 * This routine can be aborted with filterWheelAbort.
+	 * @param position The absolute position to move the specified wheel to.
+	 * @exception CCDLibraryNativeException This method throws a CCDLibraryNativeException if the move 
+	 *            could not be started.
+	 * @see #filterWheelMoveWait
+	 * @see #filterWheelAbort
+	 * @see #CCD_Filter_Wheel_Move_Start
+	 */
+	public void filterWheelMoveStart(int position) throws CCDLibraryNativeException
+	{
+		CCD_Filter_Wheel_Move_Start(position);
+	}
+
+	/**
+	 * Method to wait for a filter wheel move started by filterWheelMoveStart to complete.
+	 * @exception CCDLibraryNativeException This method throws a CCDLibraryNativeException if the move failed.
+	 * @see #filterWheelMoveStart
+	 * @see #CCD_Filter_Wheel_Move_Wait
+	 */
+	public void filterWheelMoveWait() throws CCDLibraryNativeException
+	{
+		CCD_Filter_Wheel_Move_Wait();
+	}
+
+	/**
+	 * Method to estimate how long a filter wheel move will take, based on previous moves.
+	 * @param fromPosition The position the wheel starts in, or -1 if it is unknown.
+	 * @param toPosition The position the wheel is moving to.
+	 * @return The estimated move time, in seconds.
+	 * @exception CCDLibraryNativeException This method throws a CCDLibraryNativeException if it failed.
+	 * @see #CCD_Filter_Wheel_Move_Time_Estimate
+	 */
+	public double filterWheelMoveTimeEstimate(int fromPosition,int toPosition) throws CCDLibraryNativeException
+	{
+		return CCD_Filter_Wheel_Move_Time_Estimate(fromPosition,toPosition);
+	}
+
 	/**
 	 * Method to abort a filter wheel move or reset operation.
 	 * @exception CCDLibraryNativeException This method throws a CCDLibraryNativeException if it failed.
@@ -1661,6 +2216,810 @@ public class CCDLibrary
 		throw new CCDLibraryFormatException("ngat.o.ccd.CCDLibrary","loadTypeFromString",s);
 	}
 
+// ccd_combine.h
+	/**
+	 * Method to configure the master frame combine. The configuration is used by the next combineStart.
+	 * @param method The combine method, one of COMBINE_METHOD_MEAN, COMBINE_METHOD_CLIPPED_MEAN or
+	 *        COMBINE_METHOD_MEDIAN.
+	 * @param clipSigma How many standard deviations from the mean a pixel must be to be rejected by
+	 *        the sigma clipped mean.
+	 * @param threadCount The number of threads (row bands) to split each frame into.
+	 * @param memoryLimit The memory, in megabytes, that can be used to keep copies of the frames for the
+	 *        median/clipped mean methods. If more frames are read out than fit, the master frame is the mean.
+	 * @exception CCDLibraryNativeException This method throws a CCDLibraryNativeException if it failed.
+	 * @see #COMBINE_METHOD_MEAN
+	 * @see #COMBINE_METHOD_CLIPPED_MEAN
+	 * @see #COMBINE_METHOD_MEDIAN
+	 * @see #CCD_Combine_Set_Config
+	 */
+	public void combineConfig(int method,double clipSigma,int threadCount,int memoryLimit)
+		throws CCDLibraryNativeException
+	{
+		CCD_Combine_Set_Config(method,clipSigma,threadCount,memoryLimit);
+	}
+
+	/**
+	 * Method to start a master frame combine. Each full frame read out after this is added to the combine
+	 * as it is de-interlaced, until combineSave or combineAbort is called.
+	 * @exception CCDLibraryNativeException This method throws a CCDLibraryNativeException if it failed.
+	 * @see #combineSave
+	 * @see #combineAbort
+	 * @see #CCD_Combine_Start
+	 */
+	public void combineStart() throws CCDLibraryNativeException
+	{
+		CCD_Combine_Start();
+	}
+
+	/**
+	 * Method to get the number of frames added to the current combine.
+	 * @return The number of frames.
+	 * @see #CCD_Combine_Get_Frame_Count
+	 */
+	public int getCombineFrameCount()
+	{
+		return CCD_Combine_Get_Frame_Count();
+	}
+
+	/**
+	 * Method to save the master frame (and the per-pixel variance) to a FITS file, and finish the combine.
+	 * @param filename The filename to save the master frame to. Any existing file is overwritten.
+	 * @exception CCDLibraryNativeException This method throws a CCDLibraryNativeException if it failed.
+	 *            The combine is finished whether this succeeds or not.
+	 * @see #CCD_Combine_Save
+	 */
+	public void combineSave(String filename) throws CCDLibraryNativeException
+	{
+		CCD_Combine_Save(filename);
+	}
+
+	/**
+	 * Method to abort the current combine. It is not an error to call this if no combine has been started.
+	 * @exception CCDLibraryNativeException This method throws a CCDLibraryNativeException if it failed.
+	 * @see #CCD_Combine_Abort
+	 */
+	public void combineAbort() throws CCDLibraryNativeException
+	{
+		CCD_Combine_Abort();
+	}
+
+	/**
+	 * Routine to parse a combine method string and return a combine method to pass into <b>combineConfig</b>.
+	 * @param s The string to parse, one of "MEAN", "CLIPPED_MEAN" or "MEDIAN".
+	 * @return The combine method.
+	 * @exception CCDLibraryFormatException If the string was not an accepted value an exception is thrown.
+	 * @see #COMBINE_METHOD_MEAN
+	 * @see #COMBINE_METHOD_CLIPPED_MEAN
+	 * @see #COMBINE_METHOD_MEDIAN
+	 */
+	public static int combineMethodFromString(String s) throws CCDLibraryFormatException
+	{
+		if(s.equals("MEAN"))
+			return COMBINE_METHOD_MEAN;
+		if(s.equals("CLIPPED_MEAN"))
+			return COMBINE_METHOD_CLIPPED_MEAN;
+		if(s.equals("MEDIAN"))
+			return COMBINE_METHOD_MEDIAN;
+		throw new CCDLibraryFormatException("ngat.o.ccd.CCDLibrary","combineMethodFromString",s);
+	}
+
+// ccd_compress.h
+	/**
+	 * Method to configure how subsequent images are saved.
+	 * @param type The compression type, COMPRESS_TYPE_NONE or COMPRESS_TYPE_RICE.
+	 * @param threadCount The number of threads the tiles of each image are compressed by.
+	 * @exception CCDLibraryNativeException This method throws a CCDLibraryNativeException if it failed.
+	 * @see #COMPRESS_TYPE_NONE
+	 * @see #COMPRESS_TYPE_RICE
+	 * @see #CCD_Compress_Set_Config
+	 */
+	public void setCompression(int type,int threadCount) throws CCDLibraryNativeException
+	{
+		CCD_Compress_Set_Config(type,threadCount);
+	}
+
+	/**
+	 * Method to get the configured compression type.
+	 * @return The compression type, COMPRESS_TYPE_NONE or COMPRESS_TYPE_RICE.
+	 * @see #CCD_Compress_Get_Type
+	 */
+	public int getCompressionType()
+	{
+		return CCD_Compress_Get_Type();
+	}
+
+	/**
+	 * Routine to parse a compression type string and return a compression type to pass into
+	 * <b>setCompression</b>.
+	 * @param s The string to parse, one of "NONE" or "RICE".
+	 * @return The compression type.
+	 * @exception CCDLibraryFormatException If the string was not an accepted value an exception is thrown.
+	 * @see #COMPRESS_TYPE_NONE
+	 * @see #COMPRESS_TYPE_RICE
+	 */
+	public static int compressionTypeFromString(String s) throws CCDLibraryFormatException
+	{
+		if(s.equals("NONE"))
+			return COMPRESS_TYPE_NONE;
+		if(s.equals("RICE"))
+			return COMPRESS_TYPE_RICE;
+		throw new CCDLibraryFormatException("ngat.o.ccd.CCDLibrary","compressionTypeFromString",s);
+	}
+
+// ccd_disk_write.h
+	/**
+	 * Method to configure whether subsequent image data is written directly to disc (O_DIRECT), rather than
+	 * through CFITSIO and the page cache.
+	 * @param enable True to write image data directly to disc.
+	 * @param fsyncPolicy How each file is synchronised to disc, one of DISK_WRITE_FSYNC_NONE,
+	 *        DISK_WRITE_FSYNC_DATA or DISK_WRITE_FSYNC_FULL.
+	 * @exception CCDLibraryNativeException This method throws a CCDLibraryNativeException if it failed.
+	 * @see #DISK_WRITE_FSYNC_NONE
+	 * @see #DISK_WRITE_FSYNC_DATA
+	 * @see #DISK_WRITE_FSYNC_FULL
+	 * @see #CCD_Disk_Write_Set_Config
+	 */
+	public void setDiskWrite(boolean enable,int fsyncPolicy) throws CCDLibraryNativeException
+	{
+		CCD_Disk_Write_Set_Config(enable,fsyncPolicy);
+	}
+
+	/**
+	 * Method to get whether image data is written directly to disc.
+	 * @return True if image data is written directly to disc.
+	 * @see #CCD_Disk_Write_Get_Enable
+	 */
+	public boolean getDiskWriteEnable()
+	{
+		return CCD_Disk_Write_Get_Enable();
+	}
+
+	/**
+	 * Method to get a percentile of the recent per-frame direct disc write latencies.
+	 * @param percentile The percentile, from 0 to 100 (i.e. 50 for the median, 100 for the maximum).
+	 * @return The latency percentile, in seconds, or 0.0 if no frames have been written.
+	 * @exception CCDLibraryNativeException This method throws a CCDLibraryNativeException if it failed.
+	 * @see #CCD_Disk_Write_Latency_Get
+	 */
+	public double getDiskWriteLatency(double percentile) throws CCDLibraryNativeException
+	{
+		return CCD_Disk_Write_Latency_Get(percentile);
+	}
+
+	/**
+	 * Method to get the number of recent per-frame direct disc write latencies the percentiles are computed from.
+	 * @return The number of latencies.
+	 * @see #CCD_Disk_Write_Latency_Sample_Count_Get
+	 */
+	public int getDiskWriteLatencySampleCount()
+	{
+		return CCD_Disk_Write_Latency_Sample_Count_Get();
+	}
+
+	/**
+	 * Routine to parse a fsync policy string and return a fsync policy to pass into <b>setDiskWrite</b>.
+	 * @param s The string to parse, one of "NONE", "DATA" or "FULL".
+	 * @return The fsync policy.
+	 * @exception CCDLibraryFormatException If the string was not an accepted value an exception is thrown.
+	 * @see #DISK_WRITE_FSYNC_NONE
+	 * @see #DISK_WRITE_FSYNC_DATA
+	 * @see #DISK_WRITE_FSYNC_FULL
+	 */
+	public static int diskWriteFsyncFromString(String s) throws CCDLibraryFormatException
+	{
+		if(s.equals("NONE"))
+			return DISK_WRITE_FSYNC_NONE;
+		if(s.equals("DATA"))
+			return DISK_WRITE_FSYNC_DATA;
+		if(s.equals("FULL"))
+			return DISK_WRITE_FSYNC_FULL;
+		throw new CCDLibraryFormatException("ngat.o.ccd.CCDLibrary","diskWriteFsyncFromString",s);
+	}
+
+// ccd_frame_ring.h
+	/**
+	 * Method to create the POSIX shared memory frame ring. Each read out frame is then published into it,
+	 * for local programs (i.e. quick-look) to use before it is saved.
+	 * @param name The shared memory object name, i.e. "/o_frame_ring".
+	 * @param slotCount The number of frames the ring holds.
+	 * @param slotPixelCount The maximum number of pixels in a frame.
+	 * @exception CCDLibraryNativeException This method throws a CCDLibraryNativeException if it failed.
+	 * @see #CCD_Frame_Ring_Open
+	 */
+	public void frameRingOpen(String name,int slotCount,int slotPixelCount) throws CCDLibraryNativeException
+	{
+		CCD_Frame_Ring_Open(name,slotCount,slotPixelCount);
+	}
+
+	/**
+	 * Method to close the shared memory frame ring.
+	 * @exception CCDLibraryNativeException This method throws a CCDLibraryNativeException if it failed.
+	 * @see #CCD_Frame_Ring_Close
+	 */
+	public void frameRingClose() throws CCDLibraryNativeException
+	{
+		CCD_Frame_Ring_Close();
+	}
+
+// ccd_preview.h
+	/**
+	 * Method to configure the quick-look previews produced for each full frame as it is read out.
+	 * Each preview is the frame block averaged by a binning factor, scaled to 8 bits between two percentiles
+	 * of it's pixel values, and saved as a FITS image with _p&lt;binning factor&gt; appended to the frame's name.
+	 * @param enable Whether to produce previews.
+	 * @param directory The directory to save previews in, or null to save them alongside the frame.
+	 * @param binFactorList The binning factor of each preview, in ascending order, i.e. {8,32}.
+	 * @param lowPercentile The percentile of pixel values scaled to black, i.e. 0.5.
+	 * @param highPercentile The percentile of pixel values scaled to white, i.e. 99.5.
+	 * @exception CCDLibraryNativeException This method throws a CCDLibraryNativeException if it failed.
+	 * @see #CCD_Preview_Set_Config
+	 */
+	public void setPreview(boolean enable,String directory,int binFactorList[],double lowPercentile,
+			       double highPercentile) throws CCDLibraryNativeException
+	{
+		CCD_Preview_Set_Config(enable,directory,binFactorList,lowPercentile,highPercentile);
+	}
+
+	/**
+	 * Routine to parse a comma separated list of preview binning factors, to pass into <b>setPreview</b>.
+	 * @param s The string to parse, i.e. "8,32".
+	 * @return A list of binning factors.
+	 * @exception CCDLibraryFormatException If a binning factor is not an integer an exception is thrown.
+	 * @see #setPreview
+	 */
+	public static int[] previewBinFactorListFromString(String s) throws CCDLibraryFormatException
+	{
+		String binFactorStringList[] = null;
+		int binFactorList[] = null;
+
+		binFactorStringList = s.split(",");
+		binFactorList = new int[binFactorStringList.length];
+		for(int i = 0; i < binFactorStringList.length; i++)
+		{
+			try
+			{
+				binFactorList[i] = Integer.parseInt(binFactorStringList[i].trim());
+			}
+			catch(NumberFormatException e)
+			{
+				throw new CCDLibraryFormatException("ngat.o.ccd.CCDLibrary",
+								    "previewBinFactorListFromString",s);
+			}
+		}
+		return binFactorList;
+	}
+
+// ccd_timing.h
+	/**
+	 * Method to get a percentile of the durations of an exposure phase, over the successful exposures taken
+	 * with a configuration (or all configurations).
+	 * @param configIndex The configuration index, from 0 to TIMING_MAX_CONFIG_COUNT-1, or TIMING_CONFIG_ALL.
+	 * @param phase The phase, one of the TIMING_PHASE_* constants.
+	 * @param percentile The percentile, from 0 to 100 (i.e. 50 for the median, 100 for the maximum).
+	 * @return The duration, in seconds, or 0.0 if the phase has not been timed.
+	 * @exception CCDLibraryNativeException This method throws a CCDLibraryNativeException if it failed.
+	 * @see #CCD_Timing_Percentile_Get
+	 * @see #TIMING_CONFIG_ALL
+	 * @see #TIMING_MAX_CONFIG_COUNT
+	 */
+	public double getExposureTimingPercentile(int configIndex,int phase,double percentile) 
+		throws CCDLibraryNativeException
+	{
+		return CCD_Timing_Percentile_Get(configIndex,phase,percentile);
+	}
+
+	/**
+	 * Method to get the number of durations of an exposure phase the percentiles are computed from.
+	 * @param configIndex The configuration index, from 0 to TIMING_MAX_CONFIG_COUNT-1, or TIMING_CONFIG_ALL.
+	 * @param phase The phase, one of the TIMING_PHASE_* constants.
+	 * @return The number of durations.
+	 * @exception CCDLibraryNativeException This method throws a CCDLibraryNativeException if it failed.
+	 * @see #CCD_Timing_Count_Get
+	 */
+	public int getExposureTimingCount(int configIndex,int phase) throws CCDLibraryNativeException
+	{
+		return CCD_Timing_Count_Get(configIndex,phase);
+	}
+
+	/**
+	 * Method to get a timed exposure configuration.
+	 * @param configIndex The configuration index, from 0 to TIMING_MAX_CONFIG_COUNT-1.
+	 * @return An array of 5 ints: whether the configuration is in use (0 or 1), the serial binning,
+	 *         the parallel binning, the amplifier (see dspAmplifierToString) and whether windowed (0 or 1).
+	 * @exception CCDLibraryNativeException This method throws a CCDLibraryNativeException if it failed.
+	 * @see #CCD_Timing_Config_Get
+	 * @see #dspAmplifierToString
+	 */
+	public int[] getExposureTimingConfig(int configIndex) throws CCDLibraryNativeException
+	{
+		return CCD_Timing_Config_Get(configIndex);
+	}
+
+	/**
+	 * Method to get the name of an exposure phase.
+	 * @param phase The phase, one of the TIMING_PHASE_* constants.
+	 * @return The name of the phase, i.e. "Readout", or null if the phase is not legal.
+	 * @see #CCD_Timing_Phase_Name_Get
+	 */
+	public String getExposureTimingPhaseName(int phase)
+	{
+		return CCD_Timing_Phase_Name_Get(phase);
+	}
+
+	/**
+	 * Method to clear the exposure phase histograms.
+	 * @exception CCDLibraryNativeException This method throws a CCDLibraryNativeException if it failed.
+	 * @see #CCD_Timing_Reset
+	 */
+	public void resetExposureTiming() throws CCDLibraryNativeException
+	{
+		CCD_Timing_Reset();
+	}
+
+// ccd_trace.h
+	/**
+	 * Method to turn tracing of the requests sent to the controller on or off. Tracing is on by default.
+	 * @param enable Whether to trace controller requests.
+	 * @see #CCD_Trace_Set_Enable
+	 */
+	public void setControllerTraceEnable(boolean enable)
+	{
+		CCD_Trace_Set_Enable(enable);
+	}
+
+	/**
+	 * Method to get whether the requests sent to the controller are being traced.
+	 * @return True if controller requests are being traced.
+	 * @see #CCD_Trace_Get_Enable
+	 */
+	public boolean getControllerTraceEnable()
+	{
+		return CCD_Trace_Get_Enable();
+	}
+
+	/**
+	 * Method to write the controller request trace to a file: the latency counters for each request and
+	 * DSP command, followed by the last requests sent by each thread.
+	 * @param filename The file to write the trace to. This is overwritten.
+	 * @exception CCDLibraryNativeException This method throws a CCDLibraryNativeException if it failed.
+	 * @see #CCD_Trace_Dump
+	 */
+	public void dumpControllerTrace(String filename) throws CCDLibraryNativeException
+	{
+		CCD_Trace_Dump(filename);
+	}
+
+	/**
+	 * Method to get the controller request latency counters, one line per request and DSP command
+	 * (the same as the start of the dumpControllerTrace output). Unlike dumpControllerTrace, no file is written.
+	 * @return The latency counters, with a column heading line first.
+	 * @exception CCDLibraryNativeException This method throws a CCDLibraryNativeException if it failed.
+	 * @see #CCD_Trace_Counters_Get
+	 */
+	public String getControllerTraceCounters() throws CCDLibraryNativeException
+	{
+		return CCD_Trace_Counters_Get();
+	}
+
+	/**
+	 * Method to clear the controller request latency counters and trace.
+	 * @exception CCDLibraryNativeException This method throws a CCDLibraryNativeException if it failed.
+	 * @see #CCD_Trace_Reset
+	 */
+	public void resetControllerTrace() throws CCDLibraryNativeException
+	{
+		CCD_Trace_Reset();
+	}
+
+// ccd_frame_view.h
+	/**
+	 * Method to turn frame viewing on or off. When it is on, the latest de-interlaced frame is kept in memory
+	 * after it is saved, for acquireFrame, and the raw readout buffer can be copied with getRawFrame.
+	 * It is off by default, as retaining frames holds on to a frame's worth of memory (or more, whilst
+	 * acquired frames are not released).
+	 * @param enable Whether to retain read out frames in memory.
+	 * @see #CCD_Frame_View_Set_Enable
+	 * @see #acquireFrame
+	 * @see #getRawFrame
+	 */
+	public void setFrameViewEnable(boolean enable)
+	{
+		CCD_Frame_View_Set_Enable(enable);
+	}
+
+	/**
+	 * Method to get whether frame viewing is on.
+	 * @return true if read out frames are being retained in memory.
+	 * @see #CCD_Frame_View_Get_Enable
+	 */
+	public boolean getFrameViewEnable()
+	{
+		return CCD_Frame_View_Get_Enable();
+	}
+
+	/**
+	 * Method to acquire a view of the latest de-interlaced frame (the first window for windowed readouts),
+	 * without copying it's pixels or re-reading the FITS file. The frame stays in memory until it is released
+	 * with releaseFrame, which must be called when the frame is no longer needed.
+	 * @return An instance of CCDLibraryFrame, with a direct ByteBuffer over the frame's pixels.
+	 * @exception CCDLibraryNativeException This method throws a CCDLibraryNativeException if it failed,
+	 *            frame viewing is not enabled, or no frame has been read out.
+	 * @see #setFrameViewEnable
+	 * @see #releaseFrame
+	 * @see #CCD_Frame_View_Acquire
+	 * @see CCDLibraryFrame
+	 */
+	public CCDLibraryFrame acquireFrame() throws CCDLibraryNativeException
+	{
+		return CCD_Frame_View_Acquire();
+	}
+
+	/**
+	 * Method to release a frame returned by acquireFrame. The frame's pixels must not be used after this.
+	 * Releasing a raw frame (or a frame that has already been released) does nothing.
+	 * @param frame The frame to release.
+	 * @exception CCDLibraryNativeException This method throws a CCDLibraryNativeException if it failed.
+	 * @see #acquireFrame
+	 * @see #CCD_Frame_View_Release
+	 * @see CCDLibraryFrame#setReleased
+	 */
+	public void releaseFrame(CCDLibraryFrame frame) throws CCDLibraryNativeException
+	{
+		if(frame.isRaw()||frame.isReleased())
+			return;
+		frame.setReleased();
+		CCD_Frame_View_Release(frame.getSequence());
+	}
+
+	/**
+	 * Method to get a copy of the raw (not de-interlaced) readout buffer of the last readout. The readout buffer
+	 * is overwritten by the next exposure, and unmapped or remapped by setupShutdown, setup and
+	 * interfaceMemoryMap, so it can't safely be viewed in place from Java. Instead, the pixels are copied
+	 * by the C layer with the readout buffer locked, and this method fails if the readout buffer was
+	 * overwritten or invalidated (i.e. an exposure started) before the copy was made.
+	 * @return An instance of CCDLibraryFrame, with a ByteBuffer holding a copy of the raw readout buffer.
+	 * @exception CCDLibraryNativeException This method throws a CCDLibraryNativeException if it failed,
+	 *            frame viewing is not enabled, the readout buffer does not hold a complete readout, or the
+	 *            readout buffer changed whilst it was being copied.
+	 * @see #setFrameViewEnable
+	 * @see #isFrameValid
+	 * @see #CCD_Frame_View_Raw_Get
+	 * @see CCDLibraryFrame
+	 */
+	public CCDLibraryFrame getRawFrame() throws CCDLibraryNativeException
+	{
+		return CCD_Frame_View_Raw_Get();
+	}
+
+	/**
+	 * Method to check whether a frame's pixels can still be used. A de-interlaced frame is valid until it is
+	 * released. A raw frame is a copy, so it's pixels can always be read, but this returns whether it is
+	 * still a copy of the last readout (the next exposure has not started).
+	 * @param frame The frame to check.
+	 * @return true if the frame's pixels are still valid.
+	 * @see #CCD_Frame_View_Raw_Sequence_Get
+	 */
+	public boolean isFrameValid(CCDLibraryFrame frame)
+	{
+		if(frame.isRaw())
+			return (frame.getSequence() == CCD_Frame_View_Raw_Sequence_Get());
+		return !frame.isReleased();
+	}
+
+// ccd_exposure_event.h
+	/**
+	 * Routine to start an exposure, without waiting for it to finish. The exposure is performed by a new
+	 * thread, which calls expose. Phase changes and readout progress are delivered to the listener by the
+	 * exposure event thread, which fetches the events from the C layer in batches, so neither thread polls the
+	 * exposure status. Only one asynchronous exposure can be in progress at once.
+	 * <ul>
+	 * <li>Any exposure events left over from previous exposures are flushed.
+	 * <li>A new CCDLibraryExposure is created, and becomes the current asynchronous exposure.
+	 * <li>The exposure event thread is started, if it is not already running.
+	 * <li>An AsyncExposureThread is started to do the exposure.
+	 * </ul>
+	 * @param openShutter Determines whether the shutter should be opened to do the exposure.
+	 * @param startTime The start time, in milliseconds since the epoch (1st January 1970) to start the exposure.
+	 * 	Passing the value -1 will start the exposure as soon as possible.
+	 * @param exposureTime The number of milliseconds to expose the CCD.
+	 * @param filenameList A list of filename strings (one per window) to save the exposure into.
+	 * @param listener The listener to deliver exposure events to, or null.
+	 * @return The CCDLibraryExposure, a Future that completes when the exposure has finished.
+	 * @exception CCDLibraryNativeException Thrown if an asynchronous exposure is already in progress.
+	 * @see #expose
+	 * @see #asyncExposure
+	 * @see #CCD_Exposure_Event_Flush
+	 * @see ExposureEventThread
+	 * @see AsyncExposureThread
+	 * @see CCDLibraryExposure
+	 * @see CCDLibraryExposureListener
+	 */
+	public CCDLibraryExposure exposeAsync(boolean openShutter,long startTime,int exposureTime,List filenameList,
+					      CCDLibraryExposureListener listener) throws CCDLibraryNativeException
+	{
+		AsyncExposureThread exposureThread = null;
+		CCDLibraryExposure exposure = null;
+
+		synchronized(asyncExposureLock)
+		{
+			if((asyncExposure != null)&&(asyncExposure.isDone() == false))
+			{
+				throw new CCDLibraryNativeException(this.getClass().getName()+
+					":exposeAsync:Asynchronous exposure "+asyncExposure.getId()+" already in progress.");
+			}
+			CCD_Exposure_Event_Flush();
+			asyncExposureId++;
+			exposure = new CCDLibraryExposure(asyncExposureId,filenameList,listener);
+			asyncExposure = exposure;
+			if(exposureEventThread == null)
+			{
+				exposureEventThread = new ExposureEventThread();
+				exposureEventThread.start();
+			}
+		}
+		exposureThread = new AsyncExposureThread(exposure,openShutter,startTime,exposureTime);
+		exposureThread.start();
+		return exposure;
+	}
+
+	/**
+	 * Routine to start an exposure, without waiting for it to finish.
+	 * @param openShutter Determines whether the shutter should be opened to do the exposure.
+	 * @param startTime The start time, in milliseconds since the epoch (1st January 1970) to start the exposure.
+	 * 	Passing the value -1 will start the exposure as soon as possible.
+	 * @param exposureTime The number of milliseconds to expose the CCD.
+	 * @param filename The filename to save the exposure into.
+	 * @param listener The listener to deliver exposure events to, or null.
+	 * @return The CCDLibraryExposure, a Future that completes when the exposure has finished.
+	 * @exception CCDLibraryNativeException Thrown if an asynchronous exposure is already in progress.
+	 * @see #exposeAsync(boolean,long,int,java.util.List,ngat.o.ccd.CCDLibraryExposureListener)
+	 */
+	public CCDLibraryExposure exposeAsync(boolean openShutter,long startTime,int exposureTime,String filename,
+					      CCDLibraryExposureListener listener) throws CCDLibraryNativeException
+	{
+		List filenameList = null;
+
+		filenameList = new Vector();
+		filenameList.add(filename);
+		return exposeAsync(openShutter,startTime,exposureTime,filenameList,listener);
+	}
+
+	/**
+	 * Get the current (or last) asynchronous exposure.
+	 * @return The exposure, or null if exposeAsync has not been called.
+	 * @see #asyncExposure
+	 */
+	public CCDLibraryExposure getAsyncExposure()
+	{
+		synchronized(asyncExposureLock)
+		{
+			return asyncExposure;
+		}
+	}
+
+	/**
+	 * Get the number of exposure events the C layer has dropped, because the exposure event thread
+	 * did not keep up.
+	 * @return The number of dropped events.
+	 * @see #CCD_Exposure_Event_Get_Dropped_Count
+	 */
+	public int getExposureEventDroppedCount()
+	{
+		return CCD_Exposure_Event_Get_Dropped_Count();
+	}
+
+// ccd_status.h
+	/**
+	 * Method to get a snapshot of the library's status in one native call: the exposure status, length and start
+	 * time, the setup dimensions, binning and window flags, and optionally the elapsed exposure time,
+	 * temperatures and supply voltages. The temperatures and supply voltages come from the telemetry sampler's 
+	 * snapshot if it is running, otherwise they are read from the controller.
+	 * Controller read failures do not cause an exception: check the relevant valid flag in the status object.
+	 * @param status A CCDLibraryStatus instance to fill in. This can be re-used between calls.
+	 * @param flags Which controller values to get, a bit mask of CCDLibraryStatus.FLAG_ELAPSED_EXPOSURE_TIME,
+	 *        CCDLibraryStatus.FLAG_TEMPERATURE and CCDLibraryStatus.FLAG_SUPPLY_VOLTAGE.
+	 * @exception CCDLibraryNativeException This method throws a CCDLibraryNativeException if it failed.
+	 * @see #CCD_Status_Get
+	 * @see CCDLibraryStatus
+	 */
+	public void getStatus(CCDLibraryStatus status,int flags) throws CCDLibraryNativeException
+	{
+		CCD_Status_Get(status,flags);
+	}
+
+	/**
+	 * Returns the current error number from this module of the library. A zero means there is no error.
+	 * @return Returns an error number.
+	 * @see #CCD_Status_Get_Error_Number
+	 */
+	public int getStatusErrorNumber()
+	{
+		return CCD_Status_Get_Error_Number();
+	}
+
+// ccd_source_find.h
+	/**
+	 * Method to configure the source finder.
+	 * @param thresholdSigma How many background standard deviations above the background a pixel must be
+	 *        to be part of an object.
+	 * @param minPixelCount The minimum number of connected pixels an object must have.
+	 * @param threadCount The number of threads (row bands) to split each frame into.
+	 * @exception CCDLibraryNativeException This method throws a CCDLibraryNativeException if it failed.
+	 * @see #CCD_Source_Find_Set_Config
+	 */
+	public void setSourceFindConfig(double thresholdSigma,int minPixelCount,int threadCount) 
+		throws CCDLibraryNativeException
+	{
+		CCD_Source_Find_Set_Config(thresholdSigma,minPixelCount,threadCount);
+	}
+
+	/**
+	 * Method to turn the source finder on or off. Whilst it is on, the source finder is run on each full frame
+	 * after it has been read out and de-interlaced, before it is saved to disk. Turning it on discards
+	 * any previous result.
+	 * @param enable true to turn the source finder on, false to turn it off.
+	 * @exception CCDLibraryNativeException This method throws a CCDLibraryNativeException if it failed.
+	 * @see #getSourceFindResult
+	 * @see #CCD_Source_Find_Set_Enable
+	 */
+	public void setSourceFindEnable(boolean enable) throws CCDLibraryNativeException
+	{
+		CCD_Source_Find_Set_Enable(enable);
+	}
+
+	/**
+	 * Method to get the source finder result for the last frame read out whilst the source finder was on.
+	 * @return An instance of CCDLibrarySourceFindResult.
+	 * @exception CCDLibraryNativeException This method throws a CCDLibraryNativeException if it failed,
+	 *            or no frame has been read out since the source finder was turned on.
+	 * @see #setSourceFindEnable
+	 * @see #CCD_Source_Find_Get_Last_Result
+	 * @see CCDLibrarySourceFindResult
+	 */
+	public CCDLibrarySourceFindResult getSourceFindResult() throws CCDLibraryNativeException
+	{
+		return CCD_Source_Find_Get_Last_Result();
+	}
+
+// ccd_seeing.h
+	/**
+	 * Method to configure the seeing estimator.
+	 * @param thresholdSigma How many background standard deviations above the background a pixel must be
+	 *        to be a candidate source's peak.
+	 * @param cutoutRadius The radius of the square cutout measured around each source, in binned pixels.
+	 *        This should be at least twice the largest expected FWHM.
+	 * @param saturationCounts Sources with a pixel at or above this value in their cutout are not measured.
+	 * @param maxSourceCount The maximum number of sources measured in each frame.
+	 * @param threadCount The number of threads to split each frame across.
+	 * @exception CCDLibraryNativeException This method throws a CCDLibraryNativeException if it failed.
+	 * @see #CCD_Seeing_Set_Config
+	 */
+	public void setSeeingConfig(double thresholdSigma,int cutoutRadius,int saturationCounts,int maxSourceCount,
+				    int threadCount) throws CCDLibraryNativeException
+	{
+		CCD_Seeing_Set_Config(thresholdSigma,cutoutRadius,saturationCounts,maxSourceCount,threadCount);
+	}
+
+	/**
+	 * Method to turn the seeing estimator on or off. Whilst it is on, the seeing estimator is run on each frame
+	 * after it has been read out and de-interlaced, before it is saved to disk. Turning it on discards
+	 * any previous result.
+	 * @param enable true to turn the seeing estimator on, false to turn it off.
+	 * @exception CCDLibraryNativeException This method throws a CCDLibraryNativeException if it failed.
+	 * @see #getSeeingResult
+	 * @see #CCD_Seeing_Set_Enable
+	 */
+	public void setSeeingEnable(boolean enable) throws CCDLibraryNativeException
+	{
+		CCD_Seeing_Set_Enable(enable);
+	}
+
+	/**
+	 * Method to get the seeing estimator result for the last frame read out whilst the seeing estimator was on.
+	 * @return An instance of CCDLibrarySeeingResult.
+	 * @exception CCDLibraryNativeException This method throws a CCDLibraryNativeException if it failed,
+	 *            or no frame has been read out since the seeing estimator was turned on.
+	 * @see #setSeeingEnable
+	 * @see #CCD_Seeing_Get_Last_Result
+	 * @see CCDLibrarySeeingResult
+	 */
+	public CCDLibrarySeeingResult getSeeingResult() throws CCDLibraryNativeException
+	{
+		return CCD_Seeing_Get_Last_Result();
+	}
+
+// ccd_readout_watchdog.h
+	/**
+	 * Method to configure the readout progress-rate watchdog, which learns the pixel rate of each readout
+	 * setup and aborts a readout that stops making progress.
+	 * @param pollPeriod How long to sleep between readout progress polls once the readout is about to start,
+	 *        in milliseconds (1 to 1000).
+	 * @param stallFactor How many learnt progress gaps without progress is a stall (at least 1.0).
+	 * @param minStallTime The shortest stall time for a readout setup that has been seen before, in milliseconds.
+	 * @param unknownStallTime The stall time for a readout setup that has not been seen before, or before
+	 *        the first pixel has arrived, in milliseconds.
+	 * @param slowRatio A readout slower than this fraction of the learnt pixel rate is recorded as a
+	 *        telemetry anomaly (0.0 to 1.0).
+	 * @exception CCDLibraryNativeException This method throws a CCDLibraryNativeException if it failed.
+	 * @see #CCD_Readout_Watchdog_Set_Config
+	 */
+	public void setReadoutWatchdogConfig(int pollPeriod,double stallFactor,int minStallTime,int unknownStallTime,
+					     double slowRatio) throws CCDLibraryNativeException
+	{
+		CCD_Readout_Watchdog_Set_Config(pollPeriod,stallFactor,minStallTime,unknownStallTime,slowRatio);
+	}
+
+// ccd_telemetry.h
+	/**
+	 * Method to start the telemetry sampler thread. This periodically reads the CCD temperature, heater ADUs and
+	 * supply voltage ADUs from the controller, when no exposure is in progress, and caches the results.
+	 * The interface must be open, and telemetryStop must be called before the interface is closed.
+	 * @param periodMs The period between samples, in milliseconds.
+	 * @exception CCDLibraryNativeException This method throws a CCDLibraryNativeException if it failed.
+	 * @see #telemetryStop
+	 * @see #getTelemetry
+	 * @see #CCD_Telemetry_Start
+	 */
+	public void telemetryStart(int periodMs) throws CCDLibraryNativeException
+	{
+		CCD_Telemetry_Start(periodMs);
+	}
+
+	/**
+	 * Method to stop the telemetry sampler thread. It is not an error to call this if the sampler is not running.
+	 * @exception CCDLibraryNativeException This method throws a CCDLibraryNativeException if it failed.
+	 * @see #telemetryStart
+	 * @see #CCD_Telemetry_Stop
+	 */
+	public void telemetryStop() throws CCDLibraryNativeException
+	{
+		CCD_Telemetry_Stop();
+	}
+
+	/**
+	 * Method to get the latest telemetry snapshot taken by the sampler thread. This does not talk to the 
+	 * controller, so can be called at any time, including during an exposure.
+	 * @return An instance of CCDLibraryTelemetry containing the snapshot.
+	 * @exception CCDLibraryNativeException This method throws a CCDLibraryNativeException if it failed.
+	 * @see #telemetryStart
+	 * @see #CCD_Telemetry_Get
+	 * @see CCDLibraryTelemetry
+	 */
+	public CCDLibraryTelemetry getTelemetry() throws CCDLibraryNativeException
+	{
+		return CCD_Telemetry_Get();
+	}
+
+// ccd_telemetry_store.h
+	/**
+	 * Method to open the telemetry store ring file. Whilst the store is open, the telemetry sampler thread 
+	 * records every sample and exposure/filter wheel status transition in it. The file is created if it
+	 * does not exist, and re-initialised if it was created with a different record count.
+	 * The store should be opened before telemetryStart is called, and closed after telemetryStop.
+	 * @param filename The filename of the store.
+	 * @param recordCount The number of records in the ring.
+	 * @exception CCDLibraryNativeException This method throws a CCDLibraryNativeException if it failed.
+	 * @see #telemetryStart
+	 * @see #telemetryStoreClose
+	 * @see #CCD_Telemetry_Store_Open
+	 */
+	public void telemetryStoreOpen(String filename,int recordCount) throws CCDLibraryNativeException
+	{
+		CCD_Telemetry_Store_Open(filename,recordCount);
+	}
+
+	/**
+	 * Method to close the telemetry store ring file. It is not an error to call this if the store is not open.
+	 * @exception CCDLibraryNativeException This method throws a CCDLibraryNativeException if it failed.
+	 * @see #telemetryStop
+	 * @see #telemetryStoreOpen
+	 * @see #CCD_Telemetry_Store_Close
+	 */
+	public void telemetryStoreClose() throws CCDLibraryNativeException
+	{
+		CCD_Telemetry_Store_Close();
+	}
+
 // ccd_temperature.h
 	/**
 	 * Routine to get the current CCD temperature.
@@ -1788,6 +3147,215 @@ public class CCDLibrary
 
 		throw new CCDLibraryFormatException("ngat.o.ccd.CCDLibrary","textPrintLevelFromString",s);
 	}
+
+	/**
+	 * Thread that performs an asynchronous exposure, by calling expose. Once expose has returned (or thrown
+	 * anything at all), any exception is stored in the CCDLibraryExposure, and a complete event is posted to the
+	 * C layer's exposure event queue, so the exposure is only completed after all it's events have been delivered.
+	 * @see #exposeAsync
+	 */
+	protected class AsyncExposureThread extends Thread
+	{
+		/**
+		 * The exposure being performed.
+		 */
+		protected CCDLibraryExposure exposure = null;
+		/**
+		 * Whether to open the shutter.
+		 */
+		protected boolean openShutter = true;
+		/**
+		 * The start time, in milliseconds since the epoch, or -1.
+		 */
+		protected long startTime = -1L;
+		/**
+		 * The exposure length, in milliseconds.
+		 */
+		protected int exposureTime = 0;
+
+		/**
+		 * Constructor.
+		 * @param e The exposure to perform.
+		 * @param os Whether to open the shutter.
+		 * @param st The start time, in milliseconds since the epoch, or -1.
+		 * @param et The exposure length, in milliseconds.
+		 */
+		public AsyncExposureThread(CCDLibraryExposure e,boolean os,long st,int et)
+		{
+			super("CCDLibrary.AsyncExposureThread:"+e.getId());
+			setDaemon(true);
+			exposure = e;
+			openShutter = os;
+			startTime = st;
+			exposureTime = et;
+		}
+
+		/**
+		 * Perform the exposure, and post the complete event. The complete event is posted in a finally block,
+		 * so the exposure is completed whatever expose throws (i.e. a RuntimeException or Error as well as a
+		 * CCDLibraryNativeException), otherwise the Future would never complete.
+		 * @see CCDLibrary#expose
+		 * @see CCDLibrary#CCD_Exposure_Event_Post_Complete
+		 */
+		public void run()
+		{
+			try
+			{
+				expose(openShutter,startTime,exposureTime,exposure.getFilenameList());
+			}
+			catch(Throwable t)
+			{
+				exposure.setException(t);
+			}
+			finally
+			{
+				CCD_Exposure_Event_Post_Complete(exposure.getId());
+			}
+		}
+	}
+
+	/**
+	 * Thread that fetches exposure events from the C layer in batches, and delivers them to the current
+	 * asynchronous exposure. It runs until the JVM exits. A failure to fetch events is logged, and fetching
+	 * is retried. If the thread stops anyway (an Error is thrown), it is cleared so the next exposeAsync starts
+	 * a new one, and the current asynchronous exposure is failed, as it's complete event will never be delivered.
+	 * @see #exposeAsync
+	 * @see #CCD_Exposure_Event_Wait
+	 */
+	protected class ExposureEventThread extends Thread
+	{
+		/**
+		 * How long to wait for events in each call to CCD_Exposure_Event_Wait, in milliseconds.
+		 */
+		public final static int WAIT_TIMEOUT = 1000;
+		/**
+		 * How long to sleep after CCD_Exposure_Event_Wait fails, before calling it again, in milliseconds.
+		 */
+		public final static int RETRY_SLEEP_TIME = 1000;
+
+		/**
+		 * Constructor.
+		 */
+		public ExposureEventThread()
+		{
+			super("CCDLibrary.ExposureEventThread");
+			setDaemon(true);
+		}
+
+		/**
+		 * Wait for batches of events, and deliver each one to the current asynchronous exposure.
+		 * Phase and readout progress events are passed to CCDLibraryExposure.deliverEvent. A complete event
+		 * completes the exposure, if it's identifier matches. Events arriving when there is no current
+		 * asynchronous exposure (i.e. from synchronous exposures) are discarded.
+		 * If waiting for events fails, the failure is logged, and the wait is retried after RETRY_SLEEP_TIME.
+		 * If anything else stops the thread, the thread is cleared and the current asynchronous exposure failed.
+		 * @see #WAIT_TIMEOUT
+		 * @see #RETRY_SLEEP_TIME
+		 * @see #deliverEvents
+		 * @see #stopped
+		 * @see CCDLibrary#CCD_Exposure_Event_Wait
+		 */
+		public void run()
+		{
+			CCDLibraryExposureEvent eventList[] = null;
+
+			try
+			{
+				while(true)
+				{
+					try
+					{
+						eventList = CCD_Exposure_Event_Wait(WAIT_TIMEOUT);
+					}
+					catch(CCDLibraryNativeException e)
+					{
+						logger.log(Logging.VERBOSITY_TERSE,this.getClass().getName()+
+							   ":run:Waiting for exposure events failed, retrying:"+e);
+						try
+						{
+							Thread.sleep(RETRY_SLEEP_TIME);
+						}
+						catch(InterruptedException ie)
+						{
+						}
+						continue;
+					}
+					deliverEvents(eventList);
+				}
+			}
+			catch(Throwable t)
+			{
+				logger.log(Logging.VERBOSITY_TERSE,this.getClass().getName()+
+					   ":run:Exposure event thread stopped:"+t);
+				stopped(t);
+			}
+		}
+
+		/**
+		 * Deliver a batch of events to the current asynchronous exposure.
+		 * @param eventList The batch of events.
+		 * @see CCDLibrary#asyncExposure
+		 * @see CCDLibraryExposure#deliverEvent
+		 * @see CCDLibraryExposure#setDone
+		 */
+		protected void deliverEvents(CCDLibraryExposureEvent eventList[])
+		{
+			CCDLibraryExposure exposure = null;
+
+			for(int i = 0; i < eventList.length; i++)
+			{
+				synchronized(asyncExposureLock)
+				{
+					exposure = asyncExposure;
+				}
+				if((exposure == null)||exposure.isDone())
+					continue;
+				if(eventList[i].getType() == CCDLibraryExposureEvent.TYPE_COMPLETE)
+				{
+					if(eventList[i].getId() == exposure.getId())
+						exposure.setDone();
+					continue;
+				}
+				try
+				{
+					exposure.deliverEvent(eventList[i]);
+				}
+				catch(Exception e)
+				{
+					logger.log(Logging.VERBOSITY_TERSE,this.getClass().getName()+
+						   ":deliverEvents:Exposure listener failed:"+e);
+				}
+			}
+		}
+
+		/**
+		 * Called when the thread is stopping. The thread is cleared (under asyncExposureLock), so the next
+		 * call to exposeAsync starts a new one, and the current asynchronous exposure (if it has not completed)
+		 * is failed with the throwable that stopped the thread, as nothing will deliver it's complete event.
+		 * @param t The throwable that stopped the thread.
+		 * @see CCDLibrary#exposureEventThread
+		 * @see CCDLibrary#asyncExposure
+		 * @see CCDLibraryExposure#setException
+		 * @see CCDLibraryExposure#setDone
+		 */
+		protected void stopped(Throwable t)
+		{
+			CCDLibraryExposure exposure = null;
+
+			synchronized(asyncExposureLock)
+			{
+				if(exposureEventThread == this)
+					exposureEventThread = null;
+				exposure = asyncExposure;
+			}
+			if((exposure != null)&&(exposure.isDone() == false))
+			{
+				exposure.setException(t);
+				exposure.setDone();
+			}
+		}
+	}
+
 }
  
 //
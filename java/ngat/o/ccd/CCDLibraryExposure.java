@@ -0,0 +1,278 @@
+// CCDLibraryExposure.java
+// $Header$
+package ngat.o.ccd;
+
+import java.util.List;
+import java.util.concurrent.ExecutionException;
+import java.util.concurrent.Future;
+import java.util.concurrent.TimeUnit;
+import java.util.concurrent.TimeoutException;
+
+/**
+ * This class is the handle to an asynchronous exposure, returned by CCDLibrary.exposeAsync. It is a Future,
+ * which completes once the exposure has been read out and saved (or has failed), and after every phase and
+ * readout progress event for the exposure has been delivered to the listener. get returns the list of
+ * filenames saved, or throws an ExecutionException wrapping the exception the exposure failed with (normally a
+ * CCDLibraryNativeException).
+ * The latest exposure status and readout progress are also kept, so the handle can be queried without a listener.
+ * The exposure cannot be cancelled through the Future interface, use CCDLibrary.abort instead.
+ * @author Chris Mottram
+ * @version $Revision$
+ * @see CCDLibrary#exposeAsync
+ * @see CCDLibrary#abort
+ * @see CCDLibraryExposureListener
+ */
+public class CCDLibraryExposure implements Future
+{
+	/**
+	 * Revision Control System id string, showing the version of the Class
+	 */
+	public final static String RCSID = new String("$Id$");
+	/**
+	 * The identifier of this exposure, used to match the complete event posted by the C layer.
+	 */
+	private int id = 0;
+	/**
+	 * The list of filenames the exposure is saved into.
+	 */
+	private List filenameList = null;
+	/**
+	 * The listener to deliver events to, or null.
+	 */
+	private CCDLibraryExposureListener listener = null;
+	/**
+	 * The exposure status in the last phase event, one of the CCDLibrary.EXPOSURE_STATUS_* values.
+	 */
+	private int exposureStatus = CCDLibrary.EXPOSURE_STATUS_NONE;
+	/**
+	 * The number of pixels read out, in the last readout progress event.
+	 */
+	private int pixelCount = 0;
+	/**
+	 * The number of pixels in the readout, in the last readout progress event.
+	 */
+	private int expectedPixelCount = 0;
+	/**
+	 * Whether the exposure has completed.
+	 */
+	private boolean done = false;
+	/**
+	 * The exception the exposure failed with (normally a CCDLibraryNativeException), or null if it succeeded.
+	 */
+	private Throwable exception = null;
+
+	/**
+	 * Constructor. Called by CCDLibrary.exposeAsync.
+	 * @param i The identifier of the exposure.
+	 * @param l The list of filenames the exposure is saved into.
+	 * @param el The listener to deliver events to, or null.
+	 */
+	public CCDLibraryExposure(int i,List l,CCDLibraryExposureListener el)
+	{
+		super();
+		id = i;
+		filenameList = l;
+		listener = el;
+	}
+
+	/**
+	 * Get the identifier of this exposure.
+	 * @return The identifier.
+	 */
+	public int getId()
+	{
+		return id;
+	}
+
+	/**
+	 * Get the list of filenames the exposure is saved into.
+	 * @return The list of filename strings.
+	 */
+	public List getFilenameList()
+	{
+		return filenameList;
+	}
+
+	/**
+	 * Get the exposure status in the last phase event delivered.
+	 * @return The exposure status, one of the CCDLibrary.EXPOSURE_STATUS_* values.
+	 */
+	public synchronized int getExposureStatus()
+	{
+		return exposureStatus;
+	}
+
+	/**
+	 * Get the number of pixels read out, in the last readout progress event delivered.
+	 * @return The number of pixels.
+	 */
+	public synchronized int getPixelCount()
+	{
+		return pixelCount;
+	}
+
+	/**
+	 * Get the number of pixels in the readout, in the last readout progress event delivered.
+	 * @return The number of pixels.
+	 */
+	public synchronized int getExpectedPixelCount()
+	{
+		return expectedPixelCount;
+	}
+
+	/**
+	 * Get the exception the exposure failed with.
+	 * @return The exception, or null if the exposure has not completed, or succeeded.
+	 */
+	public synchronized Throwable getException()
+	{
+		return exception;
+	}
+
+	/**
+	 * The exposure cannot be cancelled through this interface, use CCDLibrary.abort.
+	 * @param mayInterruptIfRunning Ignored.
+	 * @return false, always.
+	 * @see CCDLibrary#abort
+	 */
+	public boolean cancel(boolean mayInterruptIfRunning)
+	{
+		return false;
+	}
+
+	/**
+	 * The exposure cannot be cancelled through this interface.
+	 * @return false, always.
+	 */
+	public boolean isCancelled()
+	{
+		return false;
+	}
+
+	/**
+	 * Return whether the exposure has completed.
+	 * @return true if the exposure has completed, successfully or not.
+	 */
+	public synchronized boolean isDone()
+	{
+		return done;
+	}
+
+	/**
+	 * Wait for the exposure to complete.
+	 * @return The list of filenames the exposure was saved into.
+	 * @exception InterruptedException Thrown if the thread was interrupted whilst waiting.
+	 * @exception ExecutionException Thrown if the exposure failed. The cause is the exception it failed with.
+	 * @see #getResult
+	 */
+	public synchronized Object get() throws InterruptedException, ExecutionException
+	{
+		while(done == false)
+			wait();
+		return getResult();
+	}
+
+	/**
+	 * Wait for the exposure to complete, for up to the specified time.
+	 * @param timeout The maximum time to wait.
+	 * @param unit The units of timeout.
+	 * @return The list of filenames the exposure was saved into.
+	 * @exception InterruptedException Thrown if the thread was interrupted whilst waiting.
+	 * @exception ExecutionException Thrown if the exposure failed. The cause is the exception it failed with.
+	 * @exception TimeoutException Thrown if the exposure had not completed before the timeout.
+	 * @see #getResult
+	 */
+	public synchronized Object get(long timeout,TimeUnit unit) throws InterruptedException, ExecutionException,
+									  TimeoutException
+	{
+		long endTime,remainingTime;
+
+		endTime = System.currentTimeMillis()+unit.toMillis(timeout);
+		while(done == false)
+		{
+			remainingTime = endTime-System.currentTimeMillis();
+			if(remainingTime <= 0)
+			{
+				throw new TimeoutException(this.getClass().getName()+":get:Exposure "+id+
+							   " not completed after "+timeout+" "+unit+".");
+			}
+			wait(remainingTime);
+		}
+		return getResult();
+	}
+
+	/**
+	 * Return a string description of the exposure.
+	 * @return The string.
+	 */
+	public synchronized String toString()
+	{
+		return new String(this.getClass().getName()+":id:"+id+":exposureStatus:"+exposureStatus+
+				  ":pixelCount:"+pixelCount+":expectedPixelCount:"+expectedPixelCount+":done:"+done+
+				  ":exception:"+exception);
+	}
+
+	/**
+	 * Deliver an event to this exposure. The latest exposure status or readout progress is updated,
+	 * and the listener (if any) is called, outside the lock. Called from CCDLibrary's exposure event thread.
+	 * @param event The phase or readout progress event.
+	 * @exception Exception Any exception thrown by the listener is passed on.
+	 * @see CCDLibraryExposureListener#exposurePhaseChanged
+	 * @see CCDLibraryExposureListener#exposureReadoutProgress
+	 */
+	protected void deliverEvent(CCDLibraryExposureEvent event) throws Exception
+	{
+		synchronized(this)
+		{
+			exposureStatus = event.getExposureStatus();
+			if(event.getType() == CCDLibraryExposureEvent.TYPE_READOUT_PROGRESS)
+			{
+				pixelCount = event.getPixelCount();
+				expectedPixelCount = event.getExpectedPixelCount();
+			}
+		}
+		if(listener == null)
+			return;
+		if(event.getType() == CCDLibraryExposureEvent.TYPE_PHASE)
+			listener.exposurePhaseChanged(this,event);
+		else if(event.getType() == CCDLibraryExposureEvent.TYPE_READOUT_PROGRESS)
+			listener.exposureReadoutProgress(this,event);
+	}
+
+	/**
+	 * Set the exception the exposure failed with. Called from CCDLibrary's asynchronous exposure thread,
+	 * before the exposure is completed, or from CCDLibrary's exposure event thread if it has to stop
+	 * before the exposure is completed.
+	 * @param e The exception.
+	 */
+	protected synchronized void setException(Throwable e)
+	{
+		exception = e;
+	}
+
+	/**
+	 * Mark the exposure as completed, and wake up any threads waiting in get. Called from CCDLibrary's
+	 * exposure event thread when the complete event for this exposure is received.
+	 */
+	protected synchronized void setDone()
+	{
+		done = true;
+		notifyAll();
+	}
+
+	/**
+	 * Return the result of a completed exposure. Called with the lock held.
+	 * @return The list of filenames the exposure was saved into.
+	 * @exception ExecutionException Thrown if the exposure failed.
+	 */
+	private Object getResult() throws ExecutionException
+	{
+		if(exception != null)
+			throw new ExecutionException(exception);
+		return filenameList;
+	}
+}
+
+//
+// $Log: not supported by cvs2svn $
+//
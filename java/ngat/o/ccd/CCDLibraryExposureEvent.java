@@ -0,0 +1,153 @@
+// CCDLibraryExposureEvent.java
+// $Header$
+package ngat.o.ccd;
+
+/**
+ * This class holds one exposure event, as queued by libo_ccd's ccd_exposure_event module. Events are fetched
+ * from the C layer in batches by CCDLibrary's exposure event thread, and delivered to the
+ * CCDLibraryExposureListener of the current asynchronous exposure.
+ * @author Chris Mottram
+ * @version $Revision$
+ * @see CCDLibrary#exposeAsync
+ * @see CCDLibraryExposureListener
+ */
+public class CCDLibraryExposureEvent
+{
+	/**
+	 * Revision Control System id string, showing the version of the Class
+	 */
+	public final static String RCSID = new String("$Id$");
+	/* These constants should be the same as those in ccd_exposure_event.h */
+	/**
+	 * Event type, the exposure status has changed.
+	 */
+	public final static int TYPE_PHASE = 			0;
+	/**
+	 * Event type, more pixels have been read out.
+	 */
+	public final static int TYPE_READOUT_PROGRESS = 	1;
+	/**
+	 * Event type, an asynchronous exposure has finished.
+	 */
+	public final static int TYPE_COMPLETE = 		2;
+	/**
+	 * The type of event, one of TYPE_PHASE, TYPE_READOUT_PROGRESS or TYPE_COMPLETE.
+	 * @see #TYPE_PHASE
+	 * @see #TYPE_READOUT_PROGRESS
+	 * @see #TYPE_COMPLETE
+	 */
+	private int type = TYPE_PHASE;
+	/**
+	 * When the event was posted, in milliseconds since the epoch (1st January 1970).
+	 */
+	private long timeStamp = 0L;
+	/**
+	 * The exposure status after the event, one of the CCDLibrary.EXPOSURE_STATUS_* values.
+	 */
+	private int exposureStatus = 0;
+	/**
+	 * For readout progress events, the number of pixels read out so far.
+	 */
+	private int pixelCount = 0;
+	/**
+	 * For readout progress events, the number of pixels in the readout.
+	 */
+	private int expectedPixelCount = 0;
+	/**
+	 * For complete events, the identifier of the asynchronous exposure that has finished.
+	 */
+	private int id = 0;
+
+	/**
+	 * Constructor. Called from the JNI layer (CCD_Exposure_Event_Wait).
+	 * @param t The type of event.
+	 * @param ts The time stamp, in milliseconds since the epoch.
+	 * @param s The exposure status.
+	 * @param pc The number of pixels read out so far.
+	 * @param epc The number of pixels in the readout.
+	 * @param i The asynchronous exposure identifier.
+	 */
+	public CCDLibraryExposureEvent(int t,long ts,int s,int pc,int epc,int i)
+	{
+		super();
+		type = t;
+		timeStamp = ts;
+		exposureStatus = s;
+		pixelCount = pc;
+		expectedPixelCount = epc;
+		id = i;
+	}
+
+	/**
+	 * Get the type of event.
+	 * @return The type, one of TYPE_PHASE, TYPE_READOUT_PROGRESS or TYPE_COMPLETE.
+	 * @see #TYPE_PHASE
+	 * @see #TYPE_READOUT_PROGRESS
+	 * @see #TYPE_COMPLETE
+	 */
+	public int getType()
+	{
+		return type;
+	}
+
+	/**
+	 * Get when the event was posted.
+	 * @return The time stamp, in milliseconds since the epoch (1st January 1970).
+	 */
+	public long getTimeStamp()
+	{
+		return timeStamp;
+	}
+
+	/**
+	 * Get the exposure status after the event.
+	 * @return The exposure status, one of the CCDLibrary.EXPOSURE_STATUS_* values.
+	 * @see CCDLibrary#EXPOSURE_STATUS_NONE
+	 */
+	public int getExposureStatus()
+	{
+		return exposureStatus;
+	}
+
+	/**
+	 * Get the number of pixels read out so far.
+	 * @return The number of pixels, for readout progress events.
+	 */
+	public int getPixelCount()
+	{
+		return pixelCount;
+	}
+
+	/**
+	 * Get the number of pixels in the readout.
+	 * @return The number of pixels, for readout progress events.
+	 */
+	public int getExpectedPixelCount()
+	{
+		return expectedPixelCount;
+	}
+
+	/**
+	 * Get the asynchronous exposure identifier.
+	 * @return The identifier, for complete events.
+	 */
+	public int getId()
+	{
+		return id;
+	}
+
+	/**
+	 * Return a string description of the event.
+	 * @return The string.
+	 */
+	public String toString()
+	{
+		return new String(this.getClass().getName()+":type:"+type+":timeStamp:"+timeStamp+
+				  ":exposureStatus:"+exposureStatus+":pixelCount:"+pixelCount+
+				  ":expectedPixelCount:"+expectedPixelCount+":id:"+id);
+	}
+}
+
+//
+// $Log: not supported by cvs2svn $
+//
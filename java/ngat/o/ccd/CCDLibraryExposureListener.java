@@ -0,0 +1,39 @@
+// CCDLibraryExposureListener.java
+// $Header$
+package ngat.o.ccd;
+
+/**
+ * This interface is implemented by classes that want to be told about the progress of an asynchronous exposure,
+ * started with CCDLibrary.exposeAsync. The methods are called from CCDLibrary's exposure event thread, not
+ * the thread that started the exposure, so they should return quickly: whilst a listener method is running,
+ * further events are queued in the C layer (and consecutive readout progress events are merged).
+ * All the events for an exposure are delivered before the exposure's CCDLibraryExposure completes.
+ * @author Chris Mottram
+ * @version $Revision$
+ * @see CCDLibrary#exposeAsync
+ * @see CCDLibraryExposure
+ * @see CCDLibraryExposureEvent
+ */
+public interface CCDLibraryExposureListener
+{
+	/**
+	 * Called when the exposure status changes.
+	 * @param exposure The asynchronous exposure.
+	 * @param event The phase event. Use getExposureStatus to get the new exposure status.
+	 * @see CCDLibraryExposureEvent#getExposureStatus
+	 */
+	public void exposurePhaseChanged(CCDLibraryExposure exposure,CCDLibraryExposureEvent event);
+
+	/**
+	 * Called when more pixels have been read out.
+	 * @param exposure The asynchronous exposure.
+	 * @param event The readout progress event. Use getPixelCount and getExpectedPixelCount to get the progress.
+	 * @see CCDLibraryExposureEvent#getPixelCount
+	 * @see CCDLibraryExposureEvent#getExpectedPixelCount
+	 */
+	public void exposureReadoutProgress(CCDLibraryExposure exposure,CCDLibraryExposureEvent event);
+}
+
+//
+// $Log: not supported by cvs2svn $
+//
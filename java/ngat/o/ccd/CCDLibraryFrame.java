@@ -0,0 +1,232 @@
+// CCDLibraryFrame.java
+// $Header$
+package ngat.o.ccd;
+
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+import java.nio.ShortBuffer;
+
+/**
+ * This class holds a frame's pixels. It is returned by CCDLibrary.acquireFrame (the latest de-interlaced frame)
+ * and CCDLibrary.getRawFrame (the raw readout buffer), which only work whilst frame viewing is enabled
+ * (CCDLibrary.setFrameViewEnable). The pixels are unsigned 16 bit values, in native byte order, stored a row
+ * at a time.
+ * <ul>
+ * <li>A de-interlaced frame is a view of the pixels held in libo_ccd's memory, without copying them.
+ *     It stays in memory until it is released with CCDLibrary.releaseFrame, and must not be
+ *     read after that. Every acquired frame must be released, otherwise it's memory is never freed.
+ * <li>A raw frame is a copy of the controller's readout buffer, which can be overwritten by the next exposure,
+ *     or unmapped by CCDLibrary.setupShutdown, CCDLibrary.setup or CCDLibrary.interfaceMemoryMap, so it is not
+ *     viewed in place. CCDLibrary.isFrameValid returns whether it is still a copy of the last readout.
+ * </ul>
+ * @author Chris Mottram
+ * @version $Revision$
+ * @see CCDLibrary#acquireFrame
+ * @see CCDLibrary#getRawFrame
+ * @see CCDLibrary#releaseFrame
+ * @see CCDLibrary#isFrameValid
+ */
+public class CCDLibraryFrame
+{
+	/**
+	 * Revision Control System id string, showing the version of the Class
+	 */
+	public final static String RCSID = new String("$Id$");
+	/**
+	 * A direct ByteBuffer over the frame's pixels in native memory, or for a raw frame a ByteBuffer holding a
+	 * copy of them.
+	 */
+	private ByteBuffer data = null;
+	/**
+	 * The frame's sequence number (or the raw sequence number, for a raw frame).
+	 */
+	private int sequence = 0;
+	/**
+	 * The number of binned columns in the frame. For a raw frame, this is the number of pixels read out.
+	 */
+	private int ncols = 0;
+	/**
+	 * The number of binned rows in the frame. For a raw frame, this is 1.
+	 */
+	private int nrows = 0;
+	/**
+	 * The serial binning.
+	 */
+	private int xBin = 1;
+	/**
+	 * The parallel binning.
+	 */
+	private int yBin = 1;
+	/**
+	 * 0 for a full frame, or the window number (1..4) of a windowed frame.
+	 */
+	private int windowNumber = 0;
+	/**
+	 * Whether this is a copy of the raw readout buffer.
+	 */
+	private boolean raw = false;
+	/**
+	 * Whether the frame has been released.
+	 */
+	private boolean released = false;
+
+	/**
+	 * Constructor. Called from the JNI layer (CCD_Frame_View_Acquire and CCD_Frame_View_Raw_Get).
+	 * The byte order of the buffer is set to the native byte order.
+	 * @param d A direct ByteBuffer over the pixels, or a ByteBuffer holding a copy of the raw readout buffer.
+	 * @param s The sequence number.
+	 * @param nc The number of columns.
+	 * @param nr The number of rows.
+	 * @param xb The serial binning.
+	 * @param yb The parallel binning.
+	 * @param w The window number.
+	 * @param r Whether this is a copy of the raw readout buffer.
+	 */
+	public CCDLibraryFrame(ByteBuffer d,int s,int nc,int nr,int xb,int yb,int w,boolean r)
+	{
+		super();
+		data = d;
+		data.order(ByteOrder.nativeOrder());
+		sequence = s;
+		ncols = nc;
+		nrows = nr;
+		xBin = xb;
+		yBin = yb;
+		windowNumber = w;
+		raw = r;
+	}
+
+	/**
+	 * Get the pixel data, as a ByteBuffer in native byte order (a direct ByteBuffer for a de-interlaced frame).
+	 * @return The pixel data.
+	 */
+	public ByteBuffer getByteBuffer()
+	{
+		return data;
+	}
+
+	/**
+	 * Get the pixel data, as a ShortBuffer over the same native memory. The values are unsigned, so
+	 * should be masked with 0xffff.
+	 * @return The pixel data.
+	 */
+	public ShortBuffer getShortBuffer()
+	{
+		return data.asShortBuffer();
+	}
+
+	/**
+	 * Get a pixel value.
+	 * @param x The column, from 0 to ncols-1.
+	 * @param y The row, from 0 to nrows-1.
+	 * @return The (unsigned) pixel value.
+	 * @exception IndexOutOfBoundsException Thrown if the pixel is not in the frame.
+	 */
+	public int getPixel(int x,int y) throws IndexOutOfBoundsException
+	{
+		if((x < 0)||(x >= ncols)||(y < 0)||(y >= nrows))
+		{
+			throw new IndexOutOfBoundsException(this.getClass().getName()+":getPixel:Pixel ("+x+","+y+
+							    ") not in frame of size ("+ncols+","+nrows+").");
+		}
+		return ((int)data.getShort(((y*ncols)+x)*2))&0xffff;
+	}
+
+	/**
+	 * Get the frame's sequence number.
+	 * @return The sequence number.
+	 */
+	public int getSequence()
+	{
+		return sequence;
+	}
+
+	/**
+	 * Get the number of binned columns in the frame.
+	 * @return The number of columns.
+	 */
+	public int getNCols()
+	{
+		return ncols;
+	}
+
+	/**
+	 * Get the number of binned rows in the frame.
+	 * @return The number of rows.
+	 */
+	public int getNRows()
+	{
+		return nrows;
+	}
+
+	/**
+	 * Get the serial binning.
+	 * @return The serial binning.
+	 */
+	public int getXBin()
+	{
+		return xBin;
+	}
+
+	/**
+	 * Get the parallel binning.
+	 * @return The parallel binning.
+	 */
+	public int getYBin()
+	{
+		return yBin;
+	}
+
+	/**
+	 * Get the window number.
+	 * @return 0 for a full frame, or the window number (1..4) of a windowed frame.
+	 */
+	public int getWindowNumber()
+	{
+		return windowNumber;
+	}
+
+	/**
+	 * Get whether this is a copy of the raw readout buffer.
+	 * @return true for a raw frame, false for a de-interlaced frame.
+	 */
+	public boolean isRaw()
+	{
+		return raw;
+	}
+
+	/**
+	 * Get whether the frame has been released.
+	 * @return true if the frame has been released.
+	 */
+	public boolean isReleased()
+	{
+		return released;
+	}
+
+	/**
+	 * Mark the frame as released. Called by CCDLibrary.releaseFrame. The buffer is dropped, so
+	 * the released native memory can't be read through this object.
+	 * @see CCDLibrary#releaseFrame
+	 */
+	protected void setReleased()
+	{
+		released = true;
+		data = null;
+	}
+
+	/**
+	 * Return a string description of the frame.
+	 * @return The string.
+	 */
+	public String toString()
+	{
+		return new String(this.getClass().getName()+":sequence:"+sequence+":ncols:"+ncols+":nrows:"+nrows+
+				  ":xBin:"+xBin+":yBin:"+yBin+":window:"+windowNumber+":raw:"+raw+
+				  ":released:"+released);
+	}
+}
+
+//
+// $Log: not supported by cvs2svn $
+//
@@ -0,0 +1,231 @@
+// CCDLibrarySeeingResult.java
+// $Header$
+package ngat.o.ccd;
+
+/**
+ * This class holds the result of running the libo_ccd seeing estimator on the last frame read out.
+ * It is returned by CCDLibrary.getSeeingResult. FWHMs are in binned pixels, multiply by the plate scale
+ * (arcseconds per binned pixel) to get the seeing in arcseconds. For windowed readouts the seeing estimator is run
+ * on the first window.
+ * @author Chris Mottram
+ * @version $Revision$
+ * @see CCDLibrary#getSeeingResult
+ */
+public class CCDLibrarySeeingResult
+{
+	/**
+	 * Revision Control System id string, showing the version of the Class
+	 */
+	public final static String RCSID = new String("$Id$");
+	/**
+	 * The number of binned columns in the frame.
+	 */
+	private int ncols = 0;
+	/**
+	 * The number of binned rows in the frame.
+	 */
+	private int nrows = 0;
+	/**
+	 * The estimated background level, in counts.
+	 */
+	private double background = 0.0;
+	/**
+	 * The estimated standard deviation of the background, in counts.
+	 */
+	private double backgroundSigma = 0.0;
+	/**
+	 * The number of candidate sources (local maxima above the threshold) found.
+	 */
+	private int candidateCount = 0;
+	/**
+	 * The number of unsaturated, isolated sources measured.
+	 */
+	private int sourceCount = 0;
+	/**
+	 * The number of measured sources whose 2D Gaussian fit converged.
+	 */
+	private int fitCount = 0;
+	/**
+	 * The median moment-based FWHM of the measured sources, in binned pixels.
+	 */
+	private double momentFWHM = 0.0;
+	/**
+	 * The median FWHM of the measured sources, in binned pixels.
+	 */
+	private double fwhm = 0.0;
+	/**
+	 * The robust standard deviation of the measured sources' FWHMs, in binned pixels.
+	 */
+	private double fwhmSigma = 0.0;
+	/**
+	 * The median ellipticity (1 - minor/major axis) of the measured sources.
+	 */
+	private double ellipticity = 0.0;
+	/**
+	 * How long the seeing estimator took, in seconds.
+	 */
+	private double elapsedTime = 0.0;
+
+	/**
+	 * Default constructor. No sources have been measured.
+	 */
+	public CCDLibrarySeeingResult()
+	{
+		super();
+	}
+
+	/**
+	 * Constructor. Called from the JNI layer (CCD_Seeing_Get_Last_Result).
+	 * @param nc The number of binned columns in the frame.
+	 * @param nr The number of binned rows in the frame.
+	 * @param b The background level.
+	 * @param bs The background standard deviation.
+	 * @param cc The number of candidate sources.
+	 * @param sc The number of sources measured.
+	 * @param fc The number of sources fitted.
+	 * @param mf The median moment-based FWHM.
+	 * @param f The median FWHM.
+	 * @param fs The robust standard deviation of the FWHMs.
+	 * @param e The median ellipticity.
+	 * @param et How long the seeing estimator took, in seconds.
+	 */
+	public CCDLibrarySeeingResult(int nc,int nr,double b,double bs,int cc,int sc,int fc,double mf,double f,
+				      double fs,double e,double et)
+	{
+		super();
+		ncols = nc;
+		nrows = nr;
+		background = b;
+		backgroundSigma = bs;
+		candidateCount = cc;
+		sourceCount = sc;
+		fitCount = fc;
+		momentFWHM = mf;
+		fwhm = f;
+		fwhmSigma = fs;
+		ellipticity = e;
+		elapsedTime = et;
+	}
+
+	/**
+	 * Get the number of binned columns in the frame.
+	 * @return The number of columns.
+	 */
+	public int getNCols()
+	{
+		return ncols;
+	}
+
+	/**
+	 * Get the number of binned rows in the frame.
+	 * @return The number of rows.
+	 */
+	public int getNRows()
+	{
+		return nrows;
+	}
+
+	/**
+	 * Get the estimated background level.
+	 * @return The background, in counts.
+	 */
+	public double getBackground()
+	{
+		return background;
+	}
+
+	/**
+	 * Get the estimated standard deviation of the background.
+	 * @return The background standard deviation, in counts.
+	 */
+	public double getBackgroundSigma()
+	{
+		return backgroundSigma;
+	}
+
+	/**
+	 * Get the number of candidate sources (local maxima above the threshold) found.
+	 * @return The number of candidates.
+	 */
+	public int getCandidateCount()
+	{
+		return candidateCount;
+	}
+
+	/**
+	 * Get the number of unsaturated, isolated sources that were measured.
+	 * @return The number of sources.
+	 */
+	public int getSourceCount()
+	{
+		return sourceCount;
+	}
+
+	/**
+	 * Get whether any sources were measured, i.e. whether the FWHM and ellipticity are valid.
+	 * @return true if at least one source was measured.
+	 */
+	public boolean hasSource()
+	{
+		return (sourceCount > 0);
+	}
+
+	/**
+	 * Get the number of measured sources whose 2D Gaussian fit converged.
+	 * @return The number of fitted sources.
+	 */
+	public int getFitCount()
+	{
+		return fitCount;
+	}
+
+	/**
+	 * Get the median moment-based FWHM of the measured sources.
+	 * @return The FWHM, in binned pixels.
+	 */
+	public double getMomentFWHM()
+	{
+		return momentFWHM;
+	}
+
+	/**
+	 * Get the median FWHM of the measured sources. This is the 2D Gaussian fit FWHM, or the moment-based
+	 * FWHM for sources whose fit failed.
+	 * @return The FWHM, in binned pixels.
+	 */
+	public double getFWHM()
+	{
+		return fwhm;
+	}
+
+	/**
+	 * Get the robust (median absolute deviation) standard deviation of the measured sources' FWHMs.
+	 * @return The FWHM standard deviation, in binned pixels.
+	 */
+	public double getFWHMSigma()
+	{
+		return fwhmSigma;
+	}
+
+	/**
+	 * Get the median ellipticity of the measured sources.
+	 * @return The ellipticity, 1 - minor/major axis.
+	 */
+	public double getEllipticity()
+	{
+		return ellipticity;
+	}
+
+	/**
+	 * Get how long the seeing estimator took.
+	 * @return The elapsed time, in seconds.
+	 */
+	public double getElapsedTime()
+	{
+		return elapsedTime;
+	}
+}
+
+//
+// $Log: not supported by cvs2svn $
+//
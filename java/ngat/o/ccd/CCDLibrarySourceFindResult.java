@@ -0,0 +1,245 @@
+// CCDLibrarySourceFindResult.java
+// $Header$
+package ngat.o.ccd;
+
+/**
+ * This class holds the result of running the libo_ccd source finder on the last frame read out.
+ * It is returned by CCDLibrary.getSourceFindResult. Pixel positions are binned FITS pixels,
+ * i.e. the first pixel is (1.0,1.0). For windowed readouts the source finder is run on the first window,
+ * and pixel positions are relative to that window.
+ * @author Chris Mottram
+ * @version $Revision$
+ * @see CCDLibrary#getSourceFindResult
+ */
+public class CCDLibrarySourceFindResult
+{
+	/**
+	 * Revision Control System id string, showing the version of the Class
+	 */
+	public final static String RCSID = new String("$Id$");
+	/**
+	 * The number of binned columns in the frame.
+	 */
+	private int ncols = 0;
+	/**
+	 * The number of binned rows in the frame.
+	 */
+	private int nrows = 0;
+	/**
+	 * The estimated background level, in counts.
+	 */
+	private double background = 0.0;
+	/**
+	 * The estimated standard deviation of the background, in counts.
+	 */
+	private double backgroundSigma = 0.0;
+	/**
+	 * The threshold pixels had to be above to be part of an object, in counts.
+	 */
+	private double threshold = 0.0;
+	/**
+	 * The number of objects found.
+	 */
+	private int objectCount = 0;
+	/**
+	 * The flux weighted centroid X position of the brightest object, in binned pixels.
+	 */
+	private double brightestX = 0.0;
+	/**
+	 * The flux weighted centroid Y position of the brightest object, in binned pixels.
+	 */
+	private double brightestY = 0.0;
+	/**
+	 * The total counts above the background of the brightest object.
+	 */
+	private double brightestFlux = 0.0;
+	/**
+	 * The value of the brightest object's brightest pixel.
+	 */
+	private int brightestPeak = 0;
+	/**
+	 * The number of pixels in the brightest object.
+	 */
+	private int brightestPixelCount = 0;
+	/**
+	 * Whether the brightest object is saturated.
+	 */
+	private boolean brightestSaturated = false;
+	/**
+	 * How long the source finder took, in seconds.
+	 */
+	private double elapsedTime = 0.0;
+
+	/**
+	 * Default constructor. No objects have been found.
+	 */
+	public CCDLibrarySourceFindResult()
+	{
+		super();
+	}
+
+	/**
+	 * Constructor. Called from the JNI layer (CCD_Source_Find_Get_Last_Result).
+	 * @param nc The number of binned columns in the frame.
+	 * @param nr The number of binned rows in the frame.
+	 * @param b The background level.
+	 * @param bs The background standard deviation.
+	 * @param t The threshold.
+	 * @param oc The number of objects found.
+	 * @param x The brightest object's X position.
+	 * @param y The brightest object's Y position.
+	 * @param f The brightest object's flux.
+	 * @param p The brightest object's peak pixel value.
+	 * @param pc The brightest object's pixel count.
+	 * @param s Whether the brightest object is saturated.
+	 * @param et How long the source finder took, in seconds.
+	 */
+	public CCDLibrarySourceFindResult(int nc,int nr,double b,double bs,double t,int oc,double x,double y,
+					  double f,int p,int pc,boolean s,double et)
+	{
+		super();
+		ncols = nc;
+		nrows = nr;
+		background = b;
+		backgroundSigma = bs;
+		threshold = t;
+		objectCount = oc;
+		brightestX = x;
+		brightestY = y;
+		brightestFlux = f;
+		brightestPeak = p;
+		brightestPixelCount = pc;
+		brightestSaturated = s;
+		elapsedTime = et;
+	}
+
+	/**
+	 * Get the number of binned columns in the frame.
+	 * @return The number of columns.
+	 */
+	public int getNCols()
+	{
+		return ncols;
+	}
+
+	/**
+	 * Get the number of binned rows in the frame.
+	 * @return The number of rows.
+	 */
+	public int getNRows()
+	{
+		return nrows;
+	}
+
+	/**
+	 * Get the estimated background level.
+	 * @return The background, in counts.
+	 */
+	public double getBackground()
+	{
+		return background;
+	}
+
+	/**
+	 * Get the estimated standard deviation of the background.
+	 * @return The background standard deviation, in counts.
+	 */
+	public double getBackgroundSigma()
+	{
+		return backgroundSigma;
+	}
+
+	/**
+	 * Get the threshold pixels had to be above to be part of an object.
+	 * @return The threshold, in counts.
+	 */
+	public double getThreshold()
+	{
+		return threshold;
+	}
+
+	/**
+	 * Get the number of objects found.
+	 * @return The number of objects.
+	 */
+	public int getObjectCount()
+	{
+		return objectCount;
+	}
+
+	/**
+	 * Get whether any objects were found, i.e. whether the brightest object values are valid.
+	 * @return true if at least one object was found.
+	 */
+	public boolean hasObject()
+	{
+		return (objectCount > 0);
+	}
+
+	/**
+	 * Get the flux weighted centroid X position of the brightest object.
+	 * @return The X position, in binned FITS pixels.
+	 */
+	public double getBrightestX()
+	{
+		return brightestX;
+	}
+
+	/**
+	 * Get the flux weighted centroid Y position of the brightest object.
+	 * @return The Y position, in binned FITS pixels.
+	 */
+	public double getBrightestY()
+	{
+		return brightestY;
+	}
+
+	/**
+	 * Get the total counts above the background of the brightest object.
+	 * @return The flux, in counts.
+	 */
+	public double getBrightestFlux()
+	{
+		return brightestFlux;
+	}
+
+	/**
+	 * Get the value of the brightest object's brightest pixel.
+	 * @return The peak, in counts.
+	 */
+	public int getBrightestPeak()
+	{
+		return brightestPeak;
+	}
+
+	/**
+	 * Get the number of pixels in the brightest object.
+	 * @return The number of pixels.
+	 */
+	public int getBrightestPixelCount()
+	{
+		return brightestPixelCount;
+	}
+
+	/**
+	 * Get whether the brightest object is saturated.
+	 * @return true if the brightest object's peak pixel is saturated.
+	 */
+	public boolean isBrightestSaturated()
+	{
+		return brightestSaturated;
+	}
+
+	/**
+	 * Get how long the source finder took.
+	 * @return The elapsed time, in seconds.
+	 */
+	public double getElapsedTime()
+	{
+		return elapsedTime;
+	}
+}
+
+//
+// $Log: not supported by cvs2svn $
+//
@@ -0,0 +1,444 @@
+// CCDLibraryStatus.java
+// $Header$
+package ngat.o.ccd;
+
+/**
+ * This class holds a snapshot of libo_ccd's status, as filled in by CCDLibrary.getStatus.
+ * All the values are set by one native call, so they are consistent with each other, and an instance can be
+ * re-used for each status request, so nothing is allocated. The controller values are only set if the relevant
+ * FLAG_* was passed to getStatus. Each group of controller values has a valid flag and, if it could not be read,
+ * the error numbers, so callers can ignore expected failures (e.g. utility board reads during an exposure).
+ * @author Chris Mottram
+ * @version $Revision$
+ * @see CCDLibrary#getStatus
+ */
+public class CCDLibraryStatus
+{
+	/**
+	 * Revision Control System id string, showing the version of the Class
+	 */
+	public final static String RCSID = new String("$Id$");
+	/**
+	 * Flag passed to CCDLibrary.getStatus, to read the elapsed exposure time from the controller.
+	 * This value should be the same as CCD_STATUS_FLAG_ELAPSED_EXPOSURE_TIME in ccd_status.h.
+	 */
+	public final static int FLAG_ELAPSED_EXPOSURE_TIME = 	(1<<0);
+	/**
+	 * Flag passed to CCDLibrary.getStatus, to get the temperature, heater and utility board ADUs.
+	 * This value should be the same as CCD_STATUS_FLAG_TEMPERATURE in ccd_status.h.
+	 */
+	public final static int FLAG_TEMPERATURE = 		(1<<1);
+	/**
+	 * Flag passed to CCDLibrary.getStatus, to get the SDSU supply voltage ADUs.
+	 * This value should be the same as CCD_STATUS_FLAG_SUPPLY_VOLTAGE in ccd_status.h.
+	 */
+	public final static int FLAG_SUPPLY_VOLTAGE = 		(1<<2);
+	/**
+	 * The exposure status, one of CCDLibrary.EXPOSURE_STATUS_*.
+	 */
+	private int exposureStatus = 0;
+	/**
+	 * Whether the last setup completed.
+	 */
+	private boolean setupComplete = false;
+	/**
+	 * Whether a setup is in progress.
+	 */
+	private boolean setupInProgress = false;
+	/**
+	 * The number of binned columns.
+	 */
+	private int binnedNCols = 0;
+	/**
+	 * The number of binned rows.
+	 */
+	private int binnedNRows = 0;
+	/**
+	 * The serial binning.
+	 */
+	private int xBin = 0;
+	/**
+	 * The parallel binning.
+	 */
+	private int yBin = 0;
+	/**
+	 * The window flags.
+	 */
+	private int windowFlags = 0;
+	/**
+	 * The length of the current (or last) exposure, in milliseconds.
+	 */
+	private int exposureLength = 0;
+	/**
+	 * The start time of the current (or last) exposure, in milliseconds since the epoch.
+	 */
+	private long exposureStartTime = 0L;
+	/**
+	 * Whether the elapsed exposure time was read from the controller.
+	 */
+	private boolean elapsedExposureTimeValid = false;
+	/**
+	 * The elapsed exposure time, in milliseconds.
+	 */
+	private int elapsedExposureTime = 0;
+	/**
+	 * The DSP error number, if the elapsed exposure time could not be read.
+	 */
+	private int elapsedExposureTimeDSPErrorNumber = 0;
+	/**
+	 * Whether the temperature and supply voltage values came from the telemetry sampler's snapshot.
+	 */
+	private boolean telemetryRunning = false;
+	/**
+	 * Whether the temperature was read.
+	 */
+	private boolean temperatureValid = false;
+	/**
+	 * The CCD temperature, in degrees centigrade.
+	 */
+	private double temperature = 0.0;
+	/**
+	 * Whether the heater and utility board ADUs were read.
+	 */
+	private boolean temperatureADUValid = false;
+	/**
+	 * The dewar heater ADU counts.
+	 */
+	private int heaterADU = 0;
+	/**
+	 * The utility board temperature sensor ADU counts.
+	 */
+	private int utilityBoardADU = 0;
+	/**
+	 * The age of the temperature values, in seconds.
+	 */
+	private double temperatureAge = 0.0;
+	/**
+	 * The ccd_temperature error number, if a temperature value could not be read.
+	 */
+	private int temperatureErrorNumber = 0;
+	/**
+	 * The DSP error number, if a temperature value could not be read.
+	 */
+	private int temperatureDSPErrorNumber = 0;
+	/**
+	 * Whether the supply voltage ADUs were read.
+	 */
+	private boolean supplyVoltageValid = false;
+	/**
+	 * The high voltage supply ADU counts.
+	 */
+	private int highVoltageADU = 0;
+	/**
+	 * The low voltage supply ADU counts.
+	 */
+	private int lowVoltageADU = 0;
+	/**
+	 * The negative low voltage supply ADU counts.
+	 */
+	private int minusLowVoltageADU = 0;
+	/**
+	 * The age of the supply voltage ADUs, in seconds.
+	 */
+	private double supplyVoltageAge = 0.0;
+	/**
+	 * The ccd_setup error number, if the supply voltages could not be read.
+	 */
+	private int supplyVoltageErrorNumber = 0;
+	/**
+	 * The DSP error number, if the supply voltages could not be read.
+	 */
+	private int supplyVoltageDSPErrorNumber = 0;
+
+	/**
+	 * Default constructor. The fields are set by the JNI layer, in CCDLibrary.getStatus.
+	 */
+	public CCDLibraryStatus()
+	{
+		super();
+	}
+
+	/**
+	 * Get the exposure status.
+	 * @return The exposure status.
+	 * @see CCDLibrary#EXPOSURE_STATUS_NONE
+	 */
+	public int getExposureStatus()
+	{
+		return exposureStatus;
+	}
+
+	/**
+	 * Get whether the last setup completed.
+	 * @return true if the setup completed.
+	 */
+	public boolean getSetupComplete()
+	{
+		return setupComplete;
+	}
+
+	/**
+	 * Get whether a setup is in progress.
+	 * @return true if a setup is in progress.
+	 */
+	public boolean getSetupInProgress()
+	{
+		return setupInProgress;
+	}
+
+	/**
+	 * Get the number of binned columns.
+	 * @return The number of binned columns.
+	 */
+	public int getBinnedNCols()
+	{
+		return binnedNCols;
+	}
+
+	/**
+	 * Get the number of binned rows.
+	 * @return The number of binned rows.
+	 */
+	public int getBinnedNRows()
+	{
+		return binnedNRows;
+	}
+
+	/**
+	 * Get the serial binning.
+	 * @return The serial binning.
+	 */
+	public int getXBin()
+	{
+		return xBin;
+	}
+
+	/**
+	 * Get the parallel binning.
+	 * @return The parallel binning.
+	 */
+	public int getYBin()
+	{
+		return yBin;
+	}
+
+	/**
+	 * Get the window flags.
+	 * @return The window flags.
+	 */
+	public int getSetupWindowFlags()
+	{
+		return windowFlags;
+	}
+
+	/**
+	 * Get the length of the current (or last) exposure.
+	 * @return The exposure length, in milliseconds.
+	 */
+	public int getExposureLength()
+	{
+		return exposureLength;
+	}
+
+	/**
+	 * Get the start time of the current (or last) exposure.
+	 * @return The start time, in milliseconds since the epoch.
+	 */
+	public long getExposureStartTime()
+	{
+		return exposureStartTime;
+	}
+
+	/**
+	 * Get whether the elapsed exposure time was read from the controller.
+	 * @return true if getElapsedExposureTime is valid.
+	 */
+	public boolean isElapsedExposureTimeValid()
+	{
+		return elapsedExposureTimeValid;
+	}
+
+	/**
+	 * Get the elapsed exposure time. This is 0 if it could not be read.
+	 * @return The elapsed exposure time, in milliseconds.
+	 */
+	public int getElapsedExposureTime()
+	{
+		return elapsedExposureTime;
+	}
+
+	/**
+	 * Get the DSP error number, if the elapsed exposure time could not be read.
+	 * @return The DSP error number.
+	 */
+	public int getElapsedExposureTimeDSPErrorNumber()
+	{
+		return elapsedExposureTimeDSPErrorNumber;
+	}
+
+	/**
+	 * Get whether the temperature and supply voltage values came from the telemetry sampler's snapshot, rather than being read from the controller.
+	 * @return true if the telemetry sampler was running.
+	 */
+	public boolean isTelemetryRunning()
+	{
+		return telemetryRunning;
+	}
+
+	/**
+	 * Get whether the temperature was read.
+	 * @return true if getTemperature is valid.
+	 */
+	public boolean isTemperatureValid()
+	{
+		return temperatureValid;
+	}
+
+	/**
+	 * Get the CCD temperature.
+	 * @return The temperature, in degrees centigrade.
+	 */
+	public double getTemperature()
+	{
+		return temperature;
+	}
+
+	/**
+	 * Get whether the heater and utility board ADUs were read.
+	 * @return true if getHeaterADU and getUtilityBoardADU are valid.
+	 */
+	public boolean isTemperatureADUValid()
+	{
+		return temperatureADUValid;
+	}
+
+	/**
+	 * Get the dewar heater ADU counts.
+	 * @return The heater ADU counts.
+	 */
+	public int getHeaterADU()
+	{
+		return heaterADU;
+	}
+
+	/**
+	 * Get the utility board temperature sensor ADU counts.
+	 * @return The utility board ADU counts.
+	 */
+	public int getUtilityBoardADU()
+	{
+		return utilityBoardADU;
+	}
+
+	/**
+	 * Get how old the temperature values are. This is only meaningful if isTelemetryRunning is true.
+	 * @return The age, in seconds.
+	 */
+	public double getTemperatureAge()
+	{
+		return temperatureAge;
+	}
+
+	/**
+	 * Get the ccd_temperature error number, if a temperature value could not be read.
+	 * @return The error number.
+	 */
+	public int getTemperatureErrorNumber()
+	{
+		return temperatureErrorNumber;
+	}
+
+	/**
+	 * Get the DSP error number, if a temperature value could not be read.
+	 * @return The DSP error number.
+	 */
+	public int getTemperatureDSPErrorNumber()
+	{
+		return temperatureDSPErrorNumber;
+	}
+
+	/**
+	 * Get whether the supply voltage ADUs were read.
+	 * @return true if the supply voltage ADUs are valid.
+	 */
+	public boolean isSupplyVoltageValid()
+	{
+		return supplyVoltageValid;
+	}
+
+	/**
+	 * Get the high voltage supply ADU counts.
+	 * @return The ADU counts.
+	 */
+	public int getHighVoltageADU()
+	{
+		return highVoltageADU;
+	}
+
+	/**
+	 * Get the low voltage supply ADU counts.
+	 * @return The ADU counts.
+	 */
+	public int getLowVoltageADU()
+	{
+		return lowVoltageADU;
+	}
+
+	/**
+	 * Get the negative low voltage supply ADU counts.
+	 * @return The ADU counts.
+	 */
+	public int getMinusLowVoltageADU()
+	{
+		return minusLowVoltageADU;
+	}
+
+	/**
+	 * Get how old the supply voltage ADUs are. This is only meaningful if isTelemetryRunning is true.
+	 * @return The age, in seconds.
+	 */
+	public double getSupplyVoltageAge()
+	{
+		return supplyVoltageAge;
+	}
+
+	/**
+	 * Get the ccd_setup error number, if the supply voltages could not be read.
+	 * @return The error number.
+	 */
+	public int getSupplyVoltageErrorNumber()
+	{
+		return supplyVoltageErrorNumber;
+	}
+
+	/**
+	 * Get the DSP error number, if the supply voltages could not be read.
+	 * @return The DSP error number.
+	 */
+	public int getSupplyVoltageDSPErrorNumber()
+	{
+		return supplyVoltageDSPErrorNumber;
+	}
+
+	/**
+	 * Return a string description of the status.
+	 * @return The string.
+	 */
+	public String toString()
+	{
+		return new String(this.getClass().getName()+":exposureStatus:"+exposureStatus+
+				  ":exposureLength:"+exposureLength+":exposureStartTime:"+exposureStartTime+
+				  ":elapsedExposureTime:"+elapsedExposureTime+"("+elapsedExposureTimeValid+")"+
+				  ":binnedNCols:"+binnedNCols+":binnedNRows:"+binnedNRows+":xBin:"+xBin+":yBin:"+yBin+
+				  ":windowFlags:"+windowFlags+":setupComplete:"+setupComplete+
+				  ":telemetryRunning:"+telemetryRunning+":temperature:"+temperature+
+				  "("+temperatureValid+")"+":heaterADU:"+heaterADU+":utilityBoardADU:"+utilityBoardADU+
+				  "("+temperatureADUValid+")"+":highVoltageADU:"+highVoltageADU+
+				  ":lowVoltageADU:"+lowVoltageADU+":minusLowVoltageADU:"+minusLowVoltageADU+
+				  "("+supplyVoltageValid+")");
+	}
+}
+
+//
+// $Log: not supported by cvs2svn $
+//
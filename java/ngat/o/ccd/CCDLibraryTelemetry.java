@@ -0,0 +1,268 @@
+// CCDLibraryTelemetry.java
+// $Header$
+package ngat.o.ccd;
+
+/**
+ * This class holds a snapshot of the controller telemetry, as sampled by the libo_ccd telemetry sampler thread.
+ * It is returned by CCDLibrary.getTelemetry. Each group of values has an age in seconds, which is how long ago
+ * the group was last successfully read from the controller, or -1.0 if the group has never been read.
+ * @author Chris Mottram
+ * @version $Revision$
+ * @see CCDLibrary#getTelemetry
+ */
+public class CCDLibraryTelemetry
+{
+	/**
+	 * Revision Control System id string, showing the version of the Class
+	 */
+	public final static String RCSID = new String("$Id$");
+	/**
+	 * Whether the sampler thread is running.
+	 */
+	private boolean running = false;
+	/**
+	 * The number of samples taken since the sampler thread was started.
+	 */
+	private int sampleCount = 0;
+	/**
+	 * The CCD temperature, in degrees centigrade.
+	 */
+	private double temperature = 0.0;
+	/**
+	 * The age of temperature, heaterADU and utilityBoardADU, in seconds.
+	 */
+	private double temperatureAge = -1.0;
+	/**
+	 * The dewar heater ADU counts.
+	 */
+	private int heaterADU = 0;
+	/**
+	 * The utility board temperature sensor ADU counts.
+	 */
+	private int utilityBoardADU = 0;
+	/**
+	 * The age of the supply voltage ADUs, in seconds.
+	 */
+	private double supplyVoltageAge = -1.0;
+	/**
+	 * The high voltage supply ADU counts.
+	 */
+	private int highVoltageADU = 0;
+	/**
+	 * The low voltage supply ADU counts.
+	 */
+	private int lowVoltageADU = 0;
+	/**
+	 * The negative low voltage supply ADU counts.
+	 */
+	private int minusLowVoltageADU = 0;
+	/**
+	 * The age of the exposure and filter wheel status, in seconds.
+	 */
+	private double stateAge = -1.0;
+	/**
+	 * The exposure status, one of the CCDLibrary.EXPOSURE_STATUS_* values.
+	 */
+	private int exposureStatus = 0;
+	/**
+	 * The filter wheel status, one of the CCDLibrary.FILTER_WHEEL_STATUS_* values.
+	 */
+	private int filterWheelStatus = 0;
+	/**
+	 * The filter wheel position, or -1 if it is not known.
+	 */
+	private int filterWheelPosition = -1;
+
+	/**
+	 * Default constructor. The snapshot has never been sampled.
+	 */
+	public CCDLibraryTelemetry()
+	{
+		super();
+	}
+
+	/**
+	 * Constructor. Called from the JNI layer (CCD_Telemetry_Get).
+	 * @param r Whether the sampler thread is running.
+	 * @param sc The number of samples taken.
+	 * @param t The CCD temperature, in degrees centigrade.
+	 * @param ta The age of the temperature values, in seconds, or -1.0.
+	 * @param ha The dewar heater ADU counts.
+	 * @param ua The utility board temperature sensor ADU counts.
+	 * @param sva The age of the supply voltage values, in seconds, or -1.0.
+	 * @param hva The high voltage supply ADU counts.
+	 * @param lva The low voltage supply ADU counts.
+	 * @param mlva The negative low voltage supply ADU counts.
+	 * @param sa The age of the status values, in seconds, or -1.0.
+	 * @param es The exposure status.
+	 * @param fws The filter wheel status.
+	 * @param fwp The filter wheel position.
+	 */
+	public CCDLibraryTelemetry(boolean r,int sc,double t,double ta,int ha,int ua,double sva,int hva,int lva,
+				   int mlva,double sa,int es,int fws,int fwp)
+	{
+		super();
+		running = r;
+		sampleCount = sc;
+		temperature = t;
+		temperatureAge = ta;
+		heaterADU = ha;
+		utilityBoardADU = ua;
+		supplyVoltageAge = sva;
+		highVoltageADU = hva;
+		lowVoltageADU = lva;
+		minusLowVoltageADU = mlva;
+		stateAge = sa;
+		exposureStatus = es;
+		filterWheelStatus = fws;
+		filterWheelPosition = fwp;
+	}
+
+	/**
+	 * Get whether the sampler thread is running.
+	 * @return true if the sampler thread is running.
+	 */
+	public boolean isRunning()
+	{
+		return running;
+	}
+
+	/**
+	 * Get the number of samples taken since the sampler thread was started.
+	 * @return The sample count.
+	 */
+	public int getSampleCount()
+	{
+		return sampleCount;
+	}
+
+	/**
+	 * Get whether the temperature values have ever been sampled.
+	 * @return true if the temperature, heater ADU and utility board ADU are valid.
+	 */
+	public boolean isTemperatureValid()
+	{
+		return (temperatureAge >= 0.0);
+	}
+
+	/**
+	 * Get the CCD temperature.
+	 * @return The temperature, in degrees centigrade.
+	 */
+	public double getTemperature()
+	{
+		return temperature;
+	}
+
+	/**
+	 * Get how old the temperature, heater ADU and utility board ADU values are.
+	 * @return The age in seconds, or -1.0 if they have never been sampled.
+	 */
+	public double getTemperatureAge()
+	{
+		return temperatureAge;
+	}
+
+	/**
+	 * Get the dewar heater ADU counts.
+	 * @return The ADU counts.
+	 */
+	public int getHeaterADU()
+	{
+		return heaterADU;
+	}
+
+	/**
+	 * Get the utility board temperature sensor ADU counts.
+	 * @return The ADU counts.
+	 */
+	public int getUtilityBoardADU()
+	{
+		return utilityBoardADU;
+	}
+
+	/**
+	 * Get whether the supply voltage values have ever been sampled.
+	 * @return true if the supply voltage ADUs are valid.
+	 */
+	public boolean isSupplyVoltageValid()
+	{
+		return (supplyVoltageAge >= 0.0);
+	}
+
+	/**
+	 * Get how old the supply voltage ADU values are.
+	 * @return The age in seconds, or -1.0 if they have never been sampled.
+	 */
+	public double getSupplyVoltageAge()
+	{
+		return supplyVoltageAge;
+	}
+
+	/**
+	 * Get the high voltage supply ADU counts.
+	 * @return The ADU counts.
+	 */
+	public int getHighVoltageADU()
+	{
+		return highVoltageADU;
+	}
+
+	/**
+	 * Get the low voltage supply ADU counts.
+	 * @return The ADU counts.
+	 */
+	public int getLowVoltageADU()
+	{
+		return lowVoltageADU;
+	}
+
+	/**
+	 * Get the negative low voltage supply ADU counts.
+	 * @return The ADU counts.
+	 */
+	public int getMinusLowVoltageADU()
+	{
+		return minusLowVoltageADU;
+	}
+
+	/**
+	 * Get how old the exposure and filter wheel status values are.
+	 * @return The age in seconds, or -1.0 if they have never been sampled.
+	 */
+	public double getStateAge()
+	{
+		return stateAge;
+	}
+
+	/**
+	 * Get the exposure status when the snapshot was taken.
+	 * @return The exposure status.
+	 */
+	public int getExposureStatus()
+	{
+		return exposureStatus;
+	}
+
+	/**
+	 * Get the filter wheel status when the snapshot was taken.
+	 * @return The filter wheel status.
+	 */
+	public int getFilterWheelStatus()
+	{
+		return filterWheelStatus;
+	}
+
+	/**
+	 * Get the filter wheel position when the snapshot was taken.
+	 * @return The filter wheel position, or -1 if it was not known.
+	 */
+	public int getFilterWheelPosition()
+	{
+		return filterWheelPosition;
+	}
+}
+
+//
+// $Log: not supported by cvs2svn $
+//
@@ -0,0 +1,221 @@
+// CCDLibraryTestGetterLatency.java
+// $Header$
+package ngat.o.ccd.test;
+
+import java.lang.*;
+import ngat.o.ccd.*;
+
+/**
+ * This class measures the cost of calling the JNI getters of ngat.o.ccd.CCDLibrary. It compares a getter that
+ * has to find the instance's interface handle (getExposureStatus) with one that does not (getTextErrorNumber),
+ * the difference being the cost of the handle lookup. The text (emulated) interface is used by default,
+ * so no controller is needed.
+ * @author Chris Mottram
+ * @version $Revision$
+ */
+public class CCDLibraryTestGetterLatency
+{
+	/**
+	 * Revision Control System id string, showing the version of the Class.
+	 */
+	public final static String RCSID = new String("$Id$");
+	/**
+	 * Default device pathname, the text interface output file.
+	 */
+	public final static String DEFAULT_DEVICE_PATHNAME = new String("/tmp/ccd_text_output.txt");
+	/**
+	 * Default number of calls to time.
+	 */
+	public final static int DEFAULT_CALL_COUNT = 10000000;
+	/**
+	 * Which interface device to communicate with the controller over, either TEXT (emulated) or PCI.
+	 * Defaults to TEXT.
+	 * @see ngat.o.ccd.CCDLibrary#INTERFACE_DEVICE_PCI
+	 * @see ngat.o.ccd.CCDLibrary#INTERFACE_DEVICE_TEXT
+	 */
+	protected int interfaceDevice = CCDLibrary.INTERFACE_DEVICE_TEXT;
+	/**
+	 * Pathname of the device (or text interface output file).
+	 * @see #DEFAULT_DEVICE_PATHNAME
+	 */
+	protected String devicePathname = DEFAULT_DEVICE_PATHNAME;
+	/**
+	 * The number of calls to time, for each getter.
+	 * @see #DEFAULT_CALL_COUNT
+	 */
+	protected int callCount = DEFAULT_CALL_COUNT;
+	/**
+	 * The instance of the class used to control the SDSU controller.
+	 */
+	protected CCDLibrary ccd = null;
+
+	/**
+	 * Method to parse arguments.
+	 * @param args The argument list.
+	 * @see #callCount
+	 * @see #devicePathname
+	 * @see #interfaceDevice
+	 * @see #help
+	 */
+	protected void parseArguments(String args[]) throws Exception
+	{
+		for(int i = 0;i < args.length; i++)
+		{
+			if(args[i].equals("-call_count")||args[i].equals("-c"))
+			{
+				if((i+1) < args.length)
+				{
+					callCount = Integer.parseInt(args[i+1]);
+					i++;
+				}
+				else
+				{
+					throw new IllegalArgumentException(this.getClass().getName()+
+							      ":parseArguments:No call count specified.");
+				}
+			}
+			else if(args[i].equals("-device_pathname")||args[i].equals("-dp"))
+			{
+				if((i+1) < args.length)
+				{
+					devicePathname = args[i+1];
+					i++;
+				}
+				else
+				{
+					throw new IllegalArgumentException(this.getClass().getName()+
+								    ":parseArguments:No device pathname specified.");
+				}
+			}
+			else if(args[i].equals("-help")||args[i].equals("-h"))
+			{
+				help();
+				System.exit(1);
+			}
+			else if(args[i].equals("-interface_device")||args[i].equals("-id"))
+			{
+				if((i+1) < args.length)
+				{
+					// throws CCDLibraryFormatException
+					interfaceDevice = ccd.interfaceDeviceFromString(args[i+1]);
+					i++;
+				}
+				else
+				{
+					throw new IllegalArgumentException(this.getClass().getName()+
+								    ":parseArguments:No interface device specified.");
+				}
+			}
+			else
+			{
+				throw new IllegalArgumentException(this.getClass().getName()+
+								   ":parseArguments:Illegal argument:"+args[i]);
+			}
+		}
+	}
+
+	/**
+	 * Help method.
+	 */
+	protected void help()
+	{
+		System.out.println("CCD Library Test Getter Latency Help:");
+		System.out.println("java ngat.o.ccd.test.CCDLibraryTestGetterLatency ");
+		System.out.println("\t[-interface_device|-id <INTERFACE_DEVICE_TEXT|INTERFACE_DEVICE_PCI>]");
+		System.out.println("\t[-device_pathname|-dp <filename>][-call_count|-c <integer>]");
+		System.out.println("\t-call_count specifies how many times to call each getter.");
+	}
+
+	/**
+	 * Time callCount calls of getExposureStatus (which looks up the interface handle).
+	 * @return The average time per call, in nanoseconds.
+	 * @see #callCount
+	 */
+	protected double timeHandleGetter()
+	{
+		long startTime,endTime;
+		int status = 0;
+
+		startTime = System.nanoTime();
+		for(int i = 0; i < callCount; i++)
+			status += ccd.getExposureStatus();
+		endTime = System.nanoTime();
+		if(status < 0)
+			System.out.println("Impossible exposure status sum:"+status);
+		return ((double)(endTime-startTime))/((double)callCount);
+	}
+
+	/**
+	 * Time callCount calls of getTextErrorNumber (which does not look up the interface handle).
+	 * @return The average time per call, in nanoseconds.
+	 * @see #callCount
+	 */
+	protected double timeBaselineGetter()
+	{
+		long startTime,endTime;
+		int errorNumber = 0;
+
+		startTime = System.nanoTime();
+		for(int i = 0; i < callCount; i++)
+			errorNumber += ccd.getTextErrorNumber();
+		endTime = System.nanoTime();
+		if(errorNumber < 0)
+			System.out.println("Impossible error number sum:"+errorNumber);
+		return ((double)(endTime-startTime))/((double)callCount);
+	}
+
+	/**
+	 * Main program. 
+	 * <ul>
+	 * <li>The arguments are parsed.
+	 * <li>The library is initialised, and the specified interface device is opened.
+	 * <li>Each getter is called callCount times to warm up the JIT, and then timed.
+	 * <li>The interface device is closed.
+	 * </ul>
+	 * @param args The arguments to the program.
+	 * @see #timeHandleGetter
+	 * @see #timeBaselineGetter
+	 */
+	public static void main(String args[])
+	{
+		CCDLibraryTestGetterLatency cltgl = null;
+		double handleTime,baselineTime;
+
+		cltgl = new CCDLibraryTestGetterLatency();
+		// create library before parsing arguments, some arguments parsed with CCDLibrary methods.
+		cltgl.ccd = new CCDLibrary();
+		try
+		{
+			cltgl.parseArguments(args);
+		}
+		catch(Exception e)
+		{
+			System.err.println("CCD Library Test Getter Latency parse arguments failed:"+e);
+			System.exit(1);
+		}
+		try
+		{
+			cltgl.ccd.initialise();
+			cltgl.ccd.interfaceOpen(cltgl.interfaceDevice,cltgl.devicePathname);
+			// warm up
+			cltgl.timeHandleGetter();
+			cltgl.timeBaselineGetter();
+			handleTime = cltgl.timeHandleGetter();
+			baselineTime = cltgl.timeBaselineGetter();
+			System.out.println("Calls per getter:"+cltgl.callCount);
+			System.out.println("getExposureStatus (handle lookup):"+handleTime+" ns/call.");
+			System.out.println("getTextErrorNumber (no handle lookup):"+baselineTime+" ns/call.");
+			System.out.println("Handle lookup overhead:"+(handleTime-baselineTime)+" ns/call.");
+			cltgl.ccd.interfaceClose();
+		}
+		catch(Exception e)
+		{
+			System.err.println("CCDLibrary Test Getter Latency failed:"+e);
+			System.exit(2);
+		}
+		System.exit(0);
+	}
+}
+//
+// $Log: not supported by cvs2svn $
+//
@@ -0,0 +1,320 @@
+// OStatusBenchmark.java
+// $Header$
+package ngat.o.test;
+
+import java.lang.*;
+import java.io.*;
+import java.util.*;
+
+import ngat.o.*;
+import ngat.phase2.*;
+
+/**
+ * This class measures the cost of the OStatus configuration lookups made when processing a CONFIG
+ * (filter wheel positions, filter ids, filter database and per-binning dimensions), and a GET_STATUS
+ * (numeric properties). It compares the compiled OStatus lookups against the original string-keyed
+ * lookups, which build the property key, scan the filter wheel properties and parse the value each call.
+ * <p>The same O property files O is started with are loaded.
+ * @author Chris Mottram
+ * @version $Revision$
+ */
+public class OStatusBenchmark
+{
+	/**
+	 * The default number of iterations of each set of lookups.
+	 */
+	static final int DEFAULT_LOOP_COUNT = 100000;
+	/**
+	 * The numeric properties read by the benchmark GET_STATUS lookups.
+	 */
+	static final String GET_STATUS_PROPERTY_LIST[] = {"o.config.readout_time.max","o.thread.priority.normal",
+							"o.ccd.config.ncols.1","o.ccd.config.nrows.1"};
+	/**
+	 * The filename of the network properties.
+	 */
+	private String netFilename = "./o.net.properties";
+	/**
+	 * The filename of the O properties.
+	 */
+	private String filename = "./o.properties";
+	/**
+	 * The filename of the current filter properties.
+	 */
+	private String currentFilterFilename = "./current.filter.properties";
+	/**
+	 * The filename of the filter database properties.
+	 */
+	private String filterFilename = "./filter.properties";
+	/**
+	 * The number of iterations of each set of lookups.
+	 */
+	private int loopCount = DEFAULT_LOOP_COUNT;
+	/**
+	 * The compiled OStatus being benchmarked.
+	 */
+	private OStatus status = null;
+	/**
+	 * A plain properties object, loaded from the same files, used for the string-keyed lookups.
+	 */
+	private Properties properties = null;
+	/**
+	 * For each filter wheel, the type name of the last filter in the wheel, the worst case for a linear scan.
+	 */
+	private String filterTypeNameList[] = null;
+	/**
+	 * Sum of the returned values, printed so the lookups can't be optimised away.
+	 */
+	private double checkSum = 0.0;
+
+	/**
+	 * Load the property files into the OStatus and the plain properties object, and select a filter
+	 * for each wheel.
+	 * @exception Exception Thrown if the files cannot be loaded, or a wheel has no filters.
+	 * @see #status
+	 * @see #properties
+	 * @see #filterTypeNameList
+	 */
+	private void init() throws Exception
+	{
+		String fileList[] = {netFilename,filename,currentFilterFilename,filterFilename};
+		FileInputStream fileInputStream = null;
+		int count;
+
+		status = new OStatus();
+		status.load(netFilename,filename,currentFilterFilename,filterFilename);
+		properties = new Properties();
+		for(int i = 0; i < fileList.length; i++)
+		{
+			fileInputStream = new FileInputStream(fileList[i]);
+			properties.load(fileInputStream);
+			fileInputStream.close();
+		}
+		filterTypeNameList = new String[OConfig.O_FILTER_INDEX_FILTER_SLIDE_UPPER+1];
+		for(int wheelIndex = OConfig.O_FILTER_INDEX_FILTER_WHEEL;
+		    wheelIndex <= OConfig.O_FILTER_INDEX_FILTER_SLIDE_UPPER; wheelIndex++)
+		{
+			count = Integer.parseInt(properties.getProperty("filterwheel."+wheelIndex+".count"));
+			if(count < 1)
+				throw new Exception(this.getClass().getName()+":init:Filter wheel "+wheelIndex+" is empty.");
+			filterTypeNameList[wheelIndex] = properties.getProperty("filterwheel."+wheelIndex+"."+
+										(count-1)+".type");
+		}
+	}
+
+	/**
+	 * Run the CONFIG and GET_STATUS lookups using the string-keyed properties.
+	 * @see #lookupPosition
+	 * @see #properties
+	 */
+	private void runStringKeyed()
+	{
+		String filterIdName = null;
+
+		for(int wheelIndex = OConfig.O_FILTER_INDEX_FILTER_WHEEL;
+		    wheelIndex <= OConfig.O_FILTER_INDEX_FILTER_SLIDE_UPPER; wheelIndex++)
+		{
+			checkSum += lookupPosition(wheelIndex,filterTypeNameList[wheelIndex]);
+			filterIdName = properties.getProperty("filterwheel."+filterTypeNameList[wheelIndex]+".id");
+			checkSum += Double.parseDouble(properties.getProperty("filter."+filterIdName+
+									      ".optical_thickness"));
+			checkSum += Double.parseDouble(properties.getProperty("filter."+filterIdName+".center"));
+		}
+		checkSum += Integer.parseInt(properties.getProperty("o.ccd.config.ncols."+1));
+		checkSum += Integer.parseInt(properties.getProperty("o.ccd.config.nrows."+1));
+		for(int i = 0; i < GET_STATUS_PROPERTY_LIST.length; i++)
+			checkSum += Integer.parseInt(properties.getProperty(GET_STATUS_PROPERTY_LIST[i]));
+	}
+
+	/**
+	 * Find a filter in a wheel by scanning the properties, as OStatus.getFilterWheelPosition used to.
+	 * @param wheelIndex The wheel index.
+	 * @param filterTypeName The filter type name.
+	 * @return The position of the filter, or -1 if it is not found.
+	 */
+	private int lookupPosition(int wheelIndex,String filterTypeName)
+	{
+		String s = null;
+		int count;
+
+		count = Integer.parseInt(properties.getProperty("filterwheel."+wheelIndex+".count"));
+		for(int i = 0; i < count; i++)
+		{
+			s = properties.getProperty("filterwheel."+wheelIndex+"."+i+".type");
+			if((s != null) && s.equals(filterTypeName))
+				return i;
+		}
+		return -1;
+	}
+
+	/**
+	 * Run the CONFIG and GET_STATUS lookups using the compiled OStatus.
+	 * @see #status
+	 */
+	private void runCompiled()
+	{
+		String filterIdName = null;
+
+		for(int wheelIndex = OConfig.O_FILTER_INDEX_FILTER_WHEEL;
+		    wheelIndex <= OConfig.O_FILTER_INDEX_FILTER_SLIDE_UPPER; wheelIndex++)
+		{
+			checkSum += status.getFilterWheelPosition(wheelIndex,filterTypeNameList[wheelIndex]);
+			filterIdName = status.getFilterIdName(filterTypeNameList[wheelIndex]);
+			checkSum += status.getFilterIdOpticalThickness(filterIdName);
+			checkSum += status.getFilterIdWaveLength(filterIdName);
+		}
+		checkSum += status.getNumberColumns(1);
+		checkSum += status.getNumberRows(1);
+		for(int i = 0; i < GET_STATUS_PROPERTY_LIST.length; i++)
+			checkSum += status.getPropertyInteger(GET_STATUS_PROPERTY_LIST[i]);
+	}
+
+	/**
+	 * Time loopCount iterations of the string-keyed and compiled lookups, after a warm up,
+	 * and print the time per iteration of each.
+	 * @see #runStringKeyed
+	 * @see #runCompiled
+	 * @see #loopCount
+	 */
+	private void run()
+	{
+		long startTime,stringKeyedTime,compiledTime;
+
+		// warm up
+		for(int i = 0; i < loopCount/10; i++)
+		{
+			runStringKeyed();
+			runCompiled();
+		}
+		startTime = System.nanoTime();
+		for(int i = 0; i < loopCount; i++)
+			runStringKeyed();
+		stringKeyedTime = System.nanoTime()-startTime;
+		startTime = System.nanoTime();
+		for(int i = 0; i < loopCount; i++)
+			runCompiled();
+		compiledTime = System.nanoTime()-startTime;
+		System.out.println("Iterations:"+loopCount);
+		System.out.println("String keyed lookups:"+(stringKeyedTime/loopCount)+" ns per CONFIG+GET_STATUS.");
+		System.out.println("Compiled lookups:"+(compiledTime/loopCount)+" ns per CONFIG+GET_STATUS.");
+		if(compiledTime > 0)
+			System.out.println("Speed up:"+(((double)stringKeyedTime)/((double)compiledTime)));
+		System.out.println("Check sum:"+checkSum);
+	}
+
+	/**
+	 * This routine parses arguments passed into OStatusBenchmark.
+	 * @see #netFilename
+	 * @see #filename
+	 * @see #currentFilterFilename
+	 * @see #filterFilename
+	 * @see #loopCount
+	 * @see #help
+	 */
+	private void parseArgs(String[] args)
+	{
+		for(int i = 0; i < args.length;i++)
+		{
+			if(args[i].equals("-h")||args[i].equals("-help"))
+			{
+				help();
+				System.exit(0);
+			}
+			else if(args[i].equals("-c")||args[i].equals("-count"))
+			{
+				if((i+1)< args.length)
+				{
+					loopCount = Integer.parseInt(args[i+1]);
+					i++;
+				}
+				else
+					System.err.println("-count requires a number of iterations.");
+			}
+			else if(args[i].equals("-current_filter"))
+			{
+				if((i+1)< args.length)
+				{
+					currentFilterFilename = args[i+1];
+					i++;
+				}
+				else
+					System.err.println("-current_filter requires a filename.");
+			}
+			else if(args[i].equals("-filter"))
+			{
+				if((i+1)< args.length)
+				{
+					filterFilename = args[i+1];
+					i++;
+				}
+				else
+					System.err.println("-filter requires a filename.");
+			}
+			else if(args[i].equals("-net"))
+			{
+				if((i+1)< args.length)
+				{
+					netFilename = args[i+1];
+					i++;
+				}
+				else
+					System.err.println("-net requires a filename.");
+			}
+			else if(args[i].equals("-o"))
+			{
+				if((i+1)< args.length)
+				{
+					filename = args[i+1];
+					i++;
+				}
+				else
+					System.err.println("-o requires a filename.");
+			}
+			else
+				System.out.println(this.getClass().getName()+":Option not supported:"+args[i]);
+		}
+	}
+
+	/**
+	 * Help message routine.
+	 */
+	private void help()
+	{
+		System.out.println(this.getClass().getName()+" Help:");
+		System.out.println("Options are:");
+		System.out.println("\t-c[ount] <number> - Number of iterations of the lookups.");
+		System.out.println("\t-net <filename> - Network properties filename.");
+		System.out.println("\t-o <filename> - O properties filename.");
+		System.out.println("\t-current_filter <filename> - Current filter properties filename.");
+		System.out.println("\t-filter <filename> - Filter database properties filename.");
+		System.out.println("The default number of iterations is "+DEFAULT_LOOP_COUNT+".");
+	}
+
+	/**
+	 * The main routine, called when OStatusBenchmark is executed. This parses it's arguments,
+	 * loads the property files, and runs the benchmark.
+	 * @see #parseArgs
+	 * @see #init
+	 * @see #run
+	 */
+	public static void main(String[] args)
+	{
+		OStatusBenchmark osb = new OStatusBenchmark();
+
+		osb.parseArgs(args);
+		try
+		{
+			osb.init();
+			osb.run();
+		}
+		catch(Exception e)
+		{
+			System.err.println("OStatusBenchmark failed:"+e);
+			e.printStackTrace(System.err);
+			System.exit(1);
+		}
+		System.exit(0);
+	}
+}
+//
+// $Log: not supported by cvs2svn $
+//
@@ -279,7 +279,7 @@ public class SendGetStatusCommand
 		System.out.println("Options are:");
 		System.out.println("\t-p[ort] <port number> - Port to send commands to.");
 		System.out.println("\t-[ip]|[address] <address> - Address to send commands to.");
-		System.out.println("\t-l[evel] <number> - Specify GET_STATUS level.");
+		System.out.println("\t-l[evel] <number> - Specify GET_STATUS level (3 also dumps the controller request trace).");
 		System.out.println("\t-s[erverport] <port number> - Port for the O to send commands back.");
 		System.out.println("The default server port is "+DEFAULT_SERVER_PORT_NUMBER+".");
 		System.out.println("The default O port is "+DEFAULT_O_PORT_NUMBER+".");